@@ -0,0 +1,123 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "agent_status.h"
+
+#include <sstream>
+#include "callbacks_monitor.h"
+#include "memory_budget.h"
+#include "statistician.h"
+
+namespace devtools {
+namespace cdbg {
+
+static AgentStatus* g_instance = nullptr;
+
+
+void AgentStatus::InitializeSingleton() {
+  DCHECK(g_instance == nullptr);
+
+  g_instance = new AgentStatus();
+}
+
+
+void AgentStatus::CleanupSingleton() {
+  delete g_instance;
+  g_instance = nullptr;
+}
+
+
+AgentStatus* AgentStatus::GetInstance() {
+  DCHECK(g_instance != nullptr);
+  return g_instance;
+}
+
+
+AgentStatus::Cookie AgentStatus::Register(
+    const char* name,
+    StatusCallback fn_status) {
+  MutexLock lock(&mu_);
+
+  components_.push_back({ name, fn_status });
+  return &components_.back();
+}
+
+
+void AgentStatus::Unregister(Cookie cookie) {
+  MutexLock lock(&mu_);
+
+  for (auto it = components_.begin(); it != components_.end(); ++it) {
+    if (&*it == cookie) {
+      components_.erase(it);
+      return;
+    }
+  }
+
+  DCHECK(false) << "Status component not found";
+}
+
+
+string AgentStatus::Format() const {
+  std::ostringstream ss;
+
+  ss << "[statisticians]\n";
+  for (const Statistician* statistician : GetAllStatisticians()) {
+    ss << statistician->name() << ": count = " << statistician->count();
+    if (statistician->count() > 0) {
+      ss << ", min = " << statistician->min()
+         << ", mean = " << statistician->mean()
+         << ", p50 = " << statistician->percentile(0.5)
+         << ", p90 = " << statistician->percentile(0.9)
+         << ", p99 = " << statistician->percentile(0.99)
+         << ", max = " << statistician->max()
+         << ", stdev = " << statistician->stdev();
+    }
+    ss << '\n';
+  }
+
+  MemoryBudget* memory_budget = MemoryBudget::GetInstance();
+  ss << "\n[memory budget]\n"
+     << "total_bytes: " << memory_budget->total_bytes() << '\n'
+     << "over_budget: " << memory_budget->IsOverBudget() << '\n';
+
+  CallbacksMonitor* callbacks_monitor = CallbacksMonitor::GetInstance();
+  const int64 current_time_ms = callbacks_monitor->GetCurrentTimeMillis();
+  ss << "\n[callbacks monitor]\n"
+     << "healthy: "
+     << callbacks_monitor->IsHealthy(
+            current_time_ms - callbacks_monitor->max_call_duration_ms())
+     << '\n'
+     << "owned_slots: " << callbacks_monitor->owned_slots_count() << '\n'
+     << "last_unhealthy_ms_ago: ";
+  const int64 last_unhealthy_time_ms =
+      callbacks_monitor->last_unhealthy_time_ms();
+  if (last_unhealthy_time_ms < 0) {
+    ss << "never\n";
+  } else {
+    ss << (current_time_ms - last_unhealthy_time_ms) << '\n';
+  }
+
+  MutexLock lock(&mu_);
+  for (const Component& component : components_) {
+    ss << "\n[" << component.name << "]\n";
+    component.fn_status(&ss);
+  }
+
+  return ss.str();
+}
+
+}  // namespace cdbg
+}  // namespace devtools
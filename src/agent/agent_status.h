@@ -0,0 +1,88 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_AGENT_STATUS_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_AGENT_STATUS_H_
+
+#include <functional>
+#include <list>
+#include <ostream>
+#include "common.h"
+#include "mutex.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Collects a human readable snapshot of the live performance state of the
+// agent: all the statisticians, the memory budget, the callbacks watchdog
+// and whatever the registered components report (cache hit rates, queue
+// depths, rate limiter levels, breakpoint counters). Unlike the periodic
+// "Statistician" log lines, the snapshot is built on demand (see
+// "StatusServer").
+//
+// This class is thread safe.
+class AgentStatus {
+ public:
+  // Writes the status of a single component. Each line should be in the
+  // "key: value" form.
+  typedef std::function<void(std::ostream*)> StatusCallback;
+
+  // Identifies registered component.
+  typedef void* Cookie;
+
+  AgentStatus() { }
+
+  // One time initialization of the global instance.
+  static void InitializeSingleton();
+
+  // One time cleanup of the global instance.
+  static void CleanupSingleton();
+
+  // Gets the global instance of this class.
+  static AgentStatus* GetInstance();
+
+  // Registers a component reporting its status. "name" must be a string
+  // literal. The callback is invoked with an internal lock held, from an
+  // arbitrary agent thread, and must not call back into this class.
+  Cookie Register(const char* name, StatusCallback fn_status);
+
+  // Unregisters a component. The callback is not invoked after this function
+  // returns.
+  void Unregister(Cookie cookie);
+
+  // Formats the status of the agent and all the registered components.
+  string Format() const;
+
+ private:
+  struct Component {
+    const char* name;
+    StatusCallback fn_status;
+  };
+
+ private:
+  // Locks "components_".
+  mutable Mutex mu_;
+
+  // Registered components. Kept in a list to keep the cookies valid.
+  std::list<Component> components_;
+
+  DISALLOW_COPY_AND_ASSIGN(AgentStatus);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_AGENT_STATUS_H_
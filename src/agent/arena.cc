@@ -0,0 +1,74 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "arena.h"
+
+#include <cstdint>
+
+namespace devtools {
+namespace cdbg {
+
+// Alignment of every block. Allocations can't ask for more than that.
+static constexpr size_t kMaxAlignment = alignof(std::max_align_t);
+
+
+Arena::~Arena() {
+  for (char* block : blocks_) {
+    delete[] block;
+  }
+}
+
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+  DCHECK_LE(alignment, kMaxAlignment);
+  DCHECK_EQ(0, alignment & (alignment - 1));
+
+  // Large allocations get a dedicated block so that they don't waste the
+  // remainder of the current one.
+  if (size > kBlockSize / 4) {
+    return AllocateBlock(size);
+  }
+
+  const uintptr_t address = reinterpret_cast<uintptr_t>(current_);
+  const size_t padding = (alignment - (address & (alignment - 1))) &
+                         (alignment - 1);
+
+  if ((current_ == nullptr) ||
+      (static_cast<size_t>(end_ - current_) < padding + size)) {
+    current_ = AllocateBlock(kBlockSize);
+    end_ = current_ + kBlockSize;
+    char* result = current_;
+    current_ += size;
+    return result;
+  }
+
+  char* result = current_ + padding;
+  current_ = result + size;
+  return result;
+}
+
+
+char* Arena::AllocateBlock(size_t size) {
+  // "new char[]" returns memory suitably aligned for any fundamental type.
+  char* block = new char[size];
+  blocks_.push_back(block);
+  allocated_bytes_ += size;
+  return block;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
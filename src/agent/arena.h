@@ -0,0 +1,140 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_ARENA_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_ARENA_H_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Bump pointer allocator. Memory is carved out of large blocks and is only
+// returned to the heap when the arena is destroyed. Individual deallocations
+// are no-ops. This keeps the number of heap allocations low (and away from
+// the allocator used by the application) when many small objects with the
+// same lifetime are created.
+//
+// This class is not thread safe.
+class Arena {
+ public:
+  // Size of a regular block. Allocations larger than a quarter of the block
+  // get a dedicated block.
+  static constexpr size_t kBlockSize = 16384;
+
+  Arena() { }
+
+  ~Arena();
+
+  // Allocates "size" bytes aligned to "alignment" (which must be a power of
+  // two not exceeding the alignment of "std::max_align_t").
+  void* Allocate(size_t size, size_t alignment);
+
+  // Total number of bytes allocated from the heap for blocks.
+  size_t allocated_bytes() const { return allocated_bytes_; }
+
+ private:
+  // Allocates a new block of at least "size" bytes.
+  char* AllocateBlock(size_t size);
+
+ private:
+  // All the blocks allocated so far.
+  std::vector<char*> blocks_;
+
+  // Free space in the current block.
+  char* current_ { nullptr };
+  char* end_ { nullptr };
+
+  // Total size of all blocks.
+  size_t allocated_bytes_ { 0 };
+
+  DISALLOW_COPY_AND_ASSIGN(Arena);
+};
+
+
+// STL allocator that allocates from "Arena". All containers sharing the
+// same arena are released at once when the arena is destroyed.
+template <typename T>
+class ArenaAllocator {
+ public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template <typename U>
+  struct rebind {
+    typedef ArenaAllocator<U> other;
+  };
+
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) { }
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other)  // NOLINT
+      : arena_(other.arena()) {
+  }
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, size_t n) {
+    // Memory is released when the arena is destroyed.
+  }
+
+  template <typename U, typename... Args>
+  void construct(U* p, Args&&... args) {
+    ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+  }
+
+  template <typename U>
+  void destroy(U* p) {
+    p->~U();
+  }
+
+  size_t max_size() const {
+    return static_cast<size_t>(-1) / sizeof(T);
+  }
+
+  Arena* arena() const { return arena_; }
+
+ private:
+  // Not owned by this class.
+  Arena* arena_;
+};
+
+
+template <typename T, typename U>
+bool operator== (const ArenaAllocator<T>& a1, const ArenaAllocator<U>& a2) {
+  return a1.arena() == a2.arena();
+}
+
+
+template <typename T, typename U>
+bool operator!= (const ArenaAllocator<T>& a1, const ArenaAllocator<U>& a2) {
+  return a1.arena() != a2.arena();
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_ARENA_H_
@@ -0,0 +1,471 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "array_aggregate_evaluator.h"
+
+#include <algorithm>
+#include <type_traits>
+#include "jni_utils.h"
+#include "messages.h"
+#include "method_call_result.h"
+#include "model.h"
+#include "numeric_cast_evaluator.h"
+#include "type_util.h"
+
+DEFINE_int32(
+    cdbg_max_array_aggregate_elements,
+    1000000,
+    "maximum number of elements of an array passed to a built-in aggregate "
+    "function in expressions (e.g. \"contains\" or \"sum\")");
+
+namespace devtools {
+namespace cdbg {
+
+// "contains" compares elements in blocks of this size. It stops after the
+// first block with a match, without an early exit inside the loop that
+// would prevent its vectorization.
+static constexpr int64 kContainsBlockSize = 256;
+
+static const struct {
+  const char* name;
+  ArrayAggregate aggregate;
+} kArrayAggregates[] = {
+  { "len", ArrayAggregate::Len },
+  { "contains", ArrayAggregate::Contains },
+  { "count", ArrayAggregate::Count },
+  { "sum", ArrayAggregate::Sum },
+  { "min", ArrayAggregate::Min },
+  { "max", ArrayAggregate::Max },
+  { "any", ArrayAggregate::Any }
+};
+
+
+// The kernels below are written without data dependent branches and early
+// exits, so that the compiler vectorizes them.
+
+template <typename TElement, typename TValue>
+static int64 CountEqual(const TElement* data, int64 size, TValue value) {
+  int64 count = 0;
+  for (int64 i = 0; i < size; ++i) {
+    count += (static_cast<TValue>(data[i]) == value) ? 1 : 0;
+  }
+
+  return count;
+}
+
+
+template <typename TElement, typename TValue>
+static bool ContainsEqual(const TElement* data, int64 size, TValue value) {
+  for (int64 begin = 0; begin < size; begin += kContainsBlockSize) {
+    const int64 block_size = std::min(kContainsBlockSize, size - begin);
+    if (CountEqual(data + begin, block_size, value) > 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+// Sum of integer elements wraps around on overflow like in Java.
+template <typename TElement>
+static JVariant SumOf(
+    const TElement* data,
+    int64 size,
+    std::false_type is_floating_point) {
+  uint64 sum = 0;
+  for (int64 i = 0; i < size; ++i) {
+    sum += static_cast<uint64>(static_cast<jlong>(data[i]));
+  }
+
+  return JVariant::Long(static_cast<jlong>(sum));
+}
+
+
+template <typename TElement>
+static JVariant SumOf(
+    const TElement* data,
+    int64 size,
+    std::true_type is_floating_point) {
+  jdouble sum = 0;
+  for (int64 i = 0; i < size; ++i) {
+    sum += data[i];
+  }
+
+  return JVariant::Double(sum);
+}
+
+
+template <typename TElement>
+static TElement MinOf(const TElement* data, int64 size) {
+  TElement result = data[0];
+  for (int64 i = 1; i < size; ++i) {
+    result = (data[i] < result) ? data[i] : result;
+  }
+
+  return result;
+}
+
+
+template <typename TElement>
+static TElement MaxOf(const TElement* data, int64 size) {
+  TElement result = data[0];
+  for (int64 i = 1; i < size; ++i) {
+    result = (data[i] > result) ? data[i] : result;
+  }
+
+  return result;
+}
+
+
+template <typename TElement, typename TValue>
+static ErrorOr<JVariant> FindEqual(
+    ArrayAggregate aggregate,
+    const TElement* data,
+    int64 size,
+    const JVariant& value) {
+  TValue native_value = TValue();
+  if (!value.get<TValue>(&native_value)) {
+    return INTERNAL_ERROR_MESSAGE;
+  }
+
+  if (aggregate == ArrayAggregate::Contains) {
+    return JVariant::Boolean(ContainsEqual(data, size, native_value));
+  }
+
+  return JVariant::Int(CountEqual(data, size, native_value));
+}
+
+
+bool ArrayAggregateFromName(const string& name, ArrayAggregate* aggregate) {
+  for (const auto& entry : kArrayAggregates) {
+    if (name == entry.name) {
+      *aggregate = entry.aggregate;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+ArrayAggregateEvaluator::ArrayAggregateEvaluator(
+    const string& name,
+    ArrayAggregate aggregate,
+    std::vector<std::unique_ptr<ExpressionEvaluator>> arguments,
+    std::unique_ptr<ExpressionEvaluator> method_call)
+    : name_(name),
+      aggregate_(aggregate),
+      arguments_(std::move(arguments)),
+      method_call_(std::move(method_call)) {
+}
+
+
+ArrayAggregateEvaluator::~ArrayAggregateEvaluator() {
+}
+
+
+bool ArrayAggregateEvaluator::Compile(
+    ReadersFactory* readers_factory,
+    FormatMessageModel* error_message) {
+  // Methods take precedence over the built-in functions, so that existing
+  // expressions calling a method with the same name keep working.
+  FormatMessageModel method_call_error;
+  if (method_call_->Compile(readers_factory, &method_call_error)) {
+    return true;
+  }
+
+  method_call_ = nullptr;
+
+  FormatMessageModel aggregate_error;
+  if (CompileAggregate(readers_factory, &aggregate_error)) {
+    return true;
+  }
+
+  // If the first argument is not a primitive array, this is not an attempt
+  // to call the built-in function.
+  *error_message = aggregate_error.format.empty()
+      ? method_call_error
+      : aggregate_error;
+  return false;
+}
+
+
+bool ArrayAggregateEvaluator::CompileAggregate(
+    ReadersFactory* readers_factory,
+    FormatMessageModel* error_message) {
+  if (arguments_.empty()) {
+    return false;
+  }
+
+  for (auto& argument : arguments_) {
+    if (!argument->Compile(readers_factory, error_message)) {
+      return false;
+    }
+  }
+
+  const JSignature& array_signature = arguments_[0]->GetStaticType();
+  if (!IsArrayObjectType(array_signature)) {
+    return false;
+  }
+
+  element_type_ = GetArrayElementJSignature(array_signature).type;
+  if ((element_type_ == JType::Void) || (element_type_ == JType::Object)) {
+    return false;
+  }
+
+  const bool is_boolean = IsBooleanType(element_type_);
+  const bool is_integer = IsIntegerType(element_type_);
+  const size_t expected_arguments_count =
+      ((aggregate_ == ArrayAggregate::Contains) ||
+       (aggregate_ == ArrayAggregate::Count)) ? 2 : 1;
+
+  bool is_valid = (arguments_.size() == expected_arguments_count);
+  if (is_valid) {
+    switch (aggregate_) {
+      case ArrayAggregate::Len:
+        return_type_ = { JType::Int };
+        break;
+
+      case ArrayAggregate::Contains:
+      case ArrayAggregate::Count: {
+        return_type_ = { (aggregate_ == ArrayAggregate::Contains)
+                         ? JType::Boolean
+                         : JType::Int };
+
+        // Elements are compared to the value widened to "long", "double" or
+        // kept as "boolean" (following Java rules for "==").
+        const JType value_type = arguments_[1]->GetStaticType().type;
+        if (is_boolean || IsBooleanType(value_type)) {
+          is_valid = is_boolean && IsBooleanType(value_type);
+        } else if (!IsNumericJType(value_type)) {
+          is_valid = false;
+        } else if (is_integer && IsIntegerType(value_type)) {
+          is_valid = ApplyNumericCast<jlong>(&arguments_[1], error_message);
+        } else {
+          is_valid = ApplyNumericCast<jdouble>(&arguments_[1], error_message);
+        }
+        break;
+      }
+
+      case ArrayAggregate::Sum:
+        is_valid = !is_boolean;
+        return_type_ = { is_integer ? JType::Long : JType::Double };
+        break;
+
+      case ArrayAggregate::Min:
+      case ArrayAggregate::Max:
+        is_valid = !is_boolean;
+        return_type_ = { element_type_ };
+        break;
+
+      case ArrayAggregate::Any:
+        is_valid = is_boolean;
+        return_type_ = { JType::Boolean };
+        break;
+    }
+  }
+
+  if (!is_valid) {
+    *error_message = { ArrayAggregateInvalidArguments, { name_ } };
+    return false;
+  }
+
+  return true;
+}
+
+
+bool ArrayAggregateEvaluator::HasMethodCalls() const {
+  if (method_call_ != nullptr) {
+    return method_call_->HasMethodCalls();
+  }
+
+  for (const auto& argument : arguments_) {
+    if (argument->HasMethodCalls()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+int ArrayAggregateEvaluator::Lower(ExpressionProgramBuilder* builder) const {
+  if (method_call_ != nullptr) {
+    return method_call_->Lower(builder);
+  }
+
+  return builder->AddLeaf(*this);
+}
+
+
+ErrorOr<JVariant> ArrayAggregateEvaluator::Evaluate(
+    const EvaluationContext& evaluation_context) const {
+  if (method_call_ != nullptr) {
+    return method_call_->Evaluate(evaluation_context);
+  }
+
+  ErrorOr<JVariant> array = arguments_[0]->Evaluate(evaluation_context);
+  if (array.is_error()) {
+    return array;
+  }
+
+  jobject obj = nullptr;
+  if (!array.value().get<jobject>(&obj)) {
+    return INTERNAL_ERROR_MESSAGE;
+  }
+
+  if (obj == nullptr) {
+    return FormatMessageModel { NullPointerDereference };
+  }
+
+  const jsize size = jni()->GetArrayLength(static_cast<jarray>(obj));
+  if (aggregate_ == ArrayAggregate::Len) {
+    return JVariant::Int(size);
+  }
+
+  if (size > FLAGS_cdbg_max_array_aggregate_elements) {
+    return FormatMessageModel {
+      ArrayAggregateTooLarge,
+      {
+        name_,
+        std::to_string(size),
+        std::to_string(FLAGS_cdbg_max_array_aggregate_elements)
+      }
+    };
+  }
+
+  if (((aggregate_ == ArrayAggregate::Min) ||
+       (aggregate_ == ArrayAggregate::Max)) &&
+      (size == 0)) {
+    return FormatMessageModel { ArrayAggregateEmptyArray, { name_ } };
+  }
+
+  // The value has to be computed before entering the critical region, in
+  // which no JNI calls are allowed.
+  ErrorOr<JVariant> value = JVariant();
+  if (arguments_.size() > 1) {
+    value = arguments_[1]->Evaluate(evaluation_context);
+    if (value.is_error()) {
+      return value;
+    }
+  }
+
+  void* data = jni()->GetPrimitiveArrayCritical(
+      static_cast<jarray>(obj),
+      nullptr);
+  if (data == nullptr) {
+    if (jni()->ExceptionCheck()) {
+      return MethodCallResult::PendingJniException().format_exception();
+    }
+
+    return FormatMessageModel { OutOfMemory };
+  }
+
+  const JVariant& v = value.value();
+  ErrorOr<JVariant> result;
+  switch (element_type_) {
+    case JType::Boolean:
+      result = Aggregate(static_cast<const jboolean*>(data), size, v);
+      break;
+
+    case JType::Byte:
+      result = Aggregate(static_cast<const jbyte*>(data), size, v);
+      break;
+
+    case JType::Char:
+      result = Aggregate(static_cast<const jchar*>(data), size, v);
+      break;
+
+    case JType::Short:
+      result = Aggregate(static_cast<const jshort*>(data), size, v);
+      break;
+
+    case JType::Int:
+      result = Aggregate(static_cast<const jint*>(data), size, v);
+      break;
+
+    case JType::Long:
+      result = Aggregate(static_cast<const jlong*>(data), size, v);
+      break;
+
+    case JType::Float:
+      result = Aggregate(static_cast<const jfloat*>(data), size, v);
+      break;
+
+    case JType::Double:
+      result = Aggregate(static_cast<const jdouble*>(data), size, v);
+      break;
+
+    default:
+      result = INTERNAL_ERROR_MESSAGE;
+      break;
+  }
+
+  // The array was not modified, so there is nothing to copy back.
+  jni()->ReleasePrimitiveArrayCritical(
+      static_cast<jarray>(obj),
+      data,
+      JNI_ABORT);
+
+  return result;
+}
+
+
+template <typename TElement>
+ErrorOr<JVariant> ArrayAggregateEvaluator::Aggregate(
+    const TElement* data,
+    int64 size,
+    const JVariant& value) const {
+  switch (aggregate_) {
+    case ArrayAggregate::Contains:
+    case ArrayAggregate::Count:
+      switch (value.type()) {
+        case JType::Boolean:
+          return FindEqual<TElement, jboolean>(aggregate_, data, size, value);
+
+        case JType::Long:
+          return FindEqual<TElement, jlong>(aggregate_, data, size, value);
+
+        case JType::Double:
+          return FindEqual<TElement, jdouble>(aggregate_, data, size, value);
+
+        default:
+          return INTERNAL_ERROR_MESSAGE;
+      }
+
+    case ArrayAggregate::Sum:
+      return SumOf(data, size, std::is_floating_point<TElement>());
+
+    case ArrayAggregate::Min:
+      return JVariant::Primitive<TElement>(MinOf(data, size));
+
+    case ArrayAggregate::Max:
+      return JVariant::Primitive<TElement>(MaxOf(data, size));
+
+    case ArrayAggregate::Any:
+      return JVariant::Boolean(
+          ContainsEqual(data, size, static_cast<TElement>(true)));
+
+    case ArrayAggregate::Len:
+      return JVariant::Int(size);
+  }
+
+  return INTERNAL_ERROR_MESSAGE;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,129 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_ARRAY_AGGREGATE_EVALUATOR_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_ARRAY_AGGREGATE_EVALUATOR_H_
+
+#include <vector>
+#include "common.h"
+#include "expression_evaluator.h"
+#include "expression_program.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Built-in aggregate functions over primitive arrays.
+enum class ArrayAggregate {
+  Len,       // len(a): number of elements.
+  Contains,  // contains(a, x): true if any element equals "x".
+  Count,     // count(a, x): number of elements equal to "x".
+  Sum,       // sum(a): long for integer arrays, double otherwise.
+  Min,       // min(a): smallest element (error if the array is empty).
+  Max,       // max(a): largest element (error if the array is empty).
+  Any        // any(a): true if any element of a boolean array is true.
+};
+
+// Gets the built-in aggregate function by name. Returns false if "name" is
+// not a built-in function.
+bool ArrayAggregateFromName(const string& name, ArrayAggregate* aggregate);
+
+// Evaluates built-in aggregate functions over primitive arrays (e.g.
+// "contains(ids, 42)" or "max(latencies) > 1000"). Without them such
+// conditions can only be expressed with Java methods that the interpreter
+// has to run under the instructions quota.
+//
+// The elements are scanned in place between "GetPrimitiveArrayCritical" and
+// "ReleasePrimitiveArrayCritical" with simple loops that the compiler
+// vectorizes. Arrays with more than --cdbg_max_array_aggregate_elements
+// elements fail the evaluation, so a single condition can't stall the
+// garbage collector for long.
+//
+// The built-in functions don't shadow methods: if the call compiles as a
+// Java method call (e.g. the class has its own "sum(int[])"), the method is
+// called instead.
+class ArrayAggregateEvaluator : public ExpressionEvaluator {
+ public:
+  // "method_call" is the same call compiled as a regular method call. It
+  // takes precedence if it compiles.
+  ArrayAggregateEvaluator(
+      const string& name,
+      ArrayAggregate aggregate,
+      std::vector<std::unique_ptr<ExpressionEvaluator>> arguments,
+      std::unique_ptr<ExpressionEvaluator> method_call);
+
+  ~ArrayAggregateEvaluator() override;
+
+  bool Compile(
+      ReadersFactory* readers_factory,
+      FormatMessageModel* error_message) override;
+
+  const JSignature& GetStaticType() const override {
+    return (method_call_ != nullptr)
+        ? method_call_->GetStaticType()
+        : return_type_;
+  }
+
+  Nullable<jvalue> GetStaticValue() const override { return nullptr; }
+
+  bool HasMethodCalls() const override;
+
+  int Lower(ExpressionProgramBuilder* builder) const override;
+
+  ErrorOr<JVariant> Evaluate(
+      const EvaluationContext& evaluation_context) const override;
+
+ private:
+  // Compiles the built-in function. Returns false if the arguments don't
+  // match it.
+  bool CompileAggregate(
+      ReadersFactory* readers_factory,
+      FormatMessageModel* error_message);
+
+  // Computes the aggregate over the array elements. "value" is the second
+  // argument (if any) converted to "jlong", "jdouble" or "jboolean".
+  template <typename TElement>
+  ErrorOr<JVariant> Aggregate(
+      const TElement* data,
+      int64 size,
+      const JVariant& value) const;
+
+ private:
+  // Name of the built-in function (for error messages).
+  const string name_;
+
+  // Built-in function to compute.
+  const ArrayAggregate aggregate_;
+
+  // The array and the value to look for (for "contains" and "count").
+  std::vector<std::unique_ptr<ExpressionEvaluator>> arguments_;
+
+  // Regular method call of the same name. Reset after "Compile" unless the
+  // method call compiled, in which case all calls are forwarded to it.
+  std::unique_ptr<ExpressionEvaluator> method_call_;
+
+  // Type of the array elements.
+  JType element_type_ { JType::Void };
+
+  // Type of the result.
+  JSignature return_type_;
+
+  DISALLOW_COPY_AND_ASSIGN(ArrayAggregateEvaluator);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_ARRAY_AGGREGATE_EVALUATOR_H_
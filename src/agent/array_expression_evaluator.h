@@ -19,6 +19,7 @@
 
 #include "common.h"
 #include "expression_evaluator.h"
+#include "expression_program.h"
 
 namespace devtools {
 namespace cdbg {
@@ -42,6 +43,15 @@ class ArrayExpressionEvaluator : public ExpressionEvaluator {
 
   Nullable<jvalue> GetStaticValue() const override { return nullptr; }
 
+  bool HasMethodCalls() const override {
+    return source_array_->HasMethodCalls() ||
+           source_index_->HasMethodCalls();
+  }
+
+  int Lower(ExpressionProgramBuilder* builder) const override {
+    return builder->AddLeaf(*this);
+  }
+
   ErrorOr<JVariant> Evaluate(
       const EvaluationContext& evaluation_context) const override;
 
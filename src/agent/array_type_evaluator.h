@@ -17,6 +17,7 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_ARRAY_TYPE_EVALUATOR_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_ARRAY_TYPE_EVALUATOR_H_
 
+#include <cstring>
 #include "common.h"
 #include "instance_field_reader.h"
 #include "jni_utils.h"
@@ -78,9 +79,7 @@ void ArrayTypeEvaluator<jobject>::Evaluate(
         jni()->GetObjectArrayElement(static_cast<jobjectArray>(obj), i));
 
     (*members)[i + 1].name = FormatArrayIndexName(i);
-    (*members)[i + 1].value.assign_new_ref(
-        JVariant::ReferenceKind::Global,
-        jitem.get());
+    (*members)[i + 1].value = JVariant::LocalRef(std::move(jitem));
     (*members)[i + 1].well_known_jclass = element_well_known_jclass;
   }
 
@@ -98,6 +97,13 @@ void ArrayTypeEvaluator<TArrayType>::Evaluate(
 
   const jsize array_len = jni()->GetArrayLength(static_cast<jarray>(obj));
 
+  // Copy the captured elements out of the array in one shot, so that the
+  // critical section (which may block garbage collection) is as short as
+  // possible. Variables for the elements are built after the array is
+  // released.
+  TArrayType elements[kMaxCapturePrimitiveElements];
+  int count = 0;
+
   //
   // Note: the function must not block or make any calls to JNI in
   // between GetPrimitiveArrayCritical and ReleasePrimitiveArrayCritical.
@@ -108,23 +114,21 @@ void ArrayTypeEvaluator<TArrayType>::Evaluate(
         jni()->GetPrimitiveArrayCritical(static_cast<jarray>(obj), nullptr));
 
     if (array_data != nullptr) {
-      const int count =
-          std::min<int>(kMaxCapturePrimitiveElements, array_len);
-      *members = std::vector<NamedJVariant>(count + 1);
-
-      for (int i = 0; i < count; ++i) {
-        (*members)[i + 1].name = FormatArrayIndexName(i);
-        (*members)[i + 1].value =
-            JVariant::Primitive<TArrayType>(array_data[i]);
-      }
+      count = std::min<int>(kMaxCapturePrimitiveElements, array_len);
+      memcpy(elements, array_data, count * sizeof(TArrayType));
 
       jni()->ReleasePrimitiveArrayCritical(
           static_cast<jarray>(obj),
           const_cast<TArrayType*>(array_data),
-          0);
+          JNI_ABORT);
     }
-  } else {
-    *members = std::vector<NamedJVariant>(1);
+  }
+
+  *members = std::vector<NamedJVariant>(count + 1);
+
+  for (int i = 0; i < count; ++i) {
+    (*members)[i + 1].name = FormatArrayIndexName(i);
+    (*members)[i + 1].value = JVariant::Primitive<TArrayType>(elements[i]);
   }
 
   (*members)[0].name = kArrayLengthName;
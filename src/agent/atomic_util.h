@@ -0,0 +1,63 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_ATOMIC_UTIL_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_ATOMIC_UTIL_H_
+
+#include <atomic>
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Atomically adds "value" to "target".
+inline void AtomicAdd(std::atomic<double>* target, double value) {
+  double current = target->load(std::memory_order_relaxed);
+  while (!target->compare_exchange_weak(
+      current,
+      current + value,
+      std::memory_order_relaxed)) {
+  }
+}
+
+
+// Atomically sets "target" to "value" if "value" is smaller.
+inline void AtomicMin(std::atomic<double>* target, double value) {
+  double current = target->load(std::memory_order_relaxed);
+  while ((value < current) &&
+         !target->compare_exchange_weak(
+             current,
+             value,
+             std::memory_order_relaxed)) {
+  }
+}
+
+
+// Atomically sets "target" to "value" if "value" is larger.
+inline void AtomicMax(std::atomic<double>* target, double value) {
+  double current = target->load(std::memory_order_relaxed);
+  while ((value > current) &&
+         !target->compare_exchange_weak(
+             current,
+             value,
+             std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_ATOMIC_UTIL_H_
@@ -28,7 +28,21 @@ bool AutoJvmtiBreakpoint::Set(
   MutexLock lock(&mu_);
 
   if ((method_ == method) && (location_ == location)) {
-    return true;
+    if (!is_disarmed_) {
+      return true;
+    }
+
+    // Activating a disarmed breakpoint again arms it right away.
+    if (breakpoints_manager_->SetJvmtiBreakpoint(method, location,
+                                                 breakpoint)) {
+      is_disarmed_ = false;
+      return true;
+    }
+
+    method_ = nullptr;
+    location_ = 0;
+    is_disarmed_ = false;
+    return false;
   }
 
   ClearUnsafe(breakpoint);
@@ -53,16 +67,60 @@ void AutoJvmtiBreakpoint::Clear(std::shared_ptr<Breakpoint> breakpoint) {
 }
 
 
+bool AutoJvmtiBreakpoint::Disarm(std::shared_ptr<Breakpoint> breakpoint) {
+  MutexLock lock(&mu_);
+
+  if ((method_ == nullptr) || is_disarmed_) {
+    return false;
+  }
+
+  breakpoints_manager_->ClearJvmtiBreakpoint(
+      method_,
+      location_,
+      breakpoint);
+
+  is_disarmed_ = true;
+
+  return true;
+}
+
+
+bool AutoJvmtiBreakpoint::Rearm(std::shared_ptr<Breakpoint> breakpoint) {
+  MutexLock lock(&mu_);
+
+  if ((method_ == nullptr) || !is_disarmed_) {
+    return true;
+  }
+
+  is_disarmed_ = false;
+
+  if (!breakpoints_manager_->SetJvmtiBreakpoint(
+          method_,
+          location_,
+          breakpoint)) {
+    method_ = nullptr;
+    location_ = 0;
+    return false;
+  }
+
+  return true;
+}
+
+
 void AutoJvmtiBreakpoint::ClearUnsafe(
     std::shared_ptr<Breakpoint> breakpoint) {
   if (method_ != nullptr) {
-    breakpoints_manager_->ClearJvmtiBreakpoint(
-        method_,
-        location_,
-        breakpoint);
+    // The JVMTI breakpoint of a disarmed breakpoint is already cleared.
+    if (!is_disarmed_) {
+      breakpoints_manager_->ClearJvmtiBreakpoint(
+          method_,
+          location_,
+          breakpoint);
+    }
 
     method_ = nullptr;
     location_ = 0;
+    is_disarmed_ = false;
   }
 }
 
@@ -47,6 +47,15 @@ class AutoJvmtiBreakpoint {
 
   void Clear(std::shared_ptr<Breakpoint> breakpoint);
 
+  // Clears the JVMTI breakpoint, but keeps its location, so that it can be
+  // set again with "Rearm". Returns false if there is no breakpoint set.
+  bool Disarm(std::shared_ptr<Breakpoint> breakpoint);
+
+  // Sets the JVMTI breakpoint cleared by "Disarm" again (if it's still
+  // disarmed). Returns false if it could not be set, then the location is
+  // forgotten as if "Clear" was called.
+  bool Rearm(std::shared_ptr<Breakpoint> breakpoint);
+
  private:
   void ClearUnsafe(std::shared_ptr<Breakpoint> breakpoint);
 
@@ -56,6 +65,9 @@ class AutoJvmtiBreakpoint {
   jmethodID method_ { nullptr };
   jlocation location_ { 0 };
 
+  // Set while the breakpoint at "method_" and "location_" is disarmed.
+  bool is_disarmed_ { false };
+
   DISALLOW_COPY_AND_ASSIGN(AutoJvmtiBreakpoint);
 };
 
@@ -18,6 +18,8 @@
 
 #include <cmath>
 #include <limits>
+#include <type_traits>
+#include "expression_program.h"
 #include "model.h"
 #include "messages.h"
 #include "numeric_cast_evaluator.h"
@@ -136,6 +138,125 @@ static bool IsEqual(jstring string1, jstring string2) {
 }
 
 
+// Operation kernels plugged into the computers of
+// "BinaryExpressionEvaluator". Each one implements a single Java operator.
+struct AddOperation {
+  template <typename T>
+  static T Apply(T x, T y) { return x + y; }
+};
+
+
+struct SubtractOperation {
+  template <typename T>
+  static T Apply(T x, T y) { return x - y; }
+};
+
+
+struct MultiplyOperation {
+  template <typename T>
+  static T Apply(T x, T y) { return x * y; }
+};
+
+
+struct DivideOperation {
+  template <typename T>
+  static T Apply(T x, T y) { return x / y; }
+};
+
+
+struct ModuloOperation {
+  template <typename T>
+  static T Apply(T x, T y) { return ComputeModulo(x, y); }
+};
+
+
+struct BitwiseAndOperation {
+  template <typename T>
+  static T Apply(T x, T y) { return x & y; }
+};
+
+
+struct BitwiseOrOperation {
+  template <typename T>
+  static T Apply(T x, T y) { return x | y; }
+};
+
+
+struct BitwiseXorOperation {
+  template <typename T>
+  static T Apply(T x, T y) { return x ^ y; }
+};
+
+
+struct ShiftLeftOperation {
+  template <typename T>
+  static T Apply(T value, jint distance) { return value << distance; }
+};
+
+
+struct ShiftRightOperation {
+  template <typename T>
+  static T Apply(T value, jint distance) { return value >> distance; }
+};
+
+
+struct UnsignedShiftRightOperation {
+  template <typename T>
+  static T Apply(T value, jint distance) {
+    return static_cast<typename std::make_unsigned<T>::type>(value) >>
+           distance;
+  }
+};
+
+
+struct LogicalAndOperation {
+  template <typename T>
+  static bool Apply(T x, T y) { return x && y; }
+};
+
+
+struct LogicalOrOperation {
+  template <typename T>
+  static bool Apply(T x, T y) { return x || y; }
+};
+
+
+struct EqualOperation {
+  template <typename T>
+  static bool Apply(T x, T y) { return x == y; }
+};
+
+
+struct NotEqualOperation {
+  template <typename T>
+  static bool Apply(T x, T y) { return x != y; }
+};
+
+
+struct LessOperation {
+  template <typename T>
+  static bool Apply(T x, T y) { return x < y; }
+};
+
+
+struct LessOrEqualOperation {
+  template <typename T>
+  static bool Apply(T x, T y) { return x <= y; }
+};
+
+
+struct GreaterOperation {
+  template <typename T>
+  static bool Apply(T x, T y) { return x > y; }
+};
+
+
+struct GreaterOrEqualOperation {
+  template <typename T>
+  static bool Apply(T x, T y) { return x >= y; }
+};
+
+
 BinaryExpressionEvaluator::BinaryExpressionEvaluator(
     BinaryJavaExpression::Type type,
     std::unique_ptr<ExpressionEvaluator> arg1,
@@ -159,6 +280,18 @@ bool BinaryExpressionEvaluator::Compile(
     return false;
   }
 
+  if (!CompileOperator(error_message)) {
+    return false;
+  }
+
+  FoldConstants();
+
+  return true;
+}
+
+
+bool BinaryExpressionEvaluator::CompileOperator(
+    FormatMessageModel* error_message) {
   switch (type_) {
     case BinaryJavaExpression::Type::add:
     case BinaryJavaExpression::Type::sub:
@@ -192,6 +325,48 @@ bool BinaryExpressionEvaluator::Compile(
   return false;
 }
 
+
+void BinaryExpressionEvaluator::FoldConstants() {
+  JVariant value1;
+  JVariant value2;
+  const bool is_static1 = GetStaticPrimitiveValue(*arg1_, &value1);
+  const bool is_static2 = GetStaticPrimitiveValue(*arg2_, &value2);
+
+  if (is_static1 && is_static2) {
+    // Errors (e.g. division by zero) are left to be reported by "Evaluate".
+    ErrorOr<JVariant> result = (this->*computer_)(value1, value2);
+    if (!result.is_error()) {
+      static_value_ = JVariant(result.value());
+    }
+
+    return;
+  }
+
+  if ((type_ != BinaryJavaExpression::Type::conditional_and) &&
+      (type_ != BinaryJavaExpression::Type::conditional_or)) {
+    return;
+  }
+
+  // "true && x" is "x" and "false && x" is "false" (Java doesn't evaluate "x"
+  // in this case). "x && true" is "x", but "x && false" still has to evaluate
+  // "x" and is left as is. Same for "||" with the opposite constants.
+  const jboolean neutral =
+      (type_ == BinaryJavaExpression::Type::conditional_and);
+
+  jboolean boolean_value = false;
+  if (is_static1 && value1.get<jboolean>(&boolean_value)) {
+    if (boolean_value == neutral) {
+      passthrough_ = arg2_.get();
+    } else {
+      static_value_ = JVariant::Boolean(boolean_value);
+    }
+  } else if (is_static2 && value2.get<jboolean>(&boolean_value)) {
+    if (boolean_value == neutral) {
+      passthrough_ = arg1_.get();
+    }
+  }
+}
+
 bool BinaryExpressionEvaluator::CompileArithmetical(
     FormatMessageModel* error_message) {
   // TODO(vlif): unbox (Java Language Specification section 5.1.8).
@@ -205,7 +380,11 @@ bool BinaryExpressionEvaluator::CompileArithmetical(
       return false;
     }
 
-    computer_ = &BinaryExpressionEvaluator::ArithmeticComputer<jdouble>;
+    if (!SelectArithmeticComputer<jdouble>()) {
+      *error_message = { TypeMismatch };
+      return false;
+    }
+
     result_type_ = { JType::Double };
 
     return true;
@@ -214,7 +393,11 @@ bool BinaryExpressionEvaluator::CompileArithmetical(
       return false;
     }
 
-    computer_ = &BinaryExpressionEvaluator::ArithmeticComputer<jfloat>;
+    if (!SelectArithmeticComputer<jfloat>()) {
+      *error_message = { TypeMismatch };
+      return false;
+    }
+
     result_type_ = { JType::Float };
 
     return true;
@@ -223,7 +406,11 @@ bool BinaryExpressionEvaluator::CompileArithmetical(
       return false;
     }
 
-    computer_ = &BinaryExpressionEvaluator::ArithmeticComputer<jlong>;
+    if (!SelectArithmeticComputer<jlong>()) {
+      *error_message = { TypeMismatch };
+      return false;
+    }
+
     result_type_ = { JType::Long };
 
     return true;
@@ -232,7 +419,11 @@ bool BinaryExpressionEvaluator::CompileArithmetical(
       return false;
     }
 
-    computer_ = &BinaryExpressionEvaluator::ArithmeticComputer<jint>;
+    if (!SelectArithmeticComputer<jint>()) {
+      *error_message = { TypeMismatch };
+      return false;
+    }
+
     result_type_ = { JType::Int };
 
     return true;
@@ -288,28 +479,37 @@ bool BinaryExpressionEvaluator::CompileConditional(
         return false;
       }
 
-      computer_ =
-          &BinaryExpressionEvaluator::NumericalComparisonComputer<jdouble>;
+      if (!SelectComparisonComputer<jdouble>()) {
+        *error_message = { TypeMismatch };
+        return false;
+      }
     } else if (IsEitherType(JType::Float)) {
       if (!ApplyNumericPromotions<jfloat>(error_message)) {
         return false;
       }
 
-      computer_ =
-          &BinaryExpressionEvaluator::NumericalComparisonComputer<jfloat>;
+      if (!SelectComparisonComputer<jfloat>()) {
+        *error_message = { TypeMismatch };
+        return false;
+      }
     } else if (IsEitherType(JType::Long)) {
       if (!ApplyNumericPromotions<jlong>(error_message)) {
         return false;
       }
 
-      computer_ =
-          &BinaryExpressionEvaluator::NumericalComparisonComputer<jlong>;
+      if (!SelectComparisonComputer<jlong>()) {
+        *error_message = { TypeMismatch };
+        return false;
+      }
     } else {
       if (!ApplyNumericPromotions<jint>(error_message)) {
         return false;
       }
 
-      computer_ = &BinaryExpressionEvaluator::NumericalComparisonComputer<jint>;
+      if (!SelectComparisonComputer<jint>()) {
+        *error_message = { TypeMismatch };
+        return false;
+      }
     }
 
     result_type_ = { JType::Boolean };
@@ -334,7 +534,11 @@ bool BinaryExpressionEvaluator::CompileBooleanConditional(
        (type_ == BinaryJavaExpression::Type::bitwise_and) ||
        (type_ == BinaryJavaExpression::Type::bitwise_or) ||
        (type_ == BinaryJavaExpression::Type::bitwise_xor))) {
-    computer_ = &BinaryExpressionEvaluator::ConditionalBooleanComputer;
+    if (!SelectBooleanComputer()) {
+      *error_message = { TypeMismatch };
+      return false;
+    }
+
     result_type_ = { JType::Boolean };
 
     return true;
@@ -370,7 +574,11 @@ bool BinaryExpressionEvaluator::CompileBitwise(
       return false;
     }
 
-    computer_ = &BinaryExpressionEvaluator::BitwiseComputer<jlong>;
+    if (!SelectBitwiseComputer<jlong>()) {
+      *error_message = { TypeMismatch };
+      return false;
+    }
+
     result_type_ = { JType::Long };
 
     return true;
@@ -381,7 +589,11 @@ bool BinaryExpressionEvaluator::CompileBitwise(
     return false;
   }
 
-  computer_ = &BinaryExpressionEvaluator::BitwiseComputer<jint>;
+  if (!SelectBitwiseComputer<jint>()) {
+    *error_message = { TypeMismatch };
+    return false;
+  }
+
   result_type_ = { JType::Int };
 
   return true;
@@ -405,16 +617,29 @@ bool BinaryExpressionEvaluator::CompileShift(
     return false;
   }
 
+  const bool is_long_distance = (arg2_->GetStaticType().type == JType::Long);
+
   switch (arg1_->GetStaticType().type) {
     case JType::Int:
-      computer_ = &BinaryExpressionEvaluator::ShiftComputer<jint, uint32, 0x1f>;
+      if (!(is_long_distance ?
+            SelectShiftComputer<jint, jlong>() :
+            SelectShiftComputer<jint, jint>())) {
+        *error_message = { TypeMismatch };
+        return false;
+      }
+
       result_type_ = { JType::Int };
 
       return true;
 
     case JType::Long:
-      computer_ =
-          &BinaryExpressionEvaluator::ShiftComputer<jlong, uint64, 0x3f>;
+      if (!(is_long_distance ?
+            SelectShiftComputer<jlong, jlong>() :
+            SelectShiftComputer<jlong, jint>())) {
+        *error_message = { TypeMismatch };
+        return false;
+      }
+
       result_type_ = { JType::Long };
 
       return true;
@@ -426,6 +651,276 @@ bool BinaryExpressionEvaluator::CompileShift(
 }
 
 
+template <typename T>
+bool BinaryExpressionEvaluator::SelectArithmeticComputer() {
+  switch (type_) {
+    case BinaryJavaExpression::Type::add:
+      computer_ =
+          &BinaryExpressionEvaluator::ArithmeticComputer<T, AddOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::sub:
+      computer_ =
+          &BinaryExpressionEvaluator::ArithmeticComputer<T, SubtractOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::mul:
+      computer_ =
+          &BinaryExpressionEvaluator::ArithmeticComputer<T, MultiplyOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::div:
+      computer_ =
+          &BinaryExpressionEvaluator::DivisionComputer<T, DivideOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::mod:
+      computer_ =
+          &BinaryExpressionEvaluator::DivisionComputer<T, ModuloOperation>;
+      return true;
+
+    default:
+      return false;  // Not an arithmetical operator.
+  }
+}
+
+
+template <typename T>
+bool BinaryExpressionEvaluator::SelectBitwiseComputer() {
+  switch (type_) {
+    case BinaryJavaExpression::Type::bitwise_and:
+      computer_ =
+          &BinaryExpressionEvaluator::BitwiseComputer<T, BitwiseAndOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::bitwise_or:
+      computer_ =
+          &BinaryExpressionEvaluator::BitwiseComputer<T, BitwiseOrOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::bitwise_xor:
+      computer_ =
+          &BinaryExpressionEvaluator::BitwiseComputer<T, BitwiseXorOperation>;
+      return true;
+
+    default:
+      return false;  // Not a bitwise operator.
+  }
+}
+
+
+template <typename T, typename TDistance>
+bool BinaryExpressionEvaluator::SelectShiftComputer() {
+  switch (type_) {
+    case BinaryJavaExpression::Type::shl:
+      computer_ = &BinaryExpressionEvaluator::ShiftComputer<
+          T, TDistance, ShiftLeftOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::shr_s:
+      computer_ = &BinaryExpressionEvaluator::ShiftComputer<
+          T, TDistance, ShiftRightOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::shr_u:
+      computer_ = &BinaryExpressionEvaluator::ShiftComputer<
+          T, TDistance, UnsignedShiftRightOperation>;
+      return true;
+
+    default:
+      return false;  // Not a shift operator.
+  }
+}
+
+
+bool BinaryExpressionEvaluator::SelectBooleanComputer() {
+  switch (type_) {
+    case BinaryJavaExpression::Type::conditional_and:
+    case BinaryJavaExpression::Type::bitwise_and:
+      computer_ = &BinaryExpressionEvaluator::ConditionalBooleanComputer<
+          LogicalAndOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::conditional_or:
+    case BinaryJavaExpression::Type::bitwise_or:
+      computer_ = &BinaryExpressionEvaluator::ConditionalBooleanComputer<
+          LogicalOrOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::eq:
+      computer_ = &BinaryExpressionEvaluator::ConditionalBooleanComputer<
+          EqualOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::ne:
+    case BinaryJavaExpression::Type::bitwise_xor:
+      computer_ = &BinaryExpressionEvaluator::ConditionalBooleanComputer<
+          NotEqualOperation>;
+      return true;
+
+    default:
+      return false;  // Not applicable to booleans.
+  }
+}
+
+
+template <typename T>
+bool BinaryExpressionEvaluator::SelectComparisonComputer() {
+  switch (type_) {
+    case BinaryJavaExpression::Type::eq:
+      computer_ = &BinaryExpressionEvaluator::NumericalComparisonComputer<
+          T, EqualOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::ne:
+      computer_ = &BinaryExpressionEvaluator::NumericalComparisonComputer<
+          T, NotEqualOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::le:
+      computer_ = &BinaryExpressionEvaluator::NumericalComparisonComputer<
+          T, LessOrEqualOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::ge:
+      computer_ = &BinaryExpressionEvaluator::NumericalComparisonComputer<
+          T, GreaterOrEqualOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::lt:
+      computer_ = &BinaryExpressionEvaluator::NumericalComparisonComputer<
+          T, LessOperation>;
+      return true;
+
+    case BinaryJavaExpression::Type::gt:
+      computer_ = &BinaryExpressionEvaluator::NumericalComparisonComputer<
+          T, GreaterOperation>;
+      return true;
+
+    default:
+      return false;  // Not a comparison operator.
+  }
+}
+
+
+bool BinaryExpressionEvaluator::SelectProgramOpcode(
+    ExpressionProgram::Opcode* opcode) const {
+  const JType arg1_type = arg1_->GetStaticType().type;
+
+  // Boolean operators (see "ConditionalBooleanComputer").
+  if (IsBooleanType(arg1_type)) {
+    switch (type_) {
+      case BinaryJavaExpression::Type::conditional_and:
+      case BinaryJavaExpression::Type::bitwise_and:
+        *opcode = ExpressionProgram::Opcode::BOOLEAN_AND;
+        return true;
+
+      case BinaryJavaExpression::Type::conditional_or:
+      case BinaryJavaExpression::Type::bitwise_or:
+        *opcode = ExpressionProgram::Opcode::BOOLEAN_OR;
+        return true;
+
+      case BinaryJavaExpression::Type::eq:
+        *opcode = ExpressionProgram::Opcode::BOOLEAN_EQ;
+        return true;
+
+      case BinaryJavaExpression::Type::ne:
+      case BinaryJavaExpression::Type::bitwise_xor:
+        *opcode = ExpressionProgram::Opcode::BOOLEAN_NE;
+        return true;
+
+      default:
+        return false;
+    }
+  }
+
+  // Both arguments have already been promoted to the same type (except for
+  // the shift distance), so the type of the first argument picks the variant.
+  ExpressionProgram::Opcode base;
+  switch (type_) {
+    case BinaryJavaExpression::Type::add:
+      base = ExpressionProgram::Opcode::ADD_INT;
+      break;
+
+    case BinaryJavaExpression::Type::sub:
+      base = ExpressionProgram::Opcode::SUB_INT;
+      break;
+
+    case BinaryJavaExpression::Type::mul:
+      base = ExpressionProgram::Opcode::MUL_INT;
+      break;
+
+    case BinaryJavaExpression::Type::div:
+      base = ExpressionProgram::Opcode::DIV_INT;
+      break;
+
+    case BinaryJavaExpression::Type::mod:
+      base = ExpressionProgram::Opcode::REM_INT;
+      break;
+
+    case BinaryJavaExpression::Type::eq:
+      base = ExpressionProgram::Opcode::EQ_INT;
+      break;
+
+    case BinaryJavaExpression::Type::ne:
+      base = ExpressionProgram::Opcode::NE_INT;
+      break;
+
+    case BinaryJavaExpression::Type::lt:
+      base = ExpressionProgram::Opcode::LT_INT;
+      break;
+
+    case BinaryJavaExpression::Type::le:
+      base = ExpressionProgram::Opcode::LE_INT;
+      break;
+
+    case BinaryJavaExpression::Type::gt:
+      base = ExpressionProgram::Opcode::GT_INT;
+      break;
+
+    case BinaryJavaExpression::Type::ge:
+      base = ExpressionProgram::Opcode::GE_INT;
+      break;
+
+    case BinaryJavaExpression::Type::bitwise_and:
+      base = ExpressionProgram::Opcode::AND_INT;
+      break;
+
+    case BinaryJavaExpression::Type::bitwise_or:
+      base = ExpressionProgram::Opcode::OR_INT;
+      break;
+
+    case BinaryJavaExpression::Type::bitwise_xor:
+      base = ExpressionProgram::Opcode::XOR_INT;
+      break;
+
+    case BinaryJavaExpression::Type::shl:
+      base = ExpressionProgram::Opcode::SHL_INT;
+      break;
+
+    case BinaryJavaExpression::Type::shr_s:
+      base = ExpressionProgram::Opcode::SHR_INT;
+      break;
+
+    case BinaryJavaExpression::Type::shr_u:
+      base = ExpressionProgram::Opcode::USHR_INT;
+      break;
+
+    default:
+      return false;  // Logical operators only apply to booleans.
+  }
+
+  return ExpressionProgram::SelectTypedOpcode(base, arg1_type, opcode);
+}
+
+
+bool BinaryExpressionEvaluator::IsShiftOperator() const {
+  return (type_ == BinaryJavaExpression::Type::shl) ||
+         (type_ == BinaryJavaExpression::Type::shr_s) ||
+         (type_ == BinaryJavaExpression::Type::shr_u);
+}
+
+
 bool BinaryExpressionEvaluator::IsEitherType(JType type) const {
   return (arg1_->GetStaticType().type == type) ||
          (arg2_->GetStaticType().type == type);
@@ -460,8 +955,42 @@ bool BinaryExpressionEvaluator::ApplyShiftNumericPromotion(
 }
 
 
+Nullable<jvalue> BinaryExpressionEvaluator::GetStaticValue() const {
+  if (static_value_.type() != JType::Void) {
+    return static_value_.get_jvalue();
+  }
+
+  if (passthrough_ != nullptr) {
+    return passthrough_->GetStaticValue();
+  }
+
+  return nullptr;
+}
+
+
+bool BinaryExpressionEvaluator::HasMethodCalls() const {
+  if (static_value_.type() != JType::Void) {
+    return false;
+  }
+
+  if (passthrough_ != nullptr) {
+    return passthrough_->HasMethodCalls();
+  }
+
+  return arg1_->HasMethodCalls() || arg2_->HasMethodCalls();
+}
+
+
 ErrorOr<JVariant> BinaryExpressionEvaluator::Evaluate(
     const EvaluationContext& evaluation_context) const {
+  if (static_value_.type() != JType::Void) {
+    return JVariant(static_value_);
+  }
+
+  if (passthrough_ != nullptr) {
+    return passthrough_->Evaluate(evaluation_context);
+  }
+
   ErrorOr<JVariant> arg1_value = arg1_->Evaluate(evaluation_context);
   if (arg1_value.is_error()) {
     return arg1_value;
@@ -479,7 +1008,44 @@ ErrorOr<JVariant> BinaryExpressionEvaluator::Evaluate(
 }
 
 
-template <typename T>
+int BinaryExpressionEvaluator::Lower(ExpressionProgramBuilder* builder) const {
+  if (static_value_.type() != JType::Void) {
+    return builder->AddConstant(
+        static_value_.type(),
+        static_value_.get_jvalue());
+  }
+
+  if (passthrough_ != nullptr) {
+    return passthrough_->Lower(builder);
+  }
+
+  const JType arg1_type = arg1_->GetStaticType().type;
+  const JType arg2_type = arg2_->GetStaticType().type;
+
+  // Comparison of objects and strings is evaluated through the tree.
+  if ((arg1_type == JType::Object) || (arg2_type == JType::Object)) {
+    return builder->AddLeaf(*this);
+  }
+
+  ExpressionProgram::Opcode opcode;
+  if (!SelectProgramOpcode(&opcode)) {
+    return ExpressionProgramBuilder::kNoRegister;
+  }
+
+  const int arg1 = arg1_->Lower(builder);
+  int arg2 = arg2_->Lower(builder);
+
+  // Shift distance can be either int or long, but the program always
+  // expects int.
+  if (IsShiftOperator() && (arg2_type == JType::Long)) {
+    arg2 = builder->AddConversion(JType::Long, JType::Int, arg2);
+  }
+
+  return builder->AddBinary(opcode, arg1, arg2);
+}
+
+
+template <typename T, typename TOperation>
 ErrorOr<JVariant> BinaryExpressionEvaluator::ArithmeticComputer(
     const JVariant& arg1,
     const JVariant& arg2) const {
@@ -493,40 +1059,37 @@ ErrorOr<JVariant> BinaryExpressionEvaluator::ArithmeticComputer(
     return INTERNAL_ERROR_MESSAGE;
   }
 
-  switch (type_) {
-    case BinaryJavaExpression::Type::add:
-      return JVariant::Primitive<T>(value1 + value2);
-
-    case BinaryJavaExpression::Type::sub:
-      return JVariant::Primitive<T>(value1 - value2);
+  return JVariant::Primitive<T>(TOperation::Apply(value1, value2));
+}
 
-    case BinaryJavaExpression::Type::mul:
-      return JVariant::Primitive<T>(value1 * value2);
 
-    case BinaryJavaExpression::Type::mod:
-    case BinaryJavaExpression::Type::div:
-      if (IsDivisionByZero(value2)) {
-        return FormatMessageModel { DivisionByZero };
-      }
+template <typename T, typename TOperation>
+ErrorOr<JVariant> BinaryExpressionEvaluator::DivisionComputer(
+    const JVariant& arg1,
+    const JVariant& arg2) const {
+  T value1 = T();
+  if (!arg1.get<T>(&value1)) {
+    return INTERNAL_ERROR_MESSAGE;
+  }
 
-      if (IsDivisionOverflow(value1, value2)) {
-        return FormatMessageModel { IntegerDivisionOverflow };
-      }
+  T value2 = T();
+  if (!arg2.get<T>(&value2)) {
+    return INTERNAL_ERROR_MESSAGE;
+  }
 
-      if (type_ == BinaryJavaExpression::Type::div) {
-        return JVariant::Primitive<T>(value1 / value2);
-      } else {
-        return JVariant::Primitive<T>(ComputeModulo(value1, value2));
-      }
+  if (IsDivisionByZero(value2)) {
+    return FormatMessageModel { DivisionByZero };
+  }
 
-    default:
-      DCHECK(false);  // Any non arithmetic operations are unexpected here.
-      return INTERNAL_ERROR_MESSAGE;
+  if (IsDivisionOverflow(value1, value2)) {
+    return FormatMessageModel { IntegerDivisionOverflow };
   }
+
+  return JVariant::Primitive<T>(TOperation::Apply(value1, value2));
 }
 
 
-template <typename T>
+template <typename T, typename TOperation>
 ErrorOr<JVariant> BinaryExpressionEvaluator::BitwiseComputer(
     const JVariant& arg1,
     const JVariant& arg2) const {
@@ -540,24 +1103,11 @@ ErrorOr<JVariant> BinaryExpressionEvaluator::BitwiseComputer(
     return INTERNAL_ERROR_MESSAGE;
   }
 
-  switch (type_) {
-    case BinaryJavaExpression::Type::bitwise_and:
-      return JVariant::Primitive<T>(value1 & value2);
-
-    case BinaryJavaExpression::Type::bitwise_or:
-      return JVariant::Primitive<T>(value1 | value2);
-
-    case BinaryJavaExpression::Type::bitwise_xor:
-      return JVariant::Primitive<T>(value1 ^ value2);
-
-    default:
-      DCHECK(false);  // Any other operations are unexpected here.
-      return INTERNAL_ERROR_MESSAGE;
-  }
+  return JVariant::Primitive<T>(TOperation::Apply(value1, value2));
 }
 
 
-template <typename T, typename TUnsigned, uint16 Bitmask>
+template <typename T, typename TDistance, typename TOperation>
 ErrorOr<JVariant> BinaryExpressionEvaluator::ShiftComputer(
     const JVariant& arg1,
     const JVariant& arg2) const {
@@ -566,14 +1116,9 @@ ErrorOr<JVariant> BinaryExpressionEvaluator::ShiftComputer(
     return INTERNAL_ERROR_MESSAGE;
   }
 
-  jint value2 = 0;
-  if (!arg2.get<jint>(&value2)) {
-    jlong value2_long = 0;
-    if (!arg2.get<jlong>(&value2_long)) {
-      return INTERNAL_ERROR_MESSAGE;
-    }
-
-    value2 = static_cast<jint>(value2_long);
+  TDistance value2 = TDistance();
+  if (!arg2.get<TDistance>(&value2)) {
+    return INTERNAL_ERROR_MESSAGE;
   }
 
   // From Java Language Specification, section 15.19:
@@ -587,22 +1132,10 @@ ErrorOr<JVariant> BinaryExpressionEvaluator::ShiftComputer(
   // It is as if the right-hand operand were subjected to a bitwise logical AND
   // operator & (15.22.1) with the mask value 0x3f (0b111111). The shift
   // distance actually used is therefore always in the range 0 to 63, inclusive.
-  value2 &= Bitmask;
-
-  switch (type_) {
-    case BinaryJavaExpression::Type::shl:
-      return JVariant::Primitive<T>(value1 << value2);
-
-    case BinaryJavaExpression::Type::shr_s:
-      return JVariant::Primitive<T>(value1 >> value2);
-
-    case BinaryJavaExpression::Type::shr_u:
-      return JVariant::Primitive<T>(static_cast<TUnsigned>(value1) >> value2);
+  const jint bitmask = (sizeof(T) * 8) - 1;
+  const jint distance = static_cast<jint>(value2) & bitmask;
 
-    default:
-      DCHECK(false);  // Any operations other than shift are unexpected here.
-      return INTERNAL_ERROR_MESSAGE;
-  }
+  return JVariant::Primitive<T>(TOperation::Apply(value1, distance));
 }
 
 
@@ -663,6 +1196,7 @@ ErrorOr<JVariant> BinaryExpressionEvaluator::ConditionalStringComputer(
 }
 
 
+template <typename TOperation>
 ErrorOr<JVariant> BinaryExpressionEvaluator::ConditionalBooleanComputer(
     const JVariant& arg1,
     const JVariant& arg2) const {
@@ -676,30 +1210,11 @@ ErrorOr<JVariant> BinaryExpressionEvaluator::ConditionalBooleanComputer(
     return INTERNAL_ERROR_MESSAGE;
   }
 
-  switch (type_) {
-    case BinaryJavaExpression::Type::conditional_and:
-    case BinaryJavaExpression::Type::bitwise_and:
-      return JVariant::Boolean(boolean1 && boolean2);
-
-    case BinaryJavaExpression::Type::conditional_or:
-    case BinaryJavaExpression::Type::bitwise_or:
-      return JVariant::Boolean(boolean1 || boolean2);
-
-    case BinaryJavaExpression::Type::eq:
-      return JVariant::Boolean(boolean1 == boolean2);
-
-    case BinaryJavaExpression::Type::ne:
-    case BinaryJavaExpression::Type::bitwise_xor:
-      return JVariant::Boolean(boolean1 != boolean2);
-
-    default:
-      DCHECK(false);  // Any other operations are unexpected here.
-      return INTERNAL_ERROR_MESSAGE;
-  }
+  return JVariant::Boolean(TOperation::Apply(boolean1, boolean2));
 }
 
 
-template <typename T>
+template <typename T, typename TOperation>
 ErrorOr<JVariant> BinaryExpressionEvaluator::NumericalComparisonComputer(
     const JVariant& arg1,
     const JVariant& arg2) const {
@@ -713,30 +1228,7 @@ ErrorOr<JVariant> BinaryExpressionEvaluator::NumericalComparisonComputer(
     return INTERNAL_ERROR_MESSAGE;
   }
 
-  switch (type_) {
-    case BinaryJavaExpression::Type::eq:
-      return JVariant::Boolean(value1 == value2);
-
-    case BinaryJavaExpression::Type::ne:
-    case BinaryJavaExpression::Type::bitwise_xor:
-      return JVariant::Boolean(value1 != value2);
-
-    case BinaryJavaExpression::Type::le:
-      return JVariant::Boolean(value1 <= value2);
-
-    case BinaryJavaExpression::Type::ge:
-      return JVariant::Boolean(value1 >= value2);
-
-    case BinaryJavaExpression::Type::lt:
-      return JVariant::Boolean(value1 < value2);
-
-    case BinaryJavaExpression::Type::gt:
-      return JVariant::Boolean(value1 > value2);
-
-    default:
-      DCHECK(false);  // Any other operations are not supported for booleans.
-      return INTERNAL_ERROR_MESSAGE;
-  }
+  return JVariant::Boolean(TOperation::Apply(value1, value2));
 }
 
 
@@ -19,6 +19,7 @@
 
 #include "common.h"
 #include "expression_evaluator.h"
+#include "expression_program.h"
 #include "java_expression.h"
 
 namespace devtools {
@@ -42,14 +43,24 @@ class BinaryExpressionEvaluator : public ExpressionEvaluator {
     return result_type_;
   }
 
-  Nullable<jvalue> GetStaticValue() const override {
-    return nullptr;
-  }
+  Nullable<jvalue> GetStaticValue() const override;
+
+  bool HasMethodCalls() const override;
+
+  int Lower(ExpressionProgramBuilder* builder) const override;
 
   ErrorOr<JVariant> Evaluate(
       const EvaluationContext& evaluation_context) const override;
 
  private:
+  // Selects the computer and the result type based on the operator and on
+  // the types of the compiled arguments.
+  bool CompileOperator(FormatMessageModel* error_message);
+
+  // Computes the value of the expression at compile time if both arguments
+  // are constant. Also simplifies "&&" and "||" with one constant argument.
+  void FoldConstants();
+
   // Implements "Compile" for arithmetical operators (+, -, *, /, %).
   bool CompileArithmetical(FormatMessageModel* error_message);
 
@@ -66,6 +77,13 @@ class BinaryExpressionEvaluator : public ExpressionEvaluator {
   // Implements "Compile" for shoft operators (<<, >>, >>>).
   bool CompileShift(FormatMessageModel* error_message);
 
+  // Maps the compiled operator to the instruction of "ExpressionProgram".
+  // Returns false if the program doesn't support the operator.
+  bool SelectProgramOpcode(ExpressionProgram::Opcode* opcode) const;
+
+  // Checks whether this is one of the shift operators (<<, >>, >>>).
+  bool IsShiftOperator() const;
+
   // Checks whether "arg1" or "arg2" are of the specified type.
   bool IsEitherType(JType type) const;
 
@@ -81,19 +99,51 @@ class BinaryExpressionEvaluator : public ExpressionEvaluator {
       std::unique_ptr<ExpressionEvaluator>* arg,
       FormatMessageModel* error_message);
 
-  // Computes the value of the expression for arithmetical operators. The
+  // Selects "ArithmeticComputer" or "DivisionComputer" for the operator.
+  // The template type "T" is the type that both arguments were promoted into.
+  template <typename T>
+  bool SelectArithmeticComputer();
+
+  // Selects "BitwiseComputer" for the operator. "T" is either jint or jlong.
+  template <typename T>
+  bool SelectBitwiseComputer();
+
+  // Selects "ShiftComputer" for the operator. "T" is the type of the shifted
+  // number and "TDistance" is the type of the shift distance.
+  template <typename T, typename TDistance>
+  bool SelectShiftComputer();
+
+  // Selects "ConditionalBooleanComputer" for the operator.
+  bool SelectBooleanComputer();
+
+  // Selects "NumericalComparisonComputer" for the operator. "T" is the type
+  // that both arguments were promoted into.
+  template <typename T>
+  bool SelectComparisonComputer();
+
+  // Computes the value of the expression for +, - and * operators. The
   // template type "T" is the type that both arguments were promoted into.
   // See Java Language Specification section 5.6.2 for more details.
-  template <typename T>
+  // "TOperation" is one of the operation kernels defined in the .cc file, so
+  // that each (operator, type) pair gets its own computer with no dispatch
+  // at evaluation time.
+  template <typename T, typename TOperation>
   ErrorOr<JVariant> ArithmeticComputer(
       const JVariant& arg1,
       const JVariant& arg2) const;
 
+  // Same as "ArithmeticComputer", but for / and % operators that need to
+  // check for division by zero and integer overflow.
+  template <typename T, typename TOperation>
+  ErrorOr<JVariant> DivisionComputer(
+      const JVariant& arg1,
+      const JVariant& arg2) const;
+
   // Computes the value of the expression for bitwise operators. This does not
   // include bitwise operators applied on booleans (which become conditional
   // operators). The template type "T" can be either jint or jlong as per
   // Java Language Specification section 15.22).
-  template <typename T>
+  template <typename T, typename TOperation>
   ErrorOr<JVariant> BitwiseComputer(
       const JVariant& arg1,
       const JVariant& arg2) const;
@@ -101,9 +151,8 @@ class BinaryExpressionEvaluator : public ExpressionEvaluator {
   // Computes the value of shift expression. The template type "T" denotes the
   // type of the first argument (the shifted number). As per Java Language
   // Specification section 15.19), "T" can only be jint or jlong. The type of
-  // the second argument is either int or long. "Bitmask" is applied to the
-  // second argument as per specifications (also section 15.19).
-  template <typename T, typename TUnsigned, uint16 Bitmask>
+  // the second argument "TDistance" is either jint or jlong.
+  template <typename T, typename TDistance, typename TOperation>
   ErrorOr<JVariant> ShiftComputer(
       const JVariant& arg1,
       const JVariant& arg2) const;
@@ -123,6 +172,7 @@ class BinaryExpressionEvaluator : public ExpressionEvaluator {
   // Specifications sections 15.23 and 15.24 logical operators && and || only
   // apply to boolean type. Comparison operators == and != can also apply to
   // boolean.
+  template <typename TOperation>
   ErrorOr<JVariant> ConditionalBooleanComputer(
       const JVariant& arg1,
       const JVariant& arg2) const;
@@ -130,7 +180,7 @@ class BinaryExpressionEvaluator : public ExpressionEvaluator {
   // Implements comparison operators for numerical types (i.e. not booleans).
   // As per Java Language Specifications section 15.20 the two arguments are
   // promoted to the same type and compared against each other.
-  template <typename T>
+  template <typename T, typename TOperation>
   ErrorOr<JVariant> NumericalComparisonComputer(
       const JVariant& arg1,
       const JVariant& arg2) const;
@@ -146,7 +196,8 @@ class BinaryExpressionEvaluator : public ExpressionEvaluator {
   std::unique_ptr<ExpressionEvaluator> arg2_;
 
   // Pointer to a member function of this class to do the actual evaluation
-  // of the binary expression.
+  // of the binary expression. It is specialized for both the operator and
+  // the promoted type of the arguments.
   ErrorOr<JVariant> (BinaryExpressionEvaluator::*computer_)(
       const JVariant&,
       const JVariant&) const;
@@ -155,6 +206,14 @@ class BinaryExpressionEvaluator : public ExpressionEvaluator {
   // computer_ is supposed product.
   JSignature result_type_;
 
+  // Value of the expression computed at compile time or void if the value
+  // is only known at runtime.
+  JVariant static_value_;
+
+  // Argument that the expression is reduced to (e.g. "x" in "true && x") or
+  // null if the expression was not simplified.
+  const ExpressionEvaluator* passthrough_ { nullptr };
+
   DISALLOW_COPY_AND_ASSIGN(BinaryExpressionEvaluator);
 };
 
@@ -17,12 +17,15 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_BREAKPOINT_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_BREAKPOINT_H_
 
+#include "breakpoint_counters.h"
 #include "common.h"
 #include "model.h"
 
 namespace devtools {
 namespace cdbg {
 
+class SharedCapture;
+
 // Single active breakpoint in Java code. A breakpoint can be in one of these
 // states:
 //   1. Uninitialized: this is the state the breakpoint gets right after the
@@ -58,6 +61,11 @@ class Breakpoint {
   // the breakpoint.
   virtual void Initialize() = 0;
 
+  // Gets the signature of the class containing the breakpoint location or
+  // empty string if the breakpoint location hasn't been resolved. The
+  // signature doesn't change once the location is resolved in "Initialize".
+  virtual string GetClassSignature() const = 0;
+
   // Invalidates the breakpoint state back to pending. Clears JVMTI breakpoint
   // as necessary.
   virtual void ResetToPending() = 0;
@@ -68,16 +76,27 @@ class Breakpoint {
       const string& type_name,
       const string& class_signature) = 0;
 
-  // Takes action on a hit over a single breakpoint.
+  // Activates a pending breakpoint whose class has been prepared. Called
+  // from an agent thread when "OnClassPrepared" deferred the activation
+  // through "BreakpointsManager::ScheduleBreakpointActivation".
+  virtual void ActivatePending() = 0;
+
+  // Takes action on a hit over a single breakpoint. If "shared_capture" is
+  // not nullptr, other breakpoints were hit at the same location and a
+  // snapshot breakpoint enlists there instead of capturing the data itself.
   virtual void OnJvmBreakpointHit(
       jthread thread,
       jmethodID method,
-      jlocation location) = 0;
+      jlocation location,
+      SharedCapture* shared_capture) = 0;
 
   // Finalizes the breakpoint with the specified status message and removes
   // it from the list of active breakpoints.
   virtual void CompleteBreakpointWithStatus(
       std::unique_ptr<StatusMessageModel> status) = 0;
+
+  // Gets the current values of the counters of breakpoint hits.
+  virtual BreakpointCounters::Snapshot GetCounters() const = 0;
 };
 
 }  // namespace cdbg
@@ -0,0 +1,126 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "breakpoint_counters.h"
+
+#include <stdio.h>
+#include <sstream>
+
+namespace devtools {
+namespace cdbg {
+
+// Names of the counters in "BreakpointCounters::Snapshot".
+static const struct {
+  const char* name;
+  int64 BreakpointCounters::Snapshot::*value;
+} kCounters[] = {
+  { "hits", &BreakpointCounters::Snapshot::hits },
+  { "condition_true", &BreakpointCounters::Snapshot::condition_true },
+  { "condition_false", &BreakpointCounters::Snapshot::condition_false },
+  { "condition_errors", &BreakpointCounters::Snapshot::condition_errors },
+  { "captures", &BreakpointCounters::Snapshot::captures },
+  { "logs", &BreakpointCounters::Snapshot::logs },
+  { "metrics", &BreakpointCounters::Snapshot::metrics },
+  { "quota_rejections", &BreakpointCounters::Snapshot::quota_rejections },
+  { "sampled_out", &BreakpointCounters::Snapshot::sampled_out },
+  { "drops", &BreakpointCounters::Snapshot::drops }
+};
+
+
+// Escapes a Prometheus label value.
+static string EscapeLabelValue(const string& value) {
+  string escaped;
+  escaped.reserve(value.size());
+  for (char c : value) {
+    switch (c) {
+      case '\\':
+        escaped += "\\\\";
+        break;
+
+      case '"':
+        escaped += "\\\"";
+        break;
+
+      case '\n':
+        escaped += "\\n";
+        break;
+
+      default:
+        escaped += c;
+        break;
+    }
+  }
+
+  return escaped;
+}
+
+
+string FormatBreakpointCounters(const BreakpointCounters::Snapshot& counters) {
+  std::ostringstream ss;
+  for (int i = 0; i < arraysize(kCounters); ++i) {
+    if (i > 0) {
+      ss << ", ";
+    }
+
+    ss << kCounters[i].name << " = " << counters.*kCounters[i].value;
+  }
+
+  return ss.str();
+}
+
+
+bool WriteBreakpointCountersFile(
+    const string& path,
+    const std::map<string, BreakpointCounters::Snapshot>& active_breakpoints,
+    const BreakpointCounters::Snapshot& total) {
+  std::ostringstream ss;
+  for (const auto& counter : kCounters) {
+    ss << "# TYPE cdbg_breakpoint_" << counter.name << "_total counter\n";
+    for (const auto& breakpoint : active_breakpoints) {
+      ss << "cdbg_breakpoint_" << counter.name << "_total{breakpoint_id=\""
+         << EscapeLabelValue(breakpoint.first) << "\"} "
+         << breakpoint.second.*counter.value << '\n';
+    }
+
+    ss << "# TYPE cdbg_agent_breakpoint_" << counter.name
+       << "_total counter\n";
+    ss << "cdbg_agent_breakpoint_" << counter.name << "_total "
+       << total.*counter.value << '\n';
+  }
+
+  const string content = ss.str();
+
+  // Write to a temporary file first, so that readers never see a partially
+  // written file.
+  const string temp_path = path + ".tmp";
+  FILE* file = fopen(temp_path.c_str(), "w");
+  if (file == nullptr) {
+    return false;
+  }
+
+  const bool is_written =
+      (fwrite(content.data(), 1, content.size(), file) == content.size());
+  if ((fclose(file) != 0) || !is_written) {
+    remove(temp_path.c_str());
+    return false;
+  }
+
+  return rename(temp_path.c_str(), path.c_str()) == 0;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,132 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_BREAKPOINT_COUNTERS_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_BREAKPOINT_COUNTERS_H_
+
+#include <atomic>
+#include <map>
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Counts what happened to the hits of a single breakpoint. This tells apart
+// a breakpoint that is never hit from one with a condition that is never
+// true and from one whose hits are rejected by quotas.
+//
+// The counters are relaxed atomics, so incrementing them on the breakpoint
+// hit path is cheap. Values read while the breakpoint is being hit are not
+// necessarily consistent with each other.
+struct BreakpointCounters {
+  // Values of the counters at some point in time.
+  struct Snapshot {
+    int64 hits { 0 };
+    int64 condition_true { 0 };
+    int64 condition_false { 0 };
+    int64 condition_errors { 0 };
+    int64 captures { 0 };
+    int64 logs { 0 };
+    int64 metrics { 0 };
+    int64 quota_rejections { 0 };
+    int64 sampled_out { 0 };
+    int64 drops { 0 };
+
+    // Adds the values of "other" to this snapshot.
+    void Add(const Snapshot& other) {
+      hits += other.hits;
+      condition_true += other.condition_true;
+      condition_false += other.condition_false;
+      condition_errors += other.condition_errors;
+      captures += other.captures;
+      logs += other.logs;
+      metrics += other.metrics;
+      quota_rejections += other.quota_rejections;
+      sampled_out += other.sampled_out;
+      drops += other.drops;
+    }
+  };
+
+  // Number of times the breakpoint was hit while active.
+  std::atomic<int64> hits { 0 };
+
+  // Number of condition evaluations that returned true and false.
+  std::atomic<int64> condition_true { 0 };
+  std::atomic<int64> condition_false { 0 };
+
+  // Number of condition evaluations that failed (these are counted as false
+  // as well).
+  std::atomic<int64> condition_errors { 0 };
+
+  // Number of snapshots captured, log statements issued and metric samples
+  // aggregated.
+  std::atomic<int64> captures { 0 };
+  std::atomic<int64> logs { 0 };
+  std::atomic<int64> metrics { 0 };
+
+  // Number of hits rejected by a cost limit, log quota or the agent CPU
+  // budget (including hits skipped by condition sampling).
+  std::atomic<int64> quota_rejections { 0 };
+
+  // Number of hits skipped by the hit count and thread predicates (see
+  // "HitFilter") and of log point hits skipped by log sampling.
+  std::atomic<int64> sampled_out { 0 };
+
+  // Number of breakpoint updates that were discarded because the format
+  // queue or the transmission backlog was full.
+  std::atomic<int64> drops { 0 };
+
+  // Increments one of the counters.
+  static void Increment(std::atomic<int64>* counter) {
+    counter->fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Reads all the counters.
+  Snapshot GetSnapshot() const {
+    Snapshot snapshot;
+    snapshot.hits = hits.load(std::memory_order_relaxed);
+    snapshot.condition_true = condition_true.load(std::memory_order_relaxed);
+    snapshot.condition_false = condition_false.load(std::memory_order_relaxed);
+    snapshot.condition_errors =
+        condition_errors.load(std::memory_order_relaxed);
+    snapshot.captures = captures.load(std::memory_order_relaxed);
+    snapshot.logs = logs.load(std::memory_order_relaxed);
+    snapshot.metrics = metrics.load(std::memory_order_relaxed);
+    snapshot.quota_rejections =
+        quota_rejections.load(std::memory_order_relaxed);
+    snapshot.sampled_out = sampled_out.load(std::memory_order_relaxed);
+    snapshot.drops = drops.load(std::memory_order_relaxed);
+    return snapshot;
+  }
+};
+
+// Formats the counters for logging.
+string FormatBreakpointCounters(const BreakpointCounters::Snapshot& counters);
+
+// Writes counters of the active breakpoints and the totals of all the
+// breakpoints since the agent started to "path" in Prometheus text
+// exposition format (e.g. to be picked up by the node exporter textfile
+// collector). The file is replaced atomically. Returns false on I/O error.
+bool WriteBreakpointCountersFile(
+    const string& path,
+    const std::map<string, BreakpointCounters::Snapshot>& active_breakpoints,
+    const BreakpointCounters::Snapshot& total);
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_BREAKPOINT_COUNTERS_H_
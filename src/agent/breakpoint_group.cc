@@ -0,0 +1,63 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "breakpoint_group.h"
+
+#include "breakpoint.h"
+#include "rate_limit.h"
+
+namespace devtools {
+namespace cdbg {
+
+BreakpointGroup::BreakpointGroup(string name)
+    : name_(std::move(name)),
+      condition_cost_limiter_(
+          CreatePerBreakpointCostLimiter(CostLimitType::BreakpointCondition)) {
+}
+
+
+BreakpointGroup::~BreakpointGroup() {
+}
+
+
+void BreakpointGroup::AddMember(std::weak_ptr<Breakpoint> breakpoint) {
+  MutexLock lock(&mu_);
+  members_.push_back(std::move(breakpoint));
+}
+
+
+bool BreakpointGroup::ClaimCapture() {
+  return !is_captured_.exchange(true);
+}
+
+
+std::vector<std::shared_ptr<Breakpoint>> BreakpointGroup::GetOtherMembers(
+    const string& breakpoint_id) {
+  std::vector<std::shared_ptr<Breakpoint>> other_members;
+
+  MutexLock lock(&mu_);
+  for (const std::weak_ptr<Breakpoint>& member : members_) {
+    std::shared_ptr<Breakpoint> breakpoint = member.lock();
+    if ((breakpoint != nullptr) && (breakpoint->id() != breakpoint_id)) {
+      other_members.push_back(std::move(breakpoint));
+    }
+  }
+
+  return other_members;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
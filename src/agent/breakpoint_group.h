@@ -0,0 +1,86 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_BREAKPOINT_GROUP_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_BREAKPOINT_GROUP_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "leaky_bucket.h"
+#include "common.h"
+#include "mutex.h"
+
+namespace devtools {
+namespace cdbg {
+
+class Breakpoint;
+
+// Breakpoints set on several nearby lines to catch a code path (see the
+// "cdbg.breakpoint_group" label). The members share a single condition cost
+// limit and a single capture: the first member to capture a snapshot
+// completes the other members. Conditions and watched expressions are still
+// compiled per member, since local variables differ between locations.
+//
+// This class is thread safe.
+class BreakpointGroup {
+ public:
+  explicit BreakpointGroup(string name);
+
+  ~BreakpointGroup();
+
+  // Gets the name of the group (the value of the breakpoint label).
+  const string& name() const { return name_; }
+
+  // Gets the condition cost limiter shared by all the members.
+  std::shared_ptr<LeakyBucket> condition_cost_limiter() const {
+    return condition_cost_limiter_;
+  }
+
+  // Adds a new member to the group.
+  void AddMember(std::weak_ptr<Breakpoint> breakpoint);
+
+  // Claims the capture of the group for the calling member. Returns false if
+  // another member already claimed it.
+  bool ClaimCapture();
+
+  // Gets the members other than "breakpoint_id" that are still alive.
+  std::vector<std::shared_ptr<Breakpoint>> GetOtherMembers(
+      const string& breakpoint_id);
+
+ private:
+  // Value of the breakpoint label.
+  const string name_;
+
+  // Condition cost limiter shared by all the members.
+  const std::shared_ptr<LeakyBucket> condition_cost_limiter_;
+
+  // Set once a member captured a snapshot.
+  std::atomic<bool> is_captured_ { false };
+
+  // Locks access to "members_".
+  Mutex mu_;
+
+  // Breakpoints in the group.
+  std::vector<std::weak_ptr<Breakpoint>> members_;
+
+  DISALLOW_COPY_AND_ASSIGN(BreakpointGroup);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_BREAKPOINT_GROUP_H_
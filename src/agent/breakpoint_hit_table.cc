@@ -0,0 +1,136 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "breakpoint_hit_table.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+
+namespace devtools {
+namespace cdbg {
+
+// Reader counter stripe assigned to the current thread (or -1 if not assigned
+// yet).
+static __thread int g_reader_stripe = -1;
+
+// Source of reader stripes for new threads.
+static std::atomic<int> g_next_reader_stripe { 0 };
+
+
+// Orders table entries by code location.
+static bool EntryLess(
+    const BreakpointHitTable::Entry& entry,
+    const std::pair<jmethodID, jlocation>& key) {
+  if (entry.method != key.first) {
+    return entry.method < key.first;
+  }
+
+  return entry.location < key.second;
+}
+
+
+BreakpointHitTable::BreakpointHitTable() {
+}
+
+
+BreakpointHitTable::~BreakpointHitTable() {
+  for (int i = 0; i < arraysize(tables_); ++i) {
+    WaitForReaders(i);
+  }
+}
+
+
+void BreakpointHitTable::Publish(std::vector<Entry> entries) {
+  std::sort(
+      entries.begin(),
+      entries.end(),
+      [] (const Entry& e1, const Entry& e2) {
+        return EntryLess(e1, std::make_pair(e2.method, e2.location));
+      });
+
+  const int previous = current_.load();
+  const int next = 1 - previous;
+
+  // Readers that picked up "next" before the last flip might still be
+  // looking at it.
+  WaitForReaders(next);
+  tables_[next] = std::move(entries);
+
+  current_.store(next);
+
+  // Release the previous version of the table, so that it doesn't keep
+  // completed breakpoints alive until the next call to "Publish".
+  WaitForReaders(previous);
+  tables_[previous].clear();
+}
+
+
+std::shared_ptr<const BreakpointHitTable::BreakpointsList>
+BreakpointHitTable::Find(jmethodID method, jlocation location) const {
+  const int stripe = GetReaderStripe();
+
+  while (true) {
+    const int index = current_.load();
+    std::atomic<int>& reader_count = readers_[index][stripe].count;
+
+    reader_count.fetch_add(1);
+
+    // "Publish" might have flipped the table between reading "current_" and
+    // announcing this reader. In this case the table at "index" might be
+    // getting modified right now.
+    if (current_.load() != index) {
+      reader_count.fetch_sub(1);
+      continue;
+    }
+
+    std::shared_ptr<const BreakpointsList> breakpoints;
+
+    const std::vector<Entry>& table = tables_[index];
+    const auto key = std::make_pair(method, location);
+    auto it = std::lower_bound(table.begin(), table.end(), key, EntryLess);
+    if ((it != table.end()) &&
+        (it->method == method) &&
+        (it->location == location)) {
+      breakpoints = it->breakpoints;
+    }
+
+    reader_count.fetch_sub(1);
+
+    return breakpoints;
+  }
+}
+
+
+void BreakpointHitTable::WaitForReaders(int index) const {
+  for (int stripe = 0; stripe < kReaderStripes; ++stripe) {
+    while (readers_[index][stripe].count.load() > 0) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+
+int BreakpointHitTable::GetReaderStripe() {
+  if (g_reader_stripe == -1) {
+    g_reader_stripe = g_next_reader_stripe.fetch_add(1) % kReaderStripes;
+  }
+
+  return g_reader_stripe;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
@@ -0,0 +1,104 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_BREAKPOINT_HIT_TABLE_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_BREAKPOINT_HIT_TABLE_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+class Breakpoint;
+
+// Read-mostly index of code locations with JVMTI breakpoints. The index is
+// consulted on every breakpoint hit and only changes when a breakpoint is set
+// or cleared.
+//
+// Lookups never take a lock and never allocate memory. The table keeps two
+// copies of the index. Readers use whichever copy is current and announce
+// their presence in a reader counter of that copy. "Publish" fills the other
+// copy (after waiting for stragglers that still read it from before), flips
+// the current copy and then waits for all readers of the old copy before
+// releasing it. The waiting is short because readers only do a binary search
+// and copy a single "std::shared_ptr".
+//
+// Reader counters are striped across cache lines to keep threads running on
+// different CPUs from bouncing the same cache line on every breakpoint hit.
+class BreakpointHitTable {
+ public:
+  // Immutable list of breakpoints set at the same code location.
+  typedef std::vector<std::shared_ptr<Breakpoint>> BreakpointsList;
+
+  // Single code location and all the breakpoints set at it.
+  struct Entry {
+    jmethodID method;
+    jlocation location;
+    std::shared_ptr<const BreakpointsList> breakpoints;
+  };
+
+  BreakpointHitTable();
+
+  ~BreakpointHitTable();
+
+  // Replaces the content of the table. "entries" doesn't need to be sorted.
+  // Calls to "Publish" must be serialized by the caller. Blocks (spinning)
+  // until all the readers of the previous version of the table are done.
+  void Publish(std::vector<Entry> entries);
+
+  // Finds all the breakpoints set at the specified code location. Returns
+  // nullptr if there are none. This function is lock free and can be called
+  // concurrently with "Publish".
+  std::shared_ptr<const BreakpointsList> Find(
+      jmethodID method,
+      jlocation location) const;
+
+ private:
+  // Number of reader counters per copy of the table.
+  static constexpr int kReaderStripes = 16;
+
+  // Reader counter padded to occupy its own cache line.
+  struct ReaderCounter {
+    std::atomic<int> count { 0 };
+    char padding[64 - sizeof(std::atomic<int>)];
+  };
+
+  // Blocks until there are no readers of the specified copy of the table.
+  void WaitForReaders(int index) const;
+
+  // Gets the reader counter stripe of the current thread.
+  static int GetReaderStripe();
+
+ private:
+  // Two copies of the index sorted by (method, location).
+  std::vector<Entry> tables_[2];
+
+  // Index of the copy in "tables_" that readers should use.
+  std::atomic<int> current_ { 0 };
+
+  // Number of threads currently reading each copy of the table.
+  mutable ReaderCounter readers_[2][kReaderStripes];
+
+  DISALLOW_COPY_AND_ASSIGN(BreakpointHitTable);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_BREAKPOINT_HIT_TABLE_H_
@@ -20,13 +20,17 @@
 #include <map>
 #include <memory>
 #include "leaky_bucket.h"
+#include "breakpoint_counters.h"
 #include "common.h"
+#include "sharded_leaky_bucket.h"
 
 namespace devtools {
 namespace cdbg {
 
 class BreakpointModel;
 class Breakpoint;
+class BreakpointGroup;
+class ClassMethodLines;
 
 // Manages list of active breakpoints and processes breakpoint hit events.
 // This class is thread safe.
@@ -45,6 +49,20 @@ class BreakpointsManager {
   virtual void SetActiveBreakpointsList(
       std::vector<std::unique_ptr<BreakpointModel>> breakpoints) = 0;
 
+  // Applies an incremental change to the list of active breakpoints. Has the
+  // same effect as "SetActiveBreakpointsList" with the previously listed
+  // breakpoints plus "added_breakpoints" minus "removed_breakpoint_ids". The
+  // caller is responsible for computing the change relative to the list it
+  // passed last time.
+  virtual void UpdateActiveBreakpointsList(
+      std::vector<std::unique_ptr<BreakpointModel>> added_breakpoints,
+      const std::vector<string>& removed_breakpoint_ids) = 0;
+
+  // Removes all the active breakpoints and forgets the completed ones, so
+  // that the next "SetActiveBreakpointsList" starts over as if this instance
+  // was just created.
+  virtual void RemoveAllBreakpoints() = 0;
+
   // Indicates that the specified Java method is no longer valid. The purpose
   // of this callback is to remove all references to the unloaded method. This
   // is needed because the value of jmethodID is no longer valid after
@@ -83,6 +101,25 @@ class BreakpointsManager {
       jlocation location,
       std::shared_ptr<Breakpoint> breakpoint) = 0;
 
+  // Gets the methods and line number tables of a loaded class. Breakpoints
+  // in the same class share the returned object, so the class is only
+  // scanned once while it stays loaded.
+  virtual std::shared_ptr<ClassMethodLines> GetClassMethodLines(
+      jclass cls,
+      const string& class_signature) = 0;
+
+  // Defers activation of a pending breakpoint (compilation of its
+  // expressions and setting the JVMTI breakpoint) to an agent thread, so that
+  // the application thread preparing the class isn't stalled. Returns false
+  // if there is no agent thread to activate the breakpoint, in which case the
+  // caller is expected to activate it synchronously.
+  virtual bool ScheduleBreakpointActivation(
+      std::shared_ptr<Breakpoint> breakpoint) = 0;
+
+  // Activates the breakpoints scheduled with "ScheduleBreakpointActivation".
+  // Called from the agent thread.
+  virtual void ActivateScheduledBreakpoints() = 0;
+
   // Removes the breakpoint from list of active breakpoints and clears the
   // breakpoint. It is possible that some other thread is currently handling
   // breakpoint hit for this breakpoint.
@@ -92,12 +129,29 @@ class BreakpointsManager {
   // all enabled breakpoints. The purpose of this counter is to prevent many
   // breakpoints from consuming too much CPU together (while each breakpoint
   // is within limits).
-  virtual LeakyBucket* GetGlobalConditionCostLimiter() = 0;
+  virtual ShardedLeakyBucket* GetGlobalConditionCostLimiter() = 0;
 
   // Gets the counter for total dynamic log entries spawn by all logging
   // breakpoints. The purpose of this counter is to prevent many breakpoints
   // from logging too much (while each logging breakpoint logs within limits).
   virtual LeakyBucket* GetGlobalDynamicLogLimiter() = 0;
+
+  // Gets the counter for total bytes of dynamic log messages of all logging
+  // breakpoints.
+  virtual LeakyBucket* GetGlobalDynamicLogBytesLimiter() = 0;
+
+  // Gets the group of breakpoints with the specified name (see
+  // "BreakpointGroup"), creating it if it doesn't exist. The group lives as
+  // long as any of its members.
+  virtual std::shared_ptr<BreakpointGroup> GetBreakpointGroup(
+      const string& name) = 0;
+
+  // Gets the hit counters of each active breakpoint and the total of the
+  // counters of all the breakpoints (including the completed ones) since the
+  // debugger started.
+  virtual void GetBreakpointCounters(
+      std::map<string, BreakpointCounters::Snapshot>* active_breakpoints,
+      BreakpointCounters::Snapshot* total) = 0;
 };
 
 }  // namespace cdbg
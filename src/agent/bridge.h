@@ -33,8 +33,17 @@ class Bridge {
  public:
   enum class HangingGetResult {
     SUCCESS,
+
+    // Transient failure (e.g. network error). The debuggee registration is
+    // still assumed to be valid.
     FAIL,
-    TIMEOUT
+
+    // No changes to the list of active breakpoints.
+    TIMEOUT,
+
+    // The backend no longer recognizes the debuggee, which needs to be
+    // registered again.
+    NOT_REGISTERED
   };
 
   virtual ~Bridge() { }
@@ -62,15 +71,20 @@ class Bridge {
   virtual void EnqueueBreakpointUpdate(
       std::unique_ptr<BreakpointModel> breakpoint) = 0;
 
-  // Attempts transmission of pending breakpoints. "HasPendingMessages"
-  // can be used to check whether all pending messages have been sent
-  // successfully.
+  // Attempts transmission of pending breakpoints. Pending updates are sent
+  // to the backend in batches. "HasPendingMessages" can be used to check
+  // whether all pending messages have been sent successfully.
   virtual void TransmitBreakpointUpdates() = 0;
 
   // Checks whether there are still pending messages to be transmitted to the
   // Hub service.
   virtual bool HasPendingMessages() const = 0;
 
+  // Checks whether breakpoint updates pile up faster than they can be
+  // transmitted, for example because the Hub service is not reachable. New
+  // breakpoint captures are not taken while this is true.
+  virtual bool IsTransmitBacklogged() const = 0;
+
   // Notifies the backend that a canary agent enabled the breakpoint.
   virtual bool RegisterBreakpointCanary(const string& breakpoint_id) = 0;
 
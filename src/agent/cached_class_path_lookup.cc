@@ -0,0 +1,230 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cached_class_path_lookup.h"
+
+#include "messages.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Extracts the file name without directory and extension from a source path
+// (e.g. "com/prod/MyClass.java" -> "MyClass").
+static string GetSourceFileStem(const string& source_path) {
+  size_t begin = source_path.find_last_of("/\\");
+  begin = (begin == string::npos) ? 0 : begin + 1;
+
+  size_t end = source_path.find('.', begin);
+  if (end == string::npos) {
+    end = source_path.size();
+  }
+
+  return source_path.substr(begin, end - begin);
+}
+
+
+// Splits the class name without the package from a class signature into
+// names of the outer class and of nested classes (e.g.
+// "Lcom/prod/MyClass$Inner;" -> [ "MyClass", "Inner" ]).
+static std::vector<string> GetClassNameComponents(
+    const string& class_signature) {
+  size_t begin = class_signature.find_last_of('/');
+  if (begin == string::npos) {
+    begin = (!class_signature.empty() && (class_signature[0] == 'L')) ? 1 : 0;
+  } else {
+    begin += 1;
+  }
+
+  size_t end = class_signature.find(';', begin);
+  if (end == string::npos) {
+    end = class_signature.size();
+  }
+
+  std::vector<string> components;
+  while (begin < end) {
+    size_t sep = class_signature.find('$', begin);
+    if ((sep == string::npos) || (sep > end)) {
+      sep = end;
+    }
+
+    components.push_back(class_signature.substr(begin, sep - begin));
+    begin = sep + 1;
+  }
+
+  return components;
+}
+
+
+// Gets the last component of a class name as it appears in an expression
+// (e.g. "com.prod.MyClass.Inner" -> "Inner").
+static string GetLastClassNameComponent(const string& class_name) {
+  size_t sep = class_name.find_last_of(".$");
+  if (sep == string::npos) {
+    return class_name;
+  }
+
+  return class_name.substr(sep + 1);
+}
+
+
+CachedClassPathLookup::CachedClassPathLookup(
+    ClassPathLookup* class_path_lookup,
+    int max_size,
+    int64 negative_ttl_ms)
+    : class_path_lookup_(class_path_lookup),
+      max_size_(max_size),
+      negative_ttl_ms_(negative_ttl_ms) {
+}
+
+
+void CachedClassPathLookup::ResolveSourceLocation(
+    const string& source_path,
+    int line_number,
+    ResolvedSourceLocation* location) {
+  const string stem = GetSourceFileStem(source_path);
+  const auto key = std::make_pair(source_path, line_number);
+
+  {
+    MutexLock lock(&mu_);
+
+    auto it = locations_.find(stem);
+    if (it != locations_.end()) {
+      auto it_location = it->second.find(key);
+      if (it_location != it->second.end()) {
+        *location = it_location->second;
+        return;
+      }
+    }
+  }
+
+  // "mu_" must not be held while calling into Java.
+  class_path_lookup_->ResolveSourceLocation(
+      source_path,
+      line_number,
+      location);
+
+  // Internal errors are transient, don't keep them around.
+  if ((max_size_ <= 0) ||
+      (location->error_message.format == INTERNAL_ERROR_MESSAGE.format)) {
+    return;
+  }
+
+  MutexLock lock(&mu_);
+
+  if (locations_size_ >= max_size_) {
+    locations_.clear();
+    locations_size_ = 0;
+  }
+
+  if (locations_[stem].insert({ key, *location }).second) {
+    ++locations_size_;
+  }
+}
+
+
+std::vector<string> CachedClassPathLookup::FindClassesByName(
+    const string& class_name) {
+  const string last_component = GetLastClassNameComponent(class_name);
+
+  {
+    MutexLock lock(&mu_);
+
+    auto it = class_names_.find(last_component);
+    if (it != class_names_.end()) {
+      auto it_entry = it->second.find(class_name);
+      if (it_entry != it->second.end()) {
+        const ClassNameEntry& entry = it_entry->second;
+        if (!entry.signatures.empty() ||
+            (clock_.GetElapsedMillis() - entry.time_ms < negative_ttl_ms_)) {
+          return entry.signatures;
+        }
+
+        it->second.erase(it_entry);
+        --class_names_size_;
+      }
+    }
+  }
+
+  // "mu_" must not be held while calling into Java.
+  std::vector<string> signatures =
+      class_path_lookup_->FindClassesByName(class_name);
+
+  if (max_size_ <= 0) {
+    return signatures;
+  }
+
+  MutexLock lock(&mu_);
+
+  if (class_names_size_ >= max_size_) {
+    class_names_.clear();
+    class_names_size_ = 0;
+  }
+
+  ClassNameEntry entry { signatures, clock_.GetElapsedMillis() };
+  if (class_names_[last_component].insert({ class_name, entry }).second) {
+    ++class_names_size_;
+  }
+
+  return signatures;
+}
+
+
+void CachedClassPathLookup::OnClassPrepared(
+    const string& type_name,
+    const string& class_signature) {
+  MutexLock lock(&mu_);
+  InvalidateClass(class_signature);
+}
+
+
+void CachedClassPathLookup::OnClassesPrepared(
+    const std::vector<std::pair<string, string>>& classes) {
+  MutexLock lock(&mu_);
+  for (const auto& cls : classes) {
+    InvalidateClass(cls.second);
+  }
+}
+
+
+void CachedClassPathLookup::InvalidateClass(const string& class_signature) {
+  if (locations_.empty() && class_names_.empty()) {
+    return;
+  }
+
+  const std::vector<string> components =
+      GetClassNameComponents(class_signature);
+  if (components.empty()) {
+    return;
+  }
+
+  auto it_location = locations_.find(components.front());
+  if (it_location != locations_.end()) {
+    locations_size_ -= it_location->second.size();
+    locations_.erase(it_location);
+  }
+
+  for (const string& component : components) {
+    auto it_class_name = class_names_.find(component);
+    if (it_class_name != class_names_.end()) {
+      class_names_size_ -= it_class_name->second.size();
+      class_names_.erase(it_class_name);
+    }
+  }
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
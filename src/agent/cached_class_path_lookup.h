@@ -0,0 +1,146 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_CACHED_CLASS_PATH_LOOKUP_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_CACHED_CLASS_PATH_LOOKUP_H_
+
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "class_path_lookup.h"
+#include "common.h"
+#include "mutex.h"
+#include "resolved_source_location.h"
+#include "stopwatch.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Decorates "ClassPathLookup" with caches of "ResolveSourceLocation" and
+// "FindClassesByName" results. Both functions call into Java and scan the
+// class path index. Resolving source locations is expensive when the same
+// list of breakpoints is applied again (e.g. after the connection to the hub
+// is restored). Class names are looked up each time an expression refers to
+// an unqualified class (e.g. "Math" or "MyEnum"), and many breakpoints share
+// the same references.
+//
+// The results only depend on the classes available to the application. The
+// cached results are therefore dropped when a potentially matching class is
+// prepared:
+//   1. Resolved source locations are grouped by the source file name. A new
+//      class "Lcom/prod/MyClass$Inner;" drops cached locations in
+//      "com/prod/MyClass.java" (and any other "MyClass.java").
+//   2. Class name lookups are grouped by the last component of the name. The
+//      same class drops cached lookups of "MyClass", "com.prod.MyClass",
+//      "Inner" and "MyClass.Inner".
+// Lookups of class names that were not found are additionally only kept for
+// a limited time.
+//
+// The number of entries is bounded. When a cache is full, it starts over.
+// Other methods of "ClassPathLookup" are forwarded without caching.
+//
+// This class is thread safe.
+class CachedClassPathLookup : public ClassPathLookup {
+ public:
+  // "class_path_lookup" is not owned by this class and must outlive it.
+  // "max_size" is the maximum number of entries in each of the caches.
+  // "negative_ttl_ms" is the time in milliseconds to keep lookups of class
+  // names that were not found.
+  CachedClassPathLookup(
+      ClassPathLookup* class_path_lookup,
+      int max_size,
+      int64 negative_ttl_ms);
+
+  void ResolveSourceLocation(
+      const string& source_path,
+      int line_number,
+      ResolvedSourceLocation* location) override;
+
+  std::vector<string> FindClassesByName(const string& class_name) override;
+
+  string ComputeDebuggeeUniquifier(const string& iv) override {
+    return class_path_lookup_->ComputeDebuggeeUniquifier(iv);
+  }
+
+  std::set<string> ReadApplicationResource(
+      const string& resource_path) override {
+    return class_path_lookup_->ReadApplicationResource(resource_path);
+  }
+
+  // Drops cached results that might be affected by a newly prepared class.
+  void OnClassPrepared(const string& type_name, const string& class_signature);
+
+  // Batched version of "OnClassPrepared".
+  void OnClassesPrepared(
+      const std::vector<std::pair<string, string>>& classes);
+
+ private:
+  // Cached result of "FindClassesByName".
+  struct ClassNameEntry {
+    // Signatures of the matching classes (empty if not found).
+    std::vector<string> signatures;
+
+    // Time (as measured by "clock_") when the entry was added.
+    int64 time_ms;
+  };
+
+  // Drops cached results that might be affected by "class_signature". Must
+  // be called with "mu_" held.
+  void InvalidateClass(const string& class_signature);
+
+ private:
+  // Underlying implementation of "ClassPathLookup".
+  ClassPathLookup* const class_path_lookup_;
+
+  // Maximum number of entries in each of the caches.
+  const int max_size_;
+
+  // Expiration time of class name lookups that were not found.
+  const int64 negative_ttl_ms_;
+
+  // Measures age of cached class name lookups.
+  const Stopwatch clock_;
+
+  // Locks access to all the data members below.
+  Mutex mu_;
+
+  // Cached resolved source locations grouped by the source file stem and
+  // then keyed by source path and line number. Grouping by the stem makes
+  // the invalidation on class prepare (a hot path) a single lookup.
+  std::unordered_map<
+      string,
+      std::map<std::pair<string, int>, ResolvedSourceLocation>> locations_;
+
+  // Total number of cached source locations in "locations_".
+  int locations_size_ = 0;
+
+  // Cached class name lookups grouped by the last component of the class
+  // name and then keyed by the class name.
+  std::unordered_map<
+      string,
+      std::unordered_map<string, ClassNameEntry>> class_names_;
+
+  // Total number of cached class name lookups in "class_names_".
+  int class_names_size_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(CachedClassPathLookup);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_CACHED_CLASS_PATH_LOOKUP_H_
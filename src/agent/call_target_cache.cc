@@ -0,0 +1,84 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "call_target_cache.h"
+
+namespace devtools {
+namespace cdbg {
+
+bool CallTargetCache::Find(
+    jobject object_cls,
+    int64 config_version,
+    MethodCallTarget* target) const {
+  MutexLock lock(&mu_);
+
+  for (const Entry& entry : entries_) {
+    if (entry.object_cls == nullptr) {
+      break;  // Entries are taken in order, the rest is unused.
+    }
+
+    if ((entry.config_version != config_version) ||
+        !jni()->IsSameObject(entry.object_cls.get(), object_cls)) {
+      continue;
+    }
+
+    target->method_cls = JniNewLocalRef(entry.method_cls.get());
+    target->method_cls_signature = entry.method_cls_signature;
+    target->object_cls = JniNewLocalRef(entry.object_cls.get());
+    target->object_cls_signature = entry.object_cls_signature;
+    target->method_config = entry.method_config;
+    target->config_version = entry.config_version;
+
+    return true;
+  }
+
+  return false;
+}
+
+
+void CallTargetCache::Update(const MethodCallTarget& target) {
+  JniGlobalRef method_cls = JniNewGlobalRef(target.method_cls.get());
+  JniGlobalRef object_cls = JniNewGlobalRef(target.object_cls.get());
+
+  MutexLock lock(&mu_);
+
+  // Reuse the entry of the same receiver class (cached with a stale
+  // configuration) or the first unused entry.
+  Entry* entry = nullptr;
+  for (Entry& candidate : entries_) {
+    if ((candidate.object_cls == nullptr) ||
+        jni()->IsSameObject(candidate.object_cls.get(), object_cls.get())) {
+      entry = &candidate;
+      break;
+    }
+  }
+
+  if (entry == nullptr) {
+    entry = &entries_[next_entry_];
+    next_entry_ = (next_entry_ + 1) % kMaxEntries;
+  }
+
+  entry->method_cls = std::move(method_cls);
+  entry->method_cls_signature = target.method_cls_signature;
+  entry->object_cls = std::move(object_cls);
+  entry->object_cls_signature = target.object_cls_signature;
+  entry->method_config = target.method_config;
+  entry->config_version = target.config_version;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
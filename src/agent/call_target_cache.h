@@ -0,0 +1,124 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_CALL_TARGET_CACHE_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_CALL_TARGET_CACHE_H_
+
+#include "common.h"
+#include "config.h"
+#include "jni_utils.h"
+#include "mutex.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Classes that play a role when calling a method.
+struct MethodCallTarget {
+  // Class that implemented the method to be executed.
+  JniLocalRef method_cls;
+
+  // Signature of "method_cls".
+  string method_cls_signature;
+
+  // The class returned by Java statement "obj.getClass()".
+  JniLocalRef object_cls;
+
+  // Signature of "object_cls".
+  string object_cls_signature;
+
+  // Policy of the method.
+  const Config::Method* method_config;
+
+  // Version of the configuration that "method_config" belongs to. The
+  // cached call target is stale if the configuration has been replaced
+  // since.
+  int64 config_version;
+};
+
+
+// Polymorphic inline cache of a single method call site in a compiled
+// expression or in an interpreted method. Resolving the call target of
+// "a.f()" takes a method lookup, two class signature queries and a method
+// policy lookup. All of these only depend on the class of "a", which rarely
+// changes between calls. The cache remembers the call targets for the last
+// few receiver classes (most call sites only ever see one) and reuses one
+// if the next receiver is of the same class (checked with "IsSameObject" on
+// the class reference). When all the entries are taken, the oldest one is
+// replaced.
+//
+// The cache keeps global references to the receiver classes, so the classes
+// will not be unloaded while the owner of the cache (e.g. compiled
+// breakpoint or cached class file) is alive.
+//
+// This class is thread safe.
+class CallTargetCache {
+ public:
+  CallTargetCache() { }
+
+  // Fills "target" with the cached call target if a recent call was made on
+  // an object of class "object_cls" with the configuration of
+  // "config_version". Returns false otherwise.
+  bool Find(
+      jobject object_cls,
+      int64 config_version,
+      MethodCallTarget* target) const;
+
+  // Adds the call target to the cache replacing the entry of the same
+  // receiver class or the oldest entry.
+  void Update(const MethodCallTarget& target);
+
+  // Marks the call site as having its arguments checked against the method
+  // signature at compile time. Must be called before the cache is shared
+  // with other threads.
+  void set_arguments_verified() { arguments_verified_ = true; }
+
+  // Returns true if the runtime check of the call arguments is redundant.
+  bool arguments_verified() const { return arguments_verified_; }
+
+ private:
+  // Maximum number of receiver classes cached per call site.
+  static constexpr int kMaxEntries = 4;
+
+  // Cached call target with global references instead of local ones.
+  struct Entry {
+    JniGlobalRef method_cls;
+    string method_cls_signature;
+    JniGlobalRef object_cls;
+    string object_cls_signature;
+    const Config::Method* method_config { nullptr };
+    int64 config_version { 0 };
+  };
+
+ private:
+  // Set by the owner of the call site during compilation. Immutable after.
+  bool arguments_verified_ { false };
+
+  // Locks access to the cached call targets.
+  mutable Mutex mu_;
+
+  // Cached call targets. Unused entries have null "object_cls".
+  Entry entries_[kMaxEntries];
+
+  // Index of the entry to replace next when all the entries are taken.
+  int next_entry_ { 0 };
+
+  DISALLOW_COPY_AND_ASSIGN(CallTargetCache);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_CALL_TARGET_CACHE_H_
@@ -23,6 +23,37 @@ namespace cdbg {
 
 static CallbacksMonitor* g_instance = nullptr;
 
+// Position in "CallbacksMonitor::slots_" where the current thread starts
+// looking for a free slot.
+static __thread int g_thread_slot_hint = -1;
+
+// Source of "g_thread_slot_hint" for new threads.
+static std::atomic<int> g_next_thread_slot_hint { 0 };
+
+// Slot owned by the current thread for "RegisterHotCall". The slot is given
+// back when the thread exits.
+struct ThreadOwnedSlot {
+  ~ThreadOwnedSlot() {
+    if ((slot != nullptr) && (monitor == g_instance)) {
+      monitor->ReleaseThreadSlot(slot);
+    }
+  }
+
+  // Instance of "CallbacksMonitor" that "slot" belongs to.
+  CallbacksMonitor* monitor = nullptr;
+
+  // Slot owned by the thread or nullptr if the thread couldn't claim any.
+  CallbacksMonitor::Slot* slot = nullptr;
+};
+
+static thread_local ThreadOwnedSlot g_thread_owned_slot;
+
+constexpr int64 CallbacksMonitor::kFreeSlot;
+constexpr int64 CallbacksMonitor::kIdleOwnedSlot;
+constexpr int CallbacksMonitor::kSlotsCount;
+constexpr int CallbacksMonitor::kMaxSlotProbes;
+constexpr int CallbacksMonitor::kMaxOwnedSlots;
+
 void CallbacksMonitor::InitializeSingleton(int max_interval_ms) {
   DCHECK(g_instance == nullptr);
 
@@ -49,27 +80,143 @@ int64 CallbacksMonitor::MonotonicClockMillis() {
 }
 
 
+// Initializes "g_thread_slot_hint" on the first call on the current thread.
+static int GetThreadSlotHint() {
+  if (g_thread_slot_hint < 0) {
+    g_thread_slot_hint = g_next_thread_slot_hint.fetch_add(
+        1,
+        std::memory_order_relaxed) % CallbacksMonitor::kSlotsCount;
+  }
+
+  return g_thread_slot_hint;
+}
+
+
 CallbacksMonitor::Id CallbacksMonitor::RegisterCall(const char* tag) {
-  OngoingCall ongoing_call { GetCurrentTimeMillis(), tag };
+  const int64 start_time_ms = GetCurrentTimeMillis();
+
+  // Usually the thread finds its own slot free and claims it right away.
+  // Nested calls and threads sharing the same starting position move on to
+  // the next slots.
+  GetThreadSlotHint();
+
+  for (int i = 0; i < kMaxSlotProbes; ++i) {
+    Slot* slot = &slots_[(g_thread_slot_hint + i) % kSlotsCount];
+    int64 expected = kFreeSlot;
+    if (slot->start_time_ms.compare_exchange_strong(
+            expected,
+            start_time_ms,
+            std::memory_order_relaxed)) {
+      slot->tag.store(tag, std::memory_order_relaxed);
+      return Id { slot, std::list<OngoingCall>::iterator(), false };
+    }
+  }
+
+  OngoingCall ongoing_call { start_time_ms, tag };
 
   std::lock_guard<std::mutex> lock(mu_);
-  return ongoing_calls_.insert(ongoing_calls_.begin(), ongoing_call);
+  return Id {
+    nullptr,
+    overflow_calls_.insert(overflow_calls_.begin(), ongoing_call),
+    false
+  };
+}
+
+
+CallbacksMonitor::Id CallbacksMonitor::RegisterHotCall(const char* tag) {
+  ThreadOwnedSlot& owned = g_thread_owned_slot;
+
+  // Claim a slot on the first call on this thread. This is the only atomic
+  // read-modify-write operation the thread does here (unless it fails to
+  // get a slot or makes nested calls).
+  if (owned.monitor != this) {
+    owned.monitor = this;
+    owned.slot = nullptr;
+
+    if (owned_slots_count_.fetch_add(1, std::memory_order_relaxed) <
+        kMaxOwnedSlots) {
+      const int hint = GetThreadSlotHint();
+      for (int i = 0; i < kSlotsCount; ++i) {
+        Slot* slot = &slots_[(hint + i) % kSlotsCount];
+        int64 expected = kFreeSlot;
+        if (slot->start_time_ms.compare_exchange_strong(
+                expected,
+                kIdleOwnedSlot,
+                std::memory_order_relaxed)) {
+          owned.slot = slot;
+          break;
+        }
+      }
+    }
+
+    if (owned.slot == nullptr) {
+      owned_slots_count_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+  Slot* slot = owned.slot;
+  Id id;
+  if ((slot != nullptr) &&
+      (slot->start_time_ms.load(std::memory_order_relaxed) ==
+       kIdleOwnedSlot)) {
+    slot->tag.store(tag, std::memory_order_relaxed);
+    slot->start_time_ms.store(
+        GetCurrentTimeMillis(),
+        std::memory_order_relaxed);
+    id = Id { slot, std::list<OngoingCall>::iterator(), true };
+  } else {
+    id = RegisterCall(tag);
+  }
+
+  // Pairs with the fence in "HasCallsStartedBy": either the other thread
+  // sees this call, or this call sees whatever the other thread unpublished
+  // before checking.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  return id;
+}
+
+
+void CallbacksMonitor::ReleaseThreadSlot(Slot* slot) {
+  slot->start_time_ms.store(kFreeSlot, std::memory_order_release);
+  owned_slots_count_.fetch_sub(1, std::memory_order_relaxed);
 }
 
 
 void CallbacksMonitor::CompleteCall(CallbacksMonitor::Id id) {
   int64 current_time_ms = GetCurrentTimeMillis();
 
+  if (id.slot != nullptr) {
+    CheckCallDuration(
+        id.slot->start_time_ms.load(std::memory_order_relaxed),
+        current_time_ms,
+        id.slot->tag.load(std::memory_order_relaxed));
+    id.slot->start_time_ms.store(
+        id.is_owned_slot ? kIdleOwnedSlot : kFreeSlot,
+        std::memory_order_release);
+    return;
+  }
+
   std::lock_guard<std::mutex> lock(mu_);
 
-  if (current_time_ms - id->start_time_ms > max_call_duration_ms_) {
-    LOG(INFO) << "Cloud Debugger call \"" << id->tag
-              << "\" completed after " << current_time_ms - id->start_time_ms
+  CheckCallDuration(
+      id.overflow->start_time_ms,
+      current_time_ms,
+      id.overflow->tag);
+  overflow_calls_.erase(id.overflow);
+}
+
+
+void CallbacksMonitor::CheckCallDuration(
+    int64 start_time_ms,
+    int64 current_time_ms,
+    const char* tag) {
+  if (current_time_ms - start_time_ms > max_call_duration_ms_) {
+    LOG(INFO) << "Cloud Debugger call \"" << tag
+              << "\" completed after " << current_time_ms - start_time_ms
               << " ms";
-    last_unhealthy_time_ms_ = current_time_ms;
+    last_unhealthy_time_ms_.store(current_time_ms, std::memory_order_relaxed);
   }
-
-  ongoing_calls_.erase(id);
 }
 
 
@@ -77,27 +224,70 @@ bool CallbacksMonitor::IsHealthy(int64 timestamp) const {
   bool rc = true;
   int64 current_time_ms = GetCurrentTimeMillis();
 
-  std::lock_guard<std::mutex> lock(mu_);
-
-  if (last_unhealthy_time_ms_ >= timestamp) {
+  const int64 last_unhealthy_time_ms =
+      last_unhealthy_time_ms_.load(std::memory_order_relaxed);
+  if (last_unhealthy_time_ms >= timestamp) {
     LOG(WARNING) << "Unhealthy callback completed "
-                 << current_time_ms - last_unhealthy_time_ms_ << " ms ago";
+                 << current_time_ms - last_unhealthy_time_ms << " ms ago";
     return false;
   }
 
-  for (auto it = ongoing_calls_.begin(); it != ongoing_calls_.end(); ++it) {
-    int64 duration_ms = current_time_ms - it->start_time_ms;
+  auto check_ongoing_call = [this, current_time_ms, &rc] (
+      int64 start_time_ms,
+      const char* tag) {
+    int64 duration_ms = current_time_ms - start_time_ms;
     if (duration_ms > max_call_duration_ms_) {
-      LOG(WARNING) << "Cloud Debugger call \"" << it->tag
+      LOG(WARNING) << "Cloud Debugger call \""
+                   << ((tag == nullptr) ? "unknown" : tag)
                    << "\" hasn't completed in " << duration_ms
                    << " ms, possibly stuck";
       rc = false;
     }
+  };
+
+  // The tag is stored right after the slot is claimed, so it might be
+  // momentarily stale. It's only used for logging.
+  for (const Slot& slot : slots_) {
+    int64 start_time_ms = slot.start_time_ms.load(std::memory_order_acquire);
+    if (start_time_ms > kIdleOwnedSlot) {
+      check_ongoing_call(
+          start_time_ms,
+          slot.tag.load(std::memory_order_relaxed));
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+
+  for (auto it = overflow_calls_.begin(); it != overflow_calls_.end(); ++it) {
+    check_ongoing_call(it->start_time_ms, it->tag);
   }
 
   return rc;
 }
 
+
+bool CallbacksMonitor::HasCallsStartedBy(int64 time_ms) const {
+  // Pairs with the fence in "RegisterHotCall".
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  for (const Slot& slot : slots_) {
+    int64 start_time_ms = slot.start_time_ms.load(std::memory_order_acquire);
+    if ((start_time_ms > kIdleOwnedSlot) && (start_time_ms <= time_ms)) {
+      return true;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+
+  for (const OngoingCall& call : overflow_calls_) {
+    if (call.start_time_ms <= time_ms) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 }  // namespace cdbg
 }  // namespace devtools
 
@@ -17,7 +17,9 @@
 #ifndef DEVTOOLS_CDBG_COMMON_CALLBACKS_MONITOR_H_
 #define DEVTOOLS_CDBG_COMMON_CALLBACKS_MONITOR_H_
 
+#include <atomic>
 #include <functional>
+#include <limits>
 #include <list>
 #include <mutex>  // NOLINT
 
@@ -31,6 +33,19 @@ namespace cdbg {
 // detected, the caller should declare the agent as unhealthy.
 //
 // The class is optimized for performance of registering/completing new calls.
+// Ongoing calls are kept in a fixed array of slots. Each thread starts
+// looking for a free slot at its own position in the array, so in the common
+// case registering a call is a single uncontended compare-and-swap and a
+// relaxed store, and completing it is a single store. Only "IsHealthy" scans
+// the whole array. Calls that don't find a free slot (too many concurrent or
+// nested calls) fall back to a linked list protected by a mutex.
+//
+// The hottest callbacks use "RegisterHotCall" instead. The first such call
+// on a thread claims a slot that the thread then owns until it exits. Later
+// calls on that thread only store into the owned slot, so they don't do any
+// atomic read-modify-write operations. Ongoing calls also serve as the
+// read-side critical sections for objects retired by other threads (see
+// "HasCallsStartedBy").
 class CallbacksMonitor {
  public:
   struct OngoingCall {
@@ -38,7 +53,47 @@ class CallbacksMonitor {
     const char* tag;
   };
 
-  typedef std::list<OngoingCall>::iterator Id;
+  // Slot of the array of ongoing calls. Slots are padded to a cache line to
+  // avoid false sharing between threads.
+  struct Slot {
+    // Start time of the call occupying the slot or "kFreeSlot".
+    std::atomic<int64> start_time_ms { kFreeSlot };
+
+    // Name of the call occupying the slot (only used for logging).
+    std::atomic<const char*> tag { nullptr };
+
+    char padding[64 - sizeof(std::atomic<int64>) -
+                 sizeof(std::atomic<const char*>)];
+  };
+
+  struct Id {
+    // Slot taken by the call or nullptr if the call is in "overflow_calls_".
+    Slot* slot;
+
+    // Position of the call in "overflow_calls_" if "slot" is nullptr.
+    std::list<OngoingCall>::iterator overflow;
+
+    // True if "slot" is owned by the thread that made the call.
+    bool is_owned_slot;
+  };
+
+  // Value of "Slot::start_time_ms" for slots not taken by any call.
+  static constexpr int64 kFreeSlot = std::numeric_limits<int64>::min();
+
+  // Value of "Slot::start_time_ms" for slots owned by a thread that is not
+  // in a call.
+  static constexpr int64 kIdleOwnedSlot = kFreeSlot + 1;
+
+  // Number of slots for ongoing calls.
+  static constexpr int kSlotsCount = 256;
+
+  // Maximum number of slots a call checks before falling back to
+  // "overflow_calls_".
+  static constexpr int kMaxSlotProbes = 8;
+
+  // Maximum number of slots owned by threads. The rest of "slots_" is left
+  // for "RegisterCall".
+  static constexpr int kMaxOwnedSlots = kSlotsCount / 2;
 
   CallbacksMonitor(
       int max_call_duration_ms,
@@ -49,7 +104,7 @@ class CallbacksMonitor {
   }
 
   ~CallbacksMonitor() {
-    DCHECK(ongoing_calls_.empty());
+    DCHECK(overflow_calls_.empty());
   }
 
   // One time initialization of the global instance.
@@ -68,9 +123,26 @@ class CallbacksMonitor {
   // name of this callback. It is only used for logging purposes.
   Id RegisterCall(const char* tag);
 
-  // Notifies completion of an operation started with "RegisterCall".
+  // Variant of "RegisterCall" for callbacks on the hottest paths. Uses the
+  // slot owned by the current thread (claiming it on the first call). Falls
+  // back to "RegisterCall" for nested calls and if the thread couldn't claim
+  // a slot. Unlike "RegisterCall", the registration is ordered before all
+  // the memory accesses that follow it.
+  Id RegisterHotCall(const char* tag);
+
+  // Notifies completion of an operation started with "RegisterCall" or
+  // "RegisterHotCall".
   void CompleteCall(Id id);
 
+  // Returns true if any of the ongoing calls started no later than
+  // "time_ms". An object that was unpublished before "time_ms" can be
+  // destroyed once this function returns false, because no callback
+  // registered with "RegisterHotCall" can still be using it.
+  bool HasCallsStartedBy(int64 time_ms) const;
+
+  // Releases the slot owned by the current thread. Called on thread exit.
+  void ReleaseThreadSlot(Slot* slot);
+
   // Returns true if there are no ongoing calls that already take more than
   // "max_interval_ms_" and that no completed call took more than
   // "max_interval_ms_" after "timestamp" time.
@@ -79,6 +151,20 @@ class CallbacksMonitor {
   // Returns the current time in milliseconds.
   static int64 MonotonicClockMillis();
 
+  // Gets the maximum allowed duration of the healthy callback.
+  int max_call_duration_ms() const { return max_call_duration_ms_; }
+
+  // Gets the number of slots currently owned by threads.
+  int owned_slots_count() const {
+    return owned_slots_count_.load(std::memory_order_relaxed);
+  }
+
+  // Gets the completion time of the last callback that took too long, or -1
+  // if there was none.
+  int64 last_unhealthy_time_ms() const {
+    return last_unhealthy_time_ms_.load(std::memory_order_relaxed);
+  }
+
  private:
   // Maximum allowed duration of the healthy callback.
   const int max_call_duration_ms_;
@@ -86,20 +172,52 @@ class CallbacksMonitor {
   // Function to get the current time. Defined explicitly for unit tests.
   std::function<int64()> fn_gettime_;
 
-  // Protects access to "ongoing_calls_" and "last_unhealthy_timestamp_".
+  // Logs and records the time of the unhealthy completion if a call that
+  // started at "start_time_ms" took longer than "max_call_duration_ms_".
+  void CheckCallDuration(
+      int64 start_time_ms,
+      int64 current_time_ms,
+      const char* tag);
+
+  // Currently active calls to monitor.
+  Slot slots_[kSlotsCount];
+
+  // Protects access to "overflow_calls_".
   mutable std::mutex mu_;
 
-  // Linked list of currently active calls to monitor.
-  std::list<OngoingCall> ongoing_calls_;
+  // Linked list of currently active calls that didn't fit into "slots_".
+  std::list<OngoingCall> overflow_calls_;
+
+  // Number of slots currently owned by threads.
+  std::atomic<int> owned_slots_count_ { 0 };
 
   // Timestamp of the completion of last callback that lasted more than
   // "max_interval_ms_".
-  int64 last_unhealthy_time_ms_;
+  std::atomic<int64> last_unhealthy_time_ms_;
 
   DISALLOW_COPY_AND_ASSIGN(CallbacksMonitor);
 };
 
 
+// Automatically calls "RegisterHotCall", "CompleteCall" on entry and scope
+// exit.
+class ScopedHotMonitoredCall {
+ public:
+  explicit ScopedHotMonitoredCall(const char* tag)
+      : id_(CallbacksMonitor::GetInstance()->RegisterHotCall(tag)) {
+  }
+
+  ~ScopedHotMonitoredCall() {
+    CallbacksMonitor::GetInstance()->CompleteCall(id_);
+  }
+
+ private:
+  const CallbacksMonitor::Id id_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedHotMonitoredCall);
+};
+
+
 // Automatically calls "RegisterCall", "CompleteCall" on entry and scope exit.
 class ScopedMonitoredCall {
  public:
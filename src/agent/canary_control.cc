@@ -16,6 +16,8 @@
 
 #include "canary_control.h"
 
+#include <algorithm>
+#include <limits>
 #include "messages.h"
 #include "model_util.h"
 
@@ -26,10 +28,15 @@ namespace cdbg {
 // failing the operation.
 static constexpr int kMaxAttempts = 3;
 
-// The "ApproveHealtyBreakpoints" method is called from worker thread every
-// cycle of "ListActiveBreakpoints", which is once every 40 seconds. The
-// constant of 35 seconds is deliberately a bit shorter than that so that the
-// canary period fits in one such cycle.
+// Delay before trying again to approve a canary breakpoint after all the
+// attempts failed.
+static constexpr int64 kApprovalRetryDelayMs = 10000;
+
+// The "ApproveHealtyBreakpoints" method is called from the transmission
+// thread as soon as the earliest canary breakpoint has spent this long in
+// canary (see "GetApprovalDelayMs"). The default of 35 seconds used to be a
+// bit shorter than a cycle of "ListActiveBreakpoints" (40 seconds), which
+// used to drive the approvals.
 DEFINE_int32(
     min_canary_duration_ms,
     35000,
@@ -39,63 +46,140 @@ DEFINE_int32(
 
 CanaryControl::CanaryControl(
     CallbacksMonitor* callbacks_monitor,
-    Bridge* bridge)
+    Bridge* bridge,
+    std::function<void()> fn_registration_pending /* = nullptr */)
     : callbacks_monitor_(callbacks_monitor),
-      bridge_(bridge) {
+      bridge_(bridge),
+      fn_registration_pending_(fn_registration_pending) {
 }
 
 
 bool CanaryControl::RegisterBreakpointCanary(
     const string& breakpoint_id,
-    std::function<void(std::unique_ptr<StatusMessageModel>)> fn_complete) {
-  int64 current_timestamp_ms = callbacks_monitor_->GetCurrentTimeMillis();
-
+    std::function<void(std::unique_ptr<StatusMessageModel>)> fn_complete,
+    RegistrationCallback fn_registered) {
   {
     MutexLock lock(&mu_);
     // Fail if already in canary.
-    if (canary_breakpoints_.find(breakpoint_id) != canary_breakpoints_.end()) {
+    if ((canary_breakpoints_.find(breakpoint_id) !=
+         canary_breakpoints_.end()) ||
+        (pending_breakpoints_.find(breakpoint_id) !=
+         pending_breakpoints_.end())) {
       LOG(ERROR) << "Breakpoint " << breakpoint_id
                  << " already registered for canary";
       DCHECK(false);
       return false;
     }
 
-    // Optimistically mark the breakpoint as if in canary. We don't want to
-    // keep the mutex locked throughout the call to the backend.
-    canary_breakpoints_[breakpoint_id] = { current_timestamp_ms, fn_complete };
+    pending_breakpoints_[breakpoint_id] =
+        { std::move(fn_complete), std::move(fn_registered) };
+  }
+
+  if (fn_registration_pending_ != nullptr) {
+    fn_registration_pending_();
   }
 
-  for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
-    if (bridge_->RegisterBreakpointCanary(breakpoint_id)) {
-      return true;
+  return true;
+}
+
+
+void CanaryControl::RegisterPendingBreakpoints() {
+  std::vector<string> pending_ids;
+  {
+    MutexLock lock(&mu_);
+    if (pending_breakpoints_.empty()) {
+      return;
+    }
+
+    pending_ids.reserve(pending_breakpoints_.size());
+    for (const auto& entry : pending_breakpoints_) {
+      pending_ids.push_back(entry.first);
     }
   }
 
-  // Roll back the marking that the breakpoint is in canary.
-  MutexLock lock(&mu_);
-  canary_breakpoints_.erase(breakpoint_id);
+  // The breakpoints stay in "pending_breakpoints_" throughout the calls to
+  // the backend, so that a breakpoint completed in the meantime is not put
+  // into canary.
+  std::vector<bool> registered(pending_ids.size(), false);
+  for (int i = 0; i < pending_ids.size(); ++i) {
+    for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+      if (bridge_->RegisterBreakpointCanary(pending_ids[i])) {
+        registered[i] = true;
+        break;
+      }
+    }
+  }
+
+  std::vector<std::pair<RegistrationCallback, bool>> callbacks;
+  callbacks.reserve(pending_ids.size());
+  {
+    int64 current_timestamp_ms = callbacks_monitor_->GetCurrentTimeMillis();
+
+    MutexLock lock(&mu_);
+    for (int i = 0; i < pending_ids.size(); ++i) {
+      auto it = pending_breakpoints_.find(pending_ids[i]);
+      if (it == pending_breakpoints_.end()) {
+        continue;  // The breakpoint was completed.
+      }
 
-  return false;
+      if (registered[i]) {
+        canary_breakpoints_[pending_ids[i]] = {
+          current_timestamp_ms,
+          std::move(it->second.fn_complete),
+          current_timestamp_ms + FLAGS_min_canary_duration_ms
+        };
+      }
+
+      callbacks.push_back(
+          std::make_pair(std::move(it->second.fn_registered), registered[i]));
+      pending_breakpoints_.erase(it);
+    }
+  }
+
+  // The callbacks activate the breakpoints, which may call back into this
+  // class.
+  for (const auto& callback : callbacks) {
+    callback.first(callback.second);
+  }
 }
 
 
 void CanaryControl::BreakpointCompleted(const string& breakpoint_id) {
   MutexLock lock(&mu_);
   canary_breakpoints_.erase(breakpoint_id);
+  pending_breakpoints_.erase(breakpoint_id);
+}
+
+
+int64 CanaryControl::GetApprovalDelayMs() {
+  MutexLock lock(&mu_);
+
+  if (canary_breakpoints_.empty()) {
+    return -1;
+  }
+
+  int64 earliest_approval_time = std::numeric_limits<int64>::max();
+  for (const auto& entry : canary_breakpoints_) {
+    earliest_approval_time =
+        std::min(earliest_approval_time, entry.second.approval_time);
+  }
+
+  const int64 delay_ms =
+      earliest_approval_time - callbacks_monitor_->GetCurrentTimeMillis();
+
+  return std::max<int64>(delay_ms, 0);
 }
 
 
 void CanaryControl::ApproveHealtyBreakpoints() {
   // Choose breakpoints that can be approved.
   std::vector<string> healthy_ids;
-  std::map<string, CanaryBreakpoint> unhealthy_ids;
+  std::unordered_map<string, CanaryBreakpoint> unhealthy_ids;
+  const int64 current_timestamp_ms = callbacks_monitor_->GetCurrentTimeMillis();
   {
-    int64 current_timestamp_ms = callbacks_monitor_->GetCurrentTimeMillis();
-    int64 cutoff = current_timestamp_ms - FLAGS_min_canary_duration_ms;
-
     MutexLock lock(&mu_);
     for (const auto& entry : canary_breakpoints_) {
-      if (entry.second.register_time > cutoff) {
+      if (entry.second.approval_time > current_timestamp_ms) {
         continue;  // The breakpoint hasn't spent enough time in canary.
       }
 
@@ -115,14 +199,22 @@ void CanaryControl::ApproveHealtyBreakpoints() {
   // Try to approve the breakpoints.
   std::vector<string> approved_ids;
   approved_ids.reserve(healthy_ids.size());
+  std::vector<string> failed_ids;
 
   for (const string& breakpoint_id : healthy_ids) {
+    bool is_approved = false;
     for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
       if (bridge_->ApproveBreakpointCanary(breakpoint_id)) {
-        approved_ids.push_back(breakpoint_id);
+        is_approved = true;
         break;
       }
     }
+
+    if (is_approved) {
+      approved_ids.push_back(breakpoint_id);
+    } else {
+      failed_ids.push_back(breakpoint_id);
+    }
   }
 
   // Complete unhealthy breakpoints.
@@ -140,6 +232,14 @@ void CanaryControl::ApproveHealtyBreakpoints() {
     canary_breakpoints_.erase(breakpoint_id);
   }
 
+  // Try again later rather than right away on the next call.
+  for (const string& breakpoint_id : failed_ids) {
+    auto it = canary_breakpoints_.find(breakpoint_id);
+    if (it != canary_breakpoints_.end()) {
+      it->second.approval_time = current_timestamp_ms + kApprovalRetryDelayMs;
+    }
+  }
+
   // We may have some unhealthy breakpoints. They have are now completed, and
   // "JvmBreakpointsManager" will call "BreakpointCompleted", so we don't
   // really have to erase them from "canary_breakpoints_". We still do it
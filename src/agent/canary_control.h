@@ -18,7 +18,7 @@
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_CANARY_CONTROL_H_
 
 #include <functional>
-#include <map>
+#include <unordered_map>
 #include "callbacks_monitor.h"
 #include "bridge.h"
 #include "common.h"
@@ -29,18 +29,42 @@ namespace devtools {
 namespace cdbg {
 
 // Keeps track of canary breakpoints and approves them as necessary.
+//
+// Registration of a canary breakpoint with the backend is asynchronous.
+// "RegisterBreakpointCanary" only queues the breakpoint. The queued
+// breakpoints are registered together by "RegisterPendingBreakpoints" on
+// the transmission thread, so that setting many canary breakpoints doesn't
+// block the list of active breakpoints on backend round trips.
+//
 // This class is thread safe.
 class CanaryControl {
  public:
-  CanaryControl(CallbacksMonitor* callbacks_monitor, Bridge* bridge);
-
-  // Tries to register the breakpoint for canary. Returns false on failure.
-  // The caller must not activate the breakpoint until this call succeeds.
+  // Invoked once the canary registration of a breakpoint is done. The
+  // argument is true if the registration succeeded.
+  typedef std::function<void(bool)> RegistrationCallback;
+
+  // "fn_registration_pending" is invoked (without any locks held) every
+  // time a new breakpoint is queued for registration. It should wake up
+  // the thread calling "RegisterPendingBreakpoints".
+  CanaryControl(
+      CallbacksMonitor* callbacks_monitor,
+      Bridge* bridge,
+      std::function<void()> fn_registration_pending = nullptr);
+
+  // Queues the breakpoint for canary registration. Returns false if the
+  // breakpoint is already in canary. The caller must not activate the
+  // breakpoint until "fn_registered" is invoked with true.
   // The "fn_complete" argument is a function that will finalize and complete
   // the breakpoint (used when the breakpoint is determined to be unhealthy).
+  // "fn_registered" is not invoked if the breakpoint is completed first.
   bool RegisterBreakpointCanary(
       const string& breakpoint_id,
-      std::function<void(std::unique_ptr<StatusMessageModel>)> fn_complete);
+      std::function<void(std::unique_ptr<StatusMessageModel>)> fn_complete,
+      RegistrationCallback fn_registered);
+
+  // Registers all the queued breakpoints with the backend and invokes their
+  // "fn_registered" callbacks. Called from the transmission thread.
+  void RegisterPendingBreakpoints();
 
   // Indicates that the breakpoint has been finalized. This automatically
   // takes out the breakpoint from a canary.
@@ -50,6 +74,10 @@ class CanaryControl {
   // the necessary period of time and the debuglet asserted to be harmless.
   void ApproveHealtyBreakpoints();
 
+  // Gets the time in milliseconds until the earliest canary breakpoint is
+  // due for "ApproveHealtyBreakpoints" or -1 if there are none.
+  int64 GetApprovalDelayMs();
+
  private:
   struct CanaryBreakpoint {
     // Time (in milliseconds) when the breakpoint was registered for canary.
@@ -57,6 +85,18 @@ class CanaryControl {
 
     // Callback to complete the breakpoint with the specified status.
     std::function<void(std::unique_ptr<StatusMessageModel>)> fn_complete;
+
+    // Time (in milliseconds) when the breakpoint is due for approval.
+    // Postponed if the approval fails.
+    int64 approval_time;
+  };
+
+  struct PendingBreakpoint {
+    // Callback to complete the breakpoint with the specified status.
+    std::function<void(std::unique_ptr<StatusMessageModel>)> fn_complete;
+
+    // Callback invoked once the registration is done.
+    RegistrationCallback fn_registered;
   };
 
   // Monitors all callbacks into the agent to detect those that may be stuck.
@@ -66,11 +106,18 @@ class CanaryControl {
   // "ApproveBreakpointCanary" on the backend.
   Bridge* const bridge_;
 
+  // Wakes up the thread calling "RegisterPendingBreakpoints" (may be null).
+  const std::function<void()> fn_registration_pending_;
+
   // Locks access to all breakpoint related data structures.
   Mutex mu_;
 
   // List of breakpoints currently in canary. The key is the breakpoint ID.
-  std::map<string, CanaryBreakpoint> canary_breakpoints_;
+  std::unordered_map<string, CanaryBreakpoint> canary_breakpoints_;
+
+  // Breakpoints waiting for "RegisterPendingBreakpoints". The key is the
+  // breakpoint ID.
+  std::unordered_map<string, PendingBreakpoint> pending_breakpoints_;
 
   DISALLOW_COPY_AND_ASSIGN(CanaryControl);
 };
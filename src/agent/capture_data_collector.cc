@@ -17,142 +17,664 @@
 #include "capture_data_collector.h"
 
 #include <algorithm>
+#include <unordered_map>
+#include "compiled_method_filter.h"
 #include "eval_call_stack.h"
 #include "expression_evaluator.h"
 #include "expression_util.h"
+#include "jvm_eval_call_stack.h"
+#include "jvm_local_variable_reader.h"
 #include "local_variable_reader.h"
+#include "memory_budget.h"
 #include "messages.h"
 #include "method_locals.h"
 #include "model_util.h"
 #include "object_evaluator.h"
+#include "statistician.h"
+#include "stopwatch.h"
 #include "value_formatter.h"
 
+DEFINE_bool(
+    enable_deferred_object_capture,
+    false,
+    "Capture only call stack, local variables and watched expressions "
+    "while the thread is paused on a breakpoint and explore referenced "
+    "objects on the worker thread instead");
+
+DEFINE_bool(
+    enable_lazy_locals_capture,
+    false,
+    "Read values of local variables only in the top call frame, where "
+    "watched expressions are evaluated. Deeper frames only list names and "
+    "types of their local variables (same as "
+    "--locals_capture_frames=top)");
+
+DEFINE_string(
+    locals_capture_frames,
+    "all",
+    "call frames in which values of local variables are read: \"all\" "
+    "frames up to the locals depth limit, only the \"top\" frame or only "
+    "\"interpreted\" frames (the top frame and frames of methods without "
+    "JIT compiled code); reading locals of a compiled frame forces the JVM "
+    "to deoptimize it");
+
+DEFINE_bool(
+    enable_string_value_deduplication,
+    false,
+    "Send long string values that appear multiple times in a snapshot only "
+    "once, as a shared entry in the variable table");
+
+DEFINE_int32(
+    cdbg_capture_expansion_time_budget_us,
+    0,
+    "maximum time in microseconds spent exploring objects referenced by "
+    "local variables and watched expressions of a snapshot (including "
+    "pretty printers); objects not explored in time are reported as not "
+    "captured; 0 for no limit (the size limit still applies)");
+
+DEFINE_int32(
+    max_thread_dump_threads,
+    100,
+    "maximum number of threads whose call stacks are reported by a "
+    "snapshot breakpoint with the \"cdbg.thread_dump\" label");
+
 namespace devtools {
 namespace cdbg {
 
-CaptureDataCollector::CaptureDataCollector(JvmEvaluators* evaluators)
-    : evaluators_(evaluators) {
+// Initial capacity of the JNI local frame used to evaluate a single memory
+// object. Large enough for members of most objects. The JVM grows the frame
+// if needed.
+static constexpr int kMemoryObjectLocalFrameCapacity = 64;
+
+// Strings shorter than this are always formatted inline. Referencing a
+// variable table entry wouldn't make the message smaller.
+static constexpr size_t kMinDeduplicatedStringLength = 64;
+
+// Formats the Java state ("java.lang.Thread.State") of a thread.
+static const char* FormatThreadState(jint state) {
+  switch (state & JVMTI_JAVA_LANG_THREAD_STATE_MASK) {
+    case JVMTI_JAVA_LANG_THREAD_STATE_NEW:
+      return "NEW";
+
+    case JVMTI_JAVA_LANG_THREAD_STATE_TERMINATED:
+      return "TERMINATED";
+
+    case JVMTI_JAVA_LANG_THREAD_STATE_RUNNABLE:
+      return "RUNNABLE";
+
+    case JVMTI_JAVA_LANG_THREAD_STATE_BLOCKED:
+      return "BLOCKED";
+
+    case JVMTI_JAVA_LANG_THREAD_STATE_WAITING:
+      return "WAITING";
+
+    case JVMTI_JAVA_LANG_THREAD_STATE_TIMED_WAITING:
+      return "TIMED_WAITING";
+  }
+
+  return "UNKNOWN";
+}
+
+// Call frames in which values of local variables are read.
+enum class LocalsCaptureFrames {
+  ALL,
+  TOP,
+  INTERPRETED
+};
+
+// Parses --locals_capture_frames. Unrecognized values read all the frames.
+static LocalsCaptureFrames GetLocalsCaptureFrames() {
+  if (FLAGS_enable_lazy_locals_capture ||
+      (FLAGS_locals_capture_frames == "top")) {
+    return LocalsCaptureFrames::TOP;
+  }
+
+  if (FLAGS_locals_capture_frames == "interpreted") {
+    return LocalsCaptureFrames::INTERPRETED;
+  }
+
+  LOG_IF(WARNING, FLAGS_locals_capture_frames != "all")
+      << "Unrecognized --locals_capture_frames value: "
+      << FLAGS_locals_capture_frames;
+
+  return LocalsCaptureFrames::ALL;
+}
+
+// Appends variables to "FlatVariableTableModel". Names and types repeat a
+// lot (e.g. field names of objects of the same class), so each distinct one
+// is stored only once.
+class FlatVariableTableWriter {
+ public:
+  explicit FlatVariableTableWriter(FlatVariableTableModel* table)
+      : table_(table) {
+  }
+
+  FlatVariableTableModel* table() const { return table_; }
+
+  // Adds the string to the table unless it is already there.
+  FlatVariableTableModel::StringRef Intern(const string& str) {
+    if (str.empty()) {
+      return FlatVariableTableModel::StringRef();
+    }
+
+    auto it = interned_.find(str);
+    if (it != interned_.end()) {
+      return it->second;
+    }
+
+    FlatVariableTableModel::StringRef ref = table_->AddString(str);
+    interned_.emplace(str, ref);
+
+    return ref;
+  }
+
+  // Adds the status message and returns its index.
+  int32 AddStatus(const StatusMessageModel& status) {
+    table_->statuses.push_back(status);
+    return table_->statuses.size() - 1;
+  }
+
+  // Formats the value and the type of "source" into "target".
+  void FormatValue(
+      const NamedJVariant& source,
+      const ValueFormatter::Options& options,
+      FlatVariableTableModel::Variable* target) {
+    ValueFormatter::Format(source, options, &value_, &type_);
+
+    target->has_value = true;
+    target->value = table_->AddString(value_);
+    target->type = Intern(type_);
+  }
+
+ private:
+  // Table receiving the variables. Not owned by this class.
+  FlatVariableTableModel* const table_;
+
+  // Strings already added to the table by "Intern".
+  std::unordered_map<string, FlatVariableTableModel::StringRef> interned_;
+
+  // Buffers reused across "FormatValue" calls.
+  string value_;
+  string type_;
+
+  DISALLOW_COPY_AND_ASSIGN(FlatVariableTableWriter);
+};
+
+
+// Replaces repeated long string values in "breakpoint" with references to a
+// single variable table entry holding the value. Strings are immutable, so
+// two variables with the same formatted value show the same thing whether
+// or not they reference the same Java object.
+static void DeduplicateStringValues(
+    BreakpointModel* breakpoint,
+    FlatVariableTableModel* variable_table) {
+  typedef FlatVariableTableModel::StringRef StringRef;
+  typedef FlatVariableTableModel::Variable FlatVariable;
+
+  struct StringValue {
+    // First variable with this value. It is either a variable of a call
+    // frame or a member in the variable table (index in "variables").
+    VariableModel* first;
+    int32 first_member;
+
+    // Index of the shared variable table entry or -1 if the value has only
+    // been seen once so far.
+    int64 var_table_index;
+  };
+
+  std::unordered_map<string, StringValue> values;
+
+  // Adds the variable table entry holding the shared value.
+  auto add_entry = [variable_table] (StringRef value, StringRef type) {
+    FlatVariable entry;
+    entry.has_value = true;
+    entry.value = value;
+    entry.type = type;
+
+    const int64 var_table_index = variable_table->entries.size();
+    variable_table->entries.push_back(variable_table->variables.size());
+    variable_table->variables.push_back(entry);
+
+    return var_table_index;
+  };
+
+  // Creates the shared entry out of the first variable with the value.
+  auto share_first = [variable_table, &add_entry] (StringValue* value) {
+    if (value->first != nullptr) {
+      VariableModel* first = value->first;
+      value->var_table_index = add_entry(
+          variable_table->AddString(first->value.value()),
+          variable_table->AddString(first->type));
+
+      first->value.clear();
+      first->type.clear();
+      first->var_table_index = value->var_table_index;
+    } else {
+      FlatVariable* first = &variable_table->variables[value->first_member];
+      value->var_table_index = add_entry(first->value, first->type);
+
+      // "add_entry" may have reallocated "variables".
+      first = &variable_table->variables[value->first_member];
+      first->has_value = false;
+      first->value = StringRef();
+      first->type = StringRef();
+      first->var_table_index = value->var_table_index;
+    }
+  };
+
+  auto deduplicate = [&values, &share_first] (VariableModel* variable) {
+    if ((variable->type != "String") ||
+        !variable->value.has_value() ||
+        (variable->value.value().size() < kMinDeduplicatedStringLength) ||
+        variable->var_table_index.has_value() ||
+        (variable->status != nullptr)) {
+      return;
+    }
+
+    auto it = values.find(variable->value.value());
+    if (it == values.end()) {
+      values[variable->value.value()] = { variable, -1, -1 };
+      return;
+    }
+
+    StringValue& string_value = it->second;
+    if (string_value.var_table_index == -1) {
+      share_first(&string_value);
+    }
+
+    variable->value.clear();
+    variable->type.clear();
+    variable->var_table_index = string_value.var_table_index;
+  };
+
+  auto deduplicate_member =
+      [variable_table, &values, &share_first] (int32 index) {
+    const FlatVariable& variable = variable_table->variables[index];
+    if ((variable.type.length != 6) ||
+        (variable_table->strings.compare(
+            variable.type.offset,
+            variable.type.length,
+            "String") != 0) ||
+        !variable.has_value ||
+        (variable.value.length < kMinDeduplicatedStringLength) ||
+        (variable.var_table_index != -1) ||
+        (variable.status != -1)) {
+      return;
+    }
+
+    string value = variable_table->GetString(variable.value);
+    auto it = values.find(value);
+    if (it == values.end()) {
+      values[std::move(value)] = { nullptr, index, -1 };
+      return;
+    }
+
+    StringValue& string_value = it->second;
+    if (string_value.var_table_index == -1) {
+      share_first(&string_value);
+    }
+
+    FlatVariable* member = &variable_table->variables[index];
+    member->has_value = false;
+    member->value = StringRef();
+    member->type = StringRef();
+    member->var_table_index = string_value.var_table_index;
+  };
+
+  for (auto& frame : breakpoint->stack) {
+    for (auto& variable : frame->arguments) {
+      deduplicate(variable.get());
+    }
+
+    for (auto& variable : frame->locals) {
+      deduplicate(variable.get());
+    }
+  }
+
+  // The entries added to the variable table in the loop are not visited.
+  const int entries_count = variable_table->entries.size();
+  for (int i = 0; i < entries_count; ++i) {
+    const FlatVariable& entry =
+        variable_table->variables[variable_table->entries[i]];
+    const int32 first_member = entry.first_member;
+    const int32 members_count = entry.members_count;
+    for (int32 member = 0; member < members_count; ++member) {
+      deduplicate_member(first_member + member);
+    }
+  }
+}
+
+
+// Promotes the captured object references to global references, so that
+// they stay valid on the worker thread formatting the breakpoint. Short
+// strings are copied instead and don't need a global reference.
+static void PromoteToGlobalRef(NamedJVariant* variable) {
+  ValueFormatter::CaptureInlineString(variable);
+  variable->value.change_ref_type(JVariant::ReferenceKind::Global);
+}
+
+
+static void PromoteToGlobalRefs(std::vector<NamedJVariant>* variables) {
+  for (NamedJVariant& variable : *variables) {
+    PromoteToGlobalRef(&variable);
+  }
+}
+
+
+const CaptureLimits& GetCaptureLimits(
+    BreakpointModel::CaptureProfile capture_profile) {
+  static const CaptureLimits kDefaultLimits = {
+    kMaxStackDepth,
+    kMethodLocalsFrames,
+    kBreakpointMaxCaptureSize
+  };
+
+  // Short enough pause to leave the breakpoint on a hot path. Watched
+  // expressions are still evaluated, so the relevant data can be requested
+  // explicitly.
+  static const CaptureLimits kMinimalLimits = { 1, 1, 0 };
+
+  // First tier of a tiered capture. Walking the call stack is cheap compared
+  // to reading local variables (which may deoptimize compiled frames) and
+  // to exploring referenced objects (which runs pretty printers).
+  static const CaptureLimits kFirstTierLimits = { kMaxStackDepth, 1, 0 };
+
+  static const CaptureLimits kDeepLimits = {
+    kMaxStackDepth,
+    2 * kMethodLocalsFrames,
+    4 * kBreakpointMaxCaptureSize
+  };
+
+  switch (capture_profile) {
+    case BreakpointModel::CaptureProfile::DEFAULT:
+      return kDefaultLimits;
+
+    case BreakpointModel::CaptureProfile::MINIMAL:
+      return kMinimalLimits;
+
+    case BreakpointModel::CaptureProfile::DEEP:
+      return kDeepLimits;
+
+    case BreakpointModel::CaptureProfile::TIERED:
+      return kFirstTierLimits;
+  }
+
+  return kDefaultLimits;
+}
+
+
+CaptureDataCollector::CaptureDataCollector(
+    JvmEvaluators* evaluators,
+    BreakpointModel::CaptureProfile capture_profile)
+    : evaluators_(evaluators),
+      // Keep the pause and the pending update small while the agent is over
+      // its memory budget.
+      limits_(GetCaptureLimits(
+          MemoryBudget::GetInstance()->IsOverBudget()
+              ? BreakpointModel::CaptureProfile::MINIMAL
+              : capture_profile)),
+      call_frames_(ArenaAllocator<CallFrame>(&arena_)),
+      watch_results_(ArenaAllocator<EvaluatedExpression>(&arena_)),
+      memory_objects_(ArenaAllocator<MemoryObject>(&arena_)) {
   // Reserve "var_table_index" 0 for memory objects that we didn't capture
   // because collector ran out of quota.
   memory_objects_.push_back(MemoryObject());
-  ++memory_objects_size_;
 }
 
 
 CaptureDataCollector::~CaptureDataCollector() {
+  ChargeMemory(0);
 }
 
 
 void CaptureDataCollector::Collect(
     const std::vector<CompiledExpression>& watches,
+    SharedSubexpressionValues* shared_values,
+    jthread thread) {
+  CollectShared({ { string(), &watches, shared_values } }, thread);
+}
+
+
+void CaptureDataCollector::CollectShared(
+    const std::vector<BreakpointWatches>& breakpoints,
     jthread thread) {
+  DCHECK(!breakpoints.empty());
+  pending_releases_ = breakpoints.size();
+
   // Collect information about the local environment, but don't format it
   // at this point.
   breakpoint_labels_provider_ = evaluators_->labels_factory();
   breakpoint_labels_provider_->Collect();
 
-  std::unique_ptr<MethodCaller> pretty_printers_method_caller =
+  MethodCallerPtr pretty_printers_method_caller =
       evaluators_->method_caller_factory(Config::PRETTY_PRINTERS);
 
   // Walk the call stack.
   std::vector<EvalCallStack::JvmFrame> jvm_frames;
   evaluators_->eval_call_stack->Read(thread, &jvm_frames);
 
-  const int call_frames_count = jvm_frames.size();
+  const LocalsCaptureFrames capture_frames = GetLocalsCaptureFrames();
+
+  // Number of frames below the top one whose locals were read without
+  // knowing whether they run compiled code.
+  int deoptimized_frames_count = 0;
+
+  const int call_frames_count =
+      std::min<int>(jvm_frames.size(), limits_.max_stack_depth);
   call_frames_.resize(call_frames_count);
   for (int depth = 0; depth < call_frames_count; ++depth) {
-    call_frames_[depth].frame_info_key = jvm_frames[depth].frame_info_key;
+    call_frames_[depth].frame_info = jvm_frames[depth].frame_info;
 
     // Collect local variables.
-    if ((depth < kMethodLocalsFrames) &&
+    if ((depth < limits_.max_locals_frames) &&
         (jvm_frames[depth].code_location.method != nullptr)) {
       EvaluationContext evaluation_context;
       evaluation_context.thread = thread;
       evaluation_context.frame_depth = depth;
       evaluation_context.method_caller = pretty_printers_method_caller.get();
 
+      // The top frame is always interpreted (it's stopped on a breakpoint).
+      // Reading locals of any deeper frame that runs compiled code
+      // deoptimizes it.
+      const char* not_captured_message = nullptr;
+      if (depth > 0) {
+        if (capture_frames == LocalsCaptureFrames::TOP) {
+          not_captured_message = LocalVariableNotCaptured;
+        } else if (capture_frames == LocalsCaptureFrames::INTERPRETED) {
+          if (CompiledMethodFilter::MayContain(
+                  jvm_frames[depth].code_location.method)) {
+            not_captured_message = LocalVariableNotCapturedCompiled;
+          }
+        } else {
+          ++deoptimized_frames_count;
+        }
+      }
+
       ReadLocalVariables(
           evaluation_context,
           jvm_frames[depth].code_location.method,
           jvm_frames[depth].code_location.location,
+          not_captured_message,
           &call_frames_[depth].arguments,
           &call_frames_[depth].local_variables);
 
-      PostProcessVariables(call_frames_[depth].arguments);
-      PostProcessVariables(call_frames_[depth].local_variables);
+      PostProcessVariables(&call_frames_[depth].arguments);
+      PostProcessVariables(&call_frames_[depth].local_variables);
     }
   }
 
-  // Evaluate watched expressions.
-  watch_results_ = std::vector<EvaluatedExpression>(watches.size());
-  for (int i = 0; i < watches.size(); ++i) {
-    // Keep the original expression around so that we can populate variable
-    // name.
-    watch_results_[i].expression = watches[i].expression;
+  statCaptureDeoptimizedFrames->add(deoptimized_frames_count);
 
-    if (jvm_frames.size() > 0 &&
-        jvm_frames[0].code_location.method == nullptr) {
+  // Evaluate watched expressions of all the breakpoints.
+  int watches_count = 0;
+  for (const BreakpointWatches& item : breakpoints) {
+    watches_count += item.watches->size();
+  }
 
-      watch_results_[i].compile_error_message = {ExpressionSensitiveData, { }};
+  watch_results_.resize(watches_count);
+  int index = 0;
+  for (const BreakpointWatches& item : breakpoints) {
+    if (breakpoints.size() > 1) {
+      watch_ranges_[item.breakpoint_id] =
+          { index, static_cast<int>(item.watches->size()) };
+    }
 
-    } else if (watches[i].evaluator != nullptr) {
-      std::unique_ptr<MethodCaller> expression_method_caller =
-          evaluators_->method_caller_factory(Config::EXPRESSION_EVALUATION);
+    for (const CompiledExpression& watch : *item.watches) {
+      EvaluatedExpression& result = watch_results_[index++];
 
-      EvaluationContext evaluation_context;
-      evaluation_context.thread = thread;
-      evaluation_context.frame_depth = 0;
-      evaluation_context.method_caller = expression_method_caller.get();
+      // Keep the original expression around so that we can populate variable
+      // name.
+      result.expression = watch.expression;
 
-      EvaluateWatchedExpression(
-          evaluation_context,
-          *watches[i].evaluator,
-          &watch_results_[i].evaluation_result);
+      if (jvm_frames.size() > 0 &&
+          jvm_frames[0].code_location.method == nullptr) {
 
-      PostProcessVariable(watch_results_[i].evaluation_result);
-    } else {
-      watch_results_[i].compile_error_message = watches[i].error_message;
+        result.compile_error_message = {ExpressionSensitiveData, { }};
+
+      } else if (watch.evaluator != nullptr) {
+        MethodCallerPtr expression_method_caller =
+            evaluators_->method_caller_factory(Config::EXPRESSION_EVALUATION);
+
+        EvaluationContext evaluation_context;
+        evaluation_context.thread = thread;
+        evaluation_context.frame_depth = 0;
+        evaluation_context.method_caller = expression_method_caller.get();
+        evaluation_context.shared_values = item.shared_values;
 
-      LOG_IF(WARNING, watch_results_[i].compile_error_message.format.empty())
-          << "Unavailable error message for "
-             "watched expression that failed to compile";
+        EvaluateWatchedExpression(
+            evaluation_context,
+            *watch.evaluator,
+            &result.evaluation_result);
+
+        PostProcessVariable(&result.evaluation_result);
+      } else {
+        result.compile_error_message = watch.error_message;
+
+        LOG_IF(WARNING, result.compile_error_message.format.empty())
+            << "Unavailable error message for "
+               "watched expression that failed to compile";
+      }
     }
   }
 
-  // Collect referenced objects in BFS fashion.
-  auto it_pending_object = memory_objects_.begin();
-  int captured_variable_table_size = 0;
-  DCHECK(it_pending_object != memory_objects_.end());
+  // Expanding the object graph is the most expensive part of the collection.
+  // In the deferred mode only the roots (local variables and watched
+  // expressions) are captured while the thread is paused.
+  if (FLAGS_enable_deferred_object_capture) {
+    is_expansion_pending_ = true;
+  } else {
+    ExpandMemoryObjects(pretty_printers_method_caller.get());
+  }
 
-  ++it_pending_object;  // First entry has a special meaning of "buffer full".
-  ++captured_variable_table_size;
+  ChargeMemory(total_variables_size_);
+}
 
-  while ((it_pending_object != memory_objects_.end()) &&
+
+void CaptureDataCollector::CompleteCollection() {
+  for (auto& following_hit : following_hits_) {
+    following_hit.second->CompleteCollection();
+  }
+
+  MutexLock lock(&mu_completion_);
+
+  if (!is_expansion_pending_) {
+    return;
+  }
+
+  MethodCallerPtr pretty_printers_method_caller =
+      evaluators_->method_caller_factory(Config::PRETTY_PRINTERS);
+
+  ExpandMemoryObjects(pretty_printers_method_caller.get());
+
+  ChargeMemory(total_variables_size_);
+}
+
+
+void CaptureDataCollector::AddFollowingHit(
+    int hit_number,
+    std::shared_ptr<CaptureDataCollector> hit) {
+  following_hits_.push_back({ hit_number, std::move(hit) });
+}
+
+
+void CaptureDataCollector::CollectThreadDump(
+    const string& thread_name_prefix) {
+  evaluators_->eval_call_stack->ReadAllThreads(
+      std::max(0, FLAGS_max_thread_dump_threads),
+      thread_name_prefix,
+      &thread_stacks_);
+}
+
+
+void CaptureDataCollector::ExpandMemoryObjects(MethodCaller* method_caller) {
+  is_expansion_pending_ = false;
+
+  Stopwatch stopwatch;
+
+  // Collect referenced objects in BFS fashion. Appending to
+  // "memory_objects_" invalidates iterators (but not references), so the
+  // pending objects are tracked by index.
+  DCHECK(!memory_objects_.empty());
+
+  // First entry has a special meaning of "buffer full".
+  size_t pending_object_index = 1;
+
+  // The size quota doesn't reflect the cost of pretty printers and of JNI
+  // calls, so the time spent is limited separately. The remaining objects
+  // are reported the same way as when the size quota runs out.
+  const int64 time_budget_micros = FLAGS_cdbg_capture_expansion_time_budget_us;
+
+  while ((pending_object_index < memory_objects_.size()) &&
          CanCollectMoreMemoryObjects()) {
-    evaluators_->object_evaluator->Evaluate(
-        pretty_printers_method_caller.get(),
-        it_pending_object->object_ref,
-        &it_pending_object->members);
+    if ((time_budget_micros > 0) &&
+        (stopwatch.GetElapsedMicros() >= time_budget_micros)) {
+      is_expansion_time_exceeded_ = true;
+      break;
+    }
+
+    MemoryObject* pending_object = &memory_objects_[pending_object_index];
+
+    {
+      // All the temporary references created while evaluating the object
+      // (including the members that a failed type evaluator discarded) are
+      // released together with the frame. Only the members that make it
+      // into the capture get a global reference.
+      JniLocalFrame local_frame(kMemoryObjectLocalFrameCapacity);
+
+      evaluators_->object_evaluator->Evaluate(
+          method_caller,
+          pending_object->object_ref,
+          &pending_object->members);
+
+      PromoteToGlobalRefs(&pending_object->members);
+    }
 
     // If members of the current object contain references to other memory
     // objects, "memory_objects_" will grow inside "PostProcessVariables".
-    PostProcessVariables(it_pending_object->members);
+    PostProcessVariables(&pending_object->members);
 
-    ++it_pending_object;
-    ++captured_variable_table_size;
+    ++pending_object_index;
   }
 
   // Remove all memory objects that were enqueued, but were not explored.
-  DCHECK_EQ(memory_objects_size_, memory_objects_.size());
-
-  memory_objects_.erase(it_pending_object, memory_objects_.end());
-  memory_objects_size_ = captured_variable_table_size;
-
-  DCHECK_EQ(memory_objects_size_, memory_objects_.size());
+  memory_objects_.resize(pending_object_index);
 }
 
 
 void CaptureDataCollector::ReleaseRefs() {
+  // Other breakpoints sharing the capture still need to format it.
+  if (pending_releases_.fetch_sub(1) > 1) {
+    return;
+  }
+
+  is_expansion_pending_ = false;
+
+  for (auto& following_hit : following_hits_) {
+    following_hit.second->ReleaseRefs();
+  }
+
+  following_hits_.clear();
+
   object_index_map_.RemoveAll();
 
   watch_results_.clear();
@@ -160,18 +682,24 @@ void CaptureDataCollector::ReleaseRefs() {
   call_frames_.clear();
 
   memory_objects_.clear();
-  memory_objects_size_ = 0;
+
+  ChargeMemory(0);
 }
 
 
 void CaptureDataCollector::Format(BreakpointModel* breakpoint) const {
   // Format stack trace.
   breakpoint->stack.clear();
+  std::shared_ptr<const StackTraceCache::Stack> stack_trace = GetStackTrace();
   for (int depth = 0; depth < call_frames_.size(); ++depth) {
+    const StackTraceCache::Frame& stack_frame = (*stack_trace)[depth];
+
     std::unique_ptr<StackFrameModel> frame(new StackFrameModel);
 
-    frame->function = GetFunctionName(depth);
-    frame->location = GetCallFrameSourceLocation(depth);
+    frame->function = stack_frame.function;
+    frame->location.reset(new SourceLocationModel);
+    frame->location->path = stack_frame.path;
+    frame->location->line = stack_frame.line;
 
     FormatVariablesArray(
         call_frames_[depth].arguments,
@@ -185,51 +713,36 @@ void CaptureDataCollector::Format(BreakpointModel* breakpoint) const {
   }
 
   // Format watched expressions.
-  FormatWatchedExpressions(&breakpoint->evaluated_expressions);
+  FormatWatchedExpressions(
+      breakpoint->id,
+      &breakpoint->evaluated_expressions);
 
   // Format referenced memory objects (within the quota).
   breakpoint->variable_table.clear();
-  for (const MemoryObject& memory_object : memory_objects_) {
-    std::unique_ptr<VariableModel> object_variable;
-
-    if (breakpoint->variable_table.empty()) {
-      // First entry in "memory_objects_" has a special meaning.
-      object_variable = VariableBuilder::build_capture_buffer_full_variable();
-    } else {
-      if ((memory_object.members.size() == 1) &&
-          memory_object.members[0].name.empty() &&
-          memory_object.members[0].status.description.format.empty()) {
-        // Special case for Java strings: format single unnamed member as
-        // variable value rather than as a member. We don't want to do this
-        // collapsing for synthetic member entries like "object has no fields".
-        //
-        // TODO(vlif): it is possible that the string object is referenced by
-        // a watched expression. In this case we should pass true in
-        // "FormatVariable" to increase the size limit of captured a string
-        // string object.
-        object_variable = FormatVariable(memory_object.members[0], false);
-      } else {
-        object_variable.reset(new VariableModel);
-
-        object_variable->type = TypeNameFromSignature({
-            JType::Object,
-            GetObjectClassSignature(memory_object.object_ref)
-        });
-
-        if (!memory_object.status.description.format.empty()) {
-          object_variable->status =
-              StatusMessageBuilder(memory_object.status).build();
-        }
+  std::shared_ptr<FlatVariableTableModel> variable_table =
+      std::make_shared<FlatVariableTableModel>();
+  FormatVariableTable(variable_table.get());
+
+  // Later hits of a multi-hit breakpoint follow the watched expressions.
+  for (const auto& following_hit : following_hits_) {
+    breakpoint->evaluated_expressions.push_back(
+        FormatFollowingHit(following_hit.first, *following_hit.second));
+  }
 
-        FormatVariablesArray(
-            memory_object.members,
-            &object_variable->members);
-      }
-    }
+  // Call stacks of other threads follow the watched expressions too.
+  for (const EvalCallStack::ThreadStack& thread_stack : thread_stacks_) {
+    breakpoint->evaluated_expressions.push_back(
+        FormatThreadStack(thread_stack));
+  }
 
-    breakpoint->variable_table.push_back(std::move(object_variable));
+  // Watched expressions are left intact, since they typically use the
+  // extended string length limit and the user explicitly asked for them.
+  if (FLAGS_enable_string_value_deduplication) {
+    DeduplicateStringValues(breakpoint, variable_table.get());
   }
 
+  breakpoint->flat_variable_table = std::move(variable_table);
+
   // Format the breakpoint labels.
   breakpoint->labels = breakpoint_labels_provider_->Format();
 }
@@ -239,6 +752,7 @@ void CaptureDataCollector::ReadLocalVariables(
     const EvaluationContext& evaluation_context,
     jmethodID method,
     jlocation location,
+    const char* not_captured_message,
     std::vector<NamedJVariant>* arguments,
     std::vector<NamedJVariant>* local_variables) {
 
@@ -249,48 +763,58 @@ void CaptureDataCollector::ReadLocalVariables(
   std::shared_ptr<const MethodLocals::Entry> entry =
       evaluators_->method_locals->GetLocalVariables(method);
 
-  // TODO(vlif): refactor this function to add locals and arguments to
-  // output vectors as we go.
-
-  // Count number of local variables that are defined at "location".
-  int arguments_count = 0;
-  int local_variables_count = 0;
-  for (const auto& reader : entry->locals) {
-    if (reader->IsDefinedAtLocation(location)) {
-      if (reader->IsArgument()) {
-        ++arguments_count;
-      } else {
-        ++local_variables_count;
-      }
-    }
+  // The local variables defined at "location" and the number of arguments
+  // among them are precomputed for each range of locations in the method.
+  const int range = entry->FindRange(location);
+  if (range == -1) {
+    arguments->clear();
+    local_variables->clear();
+    return;
   }
 
+  const int* defined_begin =
+      entry->range_locals.data() + entry->range_offsets[range];
+  const int* defined_end =
+      entry->range_locals.data() + entry->range_offsets[range + 1];
+
+  const int arguments_count = entry->range_arguments[range];
+  const int local_variables_count =
+      (defined_end - defined_begin) - arguments_count;
+
   *arguments = std::vector<NamedJVariant>(arguments_count);
   *local_variables = std::vector<NamedJVariant>(local_variables_count);
 
   int arguments_index = 0;
   int local_variables_index = 0;
 
-  for (const auto& reader : entry->locals) {
-    if (!reader->IsDefinedAtLocation(location)) {
-      continue;
-    }
+  for (const int* it = defined_begin; it != defined_end; ++it) {
+    const int index = *it;
 
-    NamedJVariant& item = reader->IsArgument()
+    NamedJVariant& item = entry->is_argument[index]
         ? (*arguments)[arguments_index++]
         : (*local_variables)[local_variables_index++];
 
-    item.name = reader->GetName();
-    if (!reader->ReadValue(evaluation_context, &item.value)) {
+    item.name = *entry->names[index];
+    if (not_captured_message != nullptr) {
+      item.status.is_error = false;
+      item.status.refers_to = StatusMessageModel::Context::VARIABLE_VALUE;
+      item.status.description = {
+        not_captured_message,
+        { TypeNameFromSignature(entry->locals[index]->GetStaticType()) }
+      };
+    } else if (!JvmLocalVariableReader::ReadSlot(
+                   evaluation_context,
+                   entry->slots[index],
+                   entry->types[index],
+                   &item.value)) {
       item.status.is_error = false;
       item.status.refers_to = StatusMessageModel::Context::VARIABLE_VALUE;
       item.status.description = INTERNAL_ERROR_MESSAGE;
     } else {
-      item.well_known_jclass =
-          WellKnownJClassFromSignature(reader->GetStaticType());
+      item.well_known_jclass = entry->well_known_jclasses[index];
     }
 
-    item.value.change_ref_type(JVariant::ReferenceKind::Global);
+    PromoteToGlobalRef(&item);
   }
 
   DCHECK_EQ(arguments_count, arguments_index);
@@ -315,7 +839,7 @@ void CaptureDataCollector::EvaluateWatchedExpression(
 
   result->well_known_jclass =
       WellKnownJClassFromSignature(watch_evaluator.GetStaticType());
-  result->value.change_ref_type(JVariant::ReferenceKind::Global);
+  PromoteToGlobalRef(result);
 }
 
 
@@ -329,10 +853,26 @@ void CaptureDataCollector::FormatVariablesArray(
 
 
 void CaptureDataCollector::FormatWatchedExpressions(
+    const string& breakpoint_id,
     std::vector<std::unique_ptr<VariableModel>>* target) const {
   target->clear();
 
-  for (const EvaluatedExpression& item : watch_results_) {
+  int begin = 0;
+  int end = watch_results_.size();
+  if (!watch_ranges_.empty()) {
+    auto it = watch_ranges_.find(breakpoint_id);
+    if (it == watch_ranges_.end()) {
+      LOG(ERROR) << "Breakpoint " << breakpoint_id
+                 << " doesn't share this capture";
+      return;
+    }
+
+    begin = it->second.first;
+    end = begin + it->second.second;
+  }
+
+  for (int i = begin; i < end; ++i) {
+    const EvaluatedExpression& item = watch_results_[i];
     if (!item.compile_error_message.format.empty()) {
       target->push_back(VariableBuilder()
           .set_name(item.expression)
@@ -368,82 +908,324 @@ std::unique_ptr<VariableModel> CaptureDataCollector::FormatVariable(
       ValueFormatter::Format(source, options, &formatted_value, &target->type);
       target->value = std::move(formatted_value);
     } else {
-      jobject ref = nullptr;
-      const int* var_table_index = nullptr;
-      if (source.value.get<jobject>(&ref)) {
-        var_table_index = object_index_map_.Find(ref);
-      }
-
-      if (var_table_index == nullptr) {
+      const int var_table_index = GetVarTableIndex(source);
+      if (var_table_index == -1) {
         target->status = StatusMessageBuilder()
             .set_error()
             .set_refers_to(StatusMessageModel::Context::VARIABLE_VALUE)
             .set_description(INTERNAL_ERROR_MESSAGE)
             .build();
       } else {
-        if (*var_table_index < memory_objects_size_) {
-          target->var_table_index = *var_table_index;
-        } else {
-          // Collector ran out of quota before the current object was explored.
-          // Set "var_table_index" to 0, which is an empty object (with no
-          // fields) and has a special meaning ("buffer full").
-          target->var_table_index.set_value(0);
+        target->var_table_index = var_table_index;
+      }
+    }
+  }
+
+  return target;
+}
+
+
+void CaptureDataCollector::FormatVariableTable(
+    FlatVariableTableModel* table) const {
+  // All the records are allocated at once. Members of an object are stored
+  // right after the object.
+  size_t variables_count = 0;
+  for (const MemoryObject& memory_object : memory_objects_) {
+    variables_count += 1 + memory_object.members.size();
+  }
+
+  table->entries.reserve(memory_objects_.size());
+  table->variables.reserve(variables_count);
+
+  FlatVariableTableWriter writer(table);
+  for (const MemoryObject& memory_object : memory_objects_) {
+    const int32 index = table->variables.size();
+    table->entries.push_back(index);
+    table->variables.emplace_back();
+
+    if (index == 0) {
+      // First entry in "memory_objects_" has a special meaning.
+      std::unique_ptr<VariableModel> truncated =
+          VariableBuilder::build_capture_buffer_full_variable();
+      if (is_expansion_time_exceeded_) {
+        truncated->status->description = {
+            CaptureTimeLimitExceeded,
+            { std::to_string(FLAGS_cdbg_capture_expansion_time_budget_us) }
+        };
+      }
+
+      table->variables[index].status = writer.AddStatus(*truncated->status);
+      continue;
+    }
+
+    if ((memory_object.members.size() == 1) &&
+        memory_object.members[0].name.empty() &&
+        memory_object.members[0].status.description.format.empty()) {
+      // Special case for Java strings: format single unnamed member as
+      // variable value rather than as a member (see "FormatVariable").
+      FormatFlatVariable(memory_object.members[0], index, &writer);
+      continue;
+    }
+
+    FlatVariableTableModel::Variable* object_variable =
+        &table->variables[index];
+
+    object_variable->type = writer.Intern(TypeNameFromSignature({
+        JType::Object,
+        GetObjectClassSignature(memory_object.object_ref)
+    }));
+
+    if (!memory_object.status.description.format.empty()) {
+      object_variable->status = writer.AddStatus(memory_object.status);
+    }
+
+    object_variable->first_member = index + 1;
+    object_variable->members_count = memory_object.members.size();
+
+    for (const NamedJVariant& member : memory_object.members) {
+      const int32 member_index = table->variables.size();
+      table->variables.emplace_back();
+      FormatFlatVariable(member, member_index, &writer);
+    }
+  }
+}
+
+
+void CaptureDataCollector::FormatFlatVariable(
+    const NamedJVariant& source,
+    int32 index,
+    FlatVariableTableWriter* writer) const {
+  FlatVariableTableModel::Variable* target =
+      &writer->table()->variables[index];
+
+  target->name = writer->Intern(source.name);
+
+  if (!source.status.description.format.empty()) {
+    target->status = writer->AddStatus(source.status);
+  } else if (ValueFormatter::IsValue(source)) {
+    writer->FormatValue(source, ValueFormatter::Options(), target);
+  } else {
+    const int var_table_index = GetVarTableIndex(source);
+    if (var_table_index == -1) {
+      target->status = writer->AddStatus(*StatusMessageBuilder()
+          .set_error()
+          .set_refers_to(StatusMessageModel::Context::VARIABLE_VALUE)
+          .set_description(INTERNAL_ERROR_MESSAGE)
+          .build());
+    } else {
+      target->var_table_index = var_table_index;
+    }
+  }
+}
+
+
+int CaptureDataCollector::GetVarTableIndex(const NamedJVariant& source) const {
+  jobject ref = nullptr;
+  const int* var_table_index = nullptr;
+  if (source.value.get<jobject>(&ref)) {
+    var_table_index = object_index_map_.Find(ref);
+  }
+
+  if (var_table_index == nullptr) {
+    return -1;
+  }
+
+  if (*var_table_index >= static_cast<int>(memory_objects_.size())) {
+    // Collector ran out of quota before the current object was explored.
+    // Use "var_table_index" 0, which is an empty object (with no fields) and
+    // has a special meaning ("buffer full").
+    return 0;
+  }
+
+  return *var_table_index;
+}
+
+
+std::unique_ptr<VariableModel> CaptureDataCollector::FormatFollowingHit(
+    int hit_number,
+    const CaptureDataCollector& hit) const {
+  std::unique_ptr<VariableModel> target(new VariableModel);
+  target->name = "[hit " + std::to_string(hit_number) + "]";
+
+  // Both hits stopped at the same location, so the top frame has the same
+  // variables. They are still matched by name rather than by position.
+  if (!call_frames_.empty() && !hit.call_frames_.empty()) {
+    const CallFrame& first_frame = call_frames_[0];
+    const CallFrame& hit_frame = hit.call_frames_[0];
+
+    auto find_first = [] (
+        const std::vector<NamedJVariant>& variables,
+        const string& name) -> const NamedJVariant* {
+      for (const NamedJVariant& variable : variables) {
+        if (variable.name == name) {
+          return &variable;
         }
       }
+
+      return nullptr;
+    };
+
+    for (const NamedJVariant& variable : hit_frame.arguments) {
+      std::unique_ptr<VariableModel> changed = hit.FormatChangedVariable(
+          find_first(first_frame.arguments, variable.name),
+          variable,
+          false);
+      if (changed != nullptr) {
+        target->members.push_back(std::move(changed));
+      }
+    }
+
+    for (const NamedJVariant& variable : hit_frame.local_variables) {
+      std::unique_ptr<VariableModel> changed = hit.FormatChangedVariable(
+          find_first(first_frame.local_variables, variable.name),
+          variable,
+          false);
+      if (changed != nullptr) {
+        target->members.push_back(std::move(changed));
+      }
     }
   }
 
+  // Both hits evaluated the same list of watched expressions.
+  for (int i = 0; i < hit.watch_results_.size(); ++i) {
+    const EvaluatedExpression& item = hit.watch_results_[i];
+    if (!item.compile_error_message.format.empty()) {
+      continue;  // Already reported by the first hit.
+    }
+
+    const NamedJVariant* first = nullptr;
+    if ((i < watch_results_.size()) &&
+        watch_results_[i].compile_error_message.format.empty()) {
+      first = &watch_results_[i].evaluation_result;
+    }
+
+    std::unique_ptr<VariableModel> changed =
+        hit.FormatChangedVariable(first, item.evaluation_result, true);
+    if (changed != nullptr) {
+      changed->name = item.expression;
+      target->members.push_back(std::move(changed));
+    }
+  }
+
+  if (target->members.empty()) {
+    target->status = StatusMessageBuilder()
+        .set_info()
+        .set_refers_to(StatusMessageModel::Context::VARIABLE_VALUE)
+        .set_format(CaptureHitUnchanged)
+        .build();
+  }
+
   return target;
 }
 
 
-string CaptureDataCollector::GetFunctionName(int depth) const {
-  const int frame_info_key = call_frames_[depth].frame_info_key;
-  const auto& frame_info =
-      evaluators_->eval_call_stack->ResolveCallFrameKey(frame_info_key);
+std::unique_ptr<VariableModel> CaptureDataCollector::FormatChangedVariable(
+    const NamedJVariant* first,
+    const NamedJVariant& source,
+    bool is_watched_expression) const {
+  if (ValueFormatter::IsValue(source)) {
+    std::unique_ptr<VariableModel> target =
+        FormatVariable(source, is_watched_expression);
+    if ((first != nullptr) &&
+        ValueFormatter::IsValue(*first) &&
+        (first->status.is_error == source.status.is_error) &&
+        (first->status.description.format ==
+         source.status.description.format) &&
+        (first->status.description.parameters ==
+         source.status.description.parameters)) {
+      std::unique_ptr<VariableModel> first_variable =
+          FormatVariable(*first, is_watched_expression);
+      if ((first_variable->value == target->value) &&
+          (first_variable->type == target->type)) {
+        return nullptr;
+      }
+    }
 
-  string function_name =
-      TypeNameFromJObjectSignature(frame_info.class_signature);
-  function_name += '.';
-  function_name += frame_info.method_name;
+    return target;
+  }
+
+  jobject ref = nullptr;
+  source.value.get<jobject>(&ref);
+
+  jobject first_ref = nullptr;
+  if ((first != nullptr) &&
+      !ValueFormatter::IsValue(*first) &&
+      first->value.get<jobject>(&first_ref) &&
+      jni()->IsSameObject(ref, first_ref)) {
+    return nullptr;
+  }
 
-  return function_name;
+  std::unique_ptr<VariableModel> target(new VariableModel);
+  target->name = source.name;
+  target->type = TypeNameFromSignature({
+      JType::Object,
+      GetObjectClassSignature(ref)
+  });
+  target->status = StatusMessageBuilder()
+      .set_info()
+      .set_refers_to(StatusMessageModel::Context::VARIABLE_VALUE)
+      .set_format(CaptureHitObjectChanged)
+      .build();
+
+  return target;
 }
 
 
-std::unique_ptr<SourceLocationModel>
-CaptureDataCollector::GetCallFrameSourceLocation(int depth) const {
-  const int frame_info_key = call_frames_[depth].frame_info_key;
-  const auto& frame_info =
-      evaluators_->eval_call_stack->ResolveCallFrameKey(frame_info_key);
+std::unique_ptr<VariableModel> CaptureDataCollector::FormatThreadStack(
+    const EvalCallStack::ThreadStack& thread_stack) const {
+  std::unique_ptr<VariableModel> target(new VariableModel);
+  target->name = "[thread " + thread_stack.thread_name + "]";
+  target->value = FormatThreadState(thread_stack.state);
+
+  std::shared_ptr<const StackTraceCache::Stack> stack_trace =
+      StackTraceCache::GetInstance()->Get(thread_stack.frames);
+  for (int depth = 0; depth < stack_trace->size(); ++depth) {
+    const StackTraceCache::Frame& stack_frame = (*stack_trace)[depth];
+
+    string frame = stack_frame.function;
+    frame += " (";
+    frame += stack_frame.path;
+    frame += ':';
+    frame += std::to_string(stack_frame.line);
+    frame += ')';
+
+    std::unique_ptr<VariableModel> member(new VariableModel);
+    member->name = "[" + std::to_string(depth) + "]";
+    member->value = std::move(frame);
+
+    target->members.push_back(std::move(member));
+  }
 
-  std::unique_ptr<SourceLocationModel> location(new SourceLocationModel);
+  return target;
+}
 
-  location->path = ConstructFilePath(
-      frame_info.class_signature.c_str(),
-      frame_info.source_file_name.c_str());
 
-  location->line = frame_info.line_number;
+std::shared_ptr<const StackTraceCache::Stack>
+CaptureDataCollector::GetStackTrace() const {
+  StackTraceCache::FrameInfos frames;
+  frames.reserve(call_frames_.size());
+  for (const CallFrame& call_frame : call_frames_) {
+    frames.push_back(call_frame.frame_info);
+  }
 
-  return location;
+  return StackTraceCache::GetInstance()->Get(frames);
 }
 
 
-void CaptureDataCollector::PostProcessVariable(
-    const NamedJVariant& variable) {
+void CaptureDataCollector::PostProcessVariable(NamedJVariant* variable) {
   // Even if due to some error the variable has a zero size, we still want
   // to add a non-zero. This is to avoid any potential endless loops.
   total_variables_size_ +=
       std::max(1, ValueFormatter::GetTotalDataSize(variable));
 
-  EnqueueRef(variable);
+  EnqueueRef(*variable);
 }
 
 
 void CaptureDataCollector::PostProcessVariables(
-    const std::vector<NamedJVariant>& variables) {
-  for (const NamedJVariant& variable : variables) {
-    PostProcessVariable(variable);
+    std::vector<NamedJVariant>* variables) {
+  for (NamedJVariant& variable : *variables) {
+    PostProcessVariable(&variable);
   }
 }
 
@@ -463,7 +1245,7 @@ void CaptureDataCollector::EnqueueRef(const NamedJVariant& var) {
   // has already been encountered, it will be in memory_objects_ and "Insert"
   // will return false. In this case no further action is necessary.
   const bool is_new_object =
-      object_index_map_.Insert(ref, memory_objects_size_);
+      object_index_map_.Insert(ref, static_cast<int>(memory_objects_.size()));
   if (!is_new_object) {
     return;
   }
@@ -474,12 +1256,17 @@ void CaptureDataCollector::EnqueueRef(const NamedJVariant& var) {
   new_memory_object.object_ref = ref;
 
   memory_objects_.push_back(std::move(new_memory_object));
-  ++memory_objects_size_;
 }
 
 
 bool CaptureDataCollector::CanCollectMoreMemoryObjects() const {
-  return total_variables_size_ < kBreakpointMaxCaptureSize;
+  return total_variables_size_ < limits_.max_capture_size;
+}
+
+
+void CaptureDataCollector::ChargeMemory(int64 bytes) {
+  MemoryBudget::GetInstance()->Charge(bytes - charged_memory_);
+  charged_memory_ = bytes;
 }
 
 
@@ -17,16 +17,23 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_CAPTURE_DATA_COLLECTOR_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_CAPTURE_DATA_COLLECTOR_H_
 
-#include <list>
+#include <atomic>
+#include <deque>
+#include <map>
 #include <memory>
+#include "arena.h"
 #include "breakpoint_labels_provider.h"
 #include "class_indexer.h"
 #include "class_metadata_reader.h"
 #include "common.h"
+#include "eval_call_stack.h"
 #include "jobject_map.h"
 #include "jvm_evaluators.h"
 #include "model.h"
+#include "mutex.h"
 #include "readers_factory.h"
+#include "stack_trace_cache.h"
+#include "tagged_jobject_map.h"
 #include "type_util.h"
 
 namespace devtools {
@@ -41,12 +48,32 @@ constexpr int kMethodLocalsFrames = 5;
 // limit the time we pause the service on a breakpoint event.
 constexpr int kBreakpointMaxCaptureSize = 65536;
 
+// Limits on the amount of data captured by a single snapshot.
+struct CaptureLimits {
+  // Number of top call frames included in the snapshot.
+  int max_stack_depth;
+
+  // Number of top frames for which local variables are read.
+  int max_locals_frames;
+
+  // Quota for total size of all the variables we collect (see
+  // "kBreakpointMaxCaptureSize"). Referenced objects are not explored if
+  // the quota is 0.
+  int max_capture_size;
+};
+
+// Gets the limits corresponding to the capture profile of a breakpoint.
+const CaptureLimits& GetCaptureLimits(
+    BreakpointModel::CaptureProfile capture_profile);
+
 class CompiledExpression;
 class EvalCallStack;
 class ExpressionEvaluator;
 class MethodLocals;
 class ObjectEvaluator;
+class SharedSubexpressionValues;
 class ClassFilesCache;
+class FlatVariableTableWriter;
 
 // Orchestrates functionality of all the evaluation classes together to
 // collect the state of the program upon breakpoint hit. This includes call
@@ -66,28 +93,80 @@ class ClassFilesCache;
 //    will be transmitted to the Hub service.
 class CaptureDataCollector {
  public:
-  explicit CaptureDataCollector(JvmEvaluators* evaluators);
+  // Watched expressions of a single breakpoint sharing the capture with
+  // other breakpoints (see "CollectShared").
+  struct BreakpointWatches {
+    // ID of the breakpoint.
+    string breakpoint_id;
+
+    // Watched expressions of the breakpoint. Not owned by this class.
+    const std::vector<CompiledExpression>* watches;
+
+    // Values of the method calls the watched expressions share with the
+    // breakpoint condition or null. Not owned by this class.
+    SharedSubexpressionValues* shared_values;
+  };
+
+  CaptureDataCollector(
+      JvmEvaluators* evaluators,
+      BreakpointModel::CaptureProfile capture_profile);
 
   virtual ~CaptureDataCollector();
 
-  // Reads the state of the the debugged program.
+  // Reads the state of the the debugged program. If deferred object capture
+  // is enabled, referenced objects are not explored until
+  // "CompleteCollection" is called.
   void Collect(
       const std::vector<CompiledExpression>& watches,
+      SharedSubexpressionValues* shared_values,
+      jthread thread);
+
+  // Variant of "Collect" for multiple snapshot breakpoints hit at the same
+  // location. Call stack, local variables and referenced objects are only
+  // captured once. "Format" includes just the watched expressions of the
+  // breakpoint being formatted. Each of the breakpoints must call
+  // "ReleaseRefs" exactly once.
+  void CollectShared(
+      const std::vector<BreakpointWatches>& breakpoints,
       jthread thread);
 
+  // Explores the objects referenced by local variables and watched
+  // expressions if "Collect" deferred it. Unlike "Collect", this function
+  // doesn't need the thread that hit the breakpoint to be paused. It is
+  // called on the worker thread before "Format". No-op if there is nothing
+  // left to collect.
+  void CompleteCollection();
+
   // Releases the all global reference to Java objects. This function must be
   // called before the object is destroyed. After "Release" has been called,
-  // "Format" should not be called.
+  // "Format" should not be called. If the capture is shared by multiple
+  // breakpoints, only the last call releases the references.
   void ReleaseRefs();
 
+  // Attaches the capture of a later hit of a multi-hit breakpoint (see
+  // "kCaptureHitsLabel"). "Format" reports the attached hits as the
+  // differences from this capture, which carries the call stack, the names
+  // and types shared by all the hits. "hit_number" is the 1-based order of
+  // the hit. "ReleaseRefs" and "CompleteCollection" also apply to the
+  // attached hits. Must be called before "Format".
+  void AddFollowingHit(
+      int hit_number,
+      std::shared_ptr<CaptureDataCollector> hit);
+
+  // Reads call stacks of all the threads whose names start with
+  // "thread_name_prefix" (all threads if empty) at once (see
+  // "kThreadDumpLabel"). "Format" reports them after the watched
+  // expressions. Must be called before "Format".
+  void CollectThreadDump(const string& thread_name_prefix);
+
   // Formats the captured data into the specified Breakpoint message.
   void Format(BreakpointModel* breakpoint) const;
 
  private:
   // Information about the call frame that we keep around for formatting.
   struct CallFrame {
-    // Reference to the name of the class and method of the call frame.
-    int frame_info_key;
+    // Name of the class and method of the call frame.
+    std::shared_ptr<const EvalCallStack::FrameInfo> frame_info;
 
     // Collected method arguments.
     std::vector<NamedJVariant> arguments;
@@ -135,13 +214,10 @@ class CaptureDataCollector {
     NamedJVariant evaluation_result;
   };
 
-  // Decodes call frame key into a user friendly function name (like
-  // "MyOrg.MyClass.MyMethod").
-  string GetFunctionName(int depth) const;
-
-  // Retrieves the location of the source code at the specified call frame.
-  std::unique_ptr<SourceLocationModel> GetCallFrameSourceLocation(
-      int depth) const;
+  // Gets the formatted call stack of the breakpoint thread. The function
+  // names and source locations are shared with earlier captures of the same
+  // call stack through "StackTraceCache".
+  std::shared_ptr<const StackTraceCache::Stack> GetStackTrace() const;
 
   // Evaluates a single watched expression and appends the result to
   // "watch_results_". If "watch" is nullptr or evaluation fails, the function
@@ -153,10 +229,10 @@ class CaptureDataCollector {
 
   // Applies all internal bookkeeping to set the specified variable (quota
   // calculation and list of references to memory objects).
-  void PostProcessVariable(const NamedJVariant& variable);
+  void PostProcessVariable(NamedJVariant* variable);
 
   // Applies "PostProcessVariable" to an array of variables.
-  void PostProcessVariables(const std::vector<NamedJVariant>& variables);
+  void PostProcessVariables(std::vector<NamedJVariant>* variables);
 
   // Adds the referenced object to the list of member objects that need to
   // be collected. If "var" is not a reference, the function does nothing.
@@ -164,19 +240,27 @@ class CaptureDataCollector {
   // another memory object), no action is taken as well.
   void EnqueueRef(const NamedJVariant& var);
 
+  // Explores pending memory objects in BFS fashion until the quota runs out
+  // and drops the objects that were not explored.
+  void ExpandMemoryObjects(MethodCaller* method_caller);
+
   // Checks whether this instance has more quota to evaluate additional memory
   // objects.
   bool CanCollectMoreMemoryObjects() const;
 
+  // Updates the memory charged to "MemoryBudget" for this capture.
+  void ChargeMemory(int64 bytes);
+
   // Formats list of "NamedJVariant" into the corresponding API message
   // structure.
   void FormatVariablesArray(
       const std::vector<NamedJVariant>& source,
       std::vector<std::unique_ptr<VariableModel>>* target) const;
 
-  // Prints results of watched expressions evaluation into the corresponding
-  // API message structure.
+  // Prints results of watched expressions evaluation of the specified
+  // breakpoint into the corresponding API message structure.
   void FormatWatchedExpressions(
+      const string& breakpoint_id,
       std::vector<std::unique_ptr<VariableModel>>* target) const;
 
   // Formats a single "JVariant" instance into the corresponding API message
@@ -185,48 +269,113 @@ class CaptureDataCollector {
       const NamedJVariant& source,
       bool is_watched_expression) const;
 
+  // Formats the explored memory objects into the variable table.
+  void FormatVariableTable(FlatVariableTableModel* table) const;
+
+  // Same as "FormatVariable", but formats the variable into the record
+  // "index" of the flat variable table.
+  void FormatFlatVariable(
+      const NamedJVariant& source,
+      int32 index,
+      FlatVariableTableWriter* writer) const;
+
+  // Gets the index in the variable table of the object referenced by
+  // "source". Returns 0 ("buffer full") if the object was not explored and
+  // -1 if the object is not known.
+  int GetVarTableIndex(const NamedJVariant& source) const;
+
+  // Formats a hit attached with "AddFollowingHit" as a synthetic variable
+  // whose members are the top frame variables and the watched expressions
+  // that differ from this capture.
+  std::unique_ptr<VariableModel> FormatFollowingHit(
+      int hit_number,
+      const CaptureDataCollector& hit) const;
+
+  // Formats the variable "source" captured by this (following) hit unless it
+  // is the same as "first", which is the variable of the same name captured
+  // by the first hit or nullptr. Returns nullptr if the variable hasn't
+  // changed. Referenced objects of a following hit are not captured, so a
+  // different object is only reported by its type.
+  std::unique_ptr<VariableModel> FormatChangedVariable(
+      const NamedJVariant* first,
+      const NamedJVariant& source,
+      bool is_watched_expression) const;
+
+  // Formats the call stack of a thread collected by "CollectThreadDump".
+  std::unique_ptr<VariableModel> FormatThreadStack(
+      const EvalCallStack::ThreadStack& thread_stack) const;
+
  protected:
-  // Reads local variables at a particular call frame. The function is marked
-  // as virtual and protected for unit testing purposes.
+  // Reads local variables at a particular call frame. If
+  // "not_captured_message" is not nullptr, values are not read and only
+  // names and types of the local variables are listed with this message
+  // (formatted with the type as $0). The function is marked as virtual and
+  // protected for unit testing purposes.
   virtual void ReadLocalVariables(
       const EvaluationContext& evaluation_context,
       jmethodID method,
       jlocation location,
+      const char* not_captured_message,
       std::vector<NamedJVariant>* arguments,
       std::vector<NamedJVariant>* local_variables);
 
  private:
+  // Containers allocated from "arena_".
+  template <typename T>
+  using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+  template <typename T>
+  using ArenaDeque = std::deque<T, ArenaAllocator<T>>;
+
   // Bundles all the evaluation classes together. Evaluators are guaranteed
   // to be valid throughout the lifetime of "CaptureDataCollector".
   // Not owned by this class.
   JvmEvaluators* const evaluators_;
 
+  // Limits on the captured data.
+  const CaptureLimits& limits_;
+
   // Captures information about local environment into breakpoint labels.
   std::unique_ptr<BreakpointLabelsProvider> breakpoint_labels_provider_;
 
+  // Backs the containers of the captured data below, so that all of them are
+  // freed at once when the collector is destroyed. Must be declared before
+  // the containers that use it.
+  Arena arena_;
+
   // Captured data of call frames that can be formatted into the message
   // for Hub service.
-  std::vector<CallFrame> call_frames_;
+  ArenaVector<CallFrame> call_frames_;
 
   // Evaluated watched expressions.
-  std::vector<EvaluatedExpression> watch_results_;
+  ArenaVector<EvaluatedExpression> watch_results_;
 
-  // Set of pending and collected memory objects. Newly discovered memory
-  // objects are appended to the end of the list. Objects in the list are
-  // identified by index. This scheme enables BFS-like exporation of the
-  // object tree. Use linked list here (rather than vector) so that we
-  // can add new elements without relocating existing elements.
-  std::list<MemoryObject> memory_objects_;
+  // Range of "watch_results_" (first index and count) that belongs to each
+  // breakpoint of a shared capture. Empty if the capture is not shared.
+  std::map<string, std::pair<int, int>> watch_ranges_;
 
-  // Number of elements in "memory_objects_". We keep track of it to avoid
-  // calling "memory_objects_.size()", which has O(n) complexity.
-  int memory_objects_size_ = 0;
+  // Number of breakpoints sharing the capture that haven't called
+  // "ReleaseRefs" yet.
+  std::atomic<int> pending_releases_ { 1 };
+
+  // Serializes "CompleteCollection" of a shared capture, which may be
+  // formatted for several breakpoints.
+  Mutex mu_completion_;
+
+  // Set of pending and collected memory objects. Newly discovered memory
+  // objects are appended to the end. Objects are identified by index. This
+  // scheme enables BFS-like exporation of the object tree. The deque stores
+  // the objects in contiguous chunks and doesn't relocate existing elements
+  // when new ones are appended, so the object being explored stays valid
+  // while its members enqueue more objects.
+  ArenaDeque<MemoryObject> memory_objects_;
 
   // Maps discovered Java objects to index in "memory_objects_". The map
   // does not hold any reference to Java objects and assumes that the global
   // reference is maintained by "VariableFormatter" instances somewhere in this
-  // class.
-  JobjectMap<JObject_NoRef, int> object_index_map_;
+  // class. Keyed on object tags, so that deduplication of captured objects
+  // doesn't need to compare objects with "IsSameObject".
+  TaggedJobjectMap<JObject_NoRef, int> object_index_map_;
 
   // Total approximated size of collected variables. This size is compared
   // against a quota. The data collection will stop once the threshold has been
@@ -235,6 +384,25 @@ class CaptureDataCollector {
   // not account for formatting overhead in the actual message.
   int total_variables_size_ = 0;
 
+  // Memory currently charged to "MemoryBudget" for this capture.
+  int64 charged_memory_ = 0;
+
+  // Set when "ExpandMemoryObjects" stopped because it ran out of time
+  // rather than out of the size quota.
+  bool is_expansion_time_exceeded_ = false;
+
+  // Set when "Collect" captured only the roots and "CompleteCollection" still
+  // needs to explore the referenced objects.
+  bool is_expansion_pending_ = false;
+
+  // Later hits of a multi-hit breakpoint with their hit numbers (see
+  // "AddFollowingHit").
+  std::vector<std::pair<int, std::shared_ptr<CaptureDataCollector>>>
+      following_hits_;
+
+  // Call stacks of other threads (see "CollectThreadDump").
+  std::vector<EvalCallStack::ThreadStack> thread_stacks_;
+
   DISALLOW_COPY_AND_ASSIGN(CaptureDataCollector);
 };
 
@@ -15,6 +15,11 @@
  */
 
 #include "class_file.h"
+
+#include <algorithm>
+#include <vector>
+#include "call_target_cache.h"
+#include "retained_class_files.h"
 #include "jni_proxy_classpathlookup.h"
 
 namespace devtools {
@@ -92,6 +97,14 @@ static ClassFile::InstructionType* BuildInstructionTypeMap() {
 
 ClassFile::ClassFile(ClassIndexer* class_indexer, string buffer)
     : buffer_(std::move(buffer)),
+      data_(buffer_),
+      class_indexer_(class_indexer),
+      constant_pool_(class_indexer) {
+}
+
+
+ClassFile::ClassFile(ClassIndexer* class_indexer, ByteSource external_buffer)
+    : data_(external_buffer),
       class_indexer_(class_indexer),
       constant_pool_(class_indexer) {
 }
@@ -122,6 +135,14 @@ bool ClassFile::Initialize() {
 std::unique_ptr<ClassFile> ClassFile::Load(
     ClassIndexer* class_indexer,
     jclass cls) {
+  RetainedClassFiles* retained_class_files = GetRetainedClassFiles();
+  if (retained_class_files != nullptr) {
+    ByteSource retained_blob;
+    if (retained_class_files->Find(cls, &retained_blob)) {
+      return LoadFromExternalBlob(class_indexer, retained_blob);
+    }
+  }
+
   string blob = jniproxy::ClassPathLookup()->readClassFile(cls)
       .Release(ExceptionAction::LOG_AND_IGNORE);
   return LoadFromBlob(class_indexer, std::move(blob));
@@ -141,6 +162,18 @@ std::unique_ptr<ClassFile> ClassFile::LoadFromBlob(
 }
 
 
+std::unique_ptr<ClassFile> ClassFile::LoadFromExternalBlob(
+    ClassIndexer* class_indexer,
+    ByteSource blob) {
+  std::unique_ptr<ClassFile> instance(new ClassFile(class_indexer, blob));
+  if (!instance->Initialize()) {
+    return nullptr;
+  }
+
+  return instance;
+}
+
+
 Nullable<int> ClassFile::GetClassModifiers() const {
   ByteSource reader = GetData();
 
@@ -168,7 +201,18 @@ ClassFile::Method* ClassFile::FindMethod(
     bool is_static,
     const string& name,
     const string& signature) {
-  for (Method& method : methods_) {
+  if (method_slots_.empty()) {
+    return nullptr;
+  }
+
+  const uint32 mask = method_slots_.size() - 1;
+  uint32 slot = HashMethodKey(
+      name.data(),
+      name.size(),
+      signature.data(),
+      signature.size()) & mask;
+  for (; method_slots_[slot] != -1; slot = (slot + 1) & mask) {
+    Method& method = methods_[method_slots_[slot]];
     if ((method.IsStatic() == is_static) &&
         (method.name() == name) &&
         (method.signature() == signature)) {
@@ -180,8 +224,28 @@ ClassFile::Method* ClassFile::FindMethod(
 }
 
 
+uint32 ClassFile::HashMethodKey(
+    const char* name,
+    int name_size,
+    const char* signature,
+    int signature_size) {
+  // FNV-1a. The signature always starts with '(', which separates it from
+  // the name.
+  uint32 hash = 2166136261U;
+  for (int i = 0; i < name_size; ++i) {
+    hash = (hash ^ static_cast<uint8>(name[i])) * 16777619U;
+  }
+
+  for (int i = 0; i < signature_size; ++i) {
+    hash = (hash ^ static_cast<uint8>(signature[i])) * 16777619U;
+  }
+
+  return hash;
+}
+
+
 bool ClassFile::CheckClassFileVersion() {
-  ByteSource reader(buffer_);
+  ByteSource reader = GetData();
 
   // Check class file version.
   int16 version = reader.ReadInt16BE(6);
@@ -197,7 +261,7 @@ bool ClassFile::CheckClassFileVersion() {
 bool ClassFile::CalculateMethodsOffset(
     int constant_pool_end_offset,
     int* methods_offset) const {
-  ByteSource reader(buffer_);
+  ByteSource reader = GetData();
 
   *methods_offset = constant_pool_end_offset;
 
@@ -236,7 +300,7 @@ bool ClassFile::IndexMethods() {
     return false;
   }
 
-  ByteSource reader(buffer_);
+  ByteSource reader = GetData();
 
   // Loop through class methods.
   int offset = methods_offset;
@@ -259,23 +323,75 @@ bool ClassFile::IndexMethods() {
     methods_.push_back(std::move(method));
   }
 
+  IndexBootstrapMethods(offset);
+
+  int slots_count = 1;
+  while (slots_count < 2 * methods_count) {
+    slots_count *= 2;
+  }
+
+  const uint32 mask = slots_count - 1;
+  method_slots_.assign(slots_count, -1);
+  for (int i = 0; i < methods_count; ++i) {
+    const Method& method = methods_[i];
+    uint32 slot = HashMethodKey(
+        method.name().begin(),
+        method.name().size(),
+        method.signature().begin(),
+        method.signature().size()) & mask;
+    while (method_slots_[slot] != -1) {
+      slot = (slot + 1) & mask;
+    }
+
+    method_slots_[slot] = i;
+  }
+
   return !reader.is_error();
 }
 
 
+void ClassFile::IndexBootstrapMethods(int offset) {
+  ByteSource reader = GetData();
+
+  const uint16 attributes_count = reader.ReadUInt16BE(offset);
+  offset += 2;
+
+  for (int i = 0; i < attributes_count; ++i) {
+    const ConstantPool::Utf8Ref* attribute_name =
+        constant_pool_.GetUtf8(reader.ReadUInt16BE(offset));
+    const int attribute_size = reader.ReadInt32BE(offset + 2);
+    if ((attribute_name == nullptr) || reader.is_error()) {
+      LOG(WARNING) << "Failed to read class attribute " << i;
+      return;
+    }
+
+    if (*attribute_name == "BootstrapMethods") {
+      constant_pool_.set_bootstrap_methods(
+          reader.sub(offset + 6, attribute_size));
+      return;
+    }
+
+    offset += 6 + attribute_size;
+  }
+}
+
+
 ConstantPool::ConstantPool(ClassIndexer* class_indexer)
     : class_indexer_(class_indexer) {
 }
 
 
 ConstantPool::~ConstantPool() {
-  for (Item& item : items_) {
-    void* cache = item.cache.load();
+  for (int i = 0; i < items_count_; ++i) {
+    void* cache = cache_[i].load();
     if (cache == nullptr) {
       continue;
     }
 
-    switch (item.type) {
+    ByteSource reader = class_file_;
+    const uint8 type = reader.ReadUInt8(offsets_[i]);
+
+    switch (type) {
       case JVM_CONSTANT_Utf8:
         delete static_cast<Utf8Ref*>(cache);
         break;
@@ -301,9 +417,13 @@ ConstantPool::~ConstantPool() {
         delete static_cast<NameAndTypeRef*>(cache);
         break;
 
+      case JVM_CONSTANT_InvokeDynamic:
+        delete static_cast<InvokeDynamicRef*>(cache);
+        break;
+
       default:
         DCHECK(false) << "Missing cleanup for constant pool item of type "
-                      << static_cast<int>(item.type);
+                      << static_cast<int>(type);
         break;
     }
   }
@@ -311,70 +431,69 @@ ConstantPool::~ConstantPool() {
 
 
 bool ConstantPool::Initialize(ByteSource class_file, int* end_offset) {
-  DCHECK_EQ(0, items_.size()) << "IndexConstantPool can only be called once";
+  DCHECK_EQ(0, items_count_) << "IndexConstantPool can only be called once";
 
   *end_offset = 10;
 
+  class_file_ = class_file;
+
   const uint16 constant_pool_count = class_file.ReadUInt16BE(8);
-  items_ = std::vector<Item>(constant_pool_count);
+  items_count_ = constant_pool_count;
+  offsets_.reset(new uint32[constant_pool_count]());
+  cache_.reset(new std::atomic<void*>[constant_pool_count]);
+  for (int i = 0; i < constant_pool_count; ++i) {
+    cache_[i].store(nullptr, std::memory_order_relaxed);
+  }
 
+  // Only the item boundaries are computed here. Items are decoded on first
+  // use.
   for (int i = 1; i < constant_pool_count; ++i) {
-    int size = 0;
-    switch (class_file.ReadUInt8(*end_offset)) {
-      case JVM_CONSTANT_Fieldref:
-      case JVM_CONSTANT_Methodref:
-      case JVM_CONSTANT_InterfaceMethodref:
-      case JVM_CONSTANT_Integer:
-      case JVM_CONSTANT_Float:
-      case JVM_CONSTANT_NameAndType:
-      case JVM_CONSTANT_InvokeDynamic:
-        size = 5;
-        break;
-
-      case JVM_CONSTANT_Long:
-      case JVM_CONSTANT_Double:
-        size = 9;
-        break;
-
-      case JVM_CONSTANT_Utf8:
-        size = 3 + class_file.ReadUInt16BE(*end_offset + 1);
-        break;
-
-      case JVM_CONSTANT_MethodHandle:
-        size = 4;
-        break;
-
-      default:
-        size = 3;
-        break;
-    }
-
-    if (!InitializeConstantPoolItem(
-            &items_[i],
-            class_file.sub(*end_offset, size))) {
+    const uint8 type = class_file.ReadUInt8(*end_offset);
+    if (class_file.is_error()) {
       LOG(WARNING) << "Failed to initialize constant pool item " << i;
       return false;
     }
 
-    if ((items_[i].type == JVM_CONSTANT_Long) ||
-        (items_[i].type == JVM_CONSTANT_Double)) {
+    offsets_[i] = *end_offset;
+    *end_offset += GetConstantPoolItemSize(class_file, *end_offset);
+
+    if ((type == JVM_CONSTANT_Long) || (type == JVM_CONSTANT_Double)) {
       ++i;
     }
+  }
 
-    *end_offset += size;
+  if ((*end_offset > class_file.size()) || class_file.is_error()) {
+    return false;
   }
 
-  return !class_file.is_error();
+  return true;
 }
 
 
-bool ConstantPool::InitializeConstantPoolItem(
-    ConstantPool::Item* item,
-    ByteSource data) {
-  item->type = data.ReadUInt8(0);
-  item->data = data;
+int ConstantPool::GetConstantPoolItemSize(ByteSource class_file, int offset) {
+  switch (class_file.ReadUInt8(offset)) {
+    case JVM_CONSTANT_Fieldref:
+    case JVM_CONSTANT_Methodref:
+    case JVM_CONSTANT_InterfaceMethodref:
+    case JVM_CONSTANT_Integer:
+    case JVM_CONSTANT_Float:
+    case JVM_CONSTANT_NameAndType:
+    case JVM_CONSTANT_InvokeDynamic:
+      return 5;
 
-  return !data.is_error();
+    case JVM_CONSTANT_Long:
+    case JVM_CONSTANT_Double:
+      return 9;
+
+    case JVM_CONSTANT_Utf8:
+      return 3 + class_file.ReadUInt16BE(offset + 1);
+
+    case JVM_CONSTANT_MethodHandle:
+      return 4;
+
+    default:
+      return 3;
+  }
 }
 
 
@@ -382,27 +501,29 @@ bool ConstantPool::InitializeConstantPoolItem(
 // have to go to the header file.
 template <typename T>
 const T* ConstantPool::Fetch(
-    ConstantPool::Item* item,
+    const Nullable<ConstantPool::Item>& item,
     std::function<std::unique_ptr<T>(uint8, ByteSource)> resolver) {
-  if (item == nullptr) {
+  if (!item.has_value()) {
     LOG(ERROR) << "Null constant pool item";
     return nullptr;  // Error occurred.
   }
 
-  void* p = item->cache.load(std::memory_order_relaxed);
+  std::atomic<void*>* cache = item.value().cache;
+
+  void* p = cache->load(std::memory_order_acquire);
   if (p != nullptr) {
     return reinterpret_cast<T*>(p);  // Common code path.
   }
 
-  std::unique_ptr<T> value = resolver(item->type, item->data);
+  std::unique_ptr<T> value = resolver(item.value().type, item.value().data);
   if (value == nullptr) {
     LOG(ERROR) << "Failed to resolve constant pool item of type "
-               << static_cast<int>(item->type);
+               << static_cast<int>(item.value().type);
     return nullptr;  // Error occurred.
   }
 
   void* expected = nullptr;
-  if (item->cache.compare_exchange_strong(expected, value.get())) {
+  if (cache->compare_exchange_strong(expected, value.get())) {
     return reinterpret_cast<T*>(value.release());  // Cached.
   }
 
@@ -412,15 +533,26 @@ const T* ConstantPool::Fetch(
 }
 
 
-ConstantPool::Item* ConstantPool::GetConstantPoolItem(
+Nullable<ConstantPool::Item> ConstantPool::GetConstantPoolItem(
     int index,
     Nullable<uint8> expected_type) {
-  if ((index < 0) || (index >= items_.size())) {
+  if ((index < 0) || (index >= items_count_)) {
     LOG(ERROR) << "Bad constant pool item " << index;
     return nullptr;
   }
 
-  Item& item = items_[index];
+  Item item;
+  item.cache = &cache_[index];
+
+  const uint32 offset = offsets_[index];
+  if (offset != 0) {
+    ByteSource reader = class_file_;
+    item.type = reader.ReadUInt8(offset);
+    item.data = class_file_.sub(
+        offset,
+        GetConstantPoolItemSize(class_file_, offset));
+  }
+
   if (expected_type.has_value() && (item.type != expected_type.value())) {
     LOG(ERROR) << "Constant pool item " << index << " has type "
                << static_cast<int>(item.type)
@@ -428,17 +560,23 @@ ConstantPool::Item* ConstantPool::GetConstantPoolItem(
     return nullptr;
   }
 
-  return &item;
+  return item;
 }
 
 
 int ConstantPool::GetType(int index) const {
-  if ((index < 0) || (index >= items_.size())) {
+  if ((index < 0) || (index >= items_count_)) {
     LOG(ERROR) << "Bad constant pool item " << index;
     return 0;
   }
 
-  return items_[index].type;
+  const uint32 offset = offsets_[index];
+  if (offset == 0) {
+    return 0;
+  }
+
+  ByteSource reader = class_file_;
+  return reader.ReadUInt8(offset);
 }
 
 
@@ -461,12 +599,12 @@ const ConstantPool::Utf8Ref* ConstantPool::GetUtf8(int index) {
 
 
 Nullable<jint> ConstantPool::GetInteger(int index) {
-  Item* item = GetConstantPoolItem(index, JVM_CONSTANT_Integer);
-  if (item == nullptr) {
+  Nullable<Item> item = GetConstantPoolItem(index, JVM_CONSTANT_Integer);
+  if (!item.has_value()) {
     return nullptr;
   }
 
-  ByteSource data = item->data;
+  ByteSource data = item.value().data;
 
   const int32 value = data.ReadInt32BE(1);
   if (data.is_error()) {
@@ -478,12 +616,12 @@ Nullable<jint> ConstantPool::GetInteger(int index) {
 
 
 Nullable<jfloat> ConstantPool::GetFloat(int index) {
-  Item* item = GetConstantPoolItem(index, JVM_CONSTANT_Float);
-  if (item == nullptr) {
+  Nullable<Item> item = GetConstantPoolItem(index, JVM_CONSTANT_Float);
+  if (!item.has_value()) {
     return nullptr;
   }
 
-  ByteSource data = item->data;
+  ByteSource data = item.value().data;
 
   const int32 value = data.ReadInt32BE(1);
   if (data.is_error()) {
@@ -497,12 +635,12 @@ Nullable<jfloat> ConstantPool::GetFloat(int index) {
 
 
 Nullable<jlong> ConstantPool::GetLong(int index) {
-  Item* item = GetConstantPoolItem(index, JVM_CONSTANT_Long);
-  if (item == nullptr) {
+  Nullable<Item> item = GetConstantPoolItem(index, JVM_CONSTANT_Long);
+  if (!item.has_value()) {
     return nullptr;
   }
 
-  ByteSource data = item->data;
+  ByteSource data = item.value().data;
 
   const int64 value = data.ReadInt64BE(1);
   if (data.is_error()) {
@@ -514,12 +652,12 @@ Nullable<jlong> ConstantPool::GetLong(int index) {
 
 
 Nullable<jdouble> ConstantPool::GetDouble(int index) {
-  Item* item = GetConstantPoolItem(index, JVM_CONSTANT_Double);
-  if (item == nullptr) {
+  Nullable<Item> item = GetConstantPoolItem(index, JVM_CONSTANT_Double);
+  if (!item.has_value()) {
     return nullptr;
   }
 
-  ByteSource data = item->data;
+  ByteSource data = item.value().data;
 
   const int64 value = data.ReadInt64BE(1);
   if (data.is_error()) {
@@ -616,6 +754,199 @@ const ConstantPool::NameAndTypeRef* ConstantPool::GetNameAndType(int index) {
 }
 
 
+const ConstantPool::InvokeDynamicRef* ConstantPool::GetInvokeDynamic(
+    int index) {
+  return Fetch<InvokeDynamicRef>(
+      GetConstantPoolItem(index, JVM_CONSTANT_InvokeDynamic),
+      [this] (uint8 type, ByteSource data)
+          -> std::unique_ptr<InvokeDynamicRef> {
+        const int bootstrap_method_index = data.ReadUInt16BE(1);
+        const int name_and_type_index = data.ReadUInt16BE(3);
+        if (data.is_error()) {
+          return nullptr;
+        }
+
+        const NameAndTypeRef* names = GetNameAndType(name_and_type_index);
+        if (names == nullptr) {
+          return nullptr;
+        }
+
+        std::unique_ptr<InvokeDynamicRef> invoke_dynamic(new InvokeDynamicRef);
+        invoke_dynamic->name = names->name.str();
+
+        if (!ParseJMethodSignature(names->type.str(),
+                                   &invoke_dynamic->signature)) {
+          LOG(ERROR) << "bad call site signature " << names->type.str();
+          return nullptr;
+        }
+
+        // Unsupported call sites are cached too, so that the bootstrap
+        // method is only examined once.
+        invoke_dynamic->is_string_concat = DecodeStringConcat(
+            bootstrap_method_index,
+            invoke_dynamic.get());
+
+        return invoke_dynamic;
+      });
+}
+
+
+bool ConstantPool::DecodeStringConcat(
+    int bootstrap_method_index,
+    InvokeDynamicRef* invoke_dynamic) {
+  // Find the bootstrap method. Each entry has variable size: method handle,
+  // number of static arguments and the static arguments (2 bytes each).
+  ByteSource reader = bootstrap_methods_;
+  if (bootstrap_method_index >= reader.ReadUInt16BE(0)) {
+    return false;
+  }
+
+  int offset = 2;
+  for (int i = 0; i < bootstrap_method_index; ++i) {
+    offset += 4 + 2 * reader.ReadUInt16BE(offset + 2);
+  }
+
+  const int method_handle_index = reader.ReadUInt16BE(offset);
+  const int static_arguments_count = reader.ReadUInt16BE(offset + 2);
+
+  // The method handle is followed by the MethodRef of the bootstrap method.
+  // "GetMethod" is not used, because it would look up the method in the JVM.
+  Nullable<Item> method_handle =
+      GetConstantPoolItem(method_handle_index, JVM_CONSTANT_MethodHandle);
+  if (!method_handle.has_value()) {
+    return false;
+  }
+
+  ByteSource method_handle_data = method_handle.value().data;
+  Nullable<Item> bootstrap_method = GetConstantPoolItem(
+      method_handle_data.ReadUInt16BE(2),
+      JVM_CONSTANT_Methodref);
+  if (!bootstrap_method.has_value()) {
+    return false;
+  }
+
+  ByteSource bootstrap_method_data = bootstrap_method.value().data;
+  const ClassRef* owner = GetClass(bootstrap_method_data.ReadUInt16BE(1));
+  const NameAndTypeRef* names =
+      GetNameAndType(bootstrap_method_data.ReadUInt16BE(3));
+  if (reader.is_error() ||
+      (owner == nullptr) ||
+      (names == nullptr) ||
+      !(owner->internal_name == "java/lang/invoke/StringConcatFactory")) {
+    return false;
+  }
+
+  std::vector<StringConcatElement>& recipe =
+      invoke_dynamic->string_concat_recipe;
+  const int arguments_count = invoke_dynamic->signature.arguments.size();
+
+  // "makeConcat" just concatenates all the arguments.
+  if (names->name == "makeConcat") {
+    for (int i = 0; i < arguments_count; ++i) {
+      recipe.push_back({ i, string() });
+    }
+
+    return true;
+  }
+
+  if (!(names->name == "makeConcatWithConstants") ||
+      (static_arguments_count < 1)) {
+    return false;
+  }
+
+  // The first static argument is the recipe string. Character \1 stands for
+  // the next call site argument and \2 for the next static argument. Both
+  // are single bytes in modified UTF-8.
+  Nullable<Item> recipe_string = GetConstantPoolItem(
+      reader.ReadUInt16BE(offset + 4),
+      JVM_CONSTANT_String);
+  if (!recipe_string.has_value()) {
+    return false;
+  }
+
+  ByteSource recipe_string_data = recipe_string.value().data;
+  const Utf8Ref* recipe_utf8 = GetUtf8(recipe_string_data.ReadUInt16BE(1));
+  if (recipe_utf8 == nullptr) {
+    return false;
+  }
+
+  int next_argument = 0;
+  int next_static_argument = 1;
+  string constant;
+  for (char c : *recipe_utf8) {
+    if (c == '\x01') {
+      if (next_argument >= arguments_count) {
+        return false;
+      }
+
+      if (!constant.empty()) {
+        recipe.push_back({ -1, std::move(constant) });
+        constant.clear();
+      }
+
+      recipe.push_back({ next_argument++, string() });
+    } else if (c == '\x02') {
+      if (next_static_argument >= static_arguments_count) {
+        return false;
+      }
+
+      // Only constants formatted the same way in C++ and in Java are
+      // supported (floating point constants are not).
+      const int index = reader.ReadUInt16BE(offset + 4 +
+                                            2 * next_static_argument++);
+      switch (GetType(index)) {
+        case JVM_CONSTANT_String: {
+          Nullable<Item> item = GetConstantPoolItem(index, JVM_CONSTANT_String);
+          if (!item.has_value()) {
+            return false;
+          }
+
+          ByteSource item_data = item.value().data;
+          const Utf8Ref* utf8 = GetUtf8(item_data.ReadUInt16BE(1));
+          if (utf8 == nullptr) {
+            return false;
+          }
+
+          constant.append(utf8->begin(), utf8->end());
+          break;
+        }
+
+        case JVM_CONSTANT_Integer: {
+          Nullable<jint> value = GetInteger(index);
+          if (!value.has_value()) {
+            return false;
+          }
+
+          constant += std::to_string(value.value());
+          break;
+        }
+
+        case JVM_CONSTANT_Long: {
+          Nullable<jlong> value = GetLong(index);
+          if (!value.has_value()) {
+            return false;
+          }
+
+          constant += std::to_string(value.value());
+          break;
+        }
+
+        default:
+          return false;
+      }
+    } else {
+      constant += c;
+    }
+  }
+
+  if (!constant.empty()) {
+    recipe.push_back({ -1, std::move(constant) });
+  }
+
+  return (next_argument == arguments_count) && !reader.is_error();
+}
+
+
 const ConstantPool::FieldRef* ConstantPool::GetField(int index) {
   return Fetch<FieldRef>(
       GetConstantPoolItem(index, JVM_CONSTANT_Fieldref),
@@ -802,6 +1133,19 @@ ClassFile::Method::Method(ClassFile* class_file)
 }
 
 
+ClassFile::Method::~Method() {
+  if (instructions_cache_ != nullptr) {
+    for (int i = 0; i < code_.size(); ++i) {
+      delete instructions_cache_[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  if (exception_dispatch_table_ != nullptr) {
+    delete exception_dispatch_table_->load(std::memory_order_relaxed);
+  }
+}
+
+
 bool ClassFile::Method::Load(int offset, int* method_size) {
   *method_size = 0;
 
@@ -826,15 +1170,18 @@ bool ClassFile::Method::Load(int offset, int* method_size) {
 
   signature_ = *signature;
 
-  JMethodSignature parsed_signature;
-  if (!ParseJMethodSignature(signature_.str(), &parsed_signature)) {
+  // Method signatures repeat a lot across classes, so they are only parsed
+  // once.
+  std::shared_ptr<const JMethodSignature> parsed_signature =
+      InternJMethodSignature(signature_.str());
+  if (parsed_signature == nullptr) {
     LOG(ERROR) << "Failed to parse method signature " << signature_.str();
     return false;
   }
 
   return_type_ = JSignatureToType(
       class_file_->class_indexer(),
-      parsed_signature.return_type);
+      parsed_signature->return_type);
   if (return_type_ == nullptr) {
     LOG(ERROR) << "Invalid method return type";
     return false;
@@ -855,6 +1202,15 @@ bool ClassFile::Method::Load(int offset, int* method_size) {
       const int code_size_ = data.ReadInt32BE(code_offset_ + 4);
       code_ = data.sub(code_offset_ + 8, code_size_);
 
+      if (code_size_ > 0) {
+        instructions_cache_.reset(
+            new std::atomic<CachedInstruction*>[code_size_]());
+        control_flow_cache_.reset(new std::atomic<uint8>(0));
+        exception_dispatch_table_.reset(
+            new std::atomic<ExceptionDispatchTable*>(nullptr));
+        interpreter_profile_.reset(new InterpreterProfile);
+      }
+
       max_stack_ = data.ReadUInt16BE(code_offset_);
       max_locals_ = data.ReadUInt16BE(code_offset_ + 2);
 
@@ -902,7 +1258,144 @@ Nullable<ClassFile::TryCatchBlock> ClassFile::Method::GetTryCatchBlock(
 }
 
 
-Nullable<ClassFile::Instruction> ClassFile::Method::GetInstruction(int offset) {
+const ClassFile::ExceptionDispatchTable*
+ClassFile::Method::GetExceptionDispatchTable() {
+  if (exception_dispatch_table_ == nullptr) {
+    return nullptr;  // No code.
+  }
+
+  const ExceptionDispatchTable* table =
+      exception_dispatch_table_->load(std::memory_order_acquire);
+  if (table != nullptr) {
+    return table;  // Common code path.
+  }
+
+  // Read failures are not cached, so that the exception dispatch keeps
+  // failing with the same error every time.
+  std::vector<TryCatchBlock> rows;
+  rows.reserve(GetExceptionTableSize());
+  for (int i = 0; i < GetExceptionTableSize(); ++i) {
+    Nullable<TryCatchBlock> row = GetTryCatchBlock(i);
+    if (!row.has_value()) {
+      return nullptr;
+    }
+
+    rows.push_back(row.value());
+  }
+
+  std::unique_ptr<ExceptionDispatchTable> new_table(
+      new ExceptionDispatchTable(std::move(rows)));
+
+  ExceptionDispatchTable* expected = nullptr;
+  if (exception_dispatch_table_->compare_exchange_strong(
+          expected,
+          new_table.get(),
+          std::memory_order_acq_rel)) {
+    return new_table.release();
+  }
+
+  // Another thread just built the table, discard "new_table".
+  DCHECK(expected != nullptr);
+  return expected;
+}
+
+
+ClassFile::ExceptionDispatchTable::ExceptionDispatchTable(
+    std::vector<TryCatchBlock> rows)
+    : rows_(std::move(rows)),
+      catch_classes_(new std::atomic<jclass>[rows_.size()]()) {
+  for (const TryCatchBlock& row : rows_) {
+    if (row.begin_offset < row.end_offset) {
+      boundaries_.push_back(row.begin_offset);
+      boundaries_.push_back(row.end_offset);
+    }
+  }
+
+  std::sort(boundaries_.begin(), boundaries_.end());
+  boundaries_.erase(
+      std::unique(boundaries_.begin(), boundaries_.end()),
+      boundaries_.end());
+
+  // Rows are added to each range in the exception table order, since the
+  // first matching row takes precedence.
+  for (int i = 0; i + 1 < boundaries_.size(); ++i) {
+    range_first_.push_back(range_rows_.size());
+    for (int j = 0; j < rows_.size(); ++j) {
+      if ((rows_[j].begin_offset <= boundaries_[i]) &&
+          (rows_[j].end_offset >= boundaries_[i + 1])) {
+        range_rows_.push_back(j);
+      }
+    }
+  }
+
+  range_first_.push_back(range_rows_.size());
+}
+
+
+void ClassFile::ExceptionDispatchTable::Find(
+    int offset,
+    const int** begin,
+    const int** end) const {
+  *begin = nullptr;
+  *end = nullptr;
+
+  // Index of the last boundary not greater than "offset".
+  const int range = std::upper_bound(
+      boundaries_.begin(),
+      boundaries_.end(),
+      offset) - boundaries_.begin() - 1;
+  if ((range < 0) || (range + 1 >= boundaries_.size())) {
+    return;  // Not covered by any row.
+  }
+
+  *begin = range_rows_.data() + range_first_[range];
+  *end = range_rows_.data() + range_first_[range + 1];
+}
+
+
+jclass ClassFile::ExceptionDispatchTable::GetCatchClass(int index) const {
+  const ConstantPool::ClassRef* type = rows_[index].type;
+  if (type == nullptr) {
+    return nullptr;
+  }
+
+  jclass cls = catch_classes_[index].load(std::memory_order_relaxed);
+  if (cls == nullptr) {
+    // "FindClass" keeps the global reference and returns the same one for
+    // all the calls, so racing threads store the same value.
+    cls = type->type->FindClass();
+    if (cls != nullptr) {
+      catch_classes_[index].store(cls, std::memory_order_relaxed);
+    }
+  }
+
+  return cls;
+}
+
+
+int ClassFile::LookupSwitchTable::Find(int32 value) const {
+  int begin = 0;
+  int end = size_;
+  while (begin < end) {
+    const int middle = begin + (end - begin) / 2;
+    if (rows_[middle * 2] < value) {
+      begin = middle + 1;
+    } else {
+      end = middle;
+    }
+  }
+
+  if ((begin < size_) && (rows_[begin * 2] == value)) {
+    return begin;
+  }
+
+  return -1;
+}
+
+
+Nullable<ClassFile::Instruction> ClassFile::Method::GetInstruction(
+    int offset,
+    std::unique_ptr<int32[]>* switch_table) {
   ByteSource code = code_.sub(offset, code_.size());
 
   Instruction instruction;
@@ -959,12 +1452,26 @@ Nullable<ClassFile::Instruction> ClassFile::Method::GetInstruction(int offset) {
       int32 low = code.ReadInt32BE(operand_offset + 4);
       int32 high = code.ReadInt32BE(operand_offset + 8);
       int32 table_offset = operand_offset + 12;
-      int32 table_size = (high - low + 1) * 4;
+      int64 rows = static_cast<int64>(high) - low + 1;
+      if (code.is_error() || (rows < 0) || (rows * 4 > code.size())) {
+        return nullptr;
+      }
+
+      ByteSource table = code.sub(table_offset, rows * 4);
+      switch_table->reset(new int32[rows]);
+      for (int row = 0; row < rows; ++row) {
+        (*switch_table)[row] = table.ReadInt32BE(row * 4);
+      }
+
+      if (table.is_error()) {
+        return nullptr;
+      }
 
       operand.low = low;
       operand.default_handler_offset = code.ReadInt32BE(operand_offset);
-      operand.table = TableSwitchTable(code.sub(table_offset, table_size));
-      instruction.next_instruction_offset = offset + table_offset + table_size;
+      operand.table = TableSwitchTable(switch_table->get(), rows);
+      instruction.next_instruction_offset =
+          offset + table_offset + rows * 4;
       break;
     }
 
@@ -974,11 +1481,41 @@ Nullable<ClassFile::Instruction> ClassFile::Method::GetInstruction(int offset) {
       // Skips opcode and 0 to 3 padding bytes.
       const int operand_offset = 4 - (offset & 3);
       int32 table_offset = operand_offset + 8;
-      int32 table_size = code.ReadInt32BE(operand_offset + 4) * 8;
+      int32 rows = code.ReadInt32BE(operand_offset + 4);
+      if (code.is_error() ||
+          (rows < 0) ||
+          (static_cast<int64>(rows) * 8 > code.size())) {
+        return nullptr;
+      }
+
+      ByteSource table = code.sub(table_offset, rows * 8);
+      switch_table->reset(new int32[rows * 2]);
+      int32* pairs = switch_table->get();
+      for (int row = 0; row < rows * 2; ++row) {
+        pairs[row] = table.ReadInt32BE(row * 4);
+      }
+
+      if (table.is_error()) {
+        return nullptr;
+      }
+
+      // The JVM specification requires the table to be sorted by value. We
+      // don't trust the class file and sort it anyway.
+      std::vector<std::pair<int32, int32>> sorted_rows(rows);
+      for (int row = 0; row < rows; ++row) {
+        sorted_rows[row] = std::make_pair(pairs[row * 2], pairs[row * 2 + 1]);
+      }
+
+      std::sort(sorted_rows.begin(), sorted_rows.end());
+      for (int row = 0; row < rows; ++row) {
+        pairs[row * 2] = sorted_rows[row].first;
+        pairs[row * 2 + 1] = sorted_rows[row].second;
+      }
 
       operand.default_handler_offset = code.ReadInt32BE(operand_offset);
-      operand.table = LookupSwitchTable(code.sub(table_offset, table_size));
-      instruction.next_instruction_offset = offset + table_offset + table_size;
+      operand.table = LookupSwitchTable(pairs, rows);
+      instruction.next_instruction_offset =
+          offset + table_offset + rows * 8;
       break;
     }
 
@@ -1062,8 +1599,12 @@ Nullable<ClassFile::Instruction> ClassFile::Method::GetInstruction(int offset) {
       instruction.next_instruction_offset = offset + 3;
       break;
 
-    // TODO(vlif): implement support for INVOKE_DYNAMIC instruction.
+    // Only string concatenation call sites can be executed. The operand is
+    // left null if the call site could not be decoded, which is reported
+    // when the instruction is executed.
     case InstructionType::INVOKEDYNAMIC:
+      instruction.invoke_dynamic_operand =
+          class_file_->constant_pool()->GetInvokeDynamic(code.ReadUInt16BE(1));
       instruction.next_instruction_offset = offset + 5;
       break;
 
@@ -1084,12 +1625,223 @@ Nullable<ClassFile::Instruction> ClassFile::Method::GetInstruction(int offset) {
 }
 
 
+const ClassFile::Instruction* ClassFile::Method::GetCachedInstruction(
+    int offset) {
+  if ((instructions_cache_ == nullptr) ||
+      (offset < 0) ||
+      (offset >= code_.size())) {
+    return nullptr;
+  }
+
+  std::atomic<CachedInstruction*>& slot = instructions_cache_[offset];
+
+  const CachedInstruction* cached_instruction =
+      slot.load(std::memory_order_acquire);
+  if (cached_instruction != nullptr) {
+    return &cached_instruction->instruction;  // Common code path.
+  }
+
+  // Decoding failures are not cached, so that the instruction keeps failing
+  // with the same error every time it is executed.
+  std::unique_ptr<CachedInstruction> new_instruction(new CachedInstruction);
+  Nullable<Instruction> instruction =
+      GetInstruction(offset, &new_instruction->switch_table);
+  if (!instruction.has_value()) {
+    return nullptr;
+  }
+
+  new_instruction->instruction = instruction.value();
+
+  // The receiver class of a virtual call rarely changes between executions
+  // of the same instruction, so its call target is worth caching.
+  if ((instruction.value().opcode == JVM_OPC_invokevirtual) ||
+      (instruction.value().opcode == JVM_OPC_invokeinterface)) {
+    new_instruction->call_target_cache.reset(new CallTargetCache);
+    new_instruction->instruction.call_target_cache =
+        new_instruction->call_target_cache.get();
+  }
+
+  CachedInstruction* expected = nullptr;
+  if (slot.compare_exchange_strong(
+          expected,
+          new_instruction.get(),
+          std::memory_order_acq_rel)) {
+    return &new_instruction.release()->instruction;  // Cached.
+  }
+
+  // Another thread just populated cache, discard "new_instruction".
+  DCHECK(expected != nullptr);
+  return &expected->instruction;
+}
+
+
 ClassFile::InstructionType ClassFile::Method::GetInstructionType(
     uint8 opcode) {
   static InstructionType* map = BuildInstructionTypeMap();
   return map[opcode];
 }
 
+
+ClassFile::ControlFlow ClassFile::Method::GetControlFlow() {
+  if (control_flow_cache_ == nullptr) {
+    return ControlFlow::StraightLine;  // No code.
+  }
+
+  uint8 cached = control_flow_cache_->load(std::memory_order_relaxed);
+  if (cached == 0) {
+    // Concurrent threads might run the analysis at the same time, but they
+    // will all store the same value.
+    cached = static_cast<uint8>(AnalyzeControlFlow()) + 1;
+    control_flow_cache_->store(cached, std::memory_order_relaxed);
+  }
+
+  return static_cast<ControlFlow>(cached - 1);
+}
+
+
+ClassFile::ControlFlow ClassFile::Method::AnalyzeControlFlow() const {
+  // Size of a single row in exception table in .class file.
+  constexpr int kExceptionTableRowSize = 8;
+
+  // Exception handler that doesn't follow the protected code can be
+  // reached again from the protected code through a thrown exception.
+  ByteSource exception_table = exception_table_;
+  for (int i = 0; i < GetExceptionTableSize(); ++i) {
+    const int row = i * kExceptionTableRowSize;
+    const uint16 end_offset = exception_table.ReadUInt16BE(row + 2);
+    const uint16 handler_offset = exception_table.ReadUInt16BE(row + 4);
+    if (handler_offset < end_offset) {
+      return ControlFlow::Cyclic;
+    }
+  }
+
+  if (exception_table.is_error()) {
+    return ControlFlow::Cyclic;
+  }
+
+  // Walks the instructions without decoding the operands (which would
+  // resolve constant pool entries).
+  ByteSource code = code_;
+  bool has_calls = false;
+  int offset = 0;
+  while (offset < code.size()) {
+    const uint8 opcode = code.ReadUInt8(offset);
+
+    if ((opcode == JVM_OPC_jsr) ||
+        (opcode == JVM_OPC_jsr_w) ||
+        (opcode == JVM_OPC_ret)) {
+      return ControlFlow::Cyclic;
+    }
+
+    int branch_offset = 1;  // Relative offset of the branch target.
+    int size = 0;
+
+    switch (GetInstructionType(opcode)) {
+      case InstructionType::NO_ARG:
+      case InstructionType::IMPLICIT_LOCAL_VAR_INDEX:
+        size = 1;
+        break;
+
+      case InstructionType::INT8:
+      case InstructionType::LOCAL_VAR_INDEX:
+      case InstructionType::LDC:
+        size = 2;
+        break;
+
+      case InstructionType::INT16:
+      case InstructionType::LDC_W:
+      case InstructionType::TYPE:
+      case InstructionType::FIELD:
+      case InstructionType::IINC:
+        size = 3;
+        break;
+
+      case InstructionType::METHOD:
+        has_calls = true;
+        size = 3;
+        break;
+
+      case InstructionType::INVOKEINTERFACE:
+      case InstructionType::INVOKEDYNAMIC:
+        has_calls = true;
+        size = 5;
+        break;
+
+      case InstructionType::MULTIANEWARRAY:
+        size = 4;
+        break;
+
+      case InstructionType::LABEL:
+        branch_offset = code.ReadInt16BE(offset + 1);
+        size = 3;
+        break;
+
+      case InstructionType::LABEL_W:
+        branch_offset = code.ReadInt32BE(offset + 1);
+        size = 5;
+        break;
+
+      case InstructionType::WIDE:
+        if (code.ReadUInt8(offset + 1) == JVM_OPC_ret) {
+          return ControlFlow::Cyclic;
+        }
+
+        size = (code.ReadUInt8(offset + 1) == JVM_OPC_iinc) ? 6 : 4;
+        break;
+
+      case InstructionType::TABLESWITCH: {
+        const int operand_offset = offset + 4 - (offset & 3);
+        const int32 low = code.ReadInt32BE(operand_offset + 4);
+        const int32 high = code.ReadInt32BE(operand_offset + 8);
+        const int64 count = static_cast<int64>(high) - low + 1;
+        if ((count < 0) || (count > code.size())) {
+          return ControlFlow::Cyclic;  // Corrupted instruction.
+        }
+
+        branch_offset = code.ReadInt32BE(operand_offset);
+        for (int row = 0; row < count; ++row) {
+          branch_offset = std::min(
+              branch_offset,
+              code.ReadInt32BE(operand_offset + 12 + row * 4));
+        }
+
+        size = operand_offset - offset + 12 + count * 4;
+        break;
+      }
+
+      case InstructionType::LOOKUPSWITCH: {
+        const int operand_offset = offset + 4 - (offset & 3);
+        const int32 count = code.ReadInt32BE(operand_offset + 4);
+        if ((count < 0) || (count > code.size())) {
+          return ControlFlow::Cyclic;  // Corrupted instruction.
+        }
+
+        branch_offset = code.ReadInt32BE(operand_offset);
+        for (int row = 0; row < count; ++row) {
+          branch_offset = std::min(
+              branch_offset,
+              code.ReadInt32BE(operand_offset + 8 + row * 8 + 4));
+        }
+
+        size = operand_offset - offset + 8 + count * 8;
+        break;
+      }
+    }
+
+    if (code.is_error() || (size <= 0)) {
+      return ControlFlow::Cyclic;  // Can't analyze, assume the worst.
+    }
+
+    if (branch_offset <= 0) {
+      return ControlFlow::Cyclic;
+    }
+
+    offset += size;
+  }
+
+  return has_calls ? ControlFlow::Acyclic : ControlFlow::StraightLine;
+}
+
 }  // namespace cdbg
 }  // namespace devtools
 
@@ -20,6 +20,7 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <vector>
 #include "nullable.h"
 #include "byte_source.h"
 #include "class_indexer.h"
@@ -30,6 +31,8 @@
 namespace devtools {
 namespace cdbg {
 
+class CallTargetCache;
+
 // Reads constant pool and resolve references to classes, methods and fields
 // into types internally used in the Cloud Debugger code. This class only
 // keeps pointers. It doesn't own the buffers.
@@ -171,6 +174,33 @@ class ConstantPool {
     jmethodID method_id = nullptr;
   };
 
+  // Piece of a string concatenation recipe.
+  struct StringConcatElement {
+    // Index of the call site argument or -1 for a constant.
+    int argument_index;
+
+    // Constant (modified UTF-8) if "argument_index" is -1.
+    string constant;
+  };
+
+  // InvokeDynamic constant pool entry.
+  struct InvokeDynamicRef {
+    // Name of the call site (e.g. "makeConcatWithConstants").
+    string name;
+
+    // Arguments taken from the stack and the return type of the call site.
+    JMethodSignature signature;
+
+    // True if the call site concatenates strings (bootstrapped by
+    // "StringConcatFactory"). Other call sites (e.g. lambdas) are resolved
+    // by the JVM at runtime and can't be executed natively.
+    bool is_string_concat = false;
+
+    // Concatenation recipe decoded into a sequence of constants and call
+    // site arguments. Adjacent constants are merged.
+    std::vector<StringConcatElement> string_concat_recipe;
+  };
+
   explicit ConstantPool(ClassIndexer* class_indexer);
 
   ~ConstantPool();
@@ -213,8 +243,18 @@ class ConstantPool {
   // Reads NameAndType entry from constant pool. Returns nullptr on error.
   const NameAndTypeRef* GetNameAndType(int index);
 
+  // Reads InvokeDynamic entry from constant pool. Returns nullptr on error.
+  const InvokeDynamicRef* GetInvokeDynamic(int index);
+
+  // Sets the content of the "BootstrapMethods" class attribute referenced by
+  // InvokeDynamic entries. Must be called before "GetInvokeDynamic".
+  void set_bootstrap_methods(ByteSource bootstrap_methods) {
+    bootstrap_methods_ = bootstrap_methods;
+  }
+
  private:
-  // Constant pool item.
+  // View of a single constant pool item. Built on demand from the item
+  // offset, so that unused items cost only an offset and a cache slot.
   struct Item {
     // Type of this constant pool entry or 0 if this is not a valid item.
     uint8 type { 0 };
@@ -223,32 +263,56 @@ class ConstantPool {
     ByteSource data;
 
     // Expanded content of the constant pool item or nullptr if not cached
-    // yet. The actual type depends on constant pool item type.
-    std::atomic<void*> cache { nullptr };
+    // yet. The actual type depends on constant pool item type. Points to
+    // the slot in "cache_".
+    std::atomic<void*>* cache { nullptr };
   };
 
-  // Gets the buffer of the specified constant pool entry. Returns nullptr
-  // if the index is invalid or if the entry has a type different from
-  // "expected_type". If "expected_type" is null, the type is not checked.
-  Item* GetConstantPoolItem(int index, Nullable<uint8> expected_type);
+  // Gets the specified constant pool entry. Returns nullptr if the index is
+  // invalid or if the entry has a type different from "expected_type". If
+  // "expected_type" is null, the type is not checked.
+  Nullable<Item> GetConstantPoolItem(int index, Nullable<uint8> expected_type);
 
-  // Initializes constant pool item with no cache.
-  bool InitializeConstantPoolItem(Item* item, ByteSource data);
+  // Computes the size of the constant pool item starting at "offset" of the
+  // class file.
+  static int GetConstantPoolItemSize(ByteSource class_file, int offset);
 
   // If resolved constant pool item is already in cache, just returns it.
   // Otherwise loads the cache and returns pointer to it. Returns nullptr
-  // on failures.
+  // on failures. Each item is resolved without locks and is published once
+  // with atomic compare-and-swap.
   template <typename T>
   static const T* Fetch(
-      Item* item,
+      const Nullable<Item>& item,
       std::function<std::unique_ptr<T>(uint8, ByteSource)> resolver);
 
+  // Decodes the recipe of a string concatenation call site into
+  // "invoke_dynamic". Returns false if the bootstrap method is not a
+  // supported "StringConcatFactory" method.
+  bool DecodeStringConcat(
+      int bootstrap_method_index,
+      InvokeDynamicRef* invoke_dynamic);
+
  private:
   // Resolves class signatures to class objects. Not owned by this class.
   ClassIndexer* const class_indexer_;
 
-  // Points to buffer of each constant pool item.
-  std::vector<Item> items_;
+  // Class file BLOB. Not owned by this class.
+  ByteSource class_file_;
+
+  // Number of constant pool entries (including the unused entry 0).
+  int items_count_ { 0 };
+
+  // Offset of each constant pool item in "class_file_" or 0 if this is not
+  // a valid item (e.g. second slot of a long constant).
+  std::unique_ptr<uint32[]> offsets_;
+
+  // Resolved content of each constant pool item (see "Item::cache").
+  std::unique_ptr<std::atomic<void*>[]> cache_;
+
+  // Content of "BootstrapMethods" class attribute (empty if the class has
+  // no such attribute).
+  ByteSource bootstrap_methods_;
 
   DISALLOW_COPY_AND_ASSIGN(ConstantPool);
 };
@@ -271,48 +335,104 @@ class ClassFile {
   };
 
 
-  // Reader class for offsets table in TABLESWITCH instruction.
+  // Offsets table of TABLESWITCH instruction decoded to host byte order.
+  // The table memory is owned by the decoded instruction.
   class TableSwitchTable {
    public:
     TableSwitchTable() {}
 
-    explicit TableSwitchTable(ByteSource table) : table_(table) {}
+    TableSwitchTable(const int32* offsets, int size)
+        : offsets_(offsets),
+          size_(size) {
+    }
 
     // Gets the number of rows in the table.
-    int size() const { return table_.size() / sizeof(int32); }
+    int size() const { return size_; }
 
-    // Reads the specified row from the table.
-    int32 offset(int row) { return table_.ReadInt32BE(row * sizeof(int32)); }
-
-    // Returns true if previous read operations failed.
-    bool is_error() const { return table_.is_error(); }
+    // Gets the offset (relative to the switch instruction) in the specified
+    // row from the table.
+    int32 offset(int row) const { return offsets_[row]; }
 
    private:
-    ByteSource table_;
+    const int32* offsets_ { nullptr };
+    int size_ { 0 };
   };
 
 
-  // Reader class for lookup table in LOOKUPSWITCH instruction.
+  // Lookup table of LOOKUPSWITCH instruction decoded to host byte order.
+  // Rows are sorted by value. The table memory is owned by the decoded
+  // instruction.
   class LookupSwitchTable {
    public:
     LookupSwitchTable() {}
 
-    explicit LookupSwitchTable(ByteSource table) : table_(table) {}
+    // "rows" is an array of "size" pairs of (value, offset).
+    LookupSwitchTable(const int32* rows, int size)
+        : rows_(rows),
+          size_(size) {
+    }
 
     // Gets the number of rows in the table.
-    int size() const { return table_.size() / 8; }
+    int size() const { return size_; }
 
-    // Reads value in the specified row from the table.
-    int32 value(int row) { return table_.ReadInt32BE(row * 8); }
+    // Gets value in the specified row from the table.
+    int32 value(int row) const { return rows_[row * 2]; }
 
-    // Reads offset in the specified row from the table.
-    int32 offset(int row) { return table_.ReadInt32BE(row * 8 + 4); }
+    // Gets offset in the specified row from the table.
+    int32 offset(int row) const { return rows_[row * 2 + 1]; }
 
-    // Returns true if previous read operations failed.
-    bool is_error() const { return table_.is_error(); }
+    // Finds the row with the specified value using binary search. Returns -1
+    // if the table has no such row.
+    int Find(int32 value) const;
 
    private:
-    ByteSource table_;
+    const int32* rows_ { nullptr };
+    int size_ { 0 };
+  };
+
+
+  // Exception table of a method rearranged for exception dispatch. The code
+  // is split into sorted ranges, such that all the offsets within a range
+  // are covered by the same rows of the exception table. Finding the
+  // handlers for a thrown exception is then a binary search. The catch
+  // classes are resolved on first use and cached.
+  //
+  // This class is thread safe.
+  class ExceptionDispatchTable {
+   public:
+    explicit ExceptionDispatchTable(std::vector<TryCatchBlock> rows);
+
+    // Gets the row in the exception table order.
+    const TryCatchBlock& row(int index) const { return rows_[index]; }
+
+    // Finds the rows covering the specified code offset. The matching row
+    // indexes are returned in the exception table order as a range
+    // [*begin..*end) that can be empty.
+    void Find(int offset, const int** begin, const int** end) const;
+
+    // Gets the catch class of the specified row. Returns nullptr if the row
+    // catches all exceptions or if the class hasn't been loaded yet. The
+    // returned reference is owned by the catch type and stays valid while
+    // the class file is loaded.
+    jclass GetCatchClass(int index) const;
+
+   private:
+    // Rows of the exception table in their original order.
+    const std::vector<TryCatchBlock> rows_;
+
+    // Sorted distinct range boundaries. Range "i" is
+    // [boundaries_[i]..boundaries_[i + 1]).
+    std::vector<int> boundaries_;
+
+    // Indexes of the rows covering each range. Rows of range "i" are
+    // stored in "range_rows_" at [range_first_[i]..range_first_[i + 1]).
+    std::vector<int> range_first_;
+    std::vector<int> range_rows_;
+
+    // Catch classes resolved by "GetCatchClass" indexed by row.
+    std::unique_ptr<std::atomic<jclass>[]> catch_classes_;
+
+    DISALLOW_COPY_AND_ASSIGN(ExceptionDispatchTable);
   };
 
 
@@ -374,10 +494,18 @@ class ClassFile {
 
       // Operand for invoke method instructions.
       const ConstantPool::MethodRef* method_operand;
+
+      // Operand for INVOKEDYNAMIC instruction.
+      const ConstantPool::InvokeDynamicRef* invoke_dynamic_operand;
     };
 
     // Offset to the next instruction starting (relative to first instruction).
     int next_instruction_offset;
+
+    // Inline cache of the call target of INVOKEVIRTUAL and INVOKEINTERFACE
+    // instructions decoded by "GetCachedInstruction" or nullptr otherwise.
+    // Owned by the cached instruction.
+    CallTargetCache* call_target_cache;
   };
 
   // Classification of a Java instruction. All instructions of the same type
@@ -405,14 +533,42 @@ class ClassFile {
     WIDE                        // WIDE instruction.
   };
 
+  // Static classification of the method code by the number of times its
+  // instructions can execute in a single call.
+  enum class ControlFlow : uint8 {
+    // No branches back and no method calls. Each instruction executes at
+    // most once, so the cost of a call is bounded by the code size.
+    StraightLine,
+
+    // No branches back, but the method calls other methods. The cost of
+    // the method itself is bounded, the cost of the callees is not.
+    Acyclic,
+
+    // The method has loops (or constructs that we can't analyze, like
+    // subroutines). The cost of a call depends on the data.
+    Cyclic
+  };
+
   // Information about a single method in a class file.
   class Method {
    public:
+    // Statistics of interpreted calls to the method shared by all threads.
+    struct InterpreterProfile {
+      // Largest instructions quota that a call of this method still ran out
+      // of. Zero if no call ran out of quota since the last successful call.
+      std::atomic<int32> exhausted_quota { 0 };
+
+      // Number of calls rejected upfront because of "exhausted_quota".
+      std::atomic<int32> rejected_calls { 0 };
+    };
+
     // "class_file" not owned by this class and must outlive it.
     explicit Method(ClassFile* class_file);
 
     Method(Method&& other) = default;
 
+    ~Method();
+
     // Gets weak reference to the constant pool.
     ClassFile* class_file() { return class_file_; }
 
@@ -454,13 +610,48 @@ class ClassFile {
     // Reads single entry from exception table. Returns nullptr on error.
     Nullable<TryCatchBlock> GetTryCatchBlock(int index);
 
+    // Gets the exception table rearranged for exception dispatch. The table
+    // is built on first use and shared by all the threads that execute this
+    // method. Returns nullptr on error or if the method has no code.
+    const ExceptionDispatchTable* GetExceptionDispatchTable();
+
     // Reads instruction at the specified byte offset from the first
-    // instruction. Returns nullptr on error.
-    Nullable<Instruction> GetInstruction(int offset);
+    // instruction. Switch tables are decoded into "switch_table", which
+    // must outlive the returned instruction. Returns nullptr on error.
+    Nullable<Instruction> GetInstruction(
+        int offset,
+        std::unique_ptr<int32[]>* switch_table);
+
+    // Same as "GetInstruction", but each instruction is only decoded once.
+    // The decoded instruction is cached and shared by all the threads that
+    // execute this method. Returns nullptr on error.
+    const Instruction* GetCachedInstruction(int offset);
 
     // Gets classification of an instruction by opcode.
     static InstructionType GetInstructionType(uint8 opcode);
 
+    // Classifies the method code (see "ControlFlow"). The bytecode is only
+    // scanned once, the result is cached.
+    ControlFlow GetControlFlow();
+
+    // Gets statistics of interpreted calls to this method or nullptr if the
+    // method has no code.
+    InterpreterProfile* interpreter_profile() {
+      return interpreter_profile_.get();
+    }
+
+   private:
+    // Instruction decoded by "GetCachedInstruction" together with the
+    // storage it refers to.
+    struct CachedInstruction {
+      Instruction instruction;
+      std::unique_ptr<int32[]> switch_table;
+      std::unique_ptr<CallTargetCache> call_target_cache;
+    };
+
+    // Scans the bytecode to compute "ControlFlow" of the method.
+    ControlFlow AnalyzeControlFlow() const;
+
    private:
     // Class file that defined this method. Not owned by this class.
     ClassFile* const class_file_;
@@ -489,6 +680,24 @@ class ClassFile {
     // Exception table buffer.
     ByteSource exception_table_;
 
+    // Instructions decoded by "GetCachedInstruction" indexed by the byte
+    // offset of the instruction. Instructions are decoded lazily, the array
+    // has an entry for each byte of "code_".
+    std::unique_ptr<std::atomic<CachedInstruction*>[]> instructions_cache_;
+
+    // Cached result of "AnalyzeControlFlow" plus one, or zero if not
+    // computed yet. Allocated together with "instructions_cache_" since
+    // "Method" needs to stay movable.
+    std::unique_ptr<std::atomic<uint8>> control_flow_cache_;
+
+    // Table built by "GetExceptionDispatchTable" or nullptr if not built yet.
+    // Allocated together with "instructions_cache_".
+    std::unique_ptr<std::atomic<ExceptionDispatchTable*>>
+        exception_dispatch_table_;
+
+    // Statistics of interpreted calls to this method.
+    std::unique_ptr<InterpreterProfile> interpreter_profile_;
+
     DISALLOW_COPY_AND_ASSIGN(Method);
   };
 
@@ -506,8 +715,15 @@ class ClassFile {
       ClassIndexer* class_indexer,
       string blob);
 
+  // Loads the class file from a BLOB without copying it. The BLOB is not
+  // owned by this class, must not change and must outlive it. Returns nullptr
+  // if this is not a valid class file.
+  static std::unique_ptr<ClassFile> LoadFromExternalBlob(
+      ClassIndexer* class_indexer,
+      ByteSource blob);
+
   // Gets a class file data wrapper.
-  ByteSource GetData() const { return ByteSource(buffer_); }
+  ByteSource GetData() const { return data_; }
 
   // Reads class modifiers (e.g. public, static). Returns nullptr on error.
   Nullable<int> GetClassModifiers() const;
@@ -530,7 +746,8 @@ class ClassFile {
   // Gets method by index.
   Method* GetMethod(int method_index) { return &methods_[method_index]; }
 
-  // Find a particular method in the class file.
+  // Find a particular method in the class file. Takes constant time: methods
+  // are hashed by name and signature when the class file is loaded.
   Method* FindMethod(
       bool is_static,
       const string& name,
@@ -540,6 +757,9 @@ class ClassFile {
   // Does not take ownership of "class_indexer" which must outlive this object.
   ClassFile(ClassIndexer* class_indexer, string buffer);
 
+  // Same as above, but references external buffer instead of owning it.
+  ClassFile(ClassIndexer* class_indexer, ByteSource external_buffer);
+
   // Reads the structure of the class file and prepares indexes.
   bool Initialize();
 
@@ -556,10 +776,25 @@ class ClassFile {
   // Creates an index of class methods. Raises error on corrupt input.
   bool IndexMethods();
 
+  // Finds the "BootstrapMethods" attribute among the class attributes
+  // starting at "offset". Corrupt or missing attribute only disables
+  // INVOKEDYNAMIC instructions.
+  void IndexBootstrapMethods(int offset);
+
+  // Computes the hash of a method name and signature for "method_slots_".
+  static uint32 HashMethodKey(
+      const char* name,
+      int name_size,
+      const char* signature,
+      int signature_size);
+
  private:
-  // Class file BLOB.
+  // Class file BLOB (empty if the class file references external buffer).
   const string buffer_;
 
+  // Class file data (either "buffer_" or external buffer).
+  const ByteSource data_;
+
   // Offset of the first byte beyond the constant pool in the class file.
   int constant_pool_end_offset_ { 0 };
 
@@ -575,6 +810,11 @@ class ClassFile {
   // Information and readers about each method.
   std::vector<Method> methods_;
 
+  // Open addressing hash table of "methods_" keyed by name and signature.
+  // Each slot is an index in "methods_" or -1 if the slot is empty. The
+  // number of slots is a power of 2 at least twice the number of methods.
+  std::vector<int> method_slots_;
+
   DISALLOW_COPY_AND_ASSIGN(ClassFile);
 };
 
@@ -16,25 +16,137 @@
 
 #include "class_files_cache.h"
 
+#include <algorithm>
+#include <cstring>
+#include "lz4_block.h"
+#include "statistician.h"
+
+DEFINE_int32(
+    cdbg_class_files_cold_tier_size,
+    1024 * 1024,  // 1 MB.
+    "Maximum total size of the compressed class files evicted from the "
+    "class files cache that are kept to avoid loading them again (0 to "
+    "disable)");
+
 namespace devtools {
 namespace cdbg {
 
+// Fraction of the cache space reserved for classes of the system tier.
+constexpr int kSystemTierSharePercent = 25;
+
+constexpr int ClassFilesCache::kTiersCount;
+constexpr int ClassFilesCache::kShardsCount;
+
+
+// Determines the cache tier of the class.
+static ClassFilesCache::Tier GetClassTier(jobject cls) {
+  jobject class_loader = nullptr;
+  jvmtiError err = jvmti()->GetClassLoader(
+      static_cast<jclass>(cls),
+      &class_loader);
+  if (err != JVMTI_ERROR_NONE) {
+    return ClassFilesCache::Tier::Application;
+  }
+
+  if (class_loader != nullptr) {
+    jni()->DeleteLocalRef(class_loader);
+    return ClassFilesCache::Tier::Application;
+  }
+
+  return ClassFilesCache::Tier::System;
+}
+
+
+ClassFilesCache::FrequencySketch::FrequencySketch() {
+  memset(counters_, 0, sizeof(counters_));
+}
+
+
+int ClassFilesCache::FrequencySketch::GetIndex(jint hash_code, int row) {
+  // Derive independent hash functions by mixing the hash code with a
+  // different odd multiplier for each row.
+  static const uint32 kSeeds[kDepth] = {
+    0x9E3779B1u, 0x85EBCA77u, 0xC2B2AE3Du, 0x27D4EB2Fu
+  };
+
+  uint32 h = static_cast<uint32>(hash_code) * kSeeds[row];
+  h ^= h >> 16;
+  return h & (kWidth - 1);
+}
+
+
+void ClassFilesCache::FrequencySketch::Increment(jint hash_code) {
+  for (int row = 0; row < kDepth; ++row) {
+    uint8& counter = counters_[row][GetIndex(hash_code, row)];
+    if (counter < kMaxCount) {
+      ++counter;
+    }
+  }
+
+  ++increments_;
+  if (increments_ >= kResetInterval) {
+    for (int row = 0; row < kDepth; ++row) {
+      for (int i = 0; i < kWidth; ++i) {
+        counters_[row][i] >>= 1;
+      }
+    }
+
+    increments_ = 0;
+  }
+}
+
+
+int ClassFilesCache::FrequencySketch::Estimate(jint hash_code) const {
+  int estimate = kMaxCount;
+  for (int row = 0; row < kDepth; ++row) {
+    estimate = std::min<int>(
+        estimate,
+        counters_[row][GetIndex(hash_code, row)]);
+  }
+
+  return estimate;
+}
+
+
 ClassFilesCache::ClassFilesCache(ClassIndexer* class_indexer, int max_size)
     : class_indexer_(class_indexer),
       max_size_(max_size) {
+  memory_budget_cookie_ = MemoryBudget::GetInstance()->Register(
+      "class files cache",
+      [this] () { return static_cast<int64>(total_size()); },
+      [this] () { ReleaseUnreferenced(); });
+}
+
+
+ClassFilesCache::~ClassFilesCache() {
+  MemoryBudget::GetInstance()->Unregister(memory_budget_cookie_);
 }
 
 
 std::unique_ptr<ClassFilesCache::AutoClassFile> ClassFilesCache::Get(
     jobject cls) {
-  MutexLock lock(&mu_);
-
-  Item* item = classes_.Find(cls);
-  if (item == nullptr) {
+  jint hash_code = 0;
+  if (!JobjectMap<JObject_GlobalRef, Item>::GetHashCode(cls, &hash_code)) {
     return nullptr;
   }
 
-  return Reference(item);
+  Shard* shard = GetShard(hash_code);
+
+  {
+    MutexLock lock(&shard->mu);
+
+    Item* item = shard->classes.Find(cls, hash_code);
+    if (item != nullptr) {
+      shard->sketch.Increment(hash_code);
+      ++shard->hits;
+
+      return Reference(shard, item);
+    }
+  }
+
+  // Decompressing a class file is cheap enough even for the callers that
+  // can't afford to load it.
+  return GetFromColdTier(shard, cls, hash_code);
 }
 
 
@@ -43,14 +155,40 @@ std::unique_ptr<ClassFilesCache::AutoClassFile> ClassFilesCache::GetOrLoad(
     bool* loaded) {
   *loaded = false;
 
+  jint hash_code = 0;
+  if (!JobjectMap<JObject_GlobalRef, Item>::GetHashCode(cls, &hash_code)) {
+    return nullptr;
+  }
+
+  Shard* shard = GetShard(hash_code);
+
   {
-    MutexLock lock(&mu_);
-    Item* item = classes_.Find(cls);
+    MutexLock lock(&shard->mu);
+
+    shard->sketch.Increment(hash_code);
+
+    Item* item = shard->classes.Find(cls, hash_code);
     if (item != nullptr) {
-      return Reference(item);
+      ++shard->hits;
+      statClassFilesCacheHitRate->add(100);
+      return Reference(shard, item);
     }
   }
 
+  std::unique_ptr<AutoClassFile> cold_class_file =
+      GetFromColdTier(shard, cls, hash_code);
+  if (cold_class_file != nullptr) {
+    statClassFilesCacheHitRate->add(100);
+    return cold_class_file;
+  }
+
+  {
+    MutexLock lock(&shard->mu);
+    ++shard->misses;
+  }
+
+  statClassFilesCacheHitRate->add(0);
+
   std::unique_ptr<ClassFile> class_file =
       ClassFile::Load(class_indexer_, static_cast<jclass>(cls));
   if (class_file == nullptr) {
@@ -61,81 +199,330 @@ std::unique_ptr<ClassFilesCache::AutoClassFile> ClassFilesCache::GetOrLoad(
   LOG(INFO) << "Java class file loaded: " << GetClassSignature(cls);
   *loaded = true;
 
+  return Insert(shard, cls, hash_code, std::move(class_file));
+}
+
+
+std::unique_ptr<ClassFilesCache::AutoClassFile>
+ClassFilesCache::GetFromColdTier(
+    Shard* shard,
+    jobject cls,
+    jint hash_code) {
+  int size = 0;
+  string compressed;
+
+  {
+    MutexLock lock(&shard->mu);
+
+    ColdItem* item = shard->cold_classes.Find(cls, hash_code);
+    if (item == nullptr) {
+      return nullptr;
+    }
+
+    // The bytes are taken out of the item, so they are accounted here.
+    size = item->size;
+    compressed.swap(item->compressed);
+    shard->cold_size -= compressed.size();
+
+    RemoveColdItem(shard, item);
+
+    ++shard->cold_hits;
+  }
+
+  string data;
+  if (!DecompressLz4Block(compressed, size, &data)) {
+    LOG(ERROR) << "Corrupted class file in the cold tier: "
+               << GetClassSignature(cls);
+    return nullptr;
+  }
+
+  std::unique_ptr<ClassFile> class_file =
+      ClassFile::LoadFromBlob(class_indexer_, std::move(data));
+  if (class_file == nullptr) {
+    return nullptr;
+  }
+
+  return Insert(shard, cls, hash_code, std::move(class_file));
+}
+
+
+std::unique_ptr<ClassFilesCache::AutoClassFile> ClassFilesCache::Insert(
+    Shard* shard,
+    jobject cls,
+    jint hash_code,
+    std::unique_ptr<ClassFile> class_file) {
+  const Tier tier = GetClassTier(cls);
+  const int size = class_file->GetData().size();
+
   {
-    MutexLock lock(&mu_);
+    MutexLock lock(&shard->mu);
 
     // The class could be inserted into the cache by another thread while
-    // this thread was calling "ClassFile::Load".
-    Item* already_inserted_item = classes_.Find(cls);
+    // this thread was loading the class file.
+    Item* already_inserted_item = shard->classes.Find(cls, hash_code);
     if (already_inserted_item != nullptr) {
-      return Reference(already_inserted_item);
+      return Reference(shard, already_inserted_item);
     }
 
     Item item;
+    item.hash_code = hash_code;
+    item.tier = tier;
     item.class_file = std::move(class_file);
-    item.it_lru = lru_.end();
+    item.it_lru = shard->lru[static_cast<int>(tier)].end();
     item.ref_count = 1;
 
+    // TinyLFU admission: if the new class doesn't fit, it has to be more
+    // popular than the class it would push out.
+    const std::list<Item*>& lru = shard->lru[static_cast<int>(tier)];
+    if ((tier == Tier::Application) &&
+        (shard->tier_size[static_cast<int>(tier)] + size >
+         GetTierBudget(tier)) &&
+        !lru.empty()) {
+      const Item* victim = lru.front();
+      if (shard->sketch.Estimate(hash_code) <=
+          shard->sketch.Estimate(victim->hash_code)) {
+        item.admitted = false;
+      }
+    }
+
     std::pair<jobject, Item>* inserted = nullptr;
-    if (!classes_.Insert(cls, std::move(item), &inserted)) {
+    if (!shard->classes.Insert(cls, hash_code, std::move(item), &inserted)) {
       LOG(ERROR) << "Class could not be inserted into cache.";
       return nullptr;
     }
 
     inserted->second.cls = inserted->first;
 
-    total_size_ += inserted->second.class_file->GetData().size();
-    GarbageCollect();
+    shard->tier_size[static_cast<int>(tier)] += size;
+    if (inserted->second.admitted) {
+      GarbageCollect(shard, tier);
+    }
+
     return std::unique_ptr<ClassFilesCache::AutoClassFile>(
-        new AutoClassFile(this, &inserted->second));
+        new AutoClassFile(this, shard, &inserted->second));
+  }
+}
+
+
+bool ClassFilesCache::Pin(jobject cls) {
+  bool loaded = false;
+  std::unique_ptr<AutoClassFile> class_file = GetOrLoad(cls, &loaded);
+  if (class_file == nullptr) {
+    return false;
+  }
+
+  jint hash_code = 0;
+  if (!JobjectMap<JObject_GlobalRef, Item>::GetHashCode(cls, &hash_code)) {
+    return false;
+  }
+
+  Shard* shard = GetShard(hash_code);
+  MutexLock lock(&shard->mu);
+
+  // The class file is referenced by "class_file", so it can't be removed
+  // from the cache in the meantime.
+  Item* item = shard->classes.Find(cls, hash_code);
+  DCHECK(item != nullptr);
+
+  if (!item->pinned) {
+    item->pinned = true;
+    item->admitted = true;
+    ++item->ref_count;
+  }
+
+  return true;
+}
+
+
+int ClassFilesCache::total_size() const {
+  int total_size = 0;
+  for (Shard& shard : shards_) {
+    MutexLock lock(&shard.mu);
+    for (int tier = 0; tier < kTiersCount; ++tier) {
+      total_size += shard.tier_size[tier];
+    }
+
+    total_size += shard.cold_size;
+  }
+
+  return total_size;
+}
+
+
+ClassFilesCache::Stats ClassFilesCache::GetStats() const {
+  Stats stats;
+  for (Shard& shard : shards_) {
+    MutexLock lock(&shard.mu);
+
+    stats.hits += shard.hits;
+    stats.misses += shard.misses;
+    stats.cold_hits += shard.cold_hits;
+    stats.cold_size += shard.cold_size;
+    for (int tier = 0; tier < kTiersCount; ++tier) {
+      stats.tier_size[tier] += shard.tier_size[tier];
+    }
   }
+
+  return stats;
+}
+
+
+int ClassFilesCache::GetTierBudget(Tier tier) const {
+  const int system_budget =
+      static_cast<int64>(max_size_) * kSystemTierSharePercent / 100;
+
+  switch (tier) {
+    case Tier::System:
+      return system_budget / kShardsCount;
+
+    case Tier::Application:
+      return (max_size_ - system_budget) / kShardsCount;
+  }
+
+  return 0;
 }
 
 
 std::unique_ptr<ClassFilesCache::AutoClassFile> ClassFilesCache::Reference(
-    ClassFilesCache::Item* item) {
+    Shard* shard,
+    Item* item) {
+  std::list<Item*>& lru = shard->lru[static_cast<int>(item->tier)];
+
   if (item->ref_count == 0) {
-    DCHECK(item->it_lru != lru_.end());
+    DCHECK(item->it_lru != lru.end());
 
-    lru_.erase(item->it_lru);
-    item->it_lru = lru_.end();
+    lru.erase(item->it_lru);
+    item->it_lru = lru.end();
   } else {
-    DCHECK(item->it_lru == lru_.end());
+    DCHECK(item->it_lru == lru.end());
   }
 
   ++item->ref_count;
 
   return std::unique_ptr<ClassFilesCache::AutoClassFile>(
-      new AutoClassFile(this, item));
+      new AutoClassFile(this, shard, item));
 }
 
 
-void ClassFilesCache::Unref(ClassFilesCache::Item* item) {
-  MutexLock lock(&mu_);
+void ClassFilesCache::Unref(Shard* shard, Item* item) {
+  MutexLock lock(&shard->mu);
 
   DCHECK_GT(item->ref_count, 0);
 
   --item->ref_count;
 
   if (item->ref_count == 0) {
-    item->it_lru = lru_.insert(lru_.end(), item->cls);
+    if (!item->admitted) {
+      RemoveItem(shard, item, true);
+      return;
+    }
+
+    std::list<Item*>& lru = shard->lru[static_cast<int>(item->tier)];
+    item->it_lru = lru.insert(lru.end(), item);
+  }
+}
+
+
+void ClassFilesCache::GarbageCollect(Shard* shard, Tier tier) {
+  std::list<Item*>& lru = shard->lru[static_cast<int>(tier)];
+
+  while ((shard->tier_size[static_cast<int>(tier)] > GetTierBudget(tier)) &&
+         !lru.empty()) {
+    Item* item = lru.front();
+
+    lru.pop_front();
+    item->it_lru = lru.end();
+
+    RemoveItem(shard, item, true);
   }
 }
 
 
-void ClassFilesCache::GarbageCollect() {
-  while ((total_size_ > max_size_) && !lru_.empty()) {
-    Item* item = classes_.Find(lru_.front());
-    DCHECK(item != nullptr);
+void ClassFilesCache::ReleaseUnreferenced() {
+  for (Shard& shard : shards_) {
+    MutexLock lock(&shard.mu);
+
+    for (std::list<Item*>& lru : shard.lru) {
+      while (!lru.empty()) {
+        Item* item = lru.front();
+
+        lru.pop_front();
+        item->it_lru = lru.end();
+
+        RemoveItem(&shard, item, false);
+      }
+    }
+
+    while (!shard.cold_lru.empty()) {
+      RemoveColdItem(&shard, shard.cold_lru.front());
+    }
+  }
+}
+
 
-    LOG(INFO) << "Java class file "
-              << GetClassSignature(lru_.front())
-              << " removed from cache";
+void ClassFilesCache::RemoveItem(Shard* shard, Item* item, bool demote) {
+  DCHECK_EQ(item->ref_count, 0);
 
-    total_size_ -= item->class_file->GetData().size();
-    classes_.Remove(item->cls);
-    lru_.pop_front();
+  if (demote) {
+    Demote(shard, item);
   }
+
+  LOG(INFO) << "Java class file "
+            << GetClassSignature(item->cls)
+            << " removed from cache";
+
+  shard->tier_size[static_cast<int>(item->tier)] -=
+      item->class_file->GetData().size();
+
+  const jint hash_code = item->hash_code;
+  shard->classes.Remove(item->cls, hash_code);
+}
+
+
+void ClassFilesCache::Demote(Shard* shard, Item* item) {
+  const int budget =
+      std::max(0, FLAGS_cdbg_class_files_cold_tier_size) / kShardsCount;
+  const ByteSource data = item->class_file->GetData();
+  if (data.size() > budget * 4) {
+    return;  // Not worth compressing, it wouldn't fit anyway.
+  }
+
+  ColdItem cold_item;
+  cold_item.hash_code = item->hash_code;
+  cold_item.size = data.size();
+  cold_item.compressed = CompressLz4Block(data.data<char>(), data.size());
+
+  const int compressed_size = cold_item.compressed.size();
+  if (compressed_size > budget) {
+    return;
+  }
+
+  std::pair<jobject, ColdItem>* inserted = nullptr;
+  if (!shard->cold_classes.Insert(
+          item->cls,
+          item->hash_code,
+          std::move(cold_item),
+          &inserted)) {
+    return;
+  }
+
+  inserted->second.cls = inserted->first;
+  inserted->second.it_lru =
+      shard->cold_lru.insert(shard->cold_lru.end(), &inserted->second);
+  shard->cold_size += compressed_size;
+
+  while (shard->cold_size > budget) {
+    RemoveColdItem(shard, shard->cold_lru.front());
+  }
+}
+
+
+void ClassFilesCache::RemoveColdItem(Shard* shard, ColdItem* item) {
+  shard->cold_size -= item->compressed.size();
+  shard->cold_lru.erase(item->it_lru);
+
+  const jint hash_code = item->hash_code;
+  shard->cold_classes.Remove(item->cls, hash_code);
 }
 
 }  // namespace cdbg
@@ -24,12 +24,13 @@
 #include "class_file.h"
 #include "common.h"
 #include "jobject_map.h"
+#include "memory_budget.h"
 
 namespace devtools {
 namespace cdbg {
 
 // Loading Java class files from disk is an expensive operation. This class
-// implements a simple LRU cache to avoid unnecessary class loads.
+// implements a cache to avoid unnecessary class loads.
 //
 // Each class in the cache can be in one of two states:
 // 1. Referenced by one or more consumers. The same copy of the class file is
@@ -38,13 +39,117 @@ namespace cdbg {
 // 2. When the class is not referenced, it moves to LRU list. Classes will be
 //    garbage collected from the LRU list when a new class needs to be loaded
 //    and the cache has not enough space.
+// Class files that the first captures are likely to need can be pinned (see
+// "Pin"). They stay referenced for the lifetime of the cache.
+//
+// The cache is split into shards (by the hash code of the class) to reduce
+// lock contention. Each shard has two tiers with separate space budgets:
+// classes loaded by the bootstrap class loader (JDK classes that pretty
+// printers and common expressions call into) and all other classes. A burst
+// of application classes therefore never evicts JDK classes.
+//
+// Application classes go through TinyLFU style admission: when the tier is
+// full, a newly loaded class only stays in cache after it's released if it
+// was requested more frequently than the LRU class it would evict. Cold
+// classes touched once by a single capture don't flush out the working set.
+//
+// Class files evicted from the cache (or not admitted to it) move to a cold
+// tier that only keeps their bytes, LZ4 compressed, within a separate space
+// budget (see "--cdbg_class_files_cold_tier_size"). A request of a class
+// found in the cold tier parses the decompressed bytes rather than loading
+// the class file again through "ClassIndexer", which is orders of magnitude
+// slower. The cold tier drops the least recently evicted class files first.
 class ClassFilesCache {
+ public:
+  // Cache tiers with separate space budgets.
+  enum class Tier {
+    // Classes loaded by the bootstrap class loader.
+    System,
+
+    // All other classes.
+    Application
+  };
+
+  // Total number of tiers.
+  static constexpr int kTiersCount = 2;
+
+  // Number of independently locked shards.
+  static constexpr int kShardsCount = 4;
+
+  // Cache statistics.
+  struct Stats {
+    // Number of class file requests served from cache.
+    int64 hits = 0;
+
+    // Number of class file requests that required loading the class file.
+    int64 misses = 0;
+
+    // Number of class file requests served from the cold tier.
+    int64 cold_hits = 0;
+
+    // Total size in bytes of the compressed class files in the cold tier.
+    int64 cold_size = 0;
+
+    // Total size in bytes of the class files in each tier (indexed by
+    // "Tier").
+    int64 tier_size[kTiersCount] = { 0, 0 };
+  };
+
  private:
+  // Approximate count of recent requests per class used for admission
+  // decisions. This is a count-min sketch with small saturating counters
+  // that are halved periodically, so that the frequency decays over time.
+  class FrequencySketch {
+   public:
+    FrequencySketch();
+
+    // Counts a single request of a class with the specified hash code.
+    void Increment(jint hash_code);
+
+    // Estimates the number of recent requests of a class.
+    int Estimate(jint hash_code) const;
+
+   private:
+    // Number of hash functions (rows).
+    static constexpr int kDepth = 4;
+
+    // Number of counters in each row. Must be a power of 2.
+    static constexpr int kWidth = 256;
+
+    // Maximum value of a single counter.
+    static constexpr int kMaxCount = 15;
+
+    // Number of increments after which all the counters are halved.
+    static constexpr int kResetInterval = 10 * kWidth;
+
+    // Index of the counter of the specified row.
+    static int GetIndex(jint hash_code, int row);
+
+    uint8 counters_[kDepth][kWidth];
+
+    // Number of increments since the last halving.
+    int increments_ = 0;
+  };
+
   struct Item {
     // Global reference to the class file represented by this instance. The
     // reference is owned by "JobjectMap".
     jobject cls = nullptr;
 
+    // Hash code of "cls".
+    jint hash_code = 0;
+
+    // Tier that accounts for the space of this class file.
+    Tier tier = Tier::Application;
+
+    // False if the class file should be released as soon as it's not
+    // referenced (i.e. failed admission).
+    bool admitted = true;
+
+    // True if the class file is kept in cache for the lifetime of the cache
+    // (see "Pin"). Pinned class file holds one extra reference.
+    bool pinned = false;
+
     // Loaded Java class file. "ClassFile" is thread safe, so "class_file" is
     // shared between all the threads that referenced it.
     std::unique_ptr<ClassFile> class_file;
@@ -55,25 +160,82 @@ class ClassFilesCache {
     int ref_count = 0;
 
     // Ignored if "ref_count" is non-zero. Otherwise points to the location
-    // of this class in LRU list. We use linked list, since its iterators
-    // stay valid when the list is changed.
-    std::list<jobject>::iterator it_lru;
+    // of this class in LRU list of "tier". We use linked list, since its
+    // iterators stay valid when the list is changed.
+    std::list<Item*>::iterator it_lru;
+  };
+
+  // Class file evicted to the cold tier.
+  struct ColdItem {
+    // Global reference to the class. The reference is owned by "JobjectMap".
+    jobject cls = nullptr;
+
+    // Hash code of "cls".
+    jint hash_code = 0;
+
+    // Size of the uncompressed class file.
+    int size = 0;
+
+    // LZ4 compressed class file (see "CompressLz4Block").
+    string compressed;
+
+    // Location of this class in "Shard::cold_lru".
+    std::list<ColdItem*>::iterator it_lru;
+  };
+
+  struct Shard {
+    // Locks all the data members below.
+    Mutex mu;
+
+    // All cached class files of this shard. We keep "Item" by value because
+    // "JobjectMap" guarantees that it will not move when the entries are
+    // added or removed from it.
+    JobjectMap<JObject_GlobalRef, Item> classes;
+
+    // Class files that are not referenced and can be released if the tier
+    // needs more space (indexed by "Tier"). The most recently used classes
+    // are at the end. Class files are garbage collected starting from the
+    // front.
+    std::list<Item*> lru[kTiersCount];
+
+    // Total number of bytes used by "ClassFile" instances of each tier.
+    int tier_size[kTiersCount] = { 0, 0 };
+
+    // Class files of the cold tier. Like "classes", "ColdItem" is kept by
+    // value.
+    JobjectMap<JObject_GlobalRef, ColdItem> cold_classes;
+
+    // Class files of the cold tier in the order they were evicted. Class
+    // files are dropped starting from the front.
+    std::list<ColdItem*> cold_lru;
+
+    // Total number of bytes used by the compressed class files.
+    int cold_size = 0;
+
+    // Recent requests frequency for admission decisions.
+    FrequencySketch sketch;
+
+    // Cache statistics of this shard.
+    int64 hits = 0;
+    int64 misses = 0;
+    int64 cold_hits = 0;
   };
 
  public:
   // Automatically returns the referenced class file when goes out of scope.
   class AutoClassFile {
    public:
-    AutoClassFile(ClassFilesCache* owner, Item* item)
-       : owner_(owner), item_(item) {
+    AutoClassFile(ClassFilesCache* owner, Shard* shard, Item* item)
+       : owner_(owner), shard_(shard), item_(item) {
     }
 
-    ~AutoClassFile() { owner_->Unref(item_); }
+    ~AutoClassFile() { owner_->Unref(shard_, item_); }
 
     ClassFile* get() { return item_->class_file.get(); }
 
    private:
     ClassFilesCache* const owner_;
+    Shard* const shard_;
     Item* const item_;
 
     DISALLOW_COPY_AND_ASSIGN(AutoClassFile);
@@ -85,6 +247,8 @@ class ClassFilesCache {
   // if too many class files are referenced at the same time.
   ClassFilesCache(ClassIndexer* class_indexer, int max_size);
 
+  ~ClassFilesCache();
+
   // Gets the class file for the specified class from cache. Returns nullptr
   // if the class file is not in cache.
   std::unique_ptr<AutoClassFile> Get(jobject cls);
@@ -94,25 +258,80 @@ class ClassFilesCache {
   // retrieved from cache), "loaded" is set to true on return.
   std::unique_ptr<AutoClassFile> GetOrLoad(jobject cls, bool* loaded);
 
+  // Loads the class file if not in cache and keeps it in cache for the
+  // lifetime of this object. Pinned class files are never garbage
+  // collected, not even when the agent is over its memory budget. Returns
+  // false if the class file could not be loaded.
+  bool Pin(jobject cls);
+
   // Returns the total size in bytes of all the class files in cache. This
   // number can exceed the maximum size if too many class files are referenced
   // at the same time.
-  int total_size() const { return total_size_; }
+  int total_size() const;
+
+  // Collects statistics from all the shards.
+  Stats GetStats() const;
+
+  // Releases all the class files that are not currently referenced. Called
+  // when the agent is over its memory budget.
+  void ReleaseUnreferenced();
 
  private:
+  // Gets the shard responsible for the class with the specified hash code.
+  Shard* GetShard(jint hash_code) {
+    return &shards_[static_cast<uint32>(hash_code) % kShardsCount];
+  }
+
+  // Maximum total size of class files of the specified tier in a single
+  // shard.
+  int GetTierBudget(Tier tier) const;
+
+  // Takes the class file out of the cold tier and inserts it back into the
+  // cache. Returns nullptr if the class file is not in the cold tier. Must
+  // be called with "shard->mu" unlocked.
+  std::unique_ptr<AutoClassFile> GetFromColdTier(
+      Shard* shard,
+      jobject cls,
+      jint hash_code);
+
+  // Inserts a class file that was not found in cache and references it.
+  // Returns the class file inserted by another thread in the meantime if
+  // there is one. Must be called with "shard->mu" unlocked.
+  std::unique_ptr<AutoClassFile> Insert(
+      Shard* shard,
+      jobject cls,
+      jint hash_code,
+      std::unique_ptr<ClassFile> class_file);
+
   // Increases the "ref_count" if the class file is already referenced.
   // Otherwise removes it from LRU list and sets "ref_count" to 1.
-  // Must be called with "mu_" locked.
-  std::unique_ptr<ClassFilesCache::AutoClassFile> Reference(Item* item);
+  // Must be called with "shard->mu" locked.
+  std::unique_ptr<ClassFilesCache::AutoClassFile> Reference(
+      Shard* shard,
+      Item* item);
 
   // Returns the class file to the cache. If the class file is not referenced
-  // any more, adds the class file to LRU cache. Must be called with "mu_"
-  // unlocked.
-  void Unref(Item* item);
+  // any more, adds the class file to LRU cache. Must be called with
+  // "shard->mu" unlocked.
+  void Unref(Shard* shard, Item* item);
+
+  // Releases class files from LRU list of the tier as long as the space used
+  // by the tier exceeds its budget. Must be called with "shard->mu" locked.
+  void GarbageCollect(Shard* shard, Tier tier);
+
+  // Removes the class file from the shard. The class file must not be
+  // referenced. The bytes of the class file move to the cold tier if
+  // "demote" is true. Must be called with "shard->mu" locked.
+  void RemoveItem(Shard* shard, Item* item, bool demote);
 
-  // Releases class files from LRU list as long as the total space used by
-  // the cache exceeds the threshold. Must be called with "mu_" locked.
-  void GarbageCollect();
+  // Adds the bytes of an evicted class file to the cold tier and drops the
+  // oldest class files of the cold tier if it exceeds its budget. Must be
+  // called with "shard->mu" locked.
+  void Demote(Shard* shard, Item* item);
+
+  // Removes the class file from the cold tier. Must be called with
+  // "shard->mu" locked.
+  void RemoveColdItem(Shard* shard, ColdItem* item);
 
  private:
   // Used to load Java classes. See "ClassFile" for more details.
@@ -122,21 +341,11 @@ class ClassFilesCache {
   // in and starts releasing unreferenced class files.
   const int max_size_;
 
-  // Locks changes to "classes_, "lru_" and "total_size_".
-  Mutex mu_;
-
-  // All cached class files. We keep "Item" by value because "JobjectMap"
-  // guarantees that it will not move when the entries are added or removed
-  // from it.
-  JobjectMap<JObject_GlobalRef, Item> classes_;
-
-  // Class files that are not referenced and can be released if the cache
-  // needs more space. The most recently used classes are at the end. Class
-  // files are garbage collected starting from the front.
-  std::list<jobject> lru_;
+  // Independently locked parts of the cache.
+  mutable Shard shards_[kShardsCount];
 
-  // Total number of bytes used by "ClassFile" instances of "classes_".
-  int total_size_ = 0;
+  // Registration of this cache in "MemoryBudget".
+  MemoryBudget::Cookie memory_budget_cookie_;
 
   DISALLOW_COPY_AND_ASSIGN(ClassFilesCache);
 };
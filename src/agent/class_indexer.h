@@ -17,6 +17,8 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_CLASS_INDEXER_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_CLASS_INDEXER_H_
 
+#include <utility>
+#include <vector>
 #include "common.h"
 #include "jni_utils.h"
 #include "jvariant.h"
@@ -61,6 +63,13 @@ class ClassIndexer {
       const string& /* type_name */,
       const string& /* class_signature */> OnClassPreparedEvent;
 
+  // Event fired once after the classes that had been loaded before the
+  // class indexer started are indexed and then for batches of classes
+  // prepared later. Each element is a pair of type name and class signature.
+  // These classes do not fire "OnClassPreparedEvent".
+  typedef Observable<
+      const std::vector<std::pair<string, string>>&> OnClassesPreparedEvent;
+
   virtual ~ClassIndexer() { }
 
   // Subscribes to receive OnClassPrepared notifications.
@@ -71,6 +80,20 @@ class ClassIndexer {
   virtual void UnsubscribeOnClassPreparedEvents(
       OnClassPreparedEvent::Cookie cookie) = 0;
 
+  // Subscribes to receive the batched OnClassesPrepared notification.
+  virtual OnClassesPreparedEvent::Cookie SubscribeOnClassesPreparedEvents(
+      OnClassesPreparedEvent::Callback fn) = 0;
+
+  // Unsubscribes from the batched OnClassesPrepared notification.
+  virtual void UnsubscribeOnClassesPreparedEvents(
+      OnClassesPreparedEvent::Cookie cookie) = 0;
+
+  // Hints whether notifications about new classes should be delivered
+  // promptly, i.e. there are breakpoints waiting for their classes to be
+  // loaded. Otherwise the class indexer may index new classes and fire the
+  // notifications less frequently.
+  virtual void SetClassPreparedEventsUrgent(bool is_urgent) = 0;
+
   // Looks for a prepared Java class by class signature. A class is prepared
   // after it is first referenced and has its static fields initialized. If
   // the class is found, the function returns local reference to "jclass".
@@ -82,6 +105,19 @@ class ClassIndexer {
   // found, the function returns local reference to "jclass".
   virtual JniLocalRef FindClassByName(const string& class_name) = 0;
 
+  // Same as "FindClassBySignature" and "FindClassByName", but if classes
+  // with this name were loaded by several class loaders (e.g. one per web
+  // application), prefers the one defined by "class_loader". This is
+  // typically the class loader of the breakpoint location. "class_loader"
+  // is nullptr for the bootstrap class loader.
+  virtual JniLocalRef FindClassBySignature(
+      const string& class_signature,
+      jobject class_loader) = 0;
+
+  virtual JniLocalRef FindClassByName(
+      const string& class_name,
+      jobject class_loader) = 0;
+
   // Gets reference to primitive type. The function returns "shared_ptr" for
   // consistency with "CreateReference".
   virtual std::shared_ptr<Type> GetPrimitiveType(JType type) = 0;
@@ -17,6 +17,7 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_CLASS_METADATA_READER_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_CLASS_METADATA_READER_H_
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include "common.h"
@@ -27,6 +28,7 @@ namespace cdbg {
 
 class InstanceFieldReader;
 class StaticFieldReader;
+class TypeEvaluator;
 
 // Loads and cache class metadata. This includes class signature and its fields.
 // This interface is thread safe.
@@ -44,6 +46,11 @@ class ClassMetadataReader {
     // from the signature.
     string signature;
 
+    // Parsed "signature" shared by all methods with the same signature. Only
+    // set for methods loaded into class metadata. Otherwise nullptr and the
+    // users need to parse "signature" themselves.
+    std::shared_ptr<const JMethodSignature> parsed_signature;
+
     // Method modifiers. The most important is JVM_ACC_STATIC to distinguish
     // instance methods from static methods.
     jint modifiers { 0 };
@@ -56,10 +63,35 @@ class ClassMetadataReader {
     // Class signature.
     JSignature signature;
 
+    // Classification of the class based on "signature".
+    WellKnownJClass well_known_jclass { WellKnownJClass::Unknown };
+
     // List of instance (non-static) class fields (aka member variables). Some
     // fields might be omitted due to external policy.
     std::vector<std::unique_ptr<InstanceFieldReader>> instance_fields;
 
+    // Instance fields laid out as arrays parallel to "instance_fields" for
+    // "GenericTypeEvaluator", which reads all the fields of every captured
+    // object. Going through this layout takes no virtual call per field and
+    // fields of the same type are read together.
+    struct InstanceFieldsLayout {
+      // JNI field IDs. They stay valid as long as the class is loaded and
+      // the entry is dropped together with the class.
+      std::vector<jfieldID> field_ids;
+
+      // Names of the fields. Point to the names owned by "instance_fields".
+      std::vector<const string*> names;
+
+      // Classification of the static types of the fields.
+      std::vector<WellKnownJClass> well_known_jclasses;
+
+      // Indexes of the fields ordered by the field type. Fields of type "t"
+      // are listed in "by_type" from "type_begin[t]" to
+      // "type_begin[t + 1]" (exclusive).
+      std::vector<int> by_type;
+      int type_begin[TotalJTypes + 1] = { };
+    } instance_fields_layout;
+
     // List of static fields. Some fields might be omitted due to external
     // policy.
     std::vector<std::unique_ptr<StaticFieldReader>> static_fields;
@@ -74,12 +106,31 @@ class ClassMetadataReader {
     // Indicates whether one or more instance fields were filtered out due
     // to field visibility policy.
     bool instance_fields_omitted { false };
+
+    // Indicates whether the class has a non-default version of "toString()"
+    // (i.e. the class or one of its superclasses overrides
+    // "Object.toString()"). Computed once when the class metadata is loaded,
+    // so that dynamic logs don't resolve "toString()" on every hit. The entry
+    // is dropped together with the class, so this never refers to a
+    // previously unloaded class.
+    bool has_custom_to_string { false };
+
+    // Pretty printer that "JvmObjectEvaluator" selected for objects of this
+    // class or nullptr if it wasn't selected yet. The selection only depends
+    // on the class, so it's computed once per class rather than once per
+    // captured object. Kept behind a pointer, so that "Entry" stays movable.
+    // nullptr if the class metadata could not be loaded.
+    std::unique_ptr<std::atomic<TypeEvaluator*>> type_evaluator;
   };
 
   virtual ~ClassMetadataReader() { }
 
   // Loads metadata of Java class "cls" or retrieves it from cache.
   virtual const Entry& GetClassMetadata(jclass cls) = 0;
+
+  // Drops the cached metadata of unloaded classes. Spends at most
+  // "time_budget_micros" and returns the number of dropped entries.
+  virtual int RemoveUnloadedClasses(int64 time_budget_micros) = 0;
 };
 
 
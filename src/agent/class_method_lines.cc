@@ -0,0 +1,156 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "class_method_lines.h"
+
+#include "jvmti_buffer.h"
+
+namespace devtools {
+namespace cdbg {
+
+ClassMethodLines::ClassMethodLines(jclass cls)
+    : cls_(jni()->NewWeakGlobalRef(cls)) {
+  jint methods_count = 0;
+  JvmtiBuffer<jmethodID> methods_buf;
+  jvmtiError err =
+      jvmti()->GetClassMethods(cls, &methods_count, methods_buf.ref());
+  if (err != JVMTI_ERROR_NONE) {
+    LOG(ERROR) << "GetClassMethods failed, error: " << err;
+    return;
+  }
+
+  for (int method_index = 0; method_index < methods_count; ++method_index) {
+    jmethodID method = methods_buf.get()[method_index];
+
+    JvmtiBuffer<char> name_buf;
+    err = jvmti()->GetMethodName(method, name_buf.ref(), nullptr, nullptr);
+    if (err != JVMTI_ERROR_NONE) {
+      LOG(ERROR) << "GetMethodName failed, error: " << err << ", ignoring...";
+      continue;
+    }
+
+    if (name_buf.get() == nullptr) {
+      continue;
+    }
+
+    methods_by_name_[name_buf.get()].methods.push_back(method);
+  }
+}
+
+
+ClassMethodLines::~ClassMethodLines() {
+  if (cls_ != nullptr) {
+    jni()->DeleteWeakGlobalRef(cls_);
+  }
+}
+
+
+bool ClassMethodLines::IsSameClass(jclass cls) const {
+  return !IsClassUnloaded() && jni()->IsSameObject(cls_, cls);
+}
+
+
+bool ClassMethodLines::IsClassUnloaded() const {
+  return (cls_ == nullptr) || jni()->IsSameObject(cls_, nullptr);
+}
+
+
+bool ClassMethodLines::FindMethodLine(
+    const string& method_name,
+    int line_number,
+    jmethodID* method,
+    jlocation* location) {
+  *method = nullptr;
+  *location = 0;
+
+  MutexLock lock(&mu_);
+
+  auto it_index = methods_by_name_.find(method_name);
+  if (it_index == methods_by_name_.end()) {
+    LOG(ERROR) << "Method " << method_name << " not found in the class";
+    return false;
+  }
+
+  MethodsIndex& index = it_index->second;
+
+  // Get the line numbers corresponding to the code statements of the
+  // methods.
+  LoadIndex(&index);
+
+  // Match the line. The "line_number" parameter is by now adjusted to
+  // the start location of a statement.
+  auto it_line = index.lines.find(line_number);
+  if (it_line != index.lines.end()) {
+    *method = it_line->second.method;
+    *location = it_line->second.location;
+
+    LOG(INFO) << "Line " << line_number << " in method " << method_name
+              << " resolved to method ID: " << *method
+              << ", location: " << *location;
+
+    return true;
+  }
+
+  if (index.error == JVMTI_ERROR_ABSENT_INFORMATION) {
+    LOG(ERROR) << "Class doesn't have line number debugging information";
+    return false;
+  }
+
+  if (index.error != JVMTI_ERROR_NONE) {
+    LOG(ERROR) << "GetLineNumberTable failed, error: " << index.error;
+    return false;
+  }
+
+  LOG(ERROR) << "No statement at line " << line_number
+             << " found in method " << method_name
+             << " (" << index.methods.size() << " methods matched)";
+
+  return false;
+}
+
+
+void ClassMethodLines::LoadIndex(MethodsIndex* index) {
+  if (index->is_loaded) {
+    return;
+  }
+
+  index->is_loaded = true;
+
+  for (jmethodID method : index->methods) {
+    jint line_entries_count = 0;
+    JvmtiBuffer<jvmtiLineNumberEntry> line_entries;
+    index->error = jvmti()->GetLineNumberTable(
+        method,
+        &line_entries_count,
+        line_entries.ref());
+    if (index->error != JVMTI_ERROR_NONE) {
+      // Lines of the methods after the failed one are never matched.
+      return;
+    }
+
+    // An overloaded method earlier in the list takes precedence, so does
+    // an earlier entry of the same line in the table.
+    for (int i = 0; i < line_entries_count; ++i) {
+      const jvmtiLineNumberEntry& line_entry = line_entries.get()[i];
+      index->lines.insert(std::make_pair(
+          line_entry.line_number,
+          Location { method, line_entry.start_location }));
+    }
+  }
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,107 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_CLASS_METHOD_LINES_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_CLASS_METHOD_LINES_H_
+
+#include <unordered_map>
+#include <vector>
+#include "common.h"
+#include "jni_utils.h"
+#include "mutex.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Methods and line number tables of a single loaded and prepared Java class.
+// Setting a breakpoint has to map the resolved method name and line number
+// to "jmethodID" and "jlocation". Classes with thousands of methods (e.g.
+// generated code) make it expensive to enumerate the methods and read their
+// line number tables, so instances of this class are cached and shared by
+// all the breakpoints set in the class (see
+// "JvmBreakpointsManager::GetClassMethodLines"). The class methods are only
+// enumerated once and the line number tables of the methods with the same
+// name are read once into a reverse index from line number to location.
+//
+// The class is only referenced weakly, so that a cached instance doesn't
+// prevent the class from being unloaded. The method IDs are valid as long
+// as the class is loaded, which the caller of "FindMethodLine" guarantees
+// by holding a reference to it.
+//
+// This class is thread safe.
+class ClassMethodLines {
+ public:
+  explicit ClassMethodLines(jclass cls);
+
+  ~ClassMethodLines();
+
+  // Returns true if this object describes "cls".
+  bool IsSameClass(jclass cls) const;
+
+  // Returns true if the class has been unloaded.
+  bool IsClassUnloaded() const;
+
+  // Resolves the statement at "line_number" in one of the methods called
+  // "method_name". Returns false if not found.
+  bool FindMethodLine(
+      const string& method_name,
+      int line_number,
+      jmethodID* method,
+      jlocation* location);
+
+ private:
+  // Code location of a statement.
+  struct Location {
+    jmethodID method;
+    jlocation location;
+  };
+
+  // Reverse line index of all the methods with the same name.
+  struct MethodsIndex {
+    // Methods with the name in the order of "GetClassMethods".
+    std::vector<jmethodID> methods;
+
+    // True once the line number tables were read into "lines".
+    bool is_loaded { false };
+
+    // Error of "GetLineNumberTable" or "JVMTI_ERROR_NONE".
+    jvmtiError error { JVMTI_ERROR_NONE };
+
+    // First statement of each line number in the first method that has it.
+    std::unordered_map<int, Location> lines;
+  };
+
+  // Reads the line number tables of the methods in "index" unless they are
+  // already loaded.
+  static void LoadIndex(MethodsIndex* index);
+
+ private:
+  // Weak global reference to the Java class.
+  jweak cls_;
+
+  // Locks access to the lazily loaded indexes in "methods_by_name_".
+  Mutex mu_;
+
+  // Methods of the class keyed by method name.
+  std::unordered_map<string, MethodsIndex> methods_by_name_;
+
+  DISALLOW_COPY_AND_ASSIGN(ClassMethodLines);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_CLASS_METHOD_LINES_H_
@@ -0,0 +1,192 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "class_name_index.h"
+
+#include <algorithm>
+
+namespace devtools {
+namespace cdbg {
+
+// Initial number of slots in the table.
+constexpr int kInitialCapacity = 1024;
+
+constexpr int32 ClassNameIndex::kEmptySlot;
+constexpr int32 ClassNameIndex::kDeletedSlot;
+
+
+ClassNameIndex::ClassNameIndex() {
+  Rehash(kInitialCapacity);
+}
+
+
+void ClassNameIndex::Insert(
+    const string& type_name,
+    const string& signature,
+    jobject cls,
+    int32 loader_hash) {
+  // Keep the load factor (including deleted entries) below 1/2.
+  if ((used_ + 1) * 2 > slots_.size()) {
+    Rehash((size_ + 1) * 4);
+  }
+
+  const size_t hash = std::hash<string>()(type_name);
+  const size_t mask = slots_.size() - 1;
+
+  size_t index = hash & mask;
+  while (slots_[index].signature_id >= 0) {
+    index = (index + 1) & mask;
+  }
+
+  if (slots_[index].signature_id == kEmptySlot) {
+    ++used_;
+  }
+
+  slots_[index] = {
+    hash,
+    cls,
+    InternSignature(type_name, signature),
+    loader_hash
+  };
+  ++size_;
+}
+
+
+JniLocalRef ClassNameIndex::Find(
+    const string& type_name,
+    const string* signature,
+    Nullable<int32> loader_hash,
+    std::function<void(jobject)> on_unloaded) {
+  const size_t hash = std::hash<string>()(type_name);
+  const size_t mask = slots_.size() - 1;
+
+  // First class with the matching name from another class loader.
+  JniLocalRef fallback;
+
+  for (size_t index = hash & mask;
+       slots_[index].signature_id != kEmptySlot;
+       index = (index + 1) & mask) {
+    Slot& slot = slots_[index];
+    if ((slot.signature_id == kDeletedSlot) || (slot.hash != hash)) {
+      continue;
+    }
+
+    const std::pair<string, string>& names = names_[slot.signature_id];
+    if ((names.second != type_name) ||
+        ((signature != nullptr) && (names.first != *signature))) {
+      continue;
+    }
+
+    JniLocalRef ref(jni()->NewLocalRef(slot.cls));
+    if (ref == nullptr) {
+      // The class has been unloaded. We can remove it from the index now.
+      on_unloaded(slot.cls);
+      slot.cls = nullptr;
+      slot.signature_id = kDeletedSlot;
+      --size_;
+      continue;
+    }
+
+    if (!loader_hash.has_value() ||
+        (slot.loader_hash == loader_hash.value())) {
+      return ref;
+    }
+
+    if (fallback == nullptr) {
+      fallback = std::move(ref);
+    }
+  }
+
+  return fallback;
+}
+
+
+void ClassNameIndex::Remove(const std::vector<jobject>& classes) {
+  if (classes.empty()) {
+    return;
+  }
+
+  std::vector<jobject> sorted_classes(classes);
+  std::sort(sorted_classes.begin(), sorted_classes.end());
+
+  // The entries are keyed on the type name, so the whole table is scanned.
+  // This only happens after some classes were unloaded.
+  for (Slot& slot : slots_) {
+    if ((slot.signature_id >= 0) &&
+        std::binary_search(
+            sorted_classes.begin(),
+            sorted_classes.end(),
+            slot.cls)) {
+      slot.cls = nullptr;
+      slot.signature_id = kDeletedSlot;
+      --size_;
+    }
+  }
+}
+
+
+void ClassNameIndex::Clear() {
+  slots_.clear();
+  size_ = 0;
+  used_ = 0;
+  names_.clear();
+  signature_ids_.clear();
+
+  Rehash(kInitialCapacity);
+}
+
+
+int32 ClassNameIndex::InternSignature(
+    const string& type_name,
+    const string& signature) {
+  auto in = signature_ids_.insert(
+      std::make_pair(signature, static_cast<int32>(names_.size())));
+  if (in.second) {
+    names_.push_back(std::make_pair(signature, type_name));
+  }
+
+  return in.first->second;
+}
+
+
+void ClassNameIndex::Rehash(int min_capacity) {
+  size_t capacity = kInitialCapacity;
+  while (capacity < min_capacity) {
+    capacity *= 2;
+  }
+
+  std::vector<Slot> slots(capacity, Slot { 0, nullptr, kEmptySlot, 0 });
+  slots_.swap(slots);
+  used_ = size_;
+
+  const size_t mask = capacity - 1;
+  for (const Slot& slot : slots) {
+    if (slot.signature_id < 0) {
+      continue;
+    }
+
+    size_t index = slot.hash & mask;
+    while (slots_[index].signature_id != kEmptySlot) {
+      index = (index + 1) & mask;
+    }
+
+    slots_[index] = slot;
+  }
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
@@ -0,0 +1,127 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_CLASS_NAME_INDEX_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_CLASS_NAME_INDEX_H_
+
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "common.h"
+#include "jni_utils.h"
+#include "nullable.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Maps type names and signatures of loaded classes to the class objects.
+// The index is a flat open addressing hash table keyed on the hash code of
+// the type name. Each entry also stores an interned id of the class
+// signature, so that lookups compare names without querying JVMTI.
+//
+// Application servers load the same classes in many class loaders (one per
+// web application). Each entry therefore also stores the identity hash code
+// of its defining class loader, which partitions the entries of the same
+// name. A lookup can then pick the class of a particular class loader
+// without querying JVMTI for each candidate.
+//
+// The index doesn't own the references to class objects. It is expected
+// to store weak global references.
+//
+// This class is not thread safe.
+class ClassNameIndex {
+ public:
+  ClassNameIndex();
+
+  // Adds a class to the index. The same class must not be added twice.
+  // "loader_hash" is the identity hash code of the class loader that defined
+  // the class (0 for the bootstrap class loader).
+  void Insert(
+      const string& type_name,
+      const string& signature,
+      jobject cls,
+      int32 loader_hash);
+
+  // Looks up a loaded class by type name. If "signature" is not nullptr,
+  // the class signature must match too. Classes with the same names might
+  // be loaded by different class loaders, in which case the function returns
+  // the one with "loader_hash" (if set and such class exists) or any of
+  // them otherwise. Unloaded classes (cleared weak references) are removed
+  // from the index and passed to "on_unloaded".
+  JniLocalRef Find(
+      const string& type_name,
+      const string* signature,
+      Nullable<int32> loader_hash,
+      std::function<void(jobject)> on_unloaded);
+
+  // Removes the entries of the specified classes. Used when the references
+  // are about to be released by their owner. Doesn't release any
+  // references.
+  void Remove(const std::vector<jobject>& classes);
+
+  // Removes all entries. Doesn't release any references.
+  void Clear();
+
+ private:
+  // Special values of "Slot::signature_id".
+  static constexpr int32 kEmptySlot = -1;
+  static constexpr int32 kDeletedSlot = -2;
+
+  struct Slot {
+    // Hash code of the type name.
+    size_t hash;
+
+    // Reference to the class object (not owned by this class).
+    jobject cls;
+
+    // Index in "names_" or one of the special values.
+    int32 signature_id;
+
+    // Identity hash code of the defining class loader.
+    int32 loader_hash;
+  };
+
+  // Gets the interned id of the signature.
+  int32 InternSignature(const string& type_name, const string& signature);
+
+  // Reallocates the table so that it has at least "min_capacity" slots.
+  void Rehash(int min_capacity);
+
+ private:
+  // Open addressing hash table with linear probing. The size is a power
+  // of two.
+  std::vector<Slot> slots_;
+
+  // Number of live entries in "slots_".
+  int size_ = 0;
+
+  // Number of live and deleted entries in "slots_".
+  int used_ = 0;
+
+  // Interned pairs of class signature and type name.
+  std::vector<std::pair<string, string>> names_;
+
+  // Maps a class signature to its index in "names_".
+  std::unordered_map<string, int32> signature_ids_;
+
+  DISALLOW_COPY_AND_ASSIGN(ClassNameIndex);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_CLASS_NAME_INDEX_H_
@@ -0,0 +1,141 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compiled_breakpoint_cache.h"
+
+#include "jvm_breakpoint.h"
+#include "method_unload_filter.h"
+
+namespace devtools {
+namespace cdbg {
+
+CompiledBreakpointCache::CompiledBreakpointCache(int max_size)
+    : max_size_(max_size) {
+}
+
+
+CompiledBreakpointCache::~CompiledBreakpointCache() {
+  for (const auto& method_entries : entries_) {
+    MethodUnloadFilter::Remove(method_entries.first);
+  }
+}
+
+
+std::shared_ptr<CompiledBreakpoint> CompiledBreakpointCache::Find(
+    jmethodID method,
+    jlocation location,
+    const string& key) {
+  std::vector<std::shared_ptr<CompiledBreakpoint>> retired_entries;
+  std::shared_ptr<CompiledBreakpoint> compiled_breakpoint;
+
+  {
+    MutexLock lock(&mu_);
+
+    retired_entries = TakeRetiredEntries();
+
+    auto it = entries_.find(method);
+    if (it != entries_.end()) {
+      for (const Entry& entry : it->second) {
+        if ((entry.location == location) && (entry.key == key)) {
+          compiled_breakpoint = entry.compiled_breakpoint;
+          break;
+        }
+      }
+    }
+  }
+
+  // "retired_entries" released here (outside of the lock).
+  return compiled_breakpoint;
+}
+
+
+void CompiledBreakpointCache::Insert(
+    jmethodID method,
+    jlocation location,
+    const string& key,
+    std::shared_ptr<CompiledBreakpoint> compiled_breakpoint) {
+  if (max_size_ <= 0) {
+    return;
+  }
+
+  std::vector<std::shared_ptr<CompiledBreakpoint>> retired_entries;
+
+  {
+    MutexLock lock(&mu_);
+
+    if (size_ >= max_size_) {
+      for (auto& method_entries : entries_) {
+        MethodUnloadFilter::Remove(method_entries.first);
+        for (Entry& existing_entry : method_entries.second) {
+          retired_entries_.push_back(
+              std::move(existing_entry.compiled_breakpoint));
+        }
+      }
+
+      entries_.clear();
+      size_ = 0;
+    }
+
+    retired_entries = TakeRetiredEntries();
+
+    std::vector<Entry>& method_entries = entries_[method];
+    if (method_entries.empty()) {
+      MethodUnloadFilter::Add(method);
+    }
+
+    // Replace the existing entry if two breakpoints compiled the same
+    // expressions concurrently.
+    for (Entry& entry : method_entries) {
+      if ((entry.location == location) && (entry.key == key)) {
+        retired_entries.push_back(std::move(entry.compiled_breakpoint));
+        entry.compiled_breakpoint = std::move(compiled_breakpoint);
+        return;
+      }
+    }
+
+    method_entries.push_back({ location, key, std::move(compiled_breakpoint) });
+    ++size_;
+  }
+}
+
+
+void CompiledBreakpointCache::JvmtiOnCompiledMethodUnload(jmethodID method) {
+  MutexLock lock(&mu_);
+
+  auto it = entries_.find(method);
+  if (it == entries_.end()) {
+    return;
+  }
+
+  for (Entry& entry : it->second) {
+    retired_entries_.push_back(std::move(entry.compiled_breakpoint));
+  }
+
+  size_ -= it->second.size();
+  entries_.erase(it);
+  MethodUnloadFilter::Remove(method);
+}
+
+
+std::vector<std::shared_ptr<CompiledBreakpoint>>
+CompiledBreakpointCache::TakeRetiredEntries() {
+  std::vector<std::shared_ptr<CompiledBreakpoint>> retired_entries;
+  retired_entries.swap(retired_entries_);
+  return retired_entries;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
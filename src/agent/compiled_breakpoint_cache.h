@@ -0,0 +1,104 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_COMPILED_BREAKPOINT_CACHE_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_COMPILED_BREAKPOINT_CACHE_H_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "common.h"
+#include "mutex.h"
+
+namespace devtools {
+namespace cdbg {
+
+class CompiledBreakpoint;
+
+// Process wide cache of compiled breakpoint expressions keyed by the method,
+// the location within the method and the text of all the expressions that
+// go into "CompiledBreakpoint" (see "JvmBreakpoint::GetCompilationKey").
+// Compiling the condition and the watched expressions is the most expensive
+// part of activating a breakpoint. IDEs routinely delete and re-create the
+// same breakpoint, and a breakpoint that completes is often set again right
+// away. Lookups in the cache let these breakpoints skip the compilation.
+//
+// "CompiledBreakpoint" is immutable, so the same instance can be shared by
+// several active breakpoints. Each cached instance keeps a global reference
+// to the class of the method. The number of entries is bounded, so that the
+// cache doesn't prevent unloading of an unbounded number of classes. When
+// the cache is full, it starts over.
+//
+// This class is thread safe.
+class CompiledBreakpointCache {
+ public:
+  // "max_size" is the maximum number of cached compiled breakpoints.
+  explicit CompiledBreakpointCache(int max_size);
+
+  ~CompiledBreakpointCache();
+
+  // Returns compiled breakpoint at the specified location or nullptr if not
+  // found.
+  std::shared_ptr<CompiledBreakpoint> Find(
+      jmethodID method,
+      jlocation location,
+      const string& key);
+
+  // Adds a newly compiled breakpoint.
+  void Insert(
+      jmethodID method,
+      jlocation location,
+      const string& key,
+      std::shared_ptr<CompiledBreakpoint> compiled_breakpoint);
+
+  // Drops all the cached compiled breakpoints in "method". JNIEnv* is not
+  // available in this callback, so the global references are released later.
+  void JvmtiOnCompiledMethodUnload(jmethodID method);
+
+ private:
+  struct Entry {
+    jlocation location;
+    string key;
+    std::shared_ptr<CompiledBreakpoint> compiled_breakpoint;
+  };
+
+  // Takes out removed entries to be released by the caller after the lock is
+  // released. Must be called with "mu_" held.
+  std::vector<std::shared_ptr<CompiledBreakpoint>> TakeRetiredEntries();
+
+  // Maximum number of entries in the cache.
+  const int max_size_;
+
+  // Locks access to all the data members below.
+  Mutex mu_;
+
+  // Cached compiled breakpoints. Methods rarely have more than a couple of
+  // breakpoints, so each method has a short list that is scanned linearly.
+  std::unordered_map<jmethodID, std::vector<Entry>> entries_;
+
+  // Total number of entries in "entries_".
+  int size_ = 0;
+
+  // Removed entries that have not been released yet.
+  std::vector<std::shared_ptr<CompiledBreakpoint>> retired_entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompiledBreakpointCache);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_COMPILED_BREAKPOINT_CACHE_H_
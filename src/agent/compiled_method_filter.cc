@@ -0,0 +1,77 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compiled_method_filter.h"
+
+namespace devtools {
+namespace cdbg {
+
+constexpr int CompiledMethodFilter::kCountersCount;
+constexpr uint16 CompiledMethodFilter::kStuckCounter;
+
+std::atomic<uint16>
+    CompiledMethodFilter::counters_[CompiledMethodFilter::kCountersCount];
+
+
+void CompiledMethodFilter::Add(jmethodID method) {
+  uint32 first;
+  uint32 second;
+  GetCounters(method, &first, &second);
+
+  UpdateCounter(first, 1);
+  UpdateCounter(second, 1);
+}
+
+
+void CompiledMethodFilter::Remove(jmethodID method) {
+  uint32 first;
+  uint32 second;
+  GetCounters(method, &first, &second);
+
+  UpdateCounter(first, -1);
+  UpdateCounter(second, -1);
+}
+
+
+void CompiledMethodFilter::Clear() {
+  for (std::atomic<uint16>& counter : counters_) {
+    counter.store(0, std::memory_order_relaxed);
+  }
+}
+
+
+void CompiledMethodFilter::UpdateCounter(uint32 index, int delta) {
+  std::atomic<uint16>& counter = counters_[index];
+
+  uint16 value = counter.load(std::memory_order_relaxed);
+  do {
+    if (value == kStuckCounter) {
+      return;
+    }
+
+    // "Clear" may race with COMPILED_METHOD_UNLOAD of a method that was
+    // added before it.
+    if ((delta < 0) && (value == 0)) {
+      return;
+    }
+  } while (!counter.compare_exchange_weak(
+      value,
+      static_cast<uint16>(value + delta),
+      std::memory_order_relaxed));
+}
+
+}  // namespace cdbg
+}  // namespace devtools
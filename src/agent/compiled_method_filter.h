@@ -0,0 +1,91 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_COMPILED_METHOD_FILTER_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_COMPILED_METHOD_FILTER_H_
+
+#include <atomic>
+#include <cstdint>
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Counting Bloom filter of the methods (jmethodID) that currently have JIT
+// compiled code. Reading local variables of a frame running compiled code
+// forces the JVM to deoptimize the frame, which is expensive for the
+// snapshot and for the application afterwards. The capture consults this
+// filter to only read locals of frames that are known to be interpreted.
+//
+// COMPILED_METHOD_LOAD calls "Add" and COMPILED_METHOD_UNLOAD calls
+// "Remove". A method may have several compiled forms at once (e.g. OSR and
+// regular), each of them is counted. A counter that overflows sticks at the
+// maximum value, so the filter may report false positives. Methods inlined
+// into a compiled caller are not reported by JVMTI on their own, so their
+// frames are not detected.
+//
+// All the functions are lock free and safe to call in JVMTI callbacks.
+class CompiledMethodFilter {
+ public:
+  // Records one more compiled form of "method".
+  static void Add(jmethodID method);
+
+  // Reverts a single "Add" of "method".
+  static void Remove(jmethodID method);
+
+  // Resets all the counters. Called before replaying the COMPILED_METHOD_LOAD
+  // events of the methods compiled so far.
+  static void Clear();
+
+  // Returns false if "method" definitely has no compiled code.
+  static bool MayContain(jmethodID method) {
+    uint32 first;
+    uint32 second;
+    GetCounters(method, &first, &second);
+
+    return (counters_[first].load(std::memory_order_relaxed) != 0) &&
+           (counters_[second].load(std::memory_order_relaxed) != 0);
+  }
+
+ private:
+  CompiledMethodFilter() = delete;
+
+  // Number of counters in the filter (must be a power of 2). Large JIT heavy
+  // applications keep tens of thousands of methods compiled.
+  static constexpr int kCountersCount = 1 << 16;
+
+  // Value that a counter sticks at once it overflows.
+  static constexpr uint16 kStuckCounter = 0xFFFF;
+
+  // Computes the indexes of the two counters of "method".
+  static void GetCounters(jmethodID method, uint32* first, uint32* second) {
+    const uint64 hash =
+        static_cast<uint64>(reinterpret_cast<uintptr_t>(method)) *
+        0x9E3779B97F4A7C15ULL;
+    *first = static_cast<uint32>(hash >> 32) & (kCountersCount - 1);
+    *second = static_cast<uint32>(hash >> 48) & (kCountersCount - 1);
+  }
+
+  // Increments or decrements the counter unless it's stuck.
+  static void UpdateCounter(uint32 index, int delta);
+
+  static std::atomic<uint16> counters_[kCountersCount];
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_COMPILED_METHOD_FILTER_H_
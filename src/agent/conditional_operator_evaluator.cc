@@ -16,6 +16,7 @@
 
 #include "conditional_operator_evaluator.h"
 
+#include "expression_program.h"
 #include "messages.h"
 #include "model.h"
 #include "numeric_cast_evaluator.h"
@@ -52,23 +53,22 @@ bool ConditionalOperatorEvaluator::Compile(
   }
 
   // Case 1: both "if_true_" and "if_false_" are of a boolean type.
-  if (CompileBoolean()) {
-    return true;
-  }
-
   // Case 2: both "if_true_" and "if_false_" are numeric.
-  if (CompileNumeric()) {
-    return true;
-  }
-
   // Case 3: both "if_true_" and "if_false_" are objects.
-  if (CompileObjects()) {
-    return true;
+  if (!CompileBoolean() && !CompileNumeric() && !CompileObjects()) {
+    *error_message = { TypeMismatch };
+    return false;
   }
 
-  *error_message = { TypeMismatch };
+  // Select the branch right away if the condition is constant.
+  JVariant condition_value;
+  jboolean boolean_value = false;
+  if (GetStaticPrimitiveValue(*condition_, &condition_value) &&
+      condition_value.get<jboolean>(&boolean_value)) {
+    passthrough_ = boolean_value ? if_true_.get() : if_false_.get();
+  }
 
-  return false;
+  return true;
 }
 
 
@@ -175,6 +175,10 @@ bool ConditionalOperatorEvaluator::ApplyNumericPromotions(
 
 ErrorOr<JVariant> ConditionalOperatorEvaluator::Evaluate(
     const EvaluationContext& evaluation_context) const {
+  if (passthrough_ != nullptr) {
+    return passthrough_->Evaluate(evaluation_context);
+  }
+
   ErrorOr<JVariant> evaluated_condition =
       condition_->Evaluate(evaluation_context);
   if (evaluated_condition.is_error()) {
@@ -192,6 +196,54 @@ ErrorOr<JVariant> ConditionalOperatorEvaluator::Evaluate(
   return target_expression.Evaluate(evaluation_context);
 }
 
+
+int ConditionalOperatorEvaluator::Lower(
+    ExpressionProgramBuilder* builder) const {
+  // Objects can't be stored in registers.
+  if (result_type_.type == JType::Object) {
+    return ExpressionProgramBuilder::kNoRegister;
+  }
+
+  if (passthrough_ != nullptr) {
+    return passthrough_->Lower(builder);
+  }
+
+  const int condition = condition_->Lower(builder);
+  if (condition == ExpressionProgramBuilder::kNoRegister) {
+    return ExpressionProgramBuilder::kNoRegister;
+  }
+
+  const int result = builder->AllocateRegister();
+  if (result == ExpressionProgramBuilder::kNoRegister) {
+    return ExpressionProgramBuilder::kNoRegister;
+  }
+
+  // Only the selected branch is evaluated, same as in "Evaluate".
+  const int jump_to_if_false = builder->AddJump(condition);
+
+  const int if_true = if_true_->Lower(builder);
+  if (if_true == ExpressionProgramBuilder::kNoRegister) {
+    return ExpressionProgramBuilder::kNoRegister;
+  }
+
+  builder->AddMove(result, if_true);
+  const int jump_to_end =
+      builder->AddJump(ExpressionProgramBuilder::kNoRegister);
+
+  builder->BindJump(jump_to_if_false);
+
+  const int if_false = if_false_->Lower(builder);
+  if (if_false == ExpressionProgramBuilder::kNoRegister) {
+    return ExpressionProgramBuilder::kNoRegister;
+  }
+
+  builder->AddMove(result, if_false);
+
+  builder->BindJump(jump_to_end);
+
+  return result;
+}
+
 }  // namespace cdbg
 }  // namespace devtools
 
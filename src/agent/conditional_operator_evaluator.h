@@ -43,9 +43,25 @@ class ConditionalOperatorEvaluator : public ExpressionEvaluator {
   }
 
   Nullable<jvalue> GetStaticValue() const override {
+    if (passthrough_ != nullptr) {
+      return passthrough_->GetStaticValue();
+    }
+
     return nullptr;
   }
 
+  bool HasMethodCalls() const override {
+    if (passthrough_ != nullptr) {
+      return passthrough_->HasMethodCalls();
+    }
+
+    return condition_->HasMethodCalls() ||
+           if_true_->HasMethodCalls() ||
+           if_false_->HasMethodCalls();
+  }
+
+  int Lower(ExpressionProgramBuilder* builder) const override;
+
   ErrorOr<JVariant> Evaluate(
       const EvaluationContext& evaluation_context) const override;
 
@@ -87,6 +103,10 @@ class ConditionalOperatorEvaluator : public ExpressionEvaluator {
   // computer_ is supposed product.
   JSignature result_type_;
 
+  // Branch selected at compile time if "condition_" is constant or null
+  // otherwise.
+  const ExpressionEvaluator* passthrough_ { nullptr };
+
   DISALLOW_COPY_AND_ASSIGN(ConditionalOperatorEvaluator);
 };
 
@@ -16,16 +16,49 @@
 
 #include "config.h"
 
+#include <atomic>
+#include <cstring>
+
 namespace devtools {
 namespace cdbg {
 
+// Computes FNV-1a hash of a null terminated string.
+static uint32 HashString(const char* s) {
+  uint32 hash = 2166136261u;
+  for (; *s != '\0'; ++s) {
+    hash ^= static_cast<uint8>(*s);
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+
+// Orders compiled classes by signature hash and then by signature.
+template <typename TCompiledClass>
+static bool CompiledClassLess(
+    const TCompiledClass& cls,
+    const std::pair<uint32, const char*>& key) {
+  if (cls.signature_hash != key.first) {
+    return cls.signature_hash < key.first;
+  }
+
+  return strcmp(cls.signature->c_str(), key.second) < 0;
+}
+
+
+template <typename TCompiledRule>
 static bool MatchMethodRule(
-    const Config::Method& rule,
-    const string& method_name,
-    const string& method_signature) {
+    const TCompiledRule& compiled_rule,
+    uint32 method_name_hash,
+    const char* method_name,
+    const char* method_signature) {
+  const Config::Method& rule = *compiled_rule.rule;
+
   // Empty method name means "match all".
   if (!rule.name.empty() &&
-      (rule.name != method_name)) {
+      ((compiled_rule.name_hash != method_name_hash) ||
+       (rule.name != method_name))) {
     return false;
   }
 
@@ -48,29 +81,38 @@ Config::~Config() {
 
 
 const Config::Method& Config::GetMethodRule(
-    const string& method_cls_signature,
-    const string& object_cls_signature,
-    const string& method_name,
-    const string& method_signature) const {
-  std::map<string, std::vector<Config::Method>>::const_iterator it;
-
-  it = classes_.find(object_cls_signature);
-  if (it != classes_.end()) {
-    for (const Config::Method& rule : it->second) {
-      if (MatchMethodRule(rule, method_name, method_signature)) {
-        return rule;
+    const char* method_cls_signature,
+    const char* object_cls_signature,
+    const char* method_name,
+    const char* method_signature) const {
+  const uint32 method_name_hash = HashString(method_name);
+
+  const CompiledClass* cls = FindCompiledClass(object_cls_signature);
+  if (cls != nullptr) {
+    const CompiledRule* rules = &compiled_rules_[cls->first_rule];
+    for (int i = 0; i < cls->rules_count; ++i) {
+      if (MatchMethodRule(
+              rules[i],
+              method_name_hash,
+              method_name,
+              method_signature)) {
+        return *rules[i].rule;
       }
     }
   }
 
   // Compare class that defined the method with the class of the object.
-  if (method_cls_signature != object_cls_signature) {
-    it = classes_.find(method_cls_signature);
-    if (it != classes_.end()) {
-      for (const Config::Method& rule : it->second) {
-        if (rule.applies_to_derived_classes &&
-            MatchMethodRule(rule, method_name, method_signature)) {
-          return rule;
+  if (strcmp(method_cls_signature, object_cls_signature) != 0) {
+    cls = FindCompiledClass(method_cls_signature);
+    if (cls != nullptr) {
+      const CompiledRule* rules = &compiled_rules_[cls->first_derived_rule];
+      for (int i = 0; i < cls->derived_rules_count; ++i) {
+        if (MatchMethodRule(
+                rules[i],
+                method_name_hash,
+                method_name,
+                method_signature)) {
+          return *rules[i].rule;
         }
       }
     }
@@ -80,10 +122,76 @@ const Config::Method& Config::GetMethodRule(
 }
 
 
+void Config::Compile() {
+  compiled_classes_.clear();
+  compiled_rules_.clear();
+
+  compiled_classes_.reserve(classes_.size());
+
+  for (const auto& it : classes_) {
+    CompiledClass cls;
+    cls.signature_hash = HashString(it.first.c_str());
+    cls.signature = &it.first;
+
+    cls.first_rule = compiled_rules_.size();
+    for (const Method& rule : it.second) {
+      compiled_rules_.push_back({ HashString(rule.name.c_str()), &rule });
+    }
+    cls.rules_count = compiled_rules_.size() - cls.first_rule;
+
+    cls.first_derived_rule = compiled_rules_.size();
+    for (const Method& rule : it.second) {
+      if (rule.applies_to_derived_classes) {
+        compiled_rules_.push_back({ HashString(rule.name.c_str()), &rule });
+      }
+    }
+    cls.derived_rules_count = compiled_rules_.size() - cls.first_derived_rule;
+
+    compiled_classes_.push_back(cls);
+  }
+
+  std::sort(
+      compiled_classes_.begin(),
+      compiled_classes_.end(),
+      [] (const CompiledClass& c1, const CompiledClass& c2) {
+        return CompiledClassLess(
+            c1,
+            std::make_pair(c2.signature_hash, c2.signature->c_str()));
+      });
+}
+
+
+const Config::CompiledClass* Config::FindCompiledClass(
+    const char* class_signature) const {
+  const auto key = std::make_pair(HashString(class_signature), class_signature);
+  auto it = std::lower_bound(
+      compiled_classes_.begin(),
+      compiled_classes_.end(),
+      key,
+      CompiledClassLess<CompiledClass>);
+  if ((it == compiled_classes_.end()) ||
+      (it->signature_hash != key.first) ||
+      (*it->signature != class_signature)) {
+    return nullptr;
+  }
+
+  return &*it;
+}
+
+
 Config::Builder::Builder() {
 }
 
 
+std::unique_ptr<Config> Config::Builder::Build() {
+  static std::atomic<int64> last_version { 0 };
+
+  config_->version_ = ++last_version;
+  config_->Compile();
+  return std::move(config_);
+}
+
+
 Config::Builder& Config::Builder::SetClassConfig(
       const string& class_signature,
       std::vector<Config::Method> rules) {
@@ -71,6 +71,15 @@ class Config {
         jobject,
         std::vector<JVariant>*)> thunk;
 
+    // Optional native implementation of the method. If set, the method is
+    // not called through JNI. Instead the intrinsic computes the result
+    // directly. This is only applicable if "action" is Allow (see
+    // "safe_caller_intrinsics.h").
+    std::function<MethodCallResult(
+        SafeMethodCaller*,
+        jobject,
+        const std::vector<JVariant>&)> intrinsic;
+
     // If true this rule will apply to derived classes that do not overload
     // this method. For example consider "x.getClass()".
     bool applies_to_derived_classes = false;
@@ -143,7 +152,8 @@ class Config {
         MethodCallQuotaType quota_type,
         const MethodCallQuota& quota);
 
-    std::unique_ptr<Config> Build() { return std::move(config_); }
+    // Finalizes the configuration. The builder can't be used afterwards.
+    std::unique_ptr<Config> Build();
 
    private:
     std::unique_ptr<Config> config_ { new Config };
@@ -161,11 +171,24 @@ class Config {
   // "object_cls_signature" will be "Ljava/lang/Integer;".
   // For static methods, "object_cls_signature" is either equal to
   // "method_cls_signature" or its subclass.
+  // The lookup doesn't allocate memory.
+  const Method& GetMethodRule(
+      const char* method_cls_signature,
+      const char* object_cls_signature,
+      const char* method_name,
+      const char* method_signature) const;
+
   const Method& GetMethodRule(
       const string& method_cls_signature,
       const string& object_cls_signature,
       const string& method_name,
-      const string& method_signature) const;
+      const string& method_signature) const {
+    return GetMethodRule(
+        method_cls_signature.c_str(),
+        object_cls_signature.c_str(),
+        method_name.c_str(),
+        method_signature.c_str());
+  }
 
   // Gets the method call quota for the specified use.
   const MethodCallQuota& GetQuota(MethodCallQuotaType type) const {
@@ -173,17 +196,65 @@ class Config {
     return quota_[type];
   }
 
+  // Unique number of the configuration, increasing with each "Build". Data
+  // derived from a configuration (like cached method rules) is only valid
+  // with the configuration of the same version.
+  int64 version() const { return version_; }
+
  private:
   // Default configuration. All method calls are blocked. All quota settings
   // are zero.
   Config();
 
+  // Method rule in the flattened lookup structure.
+  struct CompiledRule {
+    // Hash of "rule->name" (not used if the name is empty).
+    uint32 name_hash;
+
+    // Original rule in "classes_".
+    const Method* rule;
+  };
+
+  // Class in the flattened lookup structure.
+  struct CompiledClass {
+    // Hash of "signature".
+    uint32 signature_hash;
+
+    // Class signature.
+    const string* signature;
+
+    // Range of rules in "compiled_rules_" applicable to the class.
+    int32 first_rule;
+    int32 rules_count;
+
+    // Range of rules in "compiled_rules_" applicable to derived classes
+    // that do not override the method. This is a subset of the rules above.
+    int32 first_derived_rule;
+    int32 derived_rules_count;
+  };
+
+  // Builds "compiled_classes_" and "compiled_rules_" from "classes_".
+  void Compile();
+
+  // Finds the class in "compiled_classes_". Returns nullptr if the class has
+  // no rules.
+  const CompiledClass* FindCompiledClass(const char* class_signature) const;
+
  private:
   // Non default configuration for class methods. The key is class signature.
   // The list is scanned sequentially until a match is found. If no matches
   // found, the default is Method::kDefault.
   std::map<string, std::vector<Method>> classes_;
 
+  // Flattened version of "classes_" used for lookups. Sorted by signature
+  // hash (and by signature on hash collisions). Immutable after "Compile".
+  std::vector<CompiledClass> compiled_classes_;
+
+  // Rules of all the classes in "compiled_classes_". Each class references
+  // two ranges in this array: all rules and rules applicable to derived
+  // classes, both in their original order.
+  std::vector<CompiledRule> compiled_rules_;
+
   // Default behavior for all class methods unless a method has an explicit
   // configuration.
   Method default_rule_;
@@ -191,6 +262,9 @@ class Config {
   // Method call quotas.
   MethodCallQuota quota_[MAX_TYPES];
 
+  // Assigned by "Builder::Build".
+  int64 version_ { 0 };
+
   DISALLOW_COPY_AND_ASSIGN(Config);
 };
 
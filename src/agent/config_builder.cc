@@ -18,6 +18,7 @@
 
 #include <sstream>
 
+#include "safe_caller_intrinsics.h"
 #include "safe_caller_proxies.h"
 
 // Multiple items in flags like "extra_allowed_methods" are separated with
@@ -91,6 +92,12 @@ DEFINE_int32(
     20,
     "Maximum stack depth that safe caller will allow");
 
+DEFINE_bool(
+    enable_safe_caller_intrinsics,
+    true,
+    "Computes some frequently called JDK methods (e.g. \"String.equals\") "
+    "natively instead of calling them through JNI");
+
 namespace devtools {
 namespace cdbg {
 
@@ -116,6 +123,16 @@ class MethodRuleBuilder {
     return *this;
   }
 
+  MethodRuleBuilder& intrinsic(
+      std::function<MethodCallResult(
+          SafeMethodCaller*,
+          jobject source,
+          const std::vector<JVariant>&)> fn) {
+    DCHECK(rule_.action == Config::Method::CallAction::Allow);
+    rule_.intrinsic = fn;
+    return *this;
+  }
+
   MethodRuleBuilder& applies_to_derived_classes() {
     // Derived class can define method with the same name, but different
     // signature. It is unsafe to allow it. It would also be nice to assert
@@ -522,6 +539,27 @@ static std::map<string, std::vector<Config::Method>> DefaultMethodsConfig() {
       }
   }();
 
+  //
+  // Native implementation of frequently called methods. The intrinsic rules
+  // precede all other rules of the class, so that they take priority.
+  //
+
+  if (FLAGS_enable_safe_caller_intrinsics) {
+    int intrinsics_count = 0;
+    const SafeCallerIntrinsic* intrinsics =
+        GetSafeCallerIntrinsics(&intrinsics_count);
+    for (int i = 0; i < intrinsics_count; ++i) {
+      std::vector<Config::Method>& rules =
+          classes[intrinsics[i].class_name];
+      rules.insert(
+          rules.begin(),
+          Allow(intrinsics[i].method_name)
+              .signature(intrinsics[i].method_signature)
+              .intrinsic(intrinsics[i].fn)
+              .build());
+    }
+  }
+
   //
   // Additional configuration provided through flags.
   //
@@ -0,0 +1,43 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "config_store.h"
+
+namespace devtools {
+namespace cdbg {
+
+std::shared_ptr<const Config> ConfigStore::Get() const {
+  MutexLock lock(&mu_);
+  return config_;
+}
+
+
+void ConfigStore::Set(std::unique_ptr<Config> config) {
+  std::shared_ptr<const Config> new_config(std::move(config));
+
+  // The previous snapshot is released outside of the lock (unless it is
+  // still in use).
+  std::shared_ptr<const Config> old_config;
+
+  {
+    MutexLock lock(&mu_);
+    old_config = std::move(config_);
+    config_ = std::move(new_config);
+  }
+}
+
+}  // namespace cdbg
+}  // namespace devtools
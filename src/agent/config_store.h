@@ -0,0 +1,58 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_CONFIG_STORE_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_CONFIG_STORE_H_
+
+#include <memory>
+#include "common.h"
+#include "config.h"
+#include "mutex.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Holds the current debuglet configuration. "Config" is immutable, so the
+// configuration is updated by atomically replacing the snapshot. Users take
+// the snapshot once per unit of work (e.g. a safe method caller) and keep
+// using it even if the configuration is replaced in the meantime. The old
+// snapshot is released once the last user is done with it.
+//
+// This class is thread safe.
+class ConfigStore {
+ public:
+  ConfigStore() { }
+
+  // Gets the current configuration snapshot or nullptr if not set yet.
+  std::shared_ptr<const Config> Get() const;
+
+  // Replaces the current configuration snapshot.
+  void Set(std::unique_ptr<Config> config);
+
+ private:
+  // Locks access to "config_".
+  mutable Mutex mu_;
+
+  // Current configuration snapshot.
+  std::shared_ptr<const Config> config_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConfigStore);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_CONFIG_STORE_H_
@@ -17,60 +17,155 @@
 #include "debugger.h"
 
 #include <memory>
+#include "file_dynamic_logger.h"
 #include "jni_utils.h"
 #include "jvm_breakpoint.h"
 #include "jvm_breakpoints_manager.h"
-#include "safe_method_caller.h"
+#include "overhead_governor.h"
+#include "rate_limit.h"
+#include "sharded_leaky_bucket.h"
 #include "statistician.h"
 #include "stopwatch.h"
+#include "trace_recorder.h"
+
+DEFINE_string(
+    cdbg_breakpoint_counters_file,
+    "",
+    "if set, hit counters of the active breakpoints are periodically written "
+    "to this file in Prometheus text format");
 
 DEFINE_int32(
     cdbg_class_files_cache_size,
     1024 * 1024,  // 1 MB.
     "Cache size for class files used in safe method caller");
 
+DEFINE_int32(
+    cdbg_shared_call_target_cache_size,
+    4096,
+    "Maximum number of resolved method call targets cached across all "
+    "the expressions evaluated by safe method caller");
+
+DEFINE_int32(
+    cdbg_compiled_breakpoint_cache_size,
+    256,
+    "Maximum number of compiled breakpoint conditions and expressions "
+    "reused by breakpoints set again on the same location");
+
+DEFINE_int32(
+    cdbg_source_location_cache_size,
+    4096,
+    "Maximum number of resolved breakpoint source locations and of class "
+    "name lookups cached across breakpoint updates");
+
+DEFINE_int32(
+    cdbg_class_name_negative_cache_ttl_ms,
+    60 * 1000,  // 1 minute.
+    "Time in milliseconds to remember that a class name referenced in an "
+    "expression was not found in the class path");
+
+DEFINE_bool(
+    cdbg_prewarm_class_files,
+    true,
+    "Load the class files of the JDK collections and boxing classes most "
+    "used by pretty printers into the safe caller cache when the debugger "
+    "is attached, so that the first snapshot doesn't spend its class load "
+    "quota on them");
+
+DEFINE_int32(
+    cdbg_unloaded_classes_sweep_budget_us,
+    1000,
+    "Time in microseconds the agent thread spends on each idle cycle "
+    "removing unloaded classes from the class index and the class metadata "
+    "cache (0 to disable)");
+
 namespace devtools {
 namespace cdbg {
 
+// Classes whose methods pretty printers and common expressions typically
+// interpret with the safe caller. Classes that are not loaded are skipped.
+static constexpr const char* kPrewarmClassSignatures[] = {
+  "Ljava/util/AbstractMap;",
+  "Ljava/util/ArrayList;",
+  "Ljava/util/ArrayList$Itr;",
+  "Ljava/util/HashMap;",
+  "Ljava/util/HashMap$EntryIterator;",
+  "Ljava/util/HashMap$EntrySet;",
+  "Ljava/util/HashMap$HashIterator;",
+  "Ljava/util/LinkedHashMap;",
+  "Ljava/util/LinkedHashMap$LinkedEntryIterator;",
+  "Ljava/util/LinkedHashMap$LinkedEntrySet;",
+  "Ljava/util/LinkedHashMap$LinkedHashIterator;",
+  "Ljava/lang/AbstractStringBuilder;",
+  "Ljava/lang/StringBuilder;",
+  "Ljava/lang/Integer;"
+};
+
 Debugger::Debugger(
     Scheduler<>* scheduler,
-    Config* config,
+    const ConfigStore* config,
     EvalCallStack* eval_call_stack,
     std::unique_ptr<MethodLocals> method_locals,
     std::unique_ptr<ClassMetadataReader> class_metadata_reader,
     ClassPathLookup* class_path_lookup,
     std::function<std::unique_ptr<BreakpointLabelsProvider>()> labels_factory,
     FormatQueue* format_queue,
-    CanaryControl* canary_control /* = nullptr */)
+    DynamicLogQueue* dynamic_log_queue,
+    CanaryControl* canary_control /* = nullptr */,
+    std::function<bool()> request_breakpoints_activation /* = nullptr */)
     : config_(config),
       eval_call_stack_(eval_call_stack),
       method_locals_(std::move(method_locals)),
       class_metadata_reader_(std::move(class_metadata_reader)),
       object_evaluator_(&class_indexer_, class_metadata_reader_.get()),
-      class_files_cache_(&class_indexer_, FLAGS_cdbg_class_files_cache_size) {
-  evaluators_.class_path_lookup = class_path_lookup;
+      class_files_cache_(&class_indexer_, FLAGS_cdbg_class_files_cache_size),
+      shared_call_target_cache_(FLAGS_cdbg_shared_call_target_cache_size),
+      safe_method_caller_pool_(
+          config_,
+          &class_indexer_,
+          &class_files_cache_,
+          &shared_call_target_cache_),
+      compiled_breakpoint_cache_(FLAGS_cdbg_compiled_breakpoint_cache_size),
+      cached_class_path_lookup_(
+          class_path_lookup,
+          FLAGS_cdbg_source_location_cache_size,
+          FLAGS_cdbg_class_name_negative_cache_ttl_ms),
+      dynamic_logger_(std::make_shared<JvmDynamicLogger>()),
+      file_dynamic_logger_(CreateFileDynamicLogger()) {
+  on_class_prepared_cookie_ = class_indexer_.SubscribeOnClassPreparedEvents(
+      std::bind(
+          &CachedClassPathLookup::OnClassPrepared,
+          &cached_class_path_lookup_,
+          std::placeholders::_1,
+          std::placeholders::_2));
+  on_classes_prepared_cookie_ = class_indexer_.SubscribeOnClassesPreparedEvents(
+      std::bind(
+          &CachedClassPathLookup::OnClassesPrepared,
+          &cached_class_path_lookup_,
+          std::placeholders::_1));
+
+  evaluators_.class_path_lookup = &cached_class_path_lookup_;
   evaluators_.class_indexer = &class_indexer_;
   evaluators_.eval_call_stack = eval_call_stack_;
   evaluators_.method_locals = method_locals_.get();
   evaluators_.class_metadata_reader = class_metadata_reader_.get();
   evaluators_.object_evaluator = &object_evaluator_;
+  evaluators_.compiled_breakpoint_cache = &compiled_breakpoint_cache_;
   evaluators_.method_caller_factory = [this](Config::MethodCallQuotaType type) {
-    return std::unique_ptr<MethodCaller>(new SafeMethodCaller(
-        config_,
-        config_->GetQuota(type),
-        &class_indexer_,
-        &class_files_cache_));
+    return safe_method_caller_pool_.Acquire(type);
   };
   evaluators_.labels_factory = labels_factory;
 
-  auto factory = [this, scheduler, format_queue](
+  auto factory = [this, scheduler, format_queue, dynamic_log_queue](
       BreakpointsManager* breakpoints_manager,
       std::unique_ptr<BreakpointModel> breakpoint_definition) {
     return std::make_shared<JvmBreakpoint>(
         scheduler,
         &evaluators_,
         format_queue,
-        &dynamic_logger_,
+        dynamic_log_queue,
+        (file_dynamic_logger_ != nullptr)
+            ? file_dynamic_logger_
+            : dynamic_logger_,
         breakpoints_manager,
         std::move(breakpoint_definition));
   };
@@ -79,12 +174,23 @@ Debugger::Debugger(
       factory,
       &evaluators_,
       format_queue,
-      canary_control));
+      canary_control,
+      request_breakpoints_activation));
+
+  agent_status_cookie_ = AgentStatus::GetInstance()->Register(
+      "debugger",
+      std::bind(&Debugger::WriteStatus, this, std::placeholders::_1));
 }
 
 
 Debugger::~Debugger() {
+  AgentStatus::GetInstance()->Unregister(agent_status_cookie_);
+
   breakpoints_manager_->Cleanup();
+  class_indexer_.UnsubscribeOnClassPreparedEvents(
+      std::move(on_class_prepared_cookie_));
+  class_indexer_.UnsubscribeOnClassesPreparedEvents(
+      std::move(on_classes_prepared_cookie_));
   class_indexer_.Cleanup();
 }
 
@@ -102,7 +208,7 @@ void Debugger::Initialize() {
   object_evaluator_.Initialize();
 
   // Create logger for dynamic logging.
-  dynamic_logger_.Initialize();
+  dynamic_logger_->Initialize();
 
   LOG(INFO) << "Debugger::Initialize initialization time: "
             << stopwatch.GetElapsedMillis() << " ms";
@@ -110,6 +216,8 @@ void Debugger::Initialize() {
 
 
 void Debugger::JvmtiOnClassPrepare(jthread thread, jclass cls) {
+  ScopedOverheadCharge overhead_charge;
+  ScopedTraceSpan trace_span("class_prepare");
   Stopwatch stopwatch;
 
   // Index the new class.
@@ -129,6 +237,8 @@ void Debugger::JvmtiOnCompiledMethodUnload(
   eval_call_stack_->JvmtiOnCompiledMethodUnload(method);
   method_locals_->JvmtiOnCompiledMethodUnload(method);
   breakpoints_manager_->JvmtiOnCompiledMethodUnload(method);
+  shared_call_target_cache_.JvmtiOnCompiledMethodUnload(method);
+  compiled_breakpoint_cache_.JvmtiOnCompiledMethodUnload(method);
 }
 
 
@@ -146,5 +256,130 @@ void Debugger::SetActiveBreakpointsList(
 }
 
 
+void Debugger::UpdateActiveBreakpointsList(
+    std::vector<std::unique_ptr<BreakpointModel>> added_breakpoints,
+    const std::vector<string>& removed_breakpoint_ids) {
+  breakpoints_manager_->UpdateActiveBreakpointsList(
+      std::move(added_breakpoints),
+      removed_breakpoint_ids);
+}
+
+
+void Debugger::RemoveAllBreakpoints() {
+  breakpoints_manager_->RemoveAllBreakpoints();
+}
+
+
+void Debugger::ActivateScheduledBreakpoints() {
+  breakpoints_manager_->ActivateScheduledBreakpoints();
+}
+
+
+void Debugger::PrewarmClassFiles() {
+  if (!FLAGS_cdbg_prewarm_class_files || are_class_files_prewarmed_) {
+    return;
+  }
+
+  are_class_files_prewarmed_ = true;
+
+  Stopwatch stopwatch;
+  int pinned_count = 0;
+  for (const char* signature : kPrewarmClassSignatures) {
+    JniLocalRef cls = class_indexer_.FindClassBySignature(signature);
+    if ((cls != nullptr) && class_files_cache_.Pin(cls.get())) {
+      ++pinned_count;
+    }
+  }
+
+  LOG(INFO) << "Prewarmed " << pinned_count << " class files in "
+            << stopwatch.GetElapsedMillis() << " ms";
+}
+
+
+void Debugger::ExportBreakpointCounters() {
+  if (FLAGS_cdbg_breakpoint_counters_file.empty()) {
+    return;
+  }
+
+  std::map<string, BreakpointCounters::Snapshot> active_breakpoints;
+  BreakpointCounters::Snapshot total;
+  breakpoints_manager_->GetBreakpointCounters(&active_breakpoints, &total);
+
+  if (!WriteBreakpointCountersFile(
+          FLAGS_cdbg_breakpoint_counters_file,
+          active_breakpoints,
+          total)) {
+    LOG_EVERY_N(WARNING, 100) << "Failed to write breakpoint counters to "
+                              << FLAGS_cdbg_breakpoint_counters_file;
+  }
+}
+
+
+void Debugger::WriteStatus(std::ostream* os) {
+  const ClassFilesCache::Stats class_files_stats =
+      class_files_cache_.GetStats();
+  const int64 class_files_requests =
+      class_files_stats.hits + class_files_stats.misses;
+  *os << "class_files_cache_hits: " << class_files_stats.hits << '\n'
+      << "class_files_cache_misses: " << class_files_stats.misses << '\n'
+      << "class_files_cache_cold_hits: " << class_files_stats.cold_hits
+      << '\n'
+      << "class_files_cache_cold_bytes: " << class_files_stats.cold_size
+      << '\n'
+      << "class_files_cache_hit_rate_percent: "
+      << ((class_files_requests > 0)
+          ? class_files_stats.hits * 100 / class_files_requests
+          : 0)
+      << '\n'
+      << "class_files_cache_bytes: " << class_files_cache_.total_size()
+      << '\n';
+
+  *os << "global_condition_cost_tokens: "
+      << breakpoints_manager_->GetGlobalConditionCostLimiter()
+             ->available_tokens()
+      << '\n';
+
+  std::map<string, BreakpointCounters::Snapshot> active_breakpoints;
+  BreakpointCounters::Snapshot total;
+  breakpoints_manager_->GetBreakpointCounters(&active_breakpoints, &total);
+
+  *os << "active_breakpoints: " << active_breakpoints.size() << '\n'
+      << "breakpoints_total: " << FormatBreakpointCounters(total) << '\n';
+  for (const auto& breakpoint : active_breakpoints) {
+    *os << "breakpoint " << breakpoint.first << ": "
+        << FormatBreakpointCounters(breakpoint.second) << '\n';
+  }
+}
+
+
+void Debugger::RemoveUnloadedClasses() {
+  if (FLAGS_cdbg_unloaded_classes_sweep_budget_us <= 0) {
+    return;
+  }
+
+  // The two caches are swept independently, each with half of the budget.
+  const int64 budget_micros = FLAGS_cdbg_unloaded_classes_sweep_budget_us / 2;
+  const int removed_count =
+      class_indexer_.RemoveUnloadedClasses(budget_micros) +
+      class_metadata_reader_->RemoveUnloadedClasses(budget_micros);
+  if (removed_count > 0) {
+    statUnloadedClassesRemoved->add(removed_count);
+    VLOG(1) << "Removed " << removed_count << " entries of unloaded classes";
+  }
+}
+
+
+void Debugger::FlushRepeatedDynamicLogs() {
+  dynamic_logger_->FlushRepeatedMessages();
+}
+
+
+void Debugger::ResizeCostLimiters() {
+  ResizeShardedGlobalCostLimiter(
+      CostLimitType::BreakpointCondition,
+      breakpoints_manager_->GetGlobalConditionCostLimiter());
+}
+
+
 }  // namespace cdbg
 }  // namespace devtools
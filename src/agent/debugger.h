@@ -19,24 +19,32 @@
 
 #include <atomic>
 #include <memory>
+#include <ostream>
+#include "agent_status.h"
 #include "breakpoint_labels_provider.h"
+#include "cached_class_path_lookup.h"
 #include "canary_control.h"
 #include "class_files_cache.h"
 #include "class_metadata_reader.h"
 #include "common.h"
+#include "compiled_breakpoint_cache.h"
+#include "config_store.h"
 #include "eval_call_stack.h"
 #include "jvm_dynamic_logger.h"
 #include "jvm_evaluators.h"
 #include "jvm_class_indexer.h"
 #include "jvm_object_evaluator.h"
 #include "method_locals.h"
+#include "safe_method_caller_pool.h"
 #include "scheduler.h"
+#include "shared_call_target_cache.h"
 
 namespace devtools {
 namespace cdbg {
 
 class BreakpointsManager;
 class ClassPathLookup;
+class DynamicLogQueue;
 class FormatQueue;
 
 // Debugger module loaded by JVMTI agent. The module is separated from the
@@ -45,17 +53,20 @@ class FormatQueue;
 class Debugger {
  public:
   // All pointer arguments are not owned by this class and must outlive
-  // this object.
+  // this object. "request_breakpoints_activation" wakes up the agent thread
+  // calling "ActivateScheduledBreakpoints" (see "JvmBreakpointsManager").
   Debugger(
       Scheduler<>* scheduler,
-      Config* config,
+      const ConfigStore* config,
       EvalCallStack* eval_call_stack,
       std::unique_ptr<MethodLocals> method_locals,
       std::unique_ptr<ClassMetadataReader> class_metadata_reader,
       ClassPathLookup* class_path_lookup,
       std::function<std::unique_ptr<BreakpointLabelsProvider>()> labels_factory,
       FormatQueue* format_queue,
-      CanaryControl* canary_control = nullptr);
+      DynamicLogQueue* dynamic_log_queue,
+      CanaryControl* canary_control = nullptr,
+      std::function<bool()> request_breakpoints_activation = nullptr);
 
   ~Debugger();
 
@@ -82,9 +93,52 @@ class Debugger {
   void SetActiveBreakpointsList(
       std::vector<std::unique_ptr<BreakpointModel>> breakpoints);
 
+  // Adds and removes breakpoints from the list of active breakpoints.
+  void UpdateActiveBreakpointsList(
+      std::vector<std::unique_ptr<BreakpointModel>> added_breakpoints,
+      const std::vector<string>& removed_breakpoint_ids);
+
+  // Removes all the breakpoints. The debugger keeps its class index and
+  // caches up to date and can start over with a new list of breakpoints.
+  void RemoveAllBreakpoints();
+
+  // Activates pending breakpoints whose classes were prepared since the last
+  // call. Called from the agent thread, so that compilation of breakpoint
+  // expressions doesn't stall the application thread loading the class.
+  void ActivateScheduledBreakpoints();
+
+  // Pins the class files of JDK classes frequently used by pretty printers
+  // in the safe caller cache (see "FLAGS_cdbg_prewarm_class_files"). Only
+  // the first call does anything. Called from the agent thread once the
+  // debugger is attached.
+  void PrewarmClassFiles();
+
+  // Writes the hit counters of all the breakpoints to the file specified by
+  // "FLAGS_cdbg_breakpoint_counters_file" (if any).
+  void ExportBreakpointCounters();
+
+  // Incrementally removes unloaded classes from the class index and from
+  // the class metadata cache (see
+  // "FLAGS_cdbg_unloaded_classes_sweep_budget_us").
+  void RemoveUnloadedClasses();
+
+  // Writes the summaries of repeated dynamic log messages (see
+  // "JvmDynamicLogger::FlushRepeatedMessages").
+  void FlushRepeatedDynamicLogs();
+
+  // Resizes the global cost limiters after the number of CPUs available to
+  // the process changed.
+  void ResizeCostLimiters();
+
+ private:
+  // Writes the state of caches, rate limiters and breakpoint counters for
+  // "AgentStatus".
+  void WriteStatus(std::ostream* os);
+
  private:
-  // Debugger agent configuration.
-  Config* const config_;
+  // Debugger agent configuration. The configuration can be replaced while
+  // the debugger is running.
+  const ConfigStore* const config_;
 
   // Reads stack trace upon a breakpoint hit. Not owned by this class.
   EvalCallStack* const eval_call_stack_;
@@ -105,16 +159,45 @@ class Debugger {
   // Global cache of loaded class files for safe caller.
   ClassFilesCache class_files_cache_;
 
+  // True once "PrewarmClassFiles" was called.
+  bool are_class_files_prewarmed_ = false;
+
+  // Global cache of resolved method call targets for safe caller.
+  SharedCallTargetCache shared_call_target_cache_;
+
+  // Idle safe method callers reused across breakpoint hits.
+  SafeMethodCallerPool safe_method_caller_pool_;
+
+  // Global cache of compiled breakpoint expressions.
+  CompiledBreakpointCache compiled_breakpoint_cache_;
+
+  // Caches resolved breakpoint locations and class name lookups on top of
+  // "ClassPathLookup".
+  CachedClassPathLookup cached_class_path_lookup_;
+
+  // Subscriptions of "cached_class_path_lookup_" to class prepare events.
+  ClassIndexer::OnClassPreparedEvent::Cookie on_class_prepared_cookie_;
+  ClassIndexer::OnClassesPreparedEvent::Cookie on_classes_prepared_cookie_;
+
   // Bundles all the evaluation classes together.
   JvmEvaluators evaluators_;
 
-  // Logger for dynamic logs.
-  JvmDynamicLogger dynamic_logger_;
+  // Logger for dynamic logs. Pending entries in the dynamic log queue keep
+  // the logger alive after the debugger is detached.
+  std::shared_ptr<JvmDynamicLogger> dynamic_logger_;
+
+  // Logger writing dynamic logs directly to a file instead of
+  // "dynamic_logger_" or nullptr if not enabled (see
+  // "FLAGS_dynamic_log_output").
+  std::shared_ptr<DynamicLogger> file_dynamic_logger_;
 
   // Manages breakpoints and computes the state of the program on breakpoint
   // hit.
   std::unique_ptr<BreakpointsManager> breakpoints_manager_;
 
+  // Registration of "WriteStatus" in "AgentStatus".
+  AgentStatus::Cookie agent_status_cookie_;
+
   DISALLOW_COPY_AND_ASSIGN(Debugger);
 };
 
@@ -0,0 +1,184 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dynamic_log_queue.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+#include "dynamic_logger.h"
+#include "resolved_source_location.h"
+#include "statistician.h"
+#include "stopwatch.h"
+
+namespace devtools {
+namespace cdbg {
+
+DynamicLogQueue::DynamicLogQueue() {
+  for (int i = 0; i < kMaxDynamicLogQueueSize; ++i) {
+    slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+
+DynamicLogQueue::~DynamicLogQueue() {
+  if (size_ > 0) {
+    LOG(WARNING) << "Pending dynamic log entries are abandoned";
+  }
+}
+
+
+void DynamicLogQueue::RemoveAll() {
+  while (Pop() != nullptr) {
+  }
+}
+
+
+bool DynamicLogQueue::Enqueue(std::unique_ptr<DynamicLogEntry> entry) {
+  uint64 position = enqueue_position_.load(std::memory_order_relaxed);
+  Slot* slot = nullptr;
+  while (true) {
+    slot = &slots_[position % kMaxDynamicLogQueueSize];
+    const uint64 sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence == position) {
+      // The slot is free. Try to claim it.
+      if (enqueue_position_.compare_exchange_weak(
+              position,
+              position + 1,
+              std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (sequence < position) {
+      // The slot still holds an entry from the previous lap: the queue is
+      // full.
+      const int64 dropped_items_count = ++dropped_items_count_;
+      LOG_EVERY_N(WARNING, 100)
+          << "Dynamic log queue is full, log entry discarded, "
+             "total dropped: " << dropped_items_count;
+      return false;
+    } else {
+      // Another producer claimed the slot first.
+      position = enqueue_position_.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->entry = std::move(entry);
+  slot->sequence.store(position + 1, std::memory_order_release);
+
+  // The consumer drains the queue until it's empty, so it only needs to be
+  // woken up when the first entry is enqueued.
+  if (size_.fetch_add(1) == 0) {
+    on_item_enqueued_.Fire();
+  }
+
+  return true;
+}
+
+
+std::unique_ptr<DynamicLogEntry> DynamicLogQueue::Pop() {
+  uint64 position = dequeue_position_.load(std::memory_order_relaxed);
+  Slot* slot = nullptr;
+  while (true) {
+    slot = &slots_[position % kMaxDynamicLogQueueSize];
+    const uint64 sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence == position + 1) {
+      // The slot has an entry. Try to claim it.
+      if (dequeue_position_.compare_exchange_weak(
+              position,
+              position + 1,
+              std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (sequence < position + 1) {
+      if (enqueue_position_.load(std::memory_order_relaxed) == position) {
+        // The queue is empty.
+        return nullptr;
+      }
+
+      // The producer claimed the slot, but hasn't finished filling it yet.
+      // Wait for it rather than returning nullptr: the producer only fires
+      // the event if the queue was empty, so if any other entry was
+      // enqueued in the meantime, the consumer would never be woken up to
+      // pop this one. The producer is only a few instructions away from
+      // publishing the slot.
+      std::this_thread::yield();
+      position = dequeue_position_.load(std::memory_order_relaxed);
+    } else {
+      // Another consumer claimed the slot first.
+      position = dequeue_position_.load(std::memory_order_relaxed);
+    }
+  }
+
+  std::unique_ptr<DynamicLogEntry> entry = std::move(slot->entry);
+  slot->sequence.store(
+      position + kMaxDynamicLogQueueSize,
+      std::memory_order_release);
+
+  size_.fetch_sub(1);
+
+  return entry;
+}
+
+
+bool DynamicLogQueue::WriteBatch() {
+  std::vector<std::unique_ptr<DynamicLogEntry>> entries;
+  while (entries.size() < kMaxDynamicLogBatchSize) {
+    std::unique_ptr<DynamicLogEntry> entry = Pop();
+    if (entry == nullptr) {
+      break;
+    }
+
+    entries.push_back(std::move(entry));
+  }
+
+  if (entries.empty()) {
+    return false;
+  }
+
+  Stopwatch stopwatch;
+
+  // All the entries normally go to the same logger. Entries of a logger
+  // that outlived its debugger are written in a separate batch.
+  std::vector<DynamicLogRecord> records;
+  records.reserve(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const DynamicLogEntry& entry = *entries[i];
+    records.push_back(DynamicLogRecord {
+      entry.level,
+      entry.source_location.get(),
+      entry.collector.Format(*entry.log_message_template)
+    });
+
+    if (entry.message_size != nullptr) {
+      entry.message_size->store(
+          records.back().message.size(),
+          std::memory_order_relaxed);
+    }
+
+    if ((i + 1 == entries.size()) || (entries[i + 1]->logger != entry.logger)) {
+      entry.logger->LogBatch(records);
+      records.clear();
+    }
+  }
+
+  // Report the average per entry to keep the statistic comparable to the
+  // synchronous dynamic log writes.
+  statDynamicLogWriteTime->add(stopwatch.GetElapsedMicros() / entries.size());
+
+  return true;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,170 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_DYNAMIC_LOG_QUEUE_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_DYNAMIC_LOG_QUEUE_H_
+
+#include <atomic>
+#include <memory>
+#include "common.h"
+#include "log_data_collector.h"
+#include "message_template.h"
+#include "model.h"
+#include "observable.h"
+
+namespace devtools {
+namespace cdbg {
+
+class DynamicLogger;
+class ResolvedSourceLocation;
+
+// Maximum number of dynamic log entries waiting to be written. Log points
+// hit faster than the application logger can keep up with are dropped.
+constexpr int kMaxDynamicLogQueueSize = 256;
+
+// Dynamic log entry with the raw values captured at a log point hit.
+struct DynamicLogEntry {
+  // Logger to write the entry to. The logger is kept alive until all the
+  // entries are written, even if the debugger gets detached in the meantime.
+  std::shared_ptr<DynamicLogger> logger;
+
+  // Log level of the log point.
+  BreakpointModel::LogLevel level;
+
+  // Location of the log point.
+  std::shared_ptr<ResolvedSourceLocation> source_location;
+
+  // Compiled log message format of the log point.
+  std::shared_ptr<const MessageTemplate> log_message_template;
+
+  // Values of the watched expressions.
+  LogDataCollector collector;
+
+  // Receives the size of the formatted message (see
+  // "JvmBreakpoint::log_message_size_").
+  std::shared_ptr<std::atomic<int64>> message_size;
+};
+
+// Bounded queue of dynamic log entries captured on application threads and
+// written to the application log by a worker thread. Building the message
+// string and calling into the application logger (which typically does I/O
+// and takes locks) are the expensive parts of a log point hit. Deferring them
+// keeps log points on request paths cheap.
+//
+// The queue is a fixed size ring buffer, where each slot has its own
+// sequence number. Producers and consumers claim slots with CAS on the
+// enqueue and dequeue positions, so neither "Enqueue" nor "Pop" ever take
+// a lock. The class is thread safe.
+class DynamicLogQueue {
+ public:
+  // Event fired when a new entry is enqueued into an empty queue. The
+  // consumer is expected to call "WriteBatch" until the queue is empty. This
+  // event is fired in the same thread that enqueued the entry.
+  typedef Observable<> OnItemEnqueued;
+
+  DynamicLogQueue();
+  ~DynamicLogQueue();
+
+  // Removes everything from the queue without writing it out.
+  void RemoveAll();
+
+  // Appends the entry to the end of the queue. Returns false if the queue is
+  // full, in which case the entry is discarded.
+  bool Enqueue(std::unique_ptr<DynamicLogEntry> entry);
+
+  // Checks whether the queue has no free slots left. Log points should not
+  // bother collecting the data if the entry would be discarded anyway.
+  bool IsFull() const {
+    return enqueue_position_.load(std::memory_order_relaxed) -
+           dequeue_position_.load(std::memory_order_relaxed) >=
+           kMaxDynamicLogQueueSize;
+  }
+
+  // Pops up to "kMaxDynamicLogBatchSize" entries from the queue, formats
+  // their log messages and writes them to the logger as a batch. Returns
+  // false if the queue is empty.
+  bool WriteBatch();
+
+  // Sets whether there is a thread that drains the queue. Entries are only
+  // expected to be enqueued while the consumer is active. Otherwise log
+  // points should write the entry synchronously.
+  void SetConsumerActive(bool is_active) { is_consumer_active_ = is_active; }
+
+  // Returns true if there is a thread that drains the queue.
+  bool IsConsumerActive() const { return is_consumer_active_; }
+
+  // Gets the number of entries discarded because the queue was full.
+  int64 GetDroppedItemsCount() const { return dropped_items_count_; }
+
+  // Subscribes to receive OnItemEnqueued notifications.
+  OnItemEnqueued::Cookie SubscribeOnItemEnqueuedEvents(
+      OnItemEnqueued::Callback fn) {
+    return on_item_enqueued_.Subscribe(fn);
+  }
+
+  // Unsubscribes from OnItemEnqueued notifications.
+  void UnsubscribeOnItemEnqueuedEvents(OnItemEnqueued::Cookie cookie) {
+    on_item_enqueued_.Unsubscribe(std::move(cookie));
+  }
+
+ private:
+  // Single slot in the ring buffer.
+  struct Slot {
+    // Equals to the position of the slot when it's free for the producer
+    // to fill and to position + 1 when "entry" is ready to be popped.
+    std::atomic<uint64> sequence;
+
+    // Entry stored in the slot.
+    std::unique_ptr<DynamicLogEntry> entry;
+  };
+
+  // Removes the first entry from the queue. Returns nullptr if the queue is
+  // empty. If the first slot was claimed by a producer that hasn't filled it
+  // yet, waits for the producer to finish.
+  std::unique_ptr<DynamicLogEntry> Pop();
+
+ private:
+  // Ring buffer of the queued entries.
+  Slot slots_[kMaxDynamicLogQueueSize];
+
+  // Position of the next slot to fill.
+  std::atomic<uint64> enqueue_position_ { 0 };
+
+  // Position of the next slot to pop.
+  std::atomic<uint64> dequeue_position_ { 0 };
+
+  // Approximate number of entries in the queue (it is updated after the
+  // entry is published or popped, so it may briefly go negative). Only used
+  // to decide when to fire "on_item_enqueued_".
+  std::atomic<int> size_ { 0 };
+
+  // Number of entries discarded because the queue was full.
+  std::atomic<int64> dropped_items_count_ { 0 };
+
+  // Set while there is a thread draining the queue.
+  std::atomic<bool> is_consumer_active_ { false };
+
+  // Allows other objects to receive synchronous notifications when the
+  // queue is no longer empty.
+  OnItemEnqueued on_item_enqueued_;
+
+  DISALLOW_COPY_AND_ASSIGN(DynamicLogQueue);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_DYNAMIC_LOG_QUEUE_H_
@@ -17,6 +17,7 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_DYNAMIC_LOGGER_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_DYNAMIC_LOGGER_H_
 
+#include <vector>
 #include "common.h"
 #include "model.h"
 
@@ -25,6 +26,19 @@ namespace cdbg {
 
 class ResolvedSourceLocation;
 
+// Maximum number of dynamic log records written in a single batch.
+constexpr int kMaxDynamicLogBatchSize = 64;
+
+// Dynamic log entry with a formatted message.
+struct DynamicLogRecord {
+  BreakpointModel::LogLevel level;
+
+  // Location of the log point. Not owned by this structure.
+  const ResolvedSourceLocation* source_location;
+
+  string message;
+};
+
 // Writes dynamic log entries to application log.
 class DynamicLogger {
  public:
@@ -39,6 +53,15 @@ class DynamicLogger {
       BreakpointModel::LogLevel level,
       const ResolvedSourceLocation& source_location,
       const string& message) = 0;
+
+  // Writes multiple log entries to application log in the specified order.
+  // Implementations may amortize the cost of reaching the application logger
+  // across the batch. Ignores any failures.
+  virtual void LogBatch(const std::vector<DynamicLogRecord>& records) {
+    for (const DynamicLogRecord& record : records) {
+      Log(record.level, *record.source_location, record.message);
+    }
+  }
 };
 
 }  // namespace cdbg
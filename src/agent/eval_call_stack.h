@@ -17,6 +17,8 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_EVAL_CALL_STACK_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_EVAL_CALL_STACK_H_
 
+#include <memory>
+#include <vector>
 #include "common.h"
 
 namespace devtools {
@@ -29,8 +31,9 @@ namespace cdbg {
 // This class is thread safe.
 class EvalCallStack {
  public:
-  // Formatted version of a single call stack frame.
-  struct FrameInfo {
+  // Names of the method executing code at a call frame. Shared by all the
+  // call frames in the method, so that the strings are only stored once.
+  struct MethodInfo {
     // Signature of the parent class.
     string class_signature;
 
@@ -43,6 +46,12 @@ class EvalCallStack {
     // Name of the source code file or empty string if the Java class was
     // compiled without source debugging information.
     string source_file_name;
+  };
+
+  // Formatted version of a single call stack frame. Immutable.
+  struct FrameInfo {
+    // Method executing code at the call frame.
+    std::shared_ptr<const MethodInfo> method;
 
     // Line number of the statement in the call frame or -1 if the Java class
     // was compiled without line number debugging information.
@@ -52,39 +61,47 @@ class EvalCallStack {
   // Raw version of a single call stack frame. The purpose of the split between
   // "FrameInfo" and "JvmFrame" is to separate data collection from data
   // formatting. "JvmFrame" contains the necessary information to read local
-  // variables and points to "FrameInfo" through "frame_info_key" member.
+  // variables and points to "FrameInfo" through "frame_info" member.
   // "JvmFrame" can only be used within the scope of JVMTI callback and should
   // be discarded immediately thereafter. The formatting of the protocol message
   // to the Hub service, on the other hand, is deferred to a worker thread that
   // only uses data in "FrameInfo" structure.
   struct JvmFrame {
-    // Code location at the current stack frame. If not available (for example
-    // for injected frames), "code_location.method" will be nullptr.
+    // Code location at the current stack frame.
     jvmtiFrameInfo code_location;
 
-    // Reference to "FrameInfo" structure. The data is obtained through
-    // "ResolveCallFrameKey" method.
-    int frame_info_key;
+    // Decoded call frame. The caller may keep the reference as long as it
+    // needs to, even if the cache entry gets evicted or JVM unloads the
+    // method or the class.
+    std::shared_ptr<const FrameInfo> frame_info;
+  };
+
+  // Decoded call stack of one of the threads read by "ReadAllThreads".
+  struct ThreadStack {
+    // Name of the thread.
+    string thread_name;
+
+    // JVMTI state of the thread (combination of "JVMTI_THREAD_STATE_*").
+    jint state;
+
+    // Decoded call frames starting from the top one.
+    std::vector<std::shared_ptr<const FrameInfo>> frames;
   };
 
  public:
   virtual ~EvalCallStack() { }
 
   // Reads call stack of a particular thread (typically that would be the
-  // thread that hit a breakpoint). The function returns list of call frame
-  // keys, which can be resolved to a more detailed information through
-  // "ResolveCallFrameKey" function. The call frame key stays valid even if
-  // the Java method has been unloaded.
+  // thread that hit a breakpoint).
   virtual void Read(jthread thread, std::vector<JvmFrame>* result) = 0;
 
-  // Resolves call frame key returned in "Read" function. The data is stored
-  // indefinitely and the call frame key will remain valid even if JVM unloads
-  // the method or the class.
-  virtual const FrameInfo& ResolveCallFrameKey(int key) const = 0;
-
-  // Associates frame key with the specified frame. This method is used to
-  // inject artificial stack frames.
-  virtual int InjectFrame(const FrameInfo& frame_info) = 0;
+  // Reads call stacks of up to "max_threads" live threads whose names start
+  // with "thread_name_prefix" (all threads if empty). The stacks are read
+  // with a single JVMTI call, so they are consistent with each other.
+  virtual void ReadAllThreads(
+      int max_threads,
+      const string& thread_name_prefix,
+      std::vector<ThreadStack>* result) = 0;
 
   // Indicates that the specified Java method is no longer valid.
   virtual void JvmtiOnCompiledMethodUnload(jmethodID method) = 0;
@@ -28,6 +28,7 @@ namespace cdbg {
 
 class ReadersFactory;
 class FormatMessageModel;
+class ExpressionProgramBuilder;
 struct EvaluationContext;
 
 // Interface representing compiled expression or subexpression.
@@ -60,6 +61,18 @@ class ExpressionEvaluator {
   // without a value.
   virtual Nullable<jvalue> GetStaticValue() const = 0;
 
+  // Returns true if the expression or any of its subexpressions calls Java
+  // methods. Expressions that don't call methods can be evaluated without
+  // "EvaluationContext::method_caller". Only valid after "Compile" succeeded.
+  virtual bool HasMethodCalls() const = 0;
+
+  // Emits the expression into "ExpressionProgram". Subexpressions that the
+  // program can't represent natively are emitted as leaves evaluated through
+  // "Evaluate". Returns the register holding the value of the expression or
+  // "ExpressionProgramBuilder::kNoRegister" if the expression can't be
+  // converted. Only valid after "Compile" succeeded.
+  virtual int Lower(ExpressionProgramBuilder* builder) const = 0;
+
   // Evaluates the current value of the expression. Returns error if expression
   // computation fails. Failure can happen due to null references, if underlying
   // JNI calls fail or due to some code bug runtime types don't match types
@@ -69,6 +82,28 @@ class ExpressionEvaluator {
 };
 
 
+// Reads the value of "evaluator" known at compile time (see
+// "GetStaticValue"). Returns false if the value is not known or if the
+// expression is not of a primitive type. Used to fold constant subexpressions
+// after "Compile".
+inline bool GetStaticPrimitiveValue(
+    const ExpressionEvaluator& evaluator,
+    JVariant* value) {
+  const JType type = evaluator.GetStaticType().type;
+  if ((type == JType::Void) || (type == JType::Object)) {
+    return false;
+  }
+
+  Nullable<jvalue> static_value = evaluator.GetStaticValue();
+  if (!static_value.has_value()) {
+    return false;
+  }
+
+  *value = JVariant::PrimitiveFromJValue(type, static_value.value());
+  return true;
+}
+
+
 }  // namespace cdbg
 }  // namespace devtools
 
@@ -0,0 +1,581 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "expression_program.h"
+
+#include <cmath>
+#include <limits>
+#include "expression_evaluator.h"
+#include "messages.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Checks whether "type" is a Java primitive type that can be stored in a
+// register.
+static bool IsPrimitiveType(JType type) {
+  return (type != JType::Void) && (type != JType::Object);
+}
+
+
+// Reads the value of type "type" from a register and casts it to "T".
+template <typename T>
+static T ReadAs(const jvalue& value, JType type) {
+  switch (type) {
+    case JType::Byte:
+      return static_cast<T>(value.b);
+
+    case JType::Char:
+      return static_cast<T>(value.c);
+
+    case JType::Short:
+      return static_cast<T>(value.s);
+
+    case JType::Int:
+      return static_cast<T>(value.i);
+
+    case JType::Long:
+      return static_cast<T>(value.j);
+
+    case JType::Float:
+      return static_cast<T>(value.f);
+
+    case JType::Double:
+      return static_cast<T>(value.d);
+
+    default:
+      DCHECK(false);  // Only numeric types are expected here.
+      return T();
+  }
+}
+
+
+// Implements "CONVERT" instruction (same semantics as "NumericCastEvaluator").
+static void Convert(
+    JType source_type,
+    JType target_type,
+    const jvalue& source,
+    jvalue* target) {
+  switch (target_type) {
+    case JType::Byte:
+      target->b = ReadAs<jbyte>(source, source_type);
+      break;
+
+    case JType::Char:
+      target->c = ReadAs<jchar>(source, source_type);
+      break;
+
+    case JType::Short:
+      target->s = ReadAs<jshort>(source, source_type);
+      break;
+
+    case JType::Int:
+      target->i = ReadAs<jint>(source, source_type);
+      break;
+
+    case JType::Long:
+      target->j = ReadAs<jlong>(source, source_type);
+      break;
+
+    case JType::Float:
+      target->f = ReadAs<jfloat>(source, source_type);
+      break;
+
+    case JType::Double:
+      target->d = ReadAs<jdouble>(source, source_type);
+      break;
+
+    default:
+      DCHECK(false);  // Only numeric types are expected here.
+      break;
+  }
+}
+
+
+// Wraps the value of the register into "JVariant".
+static JVariant RegisterToVariant(JType type, const jvalue& value) {
+  switch (type) {
+    case JType::Boolean:
+      return JVariant::Boolean(value.z);
+
+    case JType::Byte:
+      return JVariant::Byte(value.b);
+
+    case JType::Char:
+      return JVariant::Char(value.c);
+
+    case JType::Short:
+      return JVariant::Short(value.s);
+
+    case JType::Int:
+      return JVariant::Int(value.i);
+
+    case JType::Long:
+      return JVariant::Long(value.j);
+
+    case JType::Float:
+      return JVariant::Float(value.f);
+
+    case JType::Double:
+      return JVariant::Double(value.d);
+
+    default:
+      DCHECK(false);  // Programs never produce other types.
+      return JVariant();
+  }
+}
+
+
+bool ExpressionProgram::SelectTypedOpcode(
+    Opcode base,
+    JType type,
+    Opcode* opcode) {
+  int offset = 0;
+  switch (type) {
+    case JType::Int:
+      offset = 0;
+      break;
+
+    case JType::Long:
+      offset = 1;
+      break;
+
+    case JType::Float:
+      offset = 2;
+      break;
+
+    case JType::Double:
+      offset = 3;
+      break;
+
+    default:
+      return false;
+  }
+
+  const bool is_numeric =
+      (base >= Opcode::ADD_INT) && (base <= Opcode::GE_INT) &&
+      (((static_cast<int>(base) - static_cast<int>(Opcode::ADD_INT)) % 4) == 0);
+  const bool is_integral =
+      (base >= Opcode::AND_INT) && (base <= Opcode::USHR_INT) &&
+      (((static_cast<int>(base) - static_cast<int>(Opcode::AND_INT)) % 2) == 0);
+
+  if (!is_numeric && !(is_integral && (offset < 2))) {
+    return false;
+  }
+
+  *opcode = static_cast<Opcode>(static_cast<int>(base) + offset);
+  return true;
+}
+
+
+std::unique_ptr<ExpressionProgram> ExpressionProgram::Build(
+    const ExpressionEvaluator& root) {
+  ExpressionProgramBuilder builder;
+  return builder.Build(root);
+}
+
+
+ErrorOr<JVariant> ExpressionProgram::Execute(
+    const EvaluationContext& evaluation_context) const {
+  jvalue registers[kMaxRegisters];
+
+  const int instructions_count = instructions_.size();
+  int pc = 0;
+  while (pc < instructions_count) {
+    const Instruction& instruction = instructions_[pc++];
+    jvalue& dst = registers[instruction.dst];
+    const jvalue& a = registers[instruction.src1];
+    const jvalue& b = registers[instruction.src2];
+
+    switch (instruction.opcode) {
+      case Opcode::LOAD_CONSTANT:
+        dst = instruction.constant;
+        break;
+
+      case Opcode::EVALUATE_LEAF: {
+        ErrorOr<JVariant> leaf_result =
+            instruction.leaf->Evaluate(evaluation_context);
+        if (leaf_result.is_error()) {
+          return leaf_result;
+        }
+
+        if (leaf_result.value().type() != instruction.target_type) {
+          return INTERNAL_ERROR_MESSAGE;
+        }
+
+        dst = leaf_result.value().get_jvalue();
+        break;
+      }
+
+      case Opcode::MOVE:
+        dst = a;
+        break;
+
+      case Opcode::JUMP:
+        pc = instruction.target;
+        break;
+
+      case Opcode::JUMP_IF_FALSE:
+        if (!a.z) {
+          pc = instruction.target;
+        }
+        break;
+
+      case Opcode::CONVERT:
+        Convert(instruction.source_type, instruction.target_type, a, &dst);
+        break;
+
+      case Opcode::BOOLEAN_NOT:
+        dst.z = !a.z;
+        break;
+
+      case Opcode::BOOLEAN_AND:
+        dst.z = a.z && b.z;
+        break;
+
+      case Opcode::BOOLEAN_OR:
+        dst.z = a.z || b.z;
+        break;
+
+      case Opcode::BOOLEAN_EQ:
+        dst.z = (a.z == b.z);
+        break;
+
+      case Opcode::BOOLEAN_NE:
+        dst.z = (a.z != b.z);
+        break;
+
+      case Opcode::ADD_INT: dst.i = a.i + b.i; break;
+      case Opcode::ADD_LONG: dst.j = a.j + b.j; break;
+      case Opcode::ADD_FLOAT: dst.f = a.f + b.f; break;
+      case Opcode::ADD_DOUBLE: dst.d = a.d + b.d; break;
+
+      case Opcode::SUB_INT: dst.i = a.i - b.i; break;
+      case Opcode::SUB_LONG: dst.j = a.j - b.j; break;
+      case Opcode::SUB_FLOAT: dst.f = a.f - b.f; break;
+      case Opcode::SUB_DOUBLE: dst.d = a.d - b.d; break;
+
+      case Opcode::MUL_INT: dst.i = a.i * b.i; break;
+      case Opcode::MUL_LONG: dst.j = a.j * b.j; break;
+      case Opcode::MUL_FLOAT: dst.f = a.f * b.f; break;
+      case Opcode::MUL_DOUBLE: dst.d = a.d * b.d; break;
+
+      case Opcode::DIV_INT:
+      case Opcode::REM_INT:
+        if (b.i == 0) {
+          return FormatMessageModel { DivisionByZero };
+        }
+
+        if ((a.i == std::numeric_limits<jint>::min()) && (b.i == -1)) {
+          return FormatMessageModel { IntegerDivisionOverflow };
+        }
+
+        if (instruction.opcode == Opcode::DIV_INT) {
+          dst.i = a.i / b.i;
+        } else {
+          dst.i = a.i % b.i;
+        }
+        break;
+
+      case Opcode::DIV_LONG:
+      case Opcode::REM_LONG:
+        if (b.j == 0) {
+          return FormatMessageModel { DivisionByZero };
+        }
+
+        if ((a.j == std::numeric_limits<jlong>::min()) && (b.j == -1)) {
+          return FormatMessageModel { IntegerDivisionOverflow };
+        }
+
+        if (instruction.opcode == Opcode::DIV_LONG) {
+          dst.j = a.j / b.j;
+        } else {
+          dst.j = a.j % b.j;
+        }
+        break;
+
+      case Opcode::DIV_FLOAT: dst.f = a.f / b.f; break;
+      case Opcode::DIV_DOUBLE: dst.d = a.d / b.d; break;
+
+      case Opcode::REM_FLOAT:
+        dst.f = std::fmod(static_cast<float>(a.f), static_cast<float>(b.f));
+        break;
+
+      case Opcode::REM_DOUBLE:
+        dst.d = std::fmod(static_cast<double>(a.d), static_cast<double>(b.d));
+        break;
+
+      case Opcode::NEG_INT: dst.i = -a.i; break;
+      case Opcode::NEG_LONG: dst.j = -a.j; break;
+      case Opcode::NEG_FLOAT: dst.f = -a.f; break;
+      case Opcode::NEG_DOUBLE: dst.d = -a.d; break;
+
+      case Opcode::EQ_INT: dst.z = (a.i == b.i); break;
+      case Opcode::EQ_LONG: dst.z = (a.j == b.j); break;
+      case Opcode::EQ_FLOAT: dst.z = (a.f == b.f); break;
+      case Opcode::EQ_DOUBLE: dst.z = (a.d == b.d); break;
+
+      case Opcode::NE_INT: dst.z = (a.i != b.i); break;
+      case Opcode::NE_LONG: dst.z = (a.j != b.j); break;
+      case Opcode::NE_FLOAT: dst.z = (a.f != b.f); break;
+      case Opcode::NE_DOUBLE: dst.z = (a.d != b.d); break;
+
+      case Opcode::LT_INT: dst.z = (a.i < b.i); break;
+      case Opcode::LT_LONG: dst.z = (a.j < b.j); break;
+      case Opcode::LT_FLOAT: dst.z = (a.f < b.f); break;
+      case Opcode::LT_DOUBLE: dst.z = (a.d < b.d); break;
+
+      case Opcode::LE_INT: dst.z = (a.i <= b.i); break;
+      case Opcode::LE_LONG: dst.z = (a.j <= b.j); break;
+      case Opcode::LE_FLOAT: dst.z = (a.f <= b.f); break;
+      case Opcode::LE_DOUBLE: dst.z = (a.d <= b.d); break;
+
+      case Opcode::GT_INT: dst.z = (a.i > b.i); break;
+      case Opcode::GT_LONG: dst.z = (a.j > b.j); break;
+      case Opcode::GT_FLOAT: dst.z = (a.f > b.f); break;
+      case Opcode::GT_DOUBLE: dst.z = (a.d > b.d); break;
+
+      case Opcode::GE_INT: dst.z = (a.i >= b.i); break;
+      case Opcode::GE_LONG: dst.z = (a.j >= b.j); break;
+      case Opcode::GE_FLOAT: dst.z = (a.f >= b.f); break;
+      case Opcode::GE_DOUBLE: dst.z = (a.d >= b.d); break;
+
+      case Opcode::AND_INT: dst.i = a.i & b.i; break;
+      case Opcode::AND_LONG: dst.j = a.j & b.j; break;
+
+      case Opcode::OR_INT: dst.i = a.i | b.i; break;
+      case Opcode::OR_LONG: dst.j = a.j | b.j; break;
+
+      case Opcode::XOR_INT: dst.i = a.i ^ b.i; break;
+      case Opcode::XOR_LONG: dst.j = a.j ^ b.j; break;
+
+      case Opcode::COMPLEMENT_INT: dst.i = ~a.i; break;
+      case Opcode::COMPLEMENT_LONG: dst.j = ~a.j; break;
+
+      // Shift distance is masked as per Java Language Specification
+      // section 15.19.
+      case Opcode::SHL_INT: dst.i = a.i << (b.i & 0x1f); break;
+      case Opcode::SHL_LONG: dst.j = a.j << (b.i & 0x3f); break;
+
+      case Opcode::SHR_INT: dst.i = a.i >> (b.i & 0x1f); break;
+      case Opcode::SHR_LONG: dst.j = a.j >> (b.i & 0x3f); break;
+
+      case Opcode::USHR_INT:
+        dst.i = static_cast<uint32>(a.i) >> (b.i & 0x1f);
+        break;
+
+      case Opcode::USHR_LONG:
+        dst.j = static_cast<uint64>(a.j) >> (b.i & 0x3f);
+        break;
+    }
+  }
+
+  return RegisterToVariant(result_type_, registers[result_register_]);
+}
+
+
+ExpressionProgramBuilder::ExpressionProgramBuilder()
+    : register_count_(0) {
+}
+
+
+std::unique_ptr<ExpressionProgram> ExpressionProgramBuilder::Build(
+    const ExpressionEvaluator& root) {
+  const JType result_type = root.GetStaticType().type;
+  if (!IsPrimitiveType(result_type)) {
+    return nullptr;
+  }
+
+  program_.reset(new ExpressionProgram);
+  register_count_ = 0;
+
+  const int result_register = root.Lower(this);
+  if (result_register == kNoRegister) {
+    program_ = nullptr;
+    return nullptr;
+  }
+
+  program_->result_register_ = result_register;
+  program_->result_type_ = result_type;
+
+  return std::move(program_);
+}
+
+
+int ExpressionProgramBuilder::AddConstant(JType type, jvalue value) {
+  if (!IsPrimitiveType(type)) {
+    return kNoRegister;
+  }
+
+  const int dst = AllocateRegister();
+  if (dst == kNoRegister) {
+    return kNoRegister;
+  }
+
+  ExpressionProgram::Instruction* instruction =
+      AddInstruction(ExpressionProgram::Opcode::LOAD_CONSTANT);
+  instruction->dst = dst;
+  instruction->constant = value;
+
+  return dst;
+}
+
+
+int ExpressionProgramBuilder::AddLeaf(const ExpressionEvaluator& leaf) {
+  const JType type = leaf.GetStaticType().type;
+  if (!IsPrimitiveType(type)) {
+    return kNoRegister;
+  }
+
+  const int dst = AllocateRegister();
+  if (dst == kNoRegister) {
+    return kNoRegister;
+  }
+
+  ExpressionProgram::Instruction* instruction =
+      AddInstruction(ExpressionProgram::Opcode::EVALUATE_LEAF);
+  instruction->dst = dst;
+  instruction->target_type = type;
+  instruction->leaf = &leaf;
+
+  return dst;
+}
+
+
+int ExpressionProgramBuilder::AddConversion(
+    JType source_type,
+    JType target_type,
+    int source) {
+  if ((source == kNoRegister) ||
+      !IsPrimitiveType(source_type) ||
+      !IsPrimitiveType(target_type) ||
+      (source_type == JType::Boolean) ||
+      (target_type == JType::Boolean)) {
+    return kNoRegister;
+  }
+
+  if (source_type == target_type) {
+    return source;
+  }
+
+  const int dst = AllocateRegister();
+  if (dst == kNoRegister) {
+    return kNoRegister;
+  }
+
+  ExpressionProgram::Instruction* instruction =
+      AddInstruction(ExpressionProgram::Opcode::CONVERT);
+  instruction->dst = dst;
+  instruction->src1 = source;
+  instruction->source_type = source_type;
+  instruction->target_type = target_type;
+
+  return dst;
+}
+
+
+int ExpressionProgramBuilder::AddUnary(
+    ExpressionProgram::Opcode opcode,
+    int source) {
+  if (source == kNoRegister) {
+    return kNoRegister;
+  }
+
+  const int dst = AllocateRegister();
+  if (dst == kNoRegister) {
+    return kNoRegister;
+  }
+
+  ExpressionProgram::Instruction* instruction = AddInstruction(opcode);
+  instruction->dst = dst;
+  instruction->src1 = source;
+
+  return dst;
+}
+
+
+int ExpressionProgramBuilder::AddBinary(
+    ExpressionProgram::Opcode opcode,
+    int source1,
+    int source2) {
+  if ((source1 == kNoRegister) || (source2 == kNoRegister)) {
+    return kNoRegister;
+  }
+
+  const int dst = AllocateRegister();
+  if (dst == kNoRegister) {
+    return kNoRegister;
+  }
+
+  ExpressionProgram::Instruction* instruction = AddInstruction(opcode);
+  instruction->dst = dst;
+  instruction->src1 = source1;
+  instruction->src2 = source2;
+
+  return dst;
+}
+
+
+int ExpressionProgramBuilder::AllocateRegister() {
+  if (register_count_ >= ExpressionProgram::kMaxRegisters) {
+    return kNoRegister;
+  }
+
+  return register_count_++;
+}
+
+
+void ExpressionProgramBuilder::AddMove(int target, int source) {
+  DCHECK_NE(target, kNoRegister);
+  DCHECK_NE(source, kNoRegister);
+
+  ExpressionProgram::Instruction* instruction =
+      AddInstruction(ExpressionProgram::Opcode::MOVE);
+  instruction->dst = target;
+  instruction->src1 = source;
+}
+
+
+int ExpressionProgramBuilder::AddJump(int condition) {
+  ExpressionProgram::Instruction* instruction = AddInstruction(
+      (condition == kNoRegister)
+          ? ExpressionProgram::Opcode::JUMP
+          : ExpressionProgram::Opcode::JUMP_IF_FALSE);
+  if (condition != kNoRegister) {
+    instruction->src1 = condition;
+  }
+
+  return program_->instructions_.size() - 1;
+}
+
+
+void ExpressionProgramBuilder::BindJump(int jump) {
+  program_->instructions_[jump].target = program_->instructions_.size();
+}
+
+
+ExpressionProgram::Instruction* ExpressionProgramBuilder::AddInstruction(
+    ExpressionProgram::Opcode opcode) {
+  ExpressionProgram::Instruction instruction = ExpressionProgram::Instruction();
+  instruction.opcode = opcode;
+
+  program_->instructions_.push_back(instruction);
+  return &program_->instructions_.back();
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
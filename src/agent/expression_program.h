@@ -0,0 +1,222 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_EXPRESSION_PROGRAM_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_EXPRESSION_PROGRAM_H_
+
+#include <memory>
+#include <vector>
+#include "common.h"
+#include "jvariant.h"
+#include "model_util.h"
+
+namespace devtools {
+namespace cdbg {
+
+class ExpressionEvaluator;
+struct EvaluationContext;
+
+// Compiled expression flattened into a linear sequence of instructions over
+// a fixed register file. This is an alternative backend to the tree of
+// "ExpressionEvaluator" instances. The tree evaluator remains the reference
+// implementation: the program computes exactly the same values and errors.
+//
+// The program only covers the primitive "skeleton" of the expression
+// (constants, arithmetic, comparisons, boolean logic, numeric casts and the
+// conditional operator). Everything else (local variables, fields, arrays,
+// method calls, strings and object comparisons) becomes a leaf instruction
+// that falls back to "ExpressionEvaluator::Evaluate" of the subtree.
+//
+// Execution doesn't allocate memory: registers live on the stack.
+class ExpressionProgram {
+ public:
+  // Maximum number of registers a program can use. Expressions that need
+  // more registers are not converted to a program.
+  static constexpr int kMaxRegisters = 32;
+
+  enum class Opcode : uint8 {
+    // dst = constant
+    LOAD_CONSTANT,
+
+    // dst = leaf->Evaluate(...)
+    EVALUATE_LEAF,
+
+    // dst = src1
+    MOVE,
+
+    // Continue at "target".
+    JUMP,
+
+    // Continue at "target" if src1 (boolean) is false.
+    JUMP_IF_FALSE,
+
+    // dst = (target_type) src1 where src1 is of "source_type".
+    CONVERT,
+
+    // Operations on booleans.
+    BOOLEAN_NOT,
+    BOOLEAN_AND,
+    BOOLEAN_OR,
+    BOOLEAN_EQ,
+    BOOLEAN_NE,
+
+    // Numeric operations. Each operation has four variants in this order:
+    // int, long, float, double (see "SelectTypedOpcode").
+    ADD_INT, ADD_LONG, ADD_FLOAT, ADD_DOUBLE,
+    SUB_INT, SUB_LONG, SUB_FLOAT, SUB_DOUBLE,
+    MUL_INT, MUL_LONG, MUL_FLOAT, MUL_DOUBLE,
+    DIV_INT, DIV_LONG, DIV_FLOAT, DIV_DOUBLE,
+    REM_INT, REM_LONG, REM_FLOAT, REM_DOUBLE,
+    NEG_INT, NEG_LONG, NEG_FLOAT, NEG_DOUBLE,
+    EQ_INT, EQ_LONG, EQ_FLOAT, EQ_DOUBLE,
+    NE_INT, NE_LONG, NE_FLOAT, NE_DOUBLE,
+    LT_INT, LT_LONG, LT_FLOAT, LT_DOUBLE,
+    LE_INT, LE_LONG, LE_FLOAT, LE_DOUBLE,
+    GT_INT, GT_LONG, GT_FLOAT, GT_DOUBLE,
+    GE_INT, GE_LONG, GE_FLOAT, GE_DOUBLE,
+
+    // Integral operations. Each operation has two variants in this order:
+    // int, long. The shift distance (src2) is always int.
+    AND_INT, AND_LONG,
+    OR_INT, OR_LONG,
+    XOR_INT, XOR_LONG,
+    COMPLEMENT_INT, COMPLEMENT_LONG,
+    SHL_INT, SHL_LONG,
+    SHR_INT, SHR_LONG,
+    USHR_INT, USHR_LONG
+  };
+
+  // Single instruction of the program.
+  struct Instruction {
+    Opcode opcode;
+
+    // Register indexes of the result and of the operands.
+    uint8 dst;
+    uint8 src1;
+    uint8 src2;
+
+    // Types of the conversion (only used by "CONVERT").
+    JType source_type;
+    JType target_type;
+
+    union {
+      // Value loaded by "LOAD_CONSTANT".
+      jvalue constant;
+
+      // Subtree evaluated by "EVALUATE_LEAF". Not owned by this class.
+      const ExpressionEvaluator* leaf;
+
+      // Instruction index to continue at for "JUMP" and "JUMP_IF_FALSE".
+      int32 target;
+    };
+  };
+
+  // Picks the variant of a typed operation. "base" is the int variant of the
+  // operation (e.g. "ADD_INT"). Returns false if the operation is not
+  // applicable to "type".
+  static bool SelectTypedOpcode(Opcode base, JType type, Opcode* opcode);
+
+  // Converts the compiled expression tree rooted at "root" into a program.
+  // Returns nullptr if the expression can't be represented as a program.
+  // "root" must outlive the returned program.
+  static std::unique_ptr<ExpressionProgram> Build(
+      const ExpressionEvaluator& root);
+
+  // Runs the program. Has the same semantics as "Evaluate" of the tree the
+  // program was built from.
+  ErrorOr<JVariant> Execute(const EvaluationContext& evaluation_context) const;
+
+ private:
+  ExpressionProgram() { }
+
+  friend class ExpressionProgramBuilder;
+
+ private:
+  // Linear sequence of instructions.
+  std::vector<Instruction> instructions_;
+
+  // Register holding the value of the expression after the last instruction.
+  int result_register_ = 0;
+
+  // Type of the value in "result_register_".
+  JType result_type_ = JType::Void;
+
+  DISALLOW_COPY_AND_ASSIGN(ExpressionProgram);
+};
+
+
+// Emits instructions of "ExpressionProgram". Each evaluator lowers itself
+// through "ExpressionEvaluator::Lower" using the functions below. All the
+// functions return the register with the result or "kNoRegister" if the
+// expression can't be represented as a program.
+class ExpressionProgramBuilder {
+ public:
+  static constexpr int kNoRegister = -1;
+
+  ExpressionProgramBuilder();
+
+  // Lowers the expression rooted at "root" and returns the final program.
+  // Returns nullptr on failure.
+  std::unique_ptr<ExpressionProgram> Build(const ExpressionEvaluator& root);
+
+  // Loads a constant primitive value.
+  int AddConstant(JType type, jvalue value);
+
+  // Evaluates "leaf" through the tree evaluator. The static type of "leaf"
+  // must be primitive.
+  int AddLeaf(const ExpressionEvaluator& leaf);
+
+  // Converts the value in "source" between two primitive numeric types.
+  int AddConversion(JType source_type, JType target_type, int source);
+
+  // Applies unary operation.
+  int AddUnary(ExpressionProgram::Opcode opcode, int source);
+
+  // Applies binary operation.
+  int AddBinary(ExpressionProgram::Opcode opcode, int source1, int source2);
+
+  // Reserves a register to be filled later through "AddMove".
+  int AllocateRegister();
+
+  // Copies "source" register into "target" register.
+  void AddMove(int target, int source);
+
+  // Emits a jump (conditional if "condition" is not "kNoRegister"). Returns
+  // the index of the jump instruction to be passed to "BindJump".
+  int AddJump(int condition);
+
+  // Makes the jump emitted by "AddJump" continue at the next instruction.
+  void BindJump(int jump);
+
+ private:
+  // Appends a new instruction to the program.
+  ExpressionProgram::Instruction* AddInstruction(
+      ExpressionProgram::Opcode opcode);
+
+ private:
+  // Program being built.
+  std::unique_ptr<ExpressionProgram> program_;
+
+  // Number of registers allocated so far.
+  int register_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(ExpressionProgramBuilder);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_EXPRESSION_PROGRAM_H_
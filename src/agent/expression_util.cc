@@ -16,15 +16,15 @@
 
 #include "expression_util.h"
 
+#include <iomanip>
+#include <limits>
 #include <sstream>
 #include "java_expression.h"
+#include "java_expression_parser.h"
 #include "expression_evaluator.h"
 #include "messages.h"
 #include "model_util.h"
 #include "readers_factory.h"
-#include "JavaExpressionLexer.hpp"
-#include "JavaExpressionParser.hpp"
-#include "JavaExpressionCompiler.hpp"
 
 namespace devtools {
 namespace cdbg {
@@ -40,44 +40,89 @@ static CompiledExpression EnsureDefaultErrorMessage(
   return compiled_expression;
 }
 
+
+// Prints the parsed expression tree for diagnostic logs.
+static string PrintExpressionTree(JavaExpression* expression) {
+  std::ostringstream os;
+  expression->Print(&os, false);
+  return os.str();
+}
+
+
+// Prints the method call in a form that tells apart any two calls that
+// are not identical.
+static string PrintMethodCall(MethodCallExpression* method_call) {
+  std::ostringstream os;
+  os << std::setprecision(std::numeric_limits<jdouble>::max_digits10);
+  method_call->Print(&os, false);
+  return os.str();
+}
+
+
+void SharedSubexpressions::Add(const string& string_expression) {
+  if (string_expression.empty() ||
+      (string_expression.size() > kMaxExpressionLength)) {
+    return;
+  }
+
+  JavaExpressionParser parser(string_expression);
+  if (parser.Parse() == nullptr) {
+    return;
+  }
+
+  for (MethodCallExpression* method_call : parser.method_calls()) {
+    ++counts_[PrintMethodCall(method_call)];
+  }
+}
+
+
+void SharedSubexpressions::Apply(const JavaExpressionParser& parser) {
+  for (MethodCallExpression* method_call : parser.method_calls()) {
+    const string key = PrintMethodCall(method_call);
+
+    auto it = counts_.find(key);
+    if ((it == counts_.end()) || (it->second < 2)) {
+      continue;
+    }
+
+    const int new_slot = slots_.size();
+    auto slot = slots_.insert(std::make_pair(key, new_slot)).first;
+    method_call->set_shared_slot(slot->second);
+  }
+}
+
+
 CompiledExpression CompileExpression(
     const string& string_expression,
     ReadersFactory* readers_factory) {
+  return CompileExpression(string_expression, readers_factory, nullptr);
+}
+
+
+CompiledExpression CompileExpression(
+    const string& string_expression,
+    ReadersFactory* readers_factory,
+    SharedSubexpressions* shared_subexpressions) {
   if (string_expression.size() > kMaxExpressionLength) {
     LOG(WARNING) << "Expression can't be compiled because it is too long: "
                  << string_expression.size();
     return { nullptr, { ExpressionTooLong }, string_expression };
   }
 
-  // Parse the expression.
-  std::istringstream input_stream(string_expression);
-  JavaExpressionLexer lexer(input_stream);
-  JavaExpressionParser parser(lexer);
-  parser.Init();
-
-  parser.statement();
-  if (parser.ActiveException()) {
-    parser.reportError(parser.ActiveException()->getMessage());
-  }
-
-  if (parser.num_errors() > 0) {
+  // Parse the expression into "JavaExpression" tree.
+  JavaExpressionParser parser(string_expression);
+  std::unique_ptr<JavaExpression> expression = parser.Parse();
+  if (expression == nullptr) {
     LOG(WARNING) << "Expression parsing failed" << std::endl
                  << "Input: " << string_expression << std::endl
-                 << "Parser error: " << parser.errors()[0];
-    return { nullptr, { ExpressionParserError }, string_expression };
-  }
+                 << "Error position: " << parser.error_position() << std::endl
+                 << "Error message: " << parser.error_message();
 
-  // Transform ANTLR AST into "JavaExpression" tree.
-  JavaExpressionCompiler compiler;
-  compiler.Init();
-
-  std::unique_ptr<JavaExpression> expression = compiler.Walk(parser.getAST());
-  if (expression == nullptr) {
-    LOG(WARNING) << "Tree walking on parsed expression failed" << std::endl
-                 << "Input: " << string_expression << std::endl
-                 << "AST: " << parser.getAST()->toStringTree();
+    return { nullptr, parser.error_message(), string_expression };
+  }
 
-    return { nullptr, compiler.error_message(), string_expression };
+  if (shared_subexpressions != nullptr) {
+    shared_subexpressions->Apply(parser);
   }
 
   // Compile the expression.
@@ -86,7 +131,7 @@ CompiledExpression CompileExpression(
   if (compiled_expression.evaluator == nullptr) {
     LOG(WARNING) << "Expression not supported by the evaluator" << std::endl
                  << "Input: " << string_expression << std::endl
-                 << "AST: " << parser.getAST()->toStringTree();
+                 << "AST: " << PrintExpressionTree(expression.get());
 
     return EnsureDefaultErrorMessage(std::move(compiled_expression));
   }
@@ -96,7 +141,8 @@ CompiledExpression CompileExpression(
         &compiled_expression.error_message)) {
     LOG(WARNING) << "Expression could not be compiled" << std::endl
                  << "Input: " << string_expression << std::endl
-                 << "AST: " << parser.getAST()->toStringTree() << std::endl
+                 << "AST: " << PrintExpressionTree(expression.get())
+                 << std::endl
                  << "Error message: " << compiled_expression.error_message;
     compiled_expression.evaluator = nullptr;
 
@@ -105,7 +151,7 @@ CompiledExpression CompileExpression(
 
   VLOG(1) << "Expression compiled successfully" << std::endl
           << "Input: " << string_expression << std::endl
-          << "AST: " << parser.getAST()->toStringTree();
+          << "AST: " << PrintExpressionTree(expression.get());
 
   return compiled_expression;
 }
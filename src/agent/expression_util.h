@@ -17,14 +17,17 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_EXPRESSION_UTIL_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_EXPRESSION_UTIL_H_
 
+#include <map>
 #include <memory>
 #include "common.h"
+#include "expression_program.h"
 #include "model.h"
 
 namespace devtools {
 namespace cdbg {
 
 class ExpressionEvaluator;
+class JavaExpressionParser;
 class ReadersFactory;
 
 // Some limit on expression length to prevent DoS inadvertently caused by
@@ -45,6 +48,43 @@ struct CompiledExpression {
 
   // Original expression text.
   string expression;
+
+  // Optional flat representation of "evaluator" for faster evaluation. When
+  // set, "program" computes the same result as "evaluator" (which it refers
+  // to). Null if not requested or if the expression can't be converted.
+  std::unique_ptr<ExpressionProgram> program;
+};
+
+// Finds method calls that appear more than once in a set of expressions
+// (e.g. "request.getUser().getId()" in both the condition and a watched
+// expression of a breakpoint), so that each of them is only called once per
+// breakpoint hit. Method calls are matched by their printed syntax tree.
+//
+// All the expressions have to be added before any of them is compiled.
+class SharedSubexpressions {
+ public:
+  SharedSubexpressions() { }
+
+  // Counts the method calls in "string_expression". Invalid expressions are
+  // ignored.
+  void Add(const string& string_expression);
+
+  // Marks the method calls parsed by "parser" that appear more than once
+  // across all the added expressions.
+  void Apply(const JavaExpressionParser& parser);
+
+  // Number of slots assigned to shared method calls so far. This is the size
+  // of "SharedSubexpressionValues" needed to evaluate the expressions.
+  int size() const { return slots_.size(); }
+
+ private:
+  // Number of occurrences of each method call in the added expressions.
+  std::map<string, int> counts_;
+
+  // Slots of the shared method calls that were compiled.
+  std::map<string, int> slots_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedSubexpressions);
 };
 
 // Shortcut method to tokenize, parse, tree-walk and compile the specified
@@ -56,6 +96,13 @@ CompiledExpression CompileExpression(
     const string& string_expression,
     ReadersFactory* readers_factory);
 
+// Variant of "CompileExpression" that shares the method calls identified by
+// "shared_subexpressions" with the other expressions compiled with it.
+CompiledExpression CompileExpression(
+    const string& string_expression,
+    ReadersFactory* readers_factory,
+    SharedSubexpressions* shared_subexpressions);
+
 }  // namespace cdbg
 }  // namespace devtools
 
@@ -0,0 +1,236 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "fast_clock.h"
+
+#include <time.h>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define CDBG_FAST_CLOCK_TSC
+#endif
+
+DEFINE_bool(
+    cdbg_fast_hit_clock,
+    true,
+    "measure the cost of breakpoint hits with a fast clock corrected by "
+    "sampling the thread CPU clock instead of reading the thread CPU clock "
+    "on every hit");
+
+namespace devtools {
+namespace cdbg {
+
+// Duration of the initial calibration of "FastClock".
+constexpr int64 kInitialCalibrationNs = 1000000;  // 1 ms.
+
+// "HitStopwatch" reads the thread CPU clock on 1 in this many measurements.
+constexpr uint32 kThreadClockSampleInterval = 16;
+
+// Weight of a new sample in the moving average of the ratio of thread CPU
+// time to elapsed time.
+constexpr double kThreadCpuRatioWeight = 0.05;
+
+std::atomic<uint32> FastClock::sequence_ { 0 };
+std::atomic<int64> FastClock::base_ticks_ { 0 };
+std::atomic<int64> FastClock::base_ns_ { 0 };
+std::atomic<double> FastClock::ns_per_tick_ { 0 };
+int64 FastClock::calibration_ticks_ = 0;
+int64 FastClock::calibration_ns_ = 0;
+
+// Ratio of thread CPU time to elapsed time in the sampled measurements of
+// "HitStopwatch".
+static std::atomic<double> g_thread_cpu_ratio { 1.0 };
+
+// Counts "HitStopwatch" measurements on the current thread to pick the ones
+// to sample.
+static __thread uint32 g_hit_stopwatch_count = 0;
+
+
+static int64 MonotonicClockNanos() {
+  struct timespec tp;
+  clock_gettime(CLOCK_MONOTONIC, &tp);
+  return tp.tv_sec * 1000000000LL + tp.tv_nsec;
+}
+
+
+static int64 ThreadCpuClockNanos() {
+  struct timespec tp;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tp);
+  return tp.tv_sec * 1000000000LL + tp.tv_nsec;
+}
+
+
+#ifdef CDBG_FAST_CLOCK_TSC
+
+static int64 ReadTicks() {
+  return static_cast<int64>(__rdtsc());
+}
+
+
+// Checks whether the time stamp counter runs at a constant rate regardless
+// of power management and is therefore usable as a clock.
+static bool HasInvariantTsc() {
+  unsigned int eax = 0;
+  unsigned int ebx = 0;
+  unsigned int ecx = 0;
+  unsigned int edx = 0;
+  if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+    return false;
+  }
+
+  return (edx & (1 << 8)) != 0;
+}
+
+#endif  // CDBG_FAST_CLOCK_TSC
+
+
+void FastClock::Initialize() {
+#ifdef CDBG_FAST_CLOCK_TSC
+  if (!HasInvariantTsc()) {
+    LOG(INFO) << "Invariant TSC not available, using CLOCK_MONOTONIC";
+    return;
+  }
+
+  const int64 start_ticks = ReadTicks();
+  const int64 start_ns = MonotonicClockNanos();
+
+  int64 ns = start_ns;
+  while (ns - start_ns < kInitialCalibrationNs) {
+    ns = MonotonicClockNanos();
+  }
+
+  const int64 ticks = ReadTicks();
+  if (ticks <= start_ticks) {
+    LOG(WARNING) << "TSC is not monotonic, using CLOCK_MONOTONIC";
+    return;
+  }
+
+  calibration_ticks_ = start_ticks;
+  calibration_ns_ = start_ns;
+
+  const double ns_per_tick =
+      static_cast<double>(ns - start_ns) / (ticks - start_ticks);
+  Publish(ticks, ns, ns_per_tick);
+
+  LOG(INFO) << "Using TSC clock, " << 1 / ns_per_tick << " ticks per ns";
+#endif  // CDBG_FAST_CLOCK_TSC
+}
+
+
+void FastClock::Recalibrate() {
+#ifdef CDBG_FAST_CLOCK_TSC
+  if (!IsTscEnabled()) {
+    return;
+  }
+
+  // Converting with the old factor keeps the clock continuous. The new
+  // factor is computed over the entire time since "Initialize", so it gets
+  // more precise with every recalibration.
+  const int64 ns = NowNanos();
+  const int64 ticks = ReadTicks();
+  const int64 monotonic_ns = MonotonicClockNanos();
+  if (ticks <= calibration_ticks_) {
+    return;
+  }
+
+  Publish(
+      ticks,
+      ns,
+      static_cast<double>(monotonic_ns - calibration_ns_) /
+          (ticks - calibration_ticks_));
+#endif  // CDBG_FAST_CLOCK_TSC
+}
+
+
+int64 FastClock::NowNanos() {
+#ifdef CDBG_FAST_CLOCK_TSC
+  uint32 sequence;
+  int64 base_ticks;
+  int64 base_ns;
+  double ns_per_tick;
+  do {
+    sequence = sequence_.load(std::memory_order_acquire);
+    base_ticks = base_ticks_.load(std::memory_order_relaxed);
+    base_ns = base_ns_.load(std::memory_order_relaxed);
+    ns_per_tick = ns_per_tick_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while (((sequence & 1) != 0) ||
+           (sequence != sequence_.load(std::memory_order_relaxed)));
+
+  if (ns_per_tick > 0) {
+    return base_ns +
+        static_cast<int64>((ReadTicks() - base_ticks) * ns_per_tick);
+  }
+#endif  // CDBG_FAST_CLOCK_TSC
+
+  return MonotonicClockNanos();
+}
+
+
+void FastClock::Publish(int64 ticks, int64 ns, double ns_per_tick) {
+  const uint32 sequence = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  base_ticks_.store(ticks, std::memory_order_relaxed);
+  base_ns_.store(ns, std::memory_order_relaxed);
+  ns_per_tick_.store(ns_per_tick, std::memory_order_relaxed);
+
+  sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+
+HitStopwatch::HitStopwatch()
+    : start_ns_(FLAGS_cdbg_fast_hit_clock ? FastClock::NowNanos() : 0) {
+  if (!FLAGS_cdbg_fast_hit_clock ||
+      ((++g_hit_stopwatch_count % kThreadClockSampleInterval) == 0)) {
+    start_cpu_ns_ = ThreadCpuClockNanos();
+  }
+}
+
+
+int64 HitStopwatch::GetElapsedNanos() const {
+  if (start_cpu_ns_ == -1) {
+    const int64 elapsed_ns = FastClock::NowNanos() - start_ns_;
+    return std::max<int64>(
+        0,
+        elapsed_ns * g_thread_cpu_ratio.load(std::memory_order_relaxed));
+  }
+
+  const int64 elapsed_cpu_ns = ThreadCpuClockNanos() - start_cpu_ns_;
+
+  if (FLAGS_cdbg_fast_hit_clock) {
+    const int64 elapsed_ns = FastClock::NowNanos() - start_ns_;
+    if (elapsed_ns > 0) {
+      // Concurrent updates from different threads may lose a sample, which
+      // doesn't matter for a moving average.
+      const double ratio =
+          std::min(1.0, static_cast<double>(elapsed_cpu_ns) / elapsed_ns);
+      const double average = g_thread_cpu_ratio.load(std::memory_order_relaxed);
+      g_thread_cpu_ratio.store(
+          average + kThreadCpuRatioWeight * (ratio - average),
+          std::memory_order_relaxed);
+    }
+  }
+
+  return elapsed_cpu_ns;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,119 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_FAST_CLOCK_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_FAST_CLOCK_H_
+
+#include <atomic>
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Monotonic clock that is cheap enough to be read several times on every
+// breakpoint hit. On x86 CPUs with invariant TSC it reads the time stamp
+// counter and converts it to nanoseconds with a factor calibrated against
+// CLOCK_MONOTONIC. Otherwise (or before calibration) it falls back to
+// CLOCK_MONOTONIC, which is served by vDSO without a syscall.
+//
+// The clock is only good for measuring durations: it is continuous across
+// recalibrations, but it slowly drifts away from CLOCK_MONOTONIC between
+// them.
+//
+// This class is thread safe. Readers never lock.
+class FastClock {
+ public:
+  // Calibrates the clock. Called once during agent initialization. Takes
+  // about a millisecond.
+  static void Initialize();
+
+  // Refines the conversion factor using the time elapsed since the previous
+  // calibration. Expected to be called periodically.
+  static void Recalibrate();
+
+  // Gets the current time in nanoseconds.
+  static int64 NowNanos();
+
+  // Returns true if the clock uses the time stamp counter.
+  static bool IsTscEnabled() {
+    return ns_per_tick_.load(std::memory_order_relaxed) > 0;
+  }
+
+ private:
+  FastClock() = delete;
+
+  // Replaces the calibration. Calls are serialized by the callers:
+  // "Initialize" is called before the first "Recalibrate" and
+  // "Recalibrate" is only called from a single thread.
+  static void Publish(int64 ticks, int64 ns, double ns_per_tick);
+
+  // Sequence counter protecting the calibration below (odd while being
+  // updated).
+  static std::atomic<uint32> sequence_;
+
+  // Time stamp counter value and the corresponding time in nanoseconds.
+  static std::atomic<int64> base_ticks_;
+  static std::atomic<int64> base_ns_;
+
+  // Conversion factor from time stamp counter ticks to nanoseconds. Zero if
+  // the time stamp counter is not used.
+  static std::atomic<double> ns_per_tick_;
+
+  // Time stamp counter and CLOCK_MONOTONIC values of the last calibration.
+  // Only accessed by "Initialize" and "Recalibrate".
+  static int64 calibration_ticks_;
+  static int64 calibration_ns_;
+};
+
+
+// Measures time spent by an application thread on a breakpoint hit. Reading
+// CLOCK_THREAD_CPUTIME_ID is a real syscall on many kernels, so the stopwatch
+// is based on "FastClock" and only reads the thread CPU clock on 1 in
+// "kThreadClockSampleInterval" measurements. Those sampled measurements
+// update the global ratio of thread CPU time to elapsed time, which is then
+// applied to the other measurements. This way the time the thread wasn't
+// running is (on average) still excluded, like with the thread CPU clock.
+//
+// If FLAGS_cdbg_fast_hit_clock is false, every measurement uses the thread
+// CPU clock.
+class HitStopwatch {
+ public:
+  HitStopwatch();
+
+  // Gets elapsed time in nanoseconds.
+  int64 GetElapsedNanos() const;
+
+  // Gets elapsed time in microseconds.
+  int64 GetElapsedMicros() const {
+    return (GetElapsedNanos() + 500) / 1000;
+  }
+
+ private:
+  // Start time according to "FastClock".
+  const int64 start_ns_;
+
+  // Start time according to the thread CPU clock or -1 if this measurement
+  // is not sampled.
+  int64 start_cpu_ns_ { -1 };
+
+  DISALLOW_COPY_AND_ASSIGN(HitStopwatch);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_FAST_CLOCK_H_
@@ -237,6 +237,10 @@ bool FieldEvaluator::CompileStaticField(
   result_type_ = static_field_reader_->GetStaticType();
   computer_ = &FieldEvaluator::StaticFieldComputer;
 
+  if (static_field_reader_->ReadConstantValue(&static_value_)) {
+    computer_ = &FieldEvaluator::StaticValueComputer;
+  }
+
   return true;
 }
 
@@ -311,6 +315,12 @@ ErrorOr<JVariant> FieldEvaluator::StaticFieldComputer(
 }
 
 
+ErrorOr<JVariant> FieldEvaluator::StaticValueComputer(
+    const EvaluationContext& evaluation_context) const {
+  return JVariant(static_value_);
+}
+
+
 }  // namespace cdbg
 }  // namespace devtools
 
@@ -19,6 +19,7 @@
 
 #include "common.h"
 #include "expression_evaluator.h"
+#include "expression_program.h"
 
 namespace devtools {
 namespace cdbg {
@@ -49,7 +50,28 @@ class FieldEvaluator : public ExpressionEvaluator {
 
   const JSignature& GetStaticType() const override { return result_type_; }
 
-  Nullable<jvalue> GetStaticValue() const override { return nullptr; }
+  Nullable<jvalue> GetStaticValue() const override {
+    if (static_value_.type() != JType::Void) {
+      return static_value_.get_jvalue();
+    }
+
+    return nullptr;
+  }
+
+  bool HasMethodCalls() const override {
+    return (instance_source_ != nullptr) &&
+           instance_source_->HasMethodCalls();
+  }
+
+  int Lower(ExpressionProgramBuilder* builder) const override {
+    if (static_value_.type() != JType::Void) {
+      return builder->AddConstant(
+          static_value_.type(),
+          static_value_.get_jvalue());
+    }
+
+    return builder->AddLeaf(*this);
+  }
 
   ErrorOr<JVariant> Evaluate(
       const EvaluationContext& evaluation_context) const override;
@@ -77,6 +99,11 @@ class FieldEvaluator : public ExpressionEvaluator {
   ErrorOr<JVariant> StaticFieldComputer(
       const EvaluationContext& evaluation_context) const;
 
+  // Evaluation method when the expression refers to a "static final" field
+  // whose value was read at compile time.
+  ErrorOr<JVariant> StaticValueComputer(
+      const EvaluationContext& evaluation_context) const;
+
  private:
   // Expression computing the source object to read field from.
   std::unique_ptr<ExpressionEvaluator> instance_source_;
@@ -102,6 +129,10 @@ class FieldEvaluator : public ExpressionEvaluator {
   // computer_ is supposed product.
   JSignature result_type_;
 
+  // Value of a constant static field read at compile time or void if the
+  // field is read on each evaluation.
+  JVariant static_value_;
+
   // Pointer to a member function of this class to do the actual evaluation.
   ErrorOr<JVariant> (FieldEvaluator::*computer_)(
       const EvaluationContext&) const;
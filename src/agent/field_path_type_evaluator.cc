@@ -0,0 +1,209 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "field_path_type_evaluator.h"
+
+#include <sstream>
+#include "instance_field_reader.h"
+#include "jni_utils.h"
+#include "messages.h"
+#include "model.h"
+
+DEFINE_string(
+    field_path_pretty_printers,
+    "",
+    "Colon separated list of pretty printers for application classes in the "
+    "format of \"class=path,path,...\", where class is an internal class "
+    "name and path is a dot separated chain of instance fields. For example: "
+    "\"com/prod/Money=amount,currency.code:com/prod/User=id,name\"");
+
+namespace devtools {
+namespace cdbg {
+
+// Splits "s" separated by "delimiter". Empty items are skipped.
+static std::vector<string> SplitString(const string& s, char delimiter) {
+  std::vector<string> items;
+  std::stringstream ss(s);
+  string item;
+  while (std::getline(ss, item, delimiter)) {
+    if (!item.empty()) {
+      items.push_back(std::move(item));
+    }
+  }
+
+  return items;
+}
+
+
+FieldPathTypeEvaluator::FieldPathTypeEvaluator(
+    ClassMetadataReader* class_metadata_reader,
+    std::vector<FieldPath> field_paths)
+    : class_metadata_reader_(class_metadata_reader),
+      field_paths_(std::move(field_paths)) {
+  for (const FieldPath& field_path : field_paths_) {
+    string name;
+    for (const string& field_name : field_path) {
+      if (!name.empty()) {
+        name += '.';
+      }
+
+      name += field_name;
+    }
+
+    member_names_.push_back(std::move(name));
+  }
+}
+
+
+std::map<string, std::unique_ptr<FieldPathTypeEvaluator>>
+FieldPathTypeEvaluator::CreateFromFlags(
+    ClassMetadataReader* class_metadata_reader) {
+  std::map<string, std::unique_ptr<FieldPathTypeEvaluator>> evaluators;
+
+  const std::vector<string> items =
+      SplitString(FLAGS_field_path_pretty_printers, ':');
+  for (const string& item : items) {
+    const size_t separator = item.find('=');
+    if ((separator == string::npos) || (separator == 0)) {
+      LOG(ERROR) << "Bad field path pretty printer: " << item;
+      continue;
+    }
+
+    std::vector<FieldPath> field_paths;
+    for (const string& path : SplitString(item.substr(separator + 1), ',')) {
+      field_paths.push_back(SplitString(path, '.'));
+    }
+
+    if (field_paths.empty()) {
+      LOG(ERROR) << "Field path pretty printer has no fields: " << item;
+      continue;
+    }
+
+    const string signature = 'L' + item.substr(0, separator) + ';';
+    LOG(INFO) << "Field path pretty printer for " << signature << " with "
+              << field_paths.size() << " fields";
+
+    evaluators[signature].reset(new FieldPathTypeEvaluator(
+        class_metadata_reader,
+        std::move(field_paths)));
+  }
+
+  return evaluators;
+}
+
+
+void FieldPathTypeEvaluator::Evaluate(
+    MethodCaller* method_caller,
+    const ClassMetadataReader::Entry& class_metadata,
+    jobject obj,
+    std::vector<NamedJVariant>* members) {
+  *members = std::vector<NamedJVariant>(field_paths_.size());
+  for (int i = 0; i < field_paths_.size(); ++i) {
+    (*members)[i].name = member_names_[i];
+    EvaluateFieldPath(class_metadata, obj, field_paths_[i], &(*members)[i]);
+  }
+}
+
+
+void FieldPathTypeEvaluator::EvaluateFieldPath(
+    const ClassMetadataReader::Entry& class_metadata,
+    jobject obj,
+    const FieldPath& field_path,
+    NamedJVariant* member) {
+  const ClassMetadataReader::Entry* metadata = &class_metadata;
+
+  // Keeps the intermediate object alive while reading its field.
+  JVariant current = JVariant::BorrowedRef(obj);
+
+  for (int i = 0; i < field_path.size(); ++i) {
+    const InstanceFieldReader* field_reader =
+        FindField(*metadata, field_path[i]);
+    if (field_reader == nullptr) {
+      member->status.is_error = true;
+      member->status.refers_to = StatusMessageModel::Context::VARIABLE_NAME;
+      member->status.description = {
+        InstanceFieldNotFound,
+        {
+          field_path[i],
+          TypeNameFromSignature(metadata->signature)
+        }
+      };
+      return;
+    }
+
+    jobject current_obj = nullptr;
+    current.get<jobject>(&current_obj);
+
+    JVariant value;
+    if (!field_reader->ReadValue(current_obj, &value)) {
+      member->status.is_error = true;
+      member->status.refers_to = StatusMessageModel::Context::VARIABLE_VALUE;
+      member->status.description = INTERNAL_ERROR_MESSAGE;
+      return;
+    }
+
+    if (i + 1 == field_path.size()) {
+      member->value.swap(&value);
+      member->well_known_jclass =
+          WellKnownJClassFromSignature(field_reader->GetStaticType());
+      return;
+    }
+
+    jobject next_obj = nullptr;
+    if (!value.get<jobject>(&next_obj)) {
+      member->status.is_error = true;
+      member->status.refers_to = StatusMessageModel::Context::VARIABLE_NAME;
+      member->status.description = {
+        PrimitiveTypeField,
+        {
+          TypeNameFromSignature(field_reader->GetStaticType()),
+          field_path[i + 1]
+        }
+      };
+      return;
+    }
+
+    if (next_obj == nullptr) {
+      member->status.is_error = false;
+      member->status.refers_to = StatusMessageModel::Context::VARIABLE_VALUE;
+      member->status.description = { NullPointerDereference };
+      return;
+    }
+
+    // The fields of the intermediate object depend on its runtime class.
+    JniLocalRef next_cls = GetObjectClass(next_obj);
+    metadata = &class_metadata_reader_->GetClassMetadata(
+        static_cast<jclass>(next_cls.get()));
+
+    current.swap(&value);
+  }
+}
+
+
+const InstanceFieldReader* FieldPathTypeEvaluator::FindField(
+    const ClassMetadataReader::Entry& class_metadata,
+    const string& name) {
+  for (const auto& field_reader : class_metadata.instance_fields) {
+    if (field_reader->GetName() == name) {
+      return field_reader.get();
+    }
+  }
+
+  return nullptr;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
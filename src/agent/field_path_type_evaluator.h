@@ -0,0 +1,95 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_FIELD_PATH_TYPE_EVALUATOR_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_FIELD_PATH_TYPE_EVALUATOR_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "common.h"
+#include "type_evaluator.h"
+
+namespace devtools {
+namespace cdbg {
+
+class ClassMetadataReader;
+class InstanceFieldReader;
+struct NamedJVariant;
+
+// Captures a fixed list of field paths (like "currency.code") of objects of
+// a single class. This is a declarative pretty printer configured by the
+// user (see "--field_path_pretty_printers") for domain objects, where the
+// generic field dump is too noisy and "toString()" is too expensive. The
+// fields are read through "ClassMetadataReader", so the field visibility
+// policy applies the same way as for "GenericTypeEvaluator". No methods
+// are called.
+class FieldPathTypeEvaluator : public TypeEvaluator {
+ public:
+  // Field path split into field names (e.g. { "currency", "code" }).
+  using FieldPath = std::vector<string>;
+
+  FieldPathTypeEvaluator(
+      ClassMetadataReader* class_metadata_reader,
+      std::vector<FieldPath> field_paths);
+
+  // Creates the evaluators configured in "--field_path_pretty_printers".
+  // The returned map is keyed by class signature (e.g. "Lcom/prod/Money;").
+  // Invalid entries are logged and ignored.
+  static std::map<string, std::unique_ptr<FieldPathTypeEvaluator>>
+  CreateFromFlags(ClassMetadataReader* class_metadata_reader);
+
+  string GetEvaluatorName() override {
+    return "FieldPathTypeEvaluator";
+  }
+
+  void Evaluate(
+      MethodCaller* method_caller,
+      const ClassMetadataReader::Entry& class_metadata,
+      jobject obj,
+      std::vector<NamedJVariant>* members) override;
+
+ private:
+  // Reads a single field path starting at "obj".
+  void EvaluateFieldPath(
+      const ClassMetadataReader::Entry& class_metadata,
+      jobject obj,
+      const FieldPath& field_path,
+      NamedJVariant* member);
+
+  // Finds the reader of the instance field "name". Returns nullptr if the
+  // class doesn't have such a field or if it is not visible.
+  static const InstanceFieldReader* FindField(
+      const ClassMetadataReader::Entry& class_metadata,
+      const string& name);
+
+ private:
+  // Used to get the fields of the intermediate objects in the path.
+  ClassMetadataReader* const class_metadata_reader_;
+
+  // Field paths to capture.
+  const std::vector<FieldPath> field_paths_;
+
+  // Names of the captured members (the field paths joined with '.').
+  std::vector<string> member_names_;
+
+  DISALLOW_COPY_AND_ASSIGN(FieldPathTypeEvaluator);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_FIELD_PATH_TYPE_EVALUATOR_H_
@@ -0,0 +1,235 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "file_dynamic_logger.h"
+
+#include <errno.h>
+#include <sys/time.h>
+#include <time.h>
+#include "format_util.h"
+#include "resolved_source_location.h"
+#include "type_util.h"
+
+DEFINE_string(
+    dynamic_log_output,
+    "",
+    "write dynamic logs as JSON lines to this file (or \"stdout\" or "
+    "\"stderr\") instead of java.util.logging");
+
+DEFINE_int32(
+    dynamic_log_file_max_size_mb,
+    100,
+    "size at which the dynamic log file set by --dynamic_log_output is "
+    "rotated; 0 disables the rotation");
+
+namespace devtools {
+namespace cdbg {
+
+// Estimated size of a JSON line excluding the message.
+constexpr int kEstimatedRecordOverhead = 160;
+
+// Appends the current time in RFC 3339 format with microseconds.
+static void AppendCurrentTime(string* output) {
+  struct timeval now;
+  gettimeofday(&now, nullptr);
+
+  struct tm now_tm;
+  gmtime_r(&now.tv_sec, &now_tm);
+
+  char buffer[64];
+  const size_t length = strftime(
+      buffer,
+      arraysize(buffer),
+      "%Y-%m-%dT%H:%M:%S",
+      &now_tm);
+  output->append(buffer, length);
+
+  snprintf(
+      buffer,
+      arraysize(buffer),
+      ".%06dZ",
+      static_cast<int>(now.tv_usec));
+  output->append(buffer);
+}
+
+
+static const char* GetSeverity(BreakpointModel::LogLevel level) {
+  switch (level) {
+    case BreakpointModel::LogLevel::INFO:
+      return "\"INFO\"";
+
+    case BreakpointModel::LogLevel::WARNING:
+      return "\"WARNING\"";
+
+    case BreakpointModel::LogLevel::ERROR:
+      return "\"ERROR\"";
+  }
+
+  return "\"DEFAULT\"";
+}
+
+
+FileDynamicLogger::FileDynamicLogger(const string& path)
+    : path_(path),
+      is_file_((path != "stdout") && (path != "stderr")) {
+  MutexLock lock(&mu_);
+  Open();
+}
+
+
+FileDynamicLogger::~FileDynamicLogger() {
+  if (is_file_ && (file_ != nullptr)) {
+    fclose(file_);
+  }
+}
+
+
+bool FileDynamicLogger::IsAvailable() const {
+  MutexLock lock(&mu_);
+  return file_ != nullptr;
+}
+
+
+void FileDynamicLogger::Log(
+    BreakpointModel::LogLevel level,
+    const ResolvedSourceLocation& source_location,
+    const string& message) {
+  string line;
+  line.reserve(kEstimatedRecordOverhead + message.size());
+  AppendRecord(level, source_location, message, &line);
+
+  Write(line);
+}
+
+
+void FileDynamicLogger::LogBatch(
+    const std::vector<DynamicLogRecord>& records) {
+  size_t estimated_size = 0;
+  for (const DynamicLogRecord& record : records) {
+    estimated_size += kEstimatedRecordOverhead + record.message.size();
+  }
+
+  string lines;
+  lines.reserve(estimated_size);
+  for (const DynamicLogRecord& record : records) {
+    AppendRecord(
+        record.level,
+        *record.source_location,
+        record.message,
+        &lines);
+  }
+
+  Write(lines);
+}
+
+
+void FileDynamicLogger::AppendRecord(
+    BreakpointModel::LogLevel level,
+    const ResolvedSourceLocation& source_location,
+    const string& message,
+    string* output) {
+  std::shared_ptr<const InternedClassSignature> class_signature =
+      InternClassSignature(source_location.class_signature);
+  const string& source_class = class_signature->type_name;
+
+  output->append("{\"message\":");
+  AppendJsonQuotedString(message.data(), message.size(), output);
+  output->append(",\"severity\":");
+  output->append(GetSeverity(level));
+  output->append(",\"sourceLocation\":{\"class\":");
+  AppendJsonQuotedString(source_class.data(), source_class.size(), output);
+  output->append(",\"line\":");
+  AppendInteger(source_location.adjusted_line_number, output);
+  output->append(",\"method\":");
+  AppendJsonQuotedString(
+      source_location.method_name.data(),
+      source_location.method_name.size(),
+      output);
+  output->append("},\"time\":\"");
+  AppendCurrentTime(output);
+  output->append("\"}\n");
+}
+
+
+void FileDynamicLogger::Open() {
+  if (path_ == "stdout") {
+    file_ = stdout;
+    return;
+  }
+
+  if (path_ == "stderr") {
+    file_ = stderr;
+    return;
+  }
+
+  file_ = fopen(path_.c_str(), "ab");
+  if (file_ == nullptr) {
+    LOG(ERROR) << "Failed to open dynamic log file " << path_
+               << ", error: " << errno;
+    return;
+  }
+
+  fseek(file_, 0, SEEK_END);
+  file_size_ = ftell(file_);
+}
+
+
+void FileDynamicLogger::Write(const string& lines) {
+  MutexLock lock(&mu_);
+
+  if (file_ == nullptr) {
+    return;
+  }
+
+  if ((fwrite(lines.data(), 1, lines.size(), file_) != lines.size()) ||
+      (fflush(file_) != 0)) {
+    LOG_EVERY_N(WARNING, 100) << "Failed to write dynamic log to " << path_;
+    return;
+  }
+
+  file_size_ += lines.size();
+
+  const int64 max_size =
+      static_cast<int64>(FLAGS_dynamic_log_file_max_size_mb) * 1024 * 1024;
+  if (!is_file_ || (max_size <= 0) || (file_size_ < max_size)) {
+    return;
+  }
+
+  fclose(file_);
+  file_ = nullptr;
+
+  const string rotated_path = path_ + ".1";
+  if (rename(path_.c_str(), rotated_path.c_str()) != 0) {
+    LOG_EVERY_N(WARNING, 100) << "Failed to rotate dynamic log file "
+                              << path_ << ", error: " << errno;
+  }
+
+  Open();
+}
+
+
+std::shared_ptr<DynamicLogger> CreateFileDynamicLogger() {
+  if (FLAGS_dynamic_log_output.empty()) {
+    return nullptr;
+  }
+
+  LOG(INFO) << "Dynamic logs are written to " << FLAGS_dynamic_log_output;
+
+  return std::make_shared<FileDynamicLogger>(FLAGS_dynamic_log_output);
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,99 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_FILE_DYNAMIC_LOGGER_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_FILE_DYNAMIC_LOGGER_H_
+
+#include <cstdio>
+#include <memory>
+#include "common.h"
+#include "dynamic_logger.h"
+#include "mutex.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Writes dynamic logs as JSON lines directly to a file, stdout or stderr,
+// bypassing "java.util.logging" and its handlers. Writing an entry doesn't
+// involve JNI, so log points are not affected by slow application log
+// appenders. Each line looks like this:
+//   {"message":"...","severity":"INFO","sourceLocation":{"class":"com.A",
+//    "line":12,"method":"f"},"time":"2020-01-01T00:00:00.000000Z"}
+//
+// A file is rotated once it exceeds "FLAGS_dynamic_log_file_max_size_mb":
+// the current file is renamed with ".1" suffix (replacing the previous one)
+// and a new file is started.
+//
+// This class is thread safe.
+class FileDynamicLogger : public DynamicLogger {
+ public:
+  // Writes to the file at "path" or to stdout/stderr if "path" is "stdout"
+  // or "stderr".
+  explicit FileDynamicLogger(const string& path);
+
+  ~FileDynamicLogger() override;
+
+  bool IsAvailable() const override;
+
+  void Log(
+      BreakpointModel::LogLevel level,
+      const ResolvedSourceLocation& source_location,
+      const string& message) override;
+
+  // Formats all the records into a single buffer and writes it at once.
+  void LogBatch(const std::vector<DynamicLogRecord>& records) override;
+
+ private:
+  // Appends JSON line of the log entry to "output".
+  static void AppendRecord(
+      BreakpointModel::LogLevel level,
+      const ResolvedSourceLocation& source_location,
+      const string& message,
+      string* output);
+
+  // Opens "path_" for appending. Must be called with "mu_" held.
+  void Open();
+
+  // Writes the formatted lines and rotates the file if it grew too large.
+  void Write(const string& lines);
+
+ private:
+  // Path of the log file or "stdout" or "stderr".
+  const string path_;
+
+  // True if "path_" is a file rather than stdout or stderr.
+  const bool is_file_;
+
+  // Locks access to "file_" and "file_size_".
+  mutable Mutex mu_;
+
+  // Output stream or nullptr if the file could not be opened.
+  FILE* file_ { nullptr };
+
+  // Number of bytes in the current file.
+  int64 file_size_ { 0 };
+
+  DISALLOW_COPY_AND_ASSIGN(FileDynamicLogger);
+};
+
+// Creates the dynamic logger selected by "FLAGS_dynamic_log_output". Returns
+// nullptr if dynamic logs should go to "java.util.logging".
+std::shared_ptr<DynamicLogger> CreateFileDynamicLogger();
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_FILE_DYNAMIC_LOGGER_H_
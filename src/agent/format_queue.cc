@@ -18,12 +18,13 @@
 
 #include "statistician.h"
 #include "stopwatch.h"
+#include "trace_recorder.h"
 
 namespace devtools {
 namespace cdbg {
 
 FormatQueue::~FormatQueue() {
-  if (!queue_.empty()) {
+  if (queue_size_ > 0) {
     LOG(WARNING) << "Pending breakpoint hit reports are abandoned";
   }
 }
@@ -32,71 +33,124 @@ FormatQueue::~FormatQueue() {
 void FormatQueue::RemoveAll() {
   MutexLock lock(&mu_);
 
-  for (Item& item : queue_) {
+  for (int i = 0; i < queue_size_; ++i) {
+    Item& item = queue_[(queue_head_ + i) % kMaxFormatQueueSize];
     if (item.collector != nullptr) {
       item.collector->ReleaseRefs();
     }
+
+    item = Item();
   }
 
-  queue_.clear();
+  queue_head_ = 0;
+  queue_size_ = 0;
 }
 
 
-void FormatQueue::Enqueue(
+bool FormatQueue::Enqueue(
     std::unique_ptr<BreakpointModel> breakpoint,
-    std::unique_ptr<CaptureDataCollector> collector) {
-  {
-    Item item;
-    item.breakpoint = std::move(breakpoint);
-    item.collector = std::move(collector);
+    std::shared_ptr<CaptureDataCollector> collector) {
+  Item item;
+  item.breakpoint = std::move(breakpoint);
+  item.collector = std::move(collector);
+  if (IsTracingEnabled()) {
+    item.enqueue_nanos = TraceClockNanos();
+  }
 
-    if (item.breakpoint == nullptr) {
-      DCHECK(item.breakpoint != nullptr);
-      return;
-    }
+  if (item.breakpoint == nullptr) {
+    DCHECK(item.breakpoint != nullptr);
+    return false;
+  }
 
+  bool is_dropped = false;
+  bool fire_item_enqueued = false;
+  {
     MutexLock lock(&mu_);
 
     // Replace pending non-final updates and ignore repeated final updates.
-    for (Item& existing_item : queue_) {
+    // Either way "item" ends up with the update to discard.
+    bool is_replaced = false;
+    for (int i = 0; i < queue_size_; ++i) {
+      Item& existing_item = queue_[(queue_head_ + i) % kMaxFormatQueueSize];
       if (existing_item.breakpoint->id == item.breakpoint->id) {
         if (!existing_item.breakpoint->is_final_state) {
           std::swap(existing_item, item);
         }
-        return;
+        is_replaced = true;
+        break;
       }
     }
 
-    if (queue_.size() < kMaxFormatQueueSize) {
-      queue_.push_back(std::move(item));
+    if (!is_replaced) {
+      if (queue_size_ < kMaxFormatQueueSize) {
+        // The consumer drains the queue until it's empty, so it only needs
+        // to be woken up when the first item is enqueued.
+        fire_item_enqueued = (queue_size_ == 0);
+
+        queue_[(queue_head_ + queue_size_) % kMaxFormatQueueSize] =
+            std::move(item);
+        ++queue_size_;
+      } else {
+        is_dropped = true;
+        ++dropped_items_count_;
+        LOG_EVERY_N(WARNING, 100)
+            << "Format queue is full, breakpoint update discarded, "
+               "total dropped: " << dropped_items_count_;
+      }
     }
   }
 
-  on_item_enqueued_.Fire();
+  // Release the discarded update (if any) outside of the lock.
+  if (item.collector != nullptr) {
+    item.collector->ReleaseRefs();
+  }
+
+  if (fire_item_enqueued) {
+    on_item_enqueued_.Fire();
+  }
+
+  return !is_dropped;
 }
 
 
 std::unique_ptr<BreakpointModel> FormatQueue::FormatAndPop() {
   Stopwatch stopwatch;
 
-  MutexLock lock(&mu_);
+  Item front;
+  {
+    MutexLock lock(&mu_);
 
-  if (queue_.empty()) {
-    return nullptr;
-  }
+    if (queue_size_ == 0) {
+      return nullptr;
+    }
 
-  // TODO(vlif): refactor to avoid keeping mutex locked during "Format".
+    front = std::move(queue_[queue_head_]);
+    queue_head_ = (queue_head_ + 1) % kMaxFormatQueueSize;
+    --queue_size_;
+  }
 
-  Item& front = queue_.front();
+  // The item is no longer in the queue, so neither "Enqueue" nor "RemoveAll"
+  // can touch it. Both the deferred object collection and formatting can
+  // take a while and should not block application threads that hit
+  // breakpoints.
   std::unique_ptr<BreakpointModel> breakpoint = std::move(front.breakpoint);
 
+  const int64 format_start_nanos =
+      (front.enqueue_nanos > 0) ? TraceClockNanos() : 0;
+  if (front.enqueue_nanos > 0) {
+    RecordTraceSpan(
+        "format_queue_wait",
+        breakpoint->id,
+        front.enqueue_nanos,
+        format_start_nanos);
+  }
+
   if (front.collector != nullptr) {
+    front.collector->CompleteCollection();
     front.collector->Format(breakpoint.get());
     front.collector->ReleaseRefs();
   }
 
-  queue_.pop_front();
-
   // Copy "expressions" to "evaluated_expressions". The size of "expressions"
   // and "evaluated_expressions" is expected to be the same if breakpoint was
   // evaluated. Otherwise "evaluated_expressions" will be empty. Use "std::min"
@@ -111,6 +165,14 @@ std::unique_ptr<BreakpointModel> FormatQueue::FormatAndPop() {
 
   statFormattingTime->add(stopwatch.GetElapsedMicros());
 
+  if (format_start_nanos > 0) {
+    RecordTraceSpan(
+        "format",
+        breakpoint->id,
+        format_start_nanos,
+        TraceClockNanos());
+  }
+
   return breakpoint;
 }
 
@@ -17,7 +17,7 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_FORMAT_QUEUE_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_FORMAT_QUEUE_H_
 
-#include <queue>
+#include <atomic>
 #include <memory>
 #include "capture_data_collector.h"
 #include "common.h"
@@ -33,15 +33,23 @@ namespace cdbg {
 // wrong with the communication channel to the Hub.
 constexpr int kMaxFormatQueueSize = 100;
 
+// Number of slots in the queue reserved for status only updates (e.g. a
+// snapshot cancelled because of the backlog). New captures are not admitted
+// once fewer free slots are left.
+constexpr int kFormatQueueStatusReserve = 10;
+
 // Implements a queue of breakpoint results that are waiting for be formatted
 // to the message that can be transmitted to the Hub service. The class is
 // thread safe since breakpoints are captured and formatted on different
 // threads.
 class FormatQueue {
  public:
-  // Event fired when a new breakpoint update is enqueued. This event is fired
-  // in the same thread that enqueued the update. The subscriber to this event
-  // should defer as much work as possible outside of the event callback.
+  // Event fired when a new breakpoint update is enqueued into an empty queue.
+  // Updates enqueued while the queue still has pending items don't fire the
+  // event again: the consumer is expected to call "FormatAndPop" until the
+  // queue is empty. This event is fired in the same thread that enqueued the
+  // update. The subscriber to this event should defer as much work as
+  // possible outside of the event callback.
   typedef Observable<> OnItemEnqueued;
 
   FormatQueue() { }
@@ -55,19 +63,57 @@ class FormatQueue {
   // parameter contains the definition of the breakpoint (without the results).
   // The "collector" captures call stack, local variables and objects on
   // breakpoint hit and can format the captured data into the protocol message.
-  // "FormatQueue" takes ownership over "breakpoint" and "collector". "Enqueue"
+  // "FormatQueue" takes ownership over "breakpoint" and shares "collector"
+  // with other breakpoints hit at the same location (if any). "Enqueue"
   // honors the "kMaxPendingResults" limit and discards the breakpoint if
-  // threshold is reached.
+  // threshold is reached (see "GetDroppedItemsCount"). Returns false if the
+  // breakpoint update was discarded for this reason.
   // "jni" is used to provide JNI context to "OnItemEnqueued" event.
-  void Enqueue(
+  bool Enqueue(
       std::unique_ptr<BreakpointModel> breakpoint,
-      std::unique_ptr<CaptureDataCollector> collector);
+      std::shared_ptr<CaptureDataCollector> collector);
 
   // If the queue is empty, returns nullptr. Otherwise pops the first entry in
   // the queue, formats it (i.e. combines breakpoint definition with breakpoint
   // results and captures immutable Java objects) and returns it to the caller.
+  // Object exploration deferred by the collector happens here as well. The
+  // queue is not locked while the entry is being formatted.
   std::unique_ptr<BreakpointModel> FormatAndPop();
 
+  // Checks whether a new breakpoint capture should be taken. Returns false if
+  // the queue is nearly full or if the consumer reported that it can't keep
+  // up with the flow of updates (see "SetDownstreamSaturated"). In that case
+  // the capture would likely be discarded, so it is better not to pause the
+  // application thread collecting it. The breakpoint should be completed
+  // with a status message instead, which still fits the reserved slots.
+  bool IsCaptureAdmitted() const {
+    if (is_downstream_saturated_) {
+      return false;
+    }
+
+    MutexLock lock(&mu_);
+    return queue_size_ < kMaxFormatQueueSize - kFormatQueueStatusReserve;
+  }
+
+  // Called by the consumer of the queue to indicate whether the formatted
+  // updates pile up downstream (e.g. the Hub service is not reachable).
+  void SetDownstreamSaturated(bool is_saturated) {
+    is_downstream_saturated_ = is_saturated;
+  }
+
+  // Gets the number of breakpoint updates waiting in the queue.
+  int GetSize() const {
+    MutexLock lock(&mu_);
+    return queue_size_;
+  }
+
+  // Gets the number of breakpoint updates discarded because the queue was
+  // full.
+  int64 GetDroppedItemsCount() const {
+    MutexLock lock(&mu_);
+    return dropped_items_count_;
+  }
+
   // Subscribes to receive OnItemEnqueued notifications.
   OnItemEnqueued::Cookie SubscribeOnItemEnqueuedEvents(
       OnItemEnqueued::Callback fn) {
@@ -87,17 +133,33 @@ class FormatQueue {
     std::unique_ptr<BreakpointModel> breakpoint;
 
     // Capture of call stack, local variables and objects on breakpoint hit.
-    std::unique_ptr<CaptureDataCollector> collector;
+    std::shared_ptr<CaptureDataCollector> collector;
+
+    // Time (in trace clock) when the item was enqueued. Only set if the
+    // tracing is enabled.
+    int64 enqueue_nanos { 0 };
   };
 
   // Locks access to the queue.
   mutable Mutex mu_;
 
-  // Breakpoint hit results that wait to be reported to the hub. The list is
-  // used as queue. It is important to use linked list here, so that the pointer
-  // to "Item" returned by "Top" remains valid while new elements are pushed
-  // into the queue.
-  std::list<Item> queue_;
+  // Breakpoint hit results that wait to be reported to the hub. This is a
+  // fixed capacity ring buffer: enqueuing an item never allocates memory for
+  // the queue itself. The queue consists of "queue_size_" items starting
+  // from "queue_head_".
+  Item queue_[kMaxFormatQueueSize];
+
+  // Index of the first item in "queue_".
+  int queue_head_ = 0;
+
+  // Number of items in "queue_".
+  int queue_size_ = 0;
+
+  // Number of items discarded because the queue was full.
+  int64 dropped_items_count_ = 0;
+
+  // Set when the formatted updates can't be delivered fast enough.
+  std::atomic<bool> is_downstream_saturated_ { false };
 
   // Allows other objects to receive synchronous notifications each time
   // a new breakpoint update is enqueued.
@@ -0,0 +1,241 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "format_util.h"
+
+#include <algorithm>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace devtools {
+namespace cdbg {
+
+// Maximum length of "%g" output: sign, 17 significant digits, decimal point
+// and a 4 character exponent ("e-308"), with some slack.
+constexpr int kMaxFloatingPointLength = 32;
+
+// Pairs of decimal digits from "00" to "99".
+static constexpr char kDigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Bit masks for the byte-wise tests of "NeedsJsonEscape".
+constexpr uint64 kEveryByte = 0x0101010101010101ULL;
+constexpr uint64 kHighBits = 0x8080808080808080ULL;
+
+// Checks whether any of the 8 bytes in "word" is zero.
+static inline bool HasZeroByte(uint64 word) {
+  return ((word - kEveryByte) & ~word & kHighBits) != 0;
+}
+
+
+// Checks whether any of the 8 bytes in "word" needs to be escaped in a JSON
+// string: a control character, a double quote or a backslash. Bytes of
+// multi-byte UTF-8 sequences (0x80 and above) are never flagged.
+static inline bool NeedsJsonEscape(uint64 word) {
+  const bool has_control =
+      ((word - kEveryByte * 0x20) & ~word & kHighBits) != 0;
+  return has_control ||
+         HasZeroByte(word ^ (kEveryByte * '"')) ||
+         HasZeroByte(word ^ (kEveryByte * '\\'));
+}
+
+
+// Appends the escape sequence of the character "c" or "c" itself if it
+// doesn't need escaping.
+static void AppendJsonCharacter(char c, string* output) {
+  switch (c) {
+    case '"':
+      output->append("\\\"");
+      break;
+
+    case '\\':
+      output->append("\\\\");
+      break;
+
+    case '\b':
+      output->append("\\b");
+      break;
+
+    case '\f':
+      output->append("\\f");
+      break;
+
+    case '\n':
+      output->append("\\n");
+      break;
+
+    case '\r':
+      output->append("\\r");
+      break;
+
+    case '\t':
+      output->append("\\t");
+      break;
+
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        static constexpr char kHexDigits[] = "0123456789ABCDEF";
+        const char escaped[] = {
+          '\\', 'u', '0', '0',
+          kHexDigits[static_cast<unsigned char>(c) >> 4],
+          kHexDigits[static_cast<unsigned char>(c) & 0xF]
+        };
+        output->append(escaped, arraysize(escaped));
+      } else {
+        output->push_back(c);
+      }
+      break;
+  }
+}
+
+
+// Checks whether the character needs to be escaped in a JSON string.
+static inline bool NeedsJsonEscape(char c) {
+  const unsigned char uc = static_cast<unsigned char>(c);
+  return (uc < 0x20) || (uc == '"') || (uc == '\\');
+}
+
+
+// Finds the first character in "value" starting from "begin" that needs to
+// be escaped in a JSON string. Returns "length" if there is none. Most
+// strings don't have any, so the scan checks 16 bytes at a time with SSE2
+// (and 8 bytes at a time without).
+static size_t FindJsonEscape(const char* value, size_t begin, size_t length) {
+  size_t i = begin;
+
+#if defined(__SSE2__)
+  const __m128i max_control = _mm_set1_epi8(0x1F);
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  while (i + sizeof(__m128i) <= length) {
+    const __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(value + i));
+
+    // Unsigned "block <= 0x1F" is "max(block, 0x1F) == 0x1F".
+    const __m128i needs_escape = _mm_or_si128(
+        _mm_cmpeq_epi8(_mm_max_epu8(block, max_control), max_control),
+        _mm_or_si128(
+            _mm_cmpeq_epi8(block, quote),
+            _mm_cmpeq_epi8(block, backslash)));
+
+    const int mask = _mm_movemask_epi8(needs_escape);
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+
+    i += sizeof(__m128i);
+  }
+#endif
+
+  while (i + sizeof(uint64) <= length) {
+    uint64 word;
+    memcpy(&word, value + i, sizeof(word));
+    if (NeedsJsonEscape(word)) {
+      break;
+    }
+
+    i += sizeof(uint64);
+  }
+
+  for (; i < length; ++i) {
+    if (NeedsJsonEscape(value[i])) {
+      return i;
+    }
+  }
+
+  return length;
+}
+
+
+void AppendInteger(int64 value, string* output) {
+  // Computing with unsigned value takes care of the most negative number.
+  uint64 magnitude = (value < 0)
+      ? (~static_cast<uint64>(value) + 1)
+      : static_cast<uint64>(value);
+
+  char buffer[20];  // Enough for 2^64 - 1 without the sign.
+  char* end = buffer + arraysize(buffer);
+  char* begin = end;
+
+  while (magnitude >= 100) {
+    const int pair = static_cast<int>(magnitude % 100) * 2;
+    magnitude /= 100;
+    begin -= 2;
+    begin[0] = kDigitPairs[pair];
+    begin[1] = kDigitPairs[pair + 1];
+  }
+
+  if (magnitude >= 10) {
+    const int pair = static_cast<int>(magnitude) * 2;
+    begin -= 2;
+    begin[0] = kDigitPairs[pair];
+    begin[1] = kDigitPairs[pair + 1];
+  } else {
+    *--begin = static_cast<char>('0' + magnitude);
+  }
+
+  if (value < 0) {
+    output->push_back('-');
+  }
+
+  output->append(begin, end - begin);
+}
+
+
+void AppendFloatingPoint(double value, int precision, string* output) {
+  char buffer[kMaxFloatingPointLength];
+  int length = snprintf(buffer, arraysize(buffer), "%.*g", precision, value);
+  if (length < 0) {
+    return;
+  }
+
+  output->append(buffer, std::min<int>(length, arraysize(buffer) - 1));
+}
+
+
+void AppendJsonQuotedString(const char* value, size_t length, string* output) {
+  output->reserve(output->size() + length + 2);
+  output->push_back('"');
+
+  // Copy runs of characters that don't need escaping as a whole.
+  size_t run_begin = 0;
+  while (true) {
+    const size_t i = FindJsonEscape(value, run_begin, length);
+    output->append(value + run_begin, i - run_begin);
+    if (i == length) {
+      break;
+    }
+
+    AppendJsonCharacter(value[i], output);
+    run_begin = i + 1;
+  }
+
+  output->push_back('"');
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,45 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_FORMAT_UTIL_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_FORMAT_UTIL_H_
+
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Formatting of primitive values shared by dynamic logs, captured variables
+// and the JSON serialization of breakpoint updates. All functions append to
+// "output" in place, so that a message with many values is built in a single
+// buffer without a temporary string per value.
+
+// Appends decimal representation of "value". Produces the same text as
+// "std::to_string".
+void AppendInteger(int64 value, string* output);
+
+// Appends "value" formatted as "%.*g" with the specified precision.
+void AppendFloatingPoint(double value, int precision, string* output);
+
+// Appends "value" wrapped in double quotes with the characters JSON doesn't
+// allow in a string literal escaped. The output is the same as
+// "Json::valueToQuotedString" produces.
+void AppendJsonQuotedString(const char* value, size_t length, string* output);
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_FORMAT_UTIL_H_
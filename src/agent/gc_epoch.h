@@ -0,0 +1,69 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_GC_EPOCH_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_GC_EPOCH_H_
+
+#include <atomic>
+
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Counts garbage collections so that timing measurements taken on an
+// application thread can tell whether a GC pause was included. The epoch is
+// incremented both when a collection starts and when it finishes, so an odd
+// value means that a collection is in progress.
+//
+// JVMTI GarbageCollectionStart/Finish callbacks run inside the GC and may not
+// call JNI or most of JVMTI, take locks or allocate. Updating the epoch is a
+// single atomic increment and is safe there.
+class GcEpoch {
+ public:
+  // Called from JVMTI GarbageCollectionStart callback.
+  static void OnGarbageCollectionStart() {
+    epoch_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Called from JVMTI GarbageCollectionFinish callback.
+  static void OnGarbageCollectionFinish() {
+    epoch_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Gets the current epoch. Call it when a measurement begins and pass the
+  // value to "HasCollectedSince" when the measurement ends.
+  static int64 Get() {
+    return epoch_.load(std::memory_order_relaxed);
+  }
+
+  // Returns true if a garbage collection was in progress at "epoch" or
+  // started since then.
+  static bool HasCollectedSince(int64 epoch) {
+    return ((epoch & 1) != 0) || (Get() != epoch);
+  }
+
+ private:
+  GcEpoch() = delete;
+
+  static std::atomic<int64> epoch_;
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_GC_EPOCH_H_
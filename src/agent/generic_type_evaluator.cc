@@ -16,7 +16,6 @@
 
 #include "generic_type_evaluator.h"
 
-#include "instance_field_reader.h"
 #include "jvariant.h"
 #include "messages.h"
 #include "model.h"
@@ -24,12 +23,108 @@
 namespace devtools {
 namespace cdbg {
 
+// Reads the instance fields of "obj" of a single type. "begin" and "end"
+// select the fields in "layout.by_type". The type is dispatched once for
+// all of them.
+static void ReadInstanceFields(
+    JNIEnv* env,
+    JType type,
+    jobject obj,
+    const ClassMetadataReader::Entry::InstanceFieldsLayout& layout,
+    int begin,
+    int end,
+    std::vector<NamedJVariant>* result) {
+  const int* index = layout.by_type.data();
+  const jfieldID* field_ids = layout.field_ids.data();
+
+  switch (type) {
+    case JType::Void:
+      LOG(ERROR) << "'void' type is unexpected";
+      for (int i = begin; i < end; ++i) {
+        NamedJVariant& field_data = (*result)[index[i]];
+        field_data.status.is_error = false;
+        field_data.status.refers_to =
+            StatusMessageModel::Context::VARIABLE_VALUE;
+        field_data.status.description = INTERNAL_ERROR_MESSAGE;
+      }
+      return;
+
+    case JType::Boolean:
+      for (int i = begin; i < end; ++i) {
+        (*result)[index[i]].value = JVariant::Boolean(
+            env->GetBooleanField(obj, field_ids[index[i]]));
+      }
+      return;
+
+    case JType::Byte:
+      for (int i = begin; i < end; ++i) {
+        (*result)[index[i]].value = JVariant::Byte(
+            env->GetByteField(obj, field_ids[index[i]]));
+      }
+      return;
+
+    case JType::Char:
+      for (int i = begin; i < end; ++i) {
+        (*result)[index[i]].value = JVariant::Char(
+            env->GetCharField(obj, field_ids[index[i]]));
+      }
+      return;
+
+    case JType::Short:
+      for (int i = begin; i < end; ++i) {
+        (*result)[index[i]].value = JVariant::Short(
+            env->GetShortField(obj, field_ids[index[i]]));
+      }
+      return;
+
+    case JType::Int:
+      for (int i = begin; i < end; ++i) {
+        (*result)[index[i]].value = JVariant::Int(
+            env->GetIntField(obj, field_ids[index[i]]));
+      }
+      return;
+
+    case JType::Long:
+      for (int i = begin; i < end; ++i) {
+        (*result)[index[i]].value = JVariant::Long(
+            env->GetLongField(obj, field_ids[index[i]]));
+      }
+      return;
+
+    case JType::Float:
+      for (int i = begin; i < end; ++i) {
+        (*result)[index[i]].value = JVariant::Float(
+            env->GetFloatField(obj, field_ids[index[i]]));
+      }
+      return;
+
+    case JType::Double:
+      for (int i = begin; i < end; ++i) {
+        (*result)[index[i]].value = JVariant::Double(
+            env->GetDoubleField(obj, field_ids[index[i]]));
+      }
+      return;
+
+    case JType::Object:
+      for (int i = begin; i < end; ++i) {
+        (*result)[index[i]].value.attach_ref(
+            JVariant::ReferenceKind::Local,
+            env->GetObjectField(obj, field_ids[index[i]]));
+      }
+      return;
+  }
+}
+
+
 void GenericTypeEvaluator::Evaluate(
     MethodCaller* method_caller,
     const ClassMetadataReader::Entry& class_metadata,
     jobject obj,
     std::vector<NamedJVariant>* result) {
-  if (class_metadata.instance_fields.empty() &&
+  const ClassMetadataReader::Entry::InstanceFieldsLayout& layout =
+      class_metadata.instance_fields_layout;
+
+  if (layout.field_ids.empty() &&
       !class_metadata.instance_fields_omitted) {
     *result = std::vector<NamedJVariant>(1);
 
@@ -41,26 +136,28 @@ void GenericTypeEvaluator::Evaluate(
     return;
   }
 
-  *result = std::vector<NamedJVariant>(class_metadata.instance_fields.size());
-  for (int i = 0; i < class_metadata.instance_fields.size(); ++i) {
-    const InstanceFieldReader& field_reader =
-        *class_metadata.instance_fields[i];
-
+  const int count = layout.field_ids.size();
+  *result = std::vector<NamedJVariant>(count);
+  for (int i = 0; i < count; ++i) {
     NamedJVariant& field_data = (*result)[i];
+    field_data.name = *layout.names[i];
+    field_data.well_known_jclass = layout.well_known_jclasses[i];
+  }
 
-    field_data.name = field_reader.GetName();
-
-    if (!field_reader.ReadValue(obj, &field_data.value)) {
-      field_data.status.is_error = false;
-      field_data.status.refers_to =
-          StatusMessageModel::Context::VARIABLE_VALUE;
-      field_data.status.description = INTERNAL_ERROR_MESSAGE;
-    } else {
-      field_data.well_known_jclass =
-          WellKnownJClassFromSignature(field_reader.GetStaticType());
+  JNIEnv* env = jni();
+  for (int t = 0; t < TotalJTypes; ++t) {
+    const int begin = layout.type_begin[t];
+    const int end = layout.type_begin[t + 1];
+    if (begin < end) {
+      ReadInstanceFields(
+          env,
+          static_cast<JType>(t),
+          obj,
+          layout,
+          begin,
+          end,
+          result);
     }
-
-    field_data.value.change_ref_type(JVariant::ReferenceKind::Global);
   }
 
   if (class_metadata.instance_fields_omitted) {
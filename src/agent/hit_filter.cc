@@ -0,0 +1,204 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hit_filter.h"
+
+#include <cstdlib>
+#include <limits>
+#include "fast_clock.h"
+#include "jni_utils.h"
+#include "messages.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Breakpoint labels configuring the predicates (see "HitFilter").
+static constexpr char kSkipHitsLabel[] = "cdbg.skip_hits";
+static constexpr char kHitIntervalLabel[] = "cdbg.hit_interval";
+static constexpr char kThreadNameLabel[] = "cdbg.thread_name";
+static constexpr char kMaxThreadHitsPerSecLabel[] =
+    "cdbg.max_thread_hits_per_sec";
+
+// Number of slots in the per-thread table of hit rates. Must be a power of
+// 2. Breakpoints mapped to the same slot reset each other's count, which
+// can only let more hits through.
+constexpr int kThreadHitRateSlots = 16;
+
+// Hits of a single breakpoint on the current thread within one second.
+struct ThreadHitRateSlot {
+  // Filter counting the hits.
+  const HitFilter* owner;
+
+  // Second (in "FastClock" time) in which the hits were counted.
+  int64 second;
+
+  // Number of hits in "second".
+  int count;
+};
+
+static __thread ThreadHitRateSlot g_thread_hit_rates[kThreadHitRateSlots];
+
+// Hash of the name of the current thread (valid if
+// "g_has_thread_name_hash" is set). Thread names rarely change after the
+// thread starts, so the name is only read once per thread.
+static __thread uint64 g_thread_name_hash = 0;
+static __thread bool g_has_thread_name_hash = false;
+
+
+// FNV-1a hash of a thread name.
+static uint64 HashThreadName(const string& name) {
+  uint64 hash = 0xCBF29CE484222325ULL;
+  for (char ch : name) {
+    hash ^= static_cast<uint8>(ch);
+    hash *= 0x100000001B3ULL;
+  }
+
+  return hash;
+}
+
+
+// Parses the value of an integer label. Leaves "value" intact if the label
+// is not set.
+static bool ParseIntegerLabel(
+    const BreakpointModel& definition,
+    const char* name,
+    int64 min_value,
+    int64 max_value,
+    int64* value,
+    FormatMessageModel* error_message) {
+  auto it = definition.labels.find(name);
+  if (it == definition.labels.end()) {
+    return true;
+  }
+
+  char* end = nullptr;
+  const int64 parsed = strtoll(it->second.c_str(), &end, 10);  // NOLINT
+  if (it->second.empty() ||
+      (*end != '\0') ||
+      (parsed < min_value) ||
+      (parsed > max_value)) {
+    *error_message = {
+      InvalidBreakpointLabel,
+      { name, it->second, std::to_string(min_value) }
+    };
+    return false;
+  }
+
+  *value = parsed;
+  return true;
+}
+
+
+bool HitFilter::Initialize(
+    const BreakpointModel& definition,
+    FormatMessageModel* error_message) {
+  int64 max_thread_hits_per_sec = 0;
+  if (!ParseIntegerLabel(
+          definition,
+          kSkipHitsLabel,
+          0,
+          std::numeric_limits<int64>::max(),
+          &skip_hits_,
+          error_message) ||
+      !ParseIntegerLabel(
+          definition,
+          kHitIntervalLabel,
+          1,
+          std::numeric_limits<int64>::max(),
+          &hit_interval_,
+          error_message) ||
+      !ParseIntegerLabel(
+          definition,
+          kMaxThreadHitsPerSecLabel,
+          1,
+          std::numeric_limits<int>::max(),
+          &max_thread_hits_per_sec,
+          error_message)) {
+    return false;
+  }
+
+  max_thread_hits_per_sec_ = static_cast<int>(max_thread_hits_per_sec);
+
+  auto it = definition.labels.find(kThreadNameLabel);
+  if (it != definition.labels.end()) {
+    is_thread_name_set_ = true;
+    thread_name_hash_ = HashThreadName(it->second);
+  }
+
+  is_empty_ = (skip_hits_ == 0) &&
+              (hit_interval_ == 1) &&
+              !is_thread_name_set_ &&
+              (max_thread_hits_per_sec_ == 0);
+
+  return true;
+}
+
+
+bool HitFilter::IsHitAcceptedSlow(jthread thread) {
+  if (is_thread_name_set_ && !IsThreadAccepted(thread)) {
+    return false;
+  }
+
+  if ((skip_hits_ > 0) || (hit_interval_ > 1)) {
+    const int64 hit = hits_.fetch_add(1, std::memory_order_relaxed);
+    if ((hit < skip_hits_) || ((hit - skip_hits_) % hit_interval_ != 0)) {
+      return false;
+    }
+  }
+
+  if ((max_thread_hits_per_sec_ > 0) && !IsThreadRateAccepted()) {
+    return false;
+  }
+
+  return true;
+}
+
+
+bool HitFilter::IsThreadAccepted(jthread thread) const {
+  if (!g_has_thread_name_hash) {
+    g_thread_name_hash = HashThreadName(GetThreadName(thread));
+    g_has_thread_name_hash = true;
+  }
+
+  return g_thread_name_hash == thread_name_hash_;
+}
+
+
+bool HitFilter::IsThreadRateAccepted() const {
+  const int64 second = FastClock::NowNanos() / 1000000000;
+
+  const uint64 hash =
+      static_cast<uint64>(reinterpret_cast<uintptr_t>(this)) *
+      0x9E3779B97F4A7C15ULL;
+  ThreadHitRateSlot& slot =
+      g_thread_hit_rates[(hash >> 32) & (kThreadHitRateSlots - 1)];
+
+  if ((slot.owner != this) || (slot.second != second)) {
+    slot.owner = this;
+    slot.second = second;
+    slot.count = 0;
+  }
+
+  if (slot.count >= max_thread_hits_per_sec_) {
+    return false;
+  }
+
+  ++slot.count;
+  return true;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,96 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_HIT_FILTER_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_HIT_FILTER_H_
+
+#include <atomic>
+#include "common.h"
+#include "model.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Native predicates over breakpoint hits configured by breakpoint labels:
+//   "cdbg.skip_hits": ignore the first N hits.
+//   "cdbg.hit_interval": only take every Nth hit (after the skipped ones).
+//   "cdbg.thread_name": only take hits of the thread with this name.
+//   "cdbg.max_thread_hits_per_sec": only take up to N hits per second on
+//       each thread.
+// Users used to emulate these with conditions, which pay for the expression
+// evaluator on every hit. The predicates are checked before anything else
+// is done for the hit and without any locks or JNI calls (except for the
+// first hit of each thread when filtering by thread name, since the thread
+// name is cached per thread afterwards).
+//
+// "Initialize" must be called before any hit. "IsHitAccepted" is thread
+// safe.
+class HitFilter {
+ public:
+  HitFilter() { }
+
+  // Reads the predicates from the labels of "definition". Returns false and
+  // sets "error_message" if a label has an invalid value.
+  bool Initialize(
+      const BreakpointModel& definition,
+      FormatMessageModel* error_message);
+
+  // Returns true if no predicate is set.
+  bool IsEmpty() const { return is_empty_; }
+
+  // Checks the predicates on a hit of "thread".
+  bool IsHitAccepted(jthread thread) {
+    return is_empty_ || IsHitAcceptedSlow(thread);
+  }
+
+ private:
+  // Implementation of "IsHitAccepted" when some predicate is set.
+  bool IsHitAcceptedSlow(jthread thread);
+
+  // Checks whether "thread" has the name of "cdbg.thread_name".
+  bool IsThreadAccepted(jthread thread) const;
+
+  // Checks "cdbg.max_thread_hits_per_sec" for the current thread.
+  bool IsThreadRateAccepted() const;
+
+ private:
+  // Set if none of the predicates is set.
+  bool is_empty_ { true };
+
+  // Value of "cdbg.skip_hits" or 0.
+  int64 skip_hits_ { 0 };
+
+  // Value of "cdbg.hit_interval" or 1.
+  int64 hit_interval_ { 1 };
+
+  // Hash of "cdbg.thread_name" (if set).
+  bool is_thread_name_set_ { false };
+  uint64 thread_name_hash_ { 0 };
+
+  // Value of "cdbg.max_thread_hits_per_sec" or 0 if not limited.
+  int max_thread_hits_per_sec_ { 0 };
+
+  // Number of hits that passed the thread name predicate. Only counted if
+  // "cdbg.skip_hits" or "cdbg.hit_interval" is set.
+  std::atomic<int64> hits_ { 0 };
+
+  DISALLOW_COPY_AND_ASSIGN(HitFilter);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_HIT_FILTER_H_
@@ -0,0 +1,107 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hot_path_counters.h"
+
+#include <stdlib.h>
+#include <new>
+#include "statistician.h"
+
+namespace devtools {
+namespace cdbg {
+
+const HotPathStatisticians kBreakpointHitCounters = {
+  &statBreakpointHitAllocations,
+  &statBreakpointHitJniCalls,
+  &statBreakpointHitJvmtiCalls,
+  &statBreakpointHitGlobalRefs
+};
+
+const HotPathStatisticians kConditionCounters = {
+  &statConditionAllocations,
+  &statConditionJniCalls,
+  &statConditionJvmtiCalls,
+  &statConditionGlobalRefs
+};
+
+#ifdef CDBG_HOT_PATH_COUNTERS
+
+__thread HotPathCounters g_thread_hot_path_counters = { 0, 0, 0, 0 };
+
+
+// Adds a sample to the statistician if it has been initialized.
+static void AddHotPathSample(Statistician* statistician, int64 sample) {
+  if (statistician != nullptr) {
+    statistician->add(sample);
+  }
+}
+
+
+ScopedHotPathCounters::~ScopedHotPathCounters() {
+  const HotPathCounters& end = g_thread_hot_path_counters;
+
+  AddHotPathSample(
+      *statisticians_.allocations,
+      end.allocations - start_.allocations);
+  AddHotPathSample(
+      *statisticians_.jni_calls,
+      end.jni_calls - start_.jni_calls);
+  AddHotPathSample(
+      *statisticians_.jvmti_calls,
+      end.jvmti_calls - start_.jvmti_calls);
+  AddHotPathSample(
+      *statisticians_.global_refs,
+      end.global_refs - start_.global_refs);
+}
+
+#endif  // CDBG_HOT_PATH_COUNTERS
+
+}  // namespace cdbg
+}  // namespace devtools
+
+
+#ifdef CDBG_HOT_PATH_COUNTERS
+
+// The agent library doesn't export these symbols (see
+// cdbg_java_agent.lds), so only the allocations of the agent are counted.
+
+void* operator new(size_t size) {
+  CDBG_COUNT_HOT_PATH(allocations);
+
+  void* p = malloc(size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  return p;
+}
+
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+
+void operator delete[](void* p) noexcept {
+  free(p);
+}
+
+#endif  // CDBG_HOT_PATH_COUNTERS
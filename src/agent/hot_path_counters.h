@@ -0,0 +1,107 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_HOT_PATH_COUNTERS_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_HOT_PATH_COUNTERS_H_
+
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+class Statistician;
+
+// Instrumentation build mode (make HOT_PATH_COUNTERS=1) counting the heap
+// allocations, JNI calls, JVMTI calls and global references created by
+// the agent on hot paths (e.g. breakpoint hit with a false condition). The
+// counts are attributed to phases with "ScopedHotPathCounters" and reported
+// through the statisticians, so that the hot paths can be held to hard
+// targets like "no allocations if the condition is false".
+//
+// JNI and JVMTI calls are counted through the "jni()" and "jvmti()"
+// accessors, which the agent calls once per JNI/JVMTI function call.
+// Allocations are counted by replacing the global "operator new" of the
+// agent library.
+//
+// In regular builds all of this compiles to nothing.
+
+// Counters of the current thread. Only increase.
+struct HotPathCounters {
+  int64 allocations;
+  int64 jni_calls;
+  int64 jvmti_calls;
+  int64 global_refs;
+};
+
+// Statisticians receiving the counts of a single phase.
+struct HotPathStatisticians {
+  Statistician** allocations;
+  Statistician** jni_calls;
+  Statistician** jvmti_calls;
+  Statistician** global_refs;
+};
+
+// Counts of the breakpoint hit (including condition evaluation).
+extern const HotPathStatisticians kBreakpointHitCounters;
+
+// Counts of the breakpoint condition evaluation.
+extern const HotPathStatisticians kConditionCounters;
+
+#ifdef CDBG_HOT_PATH_COUNTERS
+
+extern __thread HotPathCounters g_thread_hot_path_counters;
+
+// Increments counter of the current thread (e.g. "jni_calls").
+#define CDBG_COUNT_HOT_PATH(counter) \
+    (++devtools::cdbg::g_thread_hot_path_counters.counter)
+
+// Reports the counts accumulated by the current thread from construction
+// to destruction of this object to the statisticians of the phase.
+class ScopedHotPathCounters {
+ public:
+  explicit ScopedHotPathCounters(const HotPathStatisticians& statisticians)
+      : statisticians_(statisticians),
+        start_(g_thread_hot_path_counters) {
+  }
+
+  ~ScopedHotPathCounters();
+
+ private:
+  const HotPathStatisticians& statisticians_;
+  const HotPathCounters start_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedHotPathCounters);
+};
+
+#else  // CDBG_HOT_PATH_COUNTERS
+
+#define CDBG_COUNT_HOT_PATH(counter)
+
+class ScopedHotPathCounters {
+ public:
+  explicit ScopedHotPathCounters(const HotPathStatisticians& statisticians) {
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ScopedHotPathCounters);
+};
+
+#endif  // CDBG_HOT_PATH_COUNTERS
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_HOT_PATH_COUNTERS_H_
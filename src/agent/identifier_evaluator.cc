@@ -96,6 +96,10 @@ bool IdentifierEvaluator::Compile(
     result_type_ = static_field_reader_->GetStaticType();
     computer_ = &IdentifierEvaluator::StaticFieldComputer;
 
+    if (static_field_reader_->ReadConstantValue(&static_value_)) {
+      computer_ = &IdentifierEvaluator::StaticValueComputer;
+    }
+
     return true;
   }
 
@@ -180,6 +184,12 @@ ErrorOr<JVariant> IdentifierEvaluator::StaticFieldComputer(
   return std::move(result);
 }
 
+
+ErrorOr<JVariant> IdentifierEvaluator::StaticValueComputer(
+    const EvaluationContext& evaluation_context) const {
+  return JVariant(static_value_);
+}
+
 }  // namespace cdbg
 }  // namespace devtools
 
@@ -19,6 +19,7 @@
 
 #include "common.h"
 #include "expression_evaluator.h"
+#include "expression_program.h"
 
 namespace devtools {
 namespace cdbg {
@@ -41,7 +42,25 @@ class IdentifierEvaluator : public ExpressionEvaluator {
 
   const JSignature& GetStaticType() const override { return result_type_; }
 
-  Nullable<jvalue> GetStaticValue() const override { return nullptr; }
+  Nullable<jvalue> GetStaticValue() const override {
+    if (static_value_.type() != JType::Void) {
+      return static_value_.get_jvalue();
+    }
+
+    return nullptr;
+  }
+
+  bool HasMethodCalls() const override { return false; }
+
+  int Lower(ExpressionProgramBuilder* builder) const override {
+    if (static_value_.type() != JType::Void) {
+      return builder->AddConstant(
+          static_value_.type(),
+          static_value_.get_jvalue());
+    }
+
+    return builder->AddLeaf(*this);
+  }
 
   ErrorOr<JVariant> Evaluate(
       const EvaluationContext& evaluation_context) const override;
@@ -67,6 +86,11 @@ class IdentifierEvaluator : public ExpressionEvaluator {
   ErrorOr<JVariant> StaticFieldComputer(
       const EvaluationContext& evaluation_context) const;
 
+  // Evaluation method when the expression refers to a "static final" field
+  // whose value was read at compile time.
+  ErrorOr<JVariant> StaticValueComputer(
+      const EvaluationContext& evaluation_context) const;
+
  private:
   // Name of the identifier (whether it is local variable or something else).
   string identifier_name_;
@@ -92,6 +116,10 @@ class IdentifierEvaluator : public ExpressionEvaluator {
   // computer_ is supposed product.
   JSignature result_type_;
 
+  // Value of a constant static field read at compile time or void if the
+  // field is read on each evaluation.
+  JVariant static_value_;
+
   DISALLOW_COPY_AND_ASSIGN(IdentifierEvaluator);
 };
 
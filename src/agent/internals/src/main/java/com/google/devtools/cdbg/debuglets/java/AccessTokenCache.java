@@ -0,0 +1,262 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.google.devtools.cdbg.debuglets.java;
+
+import java.util.concurrent.Executors;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.ScheduledExecutorService;
+import java.util.concurrent.ScheduledFuture;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Caches OAuth access token and refreshes it in the background before it expires.
+ *
+ * <p>The token is shared by all the threads calling the backend (hanging get and breakpoint
+ * updates). The token is only fetched on the calling thread if there is no valid token at all,
+ * which happens on the first call or if the background refresh kept failing until the token
+ * expired. Otherwise the calls to the backend never wait for the token refresh.
+ *
+ * <p>This class is thread safe.
+ */
+final class AccessTokenCache {
+  /**
+   * Access token returned by {@link Source}.
+   */
+  static final class Token {
+    private final String accessToken;
+    private final long expiresInSec;
+
+    /**
+     * Class constructor.
+     *
+     * @param accessToken OAuth access token
+     * @param expiresInSec remaining lifetime of the token in seconds or 0 if not known
+     */
+    Token(String accessToken, long expiresInSec) {
+      this.accessToken = accessToken;
+      this.expiresInSec = expiresInSec;
+    }
+  }
+
+  /**
+   * Obtains new access tokens.
+   */
+  interface Source {
+    /**
+     * Fetches new access token. Called either from the thread calling
+     * {@link AccessTokenCache#get()} or from the background refresh thread. The calls are
+     * serialized.
+     *
+     * @return new access token or null in case of a failure
+     */
+    Token fetch();
+  }
+
+  /**
+   * Time before the token expiration when the background refresh starts.
+   */
+  private static final int REFRESH_AHEAD_SEC = 300;
+
+  /**
+   * Delay before retrying a failed background refresh.
+   */
+  private static final int RETRY_DELAY_SEC = 10;
+
+  /**
+   * Obtains new access tokens.
+   */
+  private final Source source;
+
+  /**
+   * Minimal remaining lifetime of the cached token before it is considered expired.
+   */
+  private final int expirationBufferSec;
+
+  /**
+   * Serializes calls to {@link Source#fetch()}. Unlike the lock of this object, it is held by
+   * the background refresh, so that the cached token can be read while it is in progress.
+   */
+  private final Object fetchLock = new Object();
+
+  /**
+   * Cached access token or null if not available.
+   */
+  private String accessToken = null;
+
+  /**
+   * Absolute expiration time of {@link #accessToken} in seconds since Unix epoch.
+   */
+  private long accessTokenExpirationTime = 0;
+
+  /**
+   * Single thread running the background refresh. Created when the first token with known
+   * expiration time is fetched.
+   */
+  private ScheduledExecutorService refreshExecutor = null;
+
+  /**
+   * Next scheduled background refresh or null if none.
+   */
+  private ScheduledFuture<?> pendingRefresh = null;
+
+  /**
+   * Set once {@link #shutdown()} is called.
+   */
+  private boolean isShutdown = false;
+
+  /**
+   * Class constructor.
+   *
+   * @param source obtains new access tokens
+   * @param expirationBufferSec minimal remaining lifetime of the cached token before it is
+   *     considered expired
+   */
+  AccessTokenCache(Source source, int expirationBufferSec) {
+    this.source = source;
+    this.expirationBufferSec = expirationBufferSec;
+  }
+
+  /**
+   * Gets the cached access token fetching it first if there is no valid token.
+   *
+   * @return OAuth access token or empty string if one could not be obtained
+   */
+  synchronized String get() {
+    if (!isValid()) {
+      // If we fail to fetch the access token, we just leave the last value. It might be still
+      // valid. Worst case the HTTP request that will be using the token will fail with 403.
+      Token token;
+      synchronized (fetchLock) {
+        token = source.fetch();
+      }
+
+      update(token);
+    }
+
+    return (accessToken == null) ? "" : accessToken;
+  }
+
+  /**
+   * Stops the background refresh.
+   */
+  synchronized void shutdown() {
+    isShutdown = true;
+
+    if (refreshExecutor != null) {
+      refreshExecutor.shutdownNow();
+      refreshExecutor = null;
+      pendingRefresh = null;
+    }
+  }
+
+  /**
+   * Returns true if the cached token can still be used. Must be called with the lock held.
+   */
+  private boolean isValid() {
+    long currentTime = System.currentTimeMillis() / 1000;
+    return (accessToken != null)
+        && (currentTime + expirationBufferSec < accessTokenExpirationTime);
+  }
+
+  /**
+   * Stores a newly fetched token and schedules its background refresh. Must be called with the
+   * lock held.
+   *
+   * @param token newly fetched token or null if the fetch failed
+   */
+  private void update(Token token) {
+    if ((token == null) || (token.accessToken == null) || token.accessToken.isEmpty()) {
+      return;
+    }
+
+    accessToken = token.accessToken;
+
+    if (token.expiresInSec <= 0) {
+      // Without the expiration time the token is fetched again on the next call.
+      accessTokenExpirationTime = 0;
+      return;
+    }
+
+    accessTokenExpirationTime = System.currentTimeMillis() / 1000 + token.expiresInSec;
+
+    // Refresh well before the token expires, but not more often than every half of the token
+    // lifetime if the token is short lived.
+    long delaySec = Math.max(token.expiresInSec - REFRESH_AHEAD_SEC, token.expiresInSec / 2);
+    scheduleRefresh(delaySec);
+  }
+
+  /**
+   * Schedules the background refresh replacing the one scheduled before (if any). Must be called
+   * with the lock held.
+   */
+  private void scheduleRefresh(long delaySec) {
+    if (isShutdown) {
+      return;
+    }
+
+    if (pendingRefresh != null) {
+      pendingRefresh.cancel(false);
+      pendingRefresh = null;
+    }
+
+    if (refreshExecutor == null) {
+      refreshExecutor = Executors.newSingleThreadScheduledExecutor(new ThreadFactory() {
+        @Override
+        public Thread newThread(Runnable runnable) {
+          Thread thread = new Thread(runnable, "CloudDebugger_token_refresh");
+          thread.setDaemon(true);
+          return thread;
+        }
+      });
+    }
+
+    try {
+      pendingRefresh = refreshExecutor.schedule(
+          new Runnable() {
+            @Override
+            public void run() {
+              refresh();
+            }
+          },
+          delaySec,
+          TimeUnit.SECONDS);
+    } catch (RejectedExecutionException e) {
+      // Shutdown in progress.
+    }
+  }
+
+  /**
+   * Fetches a new token on the background thread. The token is fetched without holding the lock,
+   * so the cached token remains available to other threads in the meantime.
+   */
+  private void refresh() {
+    Token token;
+    synchronized (fetchLock) {
+      token = source.fetch();
+    }
+
+    synchronized (this) {
+      if ((token == null) || (token.accessToken == null) || token.accessToken.isEmpty()) {
+        scheduleRefresh(RETRY_DELAY_SEC);
+        return;
+      }
+
+      update(token);
+    }
+  }
+}
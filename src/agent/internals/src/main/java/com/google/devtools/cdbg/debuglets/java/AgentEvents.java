@@ -0,0 +1,160 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.google.devtools.cdbg.debuglets.java;
+
+import java.lang.reflect.Constructor;
+import java.lang.reflect.Method;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * Emits Java Flight Recorder events for the work done by the agent native code (breakpoint
+ * hits, condition evaluation, capture, class prepare handling and so on), so that the debugger
+ * overhead shows up in the recordings next to GC and JIT activity.
+ *
+ * <p>The agent is compiled against Java 7, so the JFR API (Java 11+) is only accessed through
+ * reflection. A single dynamic event type ({@code com.google.cdbg.AgentOverhead}) is created on
+ * first use. If JFR is not available, {@link #isAvailable()} returns false and the native code
+ * doesn't send any events.
+ */
+final class AgentEvents {
+  private static final String EVENT_NAME = "com.google.cdbg.AgentOverhead";
+
+  /**
+   * Indexes of the event fields (in the order passed to {@code EventFactory.create}).
+   */
+  private static final int PHASE_FIELD = 0;
+  private static final int BREAKPOINT_ID_FIELD = 1;
+  private static final int DURATION_FIELD = 2;
+
+  /**
+   * Instance of {@code jdk.jfr.EventFactory} or null if JFR is not available.
+   */
+  private static final Object eventFactory;
+
+  private static final Method newEventMethod;
+  private static final Method setMethod;
+  private static final Method shouldCommitMethod;
+  private static final Method commitMethod;
+
+  static {
+    Object factory = null;
+    Method newEvent = null;
+    Method set = null;
+    Method shouldCommit = null;
+    Method commit = null;
+
+    try {
+      Class<?> annotationElementClass = Class.forName("jdk.jfr.AnnotationElement");
+      Class<?> valueDescriptorClass = Class.forName("jdk.jfr.ValueDescriptor");
+      Class<?> eventFactoryClass = Class.forName("jdk.jfr.EventFactory");
+      Class<?> eventClass = Class.forName("jdk.jfr.Event");
+
+      Constructor<?> newAnnotation =
+          annotationElementClass.getConstructor(Class.class, Object.class);
+      Constructor<?> newValueDescriptor =
+          valueDescriptorClass.getConstructor(Class.class, String.class, List.class);
+
+      List<Object> eventAnnotations = new ArrayList<>();
+      eventAnnotations.add(newAnnotation.newInstance(Class.forName("jdk.jfr.Name"), EVENT_NAME));
+      eventAnnotations.add(
+          newAnnotation.newInstance(Class.forName("jdk.jfr.Label"), "Cloud Debugger Overhead"));
+      eventAnnotations.add(
+          newAnnotation.newInstance(
+              Class.forName("jdk.jfr.Category"), new String[] {"Cloud Debugger"}));
+
+      List<Object> fields = new ArrayList<>();
+      fields.add(
+          newValueDescriptor.newInstance(
+              String.class,
+              "phase",
+              Arrays.asList(
+                  newAnnotation.newInstance(Class.forName("jdk.jfr.Label"), "Phase"))));
+      fields.add(
+          newValueDescriptor.newInstance(
+              String.class,
+              "breakpointId",
+              Arrays.asList(
+                  newAnnotation.newInstance(Class.forName("jdk.jfr.Label"), "Breakpoint ID"))));
+      fields.add(
+          newValueDescriptor.newInstance(
+              long.class,
+              "duration",
+              Arrays.asList(
+                  newAnnotation.newInstance(Class.forName("jdk.jfr.Label"), "Duration"),
+                  newAnnotation.newInstance(Class.forName("jdk.jfr.Timespan"), "NANOSECONDS"))));
+
+      factory =
+          eventFactoryClass
+              .getMethod("create", List.class, List.class)
+              .invoke(null, eventAnnotations, fields);
+      newEvent = eventFactoryClass.getMethod("newEvent");
+      set = eventClass.getMethod("set", int.class, Object.class);
+      shouldCommit = eventClass.getMethod("shouldCommit");
+      commit = eventClass.getMethod("commit");
+    } catch (Throwable t) {
+      // JFR is not available in this JVM (or is disabled).
+      factory = null;
+    }
+
+    eventFactory = factory;
+    newEventMethod = newEvent;
+    setMethod = set;
+    shouldCommitMethod = shouldCommit;
+    commitMethod = commit;
+  }
+
+  /**
+   * Returns true if JFR events can be emitted in this JVM.
+   */
+  public static boolean isAvailable() {
+    return eventFactory != null;
+  }
+
+  /**
+   * Emits a batch of events prepared by the native code.
+   *
+   * <p>The arrays are allocated once and reused for all the batches, so only the first
+   * {@code count} elements are valid. The events are committed when the batch is emitted, so
+   * their timestamps are the time of the emission and the duration of the agent work is carried
+   * in the {@code duration} field.
+   */
+  public static void emitBatch(
+      String[] phases, String[] breakpointIds, long[] durations, int count) {
+    if (eventFactory == null) {
+      return;
+    }
+
+    try {
+      for (int i = 0; i < count; ++i) {
+        Object event = newEventMethod.invoke(eventFactory);
+        if (!(Boolean) shouldCommitMethod.invoke(event)) {
+          // No recording is running (or the event is disabled).
+          return;
+        }
+
+        setMethod.invoke(event, PHASE_FIELD, phases[i]);
+        setMethod.invoke(event, BREAKPOINT_ID_FIELD, breakpointIds[i]);
+        setMethod.invoke(event, DURATION_FIELD, durations[i]);
+        commitMethod.invoke(event);
+      }
+    } catch (ReflectiveOperationException e) {
+      // Ignore, same as if the events were disabled.
+    }
+  }
+}
@@ -63,12 +63,17 @@ final class ClassPathLookup {
    */
   private final String[] extraClassPath;
   
+  /**
+   * Location of the primary debugger configuration file or null to use the embedded resource.
+   */
+  private final String configLocation;
+
   /**
    * The whitelist/blacklist that will be used to determine if a method can be called, without using
    * bytecode analysis. Any method not whitelisted or blacklisted by the filter will have its
-   * bytecode analyzed.
+   * bytecode analyzed. Only loaded on first use (see {@link #getMethodsFilter()}).
    */
-  private final MethodsFilter methodsFilter;
+  private MethodsFilter methodsFilter;
 
   /**
    * Indexes resources (.class files and other files) that the application may load.
@@ -77,7 +82,8 @@ final class ClassPathLookup {
 
   /**
    * Indexes classes available to the application. Each instance of {@link ClassResourcesIndexer}
-   * corresponds to a different source (e.g. different .jar file).
+   * corresponds to a different source (e.g. different .jar file). Only built on first use (see
+   * {@link #getClassResourcesIndexers()}).
    */
   private Collection<ClassResourcesIndexer> classResourcesIndexers;
   
@@ -108,42 +114,13 @@ final class ClassPathLookup {
 
     this.useDefaultClassPath = useDefaultClassPath;
     this.extraClassPath = extraClassPath;
+    this.configLocation = configLocation;
 
-    MethodsFilter.Builder configBuilder = new MethodsFilter.Builder();
-
-    // Primary configuration (either in file or resource).
-    // TODO(vlif): XML based configuration is deprecated. Remove this code when native agent
-    // doesn't need it anymore.
-    try {
-      if ((configLocation == null) || configLocation.isEmpty()) {
-        InputStream inputStream = getClass().getResourceAsStream("cdbg_config.xml");
-        if (inputStream != null) {
-          configBuilder.add(inputStream);
-        }
-      } else {
-        configBuilder.add(new FileInputStream(configLocation));
-      }
-    } catch (Exception e) {
-      warnfmt(e, "Debugger configuration file could not be loaded");
-    }
-
-    // Optional secondary configuration (used primarily in tests).
-    String secondaryConfigLocation = System.getProperty("com.google.cdbg.secondaryconfig");
-    if ((secondaryConfigLocation != null) && !secondaryConfigLocation.isEmpty()) {
-      try {
-        configBuilder.add(getClass().getResourceAsStream(secondaryConfigLocation));
-      } catch (Exception e) {
-        warnfmt(e, "Secondary configuration file could not be loaded from %s",
-            secondaryConfigLocation);
-      }
-    }
-
-    this.methodsFilter = configBuilder.build();
-
+    // Only the resources are indexed upfront, because they are needed to compute the debuggee
+    // uniquifier during registration. Class name indexes and the methods filter (used by
+    // SafeTransformer and MethodAnalyzer) are built on first use.
     indexApplicationResources();
 
-    SafeTransformer.setConfig(this.methodsFilter);
-
     // TODO(vlif): GcpHubClient needs ClassPathLookup to compute uniquifier. This needs to
     // be refactored. Either GcpHubClient should not require ClassPathLookup or ClassPathLookup
     // should become static.
@@ -196,7 +173,7 @@ final class ClassPathLookup {
     // Retrieve the class resources matching the source file. There might be several of those
     // if the source file contains inner or static classes or multiple outer classes.
     Collection<InputStream> resources = new ArrayList<>();
-    for (ClassResourcesIndexer indexer : classResourcesIndexers) {
+    for (ClassResourcesIndexer indexer : getClassResourcesIndexers()) {
       Collection<String> resourcePaths = indexer.mapSourceFile(sourcePath);
       if (resourcePaths != null) {
         for (String resourcePath : resourcePaths) {
@@ -228,7 +205,7 @@ final class ClassPathLookup {
    * @return list of matches or null or empty array if not found.
    */
   public String[] findClassesByName(String classTypeName) {
-    for (ClassResourcesIndexer indexer : classResourcesIndexers) {
+    for (ClassResourcesIndexer indexer : getClassResourcesIndexers()) {
       String[] rc = indexer.findClassesByName(classTypeName);
       if ((rc != null) && (rc.length > 0)) {
         return rc;
@@ -245,6 +222,9 @@ final class ClassPathLookup {
    * <p>The caller can't handle any errors, so this function silently swallows all problems,
    * returning the best result it can get.
    *
+   * <p>The result is cached on disk (see {@link UniquifierCache}), so the application files are
+   * only hashed again if any of them changed since the previous start.
+   *
    * @param initializationVector initialization vector for the hash computation to further randomize
    *        different deployments that have exactly the same binary. For example AppEngine debuglet
    *        sets this parameter to concatenated strings of project ID, module, major version and
@@ -261,8 +241,9 @@ final class ClassPathLookup {
       }
     }
     
-    UniquifierComputer computer = new UniquifierComputer(initializationVector, applicationFiles);
-    return computer.getUniquifier();
+    return UniquifierCache.fromSystemProperties().getUniquifier(
+        initializationVector,
+        applicationFiles);
   }
 
   /**
@@ -373,6 +354,73 @@ final class ClassPathLookup {
     return resourceStream;
   }
 
+  /**
+   * Gets the whitelist/blacklist of methods, loading the debugger configuration on first call.
+   */
+  synchronized MethodsFilter getMethodsFilter() {
+    if (methodsFilter != null) {
+      return methodsFilter;
+    }
+
+    long startTime = System.nanoTime();
+
+    MethodsFilter.Builder configBuilder = new MethodsFilter.Builder();
+
+    // Primary configuration (either in file or resource).
+    // TODO(vlif): XML based configuration is deprecated. Remove this code when native agent
+    // doesn't need it anymore.
+    try {
+      if ((configLocation == null) || configLocation.isEmpty()) {
+        InputStream inputStream = getClass().getResourceAsStream("cdbg_config.xml");
+        if (inputStream != null) {
+          configBuilder.add(inputStream);
+        }
+      } else {
+        configBuilder.add(new FileInputStream(configLocation));
+      }
+    } catch (Exception e) {
+      warnfmt(e, "Debugger configuration file could not be loaded");
+    }
+
+    // Optional secondary configuration (used primarily in tests).
+    String secondaryConfigLocation = System.getProperty("com.google.cdbg.secondaryconfig");
+    if ((secondaryConfigLocation != null) && !secondaryConfigLocation.isEmpty()) {
+      try {
+        configBuilder.add(getClass().getResourceAsStream(secondaryConfigLocation));
+      } catch (Exception e) {
+        warnfmt(e, "Secondary configuration file could not be loaded from %s",
+            secondaryConfigLocation);
+      }
+    }
+
+    methodsFilter = configBuilder.build();
+
+    infofmt("Debugger configuration loaded in %d ms", (System.nanoTime() - startTime) / 1000000);
+
+    return methodsFilter;
+  }
+
+  /**
+   * Gets the class name indexes of all the application resources, building them on first call.
+   */
+  private synchronized Collection<ClassResourcesIndexer> getClassResourcesIndexers() {
+    if (classResourcesIndexers != null) {
+      return classResourcesIndexers;
+    }
+
+    long startTime = System.nanoTime();
+
+    Collection<ClassResourcesIndexer> indexers = new ArrayList<>();
+    for (ResourcesSource source : resourceIndexer.getSources()) {
+      indexers.add(new ClassResourcesIndexer(source));
+    }
+
+    infofmt("Application classes indexed in %d ms", (System.nanoTime() - startTime) / 1000000);
+
+    classResourcesIndexers = indexers;
+    return classResourcesIndexers;
+  }
+
   /**
    * Tries to figure out additional directories where application class might be.
    *
@@ -445,10 +493,10 @@ final class ClassPathLookup {
       effectiveClassPath.addAll(Arrays.asList(extraClassPath));
     }
 
+    long startTime = System.nanoTime();
+
     resourceIndexer = new ResourceIndexer(effectiveClassPath);
-    classResourcesIndexers = new ArrayList<>();
-    for (ResourcesSource source : resourceIndexer.getSources()) {
-      classResourcesIndexers.add(new ClassResourcesIndexer(source));
-    }
+
+    infofmt("Application resources indexed in %d ms", (System.nanoTime() - startTime) / 1000000);
   }
 }
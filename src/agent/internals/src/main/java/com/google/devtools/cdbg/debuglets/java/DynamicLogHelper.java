@@ -44,5 +44,31 @@ final class DynamicLogHelper {
   public static Level getSevereLevel() {
     return Level.SEVERE;
   }
+
+  /**
+   * Writes a batch of dynamic log records prepared by the native code.
+   *
+   * <p>The arrays are allocated once and reused for all the batches, so only the first
+   * {@code count} elements are valid. The messages are cleared once written so that the arrays
+   * don't keep them alive until the next batch. A failure of one record doesn't prevent the
+   * rest of the batch from being written.
+   */
+  public static void logBatch(
+      Logger logger,
+      Level[] levels,
+      String[] sourceClasses,
+      String[] sourceMethods,
+      String[] messages,
+      int count) {
+    for (int i = 0; i < count; ++i) {
+      try {
+        logger.logp(levels[i], sourceClasses[i], sourceMethods[i], messages[i]);
+      } catch (RuntimeException e) {
+        // Ignore failures of the application log handlers, same as for a single record.
+      } finally {
+        messages[i] = null;
+      }
+    }
+  }
 }
 
@@ -35,5 +35,22 @@ final class FormatMessage {
   public String[] getParameters() {
     return parameters;
   }
+
+  /**
+   * Packs the format and the parameters into a single array, so that the native code reads the
+   * message with a single method call.
+   *
+   * @return array with the format followed by the parameters
+   */
+  public String[] pack() {
+    int parametersCount = (parameters == null) ? 0 : parameters.length;
+    String[] packed = new String[1 + parametersCount];
+    packed[0] = format;
+    if (parametersCount > 0) {
+      System.arraycopy(parameters, 0, packed, 1, parametersCount);
+    }
+
+    return packed;
+  }
 }
 
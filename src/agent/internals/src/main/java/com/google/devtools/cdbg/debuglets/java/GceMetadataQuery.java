@@ -25,14 +25,22 @@ import com.google.gson.JsonSyntaxException;
 import com.google.gson.annotations.SerializedName;
 
 import java.io.ByteArrayOutputStream;
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
 import java.io.IOException;
 import java.io.InputStream;
+import java.io.OutputStream;
 import java.net.HttpURLConnection;
 import java.net.MalformedURLException;
 import java.net.URL;
 import java.net.URLConnection;
 import java.util.ArrayList;
 import java.util.List;
+import java.util.Properties;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.FutureTask;
 
 /**
  * Reads project and auth token from GCE metadata service.
@@ -79,6 +87,12 @@ public final class GceMetadataQuery implements MetadataQuery {
   static final String DEFAULT_LOCAL_METADATA_SERVICE_BASE =
       "http://metadata.google.internal/computeMetadata/v1/";
   
+  /**
+   * Maximum age of the metadata cache file. Restarts of the application within this time
+   * don't need to query the project attributes.
+   */
+  static final int CACHE_FILE_TTL_SEC = 600;
+
   /**
    * JSON deserializer to read access token.
    */
@@ -111,14 +125,22 @@ public final class GceMetadataQuery implements MetadataQuery {
   private String projectNumber = null;
 
   /**
-   * Cached OAuth access token for account authentication.
+   * Set once the access token query started along with the project attributes.
    */
-  private String accessToken = null;
-  
+  private boolean isAccessTokenPrefetched = false;
+
   /**
-   * Absolute expiration time of the "access_token_" in seconds since Unix epoch.
+   * Cached OAuth access token for account authentication refreshed in the background.
    */
-  private long accessTokenExpirationTime = 0;
+  private final AccessTokenCache accessTokenCache =
+      new AccessTokenCache(
+          new AccessTokenCache.Source() {
+            @Override
+            public AccessTokenCache.Token fetch() {
+              return queryAccessToken();
+            }
+          },
+          CACHE_BUFFER_SEC);
 
   public GceMetadataQuery() throws MalformedURLException {
     this(new URL(System.getProperty("com.google.cdbg.metadataservicebase",
@@ -132,39 +154,30 @@ public final class GceMetadataQuery implements MetadataQuery {
   @Override
   public synchronized String getProjectId() {
     if (projectId == null) {
-      try {
-        projectId = queryMetadataAttribute("project/project-id");
-      } catch (IOException e) {
-        warnfmt(e, "Failed to query GCE metadata service");
-        return "";
-      }
+      prefetch();
     }
     
-    return projectId;
+    return (projectId == null) ? "" : projectId;
   }
 
   @Override
   public synchronized String getProjectNumber() {
     if (projectNumber == null) {
-      try {
-        projectNumber = queryMetadataAttribute("project/numeric-project-id");
-      } catch (IOException e) {
-        warnfmt(e, "Failed to query GCE metadata service");
-        return "";
-      }
+      prefetch();
     }
     
-    return projectNumber;
+    return (projectNumber == null) ? "" : projectNumber;
   }
 
   @Override
-  public synchronized String getAccessToken() {
-    lazyQueryAccessToken();
-    return (accessToken == null) ? "" : accessToken;
+  public String getAccessToken() {
+    return accessTokenCache.get();
   }
   
   @Override
   public void shutdown() {
+    accessTokenCache.shutdown();
+
     List<HttpURLConnection> connections;
     
     synchronized (activeConnections) {
@@ -178,25 +191,192 @@ public final class GceMetadataQuery implements MetadataQuery {
   }
 
   /**
-   * Reads OAuth access token unless the cached value is still valid.
+   * Queries the project attributes that are not cached yet in parallel, along with the access
+   * token. Registration of the debuggee needs all of them, so querying them one at a time would
+   * add up the latency of several round trips to the metadata service.
+   *
+   * <p>Must be called with the lock held.
    */
-  void lazyQueryAccessToken() {
-    long startTime = System.currentTimeMillis() / 1000;  // epoch time 
-    
-    if ((accessToken != null)
-        && (startTime + CACHE_BUFFER_SEC < accessTokenExpirationTime)) {
-      return;  // The cache is still valid.
+  private void prefetch() {
+    if ((projectId == null) || (projectNumber == null)) {
+      readCacheFile();
     }
-    
-    // If we fail to query the access token, we just leave the last value. It
-    // might be still valid. Worst case the HTTP request that will be using the
-    // token will fail with 403.
+
+    if (!isAccessTokenPrefetched) {
+      isAccessTokenPrefetched = true;
+
+      // Nobody waits for this thread. The first request to the backend picks up the token from
+      // the cache (waiting for the query to complete if it's still in progress).
+      startThread(new Runnable() {
+        @Override
+        public void run() {
+          accessTokenCache.get();
+        }
+      });
+    }
+
+    FutureTask<String> projectIdQuery =
+        (projectId == null) ? startQuery("project/project-id") : null;
+    FutureTask<String> projectNumberQuery =
+        (projectNumber == null) ? startQuery("project/numeric-project-id") : null;
+
+    boolean isUpdated = false;
+
+    if (projectIdQuery != null) {
+      projectId = waitForQuery(projectIdQuery);
+      isUpdated |= (projectId != null);
+    }
+
+    if (projectNumberQuery != null) {
+      projectNumber = waitForQuery(projectNumberQuery);
+      isUpdated |= (projectNumber != null);
+    }
+
+    if (isUpdated) {
+      writeCacheFile();
+    }
+  }
+
+  /**
+   * Starts querying a single attribute of a local metadata service on a new thread.
+   */
+  private FutureTask<String> startQuery(final String attributePath) {
+    FutureTask<String> query = new FutureTask<>(new Callable<String>() {
+      @Override
+      public String call() throws IOException {
+        return queryMetadataAttribute(attributePath);
+      }
+    });
+
+    startThread(query);
+    return query;
+  }
+
+  /**
+   * Waits for the metadata query started by {@link #startQuery(String)} to complete.
+   *
+   * @return value of the metadata attribute or null in case of a failure
+   */
+  private static String waitForQuery(FutureTask<String> query) {
+    try {
+      return query.get();
+    } catch (ExecutionException e) {
+      warnfmt(e.getCause(), "Failed to query GCE metadata service");
+    } catch (InterruptedException e) {
+      Thread.currentThread().interrupt();
+    }
+
+    return null;
+  }
+
+  /**
+   * Runs a metadata query on a new daemon thread.
+   */
+  private static void startThread(Runnable runnable) {
+    Thread thread = new Thread(runnable, "CloudDebugger_metadata");
+    thread.setDaemon(true);
+    thread.start();
+  }
+
+  /**
+   * Gets the metadata cache file set through system property or null if the file cache is
+   * disabled (default).
+   */
+  private static File getCacheFile() {
+    String path = System.getProperty("com.google.cdbg.metadatacachefile");
+    if ((path == null) || path.isEmpty()) {
+      return null;
+    }
+
+    return new File(path);
+  }
+
+  /**
+   * Loads the project attributes from the metadata cache file unless the file is too old. Only
+   * the project attributes are cached. The access token is never written to disk.
+   *
+   * <p>Must be called with the lock held.
+   */
+  private void readCacheFile() {
+    File file = getCacheFile();
+    if ((file == null) || !file.isFile()) {
+      return;
+    }
+
+    long ageMs = System.currentTimeMillis() - file.lastModified();
+    if ((ageMs < 0) || (ageMs > CACHE_FILE_TTL_SEC * 1000L)) {
+      return;
+    }
+
+    Properties properties = new Properties();
+    try (InputStream inputStream = new FileInputStream(file)) {
+      properties.load(inputStream);
+    } catch (IOException e) {
+      warnfmt(e, "Failed to read metadata cache file %s", file);
+      return;
+    }
+
+    String cachedProjectId = properties.getProperty("project-id", "");
+    if ((projectId == null) && !cachedProjectId.isEmpty()) {
+      projectId = cachedProjectId;
+    }
+
+    String cachedProjectNumber = properties.getProperty("numeric-project-id", "");
+    if ((projectNumber == null) && !cachedProjectNumber.isEmpty()) {
+      projectNumber = cachedProjectNumber;
+    }
+  }
+
+  /**
+   * Writes the project attributes to the metadata cache file. The file is replaced atomically,
+   * so that processes starting at the same time never see it partially written.
+   *
+   * <p>Must be called with the lock held.
+   */
+  private void writeCacheFile() {
+    File file = getCacheFile();
+    if ((file == null) || (projectId == null) || (projectNumber == null)) {
+      return;
+    }
+
+    Properties properties = new Properties();
+    properties.setProperty("project-id", projectId);
+    properties.setProperty("numeric-project-id", projectNumber);
+
+    File tempFile = null;
+    try {
+      tempFile = File.createTempFile(
+          "cdbg_metadata_", ".tmp", file.getAbsoluteFile().getParentFile());
+      try (OutputStream outputStream = new FileOutputStream(tempFile)) {
+        properties.store(outputStream, null);
+      }
+
+      if (!tempFile.renameTo(file)) {
+        throw new IOException("Failed to rename " + tempFile);
+      }
+
+      tempFile = null;
+    } catch (IOException e) {
+      warnfmt(e, "Failed to write metadata cache file %s", file);
+    } finally {
+      if (tempFile != null) {
+        tempFile.delete();
+      }
+    }
+  }
+
+  /**
+   * Queries a new OAuth access token from the metadata service.
+   *
+   * @return new access token or null in case of a failure
+   */
+  AccessTokenCache.Token queryAccessToken() {
     String tokenJsonString;
     try {
       tokenJsonString = queryMetadataAttribute("instance/service-accounts/default/token");
     } catch (IOException e) {
       warnfmt(e, "Failed to query access token in GCE metadata service");
-      return;
+      return null;
     }
     
     Token token;
@@ -204,22 +384,19 @@ public final class GceMetadataQuery implements MetadataQuery {
       token = gson.fromJson(tokenJsonString, Token.class);
     } catch (JsonSyntaxException e) {
       severefmt(e, "Access token is not a proper JSON string: %s", tokenJsonString);
-      return;
+      return null;
     }
 
     if ((token.getAccessToken() == null) || token.getAccessToken().isEmpty()) {
       severefmt("\"access_token\" attribute not available in JSON BLOB %s", tokenJsonString);
-      return;
+      return null;
     }
 
-    accessToken = token.getAccessToken();
-
-    if (token.getExpiresIn() > 0) {
-      accessTokenExpirationTime = startTime + token.getExpiresIn();
-    } else {
+    if (token.getExpiresIn() <= 0) {
       warnfmt("Access token expiration time not available: %s", tokenJsonString);
-      accessTokenExpirationTime = 0;
-    }    
+    }
+
+    return new AccessTokenCache.Token(token.getAccessToken(), Math.max(0, token.getExpiresIn()));
   }
   
   /**
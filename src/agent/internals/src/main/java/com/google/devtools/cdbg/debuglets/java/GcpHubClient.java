@@ -44,16 +44,35 @@ import java.io.OutputStream;
 import java.io.OutputStreamWriter;
 import java.io.Reader;
 import java.io.Writer;
+import java.lang.management.ManagementFactory;
+import java.lang.management.ThreadMXBean;
 import java.lang.reflect.Type;
 import java.net.HttpURLConnection;
+import java.net.InetAddress;
+import java.net.Socket;
 import java.net.URL;
 import java.net.URLEncoder;
+import java.nio.ByteBuffer;
+import java.nio.channels.Channels;
+import java.nio.channels.WritableByteChannel;
 import java.security.MessageDigest;
 import java.security.NoSuchAlgorithmException;
 import java.util.ArrayList;
+import java.util.LinkedHashMap;
 import java.util.List;
 import java.util.Map;
+import java.util.concurrent.CancellationException;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.zip.GZIPOutputStream;
 
+import javax.net.ssl.HttpsURLConnection;
+import javax.net.ssl.SSLSocketFactory;
 import javax.xml.bind.DatatypeConverter;
 
 class GcpHubClient implements HubClient {
@@ -137,11 +156,20 @@ class GcpHubClient implements HubClient {
    */
   static class ListActiveBreakpointsResponse {
     private String nextWaitToken;
+    private Boolean waitExpired;
     private JsonElement[] breakpoints;
     
     public String getNextWaitToken() {
       return nextWaitToken;
     }
+
+    /**
+     * True if the list of active breakpoints didn't change before the hanging get expired. The
+     * list of breakpoints in the response is empty and should be ignored then.
+     */
+    public boolean getWaitExpired() {
+      return (waitExpired != null) && waitExpired;
+    }
     
     public byte[][] serializeBreakpoints() throws IOException {
       if (breakpoints == null) {
@@ -167,9 +195,22 @@ class GcpHubClient implements HubClient {
    */
   private final class ActiveConnection implements AutoCloseable {
     private final HttpURLConnection connection;
+
+    /**
+     * Number of connections the current thread opened before this request or -1 if the
+     * connection reuse is not tracked for this request.
+     */
+    private final int startNewConnectionsCount;
     
     public ActiveConnection(HttpURLConnection connection) {
       this.connection = connection;
+
+      if (connection instanceof HttpsURLConnection) {
+        ((HttpsURLConnection) connection).setSSLSocketFactory(socketFactory);
+        this.startNewConnectionsCount = socketFactory.getNewConnectionsCount();
+      } else {
+        this.startNewConnectionsCount = -1;
+      }
       
       synchronized (activeConnections) {
         if (isShutdown) {
@@ -187,6 +228,11 @@ class GcpHubClient implements HubClient {
       synchronized (activeConnections) {
         activeConnections.remove(connection);
       }
+
+      if (startNewConnectionsCount >= 0) {
+        boolean isReused = (socketFactory.getNewConnectionsCount() == startNewConnectionsCount);
+        Statistician.addSample("hub_connection_reuse_rate_percent", isReused ? 100 : 0);
+      }
     }
     
     public HttpURLConnection get() {
@@ -194,6 +240,83 @@ class GcpHubClient implements HubClient {
     }
   }
 
+  /**
+   * Socket factory of HTTPS connections to the backend. Counts new connections, so that a
+   * request can tell whether it was sent over a connection reused from the keep-alive cache
+   * of HttpURLConnection. The sockets are created by the thread sending the request, hence
+   * the count is kept per thread.
+   *
+   * <p>HttpURLConnection only reuses a cached connection if it was created with the same socket
+   * factory instance, so all the requests must share the same instance.
+   */
+  private static final class CountingSocketFactory extends SSLSocketFactory {
+    private final ThreadLocal<int[]> newConnectionsCount = new ThreadLocal<int[]>() {
+      @Override
+      protected int[] initialValue() {
+        return new int[1];
+      }
+    };
+
+    /**
+     * Gets the number of connections opened so far by the current thread.
+     */
+    int getNewConnectionsCount() {
+      return newConnectionsCount.get()[0];
+    }
+
+    /**
+     * Gets the factory creating the actual sockets. The default factory is not captured, so
+     * that changes made by the application still apply to the agent.
+     */
+    private SSLSocketFactory delegate() {
+      ++newConnectionsCount.get()[0];
+      return HttpsURLConnection.getDefaultSSLSocketFactory();
+    }
+
+    @Override
+    public String[] getDefaultCipherSuites() {
+      return HttpsURLConnection.getDefaultSSLSocketFactory().getDefaultCipherSuites();
+    }
+
+    @Override
+    public String[] getSupportedCipherSuites() {
+      return HttpsURLConnection.getDefaultSSLSocketFactory().getSupportedCipherSuites();
+    }
+
+    @Override
+    public Socket createSocket() throws IOException {
+      return delegate().createSocket();
+    }
+
+    @Override
+    public Socket createSocket(Socket socket, String host, int port, boolean autoClose)
+        throws IOException {
+      return delegate().createSocket(socket, host, port, autoClose);
+    }
+
+    @Override
+    public Socket createSocket(String host, int port) throws IOException {
+      return delegate().createSocket(host, port);
+    }
+
+    @Override
+    public Socket createSocket(String host, int port, InetAddress localHost, int localPort)
+        throws IOException {
+      return delegate().createSocket(host, port, localHost, localPort);
+    }
+
+    @Override
+    public Socket createSocket(InetAddress host, int port) throws IOException {
+      return delegate().createSocket(host, port);
+    }
+
+    @Override
+    public Socket createSocket(InetAddress address, int port, InetAddress localAddress,
+        int localPort) throws IOException {
+      return delegate().createSocket(address, port, localAddress, localPort);
+    }
+  }
+
   /**
    * List of labels that (if defined) go into debuggee description.
    */
@@ -208,6 +331,32 @@ class GcpHubClient implements HubClient {
    * (either .jar file or directory with .class files).
    */
   private static final String SOURCE_CONTEXT_RESOURCE_NAME = "source-context.json";
+
+  /**
+   * Breakpoint updates are sent as {"breakpoint":<serialized breakpoint>}.
+   */
+  private static final byte[] BREAKPOINT_UPDATE_PREFIX = "{\"breakpoint\":".getBytes(UTF_8);
+  private static final byte[] BREAKPOINT_UPDATE_SUFFIX = "}".getBytes(UTF_8);
+
+  /**
+   * Breakpoint updates of at least this many bytes are compressed with gzip. Large snapshots
+   * with strings and collections compress very well, while compressing small updates is not
+   * worth the CPU time. Set the system property to a negative value to disable compression.
+   */
+  private static final int COMPRESSION_THRESHOLD = getCompressionThreshold();
+
+  /**
+   * Maximum number of breakpoint updates sent to the backend in parallel. The latency of a
+   * single update can be a few hundred milliseconds, so sending one update at a time limits
+   * how fast a burst of snapshots drains. Updates of the same breakpoint are always sent in
+   * order, one at a time.
+   *
+   * <p>HttpURLConnection keeps up to "http.maxConnections" (5 by default) idle connections per
+   * host. Together with the hanging get connection, the default concurrency fits into it, so
+   * that all the connections to the backend are reused.
+   */
+  private static final int TRANSMIT_CONCURRENCY =
+      Math.max(1, Integer.getInteger("com.google.cdbg.transmitconcurrency", 4));
   
   /**
    * JSON serialization and deserialization. We register a special adapter for {@link JsonElement}
@@ -227,6 +376,11 @@ class GcpHubClient implements HubClient {
         }
       })
       .create();
+
+  /**
+   * Socket factory shared by all the connections to the backend.
+   */
+  private static final CountingSocketFactory socketFactory = new CountingSocketFactory();
   
   /**
    * Base URL of Debuglet Controller service.
@@ -257,6 +411,12 @@ class GcpHubClient implements HubClient {
    * List of active HTTP connections to be closed during shutdown.
    */
   private final List<HttpURLConnection> activeConnections = new ArrayList<>(); 
+
+  /**
+   * Thread pool to send breakpoint updates in parallel. Created on the first batch with more
+   * than one breakpoint. Protected by {@link #activeConnections} lock.
+   */
+  private ExecutorService transmitExecutor = null;
   
   /**
    * Cache of unique identifier of the application resources. Computing uniquifier is
@@ -272,9 +432,10 @@ class GcpHubClient implements HubClient {
   private String[] sourceContextFiles = null;
   
   /**
-   * Registered debuggee ID. Once set never changes.
+   * Registered debuggee ID. Once set only changes if the backend stops recognizing the
+   * debuggee. Read by the transmission threads.
    */
-  private String debuggeeId = null;
+  private volatile String debuggeeId = null;
   
   /**
    * The last wait_token returned in the ListActiveBreakpoints response.
@@ -326,9 +487,11 @@ class GcpHubClient implements HubClient {
         gson.toJson(request, writer);
       }
 
-      try (Reader reader = new InputStreamReader(connection.get().getInputStream(), UTF_8)) {
+      try (InputStream inputStream = connection.get().getInputStream();
+           Reader reader = new InputStreamReader(inputStream, UTF_8)) {
         JsonParser parser = new JsonParser();
         responseJson = parser.parse(reader);
+        drain(inputStream);
       }
       catch (IOException e) {
         errorResponse = readErrorStream(connection.get());
@@ -370,6 +533,10 @@ class GcpHubClient implements HubClient {
 
   @Override
   public ListActiveBreakpointsResult listActiveBreakpoints() throws Exception {
+    if (debuggeeId == null) {
+      return LIST_ACTIVE_BREAKPOINTS_REGISTRATION_REQUIRED;
+    }
+
     StringBuilder path = new StringBuilder();
     path.append("debuggees/");
     path.append(URLEncoder.encode(debuggeeId, UTF_8.name()));
@@ -382,15 +549,30 @@ class GcpHubClient implements HubClient {
     ListActiveBreakpointsResponse response;
     String errorResponse = "";
     try (ActiveConnection connection = openConnection(path.toString())) {
-      try (Reader reader = new InputStreamReader(connection.get().getInputStream(), UTF_8)) {
+      try (InputStream inputStream = connection.get().getInputStream();
+           Reader reader = new InputStreamReader(inputStream, UTF_8)) {
         response = gson.fromJson(reader, ListActiveBreakpointsResponse.class);
+        drain(inputStream);
       } catch (IOException e) {
-        if (connection.get().getResponseCode() == 409) {
+        int responseCode = connection.get().getResponseCode();
+        if (responseCode == 409) {
           // We have to close the error stream. Otherwise the network connection leaks.
-          connection.get().getErrorStream().close();
+          try (InputStream errorStream = connection.get().getErrorStream()) {
+            drain(errorStream);
+          }
           return LIST_ACTIVE_BREAKPOINTS_TIMEOUT;
         }
 
+        if (responseCode == 404) {
+          // The backend doesn't know the debuggee any more. Any other failure is considered
+          // transient and doesn't require a new registration.
+          errorResponse = readErrorStream(connection.get());
+          warnfmt(e, "Debuggee %s not found, registering again: %s", debuggeeId, errorResponse);
+          debuggeeId = null;
+          lastWaitToken = "init";
+          return LIST_ACTIVE_BREAKPOINTS_REGISTRATION_REQUIRED;
+        }
+
         errorResponse = readErrorStream(connection.get());
         throw e;
       }
@@ -401,6 +583,12 @@ class GcpHubClient implements HubClient {
     }
 
     lastWaitToken = response.getNextWaitToken();
+
+    // Don't bother serializing the list if nothing changed.
+    if (response.getWaitExpired()) {
+      return LIST_ACTIVE_BREAKPOINTS_TIMEOUT;
+    }
+
     final byte[][] breakpoints = response.serializeBreakpoints();
 
     return new ListActiveBreakpointsResult() {
@@ -409,6 +597,11 @@ class GcpHubClient implements HubClient {
         return false;
       }
 
+      @Override
+      public boolean getIsRegistrationRequired() {
+        return false;
+      }
+
       @Override
       public String getFormat() {
         return "json";
@@ -424,6 +617,11 @@ class GcpHubClient implements HubClient {
   @Override
   public void transmitBreakpointUpdate(String format, String breakpointId, byte[] breakpoint)
       throws Exception {
+    transmitBreakpointUpdate(format, breakpointId, ByteBuffer.wrap(breakpoint));
+  }
+
+  private void transmitBreakpointUpdate(String format, String breakpointId, ByteBuffer breakpoint)
+      throws Exception {
     if (!"json".equals(format)) {
       throw new UnsupportedOperationException("GcpHubClient only supports protobuf format");
     }
@@ -431,21 +629,37 @@ class GcpHubClient implements HubClient {
     String path = String.format("debuggees/%s/breakpoints/%s",
         URLEncoder.encode(debuggeeId, UTF_8.name()),
         URLEncoder.encode(breakpointId, UTF_8.name()));
+    // We could parse breakpoint back to JsonObject, then embed it as in the request element
+    // and serialize everything back. This would be very inefficient, which is important here
+    // since breakpoint result is fairly large and contains thousands of JSON elements.
+    int requestLength =
+        BREAKPOINT_UPDATE_PREFIX.length + breakpoint.remaining() + BREAKPOINT_UPDATE_SUFFIX.length;
+    byte[] compressedBody = null;
+    if (requestLength >= COMPRESSION_THRESHOLD) {
+      compressedBody = compress(breakpoint, requestLength);
+    }
+
     try (ActiveConnection connection = openConnection(path)) {
-      // We could parse breakpoint back to JsonObject, then embed it as in the request element
-      // and serialize everything back. This would be very inefficient, which is important here
-      // since breakpoint result is fairly large and contains thousands of JSON elements.
       connection.get().setDoOutput(true);  // Request with body.
       connection.get().setRequestMethod("PUT");
+      if (compressedBody != null) {
+        connection.get().setRequestProperty("Content-Encoding", "gzip");
+        connection.get().setFixedLengthStreamingMode(compressedBody.length);
+      } else {
+        connection.get().setFixedLengthStreamingMode(requestLength);
+      }
       try (OutputStream outputStream = connection.get().getOutputStream()) {
-        outputStream.write("{\"breakpoint\":".getBytes(UTF_8));
-        outputStream.write(breakpoint);
-        outputStream.write("}".getBytes(UTF_8));
+        if (compressedBody != null) {
+          outputStream.write(compressedBody);
+        } else {
+          writeRequestBody(breakpoint, outputStream);
+        }
       }
 
-      // Trigger the request to be sent over. We don't really care to read the response.
-      try {
-        connection.get().getInputStream().close();
+      // Trigger the request to be sent over. We don't really care about the response, but it
+      // has to be read to the end for the connection to be reused.
+      try (InputStream inputStream = connection.get().getInputStream()) {
+        drain(inputStream);
       } catch (IOException e) {
         // We always call readErrorStream to close the error stream to avoid socket leak.
         String errorResponse = readErrorStream(connection.get());
@@ -467,6 +681,132 @@ class GcpHubClient implements HubClient {
     }
   }
   
+  @Override
+  public int transmitBreakpointUpdates(
+      final String format, final String[] breakpointIds, final ByteBuffer[] breakpoints) {
+    // The Controller API has no batch method to update multiple breakpoints. The connections
+    // to the backend are kept alive by HttpURLConnection, so the updates are sent back to back
+    // on the same connections. Updates of different breakpoints are independent and are sent
+    // in parallel. Updates of the same breakpoint are sent in order, and a failure stops the
+    // updates of that breakpoint that come after it.
+    Map<String, List<Integer>> chains = new LinkedHashMap<>();
+    for (int i = 0; i < breakpointIds.length; ++i) {
+      List<Integer> chain = chains.get(breakpointIds[i]);
+      if (chain == null) {
+        chain = new ArrayList<>();
+        chains.put(breakpointIds[i], chain);
+      }
+      chain.add(i);
+    }
+
+    final boolean[] isDone = new boolean[breakpointIds.length];
+
+    ExecutorService executor = (chains.size() > 1) ? getTransmitExecutor() : null;
+    if (executor == null) {
+      for (List<Integer> chain : chains.values()) {
+        transmitBreakpointUpdatesChain(format, breakpointIds, breakpoints, chain, isDone);
+      }
+    } else {
+      List<Future<?>> futures = new ArrayList<>();
+      try {
+        for (final List<Integer> chain : chains.values()) {
+          futures.add(executor.submit(new Runnable() {
+            @Override
+            public void run() {
+              transmitBreakpointUpdatesChain(format, breakpointIds, breakpoints, chain, isDone);
+            }
+          }));
+        }
+      } catch (RejectedExecutionException e) {
+        // Shutdown in progress. Wait for the updates already in flight.
+        warnfmt(e, "Breakpoint update rejected, debuggee: %s", debuggeeId);
+      }
+
+      // The native code owns "breakpoints" buffers and they are only valid during this call,
+      // so all the updates must finish before returning.
+      for (Future<?> future : futures) {
+        try {
+          future.get();
+        } catch (ExecutionException e) {
+          warnfmt(e, "Unexpected failure to transmit breakpoint update, debuggee: %s",
+              debuggeeId);
+        } catch (CancellationException | InterruptedException e) {
+          // The executor is shutting down and the updates in flight are aborted by
+          // disconnecting active connections.
+          warnfmt(e, "Breakpoint update aborted, debuggee: %s", debuggeeId);
+          break;
+        }
+      }
+    }
+
+    // Completion of the updates after the first failure doesn't matter: they are sent again.
+    int count = 0;
+    synchronized (isDone) {
+      while ((count < isDone.length) && isDone[count]) {
+        ++count;
+      }
+    }
+
+    return count;
+  }
+
+  /**
+   * Sends updates of a single breakpoint in order. Stops at the first transient failure.
+   */
+  private void transmitBreakpointUpdatesChain(
+      String format,
+      String[] breakpointIds,
+      ByteBuffer[] breakpoints,
+      List<Integer> chain,
+      boolean[] isDone) {
+    for (int i : chain) {
+      try {
+        transmitBreakpointUpdate(format, breakpointIds[i], breakpoints[i]);
+      } catch (Exception e) {
+        warnfmt(e, "Transient failure to transmit breakpoint update, debuggee: %s, "
+            + "breakpoint ID: %s", debuggeeId, breakpointIds[i]);
+        return;
+      }
+
+      synchronized (isDone) {
+        isDone[i] = true;
+      }
+    }
+  }
+
+  /**
+   * Gets the thread pool to send breakpoint updates in parallel or null if updates should be
+   * sent one at a time.
+   */
+  private ExecutorService getTransmitExecutor() {
+    if (TRANSMIT_CONCURRENCY <= 1) {
+      return null;
+    }
+
+    synchronized (activeConnections) {
+      if (isShutdown) {
+        return null;
+      }
+
+      if (transmitExecutor == null) {
+        ThreadFactory threadFactory = new ThreadFactory() {
+          private final AtomicInteger counter = new AtomicInteger();
+
+          @Override
+          public Thread newThread(Runnable runnable) {
+            Thread thread =
+                new Thread(runnable, "CloudDebugger_transmit_" + counter.incrementAndGet());
+            thread.setDaemon(true);
+            return thread;
+          }
+        };
+        transmitExecutor = Executors.newFixedThreadPool(TRANSMIT_CONCURRENCY, threadFactory);
+      }
+
+      return transmitExecutor;
+    }
+  }
+
   @Override
   public void registerBreakpointCanary(String breakpointId) throws Exception {
     throw new UnsupportedOperationException(
@@ -486,6 +826,10 @@ class GcpHubClient implements HubClient {
     synchronized (activeConnections) {
       isShutdown = true;
       connections.addAll(activeConnections);
+
+      if (transmitExecutor != null) {
+        transmitExecutor.shutdownNow();
+      }
     }
     
     for (HttpURLConnection connection : connections) {
@@ -617,6 +961,75 @@ class GcpHubClient implements HubClient {
     }
   }
 
+  /**
+   * Reads the rest of the HTTP response. HttpURLConnection only returns the connection to its
+   * keep-alive cache if the response was read to the end when the stream is closed. Otherwise
+   * the connection is closed and the next request pays for a new TCP connection and TLS
+   * handshake.
+   */
+  private static void drain(InputStream inputStream) throws IOException {
+    if (inputStream == null) {
+      return;
+    }
+
+    byte[] buffer = new byte[1024];
+    while (inputStream.read(buffer) != -1) {
+    }
+  }
+
+  /**
+   * Reads the compression threshold from the system property.
+   */
+  private static int getCompressionThreshold() {
+    int threshold = Integer.getInteger("com.google.cdbg.compressionthreshold", 4096);
+    return (threshold < 0) ? Integer.MAX_VALUE : threshold;
+  }
+
+  /**
+   * Writes the body of the breakpoint update request wrapping the serialized breakpoint. The
+   * breakpoint is streamed through a small intermediate buffer, so that a direct buffer from
+   * the native code is never copied to Java heap as a whole.
+   */
+  private static void writeRequestBody(ByteBuffer breakpoint, OutputStream outputStream)
+      throws IOException {
+    outputStream.write(BREAKPOINT_UPDATE_PREFIX);
+
+    // Don't close the channel: it would close "outputStream".
+    WritableByteChannel channel = Channels.newChannel(outputStream);
+    ByteBuffer data = breakpoint.duplicate();
+    while (data.hasRemaining()) {
+      channel.write(data);
+    }
+
+    outputStream.write(BREAKPOINT_UPDATE_SUFFIX);
+  }
+
+  /**
+   * Compresses the request body with gzip and records the compression ratio and the CPU time
+   * it took in the agent statistics.
+   */
+  private static byte[] compress(ByteBuffer breakpoint, int requestLength) throws IOException {
+    ThreadMXBean threadBean = ManagementFactory.getThreadMXBean();
+    boolean isCpuTimeSupported = threadBean.isCurrentThreadCpuTimeSupported();
+    long startTime =
+        isCpuTimeSupported ? threadBean.getCurrentThreadCpuTime() : System.nanoTime();
+
+    ByteArrayOutputStream compressed = new ByteArrayOutputStream(requestLength / 4);
+    try (GZIPOutputStream compressionStream = new GZIPOutputStream(compressed)) {
+      writeRequestBody(breakpoint, compressionStream);
+    }
+
+    long endTime =
+        isCpuTimeSupported ? threadBean.getCurrentThreadCpuTime() : System.nanoTime();
+
+    Statistician.addSample(
+        "transmit_compression_ratio_percent",
+        100.0 * compressed.size() / requestLength);
+    Statistician.addSample("transmit_compression_time_micros", (endTime - startTime) / 1000.0);
+
+    return compressed.toByteArray();
+  }
+
   /**
    * Reads error response stream from an HTTP connection.
    * 
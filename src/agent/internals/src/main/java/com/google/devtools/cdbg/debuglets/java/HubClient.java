@@ -16,6 +16,8 @@
 
 package com.google.devtools.cdbg.debuglets.java;
 
+import java.nio.ByteBuffer;
+
 /**
  * Communication layer with the Cloud Debugger backend.
  *
@@ -47,6 +49,12 @@ public interface HubClient {
      */
     boolean getIsTimeout();
 
+    /**
+     * Returns true if the backend doesn't recognize the debuggee anymore and
+     * {@link HubClient#registerDebuggee()} has to be called again.
+     */
+    boolean getIsRegistrationRequired();
+
     /**
      * Gets the serialized format of active breakpoints list.
      */
@@ -71,6 +79,38 @@ public interface HubClient {
           return true;
         }
 
+        @Override
+        public boolean getIsRegistrationRequired() {
+          return false;
+        }
+
+        @Override
+        public String getFormat() {
+          throw new UnsupportedOperationException();
+        }
+
+        @Override
+        public byte[][] getActiveBreakpoints() {
+          throw new UnsupportedOperationException();
+        }
+      };
+
+  /**
+   * Return value for {@link HubClient#listActiveBreakpoints()} when the debuggee needs to be
+   * registered again.
+   */
+  static final ListActiveBreakpointsResult LIST_ACTIVE_BREAKPOINTS_REGISTRATION_REQUIRED =
+      new ListActiveBreakpointsResult() {
+        @Override
+        public boolean getIsTimeout() {
+          return false;
+        }
+
+        @Override
+        public boolean getIsRegistrationRequired() {
+          return true;
+        }
+
         @Override
         public String getFormat() {
           throw new UnsupportedOperationException();
@@ -117,6 +157,25 @@ public interface HubClient {
    */
   void transmitBreakpointUpdate(String format, String breakpointId, byte[] breakpoint)
       throws Exception;
+
+  /**
+   * Sends a batch of breakpoint updates to the backend.
+   *
+   * <p>The updates are processed in order with the same semantics as
+   * {@link #transmitBreakpointUpdate}: updates failing with a permanent error are silently
+   * absorbed. Processing stops at the first update that fails due to a transient error. That
+   * update and all the updates after it need to be retried by the caller.
+   *
+   * @param format serialization format of all the breakpoints in the batch
+   * @param breakpointIds IDs of the updated breakpoints
+   * @param breakpoints serialized breakpoint results (same length as {@code breakpointIds}).
+   *     These are direct buffers over native memory that are only valid during this call.
+   *     They must not be modified or retained.
+   *
+   * @return number of leading updates that don't need to be retried
+   */
+  int transmitBreakpointUpdates(
+      String format, String[] breakpointIds, ByteBuffer[] breakpoints);
   
   /**
    * Notifies that a canary agent enabled the breakpoint.
@@ -28,6 +28,14 @@ import java.nio.file.Path;
 import java.util.ArrayList;
 import java.util.Collection;
 import java.util.Collections;
+import java.util.List;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.atomic.AtomicInteger;
 import java.util.jar.JarFile;
 
 /**
@@ -39,6 +47,11 @@ import java.util.jar.JarFile;
  * only read data. Therefore the class is thread safe.
  */
 final class ResourceIndexer {
+  /**
+   * Maximum number of threads indexing .jar files in parallel.
+   */
+  private static final int MAX_INDEXING_THREADS = 8;
+
   /**
    * Represents a source of resources (e.g. directory or .jar file).
    */
@@ -107,18 +120,31 @@ final class ResourceIndexer {
    */
   private static final class JarResourcesSource implements ResourcesSource {
     /**
-     * Reader for .jar file.
+     * Path to the .jar file.
      */
-    private final JarFile jarFile;
+    private final File file;
+
+    /**
+     * Reader for .jar file. Only opened when a resource is read for the first time, since most
+     * of the .jar files are only ever indexed.
+     */
+    private JarFile jarFile = null;
 
     /**
      * Index of all available files in a .jar file.
      */
     private final ResourcesDatabase db;
     
-    public JarResourcesSource(JarFile jarFile) {
-      this.jarFile = jarFile;
-      this.db = ResourcesDatabase.Builder.forJar(jarFile);
+    public JarResourcesSource(File file, ResourcesIndexCache cache) throws IOException {
+      this.file = file;
+
+      ResourcesDatabase cachedDb = cache.load(file);
+      if (cachedDb != null) {
+        this.db = cachedDb;
+      } else {
+        this.db = index(file);
+        cache.store(file, db);
+      }
     }
 
     @Override
@@ -128,8 +154,39 @@ final class ResourceIndexer {
     
     @Override
     public InputStream getResource(String resourcePath) throws IOException {
+      JarFile jarFile = getJarFile();
       return jarFile.getInputStream(jarFile.getJarEntry(resourcePath));
     }
+
+    private synchronized JarFile getJarFile() throws IOException {
+      if (jarFile == null) {
+        jarFile = new JarFile(file);
+      }
+
+      return jarFile;
+    }
+
+    /**
+     * Builds the index of the files in the .jar file. The central directory is read by the
+     * native code if possible. The Java zip APIs are only used for .jar files the native code
+     * doesn't understand.
+     */
+    private static ResourcesDatabase index(File file) throws IOException {
+      byte[] names = null;
+      try {
+        names = readJarFileNames(file.getPath());
+      } catch (UnsatisfiedLinkError e) {
+        // The native code is not available (e.g. in unit tests).
+      }
+
+      if (names != null) {
+        return ResourcesDatabase.Builder.forJarFileNames(names);
+      }
+
+      try (JarFile jarFile = new JarFile(file)) {
+        return ResourcesDatabase.Builder.forJar(jarFile);
+      }
+    }
   }
 
   /**
@@ -159,20 +216,20 @@ final class ResourceIndexer {
       File file = new File(path);
       fileSystemSources.add(new FileSystemResourcesSource(file));
     }
-    
+
+    // Index of .jar files that didn't change since the previous start of the application.
+    ResourcesIndexCache cache = ResourcesIndexCache.fromSystemProperties();
+
     sources = new ArrayList<>();
     sources.addAll(fileSystemSources);
 
-    // Now open .JAR files in the path.
+    // Now find .JAR files in the path.
+    List<File> jarFiles = new ArrayList<>();
     for (FileSystemResourcesSource source : fileSystemSources) {
       for (ResourcesDatabase.Directory directory : source.getResourcesDatabase().directories()) {
         for (String file : directory.getFilePaths()) {
           if (file.endsWith(".jar")) {
-            try {
-              sources.add(new JarResourcesSource(new JarFile(source.getResourceFile(file))));
-            } catch (IOException e) {
-              warnfmt("Failed to index JAR file %s", source.getResourceFile(file));
-            }
+            jarFiles.add(source.getResourceFile(file));
           }
         }
       }
@@ -185,14 +242,12 @@ final class ResourceIndexer {
       File file = new File(path);
       boolean hasExtension = (path.lastIndexOf('.') > path.lastIndexOf('/'));
       if (!hasExtension && file.isFile()) {
-        try {
-          sources.add(new JarResourcesSource(new JarFile(file)));
-        } catch (IOException e) {
-          warnfmt("Failed to index JAR file %s", path);
-        }
+        jarFiles.add(file);
       }
     }
 
+    sources.addAll(indexJarFiles(jarFiles, cache));
+
     sources = Collections.unmodifiableCollection(sources);
     fileSystemSources = Collections.unmodifiableCollection(fileSystemSources);
 
@@ -205,6 +260,80 @@ final class ResourceIndexer {
     infofmt("Total size of indexed resources database: %d bytes", totalSize);
   }
 
+  /**
+   * Reads the names of the files in a .jar file from its central directory in the native code.
+   *
+   * @param path path to the .jar file
+   * @return names of the files (encoded in UTF-8, each one terminated with '\0') or null if
+   *     the .jar file could not be read
+   */
+  private static native byte[] readJarFileNames(String path);
+
+  /**
+   * Indexes the .jar files in parallel. Large applications have hundreds of .jar files, and
+   * indexing them one at a time delays the startup of the debugger.
+   *
+   * @return indexed .jar files in the order of {@code jarFiles} (skipping the ones that failed)
+   */
+  private static List<ResourcesSource> indexJarFiles(
+      List<File> jarFiles, final ResourcesIndexCache cache) {
+    List<ResourcesSource> jarSources = new ArrayList<>();
+
+    int threadsCount = Math.min(
+        jarFiles.size(),
+        Math.min(MAX_INDEXING_THREADS, Runtime.getRuntime().availableProcessors()));
+    if (threadsCount <= 1) {
+      for (File file : jarFiles) {
+        try {
+          jarSources.add(new JarResourcesSource(file, cache));
+        } catch (IOException e) {
+          warnfmt("Failed to index JAR file %s", file);
+        }
+      }
+
+      return jarSources;
+    }
+
+    ThreadFactory threadFactory = new ThreadFactory() {
+      private final AtomicInteger counter = new AtomicInteger();
+
+      @Override
+      public Thread newThread(Runnable runnable) {
+        Thread thread = new Thread(runnable, "CloudDebugger_indexer_" + counter.incrementAndGet());
+        thread.setDaemon(true);
+        return thread;
+      }
+    };
+
+    ExecutorService executor = Executors.newFixedThreadPool(threadsCount, threadFactory);
+    try {
+      List<Future<ResourcesSource>> futures = new ArrayList<>();
+      for (final File file : jarFiles) {
+        futures.add(executor.submit(new Callable<ResourcesSource>() {
+          @Override
+          public ResourcesSource call() throws IOException {
+            return new JarResourcesSource(file, cache);
+          }
+        }));
+      }
+
+      for (int i = 0; i < futures.size(); ++i) {
+        try {
+          jarSources.add(futures.get(i).get());
+        } catch (ExecutionException e) {
+          warnfmt("Failed to index JAR file %s", jarFiles.get(i));
+        } catch (InterruptedException e) {
+          Thread.currentThread().interrupt();
+          break;
+        }
+      }
+    } finally {
+      executor.shutdownNow();
+    }
+
+    return jarSources;
+  }
+
   /**
    * Gets sources of application files.
    */
@@ -273,6 +273,23 @@ final class ResourcesDatabase {
       return builder.build();
     }
 
+    /**
+     * Creates database of files in a .jar file from the names read by the native code. The names
+     * are encoded in UTF-8 and each one is terminated with '\0'.
+     */
+    public static ResourcesDatabase forJarFileNames(byte[] names) {
+      Builder builder = new Builder();
+      int start = 0;
+      for (int i = 0; i < names.length; ++i) {
+        if (names[i] == 0) {
+          builder.add(new String(names, start, i - start, UTF_8));
+          start = i + 1;
+        }
+      }
+
+      return builder.build();
+    }
+
     /**
      * Adds a single file to the builder.
      *
@@ -555,6 +572,27 @@ final class ResourcesDatabase {
     }
   }
 
+  private ResourcesDatabase(byte[] buffer) {
+    this.buffer = buffer;
+  }
+
+  /**
+   * Wraps a BLOB previously obtained through {@link #getBlob()}.
+   *
+   * <p>The content of {@code blob} is not validated. The caller is responsible to only pass
+   * BLOBs produced by the same version of this class.
+   */
+  static ResourcesDatabase fromBlob(byte[] blob) {
+    return new ResourcesDatabase(blob);
+  }
+
+  /**
+   * Gets the serialized BLOB storing the entire database. The caller must not modify it.
+   */
+  byte[] getBlob() {
+    return buffer;
+  }
+
   /**
    * Gets the root directory.
    */
@@ -0,0 +1,246 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.google.devtools.cdbg.debuglets.java;
+
+import static com.google.devtools.cdbg.debuglets.java.AgentLogger.infofmt;
+import static com.google.devtools.cdbg.debuglets.java.AgentLogger.warnfmt;
+import static java.nio.charset.StandardCharsets.UTF_8;
+
+import java.io.File;
+import java.io.IOException;
+import java.io.RandomAccessFile;
+import java.nio.ByteBuffer;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.file.Files;
+import java.nio.file.StandardCopyOption;
+import java.util.Arrays;
+
+/**
+ * Persistent cache of {@link ResourcesDatabase} instances built for .jar files.
+ *
+ * <p>Enumerating entries of hundreds of .jar files takes significant time on every start of
+ * the application. The resources database is already a compact BLOB, so this class stores it
+ * on disk and loads it back on the next start, as long as the .jar file hasn't changed. A .jar
+ * file is considered unchanged if its canonical path, modification time and size are the same.
+ * Only .jar files that did change are enumerated again.
+ *
+ * <p>Each .jar file has its own cache file. The name of the cache file is derived from the hash
+ * of the .jar path. The cache file has a fixed size header followed by the jar path and the
+ * database BLOB as is:
+ * <pre>
+ *   int32    magic ("CDBG")
+ *   int32    format version
+ *   int64    .jar modification time
+ *   int64    .jar size
+ *   int32    length of the .jar path (UTF-8)
+ *   int32    length of the database BLOB
+ *   byte[]   .jar path (UTF-8)
+ *   byte[]   database BLOB
+ * </pre>
+ * The cache file is memory mapped when loading, so that only the header and the BLOB are read.
+ * Cache files are written to a temporary file first and then atomically renamed, so that
+ * concurrently starting replicas sharing the same cache directory never see partial files.
+ *
+ * <p>The cache is disabled unless the cache directory is set through the
+ * {@code com.google.cdbg.resourcesindexcache} system property.
+ *
+ * <p>This class is thread safe.
+ */
+final class ResourcesIndexCache {
+  /**
+   * System property defining the directory for the cache files.
+   */
+  static final String CACHE_DIRECTORY_PROPERTY = "com.google.cdbg.resourcesindexcache";
+
+  /**
+   * Identifies the cache files.
+   */
+  private static final int MAGIC = 0x43444247;
+
+  /**
+   * Version of the file format. Needs to be incremented whenever either the layout of the cache
+   * file or the layout of {@link ResourcesDatabase} BLOB changes.
+   */
+  private static final int VERSION = 1;
+
+  /**
+   * Size of the fixed part of the header of the cache file.
+   */
+  private static final int HEADER_SIZE = 4 + 4 + 8 + 8 + 4 + 4;
+
+  /**
+   * Directory with the cache files or null if the cache is disabled.
+   */
+  private final File directory;
+
+  /**
+   * Creates the cache in the specified directory. If {@code directory} is null, the cache is
+   * disabled: {@link #load} always returns null and {@link #store} does nothing.
+   */
+  ResourcesIndexCache(File directory) {
+    this.directory = directory;
+  }
+
+  /**
+   * Creates the cache in the directory configured through the system property.
+   */
+  static ResourcesIndexCache fromSystemProperties() {
+    String path = System.getProperty(CACHE_DIRECTORY_PROPERTY);
+    if ((path == null) || path.isEmpty()) {
+      return new ResourcesIndexCache(null);
+    }
+
+    File directory = new File(path);
+    if (!directory.isDirectory() && !directory.mkdirs()) {
+      warnfmt("Failed to create resources index cache directory %s", path);
+      return new ResourcesIndexCache(null);
+    }
+
+    infofmt("Resources index cache directory: %s", path);
+    return new ResourcesIndexCache(directory);
+  }
+
+  /**
+   * Loads the cached database of the specified .jar file.
+   *
+   * @return the cached database or null if the .jar file is not in the cache or has changed
+   */
+  ResourcesDatabase load(File jarFile) {
+    if (directory == null) {
+      return null;
+    }
+
+    byte[] path = getJarPath(jarFile);
+    File cacheFile = getCacheFile(path);
+    if (!cacheFile.isFile()) {
+      return null;
+    }
+
+    try (RandomAccessFile file = new RandomAccessFile(cacheFile, "r");
+         FileChannel channel = file.getChannel()) {
+      if (channel.size() < HEADER_SIZE) {
+        return null;
+      }
+
+      MappedByteBuffer mapped = channel.map(FileChannel.MapMode.READ_ONLY, 0, channel.size());
+      if ((mapped.getInt() != MAGIC) || (mapped.getInt() != VERSION)) {
+        return null;
+      }
+
+      long lastModified = mapped.getLong();
+      long size = mapped.getLong();
+      int pathLength = mapped.getInt();
+      int blobLength = mapped.getInt();
+
+      if ((lastModified != jarFile.lastModified())
+          || (size != jarFile.length())
+          || (pathLength != path.length)
+          || (blobLength < 0)
+          || ((long) HEADER_SIZE + pathLength + blobLength != channel.size())) {
+        return null;
+      }
+
+      // Different .jar files may have the same hash.
+      byte[] cachedPath = new byte[pathLength];
+      mapped.get(cachedPath);
+      if (!Arrays.equals(cachedPath, path)) {
+        return null;
+      }
+
+      byte[] blob = new byte[blobLength];
+      mapped.get(blob);
+
+      return ResourcesDatabase.fromBlob(blob);
+    } catch (IOException e) {
+      warnfmt(e, "Failed to load resources index cache file %s", cacheFile);
+      return null;
+    }
+  }
+
+  /**
+   * Stores the database of the specified .jar file in the cache.
+   */
+  void store(File jarFile, ResourcesDatabase db) {
+    if (directory == null) {
+      return;
+    }
+
+    byte[] path = getJarPath(jarFile);
+    byte[] blob = db.getBlob();
+    File cacheFile = getCacheFile(path);
+
+    ByteBuffer header = ByteBuffer.allocate(HEADER_SIZE);
+    header.putInt(MAGIC);
+    header.putInt(VERSION);
+    header.putLong(jarFile.lastModified());
+    header.putLong(jarFile.length());
+    header.putInt(path.length);
+    header.putInt(blob.length);
+
+    File temporaryFile = null;
+    try {
+      temporaryFile = File.createTempFile(cacheFile.getName(), ".tmp", directory);
+      try (RandomAccessFile file = new RandomAccessFile(temporaryFile, "rw")) {
+        file.write(header.array());
+        file.write(path);
+        file.write(blob);
+      }
+
+      Files.move(
+          temporaryFile.toPath(),
+          cacheFile.toPath(),
+          StandardCopyOption.REPLACE_EXISTING,
+          StandardCopyOption.ATOMIC_MOVE);
+      temporaryFile = null;
+    } catch (IOException e) {
+      warnfmt(e, "Failed to store resources index cache file %s", cacheFile);
+    } finally {
+      if (temporaryFile != null) {
+        temporaryFile.delete();
+      }
+    }
+  }
+
+  /**
+   * Gets the canonical path of the .jar file encoded in UTF-8.
+   */
+  private static byte[] getJarPath(File jarFile) {
+    String path;
+    try {
+      path = jarFile.getCanonicalPath();
+    } catch (IOException e) {
+      path = jarFile.getAbsolutePath();
+    }
+
+    return path.getBytes(UTF_8);
+  }
+
+  /**
+   * Gets the cache file for the .jar file with the specified path.
+   */
+  private File getCacheFile(byte[] path) {
+    // 64 bit FNV-1a hash of the path.
+    long hash = 0xcbf29ce484222325L;
+    for (byte b : path) {
+      hash ^= (b & 0xFF);
+      hash *= 0x100000001b3L;
+    }
+
+    return new File(directory, String.format("%016x.rdb", hash));
+  }
+}
@@ -24,7 +24,10 @@ import java.io.IOException;
 import java.lang.reflect.Method;
 import java.security.AccessController;
 import java.security.PrivilegedAction;
+import java.util.Map;
 import java.util.Objects;
+import java.util.WeakHashMap;
+import java.util.concurrent.ConcurrentHashMap;
 
 /**
  * Ensures safety of application methods invoked by the debuglet.
@@ -53,7 +56,22 @@ final class SafeTransformer {
   /**
    * Whitelist and blacklist of methods.
    */
-  private static MethodsFilter config;
+  private static volatile MethodsFilter config;
+
+  /**
+   * Maximum number of classes in {@link #analysisCache}. The cache is cleared when it grows
+   * beyond this limit.
+   */
+  private static final int MAX_ANALYSIS_CACHE_CLASSES = 1024;
+
+  /**
+   * Results of static analysis of methods keyed by the class and then by the method name and
+   * signature. The analysis reads and parses the entire class file, so it's only done once per
+   * method. Keeping the class as a weak key takes class loader identity into account and doesn't
+   * prevent classes from being unloaded. Access is synchronized on the map itself.
+   */
+  private static final Map<Class<?>, Map<String, Boolean>> analysisCache =
+      new WeakHashMap<>();
 
 
   /**
@@ -63,6 +81,25 @@ final class SafeTransformer {
    */
   static void setConfig(MethodsFilter config) {
     SafeTransformer.config = config;
+
+    // Analysis results depend on the configuration.
+    synchronized (analysisCache) {
+      analysisCache.clear();
+    }
+  }
+
+  /**
+   * Gets the configuration set with {@link #setConfig} or the one loaded lazily by the default
+   * {@link ClassPathLookup} instance.
+   */
+  private static MethodsFilter getConfig() {
+    MethodsFilter currentConfig = config;
+    if (currentConfig == null) {
+      currentConfig = ClassPathLookup.defaultInstance.getMethodsFilter();
+      config = currentConfig;
+    }
+
+    return currentConfig;
   }
 
   /**
@@ -81,6 +118,7 @@ final class SafeTransformer {
       String methodSignature,  // TODO(vlif): remove once MethodAnalyzer is gone.
       boolean isStatic) throws ClassNotFoundException {
     // Check against whitelist and blacklist.
+    MethodsFilter config = getConfig();
     Boolean isSafe = config.isSafeMethod(Type.getInternalName(cls), methodName, isStatic);
     if (isSafe != null) {
       return isSafe ? cls : null;
@@ -93,18 +131,27 @@ final class SafeTransformer {
     // Static analysis cover very little and in some scenarios it messes up with safe caller.
     // For example it allows "new int[]", but doesn't register the new array as a temporary object.
     if (!ENABLE_SAFE_CALLER) {
-      try {
-        if (MethodAnalyzer.analyzeMethod(
+      Map<String, Boolean> classAnalysis = getClassAnalysis(cls);
+      String methodKey = (isStatic ? "static " : "") + methodName + methodSignature;
+      Boolean isImmutable = classAnalysis.get(methodKey);
+      if (isImmutable == null) {
+        try {
+          isImmutable = MethodAnalyzer.analyzeMethod(
               config,
               classLoader.getResourceAsStream(Type.getInternalName(cls) + ".class"),
               methodName,
               methodSignature,
-              ENABLE_SAFE_CALLER)) {
-          return cls;  // Call method on the original class.
+              ENABLE_SAFE_CALLER);
+          classAnalysis.put(methodKey, isImmutable);
+        } catch (IOException e) {
+          warnfmt(e, "Static method analysis failed, class name: %s, method name: %s, "
+              + "signature: %s", cls.getName(), methodName, methodSignature);
+          isImmutable = false;
         }
-      } catch (IOException e) {
-        warnfmt(e, "Static method analysis failed, class name: %s, method name: %s, signature: %s",
-            cls.getName(), methodName, methodSignature);
+      }
+
+      if (isImmutable) {
+        return cls;  // Call method on the original class.
       }
     }
 
@@ -112,6 +159,25 @@ final class SafeTransformer {
     return null;  // Block the call.
   }
 
+  /**
+   * Gets the cached static analysis results of methods of the specified class.
+   */
+  private static Map<String, Boolean> getClassAnalysis(Class<?> cls) {
+    synchronized (analysisCache) {
+      Map<String, Boolean> classAnalysis = analysisCache.get(cls);
+      if (classAnalysis == null) {
+        if (analysisCache.size() >= MAX_ANALYSIS_CACHE_CLASSES) {
+          analysisCache.clear();
+        }
+
+        classAnalysis = new ConcurrentHashMap<>();
+        analysisCache.put(cls, classAnalysis);
+      }
+
+      return classAnalysis;
+    }
+  }
+
   /**
    * Gets the safe caller class corresponding to the class of specified real object.
    *
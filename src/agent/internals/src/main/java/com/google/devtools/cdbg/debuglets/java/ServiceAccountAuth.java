@@ -56,6 +56,19 @@ final class ServiceAccountAuth implements MetadataQuery {
    */
   private final GoogleCredential credential;
 
+  /**
+   * Cached OAuth access token refreshed in the background.
+   */
+  private final AccessTokenCache accessTokenCache =
+      new AccessTokenCache(
+          new AccessTokenCache.Source() {
+            @Override
+            public AccessTokenCache.Token fetch() {
+              return refreshToken();
+            }
+          },
+          TOKEN_EXPIRATION_BUFFER_SEC);
+
   /**
    * Class constructor
    * @param serviceAccountEmail service account identifier
@@ -94,28 +107,41 @@ final class ServiceAccountAuth implements MetadataQuery {
   }
   
   /**
-   * Gets the cached OAuth access token refreshing it as needed.
+   * Gets the cached OAuth access token.
    * 
-   * <p> Access token refresh is done synchronously delaying the call.
+   * <p>The token is refreshed in the background before it expires. Access token refresh is only
+   * done synchronously if there is no valid token (e.g. on the first call).
    */
   @Override
-  public synchronized String getAccessToken() {
-    Long expiresIn = credential.getExpiresInSeconds();
-    if ((expiresIn == null) || (expiresIn < TOKEN_EXPIRATION_BUFFER_SEC)) {
-      try {
-        credential.refreshToken();
-      } catch (IOException e) {
-        // Nothing we can do here.
-        // Don't log since logger is not available in standalone service account auth utility.
-      }
-    }
-
-    String accessToken = credential.getAccessToken();
-    return (accessToken == null) ? "" : accessToken;
+  public String getAccessToken() {
+    return accessTokenCache.get();
   }
 
   @Override
   public void shutdown() {
-    // TODO(vlif): implement if not handled properly by JVM shutdown.
+    accessTokenCache.shutdown();
+  }
+
+  /**
+   * Exchanges the service account private key for a new access token.
+   *
+   * @return new access token or null in case of a failure
+   */
+  private AccessTokenCache.Token refreshToken() {
+    try {
+      credential.refreshToken();
+    } catch (IOException e) {
+      // Nothing we can do here.
+      // Don't log since logger is not available in standalone service account auth utility.
+      return null;
+    }
+
+    String accessToken = credential.getAccessToken();
+    Long expiresIn = credential.getExpiresInSeconds();
+    if (accessToken == null) {
+      return null;
+    }
+
+    return new AccessTokenCache.Token(accessToken, (expiresIn == null) ? 0 : expiresIn);
   }
 }
@@ -29,7 +29,10 @@ final class Statistician {
       "condition_evaluation_time_micros",
       "formatting_time_micros",
       "class_prepare_time_micros",
-      "breakpoints_update_time_micros"
+      "breakpoints_update_time_micros",
+      "transmit_compression_ratio_percent",
+      "transmit_compression_time_micros",
+      "hub_connection_reuse_rate_percent"
   };
   
   private final int count;
@@ -37,13 +40,33 @@ final class Statistician {
   private final double max;
   private final double mean;
   private final double stdev;
+  private final double p50;
+  private final double p90;
+  private final double p99;
+  private final double p999;
 
-  private Statistician(int count, double min, double max, double mean, double stdev) {
+  /**
+   * Called from the agent native code.
+   */
+  private Statistician(
+      int count,
+      double min,
+      double max,
+      double mean,
+      double stdev,
+      double p50,
+      double p90,
+      double p99,
+      double p999) {
     this.count = count;
     this.min = min;
     this.max = max;
     this.mean = mean;
     this.stdev = stdev;
+    this.p50 = p50;
+    this.p90 = p90;
+    this.p99 = p99;
+    this.p999 = p999;
   }
  
   /**
@@ -53,6 +76,14 @@ final class Statistician {
    * @return statistics of the variable or null if variable with the specified name not defined
    */
   static native Statistician getStatistics(String name);
+
+  /**
+   * Adds a new sample to the statistics of the specified variable in the agent native code.
+   *
+   * @param name variable name
+   * @param sample value of the new sample
+   */
+  static native void addSample(String name, double sample);
   
   /**
    * Gets the number of samples added.
@@ -88,4 +119,32 @@ final class Statistician {
   double getStdev() {
     return stdev;
   }
+
+  /**
+   * Gets the median of the samples (approximate).
+   */
+  double getP50() {
+    return p50;
+  }
+
+  /**
+   * Gets the 90th percentile of the samples (approximate).
+   */
+  double getP90() {
+    return p90;
+  }
+
+  /**
+   * Gets the 99th percentile of the samples (approximate).
+   */
+  double getP99() {
+    return p99;
+  }
+
+  /**
+   * Gets the 99.9th percentile of the samples (approximate).
+   */
+  double getP999() {
+    return p999;
+  }
 }
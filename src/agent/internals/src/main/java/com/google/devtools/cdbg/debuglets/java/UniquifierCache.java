@@ -0,0 +1,165 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.google.devtools.cdbg.debuglets.java;
+
+import static com.google.devtools.cdbg.debuglets.java.AgentLogger.infofmt;
+import static com.google.devtools.cdbg.debuglets.java.AgentLogger.warnfmt;
+import static java.nio.charset.StandardCharsets.UTF_8;
+
+import java.io.File;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.file.Files;
+import java.nio.file.StandardCopyOption;
+import java.security.MessageDigest;
+import java.security.NoSuchAlgorithmException;
+import java.util.SortedSet;
+
+import javax.xml.bind.DatatypeConverter;
+
+/**
+ * Persistent cache of debuggee uniquifiers computed by {@link UniquifierComputer}.
+ *
+ * <p>Computing the uniquifier reads every application .jar file, which delays the debuggee
+ * registration on large deployments. The uniquifier is a function of the initialization vector
+ * and the content of the application files. This class approximates the content with a cheap
+ * fingerprint of the file paths, sizes and modification times (same as the build systems do)
+ * and stores the computed uniquifier in a file named after the fingerprint. If the fingerprint
+ * matches on the next start, the application files are not read at all.
+ *
+ * <p>The cache files are stored in the same directory as {@link ResourcesIndexCache} files
+ * (configured through the {@code com.google.cdbg.resourcesindexcache} system property). The
+ * cache is disabled if the property is not set.
+ *
+ * <p>This class is thread safe.
+ */
+final class UniquifierCache {
+  /**
+   * Extension of the cache files.
+   */
+  private static final String EXTENSION = ".uniquifier";
+
+  /**
+   * Directory with the cache files or null if the cache is disabled.
+   */
+  private final File directory;
+
+  /**
+   * Creates the cache in the specified directory. If {@code directory} is null, the cache is
+   * disabled.
+   */
+  UniquifierCache(File directory) {
+    this.directory = directory;
+  }
+
+  /**
+   * Creates the cache in the directory configured through the system property.
+   */
+  static UniquifierCache fromSystemProperties() {
+    String path = System.getProperty(ResourcesIndexCache.CACHE_DIRECTORY_PROPERTY);
+    if ((path == null) || path.isEmpty()) {
+      return new UniquifierCache(null);
+    }
+
+    File directory = new File(path);
+    if (!directory.isDirectory()) {
+      return new UniquifierCache(null);
+    }
+
+    return new UniquifierCache(directory);
+  }
+
+  /**
+   * Gets the uniquifier of the application files either from the cache or by computing it with
+   * {@link UniquifierComputer}.
+   *
+   * @param initializationVector initialization vector for the hash computation
+   * @param applicationFiles list of files in standard JVM class path and extra class path
+   */
+  String getUniquifier(String initializationVector, SortedSet<String> applicationFiles)
+      throws NoSuchAlgorithmException {
+    if (directory == null) {
+      return new UniquifierComputer(initializationVector, applicationFiles).getUniquifier();
+    }
+
+    File cacheFile = new File(
+        directory,
+        computeFingerprint(initializationVector, applicationFiles) + EXTENSION);
+
+    if (cacheFile.isFile()) {
+      try {
+        String uniquifier = new String(Files.readAllBytes(cacheFile.toPath()), UTF_8);
+        if (!uniquifier.isEmpty()) {
+          infofmt("Debuggee uniquifier loaded from %s", cacheFile);
+          return uniquifier;
+        }
+      } catch (IOException e) {
+        warnfmt(e, "Failed to read debuggee uniquifier cache file %s", cacheFile);
+      }
+    }
+
+    String uniquifier =
+        new UniquifierComputer(initializationVector, applicationFiles).getUniquifier();
+
+    // Write the cache file atomically, since multiple instances of the application may share
+    // the cache directory.
+    File temporaryFile = null;
+    try {
+      temporaryFile = File.createTempFile(cacheFile.getName(), ".tmp", directory);
+      Files.write(temporaryFile.toPath(), uniquifier.getBytes(UTF_8));
+      Files.move(
+          temporaryFile.toPath(),
+          cacheFile.toPath(),
+          StandardCopyOption.REPLACE_EXISTING,
+          StandardCopyOption.ATOMIC_MOVE);
+      temporaryFile = null;
+    } catch (IOException e) {
+      warnfmt(e, "Failed to store debuggee uniquifier cache file %s", cacheFile);
+    } finally {
+      if (temporaryFile != null) {
+        temporaryFile.delete();
+      }
+    }
+
+    return uniquifier;
+  }
+
+  /**
+   * Computes SHA1 hash of the initialization vector and of path, size and modification time of
+   * each application file.
+   */
+  private static String computeFingerprint(
+      String initializationVector,
+      SortedSet<String> applicationFiles) throws NoSuchAlgorithmException {
+    MessageDigest hash = MessageDigest.getInstance("SHA1");
+    hash.update(initializationVector.getBytes(UTF_8));
+
+    ByteBuffer buffer = ByteBuffer.allocate(2 * Long.SIZE / 8);
+    for (String applicationFile : applicationFiles) {
+      File file = new File(applicationFile);
+
+      hash.update(applicationFile.getBytes(UTF_8));
+      hash.update((byte) 0);
+
+      buffer.putLong(0, file.length());
+      buffer.putLong(Long.SIZE / 8, file.lastModified());
+      hash.update(buffer.array());
+    }
+
+    return DatatypeConverter.printHexBinary(hash.digest());
+  }
+}
@@ -44,6 +44,8 @@ bool IterableTypeEvaluator::Initialize() {
     return false;
   }
 
+  jdk_collections_reader_.Initialize();
+
   return true;
 }
 
@@ -57,6 +59,58 @@ bool IterableTypeEvaluator::IsIterable(jclass cls) const {
 }
 
 
+void IterableTypeEvaluator::Evaluate(
+    MethodCaller* method_caller,
+    const ClassMetadataReader::Entry& class_metadata,
+    jobject obj,
+    std::vector<NamedJVariant>* members) {
+  std::vector<JniLocalRef> elements;
+  if (!jdk_collections_reader_.ReadList(
+          class_metadata.signature,
+          obj,
+          kMaxCaptureObjectElements,
+          &elements)) {
+    Evaluate(method_caller, obj, members);
+    return;
+  }
+
+  members->clear();
+  members->reserve(elements.size() + 1);
+
+  for (JniLocalRef& element : elements) {
+    NamedJVariant item;
+    item.name = FormatArrayIndexName(members->size());
+    item.value = JVariant::LocalRef(std::move(element));
+
+    members->push_back(std::move(item));
+  }
+
+  AppendCollectionStatus(members);
+}
+
+
+void IterableTypeEvaluator::AppendCollectionStatus(
+    std::vector<NamedJVariant>* members) {
+  // Same as the iterator based evaluation below, which stops after
+  // "kMaxCaptureObjectElements" elements.
+  if (members->size() >= kMaxCaptureObjectElements) {
+    members->push_back(NamedJVariant::InfoStatus({
+      CollectionNotAllItemsCaptured,
+      { std::to_string(members->size()) }
+    }));
+  }
+
+  if (members->empty()) {
+    members->resize(1);
+
+    (*members)[0].status.is_error = false;
+    (*members)[0].status.refers_to =
+        StatusMessageModel::Context::VARIABLE_NAME;
+    (*members)[0].status.description = { EmptyCollection };
+  }
+}
+
+
 void IterableTypeEvaluator::Evaluate(
     MethodCaller* method_caller,
     jobject obj,
@@ -123,7 +177,6 @@ void IterableTypeEvaluator::Evaluate(
     NamedJVariant item;
     item.name = FormatArrayIndexName(members->size());
     item.value = ErrorOr<JVariant>::detach_value(std::move(next));
-    item.value.change_ref_type(JVariant::ReferenceKind::Global);
 
     members->push_back(std::move(item));
   }
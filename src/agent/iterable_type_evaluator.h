@@ -19,6 +19,7 @@
 
 #include <memory>
 #include "common.h"
+#include "jdk_collections_reader.h"
 #include "jni_utils.h"
 #include "type_evaluator.h"
 
@@ -30,6 +31,8 @@ struct NamedJVariant;
 
 // Captures elements of a Java class that implements Iterable interface.
 // This class doesn't verify that the object is safe for method calls.
+// Elements of "java.util.ArrayList" and "java.util.ArrayDeque" are read
+// directly from the backing array when possible.
 class IterableTypeEvaluator : public TypeEvaluator {
  public:
   IterableTypeEvaluator();
@@ -49,19 +52,25 @@ class IterableTypeEvaluator : public TypeEvaluator {
       MethodCaller* method_caller,
       const ClassMetadataReader::Entry& class_metadata,
       jobject obj,
-      std::vector<NamedJVariant>* members) override {
-    Evaluate(method_caller, obj, members);
-  }
+      std::vector<NamedJVariant>* members) override;
 
   void Evaluate(
       MethodCaller* method_caller,
       jobject obj,
       std::vector<NamedJVariant>* members);
 
+  // Adds the status message of a collection captured without the iterator
+  // (either an empty collection or a collection that was not captured in
+  // full).
+  static void AppendCollectionStatus(std::vector<NamedJVariant>* members);
+
  private:
   // "java.lang.Iterable" class object.
   JavaClass iterable_;
 
+  // Fast path for the most common JDK collections.
+  JdkCollectionsReader jdk_collections_reader_;
+
   // Method metadata for the Java methods this pretty printer is using.
   const ClassMetadataReader::Method iterable_iterator_;
   const ClassMetadataReader::Method iterator_has_next_;
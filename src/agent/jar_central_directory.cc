@@ -0,0 +1,179 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jar_central_directory.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+
+namespace devtools {
+namespace cdbg {
+
+// Signatures of the zip records (see APPNOTE.TXT of the zip format).
+static constexpr uint32 kEndOfCentralDirectorySignature = 0x06054b50;
+static constexpr uint32 kCentralDirectoryHeaderSignature = 0x02014b50;
+
+// Size of the fixed part of the end of central directory record.
+static constexpr int kEndOfCentralDirectorySize = 22;
+
+// Size of the fixed part of the central directory file header.
+static constexpr int kCentralDirectoryHeaderSize = 46;
+
+// Maximum length of the zip file comment following the end of central
+// directory record.
+static constexpr int kMaxCommentSize = 0xFFFF;
+
+// Marks values moved to the ZIP64 end of central directory record.
+static constexpr uint16 kZip64Marker16 = 0xFFFF;
+static constexpr uint32 kZip64Marker32 = 0xFFFFFFFF;
+
+
+static uint16 ReadUInt16(const uint8* p) {
+  return p[0] | (p[1] << 8);
+}
+
+
+static uint32 ReadUInt32(const uint8* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32>(p[3]) << 24);
+}
+
+
+// Locates the end of central directory record scanning backwards, since the
+// record may be followed by a variable length comment. Returns nullptr if
+// not found.
+static const uint8* FindEndOfCentralDirectory(const uint8* data, int64 size) {
+  if (size < kEndOfCentralDirectorySize) {
+    return nullptr;
+  }
+
+  const uint8* const lowest = data + std::max<int64>(
+      0,
+      size - kEndOfCentralDirectorySize - kMaxCommentSize);
+  for (const uint8* p = data + size - kEndOfCentralDirectorySize;
+       p >= lowest;
+       --p) {
+    if ((ReadUInt32(p) == kEndOfCentralDirectorySignature) &&
+        (p + kEndOfCentralDirectorySize + ReadUInt16(p + 20) ==
+         data + size)) {
+      return p;
+    }
+  }
+
+  return nullptr;
+}
+
+
+// Parses the central directory of a memory mapped zip file.
+static bool ParseCentralDirectory(
+    const uint8* data,
+    int64 size,
+    string* names) {
+  const uint8* eocd = FindEndOfCentralDirectory(data, size);
+  if (eocd == nullptr) {
+    return false;
+  }
+
+  const uint16 disk_number = ReadUInt16(eocd + 4);
+  const uint16 central_directory_disk = ReadUInt16(eocd + 6);
+  const uint16 entries_count = ReadUInt16(eocd + 10);
+  const uint32 central_directory_size = ReadUInt32(eocd + 12);
+  const uint32 central_directory_offset = ReadUInt32(eocd + 16);
+
+  if ((disk_number != 0) || (central_directory_disk != 0)) {
+    return false;  // Multi-disk archives are not supported.
+  }
+
+  if ((entries_count == kZip64Marker16) ||
+      (central_directory_size == kZip64Marker32) ||
+      (central_directory_offset == kZip64Marker32)) {
+    return false;  // ZIP64 is not supported.
+  }
+
+  const int64 central_directory_end =
+      static_cast<int64>(central_directory_offset) + central_directory_size;
+  if (central_directory_end > eocd - data) {
+    return false;
+  }
+
+  const uint8* p = data + central_directory_offset;
+  const uint8* const end = data + central_directory_end;
+  for (int i = 0; i < entries_count; ++i) {
+    if ((end - p < kCentralDirectoryHeaderSize) ||
+        (ReadUInt32(p) != kCentralDirectoryHeaderSignature)) {
+      return false;
+    }
+
+    const uint16 name_length = ReadUInt16(p + 28);
+    const uint16 extra_length = ReadUInt16(p + 30);
+    const uint16 comment_length = ReadUInt16(p + 32);
+
+    const int64 header_size = static_cast<int64>(kCentralDirectoryHeaderSize) +
+                              name_length + extra_length + comment_length;
+    if (end - p < header_size) {
+      return false;
+    }
+
+    const char* name =
+        reinterpret_cast<const char*>(p + kCentralDirectoryHeaderSize);
+    if ((name_length > 0) && (name[name_length - 1] != '/')) {
+      names->append(name, name_length);
+      names->push_back('\0');
+    }
+
+    p += header_size;
+  }
+
+  return true;
+}
+
+
+bool ReadJarFileNames(const string& path, string* names) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    return false;
+  }
+
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || (st.st_size <= 0)) {
+    close(fd);
+    return false;
+  }
+
+  void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // The mapping keeps the file referenced.
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  const size_t original_size = names->size();
+  const bool rc = ParseCentralDirectory(
+      static_cast<const uint8*>(data),
+      st.st_size,
+      names);
+  if (!rc) {
+    names->resize(original_size);
+  }
+
+  munmap(data, st.st_size);
+
+  return rc;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,42 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_JAR_CENTRAL_DIRECTORY_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_JAR_CENTRAL_DIRECTORY_H_
+
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Reads the names of the files in a .jar (zip) file from its central
+// directory. The file is memory mapped and only the end of central directory
+// record and the central directory itself are touched, so nothing is
+// decompressed and no per entry objects are allocated on Java heap (unlike
+// enumerating the entries with "java.util.jar.JarFile").
+//
+// The names of all the entries that are not directories are appended to
+// "names", each one terminated with '\0'. Returns false if the file can't be
+// read or uses a zip feature this reader doesn't support (ZIP64 or multi-disk
+// archives). The caller should then fall back to the Java zip APIs.
+//
+// This function is thread safe.
+bool ReadJarFileNames(const string& path, string* names);
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_JAR_CENTRAL_DIRECTORY_H_
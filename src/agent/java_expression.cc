@@ -17,6 +17,7 @@
 #include "java_expression.h"
 
 #include <iomanip>
+#include "array_aggregate_evaluator.h"
 #include "array_expression_evaluator.h"
 #include "binary_expression_evaluator.h"
 #include "conditional_operator_evaluator.h"
@@ -27,7 +28,9 @@
 #include "messages.h"
 #include "method_call_evaluator.h"
 #include "model.h"
+#include "shared_subexpression_evaluator.h"
 #include "string_evaluator.h"
+#include "string_intrinsic_evaluator.h"
 #include "type_cast_operator_evaluator.h"
 #include "unary_expression_evaluator.h"
 
@@ -805,6 +808,23 @@ CompiledExpression MethodCallExpression::CreateEvaluator() {
   CompiledExpression source_evaluator;
   string possible_class_name;
 
+  // Comparisons of a string to a string literal get a second copy of the
+  // source evaluator for "StringIntrinsicEvaluator".
+  StringIntrinsic intrinsic;
+  std::vector<jchar> literal;
+  CompiledExpression intrinsic_source_evaluator;
+  auto first_argument = arguments_->begin();
+  if ((source_ != nullptr) &&
+      StringIntrinsicFromName(method_, &intrinsic) &&
+      (first_argument != arguments_->end()) &&
+      (std::next(first_argument) == arguments_->end()) &&
+      (*first_argument)->TryGetStringLiteral(&literal)) {
+    intrinsic_source_evaluator = source_->CreateEvaluator();
+    if (intrinsic_source_evaluator.evaluator == nullptr) {
+      return intrinsic_source_evaluator;
+    }
+  }
+
   if (source_ != nullptr) {
     source_evaluator = source_->CreateEvaluator();
     if (source_evaluator.evaluator == nullptr) {
@@ -827,14 +847,51 @@ CompiledExpression MethodCallExpression::CreateEvaluator() {
     argument_evaluators.push_back(std::move(argument_evaluator.evaluator));
   }
 
-  return {
-    std::unique_ptr<ExpressionEvaluator>(
-        new MethodCallEvaluator(
+  std::unique_ptr<ExpressionEvaluator> evaluator(
+      new MethodCallEvaluator(
+          method_,
+          std::move(source_evaluator.evaluator),
+          possible_class_name,
+          std::move(argument_evaluators)));
+
+  if (intrinsic_source_evaluator.evaluator != nullptr) {
+    evaluator.reset(
+        new StringIntrinsicEvaluator(
+            intrinsic,
+            std::move(literal),
+            std::move(intrinsic_source_evaluator.evaluator),
+            std::move(evaluator)));
+  }
+
+  // Unqualified calls of built-in aggregate functions (e.g. "sum(a)") are
+  // resolved at compile time: the method of the same name if there is one,
+  // otherwise the built-in function over a primitive array.
+  ArrayAggregate aggregate;
+  if ((source_ == nullptr) && ArrayAggregateFromName(method_, &aggregate)) {
+    std::vector<std::unique_ptr<ExpressionEvaluator>> aggregate_arguments;
+    for (std::unique_ptr<JavaExpression>& argument : *arguments_) {
+      CompiledExpression argument_evaluator = argument->CreateEvaluator();
+      if (argument_evaluator.evaluator == nullptr) {
+        return argument_evaluator;
+      }
+
+      aggregate_arguments.push_back(std::move(argument_evaluator.evaluator));
+    }
+
+    evaluator.reset(
+        new ArrayAggregateEvaluator(
             method_,
-            std::move(source_evaluator.evaluator),
-            possible_class_name,
-            std::move(argument_evaluators)))
-  };
+            aggregate,
+            std::move(aggregate_arguments),
+            std::move(evaluator)));
+  }
+
+  if (shared_slot_ != -1) {
+    evaluator.reset(
+        new SharedSubexpressionEvaluator(shared_slot_, std::move(evaluator)));
+  }
+
+  return { std::move(evaluator) };
 }
 
 
@@ -45,6 +45,11 @@ class JavaExpression {
   // converted to "java.lang.String". At the same time (a+b) cannot.
   virtual bool TryGetTypeName(string* name) const = 0;
 
+  // Gets the characters of the expression if it is a string literal.
+  virtual bool TryGetStringLiteral(std::vector<jchar>* str) const {
+    return false;
+  }
+
   // Compiles the expression into executable format. The caller owns the
   // returned instance. If a particular language feature is not yet supported,
   // the function returns null and prints description in "error_message".
@@ -234,6 +239,11 @@ class JavaStringLiteral : public JavaExpression {
 
   bool TryGetTypeName(string* name) const override { return false; }
 
+  bool TryGetStringLiteral(std::vector<jchar>* str) const override {
+    *str = str_;
+    return true;
+  }
+
   CompiledExpression CreateEvaluator() override;
 
  private:
@@ -430,10 +440,20 @@ class MethodCallExpression : public JavaExpressionSelector {
 
   CompiledExpression CreateEvaluator() override;
 
+  // Marks the method call as shared with other expressions of the same
+  // breakpoint. The call will be evaluated through
+  // "SharedSubexpressionEvaluator" with the value kept in "slot".
+  void set_shared_slot(int slot) {
+    shared_slot_ = slot;
+  }
+
  private:
   const string method_;
   std::unique_ptr<MethodArguments> arguments_;
 
+  // Slot of the shared method call value or -1 if the call is not shared.
+  int shared_slot_ { -1 };
+
   DISALLOW_COPY_AND_ASSIGN(MethodCallExpression);
 };
 
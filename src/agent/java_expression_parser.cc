@@ -0,0 +1,1050 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "java_expression_parser.h"
+
+#include <algorithm>
+#include "messages.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Number of binary operator precedence levels (see "GetBinaryOperator").
+static constexpr int kBinaryPrecedenceLevels = 10;
+
+static bool IsDecDigit(char ch) {
+  return (ch >= '0') && (ch <= '9');
+}
+
+
+static bool IsOctDigit(char ch) {
+  return (ch >= '0') && (ch <= '7');
+}
+
+
+static bool IsHexDigit(char ch) {
+  return IsDecDigit(ch) ||
+         ((ch >= 'a') && (ch <= 'f')) ||
+         ((ch >= 'A') && (ch <= 'F'));
+}
+
+
+static bool IsIdentifierStart(char ch) {
+  return ((ch >= 'a') && (ch <= 'z')) ||
+         ((ch >= 'A') && (ch <= 'Z')) ||
+         (ch == '$') ||
+         (ch == '_');
+}
+
+
+static bool IsIdentifierPart(char ch) {
+  return IsIdentifierStart(ch) || IsDecDigit(ch);
+}
+
+
+// Characters 0 to 2 are not allowed anywhere in the expression.
+static bool IsValidCharacter(char ch) {
+  return static_cast<unsigned char>(ch) >= 3;
+}
+
+
+JavaExpressionParser::NestingGuard::NestingGuard(JavaExpressionParser* parser)
+    : parser_(parser) {
+  if (++parser_->nesting_ > kMaxTreeDepth) {
+    parser_->too_deep_ = true;
+  }
+}
+
+
+JavaExpressionParser::JavaExpressionParser(const string& text)
+    : text_(text) {
+}
+
+
+std::unique_ptr<JavaExpression> JavaExpressionParser::Parse() {
+  if (!Tokenize()) {
+    LOG(WARNING) << "Invalid token in expression at position "
+                 << error_position_;
+    error_message_ = { ExpressionParserError };
+    return nullptr;
+  }
+
+  Parsed<JavaExpression> statement = ParseStatement();
+
+  if (error_position_ != -1) {
+    LOG(WARNING) << "Syntax error in expression at position "
+                 << error_position_;
+    error_message_ = { ExpressionParserError };
+    return nullptr;
+  }
+
+  if (too_deep_ || (statement.depth > kMaxTreeDepth)) {
+    LOG(WARNING) << "The parsed expression tree is too deep";
+    error_message_ = { ExpressionTreeTooDeep };
+    return nullptr;
+  }
+
+  if (statement.value == nullptr) {
+    // Set generic error message if specific error wasn't set.
+    SetErrorMessage({ ExpressionParserError });
+  }
+
+  return std::move(statement.value);
+}
+
+
+bool JavaExpressionParser::Tokenize() {
+  const int size = text_.size();
+
+  tokens_.clear();
+  tokens_.reserve(size / 2 + 1);
+
+  int pos = 0;
+  while (true) {
+    if (!SkipWhitespacesAndComments(&pos)) {
+      error_position_ = pos;
+      return false;
+    }
+
+    if (pos >= size) {
+      break;
+    }
+
+    const char ch = text_[pos];
+    const int begin = pos;
+    Token token { TokenType::END, begin, 0 };
+
+    if (IsDecDigit(ch) || (ch == '.')) {
+      if (!ScanNumericLiteral(&pos, &token.type)) {
+        error_position_ = begin;
+        return false;
+      }
+
+      token.length = pos - begin;
+    } else if ((ch == '\'') || (ch == '"')) {
+      if (!ScanQuotedLiteral(&pos, ch)) {
+        error_position_ = begin;
+        return false;
+      }
+
+      token.type = (ch == '\'')
+          ? TokenType::CHARACTER_LITERAL
+          : TokenType::STRING_LITERAL;
+      token.begin = begin + 1;
+      token.length = pos - begin - 2;
+    } else if (IsIdentifierStart(ch)) {
+      while ((pos < size) && IsIdentifierPart(text_[pos])) {
+        ++pos;
+      }
+
+      token.type = TokenType::IDENTIFIER;
+      token.length = pos - begin;
+
+      if (text_.compare(begin, token.length, "null") == 0) {
+        token.type = TokenType::JNULL;
+      } else if (text_.compare(begin, token.length, "true") == 0) {
+        token.type = TokenType::JTRUE;
+      } else if (text_.compare(begin, token.length, "false") == 0) {
+        token.type = TokenType::JFALSE;
+      }
+    } else {
+      token.type = ScanOperator(&pos);
+      if (token.type == TokenType::END) {
+        error_position_ = begin;
+        return false;
+      }
+
+      token.length = pos - begin;
+    }
+
+    tokens_.push_back(token);
+  }
+
+  tokens_.push_back({ TokenType::END, size, 0 });
+
+  return true;
+}
+
+
+bool JavaExpressionParser::ScanNumericLiteral(
+    int* pos,
+    TokenType* type) const {
+  const int size = text_.size();
+  auto at = [this, size] (int index) {
+    return (index < size) ? text_[index] : '\0';
+  };
+
+  int p = *pos;
+
+  if ((at(p) == '0') && (at(p + 1) == 'x')) {
+    // Hex: 0x12AB, 0x34CDL.
+    p += 2;
+    if (!IsHexDigit(at(p))) {
+      return false;
+    }
+
+    while (IsHexDigit(at(p))) {
+      ++p;
+    }
+
+    if ((at(p) == 'l') || (at(p) == 'L')) {
+      ++p;
+    }
+
+    *type = TokenType::HEX_NUMERIC_LITERAL;
+    *pos = p;
+    return true;
+  }
+
+  if ((at(p) == '0') && IsOctDigit(at(p + 1))) {
+    // Octal: 01234, 05670L.
+    ++p;
+    while (IsOctDigit(at(p))) {
+      ++p;
+    }
+
+    if ((at(p) == 'l') || (at(p) == 'L')) {
+      ++p;
+    }
+
+    *type = TokenType::OCT_NUMERIC_LITERAL;
+    *pos = p;
+    return true;
+  }
+
+  int digits_end = p;
+  while (IsDecDigit(at(digits_end))) {
+    ++digits_end;
+  }
+
+  const char suffix = at(digits_end);
+
+  if ((suffix == '.') && IsDecDigit(at(digits_end + 1))) {
+    // Floating point: 12.3, .4, 5.6f, .6d.
+    p = digits_end + 1;
+    while (IsDecDigit(at(p))) {
+      ++p;
+    }
+
+    const char fp_suffix = at(p);
+    if ((fp_suffix == 'd') || (fp_suffix == 'D') ||
+        (fp_suffix == 'f') || (fp_suffix == 'F')) {
+      ++p;
+    }
+
+    *type = TokenType::FP_NUMERIC_LITERAL;
+    *pos = p;
+    return true;
+  }
+
+  if (digits_end == p) {
+    // Just a dot.
+    *type = TokenType::DOT;
+    *pos = p + 1;
+    return true;
+  }
+
+  if ((suffix == 'd') || (suffix == 'D') || (suffix == 'f') ||
+      (suffix == 'F')) {
+    // Floating point: 12f, 34d.
+    *type = TokenType::FP_NUMERIC_LITERAL;
+    *pos = digits_end + 1;
+    return true;
+  }
+
+  // Decimal: 123, 456L.
+  p = digits_end;
+  if ((suffix == 'l') || (suffix == 'L')) {
+    ++p;
+  }
+
+  *type = TokenType::DEC_NUMERIC_LITERAL;
+  *pos = p;
+  return true;
+}
+
+
+bool JavaExpressionParser::ScanQuotedLiteral(int* pos, char quote) const {
+  const int size = text_.size();
+  int p = *pos + 1;
+
+  if (quote == '\'') {
+    // Exactly one character or escape sequence.
+    if ((p >= size) || !IsValidCharacter(text_[p]) || (text_[p] == '\'')) {
+      return false;
+    }
+
+    if (text_[p] == '\\') {
+      if (!ScanEscapeSequence(&p)) {
+        return false;
+      }
+    } else {
+      ++p;
+    }
+  } else {
+    while ((p < size) && (text_[p] != quote)) {
+      if (!IsValidCharacter(text_[p])) {
+        return false;
+      }
+
+      if (text_[p] == '\\') {
+        if (!ScanEscapeSequence(&p)) {
+          return false;
+        }
+      } else {
+        ++p;
+      }
+    }
+  }
+
+  if ((p >= size) || (text_[p] != quote)) {
+    return false;
+  }
+
+  *pos = p + 1;
+  return true;
+}
+
+
+bool JavaExpressionParser::ScanEscapeSequence(int* pos) const {
+  const int size = text_.size();
+  auto at = [this, size] (int index) {
+    return (index < size) ? text_[index] : '\0';
+  };
+
+  int p = *pos + 1;  // Skip the backslash.
+  const char ch = at(p);
+
+  switch (ch) {
+    case 'b':
+    case 't':
+    case 'n':
+    case 'f':
+    case 'r':
+    case '"':
+    case '\'':
+    case '\\':
+      *pos = p + 1;
+      return true;
+
+    case 'u':
+      for (int i = 1; i <= 4; ++i) {
+        if (!IsHexDigit(at(p + i))) {
+          return false;
+        }
+      }
+
+      *pos = p + 5;
+      return true;
+  }
+
+  if (!IsOctDigit(ch)) {
+    return false;
+  }
+
+  // Only the first octal digit is part of the escape sequence. Strings keep
+  // the escape sequences unchanged in the token text, so the following digits
+  // end up there anyway. Character literals with more than one octal digit
+  // are rejected.
+  *pos = p + 1;
+  return true;
+}
+
+
+bool JavaExpressionParser::SkipWhitespacesAndComments(int* pos) const {
+  const int size = text_.size();
+  int p = *pos;
+
+  while (p < size) {
+    const char ch = text_[p];
+    if ((ch == '\t') || (ch == '\r') || (ch == '\n') || (ch == ' ')) {
+      ++p;
+      continue;
+    }
+
+    if ((ch != '/') || (p + 1 >= size)) {
+      break;
+    }
+
+    if (text_[p + 1] == '*') {
+      // Block comment. An unterminated comment is invalid.
+      p += 2;
+      while ((p + 1 < size) && !((text_[p] == '*') && (text_[p + 1] == '/'))) {
+        if (!IsValidCharacter(text_[p])) {
+          *pos = p;
+          return false;
+        }
+
+        ++p;
+      }
+
+      if (p + 1 >= size) {
+        *pos = p;
+        return false;
+      }
+
+      p += 2;
+    } else if (text_[p + 1] == '/') {
+      // Line comment.
+      p += 2;
+      while ((p < size) && (text_[p] != '\r') && (text_[p] != '\n')) {
+        if (!IsValidCharacter(text_[p])) {
+          *pos = p;
+          return false;
+        }
+
+        ++p;
+      }
+    } else {
+      break;
+    }
+  }
+
+  *pos = p;
+  return true;
+}
+
+
+JavaExpressionParser::TokenType JavaExpressionParser::ScanOperator(
+    int* pos) const {
+  const int size = text_.size();
+  const int p = *pos;
+  const char next = (p + 1 < size) ? text_[p + 1] : '\0';
+  const char next2 = (p + 2 < size) ? text_[p + 2] : '\0';
+
+  // Single or two character token depending on "next".
+  auto choose = [pos, next] (
+      char second,
+      TokenType two_chars,
+      TokenType one_char) {
+    if (next == second) {
+      *pos += 2;
+      return two_chars;
+    }
+
+    *pos += 1;
+    return one_char;
+  };
+
+  switch (text_[p]) {
+    case '(': *pos += 1; return TokenType::LPAREN;
+    case ')': *pos += 1; return TokenType::RPAREN;
+    case '{': *pos += 1; return TokenType::LBRACE;
+    case '}': *pos += 1; return TokenType::RBRACE;
+    case '[': *pos += 1; return TokenType::LBRACK;
+    case ']': *pos += 1; return TokenType::RBRACK;
+    case ';': *pos += 1; return TokenType::SEMI;
+    case ',': *pos += 1; return TokenType::COMMA;
+    case '~': *pos += 1; return TokenType::TILDE;
+    case '?': *pos += 1; return TokenType::QUESTION;
+    case ':': *pos += 1; return TokenType::COLON;
+    case '+': *pos += 1; return TokenType::ADD;
+    case '-': *pos += 1; return TokenType::SUB;
+    case '*': *pos += 1; return TokenType::MUL;
+    case '/': *pos += 1; return TokenType::DIV;
+    case '^': *pos += 1; return TokenType::CARET;
+    case '%': *pos += 1; return TokenType::MOD;
+
+    case '=': return choose('=', TokenType::EQUAL, TokenType::ASSIGN);
+    case '!': return choose('=', TokenType::NOTEQUAL, TokenType::BANG);
+    case '&': return choose('&', TokenType::AND, TokenType::BITAND);
+    case '|': return choose('|', TokenType::OR, TokenType::BITOR);
+
+    case '<':
+      if (next == '<') {
+        *pos += 2;
+        return TokenType::SHIFT_LEFT;
+      }
+
+      return choose('=', TokenType::CMP_LE, TokenType::CMP_LT);
+
+    case '>':
+      if ((next == '>') && (next2 == '>')) {
+        *pos += 3;
+        return TokenType::SHIFT_RIGHT_U;
+      }
+
+      if (next == '>') {
+        *pos += 2;
+        return TokenType::SHIFT_RIGHT_S;
+      }
+
+      return choose('=', TokenType::CMP_GE, TokenType::CMP_GT);
+  }
+
+  return TokenType::END;
+}
+
+
+JavaExpressionParser::Parsed<JavaExpression>
+JavaExpressionParser::ParseStatement() {
+  Parsed<JavaExpression> expression = ParseExpression();
+  if (failed()) {
+    return Parsed<JavaExpression>();
+  }
+
+  if (Peek() != TokenType::END) {
+    SetSyntaxError();
+    return Parsed<JavaExpression>();
+  }
+
+  ++expression.depth;
+
+  return expression;
+}
+
+
+JavaExpressionParser::Parsed<JavaExpression>
+JavaExpressionParser::ParseExpression() {
+  return ParseConditional();
+}
+
+
+JavaExpressionParser::Parsed<JavaExpression>
+JavaExpressionParser::ParseConditional() {
+  Parsed<JavaExpression> condition = ParseBinary(0);
+  if (failed() || (Peek() != TokenType::QUESTION)) {
+    return condition;
+  }
+
+  NestingGuard nesting_guard(this);
+  ++position_;
+
+  Parsed<JavaExpression> if_true = ParseExpression();
+  if (failed() || !Expect(TokenType::COLON)) {
+    return Parsed<JavaExpression>();
+  }
+
+  Parsed<JavaExpression> if_false = ParseConditional();
+  if (failed()) {
+    return Parsed<JavaExpression>();
+  }
+
+  Parsed<JavaExpression> result;
+  result.depth =
+      1 + std::max({ condition.depth, if_true.depth, 1, if_false.depth });
+
+  if ((condition.value != nullptr) &&
+      (if_true.value != nullptr) &&
+      (if_false.value != nullptr)) {
+    result.value.reset(new ConditionalJavaExpression(
+        condition.value.release(),
+        if_true.value.release(),
+        if_false.value.release()));
+  }
+
+  return result;
+}
+
+
+JavaExpressionParser::Parsed<JavaExpression>
+JavaExpressionParser::ParseBinary(int level) {
+  if (level == kBinaryPrecedenceLevels) {
+    return ParseUnary();
+  }
+
+  Parsed<JavaExpression> left = ParseBinary(level + 1);
+
+  BinaryJavaExpression::Type type;
+  while (!failed() && GetBinaryOperator(Peek(), level, &type)) {
+    ++position_;
+
+    Parsed<JavaExpression> right = ParseBinary(level + 1);
+    if (failed()) {
+      break;
+    }
+
+    Parsed<JavaExpression> result;
+    result.depth = 1 + std::max({ left.depth, 1, right.depth });
+    if ((left.value != nullptr) && (right.value != nullptr)) {
+      result.value.reset(new BinaryJavaExpression(
+          type,
+          left.value.release(),
+          right.value.release()));
+    }
+
+    left = std::move(result);
+  }
+
+  return left;
+}
+
+
+JavaExpressionParser::Parsed<JavaExpression>
+JavaExpressionParser::ParseUnary() {
+  UnaryJavaExpression::Type type;
+  switch (Peek()) {
+    case TokenType::ADD:
+      type = UnaryJavaExpression::Type::plus;
+      break;
+
+    case TokenType::SUB:
+      type = UnaryJavaExpression::Type::minus;
+      break;
+
+    case TokenType::TILDE:
+      type = UnaryJavaExpression::Type::bitwise_complement;
+      break;
+
+    case TokenType::BANG:
+      type = UnaryJavaExpression::Type::logical_complement;
+      break;
+
+    default:
+      return ParseUnaryNotPlusMinus();
+  }
+
+  NestingGuard nesting_guard(this);
+  ++position_;
+
+  Parsed<JavaExpression> operand = ParseUnary();
+  if (failed()) {
+    return Parsed<JavaExpression>();
+  }
+
+  Parsed<JavaExpression> result;
+  result.depth = 1 + std::max(1, operand.depth);
+  if (operand.value != nullptr) {
+    result.value.reset(
+        new UnaryJavaExpression(type, operand.value.release()));
+  }
+
+  return result;
+}
+
+
+JavaExpressionParser::Parsed<JavaExpression>
+JavaExpressionParser::ParseUnaryNotPlusMinus() {
+  if ((Peek() == TokenType::TILDE) || (Peek() == TokenType::BANG)) {
+    return ParseUnary();
+  }
+
+  if (IsCastAhead()) {
+    return ParseCast();
+  }
+
+  Parsed<JavaExpression> primary = ParsePrimary();
+
+  while (!failed() &&
+         ((Peek() == TokenType::DOT) || (Peek() == TokenType::LBRACK))) {
+    Parsed<JavaExpressionSelector> selector = ParseSelector();
+    if (failed()) {
+      break;
+    }
+
+    Parsed<JavaExpression> result;
+    result.depth = 1 + std::max(primary.depth, selector.depth);
+    if ((primary.value != nullptr) && (selector.value != nullptr)) {
+      selector.value->set_source(primary.value.release());
+      result.value = std::move(selector.value);
+    }
+
+    primary = std::move(result);
+  }
+
+  return primary;
+}
+
+
+JavaExpressionParser::Parsed<JavaExpression>
+JavaExpressionParser::ParseCast() {
+  NestingGuard nesting_guard(this);
+  ++position_;  // Skip "(".
+
+  // "IsCastAhead" has already verified the syntax of the type name.
+  string type = TokenText();
+  int type_name_depth = 2;
+  ++position_;
+
+  while (Peek() == TokenType::DOT) {
+    ++position_;
+    type += '.';
+    type += TokenText();
+    ++type_name_depth;
+    ++position_;
+  }
+
+  ++position_;  // Skip ")".
+
+  Parsed<JavaExpression> source = ParseUnaryNotPlusMinus();
+  if (failed()) {
+    return Parsed<JavaExpression>();
+  }
+
+  Parsed<JavaExpression> result;
+  result.depth = 1 + std::max(type_name_depth, source.depth);
+  if (source.value != nullptr) {
+    result.value.reset(
+        new TypeCastJavaExpression(std::move(type), source.value.release()));
+  }
+
+  return result;
+}
+
+
+JavaExpressionParser::Parsed<JavaExpression>
+JavaExpressionParser::ParsePrimary() {
+  if (Peek() == TokenType::LPAREN) {
+    NestingGuard nesting_guard(this);
+    ++position_;
+
+    Parsed<JavaExpression> expression = ParseExpression();
+    if (failed() || !Expect(TokenType::RPAREN)) {
+      return Parsed<JavaExpression>();
+    }
+
+    ++expression.depth;
+
+    return expression;
+  }
+
+  if (Peek() == TokenType::IDENTIFIER) {
+    string identifier = TokenText();
+    ++position_;
+
+    Parsed<JavaExpression> result;
+
+    if (Peek() != TokenType::LPAREN) {
+      result.depth = 1;
+      result.value.reset(new JavaIdentifier(std::move(identifier)));
+      return result;
+    }
+
+    Parsed<MethodArguments> arguments = ParseArguments();
+    if (failed()) {
+      return Parsed<JavaExpression>();
+    }
+
+    result.depth = 1 + std::max(1, arguments.depth);
+    if (arguments.value != nullptr) {
+      MethodCallExpression* method_call = new MethodCallExpression(
+          identifier,
+          arguments.value.release());
+      method_calls_.push_back(method_call);
+      result.value.reset(method_call);
+    }
+
+    return result;
+  }
+
+  return ParseLiteral();
+}
+
+
+JavaExpressionParser::Parsed<JavaExpression>
+JavaExpressionParser::ParseLiteral() {
+  const TokenType type = Peek();
+  Parsed<JavaExpression> result;
+  result.depth = 1;
+
+  switch (type) {
+    case TokenType::HEX_NUMERIC_LITERAL:
+    case TokenType::OCT_NUMERIC_LITERAL:
+    case TokenType::DEC_NUMERIC_LITERAL: {
+      const int base = (type == TokenType::HEX_NUMERIC_LITERAL)
+          ? 16
+          : ((type == TokenType::OCT_NUMERIC_LITERAL) ? 8 : 10);
+
+      const string text = TokenText();
+      std::unique_ptr<JavaIntLiteral> literal(new JavaIntLiteral);
+      if (literal->ParseString(text, base)) {
+        result.value = std::move(literal);
+      } else {
+        SetErrorMessage({ BadNumericLiteral, { text } });
+      }
+
+      break;
+    }
+
+    case TokenType::FP_NUMERIC_LITERAL: {
+      const string text = TokenText();
+      std::unique_ptr<JavaFloatLiteral> literal(new JavaFloatLiteral);
+      if (literal->ParseString(text)) {
+        result.value = std::move(literal);
+      } else {
+        SetErrorMessage({ BadNumericLiteral, { text } });
+      }
+
+      break;
+    }
+
+    case TokenType::CHARACTER_LITERAL: {
+      std::unique_ptr<JavaCharLiteral> literal(new JavaCharLiteral);
+      if (literal->ParseString(TokenText())) {
+        result.value = std::move(literal);
+      } else {
+        LOG(WARNING) << "Invalid character literal: " << TokenText();
+      }
+
+      break;
+    }
+
+    case TokenType::STRING_LITERAL: {
+      std::unique_ptr<JavaStringLiteral> literal(new JavaStringLiteral);
+      if (literal->ParseString(TokenText())) {
+        result.value = std::move(literal);
+      } else {
+        LOG(WARNING) << "Invalid string literal: " << TokenText();
+      }
+
+      break;
+    }
+
+    case TokenType::JTRUE:
+      result.value.reset(new JavaBooleanLiteral(JNI_TRUE));
+      break;
+
+    case TokenType::JFALSE:
+      result.value.reset(new JavaBooleanLiteral(JNI_FALSE));
+      break;
+
+    case TokenType::JNULL:
+      result.value.reset(new JavaNullLiteral);
+      break;
+
+    default:
+      SetSyntaxError();
+      return Parsed<JavaExpression>();
+  }
+
+  ++position_;
+
+  return result;
+}
+
+
+JavaExpressionParser::Parsed<JavaExpressionSelector>
+JavaExpressionParser::ParseSelector() {
+  Parsed<JavaExpressionSelector> result;
+
+  if (Peek() == TokenType::LBRACK) {
+    NestingGuard nesting_guard(this);
+    ++position_;
+
+    Parsed<JavaExpression> index = ParseExpression();
+    if (failed() || !Expect(TokenType::RBRACK)) {
+      return Parsed<JavaExpressionSelector>();
+    }
+
+    result.depth = 1 + std::max(index.depth, 1);
+    if (index.value != nullptr) {
+      result.value.reset(
+          new JavaExpressionIndexSelector(index.value.release()));
+    }
+
+    return result;
+  }
+
+  ++position_;  // Skip ".".
+
+  if (Peek() != TokenType::IDENTIFIER) {
+    SetSyntaxError();
+    return Parsed<JavaExpressionSelector>();
+  }
+
+  const string member = TokenText();
+  ++position_;
+
+  if (Peek() != TokenType::LPAREN) {
+    result.depth = 2;
+    result.value.reset(new JavaExpressionMemberSelector(member));
+    return result;
+  }
+
+  Parsed<MethodArguments> arguments = ParseArguments();
+  if (failed()) {
+    return Parsed<JavaExpressionSelector>();
+  }
+
+  result.depth = 2 + std::max(1, arguments.depth);
+  if (arguments.value != nullptr) {
+    MethodCallExpression* method_call =
+        new MethodCallExpression(member, arguments.value.release());
+    method_calls_.push_back(method_call);
+    result.value.reset(method_call);
+  }
+
+  return result;
+}
+
+
+JavaExpressionParser::Parsed<MethodArguments>
+JavaExpressionParser::ParseArguments() {
+  NestingGuard nesting_guard(this);
+  ++position_;  // Skip "(".
+
+  std::vector<Parsed<JavaExpression>> arguments;
+  if (Peek() != TokenType::RPAREN) {
+    while (true) {
+      arguments.push_back(ParseExpression());
+      if (failed()) {
+        return Parsed<MethodArguments>();
+      }
+
+      if (Peek() != TokenType::COMMA) {
+        break;
+      }
+
+      ++position_;
+    }
+  }
+
+  if (!Expect(TokenType::RPAREN)) {
+    return Parsed<MethodArguments>();
+  }
+
+  // Each argument is a node with the argument expression and the list of the
+  // remaining arguments as children.
+  Parsed<MethodArguments> result;
+  bool is_valid = true;
+  for (auto it = arguments.rbegin(); it != arguments.rend(); ++it) {
+    result.depth = 1 + std::max(it->depth, result.depth);
+    is_valid = is_valid && (it->value != nullptr);
+  }
+
+  if (is_valid) {
+    result.value.reset(new MethodArguments);
+    for (auto it = arguments.rbegin(); it != arguments.rend(); ++it) {
+      result.value.reset(
+          new MethodArguments(it->value.release(), result.value.release()));
+    }
+  }
+
+  return result;
+}
+
+
+bool JavaExpressionParser::GetBinaryOperator(
+    TokenType token,
+    int level,
+    BinaryJavaExpression::Type* type) {
+  static const struct {
+    TokenType token;
+    int level;
+    BinaryJavaExpression::Type type;
+  } operators[] = {
+    { TokenType::OR, 0, BinaryJavaExpression::Type::conditional_or },
+    { TokenType::AND, 1, BinaryJavaExpression::Type::conditional_and },
+    { TokenType::BITOR, 2, BinaryJavaExpression::Type::bitwise_or },
+    { TokenType::CARET, 3, BinaryJavaExpression::Type::bitwise_xor },
+    { TokenType::BITAND, 4, BinaryJavaExpression::Type::bitwise_and },
+    { TokenType::EQUAL, 5, BinaryJavaExpression::Type::eq },
+    { TokenType::NOTEQUAL, 5, BinaryJavaExpression::Type::ne },
+    { TokenType::CMP_LE, 6, BinaryJavaExpression::Type::le },
+    { TokenType::CMP_GE, 6, BinaryJavaExpression::Type::ge },
+    { TokenType::CMP_LT, 6, BinaryJavaExpression::Type::lt },
+    { TokenType::CMP_GT, 6, BinaryJavaExpression::Type::gt },
+    { TokenType::SHIFT_LEFT, 7, BinaryJavaExpression::Type::shl },
+    { TokenType::SHIFT_RIGHT_S, 7, BinaryJavaExpression::Type::shr_s },
+    { TokenType::SHIFT_RIGHT_U, 7, BinaryJavaExpression::Type::shr_u },
+    { TokenType::ADD, 8, BinaryJavaExpression::Type::add },
+    { TokenType::SUB, 8, BinaryJavaExpression::Type::sub },
+    { TokenType::MUL, 9, BinaryJavaExpression::Type::mul },
+    { TokenType::DIV, 9, BinaryJavaExpression::Type::div },
+    { TokenType::MOD, 9, BinaryJavaExpression::Type::mod }
+  };
+
+  for (const auto& entry : operators) {
+    if ((entry.token == token) && (entry.level == level)) {
+      *type = entry.type;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+bool JavaExpressionParser::IsCastAhead() const {
+  int index = position_;
+  if ((tokens_[index].type != TokenType::LPAREN) ||
+      (tokens_[index + 1].type != TokenType::IDENTIFIER)) {
+    return false;
+  }
+
+  index += 2;
+  while ((tokens_[index].type == TokenType::DOT) &&
+         (tokens_[index + 1].type == TokenType::IDENTIFIER)) {
+    index += 2;
+  }
+
+  if (tokens_[index].type != TokenType::RPAREN) {
+    return false;
+  }
+
+  // The token following a type name in parentheses can't follow an
+  // expression in parentheses. If it can start an expression, this can only
+  // be a type cast.
+  return CanStartUnaryNotPlusMinus(tokens_[index + 1].type);
+}
+
+
+bool JavaExpressionParser::CanStartUnaryNotPlusMinus(TokenType type) {
+  switch (type) {
+    case TokenType::TILDE:
+    case TokenType::BANG:
+    case TokenType::LPAREN:
+    case TokenType::IDENTIFIER:
+    case TokenType::HEX_NUMERIC_LITERAL:
+    case TokenType::OCT_NUMERIC_LITERAL:
+    case TokenType::FP_NUMERIC_LITERAL:
+    case TokenType::DEC_NUMERIC_LITERAL:
+    case TokenType::CHARACTER_LITERAL:
+    case TokenType::STRING_LITERAL:
+    case TokenType::JTRUE:
+    case TokenType::JFALSE:
+    case TokenType::JNULL:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+
+string JavaExpressionParser::TokenText() const {
+  const Token& token = tokens_[position_];
+  return text_.substr(token.begin, token.length);
+}
+
+
+bool JavaExpressionParser::Expect(TokenType type) {
+  if (Peek() != type) {
+    SetSyntaxError();
+    return false;
+  }
+
+  ++position_;
+  return true;
+}
+
+
+void JavaExpressionParser::SetSyntaxError() {
+  if (error_position_ == -1) {
+    error_position_ = tokens_[position_].begin;
+  }
+}
+
+
+void JavaExpressionParser::SetErrorMessage(
+    FormatMessageModel new_error_message) {
+  if (error_message_.format.empty()) {
+    error_message_ = std::move(new_error_message);
+  }
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,248 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_JAVA_EXPRESSION_PARSER_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_JAVA_EXPRESSION_PARSER_H_
+
+#include <memory>
+#include <vector>
+#include "common.h"
+#include "java_expression.h"
+#include "model.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Hand written recursive descent parser that transforms the text of a debugger
+// expression into "JavaExpression" tree. The parser accepts the subset of
+// Java expressions below (lowest precedence first):
+//
+//   statement: expression EOF
+//   expression: conditional
+//   conditional: or ('?' expression ':' conditional)?
+//   or, and, |, ^, &, equality, relational, shift, additive, multiplicative:
+//       left associative binary operators
+//   unary: ('+' | '-') unary | unaryNotPlusMinus
+//   unaryNotPlusMinus: ('~' | '!') unary | cast | primary selector*
+//   cast: '(' Identifier ('.' Identifier)* ')' unaryNotPlusMinus
+//   primary: '(' expression ')' | Identifier arguments? | literal
+//   selector: '.' Identifier arguments? | '[' expression ']'
+//   arguments: '(' (expression (',' expression)*)? ')'
+//
+// Tokens only refer to the original text, so neither tokenization nor parsing
+// allocates anything other than the nodes of the resulting tree.
+//
+// The expression tree depth is limited to guard against stack overflow in
+// the recursive compilation and evaluation of the tree. The depth is defined
+// on the syntax tree that includes a node for each parenthesis, argument and
+// each component of type names. For example "f((a))" has depth of 5:
+// statement, method call, argument, parentheses and identifier.
+class JavaExpressionParser {
+ public:
+  // Maximum depth of the syntax tree.
+  static constexpr int kMaxTreeDepth = 25;
+
+  // Parser of "text". The string must outlive this instance.
+  explicit JavaExpressionParser(const string& text);
+
+  // Parses the expression. Returns nullptr if the expression is invalid. In
+  // this case "error_message" explains the problem.
+  std::unique_ptr<JavaExpression> Parse();
+
+  // Getter for the formatted error message. The error message is only set
+  // when "Parse" fails.
+  const FormatMessageModel& error_message() const { return error_message_; }
+
+  // Offset of the first character of the token that failed the parsing or -1
+  // if the expression was syntactically correct.
+  int error_position() const { return error_position_; }
+
+  // Method calls in the tree returned by "Parse" (in no particular order).
+  // The nodes are owned by the tree.
+  const std::vector<MethodCallExpression*>& method_calls() const {
+    return method_calls_;
+  }
+
+ private:
+  enum class TokenType {
+    END,
+    IDENTIFIER,
+    HEX_NUMERIC_LITERAL,
+    OCT_NUMERIC_LITERAL,
+    FP_NUMERIC_LITERAL,
+    DEC_NUMERIC_LITERAL,
+    CHARACTER_LITERAL,
+    STRING_LITERAL,
+    JNULL,
+    JTRUE,
+    JFALSE,
+    LPAREN,
+    RPAREN,
+    LBRACE,
+    RBRACE,
+    LBRACK,
+    RBRACK,
+    SEMI,
+    COMMA,
+    DOT,
+    ASSIGN,
+    CMP_GT,
+    CMP_LT,
+    BANG,
+    TILDE,
+    QUESTION,
+    COLON,
+    EQUAL,
+    CMP_LE,
+    CMP_GE,
+    NOTEQUAL,
+    AND,
+    OR,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    BITAND,
+    BITOR,
+    CARET,
+    MOD,
+    SHIFT_LEFT,
+    SHIFT_RIGHT_S,
+    SHIFT_RIGHT_U
+  };
+
+  struct Token {
+    TokenType type;
+
+    // Offset of the token text in "text_". The quotes of character and string
+    // literals are not part of the token text.
+    int begin;
+
+    // Length of the token text.
+    int length;
+  };
+
+  // Parsed subtree along with the depth of its syntax tree. If the subtree
+  // is syntactically correct, but can't be represented (e.g. a numeric
+  // literal out of range), "value" is nullptr.
+  template <typename T>
+  struct Parsed {
+    std::unique_ptr<T> value;
+    int depth = 0;
+  };
+
+  // Limits the recursion depth of the parser to "kMaxTreeDepth" nested
+  // constructs. Each of them adds at least one level to the syntax tree, so
+  // deeper expressions would fail the tree depth check anyway.
+  class NestingGuard {
+   public:
+    explicit NestingGuard(JavaExpressionParser* parser);
+    ~NestingGuard() { --parser_->nesting_; }
+
+   private:
+    JavaExpressionParser* const parser_;
+  };
+
+  // Splits "text_" into "tokens_". Returns false if the text has characters
+  // that don't form a valid token.
+  bool Tokenize();
+
+  // Tokenization helpers. Each of them starts at "*pos" and moves it past
+  // the consumed characters. Return false on invalid input.
+  bool ScanNumericLiteral(int* pos, TokenType* type) const;
+  bool ScanQuotedLiteral(int* pos, char quote) const;
+  bool ScanEscapeSequence(int* pos) const;
+  bool SkipWhitespacesAndComments(int* pos) const;
+  TokenType ScanOperator(int* pos) const;
+
+  // Recursive descent functions for the grammar rules.
+  Parsed<JavaExpression> ParseStatement();
+  Parsed<JavaExpression> ParseExpression();
+  Parsed<JavaExpression> ParseConditional();
+  Parsed<JavaExpression> ParseBinary(int level);
+  Parsed<JavaExpression> ParseUnary();
+  Parsed<JavaExpression> ParseUnaryNotPlusMinus();
+  Parsed<JavaExpression> ParseCast();
+  Parsed<JavaExpression> ParsePrimary();
+  Parsed<JavaExpression> ParseLiteral();
+  Parsed<JavaExpressionSelector> ParseSelector();
+  Parsed<MethodArguments> ParseArguments();
+
+  // Checks whether the tokens at the current position start a type cast (as
+  // opposed to an expression in parentheses).
+  bool IsCastAhead() const;
+
+  // Maps "token" to a binary operator of the precedence "level" (0 is the
+  // lowest). Returns false if the token is not an operator of this level.
+  static bool GetBinaryOperator(
+      TokenType token,
+      int level,
+      BinaryJavaExpression::Type* type);
+
+  // Checks whether "type" can start "unaryNotPlusMinus" rule.
+  static bool CanStartUnaryNotPlusMinus(TokenType type);
+
+  // Gets the type of the current token.
+  TokenType Peek() const { return tokens_[position_].type; }
+
+  // Gets the text of the current token.
+  string TokenText() const;
+
+  // Moves to the next token if the current one is of "type". Otherwise marks
+  // syntax error.
+  bool Expect(TokenType type);
+
+  // Marks syntax error at the current token.
+  void SetSyntaxError();
+
+  // Sets "error_message_" unless an earlier error has already set it.
+  void SetErrorMessage(FormatMessageModel new_error_message);
+
+  // True after a syntax error or once the expression turned out to be too
+  // deep. The parsing is aborted in both cases.
+  bool failed() const { return (error_position_ != -1) || too_deep_; }
+
+  // Expression text.
+  const string& text_;
+
+  // Tokens of "text_" terminated with "TokenType::END".
+  std::vector<Token> tokens_;
+
+  // Index of the current token in "tokens_".
+  int position_ { 0 };
+
+  // Number of nested constructs at the current position.
+  int nesting_ { 0 };
+
+  // Set when "nesting_" exceeds "kMaxTreeDepth".
+  bool too_deep_ { false };
+
+  // See "error_position()".
+  int error_position_ { -1 };
+
+  // Formatted localizable error message. Only the first error is kept.
+  FormatMessageModel error_message_;
+
+  // See "method_calls()".
+  std::vector<MethodCallExpression*> method_calls_;
+
+  DISALLOW_COPY_AND_ASSIGN(JavaExpressionParser);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_JAVA_EXPRESSION_PARSER_H_
@@ -0,0 +1,384 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jdk_collections_reader.h"
+
+#include <algorithm>
+
+namespace devtools {
+namespace cdbg {
+
+void JdkCollectionsReader::Initialize() {
+  if (array_list_.cls.FindWithJNI("java/util/ArrayList")) {
+    array_list_.element_data = FindField(
+        array_list_.cls,
+        "elementData",
+        "[Ljava/lang/Object;");
+    array_list_.size = FindField(array_list_.cls, "size", "I");
+  }
+
+  if (array_deque_.cls.FindWithJNI("java/util/ArrayDeque")) {
+    array_deque_.elements = FindField(
+        array_deque_.cls,
+        "elements",
+        "[Ljava/lang/Object;");
+    array_deque_.head = FindField(array_deque_.cls, "head", "I");
+    array_deque_.tail = FindField(array_deque_.cls, "tail", "I");
+  }
+
+  JavaClass hash_map_node;
+  if (hash_map_.cls.FindWithJNI("java/util/HashMap") &&
+      hash_map_node.FindWithJNI("java/util/HashMap$Node")) {
+    hash_map_.table = FindField(
+        hash_map_.cls,
+        "table",
+        "[Ljava/util/HashMap$Node;");
+    hash_map_.size = FindField(hash_map_.cls, "size", "I");
+    hash_map_.node_key = FindField(
+        hash_map_node,
+        "key",
+        "Ljava/lang/Object;");
+    hash_map_.node_value = FindField(
+        hash_map_node,
+        "value",
+        "Ljava/lang/Object;");
+    hash_map_.node_next = FindField(
+        hash_map_node,
+        "next",
+        "Ljava/util/HashMap$Node;");
+  }
+
+  JavaClass linked_hash_map_entry;
+  if (linked_hash_map_.cls.FindWithJNI("java/util/LinkedHashMap") &&
+      linked_hash_map_entry.FindWithJNI("java/util/LinkedHashMap$Entry")) {
+    linked_hash_map_.head = FindField(
+        linked_hash_map_.cls,
+        "head",
+        "Ljava/util/LinkedHashMap$Entry;");
+    linked_hash_map_.entry_after = FindField(
+        linked_hash_map_entry,
+        "after",
+        "Ljava/util/LinkedHashMap$Entry;");
+  }
+
+  JavaClass concurrent_hash_map_node;
+  if (concurrent_hash_map_.cls.FindWithJNI(
+          "java/util/concurrent/ConcurrentHashMap") &&
+      concurrent_hash_map_node.FindWithJNI(
+          "java/util/concurrent/ConcurrentHashMap$Node")) {
+    concurrent_hash_map_.table = FindField(
+        concurrent_hash_map_.cls,
+        "table",
+        "[Ljava/util/concurrent/ConcurrentHashMap$Node;");
+    concurrent_hash_map_.node_hash = FindField(
+        concurrent_hash_map_node,
+        "hash",
+        "I");
+    concurrent_hash_map_.node_key = FindField(
+        concurrent_hash_map_node,
+        "key",
+        "Ljava/lang/Object;");
+    concurrent_hash_map_.node_value = FindField(
+        concurrent_hash_map_node,
+        "val",
+        "Ljava/lang/Object;");
+    concurrent_hash_map_.node_next = FindField(
+        concurrent_hash_map_node,
+        "next",
+        "Ljava/util/concurrent/ConcurrentHashMap$Node;");
+  }
+}
+
+
+jfieldID JdkCollectionsReader::FindField(
+    const JavaClass& cls,
+    const char* name,
+    const char* signature) {
+  jfieldID field_id = jni()->GetFieldID(cls.get(), name, signature);
+  if (jni()->ExceptionCheck()) {
+    // Different JDK version. The collection will be read through its
+    // iterator.
+    jni()->ExceptionClear();
+    LOG(INFO) << "Field " << name << " (" << signature << ") not found, "
+                 "direct reading of the collection disabled";
+    return nullptr;
+  }
+
+  return field_id;
+}
+
+
+bool JdkCollectionsReader::ReadList(
+    const JSignature& signature,
+    jobject obj,
+    int max_count,
+    std::vector<JniLocalRef>* elements) const {
+  elements->clear();
+
+  if ((obj == nullptr) || (signature.type != JType::Object)) {
+    return false;
+  }
+
+  if (signature.object_signature == "Ljava/util/ArrayList;") {
+    return ReadArrayList(obj, max_count, elements);
+  }
+
+  if (signature.object_signature == "Ljava/util/ArrayDeque;") {
+    return ReadArrayDeque(obj, max_count, elements);
+  }
+
+  return false;
+}
+
+
+bool JdkCollectionsReader::ReadMap(
+    const JSignature& signature,
+    jobject obj,
+    int max_count,
+    std::vector<MapEntry>* entries) const {
+  entries->clear();
+
+  if ((obj == nullptr) || (signature.type != JType::Object)) {
+    return false;
+  }
+
+  bool rc = false;
+  if (signature.object_signature == "Ljava/util/HashMap;") {
+    rc = ReadHashTable(hash_map_, obj, max_count, entries);
+  } else if (signature.object_signature == "Ljava/util/LinkedHashMap;") {
+    rc = ReadLinkedHashMap(obj, max_count, entries);
+  } else if (signature.object_signature ==
+             "Ljava/util/concurrent/ConcurrentHashMap;") {
+    rc = ReadHashTable(concurrent_hash_map_, obj, max_count, entries);
+  }
+
+  if (!rc) {
+    entries->clear();
+  }
+
+  return rc;
+}
+
+
+bool JdkCollectionsReader::ReadArrayList(
+    jobject obj,
+    int max_count,
+    std::vector<JniLocalRef>* elements) const {
+  if ((array_list_.element_data == nullptr) || (array_list_.size == nullptr)) {
+    return false;
+  }
+
+  // The array is read before the size. If the list grows in between, some of
+  // the new elements are not captured, but all indexes stay within the array.
+  JniLocalRef element_data(
+      jni()->GetObjectField(obj, array_list_.element_data));
+  const jint size = jni()->GetIntField(obj, array_list_.size);
+  if (size == 0) {
+    return true;
+  }
+
+  if ((element_data == nullptr) || (size < 0) ||
+      (size > jni()->GetArrayLength(
+          static_cast<jobjectArray>(element_data.get())))) {
+    return false;
+  }
+
+  const int count = std::min<int>(size, max_count);
+  elements->reserve(count);
+  for (int i = 0; i < count; ++i) {
+    elements->push_back(JniLocalRef(jni()->GetObjectArrayElement(
+        static_cast<jobjectArray>(element_data.get()),
+        i)));
+  }
+
+  return true;
+}
+
+
+bool JdkCollectionsReader::ReadArrayDeque(
+    jobject obj,
+    int max_count,
+    std::vector<JniLocalRef>* elements) const {
+  if ((array_deque_.elements == nullptr) ||
+      (array_deque_.head == nullptr) ||
+      (array_deque_.tail == nullptr)) {
+    return false;
+  }
+
+  JniLocalRef array(jni()->GetObjectField(obj, array_deque_.elements));
+  if (array == nullptr) {
+    return false;
+  }
+
+  const jint head = jni()->GetIntField(obj, array_deque_.head);
+  const jint tail = jni()->GetIntField(obj, array_deque_.tail);
+  const jint length =
+      jni()->GetArrayLength(static_cast<jobjectArray>(array.get()));
+  if ((head < 0) || (head >= length) || (tail < 0) || (tail >= length)) {
+    return false;
+  }
+
+  // Elements are stored in a circular buffer starting at "head". This
+  // formula is correct for both the power of two capacity (JDK 8) and the
+  // arbitrary capacity (JDK 9+) versions of "ArrayDeque".
+  int size = tail - head;
+  if (size < 0) {
+    size += length;
+  }
+
+  const int count = std::min(size, max_count);
+  elements->reserve(count);
+  for (int i = 0; i < count; ++i) {
+    JniLocalRef element(jni()->GetObjectArrayElement(
+        static_cast<jobjectArray>(array.get()),
+        (head + i) % length));
+
+    // "ArrayDeque" doesn't allow null elements. This is a concurrent
+    // modification of the collection.
+    if (element == nullptr) {
+      elements->clear();
+      return false;
+    }
+
+    elements->push_back(std::move(element));
+  }
+
+  return true;
+}
+
+
+bool JdkCollectionsReader::ReadHashTable(
+    const HashMapLayout& layout,
+    jobject obj,
+    int max_count,
+    std::vector<MapEntry>* entries) const {
+  const bool is_concurrent = (layout.node_hash != nullptr);
+  if ((layout.table == nullptr) ||
+      (!is_concurrent && (layout.size == nullptr)) ||
+      (layout.node_key == nullptr) ||
+      (layout.node_value == nullptr) ||
+      (layout.node_next == nullptr)) {
+    return false;
+  }
+
+  // "ConcurrentHashMap" doesn't keep its size in a single field, so the
+  // entries are read until the end of the table. "HashMap" should have the
+  // number of entries it claims to have.
+  int expected_count = max_count;
+  if (!is_concurrent) {
+    const jint size = jni()->GetIntField(obj, layout.size);
+    if (size < 0) {
+      return false;
+    }
+
+    expected_count = std::min<int>(size, max_count);
+  }
+
+  if (expected_count == 0) {
+    return true;
+  }
+
+  JniLocalRef table(jni()->GetObjectField(obj, layout.table));
+  if (table == nullptr) {
+    return is_concurrent;  // Table of "ConcurrentHashMap" is lazily created.
+  }
+
+  const jint length =
+      jni()->GetArrayLength(static_cast<jobjectArray>(table.get()));
+  for (jint bin = 0; bin < length; ++bin) {
+    JniLocalRef node(jni()->GetObjectArrayElement(
+        static_cast<jobjectArray>(table.get()),
+        bin));
+    if (node == nullptr) {
+      continue;
+    }
+
+    // Special nodes of "ConcurrentHashMap" (bin being moved by resize, tree
+    // bin or reservation) have negative hash. Let the iterator deal with
+    // them.
+    if (is_concurrent &&
+        (jni()->GetIntField(node.get(), layout.node_hash) < 0)) {
+      return false;
+    }
+
+    while (node != nullptr) {
+      JniLocalRef next(jni()->GetObjectField(node.get(), layout.node_next));
+
+      entries->push_back(MapEntry());
+      ReadNode(layout, std::move(node), &entries->back());
+      if (static_cast<int>(entries->size()) >= expected_count) {
+        return true;
+      }
+
+      node = std::move(next);
+    }
+  }
+
+  // Fewer entries than "HashMap.size" means a concurrent modification.
+  return is_concurrent;
+}
+
+
+bool JdkCollectionsReader::ReadLinkedHashMap(
+    jobject obj,
+    int max_count,
+    std::vector<MapEntry>* entries) const {
+  if ((linked_hash_map_.head == nullptr) ||
+      (linked_hash_map_.entry_after == nullptr) ||
+      (hash_map_.size == nullptr) ||
+      (hash_map_.node_key == nullptr) ||
+      (hash_map_.node_value == nullptr)) {
+    return false;
+  }
+
+  const jint size = jni()->GetIntField(obj, hash_map_.size);
+  if (size < 0) {
+    return false;
+  }
+
+  const int expected_count = std::min<int>(size, max_count);
+
+  JniLocalRef node(jni()->GetObjectField(obj, linked_hash_map_.head));
+  while (static_cast<int>(entries->size()) < expected_count) {
+    if (node == nullptr) {
+      return false;  // Concurrent modification.
+    }
+
+    JniLocalRef next(
+        jni()->GetObjectField(node.get(), linked_hash_map_.entry_after));
+
+    entries->push_back(MapEntry());
+    ReadNode(hash_map_, std::move(node), &entries->back());
+
+    node = std::move(next);
+  }
+
+  return true;
+}
+
+
+void JdkCollectionsReader::ReadNode(
+    const HashMapLayout& layout,
+    JniLocalRef node,
+    MapEntry* entry) {
+  entry->key = JniLocalRef(jni()->GetObjectField(node.get(), layout.node_key));
+  entry->value =
+      JniLocalRef(jni()->GetObjectField(node.get(), layout.node_value));
+  entry->entry = std::move(node);
+}
+
+}  // namespace cdbg
+}  // namespace devtools
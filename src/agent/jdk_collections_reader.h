@@ -0,0 +1,170 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_JDK_COLLECTIONS_READER_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_JDK_COLLECTIONS_READER_H_
+
+#include <vector>
+#include "common.h"
+#include "jni_utils.h"
+#include "type_util.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Reads elements of the most common JDK collections straight from their
+// backing fields instead of calling "iterator()", "hasNext()" and "next()"
+// through "MethodCaller". Capturing an element then takes a couple of JNI
+// field reads rather than several interpreted method calls.
+//
+// Only the exact JDK classes are supported. Subclasses may override the
+// iteration order or keep the elements elsewhere. The fields are private
+// implementation details of the JDK, so they are all looked up in
+// "Initialize" and a class with a different layout (e.g. another JDK
+// version) is left to the iterator based evaluation. The reads also give up
+// if the collection looks inconsistent (e.g. size out of the array bounds or
+// a bin that a concurrent resize is moving), so that the caller falls back
+// to the iterator.
+//
+// Objects of the supported classes are read without calling any of their
+// methods, so this class doesn't need to verify method call safety.
+class JdkCollectionsReader {
+ public:
+  // Single entry of a map.
+  struct MapEntry {
+    // "Map.Entry" object of the entry.
+    JniLocalRef entry;
+
+    // Key and value of the entry.
+    JniLocalRef key;
+    JniLocalRef value;
+  };
+
+  JdkCollectionsReader() { }
+
+  // Looks up the classes and fields of the supported collections. The
+  // collections with unexpected layout are not supported.
+  void Initialize();
+
+  // Reads up to "max_count" first elements of "java.util.ArrayList" or
+  // "java.util.ArrayDeque" in the iteration order. Returns false if the
+  // class (given by its signature) is not supported or if the collection
+  // looks inconsistent.
+  bool ReadList(
+      const JSignature& signature,
+      jobject obj,
+      int max_count,
+      std::vector<JniLocalRef>* elements) const;
+
+  // Reads up to "max_count" first entries of "java.util.HashMap",
+  // "java.util.LinkedHashMap" or "java.util.concurrent.ConcurrentHashMap"
+  // in the iteration order. Returns false if the class is not supported or
+  // if the map looks inconsistent.
+  bool ReadMap(
+      const JSignature& signature,
+      jobject obj,
+      int max_count,
+      std::vector<MapEntry>* entries) const;
+
+ private:
+  // Backing fields of "java.util.ArrayList".
+  struct ArrayListLayout {
+    JavaClass cls;
+    jfieldID element_data { nullptr };
+    jfieldID size { nullptr };
+  };
+
+  // Backing fields of "java.util.ArrayDeque".
+  struct ArrayDequeLayout {
+    JavaClass cls;
+    jfieldID elements { nullptr };
+    jfieldID head { nullptr };
+    jfieldID tail { nullptr };
+  };
+
+  // Backing fields of "java.util.HashMap" (and its nodes). Also used for
+  // "java.util.concurrent.ConcurrentHashMap", which has the same structure
+  // of bins, but doesn't keep the size in a single field.
+  struct HashMapLayout {
+    JavaClass cls;
+    jfieldID table { nullptr };
+    jfieldID size { nullptr };  // Not used for "ConcurrentHashMap".
+    jfieldID node_hash { nullptr };  // Only used for "ConcurrentHashMap".
+    jfieldID node_key { nullptr };
+    jfieldID node_value { nullptr };
+    jfieldID node_next { nullptr };
+  };
+
+  // Backing fields of "java.util.LinkedHashMap" on top of the ones of
+  // "java.util.HashMap".
+  struct LinkedHashMapLayout {
+    JavaClass cls;
+    jfieldID head { nullptr };
+    jfieldID entry_after { nullptr };
+  };
+
+  // Looks up a field of "cls". Returns nullptr and clears the exception
+  // if the field doesn't exist.
+  static jfieldID FindField(
+      const JavaClass& cls,
+      const char* name,
+      const char* signature);
+
+  bool ReadArrayList(
+      jobject obj,
+      int max_count,
+      std::vector<JniLocalRef>* elements) const;
+
+  bool ReadArrayDeque(
+      jobject obj,
+      int max_count,
+      std::vector<JniLocalRef>* elements) const;
+
+  // Reads the bins of "java.util.HashMap" or
+  // "java.util.concurrent.ConcurrentHashMap" in the order of the table.
+  bool ReadHashTable(
+      const HashMapLayout& layout,
+      jobject obj,
+      int max_count,
+      std::vector<MapEntry>* entries) const;
+
+  // Reads the linked list of entries of "java.util.LinkedHashMap".
+  bool ReadLinkedHashMap(
+      jobject obj,
+      int max_count,
+      std::vector<MapEntry>* entries) const;
+
+  // Fills key and value of a "HashMap" node (or a "LinkedHashMap" entry).
+  static void ReadNode(
+      const HashMapLayout& layout,
+      JniLocalRef node,
+      MapEntry* entry);
+
+  // Layouts of the supported collections. A layout with nullptr fields is
+  // not supported.
+  ArrayListLayout array_list_;
+  ArrayDequeLayout array_deque_;
+  HashMapLayout hash_map_;
+  LinkedHashMapLayout linked_hash_map_;
+  HashMapLayout concurrent_hash_map_;
+
+  DISALLOW_COPY_AND_ASSIGN(JdkCollectionsReader);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_JDK_COLLECTIONS_READER_H_
@@ -0,0 +1,127 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jni_agent_events.h"
+
+#include "jni_proxy_agentevents.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Maximum number of spans emitted in a single batch.
+static constexpr int kMaxAgentEventsBatchSize = 256;
+
+
+bool JniAgentEvents::Initialize() {
+  if (!jniproxy::AgentEvents()->isAvailable()
+          .Release(ExceptionAction::LOG_AND_IGNORE)) {
+    LOG(WARNING) << "Java Flight Recorder is not available, "
+                    "agent overhead events are disabled";
+    return false;
+  }
+
+  JavaClass string_cls;
+  if (!string_cls.FindWithJNI("java/lang/String")) {
+    return false;
+  }
+
+  JniLocalRef phases(jni()->NewObjectArray(
+      kMaxAgentEventsBatchSize,
+      string_cls.get(),
+      nullptr));
+  JniLocalRef breakpoint_ids(jni()->NewObjectArray(
+      kMaxAgentEventsBatchSize,
+      string_cls.get(),
+      nullptr));
+  JniLocalRef durations(jni()->NewLongArray(kMaxAgentEventsBatchSize));
+  string_cls.ReleaseRef();
+
+  if (!JniCheckNoException("NewArray") ||
+      (phases == nullptr) ||
+      (breakpoint_ids == nullptr) ||
+      (durations == nullptr)) {
+    LOG(ERROR) << "Failed to allocate agent events batch arrays";
+    return false;
+  }
+
+  phases_ = JniNewGlobalRef(phases.get());
+  breakpoint_ids_ = JniNewGlobalRef(breakpoint_ids.get());
+  durations_ = JniNewGlobalRef(durations.get());
+  durations_buffer_.resize(kMaxAgentEventsBatchSize);
+
+  return true;
+}
+
+
+void JniAgentEvents::Add(
+    const char* name,
+    const char* breakpoint_id,
+    int64 start_nanos,
+    int64 end_nanos) {
+  jni()->SetObjectArrayElement(
+      static_cast<jobjectArray>(phases_.get()),
+      count_,
+      GetPhaseName(name));
+  jni()->SetObjectArrayElement(
+      static_cast<jobjectArray>(breakpoint_ids_.get()),
+      count_,
+      JniToJavaString(breakpoint_id).get());
+  durations_buffer_[count_] = end_nanos - start_nanos;
+
+  ++count_;
+  if (count_ == kMaxAgentEventsBatchSize) {
+    PublishBatch();
+  }
+}
+
+
+void JniAgentEvents::Flush() {
+  PublishBatch();
+}
+
+
+jstring JniAgentEvents::GetPhaseName(const char* name) {
+  JniGlobalRef& value = phase_names_[name];
+  if (value == nullptr) {
+    value = JniNewGlobalRef(JniToJavaString(name).get());
+  }
+
+  return static_cast<jstring>(value.get());
+}
+
+
+void JniAgentEvents::PublishBatch() {
+  if (count_ == 0) {
+    return;
+  }
+
+  jni()->SetLongArrayRegion(
+      static_cast<jlongArray>(durations_.get()),
+      0,
+      count_,
+      &durations_buffer_[0]);
+
+  jniproxy::AgentEvents()->emitBatch(
+      phases_.get(),
+      breakpoint_ids_.get(),
+      durations_.get(),
+      count_);
+
+  count_ = 0;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
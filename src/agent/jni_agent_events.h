@@ -0,0 +1,84 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_JNI_AGENT_EVENTS_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_JNI_AGENT_EVENTS_H_
+
+#include <map>
+#include <vector>
+#include "common.h"
+#include "jni_utils.h"
+#include "trace_recorder.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Emits the traced agent phases (breakpoint hits, condition evaluation,
+// capture, class prepare handling, etc.) as Java Flight Recorder events
+// through com.google.devtools.cdbg.debuglets.java.AgentEvents. Spans are
+// accumulated into preallocated Java arrays and emitted in batches, so
+// the JFR events cost a few JNI calls per batch rather than per span.
+//
+// This class is not thread safe. It is used as "TraceSpanSink", which is
+// only called from the thread flushing the trace spans.
+class JniAgentEvents : public TraceSpanSink {
+ public:
+  JniAgentEvents() { }
+
+  // Allocates the batch arrays. Returns false if JFR is not available in
+  // this JVM, in which case the object must not be used.
+  bool Initialize();
+
+  void Add(
+      const char* name,
+      const char* breakpoint_id,
+      int64 start_nanos,
+      int64 end_nanos) override;
+
+  void Flush() override;
+
+ private:
+  // Gets the Java string of a phase name (string literal).
+  jstring GetPhaseName(const char* name);
+
+  // Emits the spans accumulated in the batch arrays.
+  void PublishBatch();
+
+ private:
+  // Java "String[]" arrays with the phase names and the breakpoint IDs of
+  // the batch.
+  JniGlobalRef phases_;
+  JniGlobalRef breakpoint_ids_;
+
+  // Java "long[]" array with the durations of the batch spans. The values
+  // are accumulated in "durations_buffer_" and copied when published.
+  JniGlobalRef durations_;
+  std::vector<jlong> durations_buffer_;
+
+  // Number of spans in the batch.
+  int count_ = 0;
+
+  // Java strings of the phase names. The names are string literals, so the
+  // pointer identifies the phase.
+  std::map<const char*, JniGlobalRef> phase_names_;
+
+  DISALLOW_COPY_AND_ASSIGN(JniAgentEvents);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_JNI_AGENT_EVENTS_H_
@@ -21,6 +21,53 @@
 namespace devtools {
 namespace cdbg {
 
+// Invokes "format" on the Java object implementing the
+// com.google.devtools.cdbg.BreakpointLabelsProvider interface.
+static std::map<string, string> FormatLabels(jobject labels_obj) {
+  auto rc = jniproxy::BreakpointLabelsProvider()->format(labels_obj);
+  if (rc.HasException()) {
+    rc.LogException();
+    return {};  // Failed to obtain breakpoint labels.
+  }
+
+  std::vector<string> labels_array = JniToNativeStringArray(rc.GetData().get());
+
+  // "labels_array" serializes map into a flat array. Every even entry is a key
+  // and every odd entry is value.
+  std::map<string, string> labels;
+  for (int i = 0; i < labels_array.size() / 2; ++i) {
+    labels[labels_array[i * 2]] = labels_array[i * 2 + 1];
+  }
+
+  return labels;
+}
+
+
+// Breakpoint labels provider that attaches the labels computed in advance.
+class CachedBreakpointLabelsProvider : public BreakpointLabelsProvider {
+ public:
+  explicit CachedBreakpointLabelsProvider(
+      std::shared_ptr<const std::map<string, string>> labels)
+      : labels_(std::move(labels)) {
+  }
+
+  void Collect() override { }
+
+  std::map<string, string> Format() override {
+    if (labels_ == nullptr) {
+      return {};  // Breakpoint labels not available.
+    }
+
+    return *labels_;
+  }
+
+ private:
+  const std::shared_ptr<const std::map<string, string>> labels_;
+
+  DISALLOW_COPY_AND_ASSIGN(CachedBreakpointLabelsProvider);
+};
+
+
 JniBreakpointLabelsProvider::JniBreakpointLabelsProvider(
     std::function<JniLocalRef()> factory)
     : factory_(factory) {
@@ -47,22 +94,42 @@ std::map<string, string> JniBreakpointLabelsProvider::Format() {
     return {};  // Breakpoint labels not available.
   }
 
-  auto rc = jniproxy::BreakpointLabelsProvider()->format(labels_.get());
-  if (rc.HasException()) {
-    rc.LogException();
-    return {};  // Failed to obtain breakpoint labels.
+  return FormatLabels(labels_.get());
+}
+
+
+JniBreakpointLabelsCache::JniBreakpointLabelsCache(
+    std::function<JniLocalRef()> factory)
+    : factory_(factory) {
+}
+
+
+void JniBreakpointLabelsCache::Refresh() {
+  std::shared_ptr<const std::map<string, string>> labels;
+
+  JniLocalRef labels_obj = factory_();
+  if (labels_obj == nullptr) {
+    LOG(WARNING) << "Breakpoint labels provider not available";
+  } else {
+    labels = std::make_shared<const std::map<string, string>>(
+        FormatLabels(labels_obj.get()));
   }
 
-  std::vector<string> labels_array = JniToNativeStringArray(rc.GetData().get());
+  MutexLock lock(&mu_);
+  labels_ = std::move(labels);
+}
 
-  // "labels_array" serializes map into a flat array. Every even entry is a key
-  // and every odd entry is value.
-  std::map<string, string> labels;
-  for (int i = 0; i < labels_array.size() / 2; ++i) {
-    labels[labels_array[i * 2]] = labels_array[i * 2 + 1];
+
+std::unique_ptr<BreakpointLabelsProvider>
+JniBreakpointLabelsCache::NewProvider() const {
+  std::shared_ptr<const std::map<string, string>> labels;
+  {
+    MutexLock lock(&mu_);
+    labels = labels_;
   }
 
-  return labels;
+  return std::unique_ptr<BreakpointLabelsProvider>(
+      new CachedBreakpointLabelsProvider(std::move(labels)));
 }
 
 }  // namespace cdbg
@@ -17,9 +17,11 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_JNI_BREAKPOINT_LABELS_PROVIDER_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_JNI_BREAKPOINT_LABELS_PROVIDER_H_
 
+#include <memory>
 #include "breakpoint_labels_provider.h"
 #include "common.h"
 #include "jni_utils.h"
+#include "mutex.h"
 
 namespace devtools {
 namespace cdbg {
@@ -51,6 +53,42 @@ class JniBreakpointLabelsProvider : public BreakpointLabelsProvider {
   DISALLOW_COPY_AND_ASSIGN(JniBreakpointLabelsProvider);
 };
 
+
+// Keeps the breakpoint labels computed by the Java
+// com.google.devtools.cdbg.BreakpointLabelsProvider. The labels (e.g. agent
+// version) don't change during the life of the process, so there is no
+// reason to create a Java object on every breakpoint hit. The labels are
+// computed by "Refresh" on the worker thread and every capture attaches the
+// same immutable label set.
+// This class is thread safe.
+class JniBreakpointLabelsCache {
+ public:
+  // The "factory" callback creates a Java object implementing the
+  // com.google.devtools.cdbg.BreakpointLabelsProvider interface.
+  explicit JniBreakpointLabelsCache(std::function<JniLocalRef()> factory);
+
+  // Recomputes the breakpoint labels. Called from the worker thread.
+  void Refresh();
+
+  // Creates "BreakpointLabelsProvider" that attaches the cached labels
+  // without making any JNI calls.
+  std::unique_ptr<BreakpointLabelsProvider> NewProvider() const;
+
+ private:
+  // Callback that creates a Java object implementing the
+  // com.google.devtools.cdbg.BreakpointLabelsProvider interface.
+  std::function<JniLocalRef()> factory_;
+
+  // Locks access to "labels_".
+  mutable Mutex mu_;
+
+  // Labels computed by the last call to "Refresh" or nullptr if "Refresh"
+  // hasn't been called yet.
+  std::shared_ptr<const std::map<string, string>> labels_;
+
+  DISALLOW_COPY_AND_ASSIGN(JniBreakpointLabelsCache);
+};
+
 }  // namespace cdbg
 }  // namespace devtools
 
@@ -16,9 +16,38 @@
 
 #include "jni_bridge.h"
 
+#include <algorithm>
 #include "jni_proxy_classloader.h"
 #include "jni_proxy_hubclient.h"
 #include "jni_proxy_hubclient_listactivebreakpointsresult.h"
+#include "model_util.h"
+#include "trace_recorder.h"
+
+DEFINE_int32(
+    cdbg_transmit_batch_max_count,
+    16,
+    "Maximum number of breakpoint updates sent to the backend in a single "
+    "transmission");
+
+DEFINE_int32(
+    cdbg_transmit_batch_max_bytes,
+    4 * 1024 * 1024,  // 4 MB.
+    "Maximum total size of serialized breakpoint updates sent to the backend "
+    "in a single transmission");
+
+DEFINE_string(
+    cdbg_spill_file,
+    "",
+    "Path to a file that keeps breakpoint updates that could not be "
+    "transmitted before the agent stopped or the transmission queue "
+    "overflowed. The updates are retransmitted when the agent starts next "
+    "time. The file should not be shared between processes. Empty value "
+    "disables spilling");
+
+DEFINE_int32(
+    cdbg_spill_file_max_bytes,
+    16 * 1024 * 1024,  // 16 MB.
+    "Maximum size of the spill file");
 
 namespace devtools {
 namespace cdbg {
@@ -29,11 +58,46 @@ JniBridge::JniBridge(
     BreakpointDeserializer breakpoint_deserializer)
     : hub_client_factory_(hub_client_factory),
       breakpoint_serializer_(breakpoint_serializer),
-      breakpoint_deserializer_(breakpoint_deserializer) {
+      breakpoint_deserializer_(breakpoint_deserializer),
+      spill_file_(FLAGS_cdbg_spill_file, FLAGS_cdbg_spill_file_max_bytes) {
+  // Keep the messages that don't fit the transmit queue for later. This is
+  // always called with "mu_" locked.
+  transmit_queue_.set_overflow_callback(
+      [this] (const TransmitQueue<SerializedBreakpoint>::Item& item) {
+        spill_file_.Append(static_cast<int>(item.priority), *item.message);
+      });
+
+  // Pending breakpoint updates can't be released, but they count against
+  // the budget (so that the caches are released instead).
+  memory_budget_cookie_ = MemoryBudget::GetInstance()->Register(
+      "transmit queue",
+      [this] () {
+        MutexLock lock(&mu_);
+        return transmit_queue_.total_size(
+            [] (const SerializedBreakpoint& message) {
+              return static_cast<int64>(message.data.size());
+            });
+      },
+      nullptr);
+
+  agent_status_cookie_ = AgentStatus::GetInstance()->Register(
+      "transmit queue",
+      [this] (std::ostream* os) {
+        MutexLock lock(&mu_);
+        *os << "size: " << transmit_queue_.size() << '\n'
+            << "bytes: "
+            << transmit_queue_.total_size(
+                   [] (const SerializedBreakpoint& message) {
+                     return static_cast<int64>(message.data.size());
+                   })
+            << '\n';
+      });
 }
 
 
 JniBridge::~JniBridge() {
+  AgentStatus::GetInstance()->Unregister(agent_status_cookie_);
+  MemoryBudget::GetInstance()->Unregister(memory_budget_cookie_);
 }
 
 
@@ -51,18 +115,38 @@ bool JniBridge::Bind(ClassPathLookup* class_path_lookup) {
     return false;
   }
 
+  LoadSpilledMessages();
+
   return true;
 }
 
 
 void JniBridge::EnqueueBreakpointUpdate(
       std::unique_ptr<BreakpointModel> breakpoint) {
-  std::unique_ptr<SerializedBreakpoint> serialized_breakpoint(
-      new SerializedBreakpoint(breakpoint_serializer_(*breakpoint)));
+  std::unique_ptr<SerializedBreakpoint> serialized_breakpoint;
+  {
+    ScopedTraceSpan trace_span("serialize", breakpoint->id);
+    serialized_breakpoint.reset(
+        new SerializedBreakpoint(breakpoint_serializer_(*breakpoint)));
+  }
+
+  // Final results with a snapshot are the most valuable to the user, interim
+  // updates are superseded by the next update of the same breakpoint.
+  TransmitPriority priority;
+  if (!breakpoint->is_final_state) {
+    priority = TransmitPriority::INTERIM;
+  } else if (!breakpoint->stack.empty()) {
+    priority = TransmitPriority::FINAL_RESULT;
+  } else {
+    priority = TransmitPriority::FINAL_STATUS;
+  }
 
   {
     MutexLock lock(&mu_);
-    transmit_queue_.enqueue(std::move(serialized_breakpoint));
+    transmit_queue_.enqueue(
+        std::move(serialized_breakpoint),
+        priority,
+        breakpoint->id);
   }
 }
 
@@ -103,6 +187,17 @@ Bridge::HangingGetResult JniBridge::ListActiveBreakpoints(
     return HangingGetResult::TIMEOUT;
   }
 
+  ExceptionOr<jboolean> registration_required =
+      jniproxy::ListActiveBreakpointsResult()->getIsRegistrationRequired(
+          rc.GetData().get());
+  if (registration_required.HasException()) {
+    return HangingGetResult::FAIL;
+  }
+
+  if (registration_required.GetData()) {
+    return HangingGetResult::NOT_REGISTERED;
+  }
+
   ExceptionOr<string> format =
       jniproxy::ListActiveBreakpointsResult()->getFormat(
           rc.GetData().get());
@@ -125,50 +220,114 @@ Bridge::HangingGetResult JniBridge::ListActiveBreakpoints(
   SerializedBreakpoint serialized_breakpoint;
   serialized_breakpoint.format = format.GetData();
 
+  if (definitions_cache_format_ != serialized_breakpoint.format) {
+    definitions_cache_.clear();
+    definitions_cache_format_ = serialized_breakpoint.format;
+  }
+
+  std::unordered_map<string, std::unique_ptr<BreakpointModel>>
+      definitions_cache;
+
   for (int i = 0; i < size; ++i) {
-    // If we fail to deserialize a breakpoint, we just skip it and move on.
-    // There is no point in failing everything. Any errors encountered here
-    // can't be surfaced to a user.
     serialized_breakpoint.data = JniToNativeBlob(
         JniLocalRef(jni()->GetObjectArrayElement(array, i)).get());
 
-    std::unique_ptr<BreakpointModel> model =
-        breakpoint_deserializer_(serialized_breakpoint);
-    if (model == nullptr) {
-      LOG(ERROR) << "Breakpoint could not be deserialized";
-      continue;
-    }
-
-    if (model->id.empty()) {
-      LOG(ERROR) << "Missing ID in breakpoint definition";
-      continue;
+    // Reuse the definition parsed from the previous response if the
+    // breakpoint didn't change since then.
+    std::unique_ptr<BreakpointModel> cached_model;
+    auto it = definitions_cache_.find(serialized_breakpoint.data);
+    if (it != definitions_cache_.end()) {
+      cached_model = std::move(it->second);
+      definitions_cache_.erase(it);
+    } else {
+      // If we fail to deserialize a breakpoint, we just skip it and move on.
+      // There is no point in failing everything. Any errors encountered here
+      // can't be surfaced to a user.
+      cached_model = breakpoint_deserializer_(serialized_breakpoint);
+      if (cached_model == nullptr) {
+        LOG(ERROR) << "Breakpoint could not be deserialized";
+        continue;
+      }
+
+      if (cached_model->id.empty()) {
+        LOG(ERROR) << "Missing ID in breakpoint definition";
+        continue;
+      }
     }
 
-    breakpoints->push_back(std::move(model));
+    breakpoints->push_back(BreakpointBuilder(*cached_model).build());
+    definitions_cache[std::move(serialized_breakpoint.data)] =
+        std::move(cached_model);
   }
 
+  // Breakpoints that are no longer in the list are dropped from the cache.
+  definitions_cache_.swap(definitions_cache);
+
   return HangingGetResult::SUCCESS;
 }
 
 
 void JniBridge::TransmitBreakpointUpdates() {
+  const size_t max_count = std::max(1, FLAGS_cdbg_transmit_batch_max_count);
+  const size_t max_bytes = std::max(0, FLAGS_cdbg_transmit_batch_max_bytes);
+
   mu_.Lock();
 
-  std::unique_ptr<TransmitQueue<SerializedBreakpoint>::Item> item;
-  while ((item = transmit_queue_.pop()) != nullptr) {
+  while (!transmit_queue_.empty()) {
+    // Take the next batch of messages of the same format. The first message
+    // always goes in, even if it exceeds the size limit on its own.
+    TransmitBatch batch;
+    size_t batch_bytes = 0;
+    const SerializedBreakpoint* next;
+    while ((batch.size() < max_count) &&
+           ((next = transmit_queue_.peek()) != nullptr)) {
+      if (!batch.empty() &&
+          ((next->format != batch.front()->message->format) ||
+           (batch_bytes + next->data.size() > max_bytes))) {
+        break;
+      }
+
+      batch_bytes += next->data.size();
+      batch.push_back(transmit_queue_.pop());
+    }
+
+    // The remaining messages are waiting for their retry backoff delay.
+    if (batch.empty()) {
+      break;
+    }
+
     mu_.Unlock();
 
-    ExceptionOr<std::nullptr_t> no_retry =
-        jniproxy::HubClient()->transmitBreakpointUpdate(
-            jni_hub_.get(),
-            item->message->format,
-            item->message->id,
-            item->message->data);
+    const int64 transmit_start_nanos =
+        IsTracingEnabled() ? TraceClockNanos() : 0;
+
+    const size_t transmitted = TransmitBreakpointUpdatesBatch(batch);
+
+    if (transmit_start_nanos > 0) {
+      const int64 transmit_end_nanos = TraceClockNanos();
+      for (const auto& item : batch) {
+        RecordTraceSpan(
+            "transmit",
+            item->key,
+            transmit_start_nanos,
+            transmit_end_nanos);
+      }
+    }
 
     mu_.Lock();
 
-    // If the failure occurred due to an application  error, do not re-queue
-    // the offending message, discard it, and continue with the next message.
+    if (transmitted == batch.size()) {
+      continue;
+    }
+
+    // Messages after the failed one haven't been attempted. Put them back
+    // to the front of the queue in their original order.
+    for (size_t i = batch.size() - 1; i > transmitted; --i) {
+      transmit_queue_.unpop(std::move(batch[i]));
+    }
+
+    // If the failure occurred due to an application error, the Java code
+    // already discarded the offending message and moved on to the next one.
     // Otherwise, put the offending message back to the end of the
     // queue and exit. Don't continue for two reasons:
     // 1. If there was some kind of timeout, the failed transmission already
@@ -177,23 +336,94 @@ void JniBridge::TransmitBreakpointUpdates() {
     // 2. Prevent infinite loop when a message can't be sent over and over
     //    again (it won't be inifinite because a message will be eventually
     //    discarded as poisonous, but it will still take a lot of time).
-    if (!no_retry.HasException())
-      continue;
-
-    transmit_queue_.enqueue(std::move(item));
+    transmit_queue_.enqueue(std::move(batch[transmitted]));
     break;
   }
 
+  if (shutdown_) {
+    SpillPendingMessages();
+  }
+
   mu_.Unlock();
 }
 
 
+int JniBridge::TransmitBreakpointUpdatesBatch(const TransmitBatch& batch) {
+  std::vector<string> ids;
+  ids.reserve(batch.size());
+  for (const auto& item : batch) {
+    ids.push_back(item->message->id);
+  }
+
+  JniLocalRef ids_array = JniToJavaStringArray(ids);
+  if (ids_array == nullptr) {
+    return 0;
+  }
+
+  // TODO(vlif): use JNI proxy generated code.
+  JavaClass byte_buffer_cls;
+  if (!byte_buffer_cls.FindWithJNI("java/nio/ByteBuffer")) {
+    return 0;
+  }
+
+  JniLocalRef data_array(jni()->NewObjectArray(
+      batch.size(),
+      byte_buffer_cls.get(),
+      nullptr));
+  if (data_array == nullptr) {
+    LOG(ERROR) << "Failed to allocate ByteBuffer[] array, size: "
+               << batch.size();
+    return 0;
+  }
+
+  // The serialized breakpoints are passed to Java code as direct buffers over
+  // the native memory to avoid copying them to Java heap. The items in
+  // "batch" stay alive until the call below returns, and Java code doesn't
+  // keep the buffers after that.
+  for (int i = 0; i < batch.size(); ++i) {
+    JniLocalRef buffer = JniToDirectByteBuffer(batch[i]->message->data);
+    if (buffer == nullptr) {
+      JniCheckNoException("TransmitBreakpointUpdatesBatch");
+      return 0;
+    }
+
+    jni()->SetObjectArrayElement(
+        static_cast<jobjectArray>(data_array.get()),
+        i,
+        buffer.get());
+  }
+
+  if (!JniCheckNoException("TransmitBreakpointUpdatesBatch")) {
+    return 0;
+  }
+
+  ExceptionOr<jint> rc = jniproxy::HubClient()->transmitBreakpointUpdates(
+      jni_hub_.get(),
+      batch.front()->message->format,
+      ids_array.get(),
+      data_array.get());
+  if (rc.HasException()) {
+    return 0;
+  }
+
+  return std::min(std::max(rc.GetData(), 0), static_cast<jint>(batch.size()));
+}
+
+
 bool JniBridge::HasPendingMessages() const {
   MutexLock lock(&mu_);
   return !transmit_queue_.empty();
 }
 
 
+bool JniBridge::IsTransmitBacklogged() const {
+  // Leave some room for the status updates of the breakpoints completed
+  // without a capture while the backlog drains.
+  MutexLock lock(&mu_);
+  return transmit_queue_.size() >= kMaxTransmitQueueSize * 3 / 4;
+}
+
+
 bool JniBridge::RegisterBreakpointCanary(const string& breakpoint_id) {
   auto rc = jniproxy::HubClient()->registerBreakpointCanary(
       jni_hub_.get(),
@@ -228,6 +458,54 @@ void JniBridge::Shutdown() {
   }
 
   shutdown_ = true;
+
+  // Messages in flight are spilled by "TransmitBreakpointUpdates" if their
+  // transmission gets aborted.
+  SpillPendingMessages();
+}
+
+
+void JniBridge::SpillPendingMessages() {
+  if (!spill_file_.IsEnabled()) {
+    return;
+  }
+
+  int count = 0;
+  for (const auto& item : transmit_queue_.drain()) {
+    if (spill_file_.Append(static_cast<int>(item->priority), *item->message)) {
+      ++count;
+    }
+  }
+
+  if (count > 0) {
+    LOG(INFO) << count << " pending breakpoint updates spilled to "
+              << FLAGS_cdbg_spill_file;
+  }
+}
+
+
+void JniBridge::LoadSpilledMessages() {
+  std::vector<SpillFile::Record> records = spill_file_.ReadAndRemove();
+  if (records.empty()) {
+    return;
+  }
+
+  LOG(INFO) << "Loaded " << records.size() << " breakpoint updates spilled "
+               "by the previous instance of the debugger";
+
+  for (SpillFile::Record& record : records) {
+    if ((record.priority < 0) ||
+        (record.priority > static_cast<int>(TransmitPriority::INTERIM))) {
+      continue;
+    }
+
+    const string key = record.message.id;
+    transmit_queue_.enqueue(
+        std::unique_ptr<SerializedBreakpoint>(
+            new SerializedBreakpoint(std::move(record.message))),
+        static_cast<TransmitPriority>(record.priority),
+        key);
+  }
 }
 
 }  // namespace cdbg
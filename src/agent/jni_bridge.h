@@ -19,11 +19,16 @@
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 #include "nullable.h"
 #include "bridge.h"
+#include "agent_status.h"
 #include "common.h"
 #include "jni_utils.h"
+#include "memory_budget.h"
 #include "mutex.h"
+#include "spill_file.h"
 #include "transmit_queue.h"
 
 namespace devtools {
@@ -65,10 +70,29 @@ class JniBridge : public Bridge {
 
   bool HasPendingMessages() const override;
 
+  bool IsTransmitBacklogged() const override;
+
   bool RegisterBreakpointCanary(const string& breakpoint_id) override;
 
   bool ApproveBreakpointCanary(const string& breakpoint_id) override;
 
+ private:
+  typedef std::vector<std::unique_ptr<TransmitQueue<SerializedBreakpoint>::Item>>
+      TransmitBatch;
+
+  // Sends a batch of breakpoint updates of the same format in a single call
+  // to "HubClient.transmitBreakpointUpdates". Returns the number of leading
+  // updates in "batch" that don't need to be retried.
+  int TransmitBreakpointUpdatesBatch(const TransmitBatch& batch);
+
+  // Moves all the pending messages to the spill file. Must be called with
+  // "mu_" locked.
+  void SpillPendingMessages();
+
+  // Enqueues breakpoint updates spilled by the previous instance of the
+  // agent. Must be called with "mu_" locked.
+  void LoadSpilledMessages();
+
  private:
   // Callback to create an instance of Java class implementing
   // the com.google.devtools.cdbg.debuglets.java.HubClient interface.
@@ -79,6 +103,16 @@ class JniBridge : public Bridge {
   BreakpointSerializer breakpoint_serializer_;
   BreakpointDeserializer breakpoint_deserializer_;
 
+  // Breakpoint definitions deserialized from the last successful
+  // "ListActiveBreakpoints" response keyed by the serialized blob. The list
+  // of active breakpoints rarely changes between two consecutive responses,
+  // so most blobs are copied from here instead of being parsed again. The
+  // cache only keeps blobs present in the last response. Only accessed from
+  // "ListActiveBreakpoints", which is always called from the same thread.
+  string definitions_cache_format_;
+  std::unordered_map<string, std::unique_ptr<BreakpointModel>>
+      definitions_cache_;
+
   // Locks "transmit_queue_" for thread safety. Also used to prevent race
   // between "Bind" and "Shutdown".
   mutable Mutex mu_;
@@ -93,6 +127,17 @@ class JniBridge : public Bridge {
   // a breakpoint message serialized as ProtoBuf or JSON.
   TransmitQueue<SerializedBreakpoint> transmit_queue_;
 
+  // Keeps breakpoint updates that couldn't be transmitted (because the agent
+  // is shutting down or the transmit queue overflowed) for the next instance
+  // of the agent. Protected by "mu_".
+  SpillFile spill_file_;
+
+  // Registration of the transmit queue in "MemoryBudget".
+  MemoryBudget::Cookie memory_budget_cookie_;
+
+  // Registration of the transmit queue status in "AgentStatus".
+  AgentStatus::Cookie agent_status_cookie_;
+
   DISALLOW_COPY_AND_ASSIGN(JniBridge);
 };
 
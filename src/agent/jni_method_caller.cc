@@ -28,7 +28,9 @@ bool JniMethodCaller::Bind(
 
   metadata_ = metadata;
 
-  if (!ParseJMethodSignature(metadata_.signature, &method_signature_)) {
+  if (metadata_.parsed_signature != nullptr) {
+    method_signature_ = *metadata_.parsed_signature;
+  } else if (!ParseJMethodSignature(metadata_.signature, &method_signature_)) {
     LOG(ERROR) << "Failed to parse method signature";
     return false;
   }
@@ -0,0 +1,53 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common.h"
+#include "jar_central_directory.h"
+#include "jni_utils.h"
+
+/*
+ * Class:     com.google.devtools.cdbg.debuglets.java.ResourceIndexer
+ * Method:    readJarFileNames
+ * Signature: (Ljava/lang/String;)[B
+ */
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_google_devtools_cdbg_debuglets_java_ResourceIndexer_readJarFileNames(
+    JNIEnv* jni,
+    jclass cls,
+    jstring path) {
+  devtools::cdbg::set_thread_jni(jni);
+
+  string names;
+  if (!devtools::cdbg::ReadJarFileNames(
+          devtools::cdbg::JniToNativeString(path),
+          &names)) {
+    return nullptr;
+  }
+
+  // On failure "OutOfMemoryError" is pending and thrown in Java code.
+  jbyteArray result = jni->NewByteArray(names.size());
+  if (result == nullptr) {
+    return nullptr;
+  }
+
+  jni->SetByteArrayRegion(
+      result,
+      0,
+      names.size(),
+      reinterpret_cast<const jbyte*>(names.data()));
+
+  return result;
+}
@@ -23,13 +23,10 @@
 namespace devtools {
 namespace cdbg {
 
-// JNI based wrapper of Java Semaphore class. We use Java semaphore as
-// opposed to native semaphore implementation because:
-// 1. There is no semaphore implementation in the frameworks we use. We could
-//    implement one with conditional variable and mutex or wrap sem_XXX
-//    functions from pthread library, but that would be more work.
-// 2. Unlike native semaphores, wait in Java semaphores can be interrupted.
-// 3. It seems to me more natural to use Java facilities in Java thread.
+// JNI based wrapper of Java Semaphore class. Unlike "NativeSemaphore", wait
+// in Java semaphores can be interrupted (with "Thread.interrupt"). Every
+// call crosses into Java, so "NativeSemaphore" should be preferred unless
+// the interruption semantics are needed.
 class JniSemaphore : public Semaphore {
  public:
   JniSemaphore() { }
@@ -0,0 +1,85 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common.h"
+#include "jni_utils.h"
+#include "statistician.h"
+
+/*
+ * Class:     com.google.devtools.cdbg.debuglets.java.Statistician
+ * Method:    getStatistics
+ * Signature: (Ljava/lang/String;)Lcom/google/devtools/cdbg/debuglets/java/Statistician;
+ */
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_google_devtools_cdbg_debuglets_java_Statistician_getStatistics(
+    JNIEnv* jni,
+    jclass cls,
+    jstring name) {
+  devtools::cdbg::set_thread_jni(jni);
+
+  devtools::cdbg::Statistician* statistician =
+      devtools::cdbg::FindStatistician(
+          devtools::cdbg::JniToNativeString(name));
+  if (statistician == nullptr) {
+    return nullptr;
+  }
+
+  jmethodID constructor = jni->GetMethodID(cls, "<init>", "(IDDDDDDDD)V");
+  if (constructor == nullptr) {
+    LOG(ERROR) << "Statistician constructor not found";
+    jni->ExceptionClear();
+    return nullptr;
+  }
+
+  return jni->NewObject(
+      cls,
+      constructor,
+      static_cast<jint>(statistician->count()),
+      statistician->min(),
+      statistician->max(),
+      statistician->mean(),
+      statistician->stdev(),
+      statistician->percentile(0.5),
+      statistician->percentile(0.9),
+      statistician->percentile(0.99),
+      statistician->percentile(0.999));
+}
+
+
+/*
+ * Class:     com.google.devtools.cdbg.debuglets.java.Statistician
+ * Method:    addSample
+ * Signature: (Ljava/lang/String;D)V
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_google_devtools_cdbg_debuglets_java_Statistician_addSample(
+    JNIEnv* jni,
+    jclass cls,
+    jstring name,
+    jdouble sample) {
+  devtools::cdbg::set_thread_jni(jni);
+
+  devtools::cdbg::Statistician* statistician =
+      devtools::cdbg::FindStatistician(
+          devtools::cdbg::JniToNativeString(name));
+  if (statistician == nullptr) {
+    LOG(ERROR) << "Unknown statistics variable "
+               << devtools::cdbg::JniToNativeString(name);
+    return;
+  }
+
+  statistician->add(sample);
+}
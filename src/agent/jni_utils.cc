@@ -17,6 +17,8 @@
 #include "jni_utils.h"
 
 #include <cstdarg>
+#include <cstring>
+#include "hot_path_counters.h"
 #include "jni_proxy_object.h"
 #include "jni_proxy_printwriter.h"
 #include "jni_proxy_stringwriter.h"
@@ -89,6 +91,19 @@ string JniToNativeBlob(jobject byte_array_obj) {
 }
 
 
+JniLocalRef JniToDirectByteBuffer(const string& data) {
+  JniLocalRef buffer(jni()->NewDirectByteBuffer(
+      const_cast<char*>(data.data()),
+      data.size()));
+  if (buffer == nullptr) {
+    LOG(ERROR) << "Failed to create direct byte buffer, size: " << data.size();
+    return nullptr;
+  }
+
+  return buffer;
+}
+
+
 std::vector<string> JniToNativeStringArray(jobject string_array_obj) {
   if (string_array_obj == nullptr) {
     return {};
@@ -152,6 +167,7 @@ JniGlobalRef JniNewGlobalRef(jobject obj) {
     return nullptr;
   }
 
+  CDBG_COUNT_HOT_PATH(global_refs);
   return JniGlobalRef(jni()->NewGlobalRef(obj));
 }
 
@@ -208,6 +224,25 @@ string GetObjectClassSignature(jobject obj) {
 }
 
 
+string GetThreadName(jthread thread) {
+  jvmtiThreadInfo thread_info;
+  memset(&thread_info, 0, sizeof(thread_info));
+
+  jvmtiError err = jvmti()->GetThreadInfo(thread, &thread_info);
+  if (err != JVMTI_ERROR_NONE) {
+    return string();
+  }
+
+  // Release the references and the buffer returned by "GetThreadInfo".
+  JniLocalRef thread_group(thread_info.thread_group);
+  JniLocalRef context_class_loader(thread_info.context_class_loader);
+  JvmtiBuffer<char> name;
+  *name.ref() = thread_info.name;
+
+  return (name.get() == nullptr) ? string() : string(name.get());
+}
+
+
 static JavaExceptionInfo JniGetExceptionInfo(
     JniLocalRef exception_obj,
     bool verbose) {
@@ -56,6 +56,35 @@ using JniLocalRef = std::unique_ptr<_jobject, JniLocalRefDeleter>;
 // Shortcut for "std::unique_ptr" that properly deletes JNI global references.
 using JniGlobalRef = std::unique_ptr<_jobject, JniGlobalRefDeleter>;
 
+// Pushes a new JNI local reference frame for the lifetime of this object.
+// Local references created in the frame are freed together when the frame
+// is popped. Unlike global references, they don't go through the global
+// handles lock of the JVM. Any "JniLocalRef" or local reference "JVariant"
+// created within the scope must be released or promoted to a global
+// reference before the scope ends.
+class JniLocalFrame {
+ public:
+  explicit JniLocalFrame(int capacity)
+      : is_pushed_(jni()->PushLocalFrame(capacity) == 0) {
+    if (!is_pushed_) {
+      // Out of memory. Local references will be allocated in the current
+      // frame.
+      jni()->ExceptionClear();
+    }
+  }
+
+  ~JniLocalFrame() {
+    if (is_pushed_) {
+      jni()->PopLocalFrame(nullptr);
+    }
+  }
+
+ private:
+  const bool is_pushed_;
+
+  DISALLOW_COPY_AND_ASSIGN(JniLocalFrame);
+};
+
 
 // Wraps functionality to obtain Java class objects through JNI and
 // extract class methods. All the functions handle Java exceptions.
@@ -245,6 +274,12 @@ JniLocalRef JniToByteArray(const string& data);
 // Converts Java byte array (byte[]) to native BLOB.
 string JniToNativeBlob(jobject byte_array_obj);
 
+// Wraps native BLOB with a direct "java.nio.ByteBuffer" without copying it.
+// The buffer points to the memory of "data", so "data" must not change or go
+// away while Java code may still access the buffer. Java code must not write
+// to the buffer. Returns nullptr on failure.
+JniLocalRef JniToDirectByteBuffer(const string& data);
+
 // Creates a new local reference to the specified Java object. Returns
 // nullptr if "obj" is nullptr.
 JniLocalRef JniNewLocalRef(jobject obj);
@@ -266,6 +301,9 @@ string GetClassSignature(jobject cls);
 // string on errors.
 string GetObjectClassSignature(jobject obj);
 
+// Gets the name of a Java thread. Returns empty string on error.
+string GetThreadName(jthread thread);
+
 // Checks whether a JVM exception has been thrown. If not, returns null.
 // If it was, clears the exception and returns the information about the
 // thrown exception.
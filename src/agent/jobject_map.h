@@ -20,7 +20,9 @@
 #include <functional>
 #include <list>
 #include <unordered_map>
+#include <vector>
 #include "common.h"
+#include "stopwatch.h"
 
 namespace devtools {
 namespace cdbg {
@@ -59,6 +61,9 @@ class JobjectMap {
       : cleanup_routine_(cleanup_routine) {
   }
 
+  // Returns true if the map has no entries.
+  bool IsEmpty() const { return map_.empty(); }
+
   // Checks whether the specified Java object is already contained in the map.
   bool Contains(jobject obj) const;
 
@@ -67,6 +72,11 @@ class JobjectMap {
   TData* Find(jobject obj);
   const TData* Find(jobject obj) const;
 
+  // Same as above, but takes the precomputed hash code of "obj" (see
+  // "GetHashCode"). Useful when the caller needs the hash code for other
+  // purposes too, since "GetObjectHashCode" is a JVMTI call.
+  TData* Find(jobject obj, jint hash_code);
+
   // Inserts a new entry to the map. If the object is already present in the
   // map, the function returns false and the data structure is not changed.
   // If an error occurs taking ref, the function also returns false.
@@ -75,15 +85,37 @@ class JobjectMap {
 
   bool Insert(jobject obj, TData data);
 
+  bool Insert(
+      jobject obj,
+      jint hash_code,
+      TData data,
+      std::pair<jobject, TData>** inserted);
+
   // Removes the specified object from the dictionary (releasing the ref).
   // Returns true if the object was actually removed.
   bool Remove(jobject obj);
 
+  bool Remove(jobject obj, jint hash_code);
+
+  // Computes the hash code of the object as used by this dictionary. Returns
+  // false on error.
+  static bool GetHashCode(jobject obj, jint* hash_code);
+
   // Removes all entries from the dictionary (releasing the refs). This
   // function doesn't have to be called on Agent_OnUnload because JVM discards
   // all the references on shutdown.
   void RemoveAll();
 
+  // Removes entries whose Java objects have been garbage collected (i.e.
+  // cleared weak references), invoking "on_removed" (if not nullptr) and
+  // the cleanup routine for each of them. The scan is incremental: each
+  // call resumes from the hash bucket where the previous one stopped and
+  // returns after "time_budget_micros" or after a full pass over the map.
+  // Returns the number of removed entries.
+  int RemoveCollected(
+      int64 time_budget_micros,
+      std::function<void(jobject)> on_removed = nullptr);
+
  private:
   // Operation to invoke upon removal of an entry from the dictionary.
   std::function<void(jobject, TData*)> cleanup_routine_;
@@ -91,6 +123,9 @@ class JobjectMap {
   // Hash table of Java objects
   Map map_;
 
+  // Hash bucket of "map_" where the next "RemoveCollected" resumes.
+  size_t sweep_bucket_ = 0;
+
   DISALLOW_COPY_AND_ASSIGN(JobjectMap);
 };
 
@@ -135,14 +170,27 @@ class JObject_NoRef {
 
 
 
+template <typename TRef, typename TData>
+bool JobjectMap<TRef, TData>::GetHashCode(jobject obj, jint* hash_code) {
+  *hash_code = 0;
+  jvmtiError err = jvmti()->GetObjectHashCode(obj, hash_code);
+  return err == JVMTI_ERROR_NONE;
+}
+
+
 template <typename TRef, typename TData>
 TData* JobjectMap<TRef, TData>::Find(jobject obj) {
   jint hash_code = 0;
-  jvmtiError err = jvmti()->GetObjectHashCode(obj, &hash_code);
-  if (err != JVMTI_ERROR_NONE) {
+  if (!GetHashCode(obj, &hash_code)) {
     return nullptr;
   }
 
+  return Find(obj, hash_code);
+}
+
+
+template <typename TRef, typename TData>
+TData* JobjectMap<TRef, TData>::Find(jobject obj, jint hash_code) {
   auto it = map_.find(hash_code);
   if (it == map_.end()) {
     return nullptr;
@@ -180,11 +228,24 @@ bool JobjectMap<TRef, TData>::Insert(
   *inserted = nullptr;
 
   jint hash_code = 0;
-  jvmtiError err = jvmti()->GetObjectHashCode(obj, &hash_code);
-  if (err != JVMTI_ERROR_NONE) {
+  if (!GetHashCode(obj, &hash_code)) {
     return false;
   }
 
+  return Insert(obj, hash_code, std::move(data), inserted);
+}
+
+
+template <typename TRef, typename TData>
+bool JobjectMap<TRef, TData>::Insert(
+    jobject obj,
+    jint hash_code,
+    TData data,
+    std::pair<jobject, TData>** inserted) {
+  DCHECK(obj != nullptr);
+
+  *inserted = nullptr;
+
   auto in = map_.insert(
       std::make_pair(hash_code, std::list<std::pair<jobject, TData>>()));
 
@@ -219,11 +280,16 @@ bool JobjectMap<TRef, TData>::Insert(jobject obj, TData data) {
 template <typename TRef, typename TData>
 bool JobjectMap<TRef, TData>::Remove(jobject obj) {
   jint hash_code = 0;
-  jvmtiError err = jvmti()->GetObjectHashCode(obj, &hash_code);
-  if (err != JVMTI_ERROR_NONE) {
+  if (!GetHashCode(obj, &hash_code)) {
     return false;
   }
 
+  return Remove(obj, hash_code);
+}
+
+
+template <typename TRef, typename TData>
+bool JobjectMap<TRef, TData>::Remove(jobject obj, jint hash_code) {
   auto map_it = map_.find(hash_code);
   if (map_it == map_.end()) {
     return false;
@@ -264,6 +330,71 @@ void JobjectMap<TRef, TData>::RemoveAll() {
 }
 
 
+template <typename TRef, typename TData>
+int JobjectMap<TRef, TData>::RemoveCollected(
+    int64 time_budget_micros,
+    std::function<void(jobject)> on_removed) {
+  // Reading the clock is more expensive than scanning a bucket.
+  constexpr size_t kBucketsPerClockCheck = 64;
+
+  Stopwatch stopwatch;
+
+  // The bucket count changes when "map_" is rehashed, in which case the
+  // scan just resumes from an arbitrary bucket.
+  const size_t bucket_count = map_.bucket_count();
+  if (sweep_bucket_ >= bucket_count) {
+    sweep_bucket_ = 0;
+  }
+
+  // Erasing from "map_" while iterating over a bucket would invalidate the
+  // bucket iterator, so empty lists are erased after the scan.
+  std::vector<int32> empty_keys;
+  int removed_count = 0;
+  for (size_t i = 0; i < bucket_count; ++i) {
+    if ((i > 0) &&
+        (i % kBucketsPerClockCheck == 0) &&
+        (stopwatch.GetElapsedMicros() >= time_budget_micros)) {
+      break;
+    }
+
+    for (auto it = map_.begin(sweep_bucket_);
+         it != map_.end(sweep_bucket_);
+         ++it) {
+      auto& list = it->second;
+      for (auto list_it = list.begin(); list_it != list.end();) {
+        if (!jni()->IsSameObject(list_it->first, nullptr)) {
+          ++list_it;
+          continue;
+        }
+
+        if (on_removed != nullptr) {
+          on_removed(list_it->first);
+        }
+        if (cleanup_routine_ != nullptr) {
+          cleanup_routine_(list_it->first, &list_it->second);
+        }
+        TRef::Delete(list_it->first);
+
+        list_it = list.erase(list_it);
+        ++removed_count;
+      }
+
+      if (list.empty()) {
+        empty_keys.push_back(it->first);
+      }
+    }
+
+    sweep_bucket_ = (sweep_bucket_ + 1) % bucket_count;
+  }
+
+  for (int32 key : empty_keys) {
+    map_.erase(key);
+  }
+
+  return removed_count;
+}
+
+
 }  // namespace cdbg
 }  // namespace devtools
 
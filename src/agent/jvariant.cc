@@ -18,7 +18,7 @@
 
 #include <float.h>
 #include <iostream>  // NOLINT
-#include <sstream>
+#include "format_util.h"
 
 namespace devtools {
 namespace cdbg {
@@ -294,55 +294,57 @@ string JVariant::ToString(bool concise) const {
     return ToString(true);
   }
 
-  std::ostringstream ss;
+  string result;
+  AppendToString(&result);
+  return result;
+}
+
+
+void JVariant::AppendToString(string* output) const {
   switch (data_type_) {
     case JType::Void:
-      return "<void>";
+      output->append("<void>");
+      return;
 
     case JType::Boolean:
-      return (u_.z) ? "true" : "false";
+      output->append((u_.z) ? "true" : "false");
+      return;
 
     case JType::Byte:
-      return std::to_string(u_.b);
+      AppendInteger(u_.b, output);
+      return;
 
     case JType::Char:
-      return std::to_string(u_.c);
+      AppendInteger(u_.c, output);
+      return;
 
     case JType::Short:
-      return std::to_string(u_.s);
+      AppendInteger(u_.s, output);
+      return;
 
     case JType::Int:
-      return std::to_string(u_.i);
+      AppendInteger(u_.i, output);
+      return;
 
     case JType::Long:
-      return std::to_string(u_.j);
+      AppendInteger(u_.j, output);
+      return;
 
-    case JType::Float: {
-      char str[25];
-      snprintf(
-          str,
-          arraysize(str), "%.*g",
+    case JType::Float:
+      AppendFloatingPoint(
+          static_cast<double>(u_.f),
           kFloatPrecision,
-          static_cast<double>(u_.f));
-      return str;
-    }
+          output);
+      return;
 
-    case JType::Double: {
-      char str[25];
-      snprintf(
-          str,
-          arraysize(str),
-          "%.*g",
-          kDoublePrecision,
-          u_.d);
-      return str;
-    }
+    case JType::Double:
+      AppendFloatingPoint(u_.d, kDoublePrecision, output);
+      return;
 
     case JType::Object:
-      return (u_.l == nullptr) ? "null" : "<Object>";
+      output->append((u_.l == nullptr) ? "null" : "<Object>");
+      return;
   }
-
-  return string();
 }
 
 
@@ -62,7 +62,10 @@ class JVariant {
   JVariant(const JVariant& source);
 
   // Move constructor approved by c-style-arbiters in CL 80120287.
-  JVariant(JVariant&& other)  // NOLINT
+  // It must not throw, so that containers of "JVariant" (and of structures
+  // embedding it, like "NamedJVariant") move their elements when they grow
+  // rather than duplicating every reference through the copy constructor.
+  JVariant(JVariant&& other) noexcept  // NOLINT
       : data_type_(other.data_type_),
         reference_type_(other.reference_type_),
         u_(other.u_) {
@@ -70,7 +73,10 @@ class JVariant {
   }
 
   ~JVariant() {
-    ReleaseRef();
+    // Moved-from and primitive instances don't hold any reference.
+    if (data_type_ == JType::Object) {
+      ReleaseRef();
+    }
   }
 
   static JVariant Boolean(jboolean boolean_value) {
@@ -140,6 +146,18 @@ class JVariant {
   template <typename T>
   static JVariant Primitive(T value);
 
+  // Creates "JVariant" of the primitive "type" from "value". Returns void
+  // "JVariant" if "type" is not primitive.
+  static JVariant PrimitiveFromJValue(JType type, jvalue value) {
+    JVariant rc;
+    if ((type != JType::Void) && (type != JType::Object)) {
+      rc.data_type_ = type;
+      rc.u_ = value;
+    }
+
+    return rc;
+  }
+
   static JVariant LocalRef(JniLocalRef ref) {
     JVariant rc;
     rc.data_type_ = JType::Object;
@@ -188,8 +206,10 @@ class JVariant {
   }
 
   // Move assignment operator approved by c-style-arbiters in CL 80120287.
-  JVariant& operator=(JVariant&& other) {  // NOLINT
-    ReleaseRef();
+  JVariant& operator=(JVariant&& other) noexcept {  // NOLINT
+    if (data_type_ == JType::Object) {
+      ReleaseRef();
+    }
 
     data_type_ = other.data_type_;
     reference_type_ = other.reference_type_;
@@ -260,6 +280,9 @@ class JVariant {
   // Prints the content of this instance to string for debugging purposes.
   string ToString(bool concise) const;
 
+  // Appends the concise form of "ToString" to "output".
+  void AppendToString(string* output) const;
+
  private:
   JVariant& operator= (const JVariant& source) = delete;
 
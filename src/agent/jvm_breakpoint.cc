@@ -16,22 +16,40 @@
 
 #include "jvm_breakpoint.h"
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "breakpoint_group.h"
 #include "breakpoints_manager.h"
 #include "capture_data_collector.h"
 #include "class_indexer.h"
+#include "class_method_lines.h"
 #include "class_path_lookup.h"
+#include "compiled_breakpoint_cache.h"
+#include "dynamic_log_queue.h"
 #include "dynamic_logger.h"
 #include "expression_evaluator.h"
+#include "expression_program.h"
+#include "fast_clock.h"
 #include "format_queue.h"
+#include "gc_epoch.h"
+#include "hot_path_counters.h"
 #include "jvm_evaluators.h"
 #include "jvm_readers_factory.h"
-#include "jvmti_buffer.h"
-#include "log_data_collector.h"
+#include "log_rate_limiter.h"
 #include "messages.h"
+#include "metric_aggregator.h"
 #include "model.h"
 #include "model_util.h"
+#include "overhead_governor.h"
 #include "resolved_source_location.h"
+#include "shared_capture.h"
+#include "shared_subexpression_evaluator.h"
+#include "stack_sampler.h"
 #include "statistician.h"
+#include "trace_recorder.h"
+
+DECLARE_int32(max_dynamic_log_message_bytes);
 
 DEFINE_int32(
     breakpoint_expiration_sec,
@@ -43,94 +61,298 @@ DEFINE_int32(
     500,  // ms
     "time to pause dynamic logs after it runs out of quota");
 
+DEFINE_bool(
+    enable_condition_program,
+    false,
+    "evaluate breakpoint conditions by a flat instruction stream instead of "
+    "walking the expression tree");
+
+DEFINE_bool(
+    condition_cost_use_median,
+    false,
+    "estimate the cost of a breakpoint condition by the median of the last "
+    "32 evaluations (exact median over the moving average window rather "
+    "than a streaming quantile estimator), but not less than half of their "
+    "average, so that a single garbage collection pause doesn't inflate the "
+    "cost while conditions that are often expensive are still charged");
+
+DEFINE_int32(
+    condition_sampling_max_interval,
+    1,  // Disabled.
+    "when a conditional breakpoint exceeds its cost limit, evaluate the "
+    "condition only on 1 in N hits (N adapts between 1 and this value) "
+    "rather than cancelling the breakpoint; 1 disables sampling");
+
+DEFINE_bool(
+    cdbg_async_breakpoint_activation,
+    true,
+    "compile the expressions of a pending breakpoint and set the JVMTI "
+    "breakpoint on an agent thread rather than in the CLASS_PREPARE callback "
+    "of the application thread that loaded the class");
+
+DEFINE_bool(
+    cdbg_preset_jvmti_breakpoint,
+    false,
+    "with asynchronous breakpoint activation, set the JVMTI breakpoint as "
+    "soon as the class is prepared and drop the hits until the breakpoint "
+    "expressions are compiled");
+
+DEFINE_int32(
+    metric_breakpoint_update_interval_sec,
+    60,
+    "minimal time in seconds between two interim updates reporting the "
+    "aggregate of a metric breakpoint");
+
+DEFINE_int32(
+    max_capture_hits,
+    10,
+    "maximum number of hits a snapshot breakpoint can capture before it "
+    "completes (see the \"cdbg.capture_hits\" breakpoint label)");
+
+DEFINE_int32(
+    capture_hits_window_sec,
+    60,
+    "time in seconds after the first hit of a multi-hit snapshot breakpoint "
+    "after which the breakpoint completes with the hits captured so far");
+
+DEFINE_int32(
+    breakpoint_idle_disarm_sec,
+    0,  // Disabled.
+    "if positive, the JVMTI breakpoint of an active breakpoint that wasn't "
+    "hit for this many seconds is cleared, so that the JIT can compile the "
+    "method again, and set back after breakpoint_disarm_period_sec seconds; "
+    "hits while the breakpoint is disarmed are missed");
+
+DEFINE_int32(
+    breakpoint_disarm_period_sec,
+    300,
+    "time in seconds an idle breakpoint stays disarmed before its JVMTI "
+    "breakpoint is set again (see breakpoint_idle_disarm_sec)");
+
+DEFINE_int32(
+    profile_min_interval_ms,
+    10,
+    "minimal interval in milliseconds between two samples of a profile "
+    "breakpoint (see the \"cdbg.profile_interval_ms\" breakpoint label)");
+
+DEFINE_int32(
+    profile_max_duration_sec,
+    300,
+    "maximum time in seconds a profile breakpoint samples the call stacks "
+    "(see the \"cdbg.profile_duration_sec\" breakpoint label)");
+
 namespace devtools {
 namespace cdbg {
 
-// Resolves method line in a loaded and prepared Java class.
-static bool FindMethodLine(
-    jclass cls,
-    const string& method_name,
-    int line_number,
-    jmethodID* method,
-    jlocation* location) {
-  *method = nullptr;
-  *location = 0;
+// Minimal time between two adjustments of the condition sampling interval.
+// It gives the per-breakpoint cost limiter time to refill at the new
+// evaluation rate before the interval is increased again.
+constexpr int kConditionSamplingAdjustmentPeriodMs = 1000;
+
+// Breakpoint labels configuring sampling of dynamic log breakpoints. Only 1
+// in "cdbg.log_sampling_rate" hits is logged. If "cdbg.log_sampling_key" is
+// set, the decision depends on the value of this expression instead of
+// being made per hit, so that either all or none of the hits with the same
+// key value (e.g. a request ID) are logged.
+static constexpr char kLogSamplingRateLabel[] = "cdbg.log_sampling_rate";
+static constexpr char kLogSamplingKeyLabel[] = "cdbg.log_sampling_key";
+
+// Breakpoint label turning a snapshot breakpoint into a multi-hit one that
+// captures up to "cdbg.capture_hits" hits (within "capture_hits_window_sec"
+// seconds of the first one) before it completes. The breakpoint stays set
+// in between, so there is no need to set it again to catch an intermittent
+// issue. All the hits are reported in a single breakpoint update: the
+// first hit as a regular snapshot and the following ones as the changes
+// of the top frame variables and watched expressions.
+static constexpr char kCaptureHitsLabel[] = "cdbg.capture_hits";
+
+// Breakpoint label adding the call stacks of other threads to a snapshot.
+// The value is a prefix of the names of the threads to report or "*" for
+// all threads. The stacks are read at a single safepoint, which gives a
+// consistent picture of what the threads were doing at the time of the hit
+// without having to set a breakpoint in each of them.
+static constexpr char kThreadDumpLabel[] = "cdbg.thread_dump";
+
+// Breakpoint label joining breakpoints set on several nearby lines into a
+// group (see "BreakpointGroup"). Breakpoints with the same value share the
+// per-breakpoint condition cost limit. Single hit snapshot breakpoints also
+// share the capture: the first one to capture completes the others.
+static constexpr char kBreakpointGroupLabel[] = "cdbg.breakpoint_group";
+
+// Breakpoint labels configuring a profile breakpoint: the interval between
+// two samples and the time after which the breakpoint completes with the
+// profile.
+static constexpr char kProfileIntervalLabel[] = "cdbg.profile_interval_ms";
+static constexpr char kProfileDurationLabel[] = "cdbg.profile_duration_sec";
+
+// Breakpoint labels pairing two duration breakpoints into a duration probe
+// measuring the time a thread takes from one location to another. The
+// value of the label is the name of the probe: "cdbg.duration_start" is set
+// on the breakpoint at the start of the measured code region and
+// "cdbg.duration_end" on the breakpoint at its end. The optional
+// "cdbg.duration_key" expression (of a primitive type, evaluated on both
+// hits) only pairs the hits with the same value, e.g. the same request ID.
+static constexpr char kDurationStartLabel[] = "cdbg.duration_start";
+static constexpr char kDurationEndLabel[] = "cdbg.duration_end";
+static constexpr char kDurationKeyLabel[] = "cdbg.duration_key";
+
+// Name under which the aggregate of a duration probe is reported.
+static constexpr char kDurationMetricName[] = "duration_ns";
+
+// Sampling parameters of a profile breakpoint without the labels.
+constexpr int kDefaultProfileIntervalMs = 100;
+constexpr int kDefaultProfileDurationSec = 30;
+
+// State of the xorshift generator picking the breakpoint hits on which the
+// condition is evaluated when sampling. Kept per thread so that the decision
+// doesn't touch any shared memory.
+static __thread uint32 g_condition_sampling_state = 0;
+
+// Start of a duration probe measurement in the current thread.
+struct DurationProbeStart {
+  // Hash of the probe name or 0 if the slot is not used.
+  uint64 probe;
+
+  // Bits of the hit key (0 if the probe doesn't have a key).
+  uint64 key;
+
+  // Start time according to "FastClock".
+  int64 start_ns;
+};
+
+// Starts of duration probe measurements in the current thread, directly
+// mapped by the probe name hash. A measurement whose slot is taken over by
+// another probe before it ends is lost. Thread local storage keeps both
+// hits of the probe from touching any shared memory.
+constexpr int kDurationProbeSlots = 8;
+static __thread DurationProbeStart g_duration_probe_starts[
+    kDurationProbeSlots];
+
+// Decides whether the condition should be evaluated on this breakpoint hit.
+// "sampling_interval" is a power of 2.
+static bool IsConditionSampled(int sampling_interval) {
+  uint32 x = g_condition_sampling_state;
+  if (x == 0) {
+    // Xorshift state must not be zero. Seed it with something that differs
+    // between threads.
+    x = static_cast<uint32>(
+        reinterpret_cast<uintptr_t>(&g_condition_sampling_state)) | 1;
+  }
 
-  jvmtiError err = JVMTI_ERROR_NONE;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  g_condition_sampling_state = x;
 
-  // Iterate over all methods in the class.
-  jint methods_count = 0;
-  JvmtiBuffer<jmethodID> methods_buf;
-  err = jvmti()->GetClassMethods(cls, &methods_count, methods_buf.ref());
-  if (err != JVMTI_ERROR_NONE) {
-    LOG(ERROR) << "GetClassMethods failed, error: " << err;
-    return false;
+  return (x & (sampling_interval - 1)) == 0;
+}
+
+// Gets the value of breakpoint label or empty string if not set.
+static string GetBreakpointLabel(
+    const BreakpointModel& breakpoint,
+    const char* name) {
+  auto it = breakpoint.labels.find(name);
+  if (it == breakpoint.labels.end()) {
+    return string();
   }
 
-  int matched_name_count = 0;
-  for (int method_index = 0; method_index < methods_count; ++method_index) {
-    jmethodID cur_method = methods_buf.get()[method_index];
+  return it->second;
+}
 
-    // Ignore the method unless it's the one we are looking for.
-    JvmtiBuffer<char> name_buf;
-    err = jvmti()->GetMethodName(cur_method, name_buf.ref(), nullptr, nullptr);
-    if (err != JVMTI_ERROR_NONE) {
-      LOG(ERROR) << "GetMethodName failed, error: " << err << ", ignoring...";
-      continue;
-    }
 
-    if ((name_buf.get() == nullptr) || (method_name != name_buf.get())) {
-      continue;
+// Converts the value of a primitive type to the bits that identify it as a
+// hit key. Returns false if "value" is not of a primitive type.
+static bool GetHitKeyBits(const JVariant& value, uint64* key) {
+  switch (value.type()) {
+    case JType::Boolean: {
+      jboolean z = false;
+      value.get<jboolean>(&z);
+      *key = z ? 1 : 0;
+      return true;
     }
 
-    // Get the line numbers corresponding to the code statements of the method.
-    jint line_entries_count = 0;
-    JvmtiBuffer<jvmtiLineNumberEntry> line_entries;
-    err = jvmti()->GetLineNumberTable(
-        cur_method,
-        &line_entries_count,
-        line_entries.ref());
+    case JType::Byte: {
+      jbyte b = 0;
+      value.get<jbyte>(&b);
+      *key = static_cast<uint64>(b);
+      return true;
+    }
 
-    if (err == JVMTI_ERROR_ABSENT_INFORMATION) {
-      LOG(ERROR) << "Class doesn't have line number debugging information";
-      return false;
+    case JType::Char: {
+      jchar c = 0;
+      value.get<jchar>(&c);
+      *key = c;
+      return true;
     }
 
-    if (err != JVMTI_ERROR_NONE) {
-      LOG(ERROR) << "GetLineNumberTable failed, error: " << err;
-      return false;
+    case JType::Short: {
+      jshort s = 0;
+      value.get<jshort>(&s);
+      *key = static_cast<uint64>(s);
+      return true;
     }
 
-    // Match the line. The "line_number" parameter is by now adjusted to
-    // the start location of a statement.
-    for (int line_index = 0; line_index < line_entries_count; ++line_index) {
-      const jvmtiLineNumberEntry& line_entry = line_entries.get()[line_index];
+    case JType::Int: {
+      jint i = 0;
+      value.get<jint>(&i);
+      *key = static_cast<uint64>(i);
+      return true;
+    }
 
-      if (line_entry.line_number == line_number) {
-        *method = cur_method;
-        *location = line_entry.start_location;
+    case JType::Long: {
+      jlong j = 0;
+      value.get<jlong>(&j);
+      *key = static_cast<uint64>(j);
+      return true;
+    }
 
-        LOG(INFO) << "Line " << line_number << " in method " << method_name
-                  << " resolved to method ID: " << *method
-                  << ", location: " << *location;
+    case JType::Float: {
+      jfloat f = 0;
+      value.get<jfloat>(&f);
+      uint32 bits = 0;
+      memcpy(&bits, &f, sizeof(bits));
+      *key = bits;
+      return true;
+    }
 
-        return true;
-      }
+    case JType::Double: {
+      jdouble d = 0;
+      value.get<jdouble>(&d);
+      memcpy(key, &d, sizeof(*key));
+      return true;
     }
 
-    // We may still find an overloaded method with the matching line.
-    ++matched_name_count;
+    case JType::Void:
+    case JType::Object:
+      return false;
   }
 
-  if (matched_name_count > 0) {
-    LOG(ERROR) << "No statement at line " << line_number
-               << " found in method " << method_name
-               << " (" << matched_name_count << " methods matched)";
-  } else {
-    LOG(ERROR) << "Method " << method_name << " not found in the class";
+  return false;
+}
+
+
+// Mixes the bits of the hit key (SplitMix64 finalizer), so that sequential
+// keys like request counters are sampled evenly.
+static uint64 HashHitKey(uint64 key) {
+  key ^= key >> 30;
+  key *= 0xbf58476d1ce4e5b9ULL;
+  key ^= key >> 27;
+  key *= 0x94d049bb133111ebULL;
+  key ^= key >> 31;
+  return key;
+}
+
+
+// FNV-1a hash of a duration probe name. Never returns 0, which marks an
+// unused slot in "g_duration_probe_starts".
+static uint64 HashDurationProbeName(const string& name) {
+  uint64 hash = 0xCBF29CE484222325ULL;
+  for (char ch : name) {
+    hash ^= static_cast<uint8>(ch);
+    hash *= 0x100000001B3ULL;
   }
 
-  return false;
+  return (hash == 0) ? 1 : hash;
 }
 
 
@@ -139,11 +361,20 @@ CompiledBreakpoint::CompiledBreakpoint(
     const jmethodID method,
     const jlocation location,
     CompiledExpression condition,
-    std::vector<CompiledExpression> watches)
+    std::vector<CompiledExpression> watches,
+    std::shared_ptr<const MessageTemplate> log_message_template,
+    CompiledExpression hit_key,
+    int shared_subexpressions_count)
     : method_(method),
       location_(location),
       condition_(std::move(condition)),
-      watches_(std::move(watches)) {
+      condition_has_method_calls_(
+          (condition_.evaluator != nullptr) &&
+          condition_.evaluator->HasMethodCalls()),
+      watches_(std::move(watches)),
+      log_message_template_(std::move(log_message_template)),
+      hit_key_(std::move(hit_key)),
+      shared_subexpressions_count_(shared_subexpressions_count) {
   cls_.Assign(cls);
 }
 
@@ -167,13 +398,15 @@ JvmBreakpoint::JvmBreakpoint(
     Scheduler<>* scheduler,
     JvmEvaluators* evaluators,
     FormatQueue* format_queue,
-    DynamicLogger* dynamic_logger,
+    DynamicLogQueue* dynamic_log_queue,
+    std::shared_ptr<DynamicLogger> dynamic_logger,
     BreakpointsManager* breakpoints_manager,
     std::unique_ptr<BreakpointModel> breakpoint_definition)
     : scheduler_(scheduler),
       evaluators_(evaluators),
       format_queue_(format_queue),
-      dynamic_logger_(dynamic_logger),
+      dynamic_log_queue_(dynamic_log_queue),
+      dynamic_logger_(std::move(dynamic_logger)),
       breakpoints_manager_(breakpoints_manager),
       definition_(std::move(breakpoint_definition)),
       jvmti_breakpoint_(breakpoints_manager) {
@@ -183,12 +416,34 @@ JvmBreakpoint::JvmBreakpoint(
   if (definition_->action == BreakpointModel::Action::LOG) {
     breakpoint_dynamic_log_limiter_ =
       CreatePerBreakpointCostLimiter(CostLimitType::DynamicLog);
+    breakpoint_dynamic_log_bytes_limiter_ =
+      CreatePerBreakpointCostLimiter(CostLimitType::DynamicLogBytes);
+    log_message_size_ = std::make_shared<std::atomic<int64>>(0);
+  }
+
+  if (definition_->action == BreakpointModel::Action::METRIC) {
+    metric_aggregator_.reset(new MetricAggregator);
   }
 }
 
 
 JvmBreakpoint::~JvmBreakpoint() {
   scheduler_->Cancel(scheduler_id_);
+  scheduler_->Cancel(multi_hit_capture_.window_scheduler_id);
+  scheduler_->Cancel(profile_scheduler_id_);
+
+  {
+    MutexLock lock(&idle_disarm_.mu);
+    scheduler_->Cancel(idle_disarm_.scheduler_id);
+  }
+
+  // Hits of a multi-hit breakpoint that was completed before they were
+  // reported.
+  for (const auto& hit : multi_hit_capture_.hits) {
+    if (hit != nullptr) {
+      hit->ReleaseRefs();
+    }
+  }
 }
 
 
@@ -212,6 +467,121 @@ void JvmBreakpoint::Initialize() {
       std::weak_ptr<JvmBreakpoint>(shared_from_this()),
       &JvmBreakpoint::OnBreakpointExpired);
 
+  // The aggregate of a metric breakpoint is reported as the value of its
+  // only expression.
+  if ((definition_->action == BreakpointModel::Action::METRIC) &&
+      (definition_->expressions.size() != 1)) {
+    CompleteBreakpointWithStatus(StatusMessageBuilder()
+        .set_error()
+        .set_refers_to(
+            StatusMessageModel::Context::BREAKPOINT_EXPRESSION)
+        .set_format(MetricExpressionRequired)
+        .build());
+    return;
+  }
+
+  // A profile breakpoint samples all the threads, so its location is never
+  // resolved.
+  if (definition_->action == BreakpointModel::Action::PROFILE) {
+    StartProfile();
+    return;
+  }
+
+  FormatMessageModel hit_filter_error;
+  if (!hit_filter_.Initialize(*definition_, &hit_filter_error)) {
+    CompleteBreakpointWithStatus(StatusMessageBuilder()
+        .set_error()
+        .set_description(hit_filter_error)
+        .build());
+    return;
+  }
+
+  // The JVMTI breakpoint is not set yet, so the cost limiter can still be
+  // replaced.
+  const string group_name =
+      GetBreakpointLabel(*definition_, kBreakpointGroupLabel);
+  if (!group_name.empty()) {
+    group_ = breakpoints_manager_->GetBreakpointGroup(group_name);
+    group_->AddMember(shared_from_this());
+    breakpoint_condition_cost_limiter_ = group_->condition_cost_limiter();
+  }
+
+  if (definition_->action == BreakpointModel::Action::DURATION) {
+    const string start_probe =
+        GetBreakpointLabel(*definition_, kDurationStartLabel);
+    const string end_probe =
+        GetBreakpointLabel(*definition_, kDurationEndLabel);
+    if (start_probe.empty() == end_probe.empty()) {
+      CompleteBreakpointWithStatus(StatusMessageBuilder()
+          .set_error()
+          .set_format(DurationProbeLabelRequired)
+          .set_parameters({ kDurationStartLabel, kDurationEndLabel })
+          .build());
+      return;
+    }
+
+    is_duration_end_ = !end_probe.empty();
+    duration_probe_ =
+        HashDurationProbeName(is_duration_end_ ? end_probe : start_probe);
+    if (is_duration_end_) {
+      metric_aggregator_.reset(new MetricAggregator);
+    }
+  }
+
+  if (definition_->action == BreakpointModel::Action::LOG) {
+    const string sampling_rate =
+        GetBreakpointLabel(*definition_, kLogSamplingRateLabel);
+    if (!sampling_rate.empty()) {
+      char* end = nullptr;
+      const int64 rate = strtoll(sampling_rate.c_str(), &end, 10);  // NOLINT
+      if ((*end != '\0') ||
+          (rate < 1) ||
+          (rate > std::numeric_limits<int>::max())) {
+        CompleteBreakpointWithStatus(StatusMessageBuilder()
+            .set_error()
+            .set_format(InvalidLogSamplingRate)
+            .set_parameters({ sampling_rate })
+            .build());
+        return;
+      }
+
+      log_sampling_rate_ = static_cast<int>(rate);
+    }
+  }
+
+  if (definition_->action == BreakpointModel::Action::CAPTURE) {
+    const string capture_hits =
+        GetBreakpointLabel(*definition_, kCaptureHitsLabel);
+    if (!capture_hits.empty()) {
+      char* end = nullptr;
+      const int64 hits = strtoll(capture_hits.c_str(), &end, 10);  // NOLINT
+      if ((*end != '\0') ||
+          (hits < 1) ||
+          (hits > std::max(1, FLAGS_max_capture_hits))) {
+        CompleteBreakpointWithStatus(StatusMessageBuilder()
+            .set_error()
+            .set_format(InvalidCaptureHits)
+            .set_parameters({
+                capture_hits,
+                std::to_string(std::max(1, FLAGS_max_capture_hits))
+            })
+            .build());
+        return;
+      }
+
+      capture_hits_ = static_cast<int>(hits);
+      if (capture_hits_ > 1) {
+        multi_hit_capture_.hits.resize(capture_hits_);
+      }
+    }
+
+    thread_dump_prefix_ = GetBreakpointLabel(*definition_, kThreadDumpLabel);
+    is_thread_dump_ = !thread_dump_prefix_.empty();
+    if (thread_dump_prefix_ == "*") {
+      thread_dump_prefix_.clear();
+    }
+  }
+
   std::shared_ptr<ResolvedSourceLocation> rsl(new ResolvedSourceLocation);
 
   // Find the statement in Java code corresponding to breakpoint location.
@@ -265,12 +635,23 @@ void JvmBreakpoint::Initialize() {
 }
 
 
+string JvmBreakpoint::GetClassSignature() const {
+  std::shared_ptr<ResolvedSourceLocation> location = resolved_location_;
+  if (location == nullptr) {
+    return string();  // The breakpoint is still uninitialized
+  }
+
+  return location->class_signature;
+}
+
+
 void JvmBreakpoint::ResetToPending() {
   // We assume here that a class will not be reloaded while a method
   // is being unloaded. If that happens, we may ignore "OnClassLoaded" event.
 
   jvmti_breakpoint_.Clear(shared_from_this());
   compiled_breakpoint_ = nullptr;
+  is_jvmti_breakpoint_preset_ = false;
 }
 
 
@@ -286,40 +667,119 @@ void JvmBreakpoint::OnClassPrepared(
     return;  // The breakpoint is still uninitialized
   }
 
-  if (location->class_signature == class_signature) {
-    LOG(INFO) << "Class " << type_name << " loaded (" << class_signature
-              << "), trying to activate pending breakpoint " << id();
+  if (location->class_signature != class_signature) {
+    return;
+  }
 
-    TryActivatePendingBreakpoint();
+  // Compiling the breakpoint expressions here would stall the application
+  // thread loading the class. Leave it to the agent thread if there is one.
+  if (FLAGS_cdbg_async_breakpoint_activation) {
+    if (FLAGS_cdbg_preset_jvmti_breakpoint) {
+      PresetJvmtiBreakpoint(*location);
+    }
+
+    if (breakpoints_manager_->ScheduleBreakpointActivation(
+            shared_from_this())) {
+      LOG(INFO) << "Class " << type_name << " loaded (" << class_signature
+                << "), scheduled activation of pending breakpoint " << id();
+      return;
+    }
   }
+
+  LOG(INFO) << "Class " << type_name << " loaded (" << class_signature
+            << "), trying to activate pending breakpoint " << id();
+
+  TryActivatePendingBreakpoint();
+}
+
+
+void JvmBreakpoint::ActivatePending() {
+  TryActivatePendingBreakpoint();
 }
 
 
 void JvmBreakpoint::OnJvmBreakpointHit(
     jthread thread,
     jmethodID method,
-    jlocation location) {
-  Stopwatch stopwatch(Stopwatch::ThreadClock);
+    jlocation location,
+    SharedCapture* shared_capture) {
+  HitStopwatch stopwatch;
+  const int64 gc_epoch = GcEpoch::Get();
+  OverheadGovernor* overhead_governor = OverheadGovernor::GetInstance();
+  int64 charged_nanos = 0;
 
   std::shared_ptr<CompiledBreakpoint> state = compiled_breakpoint_;
   if (state == nullptr) {
+    // The JVMTI breakpoint was set before the expressions were compiled
+    // (see "FLAGS_cdbg_preset_jvmti_breakpoint"). Drop the hit.
+    if (is_jvmti_breakpoint_preset_) {
+      return;
+    }
+
     // The breakpoint is already pending. This is possible if some other thread
     // just completed this breakpoint (while the callback was being routed).
-    LOG(INFO) << "Breakpoint " << id() << " is in pending state, "
-                 "ignoring breakpoint hit";
+    LOG_RATE_LIMITED(INFO) << "Breakpoint " << id() << " is in pending state, "
+                              "ignoring breakpoint hit";
     return;
   }
 
   DCHECK((method == state->method()) && (location == state->location()));
 
+  BreakpointCounters::Increment(&counters_.hits);
+
+  // Hit count and thread predicates are much cheaper than the condition.
+  if (!hit_filter_.IsHitAccepted(thread)) {
+    BreakpointCounters::Increment(&counters_.sampled_out);
+    return;
+  }
+
+  // Method calls that appear in several expressions of the breakpoint are
+  // only evaluated once per hit.
+  std::shared_ptr<SharedSubexpressionValues> shared_values;
+  if (state->shared_subexpressions_count() > 0) {
+    shared_values = std::make_shared<SharedSubexpressionValues>(
+        state->shared_subexpressions_count());
+  }
+
   // Evaluate breakpoint condition (if defined).
   if (state->condition().evaluator != nullptr) {
-    bool condition_result = EvaluateCondition(state->condition(), thread);
+    // The condition was too expensive to evaluate on every hit. Treat the
+    // hits that are not sampled as if the condition was false.
+    const int sampling_interval =
+        condition_sampling_interval_.load(std::memory_order_relaxed);
+    if ((sampling_interval > 1) && !IsConditionSampled(sampling_interval)) {
+      BreakpointCounters::Increment(&counters_.quota_rejections);
+      return;
+    }
+
+    // The agent is over its total CPU budget.
+    if (!overhead_governor->IsAdmitted(OverheadPriority::Condition)) {
+      BreakpointCounters::Increment(&counters_.quota_rejections);
+      return;
+    }
+
+    bool condition_result;
+    {
+      ScopedTraceSpan trace_span("condition", id());
+      ScopedHotPathCounters hot_path_counters(kConditionCounters);
+      condition_result = EvaluateCondition(*state, thread, shared_values.get());
+    }
     int64 current_condition_nanos = stopwatch.GetElapsedNanos();
-    condition_cost_ns_.Add(current_condition_nanos);
+    // A GC pause during the evaluation is not the cost of the condition.
+    // Charging it would make the condition quota throttle a breakpoint for
+    // something it didn't do.
+    if (!GcEpoch::HasCollectedSince(gc_epoch)) {
+      condition_cost_ns_.Add(current_condition_nanos);
+      overhead_governor->Charge(current_condition_nanos);
+    }
+    charged_nanos = current_condition_nanos;
 
     statConditionEvaluationTime->add(current_condition_nanos / 1000);
 
+    BreakpointCounters::Increment(condition_result
+        ? &counters_.condition_true
+        : &counters_.condition_false);
+
     if (!condition_result) {
       // Skip quota if breakpoint got completed.
       if (compiled_breakpoint_ != nullptr) {
@@ -332,97 +792,645 @@ void JvmBreakpoint::OnJvmBreakpointHit(
 
   switch (definition_->action) {
     case BreakpointModel::Action::CAPTURE: {
-      DoCaptureAction(thread, state.get());
+      {
+        ScopedTraceSpan trace_span("capture", id());
+        DoCaptureAction(
+            thread,
+            state,
+            shared_capture,
+            std::move(shared_values));
+      }
 
       statCaptureTime->add(stopwatch.GetElapsedMicros());
       break;
     }
 
     case BreakpointModel::Action::LOG: {
-      DoLogAction(thread, state.get());
+      {
+        ScopedTraceSpan trace_span("log", id());
+        DoLogAction(thread, state.get(), shared_values.get());
+      }
 
       statDynamicLogTime->add(stopwatch.GetElapsedMicros());
       break;
     }
+
+    case BreakpointModel::Action::METRIC: {
+      DoMetricAction(thread, state.get(), shared_values.get());
+      break;
+    }
+
+    case BreakpointModel::Action::PROFILE:
+      break;  // The JVMTI breakpoint is never set.
+
+    case BreakpointModel::Action::DURATION: {
+      DoDurationAction(thread, *state);
+      break;
+    }
   }
+
+  overhead_governor->Charge(stopwatch.GetElapsedNanos() - charged_nanos);
 }
 
 
 void JvmBreakpoint::DoCaptureAction(
     jthread thread,
-    CompiledBreakpoint* state) {
+    std::shared_ptr<CompiledBreakpoint> state,
+    SharedCapture* shared_capture,
+    std::shared_ptr<SharedSubexpressionValues> shared_values) {
+  // The agent is over its CPU budget. Leave the breakpoint active and capture
+  // on one of the next hits.
+  if (!OverheadGovernor::GetInstance()->IsAdmitted(
+          OverheadPriority::Capture)) {
+    BreakpointCounters::Increment(&counters_.quota_rejections);
+    return;
+  }
+
+  // Don't pause the application thread to capture data that would likely be
+  // discarded because breakpoint updates can't be delivered fast enough.
+  if (!format_queue_->IsCaptureAdmitted()) {
+    // Don't cancel a multi-hit breakpoint that has some hits captured
+    // already. Skip this hit and report the earlier ones.
+    if (capture_hits_ > 1) {
+      MutexLock lock(&multi_hit_capture_.mu);
+      if (multi_hit_capture_.hits_count > 0) {
+        BreakpointCounters::Increment(&counters_.drops);
+        return;
+      }
+    }
+
+    LOG(WARNING) << "Breakpoint updates backlog is full, cancelling "
+                    "snapshot, breakpoint ID: " << id();
+    BreakpointCounters::Increment(&counters_.drops);
+
+    CompleteBreakpointWithStatus(StatusMessageBuilder()
+        .set_error()
+        .set_format(SnapshotCancelledBacklog)
+        .build());
+    return;
+  }
+
+  if (capture_hits_ > 1) {
+    DoMultiHitCaptureAction(thread, *state, shared_values.get());
+    return;
+  }
+
+  // Only one breakpoint of a group captures a snapshot. The one that does
+  // completes the rest of the group.
+  if ((group_ != nullptr) && !group_->ClaimCapture()) {
+    return;
+  }
+
   // It will now take a few milliseconds to capture all the data. Then the
   // breakpoint will be done. We don't want other threads to waste their time
   // on this breakpoint while capturing data, so we clear it here.
+  BreakpointCounters::Increment(&counters_.captures);
   breakpoints_manager_->CompleteBreakpoint(id());
 
-  // Capture the data at a breakpoint hit and prepare it for formatting. The
-  // formatting will happen in a worker thread at a later time.
-  std::unique_ptr<CaptureDataCollector> collector(
-      new CaptureDataCollector(evaluators_));
-  collector->Collect(state->watches(), thread);
+  if (group_ != nullptr) {
+    for (const std::shared_ptr<Breakpoint>& member :
+         group_->GetOtherMembers(id())) {
+      member->CompleteBreakpointWithStatus(StatusMessageBuilder()
+          .set_info()
+          .set_format(BreakpointGroupCaptured)
+          .set_parameters({ group_->name(), id() })
+          .build());
+    }
+  }
+
+  // Other breakpoints were hit at this location. Let them all share a single
+  // capture of call stack and objects. "state" is kept alive by the callback
+  // until the shared capture evaluated the watched expressions. So are the
+  // shared subexpression values.
+  if ((shared_capture != nullptr) && !is_thread_dump_) {
+    const std::vector<CompiledExpression>* watches = &state->watches();
+    shared_capture->Enlist(
+        id(),
+        definition_->capture_profile,
+        watches,
+        shared_values.get(),
+        [this, state, shared_values] (
+            std::shared_ptr<CaptureDataCollector> collector) {
+          BreakpointBuilder builder(*definition_);
+          CompleteBreakpoint(&builder, std::move(collector));
+        });
+    return;
+  }
+
+  // Capture the data at a breakpoint hit and prepare it for formatting. The
+  // formatting will happen in a worker thread at a later time.
+  std::shared_ptr<CaptureDataCollector> collector(
+      new CaptureDataCollector(evaluators_, definition_->capture_profile));
+  collector->Collect(state->watches(), shared_values.get(), thread);
+
+  if (is_thread_dump_) {
+    collector->CollectThreadDump(thread_dump_prefix_);
+  }
+
+  // Enqueue the breakpoint result and deactivate the breakpoint.
+  BreakpointBuilder builder(*definition_);
+  CompleteBreakpoint(&builder, std::move(collector));
+}
+
+
+void JvmBreakpoint::DoMultiHitCaptureAction(
+    jthread thread,
+    const CompiledBreakpoint& state,
+    SharedSubexpressionValues* shared_values) {
+  int hit_number;
+  {
+    MutexLock lock(&multi_hit_capture_.mu);
+    if (multi_hit_capture_.is_closed) {
+      return;  // Another thread took the last hit.
+    }
+
+    hit_number = ++multi_hit_capture_.hits_count;
+    ++multi_hit_capture_.collecting_count;
+    multi_hit_capture_.is_closed = (hit_number == capture_hits_);
+  }
+
+  BreakpointCounters::Increment(&counters_.captures);
+
+  if (hit_number == capture_hits_) {
+    // This is the last hit. Don't let other threads hit the breakpoint while
+    // the data is captured.
+    breakpoints_manager_->CompleteBreakpoint(id());
+  } else if (hit_number == 1) {
+    const Scheduler<>::Id window_scheduler_id = scheduler_->Schedule(
+        scheduler_->CurrentTime() + FLAGS_capture_hits_window_sec,
+        std::weak_ptr<JvmBreakpoint>(shared_from_this()),
+        &JvmBreakpoint::OnCaptureWindowClosed);
+
+    MutexLock lock(&multi_hit_capture_.mu);
+    multi_hit_capture_.window_scheduler_id = window_scheduler_id;
+  }
+
+  // Call stack, names and types of the variables are only reported by the
+  // first hit.
+  std::shared_ptr<CaptureDataCollector> collector(
+      new CaptureDataCollector(
+          evaluators_,
+          (hit_number == 1)
+              ? definition_->capture_profile
+              : BreakpointModel::CaptureProfile::MINIMAL));
+  collector->Collect(state.watches(), shared_values, thread);
+
+  std::vector<std::shared_ptr<CaptureDataCollector>> hits;
+  {
+    MutexLock lock(&multi_hit_capture_.mu);
+
+    multi_hit_capture_.hits[hit_number - 1] = std::move(collector);
+    --multi_hit_capture_.collecting_count;
+
+    if (!multi_hit_capture_.is_closed ||
+        (multi_hit_capture_.collecting_count > 0) ||
+        multi_hit_capture_.is_completed) {
+      return;
+    }
+
+    multi_hit_capture_.is_completed = true;
+    hits.swap(multi_hit_capture_.hits);
+  }
+
+  CompleteMultiHitCapture(std::move(hits));
+}
+
+
+bool JvmBreakpoint::CloseCaptureWindow(
+    std::vector<std::shared_ptr<CaptureDataCollector>>* hits) {
+  MutexLock lock(&multi_hit_capture_.mu);
+
+  if (multi_hit_capture_.hits_count == 0) {
+    return false;
+  }
+
+  multi_hit_capture_.is_closed = true;
+
+  if ((multi_hit_capture_.collecting_count == 0) &&
+      !multi_hit_capture_.is_completed) {
+    multi_hit_capture_.is_completed = true;
+    hits->swap(multi_hit_capture_.hits);
+  }
+
+  return true;
+}
+
+
+void JvmBreakpoint::CompleteMultiHitCapture(
+    std::vector<std::shared_ptr<CaptureDataCollector>> hits) {
+  // The first hit is always collected before the breakpoint completes.
+  DCHECK(!hits.empty() && (hits[0] != nullptr));
+
+  std::shared_ptr<CaptureDataCollector> first_hit = std::move(hits[0]);
+  for (int i = 1; i < hits.size(); ++i) {
+    if (hits[i] != nullptr) {
+      first_hit->AddFollowingHit(i + 1, std::move(hits[i]));
+    }
+  }
+
+  BreakpointBuilder builder(*definition_);
+  CompleteBreakpoint(&builder, std::move(first_hit));
+}
+
+
+void JvmBreakpoint::OnCaptureWindowClosed() {
+  // Keep this instance alive at least until this function exits.
+  std::shared_ptr<Breakpoint> instance_holder = shared_from_this();
+
+  std::vector<std::shared_ptr<CaptureDataCollector>> hits;
+  if (!CloseCaptureWindow(&hits) || hits.empty()) {
+    return;
+  }
+
+  LOG(INFO) << "Capture window of breakpoint " << id() << " closed";
+
+  CompleteMultiHitCapture(std::move(hits));
+}
+
+
+void JvmBreakpoint::DoLogAction(
+    jthread thread,
+    CompiledBreakpoint* state,
+    SharedSubexpressionValues* shared_values) {
+  if (!dynamic_logger_->IsAvailable()) {
+    CompleteBreakpointWithStatus(StatusMessageBuilder()
+        .set_error()
+        .set_format(DynamicLoggerNotAvailable)
+        .build());
+
+    return;
+  }
+
+  std::shared_ptr<ResolvedSourceLocation> rsl = resolved_location_;
+  if (rsl == nullptr) {
+    // The breakpoint is being deactivated.
+    LOG_RATE_LIMITED(WARNING) << "Source location is not available";
+    return;
+  }
+
+  if ((log_sampling_rate_ > 1) && !IsLogHitSampled(*state, thread)) {
+    BreakpointCounters::Increment(&counters_.sampled_out);
+    return;
+  }
+
+  int64 message_bytes = log_message_size_->load(std::memory_order_relaxed);
+  if (message_bytes == 0) {
+    const MessageTemplate& log_message_template =
+        *state->log_message_template();
+    message_bytes =
+        log_message_template.literals_size() +
+        log_message_template.parameters_count() * kEstimatedWatchResultSize;
+  }
+
+  if (!ApplyDynamicLogsQuota(
+          *rsl,
+          std::min<int64>(
+              message_bytes,
+              FLAGS_max_dynamic_log_message_bytes))) {
+    BreakpointCounters::Increment(&counters_.quota_rejections);
+    return;
+  }
+
+  // Formatting the message and writing it to the application log is
+  // deferred to the worker thread (if it's running). Don't bother evaluating
+  // the expressions if the entry would be discarded.
+  const bool is_deferred = dynamic_log_queue_->IsConsumerActive();
+  if (is_deferred && dynamic_log_queue_->IsFull()) {
+    BreakpointCounters::Increment(&counters_.drops);
+    return;
+  }
+
+  MethodCallerPtr method_caller =
+      evaluators_->method_caller_factory(Config::DYNAMIC_LOG);
+
+  std::unique_ptr<DynamicLogEntry> entry(new DynamicLogEntry);
+
+  entry->collector.Collect(
+      method_caller.get(),
+      evaluators_->class_metadata_reader,
+      evaluators_->object_evaluator,
+      state->watches(),
+      shared_values,
+      thread);
+
+  if (is_deferred) {
+    entry->logger = dynamic_logger_;
+    entry->level = definition_->log_level;
+    entry->source_location = std::move(rsl);
+    entry->log_message_template = state->log_message_template();
+    entry->message_size = log_message_size_;
+
+    if (!dynamic_log_queue_->Enqueue(std::move(entry))) {
+      BreakpointCounters::Increment(&counters_.drops);
+      return;
+    }
+  } else {
+    const string message =
+        entry->collector.Format(*state->log_message_template());
+    log_message_size_->store(message.size(), std::memory_order_relaxed);
+
+    dynamic_logger_->Log(definition_->log_level, *rsl, message);
+  }
+
+  BreakpointCounters::Increment(&counters_.logs);
+}
+
+
+bool JvmBreakpoint::IsLogHitSampled(
+    const CompiledBreakpoint& state,
+    jthread thread) {
+  if (state.hit_key().evaluator == nullptr) {
+    return log_sampling_counter_.fetch_add(1, std::memory_order_relaxed) %
+           log_sampling_rate_ == 0;
+  }
+
+  uint64 key_bits = 0;
+  if (!EvaluateHitKey(state, thread, &key_bits)) {
+    // Can't tell which request this hit belongs to.
+    return false;
+  }
+
+  return HashHitKey(key_bits) % log_sampling_rate_ == 0;
+}
+
+
+bool JvmBreakpoint::EvaluateHitKey(
+    const CompiledBreakpoint& state,
+    jthread thread,
+    uint64* key_bits) {
+  EvaluationContext evaluation_context;
+  evaluation_context.frame_depth = 0;  // Topmost call frame.
+  evaluation_context.thread = thread;
+  evaluation_context.method_caller = nullptr;  // The key doesn't call methods.
+
+  ErrorOr<JVariant> key_value =
+      state.hit_key().evaluator->Evaluate(evaluation_context);
+  return !key_value.is_error() &&
+         GetHitKeyBits(key_value.value(), key_bits);
+}
+
+
+void JvmBreakpoint::DoMetricAction(
+    jthread thread,
+    CompiledBreakpoint* state,
+    SharedSubexpressionValues* shared_values) {
+  if (!OverheadGovernor::GetInstance()->IsAdmitted(
+          OverheadPriority::Condition)) {
+    BreakpointCounters::Increment(&counters_.quota_rejections);
+    return;
+  }
+
+  const CompiledExpression& expression = state->watches()[0];
+
+  MethodCallerPtr method_caller;
+  if (expression.evaluator->HasMethodCalls()) {
+    method_caller =
+        evaluators_->method_caller_factory(Config::EXPRESSION_EVALUATION);
+  }
+
+  EvaluationContext evaluation_context;
+  evaluation_context.frame_depth = 0;  // Topmost call frame.
+  evaluation_context.thread = thread;
+  evaluation_context.method_caller = method_caller.get();
+  evaluation_context.shared_values = shared_values;
+
+  ErrorOr<JVariant> value = expression.evaluator->Evaluate(evaluation_context);
+
+  double sample = 0;
+  if (!value.is_error() &&
+      MetricAggregator::GetSample(value.value(), &sample)) {
+    metric_aggregator_->Add(sample);
+  } else {
+    metric_aggregator_->AddError();
+  }
+
+  BreakpointCounters::Increment(&counters_.metrics);
+
+  if (IsMetricUpdateDue()) {
+    SendMetricUpdate();
+  }
+}
+
+
+bool JvmBreakpoint::IsMetricUpdateDue() {
+  const int64 now_ms = metric_update_timer_.GetElapsedMillis();
+  int64 last_update_ms =
+      last_metric_update_ms_.load(std::memory_order_relaxed);
+  if (now_ms - last_update_ms <
+      FLAGS_metric_breakpoint_update_interval_sec * 1000LL) {
+    return false;
+  }
+
+  return last_metric_update_ms_.compare_exchange_strong(
+      last_update_ms,
+      now_ms,
+      std::memory_order_relaxed);
+}
+
+
+void JvmBreakpoint::SendMetricUpdate() {
+  VariableBuilder variable_builder;
+  variable_builder.set_name(GetMetricName());
+  metric_aggregator_->Format(&variable_builder);
+
+  BreakpointBuilder breakpoint_builder(*definition_);
+  breakpoint_builder.clear_evaluated_expressions();
+  breakpoint_builder.add_evaluated_expression(variable_builder);
+
+  // A pending interim update of this breakpoint is replaced, so a slow
+  // backend only ever gets the latest aggregate.
+  if (!format_queue_->Enqueue(breakpoint_builder.build(), nullptr)) {
+    BreakpointCounters::Increment(&counters_.drops);
+  }
+}
+
+
+string JvmBreakpoint::GetMetricName() const {
+  if (definition_->action == BreakpointModel::Action::DURATION) {
+    return kDurationMetricName;
+  }
+
+  if (definition_->expressions.size() != 1) {
+    return string();
+  }
+
+  return definition_->expressions[0];
+}
+
+
+void JvmBreakpoint::DoDurationAction(
+    jthread thread,
+    const CompiledBreakpoint& state) {
+  // The end of the code region is as close to the hit as possible.
+  const int64 now_ns = FastClock::NowNanos();
+
+  uint64 key_bits = 0;
+  if ((state.hit_key().evaluator != nullptr) &&
+      !EvaluateHitKey(state, thread, &key_bits)) {
+    if (is_duration_end_) {
+      metric_aggregator_->AddError();
+    }
+
+    return;
+  }
+
+  DurationProbeStart& start =
+      g_duration_probe_starts[duration_probe_ % kDurationProbeSlots];
+
+  if (!is_duration_end_) {
+    start.probe = duration_probe_;
+    start.key = key_bits;
+    start.start_ns = FastClock::NowNanos();  // Excludes the key evaluation.
+    return;
+  }
+
+  // The start of the code region was not hit in this thread since the last
+  // end (e.g. the start breakpoint was not active yet).
+  if ((start.probe != duration_probe_) || (start.key != key_bits)) {
+    metric_aggregator_->AddError();
+    return;
+  }
+
+  start.probe = 0;
+  metric_aggregator_->Add(now_ns - start.start_ns);
+
+  BreakpointCounters::Increment(&counters_.metrics);
+
+  if (IsMetricUpdateDue()) {
+    SendMetricUpdate();
+  }
+}
+
 
-  // Enqueue the breakpoint result and deactivate the breakpoint.
-  BreakpointBuilder builder(*definition_);
-  CompleteBreakpoint(&builder, std::move(collector));
+// Parses the value of an integer label of a profile breakpoint. Sets "value"
+// to "default_value" if the label is not set.
+static bool ParseProfileLabel(
+    const BreakpointModel& definition,
+    const char* name,
+    int default_value,
+    int min_value,
+    int max_value,
+    int* value,
+    FormatMessageModel* error_message) {
+  const string label = GetBreakpointLabel(definition, name);
+  if (label.empty()) {
+    *value = default_value;
+    return true;
+  }
+
+  char* end = nullptr;
+  const int64 parsed = strtoll(label.c_str(), &end, 10);  // NOLINT
+  if ((*end != '\0') || (parsed < min_value) || (parsed > max_value)) {
+    *error_message = {
+      InvalidBreakpointLabel,
+      { name, label, std::to_string(min_value) }
+    };
+    return false;
+  }
+
+  *value = static_cast<int>(parsed);
+  return true;
 }
 
 
-void JvmBreakpoint::DoLogAction(
-    jthread thread,
-    CompiledBreakpoint* state) {
-  if (!dynamic_logger_->IsAvailable()) {
+void JvmBreakpoint::StartProfile() {
+  const int min_interval_ms = std::max(1, FLAGS_profile_min_interval_ms);
+  const int max_duration_sec = std::max(1, FLAGS_profile_max_duration_sec);
+
+  int interval_ms = 0;
+  int duration_sec = 0;
+  FormatMessageModel error_message;
+  if (!ParseProfileLabel(
+          *definition_,
+          kProfileIntervalLabel,
+          std::max(min_interval_ms, kDefaultProfileIntervalMs),
+          min_interval_ms,
+          std::numeric_limits<int>::max(),
+          &interval_ms,
+          &error_message) ||
+      !ParseProfileLabel(
+          *definition_,
+          kProfileDurationLabel,
+          std::min(max_duration_sec, kDefaultProfileDurationSec),
+          1,
+          max_duration_sec,
+          &duration_sec,
+          &error_message)) {
     CompleteBreakpointWithStatus(StatusMessageBuilder()
         .set_error()
-        .set_format(DynamicLoggerNotAvailable)
+        .set_description(error_message)
         .build());
-
     return;
   }
 
-  std::shared_ptr<ResolvedSourceLocation> rsl = resolved_location_;
-  if (rsl == nullptr) {
-    // The breakpoint is being deactivated.
-    LOG(WARNING) << "Source location is not available";
+  stack_sampler_.reset(new StackSampler(evaluators_->eval_call_stack));
+  if (!stack_sampler_->Start(interval_ms, duration_sec * 1000)) {
+    stack_sampler_ = nullptr;
+    CompleteBreakpointWithStatus(StatusMessageBuilder()
+        .set_error()
+        .set_description(INTERNAL_ERROR_MESSAGE)
+        .build());
     return;
   }
 
-  if (!ApplyDynamicLogsQuota(*rsl)) {
+  LOG(INFO) << "Profile breakpoint " << id() << " started, interval: "
+            << interval_ms << " ms, duration: " << duration_sec << " s";
+
+  profile_scheduler_id_ = scheduler_->Schedule(
+      scheduler_->CurrentTime() + duration_sec,
+      std::weak_ptr<JvmBreakpoint>(shared_from_this()),
+      &JvmBreakpoint::OnProfileCompleted);
+}
+
+
+void JvmBreakpoint::OnProfileCompleted() {
+  // Keep this instance alive at least until this function exits.
+  std::shared_ptr<Breakpoint> instance_holder = shared_from_this();
+
+  // The profile is reported once even if the breakpoint expires at the
+  // same time.
+  if (is_profile_completed_.exchange(true)) {
     return;
   }
 
-  std::unique_ptr<MethodCaller> method_caller =
-      evaluators_->method_caller_factory(Config::DYNAMIC_LOG);
+  stack_sampler_->Stop();
 
-  LogDataCollector collector;
+  VariableBuilder variable_builder;
+  variable_builder.set_name("profile");
+  stack_sampler_->Format(&variable_builder);
 
-  collector.Collect(
-      method_caller.get(),
-      evaluators_->object_evaluator,
-      state->watches(),
-      thread);
+  BreakpointBuilder builder(*definition_);
+  builder.clear_evaluated_expressions();
+  builder.add_evaluated_expression(variable_builder);
 
-  dynamic_logger_->Log(
-      definition_->log_level,
-      *rsl,
-      collector.Format(*definition_));
+  CompleteBreakpoint(&builder, nullptr);
 }
 
 
 bool JvmBreakpoint::EvaluateCondition(
-    const CompiledExpression& condition,
-    jthread thread) {
-  std::unique_ptr<MethodCaller> method_caller =
-      evaluators_->method_caller_factory(Config::EXPRESSION_EVALUATION);
+    const CompiledBreakpoint& state,
+    jthread thread,
+    SharedSubexpressionValues* shared_values) {
+  MethodCallerPtr method_caller;
+  if (state.condition_has_method_calls()) {
+    method_caller =
+        evaluators_->method_caller_factory(Config::EXPRESSION_EVALUATION);
+  }
 
   EvaluationContext evaluation_context;
   evaluation_context.frame_depth = 0;  // Topmost call frame.
   evaluation_context.thread = thread;
   evaluation_context.method_caller = method_caller.get();
+  evaluation_context.shared_values = shared_values;
 
+  const CompiledExpression& condition = state.condition();
   ErrorOr<JVariant> condition_result =
-      condition.evaluator->Evaluate(evaluation_context);
+      (condition.program != nullptr)
+          ? condition.program->Execute(evaluation_context)
+          : condition.evaluator->Evaluate(evaluation_context);
   if (condition_result.is_error()) {
+    BreakpointCounters::Increment(&counters_.condition_errors);
+
     if (condition_result.error_message().format == MethodNotSafe) {
       LOG(WARNING) << "Breakpoint " << id() << " calls unsafe method: "
                    << condition_result.error_message();
@@ -447,8 +1455,9 @@ bool JvmBreakpoint::EvaluateCondition(
 
   jboolean condition_result_value = false;
   if (!condition_result.value().get<jboolean>(&condition_result_value)) {
-    LOG(WARNING) << "Breakpoint condition result is not boolean, "
-                    "breakpoint ID = " << id();
+    LOG_RATE_LIMITED(WARNING) << "Breakpoint condition result is not boolean, "
+                                 "breakpoint ID = " << id();
+    BreakpointCounters::Increment(&counters_.condition_errors);
     return false;
   }
 
@@ -466,12 +1475,21 @@ void JvmBreakpoint::ApplyConditionQuota() {
     return;
   }
 
-  const int64 tokens = condition_cost_ns_.Average();
+  // The median alone would charge almost nothing for a condition that is
+  // expensive on just under half of the evaluations (e.g. one calling a
+  // method that only sometimes takes the slow path). Half of the average
+  // still bounds such conditions, while an outlier only inflates it by
+  // half as much.
+  const int64 average = condition_cost_ns_.Average();
+  const int64 tokens = FLAGS_condition_cost_use_median
+      ? std::max(condition_cost_ns_.Median(), average / 2)
+      : average;
 
   // Apply global cost limit.
   auto* global_condition_cost_limiter =
       breakpoints_manager_->GetGlobalConditionCostLimiter();
   if (!global_condition_cost_limiter->RequestTokens(tokens)) {
+    BreakpointCounters::Increment(&counters_.quota_rejections);
     LOG(WARNING) << "Cost of condition evaluations exceeded global "
                     "limit, breakpoint ID: " << id();
 
@@ -484,8 +1502,24 @@ void JvmBreakpoint::ApplyConditionQuota() {
     return;
   }
 
-  // Apply per-breakpoint cost limit.
+  // Apply per-breakpoint cost limit. If sampling is enabled, evaluate the
+  // condition less often rather than cancel the breakpoint.
+  const int sampling_interval =
+      condition_sampling_interval_.load(std::memory_order_relaxed);
   if (!breakpoint_condition_cost_limiter_->RequestTokens(tokens)) {
+    BreakpointCounters::Increment(&counters_.quota_rejections);
+
+    if (FLAGS_condition_sampling_max_interval > 1) {
+      if (!IsConditionSamplingAdjustmentDue()) {
+        return;  // Still waiting for the effect of the last adjustment.
+      }
+
+      if (sampling_interval * 2 <= FLAGS_condition_sampling_max_interval) {
+        AdjustConditionSamplingInterval(sampling_interval, true);
+        return;
+      }
+    }
+
     LOG(WARNING) << "Cost of condition evaluations exceeded per-breakpoint "
                     "limit, breakpoint ID: " << id();
 
@@ -497,13 +1531,52 @@ void JvmBreakpoint::ApplyConditionQuota() {
         .build());
     return;
   }
+
+  // The condition fits into the quota. Try evaluating it more often.
+  if ((sampling_interval > 1) && IsConditionSamplingAdjustmentDue()) {
+    AdjustConditionSamplingInterval(sampling_interval, false);
+  }
+}
+
+
+bool JvmBreakpoint::IsConditionSamplingAdjustmentDue() const {
+  return condition_sampling_timer_.GetElapsedMillis() -
+             last_condition_sampling_adjustment_ms_.load(
+                 std::memory_order_relaxed) >=
+         kConditionSamplingAdjustmentPeriodMs;
+}
+
+
+void JvmBreakpoint::AdjustConditionSamplingInterval(
+    int sampling_interval,
+    bool increase) {
+  const int new_sampling_interval =
+      increase ? sampling_interval * 2 : sampling_interval / 2;
+
+  // Multiple threads may see the same quota state. Only one of them adjusts
+  // the interval.
+  if (!condition_sampling_interval_.compare_exchange_strong(
+          sampling_interval,
+          new_sampling_interval)) {
+    return;
+  }
+
+  last_condition_sampling_adjustment_ms_.store(
+      condition_sampling_timer_.GetElapsedMillis(),
+      std::memory_order_relaxed);
+
+  LOG(INFO) << "Evaluating condition on 1 in " << new_sampling_interval
+            << " hits, breakpoint ID: " << id();
 }
 
 
 bool JvmBreakpoint::ApplyDynamicLogsQuota(
-    const ResolvedSourceLocation& source_location) {
+    const ResolvedSourceLocation& source_location,
+    int64 message_bytes) {
   LeakyBucket* global_dynamic_log_limiter =
       breakpoints_manager_->GetGlobalDynamicLogLimiter();
+  LeakyBucket* global_dynamic_log_bytes_limiter =
+      breakpoints_manager_->GetGlobalDynamicLogBytesLimiter();
 
   {
     MutexLock lock(&dynamic_log_pause_.mu);
@@ -515,8 +1588,12 @@ bool JvmBreakpoint::ApplyDynamicLogsQuota(
     }
   }
 
-  if (breakpoint_dynamic_log_limiter_->RequestTokens(1) &&
-      global_dynamic_log_limiter->RequestTokens(1)) {
+  if (OverheadGovernor::GetInstance()->IsAdmitted(
+          OverheadPriority::DynamicLog) &&
+      breakpoint_dynamic_log_limiter_->RequestTokens(1) &&
+      global_dynamic_log_limiter->RequestTokens(1) &&
+      breakpoint_dynamic_log_bytes_limiter_->RequestTokens(message_bytes) &&
+      global_dynamic_log_bytes_limiter->RequestTokens(message_bytes)) {
     MutexLock lock(&dynamic_log_pause_.mu);
     dynamic_log_pause_.is_skipping = false;
     return true;
@@ -555,51 +1632,40 @@ bool JvmBreakpoint::IsSourceLineAdjusted() const {
 }
 
 
-void JvmBreakpoint::TryActivatePendingBreakpoint() {
-  if (compiled_breakpoint_ != nullptr) {
-    return;  // The breakpoint is already active.
-  }
-
-  std::shared_ptr<ResolvedSourceLocation> rsl = resolved_location_;
-  if (rsl == nullptr) {
-    return;  // The breakpoint is still uninitialized
-  }
-
-  // Find the class in which we are going to set the breakpoint. It is
-  // possible that the class still hasn't been loaded. In this case the
-  // breakpoint will remain pending.
-  JniLocalRef cls_local_ref =
-      evaluators_->class_indexer->FindClassBySignature(rsl->class_signature);
-  if (cls_local_ref == nullptr) {
+bool JvmBreakpoint::FindBreakpointLocation(
+    const ResolvedSourceLocation& rsl,
+    JniLocalRef* cls,
+    jmethodID* method,
+    jlocation* location) {
+  *cls = evaluators_->class_indexer->FindClassBySignature(rsl.class_signature);
+  if (*cls == nullptr) {
     LOG(INFO) << "Class signature is valid, but class is not loaded yet, "
                  "leaving it as pending, breakpoint ID: " << id()
               << ", path: " << definition_->location->path
               << ", line: " << definition_->location->line;
 
-    return;
+    return false;
   }
 
-  // We are now holding reference to Java class. This guarantees that at least
-  // until this function exits, the Java method will not get unloaded.
-
   // At this point we have the Java class object and we know the method and the
   // line number to set the breakpoint.
-  jmethodID method = nullptr;
-  jlocation location = 0;
-  if (!FindMethodLine(
-        static_cast<jclass>(cls_local_ref.get()),
-        rsl->method_name,
-        rsl->adjusted_line_number,
-        &method,
-        &location)) {
+  std::shared_ptr<ClassMethodLines> method_lines =
+      breakpoints_manager_->GetClassMethodLines(
+          static_cast<jclass>(cls->get()),
+          rsl.class_signature);
+  if (!method_lines->FindMethodLine(
+        rsl.method_name,
+        rsl.adjusted_line_number,
+        method,
+        location)) {
     // This should not normally happen. If we hit this condition, it means
     // some disagreement between "ClassPathLookup.resolveSourceLocation" that
     // told us that "resolved_location_" is a valid source location, but
-    // "FindMethodLine" could not find it.
+    // "ClassMethodLines" could not find it.
     LOG(ERROR) << "Resolved source location not found"
-                  ", class signature: " << rsl->class_signature
-               << ", method: " << rsl->method_name
-               << ", adjusted line: " << rsl->adjusted_line_number;
+                  ", class signature: " << rsl.class_signature
+               << ", method: " << rsl.method_name
+               << ", adjusted line: " << rsl.adjusted_line_number;
 
     CompleteBreakpointWithStatus(StatusMessageBuilder()
         .set_error()
@@ -608,9 +1674,53 @@ void JvmBreakpoint::TryActivatePendingBreakpoint() {
         .set_description(INTERNAL_ERROR_MESSAGE)
         .build());
 
+    return false;
+  }
+
+  return true;
+}
+
+
+void JvmBreakpoint::PresetJvmtiBreakpoint(const ResolvedSourceLocation& rsl) {
+  JniLocalRef cls_local_ref;
+  jmethodID method = nullptr;
+  jlocation location = 0;
+  if (!FindBreakpointLocation(rsl, &cls_local_ref, &method, &location)) {
+    return;
+  }
+
+  // Hits are dropped silently until the breakpoint is activated.
+  is_jvmti_breakpoint_preset_ = true;
+  if (!jvmti_breakpoint_.Set(method, location, shared_from_this())) {
+    // "TryActivatePendingBreakpoint" will report the failure.
+    is_jvmti_breakpoint_preset_ = false;
+  }
+}
+
+
+void JvmBreakpoint::TryActivatePendingBreakpoint() {
+  if (compiled_breakpoint_ != nullptr) {
+    return;  // The breakpoint is already active.
+  }
+
+  std::shared_ptr<ResolvedSourceLocation> rsl = resolved_location_;
+  if (rsl == nullptr) {
+    return;  // The breakpoint is still uninitialized
+  }
+
+  // Find the class in which we are going to set the breakpoint. It is
+  // possible that the class still hasn't been loaded. In this case the
+  // breakpoint will remain pending.
+  JniLocalRef cls_local_ref;
+  jmethodID method = nullptr;
+  jlocation location = 0;
+  if (!FindBreakpointLocation(*rsl, &cls_local_ref, &method, &location)) {
     return;
   }
 
+  // We are now holding reference to Java class. This guarantees that at least
+  // until this function exits, the Java method will not get unloaded.
+
   std::shared_ptr<CompiledBreakpoint> new_state = CompileBreakpointExpressions(
       static_cast<jclass>(cls_local_ref.get()),
       method,
@@ -633,6 +1743,37 @@ void JvmBreakpoint::TryActivatePendingBreakpoint() {
     return;
   }
 
+  if ((new_state->hit_key().evaluator == nullptr) &&
+      !new_state->hit_key().error_message.format.empty()) {
+    LOG(WARNING) << "Failed to set breakpoint " << id()
+                 << " because hit key could not be compiled";
+
+    CompleteBreakpointWithStatus(StatusMessageBuilder()
+        .set_error()
+        .set_refers_to(
+            StatusMessageModel::Context::BREAKPOINT_EXPRESSION)
+        .set_description(new_state->hit_key().error_message)
+        .build());
+
+    return;
+  }
+
+  // A metric breakpoint has nothing to aggregate without its expression.
+  if ((definition_->action == BreakpointModel::Action::METRIC) &&
+      (new_state->watches()[0].evaluator == nullptr)) {
+    LOG(WARNING) << "Failed to set breakpoint " << id()
+                 << " because metric expression could not be compiled";
+
+    CompleteBreakpointWithStatus(StatusMessageBuilder()
+        .set_error()
+        .set_refers_to(
+            StatusMessageModel::Context::BREAKPOINT_EXPRESSION)
+        .set_description(new_state->watches()[0].error_message)
+        .build());
+
+    return;
+  }
+
   const bool is_source_line_adjusted = IsSourceLineAdjusted();
 
   if (is_source_line_adjusted) {
@@ -679,6 +1820,92 @@ void JvmBreakpoint::TryActivatePendingBreakpoint() {
   }
 
   compiled_breakpoint_ = new_state;
+
+  ScheduleIdleCheck();
+}
+
+
+void JvmBreakpoint::ScheduleIdleCheck() {
+  if (FLAGS_breakpoint_idle_disarm_sec <= 0) {
+    return;
+  }
+
+  MutexLock lock(&idle_disarm_.mu);
+
+  scheduler_->Cancel(idle_disarm_.scheduler_id);
+
+  idle_disarm_.hits = counters_.GetSnapshot().hits;
+  idle_disarm_.scheduler_id = scheduler_->Schedule(
+      scheduler_->CurrentTime() + FLAGS_breakpoint_idle_disarm_sec,
+      std::weak_ptr<JvmBreakpoint>(shared_from_this()),
+      &JvmBreakpoint::OnIdleCheck);
+}
+
+
+void JvmBreakpoint::OnIdleCheck() {
+  // Keep this instance alive at least until this function exits.
+  std::shared_ptr<Breakpoint> instance_holder = shared_from_this();
+
+  if (compiled_breakpoint_ == nullptr) {
+    return;  // The breakpoint is pending or completed.
+  }
+
+  int64 idle_hits;
+  {
+    MutexLock lock(&idle_disarm_.mu);
+    idle_disarm_.scheduler_id = Scheduler<>::NullId;
+    idle_hits = idle_disarm_.hits;
+  }
+
+  if (counters_.GetSnapshot().hits != idle_hits) {
+    ScheduleIdleCheck();
+    return;
+  }
+
+  if (!jvmti_breakpoint_.Disarm(shared_from_this())) {
+    return;
+  }
+
+  LOG(INFO) << "Breakpoint " << id() << " was not hit in "
+            << FLAGS_breakpoint_idle_disarm_sec << " seconds, disarming it "
+            << "for " << FLAGS_breakpoint_disarm_period_sec << " seconds";
+
+  MutexLock lock(&idle_disarm_.mu);
+  idle_disarm_.scheduler_id = scheduler_->Schedule(
+      scheduler_->CurrentTime() +
+          std::max(1, FLAGS_breakpoint_disarm_period_sec),
+      std::weak_ptr<JvmBreakpoint>(shared_from_this()),
+      &JvmBreakpoint::OnRearm);
+}
+
+
+void JvmBreakpoint::OnRearm() {
+  // Keep this instance alive at least until this function exits.
+  std::shared_ptr<Breakpoint> instance_holder = shared_from_this();
+
+  {
+    MutexLock lock(&idle_disarm_.mu);
+    idle_disarm_.scheduler_id = Scheduler<>::NullId;
+  }
+
+  if (!jvmti_breakpoint_.Rearm(shared_from_this())) {
+    LOG(ERROR) << "Failed to rearm JVMTI breakpoint " << id();
+
+    BreakpointBuilder builder(*definition_);
+    builder.set_status(StatusMessageBuilder()
+        .set_error()
+        .set_description(INTERNAL_ERROR_MESSAGE));
+
+    CompleteBreakpoint(&builder, nullptr);
+
+    return;
+  }
+
+  // The breakpoint might have been reset to pending in the meantime.
+  if (compiled_breakpoint_ != nullptr) {
+    LOG(INFO) << "Breakpoint " << id() << " rearmed";
+    ScheduleIdleCheck();
+  }
 }
 
 
@@ -686,37 +1913,163 @@ std::shared_ptr<CompiledBreakpoint> JvmBreakpoint::CompileBreakpointExpressions(
     jclass cls,
     jmethodID method,
     jlocation location) const {
+  const string key = GetCompilationKey();
+
+  std::shared_ptr<CompiledBreakpoint> cached_state =
+      evaluators_->compiled_breakpoint_cache->Find(method, location, key);
+  if (cached_state != nullptr) {
+    return cached_state;
+  }
+
   JvmReadersFactory readers_factory(
       evaluators_,
       method,
       location);
 
+  // Find the method calls repeated in the condition and watched expressions.
+  SharedSubexpressions shared_subexpressions;
+  shared_subexpressions.Add(definition_->condition);
+  for (const string& watch : definition_->expressions) {
+    shared_subexpressions.Add(watch);
+  }
+
   // Compile breakpoint condition (if present).
-  CompiledExpression condition = CompileCondition(&readers_factory);
+  CompiledExpression condition =
+      CompileCondition(&readers_factory, &shared_subexpressions);
 
   // Compile watched expressions.
   std::vector<CompiledExpression> watches;
   for (const string& watch : definition_->expressions) {
-    watches.push_back(CompileExpression(watch, &readers_factory));
+    watches.push_back(
+        CompileExpression(watch, &readers_factory, &shared_subexpressions));
   }
 
-  return std::make_shared<CompiledBreakpoint>(
-      cls,
-      method,
-      location,
-      std::move(condition),
-      std::move(watches));
+  // Parse the log message format once rather than on every hit.
+  std::shared_ptr<const MessageTemplate> log_message_template;
+  if (definition_->action == BreakpointModel::Action::LOG) {
+    log_message_template = std::make_shared<MessageTemplate>(
+        definition_->log_message_format);
+  }
+
+  std::shared_ptr<CompiledBreakpoint> state =
+      std::make_shared<CompiledBreakpoint>(
+          cls,
+          method,
+          location,
+          std::move(condition),
+          std::move(watches),
+          std::move(log_message_template),
+          CompileHitKey(&readers_factory),
+          shared_subexpressions.size());
+
+  // Compilation errors may go away once more classes are loaded (e.g. an
+  // expression referencing a class that is not loaded yet), so only fully
+  // compiled breakpoints are cached.
+  if ((definition_->condition.empty() ||
+       (state->condition().evaluator != nullptr)) &&
+      !state->HasBadWatchedExpression() &&
+      state->hit_key().error_message.format.empty()) {
+    evaluators_->compiled_breakpoint_cache->Insert(
+        method,
+        location,
+        key,
+        state);
+  }
+
+  return state;
 }
 
 
-CompiledExpression JvmBreakpoint::CompileCondition(
+string JvmBreakpoint::GetCompilationKey() const {
+  // Each part is prefixed by its length, so that different definitions can't
+  // produce the same key. The capture profile is not part of the key, so
+  // that follow-up captures of a tiered snapshot skip the compilation.
+  string key;
+  auto append = [&key] (const string& part) {
+    key += std::to_string(part.size());
+    key += ':';
+    key += part;
+  };
+
+  append(std::to_string(static_cast<int>(definition_->action)));
+  append(definition_->condition);
+  append(std::to_string(definition_->expressions.size()));
+  for (const string& expression : definition_->expressions) {
+    append(expression);
+  }
+
+  if (definition_->action == BreakpointModel::Action::LOG) {
+    append(definition_->log_message_format);
+    if (log_sampling_rate_ > 1) {
+      append(GetBreakpointLabel(*definition_, kLogSamplingKeyLabel));
+    }
+  }
+
+  if (definition_->action == BreakpointModel::Action::DURATION) {
+    append(GetBreakpointLabel(*definition_, kDurationKeyLabel));
+  }
+
+  return key;
+}
+
+
+CompiledExpression JvmBreakpoint::CompileHitKey(
     ReadersFactory* readers_factory) const {
+  const char* label = nullptr;
+  const char* not_supported_message = nullptr;
+  if (definition_->action == BreakpointModel::Action::DURATION) {
+    label = kDurationKeyLabel;
+    not_supported_message = DurationKeyNotSupported;
+  } else if ((definition_->action == BreakpointModel::Action::LOG) &&
+             (log_sampling_rate_ > 1)) {
+    // The key only matters if some of the hits are skipped.
+    label = kLogSamplingKeyLabel;
+    not_supported_message = LogSamplingKeyNotSupported;
+  } else {
+    return CompiledExpression();
+  }
+
+  const string expression = GetBreakpointLabel(*definition_, label);
+  if (expression.empty()) {
+    return CompiledExpression();
+  }
+
+  CompiledExpression key = CompileExpression(expression, readers_factory);
+  if (key.evaluator == nullptr) {
+    LOG(WARNING) << "Hit key could not be compiled, "
+                    "expression: " << expression
+                 << ", error message: " << key.error_message;
+    return key;
+  }
+
+  // Hashing objects (like strings) or calling methods would take JNI calls
+  // on every hit, including the ones that end up not being logged.
+  const JType key_type = key.evaluator->GetStaticType().type;
+  if ((key_type == JType::Object) ||
+      (key_type == JType::Void) ||
+      key.evaluator->HasMethodCalls()) {
+    CompiledExpression result;
+    result.error_message = { not_supported_message, {} };
+    result.expression = expression;
+
+    return result;
+  }
+
+  return key;
+}
+
+
+CompiledExpression JvmBreakpoint::CompileCondition(
+    ReadersFactory* readers_factory,
+    SharedSubexpressions* shared_subexpressions) const {
   if (definition_->condition.empty()) {
     return CompiledExpression();
   }
 
-  CompiledExpression condition =
-      CompileExpression(definition_->condition, readers_factory);
+  CompiledExpression condition = CompileExpression(
+      definition_->condition,
+      readers_factory,
+      shared_subexpressions);
 
   if (condition.evaluator == nullptr) {
     LOG(WARNING) << "Breakpoint condition could not be compiled, "
@@ -743,6 +2096,15 @@ CompiledExpression JvmBreakpoint::CompileCondition(
     return result;
   }
 
+  if (FLAGS_enable_condition_program) {
+    condition.program = ExpressionProgram::Build(*condition.evaluator);
+    if (condition.program == nullptr) {
+      VLOG(1) << "Breakpoint condition can't be converted to a program, "
+                 "falling back to the expression tree, condition: "
+              << definition_->condition;
+    }
+  }
+
   return condition;
 }
 
@@ -758,9 +2120,22 @@ void JvmBreakpoint::CompleteBreakpointWithStatus(
 
 void JvmBreakpoint::CompleteBreakpoint(
     BreakpointBuilder* builder,
-    std::unique_ptr<CaptureDataCollector> collector) {
+    std::shared_ptr<CaptureDataCollector> collector) {
   builder->set_is_final_state(true);
-  format_queue_->Enqueue(builder->build(), std::move(collector));
+
+  // Let the user know that the snapshot can be taken again with more data.
+  if ((collector != nullptr) &&
+      (definition_->capture_profile ==
+       BreakpointModel::CaptureProfile::TIERED)) {
+    builder->set_status(StatusMessageBuilder()
+        .set_info()
+        .set_format(SnapshotFirstTierCaptured)
+        .build());
+  }
+
+  if (!format_queue_->Enqueue(builder->build(), std::move(collector))) {
+    BreakpointCounters::Increment(&counters_.drops);
+  }
 
   breakpoints_manager_->CompleteBreakpoint(id());
 
@@ -805,16 +2180,47 @@ void JvmBreakpoint::OnBreakpointExpired() {
   // Keep this instance alive at least until this function exits.
   std::shared_ptr<Breakpoint> instance_holder = shared_from_this();
 
+  // Report the hits of a multi-hit breakpoint captured so far instead of
+  // the expiration.
+  if (capture_hits_ > 1) {
+    std::vector<std::shared_ptr<CaptureDataCollector>> hits;
+    if (CloseCaptureWindow(&hits)) {
+      if (!hits.empty()) {
+        CompleteMultiHitCapture(std::move(hits));
+      }
+
+      return;
+    }
+  }
+
+  // Report the samples taken so far.
+  if (stack_sampler_ != nullptr) {
+    OnProfileCompleted();
+    return;
+  }
+
   LOG(INFO) << "Completing expired breakpoint " << id();
 
   ResetToPending();
 
-  CompleteBreakpointWithStatus(StatusMessageBuilder()
+  BreakpointBuilder builder(*definition_);
+  builder.set_status(StatusMessageBuilder()
       .set_error()
       .set_refers_to(
           StatusMessageModel::Context::UNSPECIFIED)
-      .set_format(BreakpointExpired)
-      .build());
+      .set_format(BreakpointExpired));
+
+  // Report the aggregate collected since the last metric update.
+  if ((metric_aggregator_ != nullptr) && !GetMetricName().empty()) {
+    VariableBuilder variable_builder;
+    variable_builder.set_name(GetMetricName());
+    metric_aggregator_->Format(&variable_builder);
+
+    builder.clear_evaluated_expressions();
+    builder.add_evaluated_expression(variable_builder);
+  }
+
+  CompleteBreakpoint(&builder, nullptr);
 }
 
 }  // namespace cdbg
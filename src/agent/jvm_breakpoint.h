@@ -17,13 +17,18 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_JVM_BREAKPOINT_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_JVM_BREAKPOINT_H_
 
+#include <atomic>
 #include <memory>
+#include <vector>
 #include "leaky_bucket.h"
 #include "auto_jvmti_breakpoint.h"
 #include "breakpoint.h"
+#include "breakpoint_counters.h"
 #include "common.h"
 #include "expression_util.h"
+#include "hit_filter.h"
 #include "jni_utils.h"
+#include "message_template.h"
 #include "rate_limit.h"
 #include "scheduler.h"
 #include "stopwatch.h"
@@ -32,12 +37,17 @@ namespace devtools {
 namespace cdbg {
 
 class BreakpointBuilder;
+class BreakpointGroup;
 class BreakpointsManager;
 class CaptureDataCollector;
 class DynamicLogger;
+class DynamicLogQueue;
 class FormatQueue;
 class JvmEvaluators;
+class MetricAggregator;
 class ResolvedSourceLocation;
+class SharedSubexpressionValues;
+class StackSampler;
 
 // Immutable state of a compiled breakpoint.
 //
@@ -58,7 +68,10 @@ class CompiledBreakpoint {
       const jmethodID method,
       const jlocation location,
       CompiledExpression condition,
-      std::vector<CompiledExpression> watches);
+      std::vector<CompiledExpression> watches,
+      std::shared_ptr<const MessageTemplate> log_message_template,
+      CompiledExpression hit_key,
+      int shared_subexpressions_count);
 
   ~CompiledBreakpoint();
 
@@ -68,8 +81,35 @@ class CompiledBreakpoint {
 
   const CompiledExpression& condition() const { return condition_; }
 
+  // True if evaluation of the breakpoint condition might call Java methods.
+  // Conditions that don't call methods are evaluated without "MethodCaller".
+  bool condition_has_method_calls() const {
+    return condition_has_method_calls_;
+  }
+
   const std::vector<CompiledExpression>& watches() const { return watches_; }
 
+  // Compiled log message format of a dynamic log breakpoint or nullptr for
+  // snapshot breakpoints.
+  const std::shared_ptr<const MessageTemplate>& log_message_template() const {
+    return log_message_template_;
+  }
+
+  // Compiled expression whose value identifies a hit: it decides which hits
+  // of a sampled log point are logged and it pairs the end hits of a
+  // duration probe with the start hits. The evaluator is null if the
+  // breakpoint doesn't have a key.
+  const CompiledExpression& hit_key() const {
+    return hit_key_;
+  }
+
+  // Number of method calls shared by the condition and the watched
+  // expressions (see "SharedSubexpressions"). Each breakpoint hit keeps
+  // their values in "SharedSubexpressionValues" of this size.
+  int shared_subexpressions_count() const {
+    return shared_subexpressions_count_;
+  }
+
   // Checks whether "JvmBreakpoint" has any expressions that could not be
   // parsed or compiled.
   bool HasBadWatchedExpression() const;
@@ -87,6 +127,9 @@ class CompiledBreakpoint {
   // Compiled breakpoint condition or null if the breakpoint is unconditional.
   CompiledExpression condition_;
 
+  // Cached result of "HasMethodCalls" on the compiled condition.
+  const bool condition_has_method_calls_;
+
   // List of watched expressions to evaluate upon breakpoint hit. Elements
   // corresponding to watched expressions that could not be compiled will be
   // nullptr. They are not skipped to maintain proper indexes (since indexes
@@ -94,6 +137,16 @@ class CompiledBreakpoint {
   // definition).
   std::vector<CompiledExpression> watches_;
 
+  // Compiled log message format. Shared with the pending dynamic log
+  // entries, which are formatted after the breakpoint hit.
+  const std::shared_ptr<const MessageTemplate> log_message_template_;
+
+  // Compiled hit key (see "hit_key()").
+  CompiledExpression hit_key_;
+
+  // See "shared_subexpressions_count()".
+  const int shared_subexpressions_count_;
+
   DISALLOW_COPY_AND_ASSIGN(CompiledBreakpoint);
 };
 
@@ -101,13 +154,14 @@ class CompiledBreakpoint {
 class JvmBreakpoint : public Breakpoint,
                       public std::enable_shared_from_this<JvmBreakpoint> {
  public:
-  // All arguments except of "breakpoint_definition" are not owned by this
-  // class and must outlive it.
+  // All arguments except of "dynamic_logger" and "breakpoint_definition" are
+  // not owned by this class and must outlive it.
   JvmBreakpoint(
       Scheduler<>* scheduler,
       JvmEvaluators* evaluators,
       FormatQueue* format_queue,
-      DynamicLogger* dynamic_logger,
+      DynamicLogQueue* dynamic_log_queue,
+      std::shared_ptr<DynamicLogger> dynamic_logger,
       BreakpointsManager* breakpoints_manager,
       std::unique_ptr<BreakpointModel> breakpoint_definition);
 
@@ -117,20 +171,29 @@ class JvmBreakpoint : public Breakpoint,
 
   void Initialize() override;
 
+  string GetClassSignature() const override;
+
   void ResetToPending() override;
 
   void OnClassPrepared(
       const string& type_name,
       const string& class_signature) override;
 
+  void ActivatePending() override;
+
   void OnJvmBreakpointHit(
       jthread thread,
       jmethodID method,
-      jlocation location) override;
+      jlocation location,
+      SharedCapture* shared_capture) override;
 
   void CompleteBreakpointWithStatus(
       std::unique_ptr<StatusMessageModel> status) override;
 
+  BreakpointCounters::Snapshot GetCounters() const override {
+    return counters_.GetSnapshot();
+  }
+
  private:
   // Checks whether the resolve location points to a different source line
   // than the one specified in the breakpoint. This will happen when a
@@ -145,48 +208,169 @@ class JvmBreakpoint : public Breakpoint,
   // If the code hasn't been loaded yet, the breakpoint stays pending.
   void TryActivatePendingBreakpoint();
 
+  // Finds the class, method and location of the breakpoint. Returns false if
+  // the class is not loaded yet (the breakpoint stays pending) or if the
+  // location could not be found (the breakpoint is completed).
+  bool FindBreakpointLocation(
+      const ResolvedSourceLocation& rsl,
+      JniLocalRef* cls,
+      jmethodID* method,
+      jlocation* location);
+
+  // Sets the JVMTI breakpoint before the breakpoint is activated, so that
+  // the breakpoint location is covered while the activation waits for the
+  // agent thread (see "FLAGS_cdbg_preset_jvmti_breakpoint").
+  void PresetJvmtiBreakpoint(const ResolvedSourceLocation& rsl);
+
   // Parses and compiles breakpoint expressions (if any) within the context
   // of a breakpoint location. The result is returned as "CompiledBreakpoint".
+  // Reuses the compiled state of an earlier breakpoint with the same
+  // expressions at the same location if it's still in the cache.
   std::shared_ptr<CompiledBreakpoint> CompileBreakpointExpressions(
       jclass cls,
       jmethodID method,
       jlocation location) const;
 
+  // Builds the key of the compiled breakpoint in "CompiledBreakpointCache".
+  // The key covers everything in the breakpoint definition that
+  // "CompileBreakpointExpressions" depends on.
+  string GetCompilationKey() const;
+
+  // Compiles the hit key (if the breakpoint has one) and verifies that its
+  // value can be read without calling Java methods. Returns
+  // "CompiledExpression" with error message in case of error.
+  CompiledExpression CompileHitKey(
+      ReadersFactory* readers_factory) const;
+
   // Compiles breakpoint condition (if the breakpoint has condition at all) and
   // verifies the proper return type. Returns "CompiledExpression" with error
   // message in case of error.
-  CompiledExpression CompileCondition(ReadersFactory* readers_factory) const;
+  CompiledExpression CompileCondition(
+      ReadersFactory* readers_factory,
+      SharedSubexpressions* shared_subexpressions) const;
 
   // Evaluates the breakpoint condition. Returns true if breakpoint condition
   // matched. Completes breakpoint if the conditional expression turns out
-  // to be mutable.
+  // to be mutable. "MethodCaller" is only created if the condition calls
+  // methods, so that the common case of conditions over fields, local
+  // variables and constants doesn't pay for it on every breakpoint hit.
   bool EvaluateCondition(
-      const CompiledExpression& condition,
-      jthread thread);
+      const CompiledBreakpoint& state,
+      jthread thread,
+      SharedSubexpressionValues* shared_values);
 
   // Subtracts the condition evaluation time from the quota and completes the
   // breakpoint if limit was reached. "condition_cost_ns_" stores the last
-  // condition evaluation duration (smoothed with sliding average filter).
+  // condition evaluation durations (smoothed with sliding average or median
+  // filter).
   void ApplyConditionQuota();
 
-  // Takes one token for a dynamic log statement from the quota. Returns true
-  // if the quota allows issuing a log entry. Returns false if the debugger
-  // already produced too many logs. In such cases the caller should abandon
-  // the log entry. Once the quota replenishes, future hits on this breakpoint
-  // will be able to proceed.
-  bool ApplyDynamicLogsQuota(const ResolvedSourceLocation& source_location);
+  // Checks whether enough time passed since the condition sampling interval
+  // was last changed to change it again.
+  bool IsConditionSamplingAdjustmentDue() const;
+
+  // Doubles ("increase" is true) or halves the condition sampling interval
+  // unless another thread changed it from "sampling_interval" already.
+  void AdjustConditionSamplingInterval(int sampling_interval, bool increase);
+
+  // Takes one token for a dynamic log statement and "message_bytes" tokens
+  // for its size from the quota. Returns true if the quota allows issuing a
+  // log entry. Returns false if the debugger already produced too many logs.
+  // In such cases the caller should abandon the log entry. Once the quota
+  // replenishes, future hits on this breakpoint will be able to proceed.
+  bool ApplyDynamicLogsQuota(
+      const ResolvedSourceLocation& source_location,
+      int64 message_bytes);
 
   // Captures the application state for data capturing breakpoints on
-  // breakpoint hit.
-  void DoCaptureAction(jthread thread, CompiledBreakpoint* state);
+  // breakpoint hit. If "shared_capture" is not nullptr, enlists the
+  // breakpoint there and completes it once the shared capture is collected.
+  // "shared_values" (if not null) has the method calls already evaluated by
+  // the condition.
+  void DoCaptureAction(
+      jthread thread,
+      std::shared_ptr<CompiledBreakpoint> state,
+      SharedCapture* shared_capture,
+      std::shared_ptr<SharedSubexpressionValues> shared_values);
+
+  // Captures a hit of a multi-hit snapshot breakpoint (see
+  // "kCaptureHitsLabel"). The first hit is captured with the capture profile
+  // of the breakpoint. The following hits only report the differences from
+  // the first one, so they are captured with the minimal profile. The
+  // breakpoint is completed once the last hit is collected.
+  void DoMultiHitCaptureAction(
+      jthread thread,
+      const CompiledBreakpoint& state,
+      SharedSubexpressionValues* shared_values);
+
+  // Stops taking hits of a multi-hit snapshot breakpoint. Returns false if
+  // no hit has been captured yet. Otherwise moves the captured hits to
+  // "hits" unless some hit is still being collected (then the thread
+  // collecting it completes the breakpoint).
+  bool CloseCaptureWindow(
+      std::vector<std::shared_ptr<CaptureDataCollector>>* hits);
+
+  // Sends the final breakpoint update with the captured hits of a multi-hit
+  // snapshot breakpoint. "hits" is indexed by hit number - 1.
+  void CompleteMultiHitCapture(
+      std::vector<std::shared_ptr<CaptureDataCollector>> hits);
+
+  // Callback invoked "capture_hits_window_sec" seconds after the first hit
+  // of a multi-hit snapshot breakpoint. Completes the breakpoint with the
+  // hits captured so far.
+  void OnCaptureWindowClosed();
+
+  // Decides whether this hit of a sampled log point should be logged. The
+  // decision is made before any data is collected and doesn't call JNI.
+  bool IsLogHitSampled(const CompiledBreakpoint& state, jthread thread);
 
   // Issues a dynamic log on breakpoint hit.
-  void DoLogAction(jthread thread, CompiledBreakpoint* state);
+  void DoLogAction(
+      jthread thread,
+      CompiledBreakpoint* state,
+      SharedSubexpressionValues* shared_values);
+
+  // Evaluates the metric expression on breakpoint hit and adds its value to
+  // "metric_aggregator_".
+  void DoMetricAction(
+      jthread thread,
+      CompiledBreakpoint* state,
+      SharedSubexpressionValues* shared_values);
+
+  // Checks whether "metric_breakpoint_update_interval_sec" passed since the
+  // last metric update. Only one of the concurrent callers gets true.
+  bool IsMetricUpdateDue();
+
+  // Sends interim breakpoint update with the current metric aggregate.
+  void SendMetricUpdate();
+
+  // Gets the name under which the metric aggregate is reported.
+  string GetMetricName() const;
+
+  // Evaluates the hit key and converts its value to bits. Returns false if
+  // the value could not be computed.
+  bool EvaluateHitKey(
+      const CompiledBreakpoint& state,
+      jthread thread,
+      uint64* key_bits);
+
+  // Records the start time of a duration probe in the current thread or
+  // aggregates the time elapsed since then.
+  void DoDurationAction(jthread thread, const CompiledBreakpoint& state);
+
+  // Starts sampling the call stacks of a profile breakpoint (configured by
+  // breakpoint labels, see "kProfileIntervalLabel") and schedules its
+  // completion.
+  void StartProfile();
+
+  // Callback invoked when the sampling time of a profile breakpoint is up.
+  // Completes the breakpoint with the aggregated call stacks.
+  void OnProfileCompleted();
 
   // Sends a final breakpoint update and completes the breakpoint.
   void CompleteBreakpoint(
       BreakpointBuilder* builder,
-      std::unique_ptr<CaptureDataCollector> collector);
+      std::shared_ptr<CaptureDataCollector> collector);
 
   // Sends interim breakpoint update to indicate that some watched expressions
   // could not be parsed or compiled.
@@ -196,6 +380,20 @@ class JvmBreakpoint : public Breakpoint,
   // has been created. This callback signals that the breakpoint has expired.
   void OnBreakpointExpired();
 
+  // Schedules "OnIdleCheck" in "breakpoint_idle_disarm_sec" seconds (if
+  // enabled) and takes note of the current number of hits.
+  void ScheduleIdleCheck();
+
+  // Disarms the JVMTI breakpoint of an active breakpoint that wasn't hit
+  // since "ScheduleIdleCheck". A JVMTI breakpoint keeps the method in the
+  // interpreter, so an idle breakpoint in a hot method slows it down for
+  // nothing. Schedules "OnRearm" in "breakpoint_disarm_period_sec" seconds.
+  void OnIdleCheck();
+
+  // Sets the disarmed JVMTI breakpoint again and schedules the next idle
+  // check.
+  void OnRearm();
+
  private:
   // Schedules callbacks at a future time. Used to expire breakpoints.
   // Not owned by this class.
@@ -212,9 +410,13 @@ class JvmBreakpoint : public Breakpoint,
   // Not owned by this class.
   FormatQueue* const format_queue_;
 
-  // Application logger to inject dynamically generated log statements.
+  // Dynamic log entries that wait to be written by the worker thread.
   // Not owned by this class.
-  DynamicLogger* const dynamic_logger_;
+  DynamicLogQueue* const dynamic_log_queue_;
+
+  // Application logger to inject dynamically generated log statements.
+  // Shared with the pending entries in "dynamic_log_queue_".
+  const std::shared_ptr<DynamicLogger> dynamic_logger_;
 
   // Multiplexer of JVMTI breakpoints.
   // Not owned by this class.
@@ -224,9 +426,19 @@ class JvmBreakpoint : public Breakpoint,
   // keep the hit results, it is very small and copying it is not a big deal.
   std::unique_ptr<const BreakpointModel> definition_;
 
+  // Counts what happened to the hits of this breakpoint.
+  BreakpointCounters counters_;
+
+  // Hit count and thread predicates checked before the condition.
+  HitFilter hit_filter_;
+
   // Manages calls to "SetJvmtiBreakpoint" and "ClearJvmtiBreakpoint"
   AutoJvmtiBreakpoint jvmti_breakpoint_;
 
+  // Set while the JVMTI breakpoint is set ahead of the activation. Hits of
+  // a pending breakpoint are expected then and are dropped silently.
+  std::atomic<bool> is_jvmti_breakpoint_preset_ { false };
+
   // Cancellation token for scheduled expiration callback.
   Scheduler<>::Id scheduler_id_ { Scheduler<>::NullId };
 
@@ -234,13 +446,119 @@ class JvmBreakpoint : public Breakpoint,
   // eliminates spikes due to garbage collector.
   MovingAverage condition_cost_ns_;
 
-  // Per breakpoint limit of the cost of condition checks.
-  std::unique_ptr<LeakyBucket> breakpoint_condition_cost_limiter_;
+  // Per breakpoint limit of the cost of condition checks. Shared by all the
+  // breakpoints in "group_".
+  std::shared_ptr<LeakyBucket> breakpoint_condition_cost_limiter_;
+
+  // The condition is only evaluated on 1 in "condition_sampling_interval_"
+  // breakpoint hits. The interval is a power of 2. It starts at 1 and
+  // adapts to keep condition evaluations within the per-breakpoint cost
+  // limit (see "FLAGS_condition_sampling_max_interval").
+  std::atomic<int> condition_sampling_interval_ { 1 };
+
+  // Time of the last change of "condition_sampling_interval_" measured by
+  // "condition_sampling_timer_".
+  std::atomic<int64> last_condition_sampling_adjustment_ms_ { 0 };
+  const Stopwatch condition_sampling_timer_;
 
   // Per breakpoint limit of dynamic logs. Only initialized for dynamic log
   // breakpoints.
   std::unique_ptr<LeakyBucket> breakpoint_dynamic_log_limiter_;
 
+  // Per breakpoint limit of the size of dynamic logs. Only initialized for
+  // dynamic log breakpoints.
+  std::unique_ptr<LeakyBucket> breakpoint_dynamic_log_bytes_limiter_;
+
+  // Size of the last message formatted by this breakpoint (0 until there
+  // is one). The message size is only known after the message is formatted,
+  // which might happen in the dynamic log thread. Since messages of a log
+  // point are typically of similar size, the quota of a log statement is
+  // charged by the size of the previous one. Shared with the pending entries
+  // in "dynamic_log_queue_". Only initialized for dynamic log breakpoints.
+  std::shared_ptr<std::atomic<int64>> log_message_size_;
+
+  // Aggregate of the metric expression values. Only initialized for metric
+  // breakpoints.
+  std::unique_ptr<MetricAggregator> metric_aggregator_;
+
+  // Samples the call stacks of all the threads. Only initialized for
+  // profile breakpoints.
+  std::unique_ptr<StackSampler> stack_sampler_;
+
+  // Scheduled completion of a profile breakpoint.
+  Scheduler<>::Id profile_scheduler_id_ { Scheduler<>::NullId };
+
+  // Set once the profile has been reported.
+  std::atomic<bool> is_profile_completed_ { false };
+
+  // Time of the last metric update measured by "metric_update_timer_".
+  std::atomic<int64> last_metric_update_ms_ { 0 };
+  const Stopwatch metric_update_timer_;
+
+  // Only 1 in "log_sampling_rate_" hits of a dynamic log breakpoint are
+  // logged. Set from breakpoint labels (see "kLogSamplingRateLabel").
+  int log_sampling_rate_ { 1 };
+
+  // Counts the hits of a log point sampled without a key.
+  std::atomic<uint64> log_sampling_counter_ { 0 };
+
+  // Hash of the duration probe name of a duration breakpoint (see
+  // "kDurationStartLabel") and whether the breakpoint ends the measured
+  // code region rather than starts it.
+  uint64 duration_probe_ { 0 };
+  bool is_duration_end_ { false };
+
+  // Number of hits a snapshot breakpoint captures before it completes. Set
+  // from breakpoint labels (see "kCaptureHitsLabel").
+  int capture_hits_ { 1 };
+
+  // Group of breakpoints this breakpoint belongs to or nullptr if none (see
+  // "kBreakpointGroupLabel").
+  std::shared_ptr<BreakpointGroup> group_;
+
+  // Set if a snapshot breakpoint also reports the call stacks of other
+  // threads (see "kThreadDumpLabel"). "thread_dump_prefix_" is the prefix
+  // of the names of the reported threads (empty for all threads).
+  bool is_thread_dump_ { false };
+  string thread_dump_prefix_;
+
+  // Hits captured by a multi-hit snapshot breakpoint.
+  struct {
+    // Locks access to members of this struct.
+    Mutex mu;
+
+    // Captured hits indexed by hit number - 1. Sized to "capture_hits_".
+    std::vector<std::shared_ptr<CaptureDataCollector>> hits;
+
+    // Number of hits taken so far.
+    int hits_count { 0 };
+
+    // Number of hits taken, but not collected yet.
+    int collecting_count { 0 };
+
+    // Set once the last hit was taken or the capture window closed. No more
+    // hits are taken afterwards.
+    bool is_closed { false };
+
+    // Set once the captured hits were handed over for formatting.
+    bool is_completed { false };
+
+    // Cancellation token for the callback closing the capture window.
+    Scheduler<>::Id window_scheduler_id { Scheduler<>::NullId };
+  } multi_hit_capture_;
+
+  // Disarming of idle breakpoints (see "OnIdleCheck").
+  struct {
+    // Locks access to members of this struct.
+    Mutex mu;
+
+    // Number of hits at the time the idle check was scheduled.
+    int64 hits { 0 };
+
+    // Cancellation token for the scheduled "OnIdleCheck" or "OnRearm".
+    Scheduler<>::Id scheduler_id { Scheduler<>::NullId };
+  } idle_disarm_;
+
   // Manages the pause in logger when quota is exceeded.
   struct {
     // Locks access to members of this struct.
@@ -17,32 +17,48 @@
 #include "jvm_breakpoints_manager.h"
 
 #include <algorithm>
+#include "breakpoint_group.h"
 #include "callbacks_monitor.h"
+#include "class_method_lines.h"
 #include "format_queue.h"
+#include "hot_path_counters.h"
+#include "log_rate_limiter.h"
 #include "breakpoint.h"
 #include "jvm_evaluators.h"
+#include "method_unload_filter.h"
+#include "model_util.h"
 #include "rate_limit.h"
+#include "shared_capture.h"
 #include "statistician.h"
 #include "stopwatch.h"
+#include "trace_recorder.h"
 
 namespace devtools {
 namespace cdbg {
 
+// Maximum number of classes in "class_method_lines_". Only classes in which
+// breakpoints were set are cached, so the limit is rarely reached.
+constexpr int kMaxClassMethodLines = 1024;
+
 JvmBreakpointsManager::JvmBreakpointsManager(
     std::function<std::shared_ptr<Breakpoint>(
         BreakpointsManager*,
         std::unique_ptr<BreakpointModel>)> breakpoint_factory,
     JvmEvaluators* evaluators,
     FormatQueue* format_queue,
-    CanaryControl* canary_control)
+    CanaryControl* canary_control,
+    std::function<bool()> request_breakpoints_activation /* = nullptr */)
     : breakpoint_factory_(breakpoint_factory),
       evaluators_(evaluators),
       format_queue_(format_queue),
       canary_control_(canary_control),
+      request_breakpoints_activation_(request_breakpoints_activation),
       global_condition_cost_limiter_(
-          CreateGlobalCostLimiter(CostLimitType::BreakpointCondition)),
+          CreateShardedGlobalCostLimiter(CostLimitType::BreakpointCondition)),
       global_dynamic_log_limiter_(
-          CreateGlobalCostLimiter(CostLimitType::DynamicLog)) {
+          CreateGlobalCostLimiter(CostLimitType::DynamicLog)),
+      global_dynamic_log_bytes_limiter_(
+          CreateGlobalCostLimiter(CostLimitType::DynamicLogBytes)) {
   on_class_prepared_cookie_ =
       evaluators_->class_indexer->SubscribeOnClassPreparedEvents(
           std::bind(
@@ -50,10 +66,19 @@ JvmBreakpointsManager::JvmBreakpointsManager(
               this,
               std::placeholders::_1,
               std::placeholders::_2));
+  on_classes_prepared_cookie_ =
+      evaluators_->class_indexer->SubscribeOnClassesPreparedEvents(
+          std::bind(
+              &JvmBreakpointsManager::OnClassesPrepared,
+              this,
+              std::placeholders::_1));
 }
 
 
 JvmBreakpointsManager::~JvmBreakpointsManager() {
+  for (const auto& method_entry : method_map_) {
+    MethodUnloadFilter::Remove(method_entry.first);
+  }
 }
 
 
@@ -71,6 +96,8 @@ void JvmBreakpointsManager::Cleanup() {
 
   evaluators_->class_indexer->UnsubscribeOnClassPreparedEvents(
       std::move(on_class_prepared_cookie_));
+  evaluators_->class_indexer->UnsubscribeOnClassesPreparedEvents(
+      std::move(on_classes_prepared_cookie_));
 
   format_queue_->RemoveAll();
 }
@@ -83,9 +110,15 @@ void JvmBreakpointsManager::SetActiveBreakpointsList(
   // Serialize simultaneous calls to "SetActiveBreakpointsList".
   MutexLock lock_set_active_breakpoints_list(&mu_set_active_breakpoints_list_);
 
-  std::map<string, std::shared_ptr<Breakpoint>> updated_active_breakpoints;
-  std::set<string> updated_completed_breakpoints;
+  std::unordered_map<string, std::shared_ptr<Breakpoint>>
+      updated_active_breakpoints(breakpoints.size());
+  std::unordered_set<string> updated_completed_breakpoints;
   std::vector<std::unique_ptr<BreakpointModel>> new_breakpoints;
+  std::vector<std::shared_ptr<Breakpoint>> removed_breakpoints;
+
+  // Canary breakpoints that failed registration before are retried if they
+  // are still listed.
+  rejected_canary_breakpoints_.clear();
 
   // Identify deleted and new breakpoints.
   {
@@ -117,67 +150,291 @@ void JvmBreakpointsManager::SetActiveBreakpointsList(
 
     active_breakpoints_.swap(updated_active_breakpoints);
 
+    // Breakpoints that are not listed any more.
+    for (auto& breakpoint : updated_active_breakpoints) {
+      if (breakpoint.second != nullptr) {
+        removed_breakpoints.push_back(std::move(breakpoint.second));
+      }
+    }
+
     // Remove entries from completed_breakpoints_ that weren't listed in
     // "breakpoints" array. These are confirmed to have been removed by the hub
     // and the debuglet can now assume that they will never show up ever again.
     completed_breakpoints_.swap(updated_completed_breakpoints);
   }
 
-  // Create new breakpoints.
+  SetNewBreakpoints(std::move(new_breakpoints));
+
+  // Remove breakpoints that were not listed.
+  RemoveBreakpoints(removed_breakpoints);
+
+  // TODO(vlif): remove breakpoints that the hub doesn't care about from
+  // format_queue_. It needs an efficient lookup and special care about the
+  // top element that might be transmitted right now.
+
+  statBreakpointsUpdateTime->add(stopwatch.GetElapsedMicros());
+}
+
+
+void JvmBreakpointsManager::RemoveAllBreakpoints() {
+  MutexLock lock_set_active_breakpoints_list(&mu_set_active_breakpoints_list_);
+
+  std::vector<std::shared_ptr<Breakpoint>> removed_breakpoints;
+
+  {
+    MutexLock lock_data(&mu_data_);
+
+    for (auto& breakpoint : active_breakpoints_) {
+      removed_breakpoints.push_back(std::move(breakpoint.second));
+    }
+
+    active_breakpoints_.clear();
+    rejected_canary_breakpoints_.clear();
+  }
+
+  RemoveBreakpoints(removed_breakpoints);
+
+  {
+    MutexLock lock_scheduled_activations(&mu_scheduled_activations_);
+    scheduled_activations_.clear();
+  }
+
+  MutexLock lock_data(&mu_data_);
+  initializing_breakpoints_.clear();
+  UpdateClassPreparedEventsUrgency();
+  completed_breakpoints_.clear();
+}
+
+
+void JvmBreakpointsManager::UpdateActiveBreakpointsList(
+    std::vector<std::unique_ptr<BreakpointModel>> added_breakpoints,
+    const std::vector<string>& removed_breakpoint_ids) {
+  Stopwatch stopwatch;
+
+  // Serialize simultaneous calls to "SetActiveBreakpointsList".
+  MutexLock lock_set_active_breakpoints_list(&mu_set_active_breakpoints_list_);
+
+  std::vector<std::unique_ptr<BreakpointModel>> new_breakpoints;
+  std::vector<std::shared_ptr<Breakpoint>> removed_breakpoints;
+
+  {
+    ScopedMonitoredCall monitored_call(
+        "BreakpointsManager:UpdateActiveBreakpoints:Scan");
+
+    MutexLock lock_data(&mu_data_);
+
+    for (const string& id : removed_breakpoint_ids) {
+      // The hub confirmed that the breakpoint will never show up again.
+      completed_breakpoints_.erase(id);
+      rejected_canary_breakpoints_.erase(id);
+
+      auto it = active_breakpoints_.find(id);
+      if (it != active_breakpoints_.end()) {
+        removed_breakpoints.push_back(std::move(it->second));
+        active_breakpoints_.erase(it);
+      }
+    }
+
+    // Retry canary breakpoints that failed registration before. They are
+    // still listed since they were not in "removed_breakpoint_ids".
+    for (auto& rejected_breakpoint : rejected_canary_breakpoints_) {
+      new_breakpoints.push_back(std::move(rejected_breakpoint.second));
+    }
+    rejected_canary_breakpoints_.clear();
+
+    for (std::unique_ptr<BreakpointModel>& breakpoint : added_breakpoints) {
+      const string& id = breakpoint->id;
+      if ((completed_breakpoints_.find(id) != completed_breakpoints_.end()) ||
+          (active_breakpoints_.find(id) != active_breakpoints_.end())) {
+        continue;
+      }
+
+      new_breakpoints.push_back(std::move(breakpoint));
+    }
+  }
+
+  SetNewBreakpoints(std::move(new_breakpoints));
+
+  RemoveBreakpoints(removed_breakpoints);
+
+  statBreakpointsUpdateTime->add(stopwatch.GetElapsedMicros());
+}
+
+
+void JvmBreakpointsManager::SetNewBreakpoints(
+    std::vector<std::unique_ptr<BreakpointModel>> new_breakpoints) {
+  // Restoring the breakpoints list (e.g. after reconnecting to the hub) sets
+  // many breakpoints at once. Publish all the new JVMTI breakpoints
+  // together.
+  const bool is_batch = (new_breakpoints.size() > 1);
+  if (is_batch) {
+    BeginBreakpointsBatch();
+  }
+
   for (std::unique_ptr<BreakpointModel>& new_breakpoint : new_breakpoints) {
     bool is_canary = new_breakpoint->is_canary;
+    std::unique_ptr<BreakpointModel> canary_definition;
+    if (is_canary) {
+      canary_definition = BreakpointBuilder(*new_breakpoint).build();
+    }
+
     std::shared_ptr<Breakpoint> jvm_breakpoint =
         breakpoint_factory_(this, std::move(new_breakpoint));
 
     if (is_canary) {
       if (canary_control_ != nullptr) {
+        // The breakpoint is listed as active right away, but it is only
+        // initialized once the canary registration completes (see
+        // "OnCanaryRegistered").
+        const string& id = jvm_breakpoint->id();
+        {
+          MutexLock lock_data(&mu_data_);
+          active_breakpoints_.insert(std::make_pair(id, jvm_breakpoint));
+          canary_pending_breakpoints_[id] = std::move(canary_definition);
+        }
+
         if (!canary_control_->RegisterBreakpointCanary(
-                jvm_breakpoint->id(),
+                id,
                 std::bind(&Breakpoint::CompleteBreakpointWithStatus,
+                          jvm_breakpoint,
+                          std::placeholders::_1),
+                std::bind(&JvmBreakpointsManager::OnCanaryRegistered,
+                          this,
                           jvm_breakpoint,
                           std::placeholders::_1))) {
-          LOG(WARNING) << "Failed to register canary breakpoint, skipping...";
-          continue;
+          RejectCanaryBreakpoint(jvm_breakpoint);
         }
-      } else {
-        LOG(ERROR) << "Breakpoint canary ignored";
+
+        continue;
       }
+
+      LOG(ERROR) << "Breakpoint canary ignored";
     }
 
-    ScopedMonitoredCall monitored_call(
-        "BreakpointsManager:SetActiveBreakpoints:SetNewBreakpoint");
+    ActivateNewBreakpoint(jvm_breakpoint);
+  }
 
-    LOG(INFO) << "Setting new breakpoint: " << jvm_breakpoint->id();
+  if (is_batch) {
+    EndBreakpointsBatch();
+  }
+}
 
-    {
-      MutexLock lock_data(&mu_data_);
-      active_breakpoints_.insert(
-          std::make_pair(jvm_breakpoint->id(), jvm_breakpoint));
+
+void JvmBreakpointsManager::ActivateNewBreakpoint(
+    std::shared_ptr<Breakpoint> jvm_breakpoint) {
+  {
+    MutexLock lock_data(&mu_data_);
+    active_breakpoints_.insert(
+        std::make_pair(jvm_breakpoint->id(), jvm_breakpoint));
+    initializing_breakpoints_.insert(
+        std::make_pair(jvm_breakpoint->id(), jvm_breakpoint));
+    UpdateClassPreparedEventsUrgency();
+  }
+
+  InitializeNewBreakpoint(jvm_breakpoint);
+}
+
+
+void JvmBreakpointsManager::InitializeNewBreakpoint(
+    std::shared_ptr<Breakpoint> jvm_breakpoint) {
+  ScopedMonitoredCall monitored_call(
+      "BreakpointsManager:SetActiveBreakpoints:SetNewBreakpoint");
+
+  LOG(INFO) << "Setting new breakpoint: " << jvm_breakpoint->id();
+
+  // Is it the responsibility of "Breakpoint" to properly deal with any
+  // errors (sending final breakpoint update and completing the breakpoint).
+  jvm_breakpoint->Initialize();
+
+  const string class_signature = jvm_breakpoint->GetClassSignature();
+
+  {
+    MutexLock lock_data(&mu_data_);
+    initializing_breakpoints_.erase(jvm_breakpoint->id());
+
+    // The breakpoint might have been completed during initialization.
+    auto it = active_breakpoints_.find(jvm_breakpoint->id());
+    if (!class_signature.empty() &&
+        (it != active_breakpoints_.end()) &&
+        (it->second == jvm_breakpoint)) {
+      class_breakpoints_.insert(
+          std::make_pair(class_signature, jvm_breakpoint));
     }
 
-    // Is it the responsibility of "Breakpoint" to properly deal with any
-    // errors (sending final breakpoint update and completing the breakpoint).
-    jvm_breakpoint->Initialize();
+    UpdateClassPreparedEventsUrgency();
   }
+}
 
-  // Remove breakpoints that were not listed.
-  for (auto& breakpoint : updated_active_breakpoints) {
-    ScopedMonitoredCall monitored_call(
-        "BreakpointsManager:SetActiveBreakpoints:RemoveCompletedBreakpoint");
 
-    if (breakpoint.second != nullptr) {
-      LOG(INFO) << "Completing breakpoint " << breakpoint.second->id()
-                << " (removed from active list by backend)";
-      breakpoint.second->ResetToPending();
-      CompleteBreakpoint(breakpoint.second->id());
+void JvmBreakpointsManager::OnCanaryRegistered(
+    std::shared_ptr<Breakpoint> jvm_breakpoint,
+    bool is_registered) {
+  MutexLock lock_set_active_breakpoints_list(&mu_set_active_breakpoints_list_);
+
+  {
+    MutexLock lock_data(&mu_data_);
+
+    // The breakpoint might have been completed or removed in the meantime.
+    auto it = active_breakpoints_.find(jvm_breakpoint->id());
+    if ((canary_pending_breakpoints_.count(jvm_breakpoint->id()) == 0) ||
+        (it == active_breakpoints_.end()) ||
+        (it->second != jvm_breakpoint)) {
+      return;
+    }
+
+    if (is_registered) {
+      canary_pending_breakpoints_.erase(jvm_breakpoint->id());
+      initializing_breakpoints_.insert(
+          std::make_pair(jvm_breakpoint->id(), jvm_breakpoint));
+      UpdateClassPreparedEventsUrgency();
     }
   }
 
-  // TODO(vlif): remove breakpoints that the hub doesn't care about from
-  // format_queue_. It needs an efficient lookup and special care about the
-  // top element that might be transmitted right now.
+  if (is_registered) {
+    InitializeNewBreakpoint(jvm_breakpoint);
+  } else {
+    RejectCanaryBreakpoint(jvm_breakpoint);
+  }
+}
 
-  statBreakpointsUpdateTime->add(stopwatch.GetElapsedMicros());
+
+void JvmBreakpointsManager::RejectCanaryBreakpoint(
+    const std::shared_ptr<Breakpoint>& jvm_breakpoint) {
+  LOG(WARNING) << "Failed to register canary breakpoint "
+               << jvm_breakpoint->id() << ", skipping...";
+
+  const string& id = jvm_breakpoint->id();
+
+  MutexLock lock_data(&mu_data_);
+
+  auto it_definition = canary_pending_breakpoints_.find(id);
+  if (it_definition != canary_pending_breakpoints_.end()) {
+    rejected_canary_breakpoints_[id] = std::move(it_definition->second);
+    canary_pending_breakpoints_.erase(it_definition);
+  }
+
+  auto it = active_breakpoints_.find(id);
+  if ((it != active_breakpoints_.end()) && (it->second == jvm_breakpoint)) {
+    active_breakpoints_.erase(it);
+  }
+}
+
+
+void JvmBreakpointsManager::RemoveBreakpoints(
+    const std::vector<std::shared_ptr<Breakpoint>>& removed_breakpoints) {
+  for (const std::shared_ptr<Breakpoint>& breakpoint : removed_breakpoints) {
+    ScopedMonitoredCall monitored_call(
+        "BreakpointsManager:SetActiveBreakpoints:RemoveCompletedBreakpoint");
+
+    LOG(INFO) << "Completing breakpoint " << breakpoint->id()
+              << " (removed from active list by backend)";
+    breakpoint->ResetToPending();
+    CompleteBreakpoint(breakpoint->id());
+
+    MutexLock lock_data(&mu_data_);
+    RemoveClassBreakpoint(breakpoint);
+    UpdateClassPreparedEventsUrgency();
+  }
 }
 
 
@@ -199,51 +456,112 @@ void JvmBreakpointsManager::JvmtiOnBreakpoint(
     jthread thread,
     jmethodID method,
     jlocation location) {
-  // Identify the list of breakpoints that were hit.
-  std::vector<std::shared_ptr<Breakpoint>> breakpoints;
+  ScopedTraceSpan trace_span("hit");
+  ScopedHotPathCounters hot_path_counters(kBreakpointHitCounters);
+
+  // Identify the list of breakpoints that were hit. This is the hottest path
+  // of the debugger, so we don't lock "mu_data_" here.
+  std::shared_ptr<const BreakpointHitTable::BreakpointsList> breakpoints =
+      hit_table_.Find(method, location);
+
+  if (breakpoints == nullptr) {
+    // This can happen once in a while: two threads are executing a function
+    // that has a breakpoint and hit the breakpoint simultaneously. By the
+    // time thread B gets to "JvmtiOnBreakpoint", thread A already finished
+    // the evaluation and completed breakpoint.
+    // If this situation happens often, it indicates a bug.
+    LOG_RATE_LIMITED(INFO)
+        << "Breakpoint hit on a location without breakpoints, method = "
+        << method << ", location: "
+        << std::hex << std::showbase << location;
+    return;
+  }
 
-  {
-    MutexLock lock_data(&mu_data_);
+  // Process the breakpoint hits.
+  if (breakpoints->size() == 1) {
+    breakpoints->front()->OnJvmBreakpointHit(
+        thread,
+        method,
+        location,
+        nullptr);
+    return;
+  }
 
-    auto it_method = method_map_.find(method);
-    if (it_method == method_map_.end()) {
-      // This can happen once in a while: two threads are executing a function
-      // that has a breakpoint and hit the breakpoint simultaneously. By the
-      // time thread B gets to "JvmtiOnBreakpoint", thread A already finished
-      // the evaluation and completed breakpoint.
-      // If this situation happens often, it indicates a bug.
-      LOG(INFO) << "Breakpoint hit on a method without breakpoints, method = "
-                << method << ", location: "
-                << std::hex << std::showbase << location;
-      return;
-    }
+  // Snapshot breakpoints at the same location capture the same call stack
+  // and objects. Each breakpoint evaluates its own condition first, then the
+  // data is collected once for all of them. "breakpoints" keeps the enlisted
+  // breakpoints alive until the capture is completed.
+  SharedCapture shared_capture(evaluators_);
+  for (const std::shared_ptr<Breakpoint>& breakpoint : *breakpoints) {
+    breakpoint->OnJvmBreakpointHit(
+          thread,
+          method,
+          location,
+          &shared_capture);
+  }
 
-    for (auto& breakpoint_location : it_method->second) {
-      if (breakpoint_location.first == location) {
-        DCHECK_EQ(std::count(
-                      breakpoints.begin(),
-                      breakpoints.end(),
-                      breakpoint_location.second),
-                  0);
+  shared_capture.Collect(thread);
+}
 
-        breakpoints.push_back(breakpoint_location.second);
-      }
+
+bool JvmBreakpointsManager::ScheduleBreakpointActivation(
+    std::shared_ptr<Breakpoint> breakpoint) {
+  if (request_breakpoints_activation_ == nullptr) {
+    return false;
+  }
+
+  {
+    MutexLock lock_scheduled_activations(&mu_scheduled_activations_);
+    scheduled_activations_.push_back(breakpoint);
+  }
+
+  // The breakpoint has to be in the list before the agent thread is woken up.
+  // If there turns out to be no agent thread, take it back out, so that the
+  // list doesn't grow forever.
+  if (!request_breakpoints_activation_()) {
+    MutexLock lock_scheduled_activations(&mu_scheduled_activations_);
+    auto it = std::find_if(
+        scheduled_activations_.begin(),
+        scheduled_activations_.end(),
+        [&breakpoint] (const std::weak_ptr<Breakpoint>& item) {
+          return item.lock() == breakpoint;
+        });
+    if (it != scheduled_activations_.end()) {
+      scheduled_activations_.erase(it);
     }
+
+    return false;
   }
 
-  if (breakpoints.empty()) {
-    LOG(WARNING) << "No locations matched on breakpoint hit, method = "
-                 << method << ", location: "
-                 << std::hex << std::showbase << location;
-    return;
+  return true;
+}
+
+
+void JvmBreakpointsManager::ActivateScheduledBreakpoints() {
+  std::vector<std::weak_ptr<Breakpoint>> scheduled_activations;
+  {
+    MutexLock lock_scheduled_activations(&mu_scheduled_activations_);
+    scheduled_activations.swap(scheduled_activations_);
   }
 
-  // Process the breakpoint hits.
-  for (std::shared_ptr<Breakpoint> breakpoint : breakpoints) {
-    breakpoint->OnJvmBreakpointHit(
-          thread,
-          method,
-          location);
+  for (const std::weak_ptr<Breakpoint>& item : scheduled_activations) {
+    std::shared_ptr<Breakpoint> breakpoint = item.lock();
+    if (breakpoint == nullptr) {
+      continue;
+    }
+
+    // Skip breakpoints that were completed or removed while waiting.
+    {
+      MutexLock lock_data(&mu_data_);
+      auto it = active_breakpoints_.find(breakpoint->id());
+      if ((it == active_breakpoints_.end()) || (it->second != breakpoint)) {
+        continue;
+      }
+    }
+
+    // "mu_data_" must not be locked, since the breakpoint calls back into
+    // "JvmBreakpointsManager".
+    breakpoint->ActivatePending();
   }
 }
 
@@ -260,9 +578,17 @@ void JvmBreakpointsManager::CompleteBreakpoint(string breakpoint_id) {
   // "CompleteBreakpoint" for the same breakpoint.
   auto it = active_breakpoints_.find(breakpoint_id);
   if (it != active_breakpoints_.end()) {
+    const BreakpointCounters::Snapshot counters = it->second->GetCounters();
+    completed_breakpoints_counters_.Add(counters);
+
     LOG(INFO) << "Breakpoint " << breakpoint_id
-              << " removed from active breakpoints list";
+              << " removed from active breakpoints list, "
+              << FormatBreakpointCounters(counters);
 
+    RemoveClassBreakpoint(it->second);
+    initializing_breakpoints_.erase(breakpoint_id);
+    canary_pending_breakpoints_.erase(breakpoint_id);
+    UpdateClassPreparedEventsUrgency();
     active_breakpoints_.erase(it);
   }
 
@@ -273,6 +599,48 @@ void JvmBreakpointsManager::CompleteBreakpoint(string breakpoint_id) {
 }
 
 
+std::shared_ptr<BreakpointGroup> JvmBreakpointsManager::GetBreakpointGroup(
+    const string& name) {
+  MutexLock lock(&mu_breakpoint_groups_);
+
+  std::weak_ptr<BreakpointGroup>& entry = breakpoint_groups_[name];
+  std::shared_ptr<BreakpointGroup> group = entry.lock();
+  if (group == nullptr) {
+    // Drop the other expired groups, so that the map doesn't grow with every
+    // group ever created.
+    for (auto it = breakpoint_groups_.begin();
+         it != breakpoint_groups_.end();) {
+      if ((it->first != name) && it->second.expired()) {
+        it = breakpoint_groups_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    group = std::make_shared<BreakpointGroup>(name);
+    entry = group;
+  }
+
+  return group;
+}
+
+
+void JvmBreakpointsManager::GetBreakpointCounters(
+    std::map<string, BreakpointCounters::Snapshot>* active_breakpoints,
+    BreakpointCounters::Snapshot* total) {
+  active_breakpoints->clear();
+
+  MutexLock lock_data(&mu_data_);
+
+  *total = completed_breakpoints_counters_;
+  for (const auto& entry : active_breakpoints_) {
+    const BreakpointCounters::Snapshot counters = entry.second->GetCounters();
+    (*active_breakpoints)[entry.first] = counters;
+    total->Add(counters);
+  }
+}
+
+
 bool JvmBreakpointsManager::SetJvmtiBreakpoint(
     jmethodID method,
     jlocation location,
@@ -280,7 +648,12 @@ bool JvmBreakpointsManager::SetJvmtiBreakpoint(
   MutexLock lock_data(&mu_data_);
 
   std::vector<std::pair<jlocation, std::shared_ptr<Breakpoint>>> empty;
-  auto it_method = method_map_.insert(std::make_pair(method, empty)).first;
+  auto in = method_map_.insert(std::make_pair(method, empty));
+  if (in.second) {
+    MethodUnloadFilter::Add(method);
+  }
+
+  auto it_method = in.first;
 
   auto& location_list = it_method->second;
 
@@ -308,6 +681,12 @@ bool JvmBreakpointsManager::SetJvmtiBreakpoint(
 
   location_list.push_back(std::make_pair(location, jvm_breakpoint));
 
+  if (is_breakpoints_batch_) {
+    is_hit_table_stale_ = true;
+  } else {
+    PublishHitTable();
+  }
+
   return true;
 }
 
@@ -366,7 +745,115 @@ void JvmBreakpointsManager::ClearJvmtiBreakpoint(
   // Clean up the entry in method_map_ (small performance optimization).
   if (location_list.empty()) {
     method_map_.erase(it_method);
+    MethodUnloadFilter::Remove(method);
   }
+
+  PublishHitTable();
+}
+
+
+void JvmBreakpointsManager::PublishHitTable() {
+  is_hit_table_stale_ = false;
+
+  std::vector<BreakpointHitTable::Entry> entries;
+
+  for (const auto& method_entry : method_map_) {
+    // Group breakpoints by location. Each method rarely has more than a
+    // couple of breakpoints, so quadratic complexity is not a concern here.
+    std::vector<std::pair<jlocation, BreakpointHitTable::BreakpointsList>>
+        locations;
+    for (const auto& breakpoint_location : method_entry.second) {
+      auto it = std::find_if(
+          locations.begin(),
+          locations.end(),
+          [&breakpoint_location] (
+              const std::pair<jlocation, BreakpointHitTable::BreakpointsList>&
+                  location) {
+            return location.first == breakpoint_location.first;
+          });
+      if (it == locations.end()) {
+        locations.push_back(std::make_pair(
+            breakpoint_location.first,
+            BreakpointHitTable::BreakpointsList()));
+        it = locations.end() - 1;
+      }
+
+      DCHECK_EQ(std::count(
+                    it->second.begin(),
+                    it->second.end(),
+                    breakpoint_location.second),
+                0);
+
+      it->second.push_back(breakpoint_location.second);
+    }
+
+    for (auto& location : locations) {
+      entries.push_back({
+        method_entry.first,
+        location.first,
+        std::make_shared<const BreakpointHitTable::BreakpointsList>(
+            std::move(location.second))
+      });
+    }
+  }
+
+  hit_table_.Publish(std::move(entries));
+}
+
+
+void JvmBreakpointsManager::BeginBreakpointsBatch() {
+  MutexLock lock_data(&mu_data_);
+  is_breakpoints_batch_ = true;
+}
+
+
+void JvmBreakpointsManager::EndBreakpointsBatch() {
+  {
+    MutexLock lock_data(&mu_data_);
+
+    is_breakpoints_batch_ = false;
+    if (is_hit_table_stale_) {
+      PublishHitTable();
+    }
+  }
+}
+
+
+std::shared_ptr<ClassMethodLines> JvmBreakpointsManager::GetClassMethodLines(
+    jclass cls,
+    const string& class_signature) {
+  MutexLock lock(&mu_class_method_lines_);
+
+  auto range = class_method_lines_.equal_range(class_signature);
+  for (auto it = range.first; it != range.second;) {
+    if (it->second->IsClassUnloaded()) {
+      it = class_method_lines_.erase(it);
+    } else if (it->second->IsSameClass(cls)) {
+      return it->second;
+    } else {
+      ++it;
+    }
+  }
+
+  if (class_method_lines_.size() >= kMaxClassMethodLines) {
+    for (auto it = class_method_lines_.begin();
+         it != class_method_lines_.end();) {
+      if (it->second->IsClassUnloaded()) {
+        it = class_method_lines_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    if (class_method_lines_.size() >= kMaxClassMethodLines) {
+      class_method_lines_.clear();
+    }
+  }
+
+  auto method_lines = std::make_shared<ClassMethodLines>(cls);
+  class_method_lines_.insert(std::make_pair(class_signature, method_lines));
+
+  return method_lines;
 }
 
 
@@ -384,17 +871,84 @@ JvmBreakpointsManager::GetActiveBreakpoints() {
   return breakpoints;
 }
 
+void JvmBreakpointsManager::FindClassBreakpoints(
+    const string& class_signature,
+    std::vector<std::shared_ptr<Breakpoint>>* breakpoints) {
+  for (const auto& entry : initializing_breakpoints_) {
+    breakpoints->push_back(entry.second);
+  }
+
+  auto range = class_breakpoints_.equal_range(class_signature);
+  for (auto it = range.first; it != range.second; ++it) {
+    breakpoints->push_back(it->second);
+  }
+}
+
+
+void JvmBreakpointsManager::RemoveClassBreakpoint(
+    const std::shared_ptr<Breakpoint>& breakpoint) {
+  for (auto it = class_breakpoints_.begin();
+       it != class_breakpoints_.end();
+       ++it) {
+    if (it->second == breakpoint) {
+      class_breakpoints_.erase(it);
+      return;
+    }
+  }
+}
+
+
+void JvmBreakpointsManager::UpdateClassPreparedEventsUrgency() {
+  evaluators_->class_indexer->SetClassPreparedEventsUrgent(
+      !initializing_breakpoints_.empty() || !class_breakpoints_.empty());
+}
+
+
 void JvmBreakpointsManager::OnClassPrepared(
     const string& type_name,
     const string& class_signature) {
-  // Propagate the event to all active breakpoints. Let each breakpoint decide
-  // whether it needs to take action.
-  for (const auto& breakpoint : GetActiveBreakpoints()) {
+  std::vector<std::shared_ptr<Breakpoint>> breakpoints;
+  {
+    MutexLock lock_data(&mu_data_);
+    FindClassBreakpoints(class_signature, &breakpoints);
+  }
+
+  // Propagate the event to breakpoints that might be in this class. Let each
+  // breakpoint decide whether it needs to take action.
+  for (const auto& breakpoint : breakpoints) {
     breakpoint->OnClassPrepared(type_name, class_signature);
   }
 }
 
 
+void JvmBreakpointsManager::OnClassesPrepared(
+    const std::vector<std::pair<string, string>>& classes) {
+  // Usually there are no breakpoints yet when the debugger starts.
+  std::vector<std::pair<int, std::shared_ptr<Breakpoint>>> notifications;
+  {
+    MutexLock lock_data(&mu_data_);
+
+    if (initializing_breakpoints_.empty() && class_breakpoints_.empty()) {
+      return;
+    }
+
+    std::vector<std::shared_ptr<Breakpoint>> breakpoints;
+    for (int i = 0; i < classes.size(); ++i) {
+      breakpoints.clear();
+      FindClassBreakpoints(classes[i].second, &breakpoints);
+      for (auto& breakpoint : breakpoints) {
+        notifications.push_back(std::make_pair(i, std::move(breakpoint)));
+      }
+    }
+  }
+
+  for (const auto& notification : notifications) {
+    const auto& cls = classes[notification.first];
+    notification.second->OnClassPrepared(cls.first, cls.second);
+  }
+}
+
+
 }  // namespace cdbg
 }  // namespace devtools
 
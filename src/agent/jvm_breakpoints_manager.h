@@ -20,9 +20,11 @@
 #include <functional>
 #include <map>
 #include <memory>
-#include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include "leaky_bucket.h"
+#include "breakpoint_hit_table.h"
 #include "breakpoints_manager.h"
 #include "canary_control.h"
 #include "class_indexer.h"
@@ -40,14 +42,17 @@ class FormatQueue;
 class JvmBreakpointsManager : public BreakpointsManager {
  public:
   // "evaluators" and "format_queue" not owned by this class and must outlive
-  // this class.
+  // this class. "request_breakpoints_activation" wakes up the agent thread
+  // that calls "ActivateScheduledBreakpoints" and returns false if there is
+  // no such thread. If null, breakpoints are always activated synchronously.
   JvmBreakpointsManager(
     std::function<std::shared_ptr<Breakpoint>(
         BreakpointsManager*,
         std::unique_ptr<BreakpointModel>)> breakpoint_factory,
     JvmEvaluators* evaluators,
     FormatQueue* format_queue,
-    CanaryControl* canary_control);
+    CanaryControl* canary_control,
+    std::function<bool()> request_breakpoints_activation = nullptr);
 
   ~JvmBreakpointsManager() override;
 
@@ -56,6 +61,12 @@ class JvmBreakpointsManager : public BreakpointsManager {
   void SetActiveBreakpointsList(
       std::vector<std::unique_ptr<BreakpointModel>> breakpoints) override;
 
+  void UpdateActiveBreakpointsList(
+      std::vector<std::unique_ptr<BreakpointModel>> added_breakpoints,
+      const std::vector<string>& removed_breakpoint_ids) override;
+
+  void RemoveAllBreakpoints() override;
+
   void JvmtiOnCompiledMethodUnload(jmethodID method) override;
 
   void JvmtiOnBreakpoint(
@@ -73,11 +84,20 @@ class JvmBreakpointsManager : public BreakpointsManager {
       jlocation location,
       std::shared_ptr<Breakpoint> breakpoint) override;
 
+  std::shared_ptr<ClassMethodLines> GetClassMethodLines(
+      jclass cls,
+      const string& class_signature) override;
+
+  bool ScheduleBreakpointActivation(
+      std::shared_ptr<Breakpoint> breakpoint) override;
+
+  void ActivateScheduledBreakpoints() override;
+
   // "breakpoint_id" is not reference because it is a string that might get
   // deleted when breakpoint gets completed.
   void CompleteBreakpoint(string breakpoint_id) override;
 
-  LeakyBucket* GetGlobalConditionCostLimiter() override {
+  ShardedLeakyBucket* GetGlobalConditionCostLimiter() override {
     return global_condition_cost_limiter_.get();
   }
 
@@ -85,7 +105,54 @@ class JvmBreakpointsManager : public BreakpointsManager {
     return global_dynamic_log_limiter_.get();
   }
 
+  LeakyBucket* GetGlobalDynamicLogBytesLimiter() override {
+    return global_dynamic_log_bytes_limiter_.get();
+  }
+
+  std::shared_ptr<BreakpointGroup> GetBreakpointGroup(
+      const string& name) override;
+
+  void GetBreakpointCounters(
+      std::map<string, BreakpointCounters::Snapshot>* active_breakpoints,
+      BreakpointCounters::Snapshot* total) override;
+
  private:
+  // Creates, initializes and activates breakpoints that were just added to
+  // the list of active breakpoints. Must be called with
+  // "mu_set_active_breakpoints_list_" locked and "mu_data_" unlocked.
+  void SetNewBreakpoints(
+      std::vector<std::unique_ptr<BreakpointModel>> new_breakpoints);
+
+  // Adds the new breakpoint to the list of active breakpoints and
+  // initializes it. Must be called with "mu_set_active_breakpoints_list_"
+  // locked and "mu_data_" unlocked.
+  void ActivateNewBreakpoint(std::shared_ptr<Breakpoint> jvm_breakpoint);
+
+  // Initializes a breakpoint that was already added to "active_breakpoints_"
+  // and "initializing_breakpoints_". Must be called with
+  // "mu_set_active_breakpoints_list_" locked and "mu_data_" unlocked.
+  void InitializeNewBreakpoint(std::shared_ptr<Breakpoint> jvm_breakpoint);
+
+  // Invoked by "canary_control_" on the transmission thread once the canary
+  // registration of the breakpoint completes. Activates the breakpoint on
+  // success.
+  void OnCanaryRegistered(
+      std::shared_ptr<Breakpoint> jvm_breakpoint,
+      bool is_registered);
+
+  // Takes out a canary breakpoint that failed registration from the list of
+  // active breakpoints and keeps its definition in
+  // "rejected_canary_breakpoints_". Must be called with
+  // "mu_set_active_breakpoints_list_" locked and "mu_data_" unlocked.
+  void RejectCanaryBreakpoint(
+      const std::shared_ptr<Breakpoint>& jvm_breakpoint);
+
+  // Completes breakpoints that the hub no longer lists as active. The
+  // breakpoints must already be removed from "active_breakpoints_". Must be
+  // called with "mu_data_" unlocked.
+  void RemoveBreakpoints(
+      const std::vector<std::shared_ptr<Breakpoint>>& removed_breakpoints);
+
   // Copies current list of active breakpoints (under "mu_data_" lock) into
   // a temporary list. The motivation to copy is to avoid lock while iterating
   // through "active_breakpoints_". All calls to "Breakpoint" have to be made
@@ -93,11 +160,43 @@ class JvmBreakpointsManager : public BreakpointsManager {
   // other JVMTI callbacks to happen.
   std::vector<std::shared_ptr<Breakpoint>> GetActiveBreakpoints();
 
+  // Gets the breakpoints that should be notified about preparation of a
+  // class with the specified signature. Appends them to "breakpoints".
+  // Must be called with "mu_data_" locked.
+  void FindClassBreakpoints(
+      const string& class_signature,
+      std::vector<std::shared_ptr<Breakpoint>>* breakpoints);
+
+  // Removes the breakpoint from "class_breakpoints_". Must be called with
+  // "mu_data_" locked.
+  void RemoveClassBreakpoint(const std::shared_ptr<Breakpoint>& breakpoint);
+
+  // Tells the class indexer whether any breakpoint is waiting for classes
+  // to be prepared. Must be called with "mu_data_" locked every time
+  // "initializing_breakpoints_" or "class_breakpoints_" changes.
+  void UpdateClassPreparedEventsUrgency();
+
+  // Rebuilds "hit_table_" from "method_map_". Must be called with "mu_data_"
+  // locked every time "method_map_" changes.
+  void PublishHitTable();
+
+  // Starts a batch of new breakpoints: "hit_table_" is only published once
+  // at the end of the batch (unless a breakpoint is cleared in the meantime).
+  void BeginBreakpointsBatch();
+
+  // Ends the batch started with "BeginBreakpointsBatch".
+  void EndBreakpointsBatch();
+
   // Callback invoked when JVM initialized (aka prepared) a Java class.
   void OnClassPrepared(
       const string& type_name,
       const string& class_signature);
 
+  // Callback invoked once for all the classes loaded before the debugger
+  // started.
+  void OnClassesPrepared(
+      const std::vector<std::pair<string, string>>& classes);
+
  private:
   // Functor to create new instances of "Breakpoint".
   const std::function<std::shared_ptr<Breakpoint>(
@@ -114,18 +213,48 @@ class JvmBreakpointsManager : public BreakpointsManager {
   // Optional manager of canary breakpoints.
   CanaryControl* const canary_control_;
 
+  // Wakes up the agent thread activating scheduled breakpoints (may be
+  // null).
+  const std::function<bool()> request_breakpoints_activation_;
+
+  // Locks access to "scheduled_activations_".
+  Mutex mu_scheduled_activations_;
+
+  // Pending breakpoints waiting for "ActivateScheduledBreakpoints".
+  std::vector<std::weak_ptr<Breakpoint>> scheduled_activations_;
+
   // Registration of a callbacks when a class has been loaded.
   ClassIndexer::OnClassPreparedEvent::Cookie on_class_prepared_cookie_;
 
+  // Registration of a callback for classes loaded before the debugger
+  // started.
+  ClassIndexer::OnClassesPreparedEvent::Cookie on_classes_prepared_cookie_;
+
   // Locks access to all breakpoint related data structures.
   Mutex mu_data_;
 
-  // Serializes calls to "SetActiveBreakpointsList" so that two simultaneous
-  // calls don't intermingle.
+  // Serializes calls to "SetActiveBreakpointsList" and
+  // "UpdateActiveBreakpointsList" so that two simultaneous calls don't
+  // intermingle.
   Mutex mu_set_active_breakpoints_list_;
 
-  // List of currently active breakpoints (keyed by breakpoint ID).
-  std::map<string, std::shared_ptr<Breakpoint>> active_breakpoints_;
+  // List of currently active breakpoints (keyed by breakpoint ID). Hash
+  // tables keep the reconciliation of the breakpoints list linear in the
+  // number of listed breakpoints.
+  std::unordered_map<string, std::shared_ptr<Breakpoint>> active_breakpoints_;
+
+  // Active breakpoints that are being initialized (keyed by breakpoint ID).
+  // Their location is not known yet, so they receive "OnClassPrepared" for
+  // every class.
+  std::unordered_map<string, std::shared_ptr<Breakpoint>>
+      initializing_breakpoints_;
+
+  // Active breakpoints with resolved location keyed by the signature of the
+  // class containing the location. Preparing a class only notifies
+  // breakpoints in that class, so the cost of class loading doesn't depend
+  // on the number of pending breakpoints.
+  std::unordered_multimap<string, std::shared_ptr<Breakpoint>>
+      class_breakpoints_;
 
   // List of recently completed breakpoint IDs that were removed from
   // "active_breakpoints_" and should not go back even if listed
@@ -133,23 +262,78 @@ class JvmBreakpointsManager : public BreakpointsManager {
   // reporting a breakpoint hit and receiving list of active breakpoints
   // from the server. Entries are removed from the set when hub stops listing
   // the breakpoint as active.
-  std::set<string> completed_breakpoints_;
-
-  // Reverse map of breakpoints. "method_map_" allows quick lookup of
-  // breakpoint given code location (useful on breakpoint hit) and lookup
-  // of all breakpoints in a certain method (to support method unload).
+  std::unordered_set<string> completed_breakpoints_;
+
+  // Sum of the hit counters of breakpoints removed from
+  // "active_breakpoints_".
+  BreakpointCounters::Snapshot completed_breakpoints_counters_;
+
+  // Definitions of canary breakpoints waiting for the registration with
+  // "canary_control_" (keyed by breakpoint ID). These breakpoints are
+  // already listed in "active_breakpoints_", but they are not initialized
+  // until "OnCanaryRegistered".
+  std::unordered_map<string, std::unique_ptr<BreakpointModel>>
+      canary_pending_breakpoints_;
+
+  // Definitions of canary breakpoints that couldn't be registered with
+  // "canary_control_". A full list of active breakpoints retries them
+  // naturally, but an incremental update doesn't list them again, so they
+  // are kept here until the hub removes them. Only accessed with
+  // "mu_set_active_breakpoints_list_" locked.
+  std::unordered_map<string, std::unique_ptr<BreakpointModel>>
+      rejected_canary_breakpoints_;
+
+  // Reverse map of breakpoints. "method_map_" allows lookup of all
+  // breakpoints in a certain method (to support method unload) and is the
+  // source of truth for "hit_table_".
   std::map<
     jmethodID,
     std::vector<
       std::pair<jlocation,
                 std::shared_ptr<Breakpoint>>>> method_map_;
 
-  // Global limit of the cost of condition checks.
-  const std::unique_ptr<LeakyBucket> global_condition_cost_limiter_;
+  // Lock free snapshot of "method_map_" for the breakpoint hit path. We can't
+  // take "mu_data_" on each breakpoint hit, because all the application
+  // threads hitting a breakpoint in a hot method will serialize on it.
+  BreakpointHitTable hit_table_;
+
+  // True while "SetNewBreakpoints" sets a batch of breakpoints.
+  bool is_breakpoints_batch_ { false };
+
+  // Set if "method_map_" changed during the batch and "hit_table_" needs to
+  // be published at the end of it.
+  bool is_hit_table_stale_ { false };
+
+  // Locks access to "class_method_lines_".
+  Mutex mu_class_method_lines_;
+
+  // Classes scanned by "GetClassMethodLines" keyed by class signature.
+  // Shared by all the breakpoints set in the class, including the ones set
+  // again after the breakpoints list is restored. Several classes may have
+  // the same signature if they were loaded by different class loaders.
+  // Entries of unloaded classes are removed when the signature is looked up
+  // again or when the cache grows too large.
+  std::unordered_multimap<string, std::shared_ptr<ClassMethodLines>>
+      class_method_lines_;
+
+  // Locks access to "breakpoint_groups_".
+  Mutex mu_breakpoint_groups_;
+
+  // Groups of breakpoints keyed by name. The groups are owned by their
+  // members. Expired entries are replaced when the name is used again.
+  std::unordered_map<string, std::weak_ptr<BreakpointGroup>>
+      breakpoint_groups_;
+
+  // Global limit of the cost of condition checks. Condition checks of hot
+  // breakpoints happen on all the CPUs at once, hence the sharding.
+  const std::unique_ptr<ShardedLeakyBucket> global_condition_cost_limiter_;
 
   // Global limit on total number of dynamic logs.
   const std::unique_ptr<LeakyBucket> global_dynamic_log_limiter_;
 
+  // Global limit on total size of dynamic log messages.
+  const std::unique_ptr<LeakyBucket> global_dynamic_log_bytes_limiter_;
+
   DISALLOW_COPY_AND_ASSIGN(JvmBreakpointsManager);
 };
 
@@ -16,14 +16,44 @@
 
 #include "jvm_class_indexer.h"
 
+#include <algorithm>
+#include <memory>
+#include "jvmti_agent_thread.h"
 #include "jvmti_buffer.h"
 #include "jni_utils.h"
 #include "type_util.h"
 #include "jni_proxy_class.h"
 
+DEFINE_int32(
+    cdbg_class_indexer_threads,
+    4,
+    "Maximum number of threads scanning classes already loaded into JVM "
+    "when the debugger starts");
+
+DEFINE_bool(
+    cdbg_deferred_class_indexing,
+    true,
+    "if true, classes prepared after the debugger starts are indexed in "
+    "batches by an agent thread rather than in the ClassPrepare callback");
+
 namespace devtools {
 namespace cdbg {
 
+// Minimum number of loaded classes that justifies an additional thread in
+// "JvmClassIndexer::Initialize".
+constexpr int kMinClassesPerIndexerThread = 2048;
+
+// Interval at which the agent thread checks for recorded prepared classes.
+constexpr int kIndexerThreadIntervalMs = 10;
+
+// Number of intervals after which the recorded classes are indexed even if
+// no breakpoint is waiting for them.
+constexpr int kIndexerThreadIdleIntervals = 100;
+
+// Number of recorded classes that are indexed even if no breakpoint is
+// waiting for them.
+constexpr int kMaxPreparedClasses = 4096;
+
 class JvmClassReference : public ClassIndexer::Type {
  public:
   JvmClassReference(ClassIndexer* class_indexer, const string& signature)
@@ -196,6 +226,16 @@ JvmClassIndexer::JvmClassIndexer()
 
 
 void JvmClassIndexer::Initialize() {
+  // Classes prepared from now on are recorded and indexed by the agent
+  // thread. Classes prepared while "GetLoadedClasses" runs may show up in
+  // both, but only get indexed once.
+  if (FLAGS_cdbg_deferred_class_indexing &&
+      indexer_thread_.Start(
+          "ClassIndexer",
+          std::bind(&JvmClassIndexer::IndexerThreadProc, this))) {
+    is_indexing_deferred_.store(true, std::memory_order_release);
+  }
+
   // Keep track of already loaded classes.
   jint classes_count = 0;
   JvmtiBuffer<jclass> classes;
@@ -205,11 +245,102 @@ void JvmClassIndexer::Initialize() {
     return;
   }
 
-  for (int i = 0; i < classes_count; ++i) {
+  const int threads_count = std::max(1, std::min(
+      FLAGS_cdbg_class_indexer_threads,
+      classes_count / kMinClassesPerIndexerThread));
+
+  // Local references can't be used in other threads.
+  std::vector<JniGlobalRef> global_classes;
+  std::vector<jobject> scanned_classes(classes.get(),
+                                       classes.get() + classes_count);
+  if (threads_count > 1) {
+    global_classes.reserve(classes_count);
+    for (int i = 0; i < classes_count; ++i) {
+      global_classes.push_back(JniNewGlobalRef(classes.get()[i]));
+      scanned_classes[i] = global_classes.back().get();
+    }
+  }
+
+  // Split the classes into chunks. The first chunk is scanned by the
+  // current thread, the rest by agent threads.
+  std::vector<std::vector<LoadedClass>> chunks(threads_count);
+  std::vector<std::unique_ptr<JvmtiAgentThread>> threads;
+  const int chunk_size = (classes_count + threads_count - 1) / threads_count;
+  for (int i = 1; i < threads_count; ++i) {
+    const int begin = i * chunk_size;
+    const int end = std::min(classes_count, begin + chunk_size);
+    const jobject* data = scanned_classes.data();
+    std::vector<LoadedClass>* chunk = &chunks[i];
+
+    std::unique_ptr<JvmtiAgentThread> thread(new JvmtiAgentThread);
+    if (thread->Start(
+            "ClassIndexer",
+            [data, begin, end, chunk] () {
+              ScanLoadedClasses(data, begin, end, chunk);
+            })) {
+      threads.push_back(std::move(thread));
+    } else {
+      ScanLoadedClasses(data, begin, end, chunk);
+    }
+  }
+
+  ScanLoadedClasses(
+      scanned_classes.data(),
+      0,
+      std::min(classes_count, chunk_size),
+      &chunks[0]);
+
+  for (auto& thread : threads) {
+    thread->Join();
+  }
+
+  // Build the index in bulk.
+  std::vector<std::pair<string, string>> prepared_classes;
+  {
+    MutexLock lock(&mu_);
+
+    for (std::vector<LoadedClass>& chunk : chunks) {
+      for (LoadedClass& loaded_class : chunk) {
+        std::pair<jobject, Empty>* inserted = nullptr;
+        if (!classes_.Insert(loaded_class.cls, Empty(), &inserted)) {
+          continue;  // Already indexed through "JvmtiOnClassPrepare".
+        }
+
+        name_index_.Insert(
+            loaded_class.type_name,
+            loaded_class.signature,
+            inserted->first,
+            loaded_class.loader_hash);
+
+        prepared_classes.push_back(std::make_pair(
+            std::move(loaded_class.type_name),
+            std::move(loaded_class.signature)));
+      }
+    }
+  }
+
+  LOG(INFO) << "Indexed " << prepared_classes.size() << " loaded classes"
+            << " using " << threads_count << " threads";
+
+  // Invoke callbacks outside of any locks to prevent potential deadlocks.
+  on_classes_prepared_.Fire(prepared_classes);
+}
+
+
+void JvmClassIndexer::ScanLoadedClasses(
+    const jobject* classes,
+    int begin,
+    int end,
+    std::vector<LoadedClass>* loaded_classes) {
+  loaded_classes->reserve(end - begin);
+
+  for (int i = begin; i < end; ++i) {
+    jclass cls = static_cast<jclass>(classes[i]);
+
     // Retrieve the class status. Ignore classes that have not been prepared
     // since list of methods will not be available for these classes.
     jint class_status = 0;
-    err = jvmti()->GetClassStatus(classes.get()[i], &class_status);
+    jvmtiError err = jvmti()->GetClassStatus(cls, &class_status);
     if (err != JVMTI_ERROR_NONE) {
       LOG(ERROR) << "GetClassStatus failed, error: " << err;
       continue;
@@ -222,22 +353,124 @@ void JvmClassIndexer::Initialize() {
       continue;
     }
 
-    JvmtiOnClassPrepare(classes.get()[i]);
+    JvmtiBuffer<char> class_signature_buffer;
+    err = jvmti()->GetClassSignature(
+        cls,
+        class_signature_buffer.ref(),
+        nullptr);
+    if (err != JVMTI_ERROR_NONE) {
+      LOG(ERROR) << "GetClassSignature failed, error: " << err;
+      continue;
+    }
+
+    if (class_signature_buffer.get() == nullptr) {
+      LOG(ERROR) << "Class signature not available";
+      continue;
+    }
+
+    LoadedClass loaded_class;
+    loaded_class.cls = cls;
+    loaded_class.signature = class_signature_buffer.get();
+    loaded_class.type_name =
+        TypeNameFromJObjectSignature(loaded_class.signature);
+    loaded_class.loader_hash = GetDefiningLoaderHash(cls);
+
+    loaded_classes->push_back(std::move(loaded_class));
   }
 }
 
 
 void JvmClassIndexer::Cleanup() {
+  stop_indexer_thread_.store(true, std::memory_order_relaxed);
+  indexer_thread_.Join();
+
+  PreparedClass* prepared_class =
+      prepared_classes_.exchange(nullptr, std::memory_order_acquire);
+  while (prepared_class != nullptr) {
+    PreparedClass* next = prepared_class->next;
+    jni()->DeleteWeakGlobalRef(prepared_class->cls);
+    delete prepared_class;
+    prepared_class = next;
+  }
+
+  prepared_classes_count_.store(0, std::memory_order_relaxed);
+
   // No other threads should be active at this point, but take the lock
   // just in case.
   MutexLock lock(&mu_);
 
   classes_.RemoveAll();
-  name_map_.clear();
+  name_index_.Clear();
+  unnotified_classes_.clear();
+}
+
+
+int JvmClassIndexer::RemoveUnloadedClasses(int64 time_budget_micros) {
+  MutexLock lock(&mu_);
+
+  // "name_index_" refers to the references owned by "classes_", so they
+  // have to be removed from both.
+  std::vector<jobject> unloaded_classes;
+  const int removed_count = classes_.RemoveCollected(
+      time_budget_micros,
+      [&unloaded_classes] (jobject cls) {
+        unloaded_classes.push_back(cls);
+      });
+
+  name_index_.Remove(unloaded_classes);
+
+  return removed_count;
 }
 
 
 void JvmClassIndexer::JvmtiOnClassPrepare(jclass cls) {
+  if (!is_indexing_deferred_.load(std::memory_order_acquire)) {
+    IndexPreparedClass(cls);
+    return;
+  }
+
+  JvmtiBuffer<char> class_signature_buffer;
+  jvmtiError err = jvmti()->GetClassSignature(
+      cls,
+      class_signature_buffer.ref(),
+      nullptr);
+  if (err != JVMTI_ERROR_NONE) {
+    LOG(ERROR) << "GetClassSignature failed, error: " << err;
+    return;
+  }
+
+  if (class_signature_buffer.get() == nullptr) {
+    LOG(ERROR) << "Class signature not available";
+    return;
+  }
+
+  jobject weak_ref = jni()->NewWeakGlobalRef(cls);
+  if (weak_ref == nullptr) {
+    LOG(ERROR) << "Failed to create weak reference to prepared class";
+    return;
+  }
+
+  // Interning directly from the JVMTI buffer copies the signature at most
+  // once (and not at all for classes with the same name loaded again).
+  PreparedClass* prepared_class = new PreparedClass {
+    weak_ref,
+    InternClassSignature(class_signature_buffer.get()),
+    nullptr
+  };
+
+  prepared_class->next = prepared_classes_.load(std::memory_order_relaxed);
+  while (!prepared_classes_.compare_exchange_weak(
+             prepared_class->next,
+             prepared_class,
+             std::memory_order_release,
+             std::memory_order_relaxed)) {
+  }
+
+  prepared_classes_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void JvmClassIndexer::IndexPreparedClass(jclass cls) {
   jvmtiError err = JVMTI_ERROR_NONE;
 
   JvmtiBuffer<char> class_signature_buffer;
@@ -255,7 +488,10 @@ void JvmClassIndexer::JvmtiOnClassPrepare(jclass cls) {
     return;
   }
 
-  string class_signature(class_signature_buffer.get());
+  std::shared_ptr<const InternedClassSignature> interned_signature =
+      InternClassSignature(class_signature_buffer.get());
+  const string& class_signature = interned_signature->signature;
+  const string& type_name = interned_signature->type_name;
 
   // Try to insert the class into the set of all loaded classes. If it fails
   // the class was already discovered and no further action is necessary.
@@ -272,17 +508,16 @@ void JvmClassIndexer::JvmtiOnClassPrepare(jclass cls) {
     DCHECK(ref != nullptr);
   }
 
-  string type_name = TypeNameFromJObjectSignature(class_signature_buffer.get());
-
   VLOG(1) << "Java class loaded, type name = " << type_name
-          << ", signature: " << class_signature_buffer.get()
+          << ", signature: " << class_signature
           << ", weak global reference to jclass: " << ref;
 
+  const int32 loader_hash = GetDefiningLoaderHash(cls);
+
   {
     MutexLock lock(&mu_);
 
-    std::hash<string> string_hash;
-    name_map_.insert(std::make_pair(string_hash(type_name), ref));
+    name_index_.Insert(type_name, class_signature, ref, loader_hash);
   }
 
   // Notify all interested parties that a new class has been prepared (i.e.
@@ -292,65 +527,173 @@ void JvmClassIndexer::JvmtiOnClassPrepare(jclass cls) {
 }
 
 
+void JvmClassIndexer::FlushPreparedClasses() {
+  PreparedClass* prepared_class =
+      prepared_classes_.exchange(nullptr, std::memory_order_acquire);
+  if (prepared_class == nullptr) {
+    return;
+  }
+
+  // Restore the order in which the classes were prepared.
+  PreparedClass* batch = nullptr;
+  while (prepared_class != nullptr) {
+    PreparedClass* next = prepared_class->next;
+    prepared_class->next = batch;
+    batch = prepared_class;
+    prepared_class = next;
+  }
+
+  int count = 0;
+  MutexLock lock(&mu_);
+
+  while (batch != nullptr) {
+    std::unique_ptr<PreparedClass> current(batch);
+    batch = batch->next;
+    ++count;
+
+    // The class might have been unloaded since "JvmtiOnClassPrepare".
+    JniLocalRef cls = JniNewLocalRef(current->cls);
+    jni()->DeleteWeakGlobalRef(current->cls);
+    if (cls == nullptr) {
+      continue;
+    }
+
+    std::pair<jobject, Empty>* inserted = nullptr;
+    if (!classes_.Insert(cls.get(), Empty(), &inserted)) {
+      continue;  // Already indexed by "Initialize".
+    }
+
+    const string& type_name = current->signature->type_name;
+    const string& signature = current->signature->signature;
+
+    VLOG(1) << "Java class loaded, type name = " << type_name
+            << ", signature: " << signature
+            << ", weak global reference to jclass: " << inserted->first;
+
+    name_index_.Insert(
+        type_name,
+        signature,
+        inserted->first,
+        GetDefiningLoaderHash(cls.get()));
+
+    unnotified_classes_.push_back(std::make_pair(type_name, signature));
+  }
+
+  prepared_classes_count_.fetch_sub(count, std::memory_order_relaxed);
+}
+
+
+void JvmClassIndexer::NotifyPreparedClasses() {
+  std::vector<std::pair<string, string>> classes;
+  {
+    MutexLock lock(&mu_);
+    classes.swap(unnotified_classes_);
+  }
+
+  if (!classes.empty()) {
+    on_classes_prepared_.Fire(classes);
+  }
+}
+
+
+void JvmClassIndexer::IndexerThreadProc() {
+  int idle_intervals = 0;
+  while (!stop_indexer_thread_.load(std::memory_order_relaxed)) {
+    indexer_thread_.Sleep(kIndexerThreadIntervalMs);
+
+    ++idle_intervals;
+    if (is_urgent_.load(std::memory_order_relaxed) ||
+        (prepared_classes_count_.load(std::memory_order_relaxed) >=
+         kMaxPreparedClasses) ||
+        (idle_intervals >= kIndexerThreadIdleIntervals)) {
+      idle_intervals = 0;
+      FlushPreparedClasses();
+      NotifyPreparedClasses();
+    }
+  }
+}
+
+
 JniLocalRef JvmClassIndexer::FindClassBySignature(
     const string& class_signature) {
-  std::hash<string> string_hash;
-  return FindClassByHashCode(
-      string_hash(TypeNameFromJObjectSignature(class_signature)),
-      [class_signature] (const string& signature) {
-        return class_signature == signature;
-      });
+  return FindClassInIndex(
+      InternClassSignature(class_signature)->type_name,
+      &class_signature,
+      nullptr);
 }
 
 
 JniLocalRef JvmClassIndexer::FindClassByName(const string& class_name) {
-  std::hash<string> string_hash;
-  return FindClassByHashCode(
-      string_hash(class_name),
-      [class_name] (const string& signature) {
-        return class_name == TypeNameFromJObjectSignature(signature);
-      });
+  return FindClassInIndex(class_name, nullptr, nullptr);
 }
 
 
-JniLocalRef JvmClassIndexer::FindClassByHashCode(
-    size_t hash_code,
-    std::function<bool(const string&)> fn_check_signature) {
-  jvmtiError err = JVMTI_ERROR_NONE;
+JniLocalRef JvmClassIndexer::FindClassBySignature(
+    const string& class_signature,
+    jobject class_loader) {
+  return FindClassInIndex(
+      InternClassSignature(class_signature)->type_name,
+      &class_signature,
+      GetLoaderHash(class_loader));
+}
+
+
+JniLocalRef JvmClassIndexer::FindClassByName(
+    const string& class_name,
+    jobject class_loader) {
+  return FindClassInIndex(class_name, nullptr, GetLoaderHash(class_loader));
+}
+
+
+JniLocalRef JvmClassIndexer::FindClassInIndex(
+    const string& type_name,
+    const string* signature,
+    Nullable<int32> loader_hash) {
+  // Lookups must see all the classes prepared so far. The notifications
+  // are still left to the agent thread.
+  FlushPreparedClasses();
 
   MutexLock lock(&mu_);
 
-  auto it = name_map_.lower_bound(hash_code);
-  while ((it != name_map_.end()) && (it->first == hash_code)) {
-    // Convert local reference to a weak reference.
-    JniLocalRef ref;
-    ref.reset(jni()->NewLocalRef(it->second));
+  return name_index_.Find(
+      type_name,
+      signature,
+      loader_hash,
+      [this] (jobject cls) {
+        classes_.Remove(cls);
+      });
+}
 
-    if (ref == nullptr) {
-      // The class has been unloaded. We can remove it from the index now.
-      classes_.Remove(it->second);
-      it = name_map_.erase(it);
-      continue;
-    }
 
-    ++it;
+int32 JvmClassIndexer::GetDefiningLoaderHash(jobject cls) {
+  jobject class_loader = nullptr;
+  jvmtiError err = jvmti()->GetClassLoader(
+      static_cast<jclass>(cls),
+      &class_loader);
+  if (err != JVMTI_ERROR_NONE) {
+    LOG(ERROR) << "GetClassLoader failed, error: " << err;
+    return 0;
+  }
 
-    JvmtiBuffer<char> class_signature_buffer;
-    err = jvmti()->GetClassSignature(
-        static_cast<jclass>(ref.get()),
-        class_signature_buffer.ref(),
-        nullptr);
-    if (err != JVMTI_ERROR_NONE) {
-      LOG(ERROR) << "GetClassSignature failed, error: " << err;
-      continue;
-    }
+  JniLocalRef auto_class_loader(class_loader);
 
-    if (fn_check_signature(class_signature_buffer.get())) {
-      return ref;
-    }
+  return GetLoaderHash(class_loader);
+}
+
+
+int32 JvmClassIndexer::GetLoaderHash(jobject class_loader) {
+  if (class_loader == nullptr) {
+    return 0;  // Bootstrap class loader.
   }
 
-  return nullptr;
+  jint hash_code = 0;
+  jvmtiError err = jvmti()->GetObjectHashCode(class_loader, &hash_code);
+  if (err != JVMTI_ERROR_NONE) {
+    LOG(ERROR) << "GetObjectHashCode failed, error: " << err;
+    return 0;
+  }
+
+  return hash_code;
 }
 
 
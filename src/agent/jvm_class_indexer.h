@@ -17,17 +17,29 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_JVM_CLASS_INDEXER_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_JVM_CLASS_INDEXER_H_
 
+#include <atomic>
 #include <list>
 #include <map>
+#include <vector>
 #include "common.h"
 #include "jobject_map.h"
 #include "class_indexer.h"
+#include "class_name_index.h"
+#include "jvmti_agent_thread.h"
 #include "mutex.h"
+#include "type_util.h"
 
 namespace devtools {
 namespace cdbg {
 
 // Listens for JVMTI notifications and maps a source file to a Java class.
+//
+// After "Initialize", "JvmtiOnClassPrepare" only records a weak reference
+// and the signature of the new class in a lock free list. The recorded
+// classes are indexed in batches by an agent thread (promptly if there are
+// pending breakpoints, otherwise infrequently) or right before a lookup.
+// Notifications about new classes are only fired from the agent thread with
+// "OnClassesPreparedEvent".
 class JvmClassIndexer : public ClassIndexer {
  public:
   JvmClassIndexer();
@@ -41,6 +53,15 @@ class JvmClassIndexer : public ClassIndexer {
   // Indicates that a new class has been loaded and prepared.
   void JvmtiOnClassPrepare(jclass cls);
 
+  // Removes unloaded classes from the index. Unloaded classes are otherwise
+  // only removed when a lookup runs into them. Spends at most
+  // "time_budget_micros" and returns the number of removed classes.
+  int RemoveUnloadedClasses(int64 time_budget_micros);
+
+  void SetClassPreparedEventsUrgent(bool is_urgent) override {
+    is_urgent_.store(is_urgent, std::memory_order_relaxed);
+  }
+
   OnClassPreparedEvent::Cookie SubscribeOnClassPreparedEvents(
       OnClassPreparedEvent::Callback fn) override {
     return on_class_prepared_.Subscribe(fn);
@@ -51,21 +72,99 @@ class JvmClassIndexer : public ClassIndexer {
     on_class_prepared_.Unsubscribe(std::move(cookie));
   }
 
+  OnClassesPreparedEvent::Cookie SubscribeOnClassesPreparedEvents(
+      OnClassesPreparedEvent::Callback fn) override {
+    return on_classes_prepared_.Subscribe(fn);
+  }
+
+  void UnsubscribeOnClassesPreparedEvents(
+      OnClassesPreparedEvent::Cookie cookie) override {
+    on_classes_prepared_.Unsubscribe(std::move(cookie));
+  }
+
   JniLocalRef FindClassBySignature(const string& class_signature) override;
 
   JniLocalRef FindClassByName(const string& class_name) override;
 
+  JniLocalRef FindClassBySignature(
+      const string& class_signature,
+      jobject class_loader) override;
+
+  JniLocalRef FindClassByName(
+      const string& class_name,
+      jobject class_loader) override;
+
   std::shared_ptr<Type> GetPrimitiveType(JType type) override;
 
   std::shared_ptr<Type> GetReference(const string& signature) override;
 
  private:
-  // Looks up the loaded class object by hash code of a class type name.
-  // "fn_check_signature" is used to ignore class objects with colliding
-  // hash code.
-  JniLocalRef FindClassByHashCode(
-      size_t hash_code,
-      std::function<bool(const string&)> fn_check_signature);
+  // Prepared class found by "Initialize".
+  struct LoadedClass {
+    // Reference to the class object (valid throughout "Initialize").
+    jobject cls;
+
+    // JVMTI signature of the class.
+    string signature;
+
+    // Type name of the class (see "TypeNameFromJObjectSignature").
+    string type_name;
+
+    // Identity hash code of the class loader that defined the class.
+    int32 loader_hash;
+  };
+
+  // Class recorded by "JvmtiOnClassPrepare" that wasn't indexed yet.
+  struct PreparedClass {
+    // Weak global reference to the class object.
+    jobject cls;
+
+    // JVMTI signature of the class and the type name derived from it.
+    std::shared_ptr<const InternedClassSignature> signature;
+
+    // Next (i.e. previously prepared) class in the list.
+    PreparedClass* next;
+  };
+
+  // Retrieves signatures of prepared classes in "classes[begin..end)".
+  // Doesn't access any data structures of this class, so that multiple
+  // threads can scan different chunks of classes in parallel.
+  static void ScanLoadedClasses(
+      const jobject* classes,
+      int begin,
+      int end,
+      std::vector<LoadedClass>* loaded_classes);
+
+ private:
+  // Indexes the new class right away and fires "OnClassPreparedEvent". Used
+  // before the agent thread starts.
+  void IndexPreparedClass(jclass cls);
+
+  // Indexes all the classes recorded by "JvmtiOnClassPrepare" so far. The
+  // notifications are queued in "unnotified_classes_".
+  void FlushPreparedClasses();
+
+  // Fires "OnClassesPreparedEvent" for "unnotified_classes_". Must not be
+  // called while holding any locks.
+  void NotifyPreparedClasses();
+
+  // Periodically indexes the recorded classes and fires notifications.
+  void IndexerThreadProc();
+
+  // Looks up the loaded class object in "name_index_". If "signature" is
+  // not nullptr, the class signature must match too. Classes defined by
+  // the class loader with "loader_hash" are preferred if it is set.
+  JniLocalRef FindClassInIndex(
+      const string& type_name,
+      const string* signature,
+      Nullable<int32> loader_hash);
+
+  // Gets the identity hash code of the class loader that defined "cls"
+  // (0 for the bootstrap class loader). Used to partition "name_index_".
+  static int32 GetDefiningLoaderHash(jobject cls);
+
+  // Gets the identity hash code of "class_loader" (0 if nullptr).
+  static int32 GetLoaderHash(jobject class_loader);
 
  private:
   // We want to use JobjectMap as a set, so we map key to empty structure.
@@ -77,20 +176,45 @@ class JvmClassIndexer : public ClassIndexer {
   // Keeps a set of loaded Java classes.
   JobjectMap<JObject_WeakRef, Empty> classes_;
 
-  // Maps hash code of a type name of the class signature to the weak
-  // reference to the Java class object. Using a type name also allows lookup
-  // by either class signature (which can be converted to type name with
+  // Maps type name and signature of a class to the weak reference to the
+  // Java class object (owned by "classes_"). Using a type name also allows
+  // lookup by class signature (which can be converted to type name with
   // "TypeNameFromJObjectSignature" method).
-  //
-  // The lookup methods compare the class signature to handle the case
-  // of hash code collision.
-  std::multimap<size_t, jobject> name_map_;
+  ClassNameIndex name_index_;
 
   // Allows other objects to subscribe to OnClassPrepared event. This event is
   // fired when a new class has been prepared (i.e. loaded and initialized)
   // in JVM.
   OnClassPreparedEvent on_class_prepared_;
 
+  // Fired once by "Initialize" for all the classes loaded before and then
+  // by the agent thread for batches of newly prepared classes.
+  OnClassesPreparedEvent on_classes_prepared_;
+
+  // Lock free list (most recent first) of classes recorded by
+  // "JvmtiOnClassPrepare" and not indexed yet.
+  std::atomic<PreparedClass*> prepared_classes_ { nullptr };
+
+  // Approximate number of elements in "prepared_classes_".
+  std::atomic<int> prepared_classes_count_ { 0 };
+
+  // Type names and signatures of classes indexed by "FlushPreparedClasses"
+  // waiting for "NotifyPreparedClasses".
+  std::vector<std::pair<string, string>> unnotified_classes_;
+
+  // Set once "indexer_thread_" is started. Until then "JvmtiOnClassPrepare"
+  // indexes new classes synchronously.
+  std::atomic<bool> is_indexing_deferred_ { false };
+
+  // Set if there are breakpoints waiting for new classes.
+  std::atomic<bool> is_urgent_ { false };
+
+  // Signals "indexer_thread_" to exit.
+  std::atomic<bool> stop_indexer_thread_ { false };
+
+  // Agent thread indexing the classes recorded by "JvmtiOnClassPrepare".
+  JvmtiAgentThread indexer_thread_;
+
   // Primitive types.
   const std::shared_ptr<ClassIndexer::Type> primitive_void_;
   const std::shared_ptr<ClassIndexer::Type> primitive_boolean_;
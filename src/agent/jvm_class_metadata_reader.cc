@@ -33,6 +33,31 @@ static void ReleaseEntryRefs(jobject cls, ClassMetadataReader::Entry* entry) {
 }
 
 
+// Checks if the class has a non-default version of "toString()". Interfaces
+// are never the class of an object, so they are not checked.
+static bool LoadHasCustomToString(jclass cls) {
+  jint class_modifiers = 0;
+  if ((jvmti()->GetClassModifiers(cls, &class_modifiers) !=
+       JVMTI_ERROR_NONE) ||
+      ((class_modifiers & JVM_ACC_INTERFACE) != 0)) {
+    return false;
+  }
+
+  jmethodID method_id = jni()->GetMethodID(
+      cls,
+      "toString",
+      "()Ljava/lang/String;");
+  if (!JniCheckNoException("GetMethodID(toString)") ||
+      (method_id == nullptr)) {
+    return false;
+  }
+
+  return !jni()->IsSameObject(
+      GetMethodDeclaringClass(method_id).get(),
+      jniproxy::Object()->GetClass());
+}
+
+
 JvmClassMetadataReader::JvmClassMetadataReader(
     MemberVisibilityPolicy* member_visibility_policy)
     : member_visibility_policy_(member_visibility_policy),
@@ -84,6 +109,15 @@ JvmClassMetadataReader::GetClassMetadata(jclass cls) {
 }
 
 
+int JvmClassMetadataReader::RemoveUnloadedClasses(int64 time_budget_micros) {
+  // Entries returned by "GetClassMetadata" stay valid as long as the caller
+  // holds a reference to the class, so only entries of classes that can no
+  // longer be referenced are removed.
+  MutexLock writer_lock(&mu_);
+  return cls_cache_.RemoveCollected(time_budget_micros);
+}
+
+
 void JvmClassMetadataReader::LoadClassMetadata(jclass cls, Entry* metadata) {
   string signature = GetClassSignature(cls);
   if (signature.empty()) {
@@ -91,6 +125,10 @@ void JvmClassMetadataReader::LoadClassMetadata(jclass cls, Entry* metadata) {
   }
 
   metadata->signature = JSignatureFromSignature(signature);
+  metadata->well_known_jclass =
+      WellKnownJClassFromSignature(metadata->signature);
+  metadata->has_custom_to_string = LoadHasCustomToString(cls);
+  metadata->type_evaluator.reset(new std::atomic<TypeEvaluator*>(nullptr));
 
   // Start from the current class and go down the inheritance chain.
   JniLocalRef current_class_ref = JniNewLocalRef(cls);
@@ -133,9 +171,49 @@ void JvmClassMetadataReader::LoadClassMetadata(jclass cls, Entry* metadata) {
   std::reverse(
       metadata->instance_fields.begin(),
       metadata->instance_fields.end());
+  std::reverse(
+      metadata->instance_fields_layout.field_ids.begin(),
+      metadata->instance_fields_layout.field_ids.end());
   std::reverse(
       metadata->static_fields.begin(),
       metadata->static_fields.end());
+
+  BuildInstanceFieldsLayout(metadata);
+}
+
+
+void JvmClassMetadataReader::BuildInstanceFieldsLayout(Entry* metadata) {
+  Entry::InstanceFieldsLayout* layout = &metadata->instance_fields_layout;
+  DCHECK_EQ(layout->field_ids.size(), metadata->instance_fields.size());
+
+  const int count = metadata->instance_fields.size();
+  layout->names.resize(count);
+  layout->well_known_jclasses.resize(count);
+
+  // Counting sort of the fields by type.
+  int type_counts[TotalJTypes] = { };
+  for (int i = 0; i < count; ++i) {
+    const InstanceFieldReader& field_reader = *metadata->instance_fields[i];
+    const JSignature& field_type = field_reader.GetStaticType();
+
+    layout->names[i] = &field_reader.GetName();
+    layout->well_known_jclasses[i] = WellKnownJClassFromSignature(field_type);
+    ++type_counts[static_cast<int>(field_type.type)];
+  }
+
+  layout->type_begin[0] = 0;
+  for (int t = 0; t < TotalJTypes; ++t) {
+    layout->type_begin[t + 1] = layout->type_begin[t] + type_counts[t];
+  }
+
+  int next[TotalJTypes];
+  std::copy(layout->type_begin, layout->type_begin + TotalJTypes, next);
+
+  layout->by_type.resize(count);
+  for (int i = 0; i < count; ++i) {
+    const JType type = metadata->instance_fields[i]->GetStaticType().type;
+    layout->by_type[next[static_cast<int>(type)]++] = i;
+  }
 }
 
 
@@ -234,8 +312,11 @@ void JvmClassMetadataReader::LoadSingleClassMetadata(
         continue;
       }
 
-      // Add the method to the registry.
+      // Add the method to the registry. The signature is parsed once here,
+      // so that overload resolution doesn't parse it on every compile.
       registered_methods->insert(std::move(key));
+      method_metadata.parsed_signature =
+          InternJMethodSignature(method_metadata.signature);
       metadata->methods.push_back(std::move(method_metadata));
     }
   }
@@ -298,6 +379,7 @@ void JvmClassMetadataReader::LoadFieldInfo(
             field_id,
             JSignatureFromSignature(field_signature)));
     metadata->instance_fields.push_back(std::move(reader));
+    metadata->instance_fields_layout.field_ids.push_back(field_id);
   } else {
     // Static field.
     std::unique_ptr<StaticFieldReader> reader(
@@ -305,7 +387,8 @@ void JvmClassMetadataReader::LoadFieldInfo(
             cls,
             field_name,
             field_id,
-            JSignatureFromSignature(field_signature)));
+            JSignatureFromSignature(field_signature),
+            (field_modifiers & JVM_ACC_FINAL) != 0));
     metadata->static_fields.push_back(std::move(reader));
   }
 }
@@ -71,6 +71,8 @@ class JvmClassMetadataReader : public ClassMetadataReader {
   // Loads metadata of Java class "cls" or retrieves it from cache.
   const Entry& GetClassMetadata(jclass cls) override;
 
+  int RemoveUnloadedClasses(int64 time_budget_micros) override;
+
  private:
   // Loads metadata of Java class and its superclasses into "metadata". The
   // function assumes previously uninitialized structure.
@@ -96,6 +98,10 @@ class JvmClassMetadataReader : public ClassMetadataReader {
       jfieldID field_id,
       Entry* metadata);
 
+  // Builds "instance_fields_layout" from "instance_fields" and the field IDs
+  // collected by "LoadFieldInfo".
+  static void BuildInstanceFieldsLayout(Entry* metadata);
+
   // Loads metadata of a method. In case of error returns "Method" with empty
   // name.
   Method LoadMethodInfo(
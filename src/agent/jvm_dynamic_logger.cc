@@ -16,14 +16,54 @@
 
 #include "jvm_dynamic_logger.h"
 
+#include <algorithm>
+#include "log_rate_limiter.h"
+#include "message_template.h"
+#include "messages.h"
 #include "resolved_source_location.h"
 #include "type_util.h"
 #include "jni_proxy_jul_logger.h"
 #include "jni_proxy_dynamicloghelper.h"
 
+DEFINE_int32(
+    dynamic_log_aggregation_window_ms,
+    0,
+    "if positive, identical messages of a dynamic log point are only written "
+    "once in this many milliseconds, followed by a summary of how many times "
+    "they repeated; 0 disables the aggregation");
+
 namespace devtools {
 namespace cdbg {
 
+// Maximum number of distinct messages aggregated at the same time. Messages
+// beyond this limit are written as is.
+static constexpr int kMaxRepeatedMessages = 1000;
+
+// Maximum number of Java strings interned for the source class and method
+// names. The cache starts over once this is reached.
+static constexpr int kMaxInternedStrings = 1000;
+
+// Creates "String[]" or "Level[]" array for the batches.
+static JniGlobalRef NewBatchArray(jclass cls) {
+  if (cls == nullptr) {
+    return nullptr;
+  }
+
+  JniLocalRef array(
+      jni()->NewObjectArray(kMaxDynamicLogBatchSize, cls, nullptr));
+  if (!JniCheckNoException("NewObjectArray") || (array == nullptr)) {
+    LOG(ERROR) << "Failed to allocate dynamic log batch array";
+    return nullptr;
+  }
+
+  return JniNewGlobalRef(array.get());
+}
+
+
+static string IdentityString(string value) {
+  return value;
+}
+
 void JvmDynamicLogger::Initialize() {
   logger_ = nullptr;
 
@@ -51,6 +91,19 @@ void JvmDynamicLogger::Initialize() {
   // The application may define to filter out INFO or WARNING logs by default,
   // but we don't want this to apply to dynamic logging.
   jniproxy::Logger()->setLevel(logger_.get(), level_.info.get());
+
+  JavaClass string_cls;
+  if (!string_cls.FindWithJNI("java/lang/String")) {
+    return;
+  }
+
+  JniLocalRef level_cls = GetObjectClass(level_.info.get());
+
+  MutexLock lock(&batch_.mu);
+  batch_.levels = NewBatchArray(static_cast<jclass>(level_cls.get()));
+  batch_.source_classes = NewBatchArray(string_cls.get());
+  batch_.source_methods = NewBatchArray(string_cls.get());
+  batch_.messages = NewBatchArray(string_cls.get());
 }
 
 
@@ -64,34 +117,316 @@ void JvmDynamicLogger::Log(
     const ResolvedSourceLocation& source_location,
     const string& message) {
   if (!IsAvailable()) {
-    LOG(WARNING) << "Dynamic logger not available";
+    LOG_RATE_LIMITED(WARNING) << "Dynamic logger not available";
+    return;
+  }
+
+  std::vector<RepeatedMessage> summaries;
+  const bool is_repeated =
+      (FLAGS_dynamic_log_aggregation_window_ms > 0) &&
+      IsRepeatedMessage(level, source_location, message, &summaries);
+
+  for (const RepeatedMessage& summary : summaries) {
+    WriteSummary(summary);
+  }
+
+  if (is_repeated) {
+    return;
+  }
+
+  WriteEntry(
+      level,
+      InternClassSignature(source_location.class_signature)->type_name,
+      source_location.method_name,
+      message);
+}
+
+
+void JvmDynamicLogger::LogBatch(const std::vector<DynamicLogRecord>& records) {
+  if (!IsAvailable()) {
+    LOG_RATE_LIMITED(WARNING) << "Dynamic logger not available";
+    return;
+  }
+
+  MutexLock lock(&batch_.mu);
+
+  if ((batch_.levels == nullptr) ||
+      (batch_.source_classes == nullptr) ||
+      (batch_.source_methods == nullptr) ||
+      (batch_.messages == nullptr)) {
+    // The arrays could not be allocated. Write the records one by one.
+    DynamicLogger::LogBatch(records);
+    return;
+  }
+
+  std::vector<RepeatedMessage> summaries;
+  for (const DynamicLogRecord& record : records) {
+    const ResolvedSourceLocation& source_location = *record.source_location;
+
+    summaries.clear();
+    const bool is_repeated =
+        (FLAGS_dynamic_log_aggregation_window_ms > 0) &&
+        IsRepeatedMessage(
+            record.level,
+            source_location,
+            record.message,
+            &summaries);
+
+    for (const RepeatedMessage& summary : summaries) {
+      AddToBatch(
+          summary.level,
+          summary.class_signature,
+          summary.method_name,
+          FormatSummary(summary));
+    }
+
+    if (!is_repeated) {
+      AddToBatch(
+          record.level,
+          source_location.class_signature,
+          source_location.method_name,
+          record.message);
+    }
+  }
+
+  PublishBatch();
+}
+
+
+void JvmDynamicLogger::FlushRepeatedMessages() {
+  if (!IsAvailable() || (FLAGS_dynamic_log_aggregation_window_ms <= 0)) {
     return;
   }
 
-  const string source_class =
-      TypeNameFromJObjectSignature(source_location.class_signature);
+  std::vector<RepeatedMessage> summaries;
+  {
+    MutexLock lock(&mu_);
+    TakeExpiredMessages(aggregation_stopwatch_.GetElapsedMillis(), &summaries);
+  }
+
+  for (const RepeatedMessage& summary : summaries) {
+    WriteSummary(summary);
+  }
+}
+
+
+bool JvmDynamicLogger::IsRepeatedMessage(
+    BreakpointModel::LogLevel level,
+    const ResolvedSourceLocation& source_location,
+    const string& message,
+    std::vector<RepeatedMessage>* summaries) {
+  string key;
+  key.reserve(
+      source_location.class_signature.size() +
+      source_location.method_name.size() +
+      message.size() + 16);
+  key += source_location.class_signature;
+  key += '\n';
+  key += source_location.method_name;
+  key += '\n';
+  key += std::to_string(source_location.adjusted_line_number);
+  key += '\n';
+  key += std::to_string(static_cast<int>(level));
+  key += '\n';
+  key += message;
+
+  MutexLock lock(&mu_);
+
+  const int64 now_ms = aggregation_stopwatch_.GetElapsedMillis();
+  if (now_ms >= next_expiration_ms_) {
+    TakeExpiredMessages(now_ms, summaries);
+  }
+
+  auto it = repeated_messages_.find(key);
+  if (it != repeated_messages_.end()) {
+    RepeatedMessage& repeated_message = it->second;
+    if (now_ms - repeated_message.window_start_ms <
+        FLAGS_dynamic_log_aggregation_window_ms) {
+      ++repeated_message.repeat_count;
+      return true;
+    }
+
+    // The window is over, but "TakeExpiredMessages" didn't get to it yet.
+    // Write out the summary and start a new window with this message.
+    if (repeated_message.repeat_count > 0) {
+      summaries->push_back(repeated_message);
+    }
+
+    repeated_message.window_start_ms = now_ms;
+    repeated_message.repeat_count = 0;
+    return false;
+  }
+
+  if (repeated_messages_.size() >= kMaxRepeatedMessages) {
+    return false;
+  }
+
+  if (repeated_messages_.empty()) {
+    next_expiration_ms_ = now_ms + FLAGS_dynamic_log_aggregation_window_ms;
+  }
+
+  repeated_messages_[std::move(key)] = RepeatedMessage {
+    level,
+    source_location.class_signature,
+    source_location.method_name,
+    message,
+    now_ms,
+    0
+  };
+
+  return false;
+}
+
+
+void JvmDynamicLogger::TakeExpiredMessages(
+    int64 now_ms,
+    std::vector<RepeatedMessage>* summaries) {
+  next_expiration_ms_ = now_ms + FLAGS_dynamic_log_aggregation_window_ms;
+
+  for (auto it = repeated_messages_.begin(); it != repeated_messages_.end(); ) {
+    const RepeatedMessage& repeated_message = it->second;
+    const int64 expiration_ms =
+        repeated_message.window_start_ms +
+        FLAGS_dynamic_log_aggregation_window_ms;
+    if (now_ms < expiration_ms) {
+      next_expiration_ms_ = std::min(next_expiration_ms_, expiration_ms);
+      ++it;
+      continue;
+    }
+
+    if (repeated_message.repeat_count > 0) {
+      summaries->push_back(repeated_message);
+    }
+
+    it = repeated_messages_.erase(it);
+  }
+}
+
+
+string JvmDynamicLogger::FormatSummary(const RepeatedMessage& summary) {
+  string message;
+  MessageTemplate::AppendFormatted(
+      DynamicLogRepeated,
+      {
+        summary.message,
+        std::to_string(summary.repeat_count),
+        std::to_string(FLAGS_dynamic_log_aggregation_window_ms)
+      },
+      &message);
+
+  return message;
+}
+
+
+void JvmDynamicLogger::WriteSummary(const RepeatedMessage& summary) {
+  WriteEntry(
+      summary.level,
+      InternClassSignature(summary.class_signature)->type_name,
+      summary.method_name,
+      FormatSummary(summary));
+}
+
+
+void JvmDynamicLogger::WriteEntry(
+    BreakpointModel::LogLevel level,
+    const string& source_class,
+    const string& method_name,
+    const string& message) {
+  jniproxy::Logger()->logp(
+      logger_.get(),
+      GetLevel(level),
+      source_class,
+      method_name,
+      message);
+}
+
 
-  jobject level_obj = nullptr;
+jobject JvmDynamicLogger::GetLevel(BreakpointModel::LogLevel level) const {
   switch (level) {
     case BreakpointModel::LogLevel::INFO:
-      level_obj = level_.info.get();
-      break;
+      return level_.info.get();
 
     case BreakpointModel::LogLevel::WARNING:
-      level_obj = level_.warning.get();
-      break;
+      return level_.warning.get();
 
     case BreakpointModel::LogLevel::ERROR:
-      level_obj = level_.severe.get();
-      break;
+      return level_.severe.get();
   }
 
-  jniproxy::Logger()->logp(
+  return nullptr;
+}
+
+
+jobject JvmDynamicLogger::InternString(
+    InternedStrings* strings,
+    const string& key,
+    string (*make_value)(string key)) {
+  auto it = strings->find(key);
+  if (it != strings->end()) {
+    return it->second.get();
+  }
+
+  if (strings->size() >= kMaxInternedStrings) {
+    strings->clear();
+  }
+
+  JniGlobalRef& value = (*strings)[key];
+  value = JniNewGlobalRef(JniToJavaString(make_value(key)).get());
+
+  return value.get();
+}
+
+
+void JvmDynamicLogger::AddToBatch(
+    BreakpointModel::LogLevel level,
+    const string& class_signature,
+    const string& method_name,
+    const string& message) {
+  const int index = batch_.count;
+
+  jni()->SetObjectArrayElement(
+      static_cast<jobjectArray>(batch_.levels.get()),
+      index,
+      GetLevel(level));
+  jni()->SetObjectArrayElement(
+      static_cast<jobjectArray>(batch_.source_classes.get()),
+      index,
+      InternString(
+          &batch_.source_class_names,
+          class_signature,
+          TypeNameFromJObjectSignature));
+  jni()->SetObjectArrayElement(
+      static_cast<jobjectArray>(batch_.source_methods.get()),
+      index,
+      InternString(&batch_.method_names, method_name, IdentityString));
+  jni()->SetObjectArrayElement(
+      static_cast<jobjectArray>(batch_.messages.get()),
+      index,
+      JniToJavaString(message).get());
+
+  ++batch_.count;
+  if (batch_.count == kMaxDynamicLogBatchSize) {
+    PublishBatch();
+  }
+}
+
+
+void JvmDynamicLogger::PublishBatch() {
+  if (batch_.count == 0) {
+    return;
+  }
+
+  // "logBatch" clears the messages, so the arrays don't keep the last batch
+  // alive until the next one.
+  jniproxy::DynamicLogHelper()->logBatch(
       logger_.get(),
-      level_obj,
-      source_class,
-      source_location.method_name,
-      message);
+      batch_.levels.get(),
+      batch_.source_classes.get(),
+      batch_.source_methods.get(),
+      batch_.messages.get(),
+      batch_.count);
+
+  batch_.count = 0;
 }
 
 }  // namespace cdbg
@@ -17,13 +17,24 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_JVM_DYNAMIC_LOGGER_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_JVM_DYNAMIC_LOGGER_H_
 
+#include <unordered_map>
+#include <vector>
 #include "common.h"
 #include "dynamic_logger.h"
 #include "jni_utils.h"
+#include "mutex.h"
+#include "stopwatch.h"
 
 namespace devtools {
 namespace cdbg {
 
+// Writes dynamic logs through "java.util.logging.Logger".
+//
+// If "FLAGS_dynamic_log_aggregation_window_ms" is set, identical messages
+// from the same log point are aggregated: the first occurrence is written
+// right away, the repetitions that follow within the window are only
+// counted. The count is written as a summary once the window is over. This
+// is checked on the next "Log" call or in "FlushRepeatedMessages".
 class JvmDynamicLogger : public DynamicLogger {
  public:
   // Loads the relevant Java classes and creates the shared "Logger" instance.
@@ -36,6 +47,85 @@ class JvmDynamicLogger : public DynamicLogger {
       const ResolvedSourceLocation& source_location,
       const string& message) override;
 
+  // Publishes the records through a single call into Java, which then calls
+  // "Logger.logp" for each of them. The names of the source class and method
+  // are converted to Java strings once per log point rather than per record.
+  void LogBatch(const std::vector<DynamicLogRecord>& records) override;
+
+  // Writes the summaries of aggregated messages whose window is over.
+  void FlushRepeatedMessages();
+
+ private:
+  // Java strings keyed by the native string they were created from.
+  typedef std::unordered_map<string, JniGlobalRef> InternedStrings;
+
+  // Message that was recently written and is being aggregated.
+  struct RepeatedMessage {
+    BreakpointModel::LogLevel level;
+    string class_signature;
+    string method_name;
+    string message;
+
+    // Time (as measured by "aggregation_stopwatch_") when the message was
+    // last written.
+    int64 window_start_ms;
+
+    // Number of times the message was suppressed since then.
+    int64 repeat_count;
+  };
+
+  // Checks whether "message" repeats a message written within the
+  // aggregation window. Takes out the summaries of the expired messages to
+  // be written by the caller.
+  bool IsRepeatedMessage(
+      BreakpointModel::LogLevel level,
+      const ResolvedSourceLocation& source_location,
+      const string& message,
+      std::vector<RepeatedMessage>* summaries);
+
+  // Takes out the messages whose aggregation window is over by "now_ms".
+  // Messages that didn't repeat are discarded and the others are appended
+  // to "summaries". Must be called with "mu_" held.
+  void TakeExpiredMessages(
+      int64 now_ms,
+      std::vector<RepeatedMessage>* summaries);
+
+  // Formats the summary message of a repeated message.
+  static string FormatSummary(const RepeatedMessage& summary);
+
+  // Writes the summary of a repeated message.
+  void WriteSummary(const RepeatedMessage& summary);
+
+  // Calls "Logger.logp".
+  void WriteEntry(
+      BreakpointModel::LogLevel level,
+      const string& source_class,
+      const string& method_name,
+      const string& message);
+
+  // Gets the "java.util.logging.Level" object of the log level.
+  jobject GetLevel(BreakpointModel::LogLevel level) const;
+
+  // Gets the Java string of "key" from "strings". If not there yet, the
+  // string is created from "make_value(key)". The returned reference is
+  // owned by "strings". Must be called with "batch_.mu" held.
+  static jobject InternString(
+      InternedStrings* strings,
+      const string& key,
+      string (*make_value)(string key));
+
+  // Appends the record to the batch arrays and publishes the batch once it
+  // is full. Must be called with "batch_.mu" held.
+  void AddToBatch(
+      BreakpointModel::LogLevel level,
+      const string& class_signature,
+      const string& method_name,
+      const string& message);
+
+  // Publishes the records accumulated in the batch arrays. Must be called
+  // with "batch_.mu" held.
+  void PublishBatch();
+
  private:
   // Instance of "java.util.logging.Logger" class.
   JniGlobalRef logger_;
@@ -51,6 +141,41 @@ class JvmDynamicLogger : public DynamicLogger {
     // Global reference to "Level.SEVERE" static field.
     JniGlobalRef severe;
   } level_;
+
+  // Arrays passed to "DynamicLogHelper.logBatch". They are allocated once and
+  // reused by all the batches.
+  struct {
+    // Locks access to this struct.
+    Mutex mu;
+
+    // "Level[]", "String[]", "String[]" and "String[]" arrays of
+    // "kMaxDynamicLogBatchSize" elements.
+    JniGlobalRef levels;
+    JniGlobalRef source_classes;
+    JniGlobalRef source_methods;
+    JniGlobalRef messages;
+
+    // Number of records in the arrays waiting to be published.
+    int count { 0 };
+
+    // Source class names keyed by the class signature.
+    InternedStrings source_class_names;
+
+    // Method names keyed by themselves.
+    InternedStrings method_names;
+  } batch_;
+
+  // Locks access to the aggregated messages.
+  Mutex mu_;
+
+  // Measures the aggregation windows.
+  Stopwatch aggregation_stopwatch_;
+
+  // Messages written recently keyed by the log point and the message itself.
+  std::unordered_map<string, RepeatedMessage> repeated_messages_;
+
+  // Time when the next aggregation window of any message might be over.
+  int64 next_expiration_ms_ { 0 };
 };
 
 }  // namespace cdbg
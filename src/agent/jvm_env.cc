@@ -16,6 +16,7 @@
 
 #include <map>
 #include "common.h"
+#include "hot_path_counters.h"
 #include "jni_proxy_arithmeticexception.h"
 #include "jni_proxy_class.h"
 #include "jni_proxy_classcastexception.h"
@@ -41,11 +42,13 @@ static __thread JNIEnv* g_jni = nullptr;
 static jobject g_system_class_loader = nullptr;
 
 jvmtiEnv* jvmti() {
+  CDBG_COUNT_HOT_PATH(jvmti_calls);
   return g_jvmti;
 }
 
 
 JNIEnv* jni() {
+  CDBG_COUNT_HOT_PATH(jni_calls);
   return g_jni;
 }
 
@@ -17,12 +17,84 @@
 #include "jvm_eval_call_stack.h"
 
 #include <algorithm>
+#include <thread>  // NOLINT
 #include "jni_utils.h"
 #include "jvmti_buffer.h"
+#include "location_index.h"
+#include "method_unload_filter.h"
+#include "statistician.h"
+
+DEFINE_int32(
+    cdbg_frame_info_cache_max_size,
+    4 * 1024 * 1024,  // 4 MB.
+    "Maximum estimated memory used by cached method names and line number "
+    "tables of decoded call frames");
 
 namespace devtools {
 namespace cdbg {
 
+// Estimated memory overhead of a single entry in "JvmEvalCallStack" cache
+// (list and hash table nodes, vectors, "MethodInfo" control block).
+constexpr int kMethodCacheOverhead = 256;
+
+// Estimated memory used by a single cached call frame.
+constexpr int kFrameInfoSize =
+    sizeof(jlocation) + sizeof(std::shared_ptr<void>) + 64;
+
+// Number of slots in the per-thread cache of decoded call frames. Must be a
+// power of 2.
+constexpr int kThreadFrameCacheSize = 128;
+
+// Single slot of the per-thread cache of decoded call frames.
+struct ThreadFrameCacheSlot {
+  // Cache that decoded the frame.
+  const JvmEvalCallStack* owner { nullptr };
+
+  // Value of "g_frame_cache_epoch" when the frame was decoded.
+  uint64 epoch { 0 };
+
+  // Location of the call frame.
+  jmethodID method { nullptr };
+  jlocation location { 0 };
+
+  std::shared_ptr<const EvalCallStack::FrameInfo> frame_info;
+};
+
+// Incremented every time a method is removed from any "JvmEvalCallStack"
+// (or the cache is destroyed). Invalidates all the per-thread caches.
+static std::atomic<uint64> g_frame_cache_epoch { 1 };
+
+// Recently decoded call frames of the current thread.
+static thread_local ThreadFrameCacheSlot
+    g_thread_frame_cache[kThreadFrameCacheSize];
+
+// Reader counter stripe assigned to the current thread (or -1 if not assigned
+// yet).
+static __thread int g_reader_stripe = -1;
+
+// Source of reader stripes for new threads.
+static std::atomic<int> g_next_reader_stripe { 0 };
+
+
+JvmEvalCallStack::JvmEvalCallStack() {
+  memory_budget_cookie_ = MemoryBudget::GetInstance()->Register(
+      "call frames cache",
+      [this] () { return total_size(); },
+      [this] () { ReleaseCache(); });
+}
+
+
+JvmEvalCallStack::~JvmEvalCallStack() {
+  MemoryBudget::GetInstance()->Unregister(memory_budget_cookie_);
+
+  g_frame_cache_epoch.fetch_add(1);
+
+  for (const MethodCache& method_cache : lru_) {
+    MethodUnloadFilter::Remove(method_cache.method);
+  }
+}
+
+
 void JvmEvalCallStack::Read(jthread thread, std::vector<JvmFrame>* result) {
   jvmtiError err = JVMTI_ERROR_NONE;
 
@@ -31,7 +103,7 @@ void JvmEvalCallStack::Read(jthread thread, std::vector<JvmFrame>* result) {
   // Block JvmtiOnCompiledMethodUnload as long as this function is executing.
   // This is to make sure Java methods don't get unloaded while this function
   // is executing.
-  MutexLock jmethods_reader_lock(&jmethods_mu_);
+  const int stripe = BeginJMethodsRead();
 
   // Load call stack through JVMTI.
   jint frames_count = 0;
@@ -44,6 +116,7 @@ void JvmEvalCallStack::Read(jthread thread, std::vector<JvmFrame>* result) {
       &frames_count);
   if (err != JVMTI_ERROR_NONE) {
     LOG(ERROR) << "Failed to get stack trace, error: " << err;
+    EndJMethodsRead(stripe);
     return;
   }
 
@@ -51,70 +124,295 @@ void JvmEvalCallStack::Read(jthread thread, std::vector<JvmFrame>* result) {
   for (int i = 0; i < frames_count; ++i) {
     result->push_back({ frames[i], DecodeFrame(frames[i]) });
   }
+
+  EndJMethodsRead(stripe);
 }
 
 
-const JvmEvalCallStack::FrameInfo& JvmEvalCallStack::ResolveCallFrameKey(
-    int key) const {
-  MutexLock data_reader_lock(&data_mu_);
+void JvmEvalCallStack::ReadAllThreads(
+    int max_threads,
+    const string& thread_name_prefix,
+    std::vector<ThreadStack>* result) {
+  jvmtiError err = JVMTI_ERROR_NONE;
 
-  DCHECK((key >= 0) && (key < frames_.size()));
+  result->clear();
 
-  // The FrameInfo is immutable and never gets deleted (as long as this
-  // instance is alive). Therefore it is safe to return pointer to it.
-  return *frames_[key];
-}
+  jint all_threads_count = 0;
+  JvmtiBuffer<jthread> all_threads;
+  err = jvmti()->GetAllThreads(&all_threads_count, all_threads.ref());
+  if (err != JVMTI_ERROR_NONE) {
+    LOG(ERROR) << "Failed to get all threads, error: " << err;
+    return;
+  }
 
+  // Filter the threads before reading their stacks, so that the JVM doesn't
+  // walk the stacks of threads that aren't reported.
+  std::vector<JniLocalRef> thread_refs;
+  std::vector<jthread> threads;
+  for (int i = 0; i < all_threads_count; ++i) {
+    JniLocalRef thread_ref(all_threads.get()[i]);
+    if (threads.size() >= max_threads) {
+      continue;
+    }
 
-int JvmEvalCallStack::InjectFrame(const FrameInfo& frame_info) {
-  MutexLock lock(&data_mu_);
+    string thread_name = GetThreadName(thread_ref.get());
+    if (thread_name.compare(
+            0,
+            thread_name_prefix.size(),
+            thread_name_prefix) != 0) {
+      continue;
+    }
 
-  frames_.push_back(std::unique_ptr<FrameInfo>(new FrameInfo(frame_info)));
-  return frames_.size() - 1;
+    threads.push_back(static_cast<jthread>(thread_ref.get()));
+    thread_refs.push_back(std::move(thread_ref));
+    result->push_back({ std::move(thread_name), 0, { } });
+  }
+
+  if (threads.empty()) {
+    return;
+  }
+
+  // Block JvmtiOnCompiledMethodUnload until all the frames are decoded.
+  const int stripe = BeginJMethodsRead();
+
+  // All the stacks are read at a single safepoint.
+  JvmtiBuffer<jvmtiStackInfo> stack_infos;
+  err = jvmti()->GetThreadListStackTraces(
+      threads.size(),
+      threads.data(),
+      kMaxStackDepth,
+      stack_infos.ref());
+  if (err != JVMTI_ERROR_NONE) {
+    LOG(ERROR) << "Failed to get stack traces of " << threads.size()
+               << " threads, error: " << err;
+    EndJMethodsRead(stripe);
+    result->clear();
+    return;
+  }
+
+  for (int i = 0; i < threads.size(); ++i) {
+    const jvmtiStackInfo& stack_info = stack_infos.get()[i];
+    ThreadStack& thread_stack = (*result)[i];
+
+    thread_stack.state = stack_info.state;
+    thread_stack.frames.reserve(stack_info.frame_count);
+    for (int depth = 0; depth < stack_info.frame_count; ++depth) {
+      thread_stack.frames.push_back(
+          DecodeFrame(stack_info.frame_buffer[depth]));
+    }
+  }
+
+  EndJMethodsRead(stripe);
 }
 
 
 // Note: JNIEnv* is not available through jni() call.
 void JvmEvalCallStack::JvmtiOnCompiledMethodUnload(jmethodID method) {
-  MutexLock jmethods_writer_lock(&jmethods_mu_);
-  MutexLock data_writer_lock(&data_mu_);
+  BeginJMethodsWrite();
+
+  {
+    MutexLock data_writer_lock(&data_mu_);
 
-  method_cache_.erase(method);
+    auto it = method_cache_.find(method);
+    if (it != method_cache_.end()) {
+      RemoveMethodCache(it->second);
+    }
+  }
+
+  EndJMethodsWrite();
 }
 
 
-int JvmEvalCallStack::DecodeFrame(const jvmtiFrameInfo& frame_info) {
+int64 JvmEvalCallStack::total_size() const {
+  MutexLock data_reader_lock(&data_mu_);
+  return total_size_;
+}
+
+
+void JvmEvalCallStack::ReleaseCache() {
+  BeginJMethodsWrite();
+
+  {
+    MutexLock data_writer_lock(&data_mu_);
+
+    while (!lru_.empty()) {
+      RemoveMethodCache(lru_.begin());
+    }
+  }
+
+  EndJMethodsWrite();
+}
+
+
+int JvmEvalCallStack::GetHitRate() const {
+  const int64 hits = hits_.load(std::memory_order_relaxed);
+  const int64 misses = misses_.load(std::memory_order_relaxed);
+
+  if (hits + misses == 0) {
+    return 0;
+  }
+
+  return hits * 100 / (hits + misses);
+}
+
+
+int JvmEvalCallStack::BeginJMethodsRead() {
+  if (g_reader_stripe == -1) {
+    g_reader_stripe = g_next_reader_stripe.fetch_add(1) % kReaderStripes;
+  }
+
+  std::atomic<int>& reader_count = jmethods_readers_[g_reader_stripe].count;
+
+  while (true) {
+    reader_count.fetch_add(1);
+
+    // The writer sets the flag before it checks the reader counters, so
+    // either it sees this reader or this reader sees the flag.
+    if (!is_jmethods_writer_pending_.load()) {
+      return g_reader_stripe;
+    }
+
+    // Step aside and wait for the writer to finish.
+    reader_count.fetch_sub(1);
+
+    MutexLock jmethods_lock(&jmethods_mu_);
+  }
+}
+
+
+void JvmEvalCallStack::EndJMethodsRead(int stripe) {
+  jmethods_readers_[stripe].count.fetch_sub(1);
+}
+
+
+void JvmEvalCallStack::BeginJMethodsWrite() {
+  jmethods_mu_.Lock();
+
+  is_jmethods_writer_pending_.store(true);
+
+  for (int stripe = 0; stripe < kReaderStripes; ++stripe) {
+    while (jmethods_readers_[stripe].count.load() > 0) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+
+void JvmEvalCallStack::EndJMethodsWrite() {
+  is_jmethods_writer_pending_.store(false);
+
+  jmethods_mu_.Unlock();
+}
+
+
+std::shared_ptr<const EvalCallStack::FrameInfo> JvmEvalCallStack::DecodeFrame(
+    const jvmtiFrameInfo& frame_info) {
+  // Unloaded methods only leave the shared cache while no thread reads the
+  // call stack. Evictions might change the epoch under our feet, but they
+  // don't make the frames decoded in the meantime stale.
+  const uint64 epoch = g_frame_cache_epoch.load();
+
+  const uint64 hash =
+      (reinterpret_cast<uintptr_t>(frame_info.method) >> 3) ^
+      (static_cast<uint64>(frame_info.location) * 0x9E3779B97F4A7C15ULL);
+  ThreadFrameCacheSlot& slot =
+      g_thread_frame_cache[(hash ^ (hash >> 32)) & (kThreadFrameCacheSize - 1)];
+
+  if ((slot.epoch == epoch) &&
+      (slot.owner == this) &&
+      (slot.method == frame_info.method) &&
+      (slot.location == frame_info.location)) {
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    statFrameInfoCacheHitRate->add(100);
+    return slot.frame_info;
+  }
+
+  std::shared_ptr<const FrameInfo> fi = LoadFrame(frame_info);
+
+  slot.owner = this;
+  slot.epoch = epoch;
+  slot.method = frame_info.method;
+  slot.location = frame_info.location;
+  slot.frame_info = fi;
+
+  return fi;
+}
+
+
+std::shared_ptr<const EvalCallStack::FrameInfo> JvmEvalCallStack::LoadFrame(
+    const jvmtiFrameInfo& frame_info) {
   MutexLock data_writer_lock(&data_mu_);
 
   // Fetch or load method information.
-  auto in = method_cache_.insert(
-      std::make_pair(frame_info.method, MethodCache()));
-  MethodCache& method_cache = in.first->second;
-  if (in.second) {
+  LruList::iterator it_lru;
+  auto it_method_cache = method_cache_.find(frame_info.method);
+  if (it_method_cache == method_cache_.end()) {
     // The method was not in cache, need to load it.
+    MethodCache method_cache;
+    method_cache.method = frame_info.method;
     LoadMethodCache(frame_info.method, &method_cache);
+
+    MethodUnloadFilter::Add(frame_info.method);
+    it_lru = lru_.insert(lru_.end(), std::move(method_cache));
+    method_cache_[frame_info.method] = it_lru;
+    total_size_ += it_lru->size;
+  } else {
+    // Mark the method as most recently used.
+    it_lru = it_method_cache->second;
+    lru_.splice(lru_.end(), lru_, it_lru);
   }
 
+  MethodCache& method_cache = *it_lru;
+
   // Check whether the current frame location is already in cache.
-  auto it_frames_cache = method_cache.frames_cache.find(frame_info.location);
-  if (it_frames_cache == method_cache.frames_cache.end()) {
-    FrameInfo* fi = new FrameInfo();
-    fi->class_signature = method_cache.class_signature;
-    fi->class_generic = method_cache.class_generic;
-    fi->method_name = method_cache.method_name;
-    fi->source_file_name = method_cache.source_file_name;
-    fi->line_number = GetMethodLocationLineNumber(frame_info);
+  const int index = FindLocationInterval(
+      method_cache.frame_locations.data(),
+      method_cache.frame_locations.size(),
+      frame_info.location);
+  if ((index != -1) &&
+      (method_cache.frame_locations[index] == frame_info.location)) {
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    statFrameInfoCacheHitRate->add(100);
+    return method_cache.frames[index];
+  }
+
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  statFrameInfoCacheHitRate->add(0);
+
+  std::shared_ptr<FrameInfo> fi(new FrameInfo);
+  fi->method = method_cache.method_info;
+  fi->line_number =
+      GetMethodLocationLineNumber(method_cache, frame_info.location);
 
-    frames_.push_back(std::unique_ptr<FrameInfo>(fi));
+  method_cache.frame_locations.insert(
+      method_cache.frame_locations.begin() + index + 1,
+      frame_info.location);
+  method_cache.frames.insert(
+      method_cache.frames.begin() + index + 1,
+      fi);
 
-    const int key = frames_.size() - 1;
+  method_cache.size += kFrameInfoSize;
+  total_size_ += kFrameInfoSize;
 
-    it_frames_cache = method_cache.frames_cache.insert(
-        method_cache.frames_cache.end(),
-        std::make_pair(frame_info.location, key));
+  // Evict least recently used methods (but never the one just used).
+  while ((total_size_ > FLAGS_cdbg_frame_info_cache_max_size) &&
+         (lru_.begin() != it_lru)) {
+    RemoveMethodCache(lru_.begin());
   }
 
-  return it_frames_cache->second;
+  return fi;
+}
+
+
+void JvmEvalCallStack::RemoveMethodCache(LruList::iterator it) {
+  // An evicted method no longer receives "JvmtiOnCompiledMethodUnload", so
+  // the per-thread caches can't keep it either.
+  g_frame_cache_epoch.fetch_add(1);
+
+  total_size_ -= it->size;
+  method_cache_.erase(it->method);
+  MethodUnloadFilter::Remove(it->method);
+  lru_.erase(it);
 }
 
 
@@ -123,6 +421,8 @@ void JvmEvalCallStack::LoadMethodCache(
     MethodCache* method_cache) {
   jvmtiError err = JVMTI_ERROR_NONE;
 
+  std::shared_ptr<MethodInfo> method_info(new MethodInfo);
+
   // Read method name.
   JvmtiBuffer<char> method_name;
   err = jvmti()->GetMethodName(
@@ -131,7 +431,7 @@ void JvmEvalCallStack::LoadMethodCache(
       nullptr,
       nullptr);
   if (err == JVMTI_ERROR_NONE) {
-    method_cache->method_name = method_name.get();
+    method_info->method_name = method_name.get();
   } else {
     LOG(ERROR) << "GetMethodName failed, error: " << err;
   }
@@ -155,10 +455,10 @@ void JvmEvalCallStack::LoadMethodCache(
         class_signature.ref(),
         class_generic.ref());
     if (err == JVMTI_ERROR_NONE) {
-      method_cache->class_signature = class_signature.get();
+      method_info->class_signature = class_signature.get();
 
       if (class_generic.get() != nullptr) {
-        method_cache->class_generic = class_generic.get();
+        method_info->class_generic = class_generic.get();
       }
     } else {
       LOG(ERROR) << "GetClassSignature failed, error: " << err;
@@ -170,65 +470,104 @@ void JvmEvalCallStack::LoadMethodCache(
         method_class,
         source_file_name.ref());
     if (err == JVMTI_ERROR_NONE) {
-      method_cache->source_file_name = source_file_name.get();
+      method_info->source_file_name = source_file_name.get();
     } else if (err == JVMTI_ERROR_ABSENT_INFORMATION) {
       LOG(WARNING) << "Class doesn't have source file debugging information";
     } else if (err != JVMTI_ERROR_NONE) {
       LOG(ERROR) << "GetSourceFileName failed, error: " << err;
     }
   }
+
+  LoadLineNumbers(method, method_cache);
+
+  method_cache->size =
+      kMethodCacheOverhead +
+      method_info->class_signature.size() +
+      method_info->class_generic.size() +
+      method_info->method_name.size() +
+      method_info->source_file_name.size() +
+      method_cache->line_starts.size() * (sizeof(jlocation) + sizeof(jint));
+  method_cache->method_info = std::move(method_info);
 }
 
 
-int JvmEvalCallStack::GetMethodLocationLineNumber(
-    const jvmtiFrameInfo& frame_info) {
+void JvmEvalCallStack::LoadLineNumbers(
+    jmethodID method,
+    MethodCache* method_cache) {
   jvmtiError err = JVMTI_ERROR_NONE;
 
   // Get the line numbers corresponding to the code statements of the method.
   jint line_entires_count = 0;
   JvmtiBuffer<jvmtiLineNumberEntry> line_entries;
   err = jvmti()->GetLineNumberTable(
-      frame_info.method,
+      method,
       &line_entires_count,
       line_entries.ref());
 
   if (err == JVMTI_ERROR_NATIVE_METHOD) {
-    return -1;
+    return;
   }
 
   if (err == JVMTI_ERROR_ABSENT_INFORMATION) {
     LOG(WARNING) << "Class doesn't have line number debugging information";
-    return -1;
+    return;
   }
 
   if (err != JVMTI_ERROR_NONE) {
     LOG(ERROR) << "GetLineNumberTable failed, error: " << err;
-    return -1;
+    return;
   }
 
   if (line_entires_count == 0) {
     LOG(WARNING) << "GetLineNumberTable returned empty set";
-    return -1;
+    return;
   }
 
-  // Find line_entries.start_location that is closest to frame_info.location
-  // from the right side. The line numbers table is not necessarily sorted.
-  const jvmtiLineNumberEntry* frame_entry = std::min_element(
+  // The line numbers table is not necessarily sorted. If multiple entries
+  // start at the same location, the first one wins.
+  std::vector<jvmtiLineNumberEntry> entries(
       line_entries.get(),
-      line_entries.get() + line_entires_count,
-      [&frame_info] (
-          const jvmtiLineNumberEntry& e1,
-          const jvmtiLineNumberEntry& e2) -> bool {
-        // Cast to uint64 to overflow negative numbers.
-        const uint64 diff1 =
-            static_cast<uint64>(frame_info.location - e1.start_location);
-        const uint64 diff2 =
-            static_cast<uint64>(frame_info.location - e2.start_location);
-
-        return diff1 < diff2;
+      line_entries.get() + line_entires_count);
+  std::stable_sort(
+      entries.begin(),
+      entries.end(),
+      [] (const jvmtiLineNumberEntry& e1, const jvmtiLineNumberEntry& e2) {
+        return e1.start_location < e2.start_location;
       });
 
-  return frame_entry->line_number;
+  method_cache->line_starts.reserve(entries.size());
+  method_cache->line_numbers.reserve(entries.size());
+  for (const jvmtiLineNumberEntry& entry : entries) {
+    if (!method_cache->line_starts.empty() &&
+        (method_cache->line_starts.back() == entry.start_location)) {
+      continue;
+    }
+
+    method_cache->line_starts.push_back(entry.start_location);
+    method_cache->line_numbers.push_back(entry.line_number);
+  }
+}
+
+
+int JvmEvalCallStack::GetMethodLocationLineNumber(
+    const MethodCache& method_cache,
+    jlocation location) {
+  if (method_cache.line_starts.empty()) {
+    return -1;
+  }
+
+  // Find the entry with start location that is closest to "location" from
+  // the left side. If "location" precedes all the entries, the closest entry
+  // by unsigned distance is the last one.
+  int index = FindLocationInterval(
+      method_cache.line_starts.data(),
+      method_cache.line_starts.size(),
+      location);
+  if (index == -1) {
+    index = method_cache.line_numbers.size() - 1;
+  }
+
+  return method_cache.line_numbers[index];
 }
 
 
@@ -17,11 +17,14 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_JVM_EVAL_CALL_STACK_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_JVM_EVAL_CALL_STACK_H_
 
-#include <map>
+#include <atomic>
+#include <list>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include "common.h"
 #include "eval_call_stack.h"
+#include "memory_budget.h"
 #include "mutex.h"
 
 namespace devtools {
@@ -32,66 +35,155 @@ namespace cdbg {
 constexpr int kMaxStackDepth = 20;
 
 // Reads call stack using JVMTI methods.
+//
+// Decoded call frames are cached per method. The total memory used by the
+// cache is bounded; least recently used methods are evicted when the budget
+// is exceeded (see "--cdbg_frame_info_cache_max_size"). Evicted "FrameInfo"
+// instances stay alive as long as somebody (e.g. a captured breakpoint
+// waiting to be formatted) references them.
+//
+// Each thread also keeps a small direct mapped cache of the frames it
+// decoded recently, so that parallel captures in different threads decode
+// their call stacks without taking any lock. The thread caches are
+// invalidated (through a global epoch) whenever a method leaves the shared
+// cache, since its jmethodID might get reused after the method is unloaded.
+// Readers of jmethodID pointers don't exclude each other either. They only
+// exclude "JvmtiOnCompiledMethodUnload" and "ReleaseCache".
 class JvmEvalCallStack : public EvalCallStack {
  public:
-  JvmEvalCallStack() { }
-  ~JvmEvalCallStack() override { }
+  JvmEvalCallStack();
 
-  void Read(jthread thread, std::vector<JvmFrame>* result) override;
+  ~JvmEvalCallStack() override;
 
-  const FrameInfo& ResolveCallFrameKey(int key) const override;
+  void Read(jthread thread, std::vector<JvmFrame>* result) override;
 
-  int InjectFrame(const FrameInfo& frame_info) override;
+  void ReadAllThreads(
+      int max_threads,
+      const string& thread_name_prefix,
+      std::vector<ThreadStack>* result) override;
 
   void JvmtiOnCompiledMethodUnload(jmethodID method) override;
 
+  // Gets the estimated memory used by the cache.
+  int64 total_size() const;
+
+  // Removes all the entries from the cache. Called when the agent is over
+  // its memory budget.
+  void ReleaseCache();
+
+  // Gets the percentage of call frames found in cache since the start.
+  int GetHitRate() const;
+
  private:
   // This structure may be released from CompiledMethodUnload. In this case
   // "JNIEnv*" is not going to be available. Therefore this structure must not
   // contain anything that requires "JNIEnv*" in destructor (e.g. "JVariant").
   struct MethodCache {
-    // Signature of the parent class.
-    string class_signature;
+    // Method of this cache entry.
+    jmethodID method;
 
-    // Generic signature of the parent class.
-    string class_generic;
+    // Names of the method shared by all the call frames.
+    std::shared_ptr<const MethodInfo> method_info;
 
-    // Method executing code at the call frame.
-    string method_name;
+    // Start locations of the line number table entries (sorted) and the
+    // corresponding line numbers. Empty if the method has no line numbers.
+    std::vector<jlocation> line_starts;
+    std::vector<jint> line_numbers;
 
-    // Name of the source code file.
-    string source_file_name;
+    // Caches FrameInfo for a given location. "frame_locations" is sorted,
+    // "frames" has the decoded call frame for each location.
+    std::vector<jlocation> frame_locations;
+    std::vector<std::shared_ptr<const FrameInfo>> frames;
 
-    // Caches FrameInfo for a given location.
-    std::map<jlocation, int> frames_cache;
+    // Estimated memory used by this entry.
+    int64 size;
   };
 
-  // Loads information about the call stack frame into the frames cache and
-  // returns call frame key.
-  int DecodeFrame(const jvmtiFrameInfo& frame_info);
+  // Least recently used method is first.
+  typedef std::list<MethodCache> LruList;
+
+  // Reader counter padded to occupy its own cache line.
+  struct ReaderCounter {
+    std::atomic<int> count { 0 };
+    char padding[64 - sizeof(std::atomic<int>)];
+  };
+
+  // Number of reader counters (see "BeginJMethodsRead").
+  static constexpr int kReaderStripes = 16;
+
+  // Announces a thread using jmethodID pointers. Blocks while
+  // "JvmtiOnCompiledMethodUnload" or "ReleaseCache" is in progress. Returns
+  // the reader stripe to pass to "EndJMethodsRead".
+  int BeginJMethodsRead();
+
+  // Ends the read started with "BeginJMethodsRead".
+  void EndJMethodsRead(int stripe);
+
+  // Locks out all readers of jmethodID pointers and waits for the current
+  // ones to finish.
+  void BeginJMethodsWrite();
+
+  // Lets the readers of jmethodID pointers in again.
+  void EndJMethodsWrite();
+
+  // Gets the decoded call frame from the cache of the current thread or
+  // loads it through "LoadFrame".
+  std::shared_ptr<const FrameInfo> DecodeFrame(
+      const jvmtiFrameInfo& frame_info);
+
+  // Loads information about the call stack frame into the frames cache.
+  std::shared_ptr<const FrameInfo> LoadFrame(
+      const jvmtiFrameInfo& frame_info);
 
   // Loads method and class information into MethodCache.
-  void LoadMethodCache(jmethodID method, MethodCache* method_cache);
+  static void LoadMethodCache(jmethodID method, MethodCache* method_cache);
+
+  // Loads the line number table of the method into "MethodCache".
+  static void LoadLineNumbers(jmethodID method, MethodCache* method_cache);
 
   // Locates a line number corresponding to a method location. Returns -1
   // if line information is absent or the specified location doesn't match
   // the line information embedded in the Java .class file.
-  int GetMethodLocationLineNumber(const jvmtiFrameInfo& frame_info);
+  static int GetMethodLocationLineNumber(
+      const MethodCache& method_cache,
+      jlocation location);
+
+  // Removes the entry from the cache.
+  void RemoveMethodCache(LruList::iterator it);
 
  private:
   // Locks access to jmethodID pointers. JVM can unload a method any time.
   // When it does, it calls JvmtiOnCompiledMethodUnload function. After this
   // function returns jmethodID of that method points to a released memory.
+  // Only the writers lock the mutex. Readers announce themselves in
+  // "jmethods_readers_" and only wait on the mutex if a writer is pending.
   mutable Mutex jmethods_mu_;
 
+  // Number of threads currently using jmethodID pointers, striped across
+  // cache lines.
+  ReaderCounter jmethods_readers_[kReaderStripes];
+
+  // Set while a writer waits for the readers or works on the cache.
+  std::atomic<bool> is_jmethods_writer_pending_ { false };
+
   // Locks access to the data structures used in this class.
   mutable Mutex data_mu_;
 
-  // List of resolved call frames. The call frame key is index in this array.
-  std::vector<std::unique_ptr<FrameInfo>> frames_;
+  // Cached information about methods we encountered so far in LRU order.
+  LruList lru_;
+
+  // Index of "lru_" by method.
+  std::unordered_map<jmethodID, LruList::iterator> method_cache_;
+
+  // Estimated memory used by all the entries in "lru_".
+  int64 total_size_ = 0;
+
+  // Registration of this cache in "MemoryBudget".
+  MemoryBudget::Cookie memory_budget_cookie_;
 
-  // Cached information about methods we encountered so far.
-  std::map<jmethodID, MethodCache> method_cache_;
+  // Number of decoded call frames that were found or not found in cache.
+  std::atomic<int64> hits_ { 0 };
+  std::atomic<int64> misses_ { 0 };
 
   DISALLOW_COPY_AND_ASSIGN(JvmEvalCallStack);
 };
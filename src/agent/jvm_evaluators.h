@@ -27,6 +27,7 @@ namespace cdbg {
 class ClassIndexer;
 class ClassMetadataReader;
 class ClassPathLookup;
+class CompiledBreakpointCache;
 class EvalCallStack;
 class MethodLocals;
 class ObjectEvaluator;
@@ -56,8 +57,13 @@ struct JvmEvaluators {
   // Evaluates members of Java objects.
   ObjectEvaluator* object_evaluator = nullptr;
 
-  // Factory for safe method caller.
-  std::function<std::unique_ptr<MethodCaller>(
+  // Shares compiled breakpoint expressions across breakpoints set on the
+  // same location.
+  CompiledBreakpointCache* compiled_breakpoint_cache = nullptr;
+
+  // Factory for safe method caller. The returned instances may be pooled,
+  // so they should be released as soon as the evaluation completes.
+  std::function<MethodCallerPtr(
       Config::MethodCallQuotaType type)> method_caller_factory;
 
   // Factory for a class capturing breakpoint labels. The interface exposes
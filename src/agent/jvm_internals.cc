@@ -75,14 +75,24 @@ bool JvmInternals::LoadInternals() {
     return false;
   }
 
+  Stopwatch stopwatch;
+
   if (!LoadClassLoader(agent_directory)) {
     return false;
   }
 
+  LOG(INFO) << "InternalsClassLoader load time: "
+            << stopwatch.GetElapsedMicros() << " microseconds";
+
+  stopwatch.Reset();
+
   if (!LoadClasses()) {
     return false;
   }
 
+  LOG(INFO) << "Internals classes load time: "
+            << stopwatch.GetElapsedMicros() << " microseconds";
+
   return true;
 }
 
@@ -159,8 +169,7 @@ void JvmInternals::ReleaseRefs() {
   resolved_source_location_.get_class_signature_method = nullptr;
   resolved_source_location_.get_method_name_method = nullptr;
   resolved_source_location_.get_adjusted_line_number_method = nullptr;
-  format_message_.get_format_method = nullptr;
-  format_message_.get_parameters_method = nullptr;
+  format_message_.pack_method = nullptr;
 }
 
 
@@ -494,19 +503,11 @@ bool JvmInternals::LoadClasses() {
     return false;
   }
 
-  format_message_.get_format_method =
-    format_message_.cls.GetInstanceMethod(
-        "getFormat",
-        "()Ljava/lang/String;");
-  if (format_message_.get_format_method == nullptr) {
-    return false;
-  }
-
-  format_message_.get_parameters_method =
+  format_message_.pack_method =
     format_message_.cls.GetInstanceMethod(
-        "getParameters",
+        "pack",
         "()[Ljava/lang/String;");
-  if (format_message_.get_parameters_method == nullptr) {
+  if (format_message_.pack_method == nullptr) {
     return false;
   }
 
@@ -520,42 +521,24 @@ FormatMessageModel JvmInternals::ConvertFormatMessage(
     return INTERNAL_ERROR_MESSAGE;
   }
 
-  JniLocalRef jobj;
-
-  // FormatMessage.getFormat
-  jobj.reset(jni()->CallObjectMethod(
+  // FormatMessage.pack returns the format followed by the parameters, so
+  // that the whole message only takes a single call into Java.
+  JniLocalRef jobj(jni()->CallObjectMethod(
       obj_format_message,
-      format_message_.get_format_method));
-  if (!JniCheckNoException("FormatMessage.getFormat")) {
+      format_message_.pack_method));
+  if (!JniCheckNoException("FormatMessage.pack")) {
     return INTERNAL_ERROR_MESSAGE;
   }
 
-  string format = JniToNativeString(jobj.get());
+  std::vector<string> parameters = JniToNativeStringArray(jobj.get());
 
-  if (format.empty()) {
+  if (parameters.empty() || parameters.front().empty()) {
     LOG(ERROR) << "Empty error message format returned in FormatMessage";
     return INTERNAL_ERROR_MESSAGE;
   }
 
-  // FormatMessage.getParameters
-  jobj.reset(jni()->CallObjectMethod(
-      obj_format_message,
-      format_message_.get_parameters_method));
-  if (!JniCheckNoException("FormatMessage.getParameters")) {
-    return INTERNAL_ERROR_MESSAGE;
-  }
-
-  std::vector<string> parameters;
-  if (jobj != nullptr) {
-    const jsize size = jni()->GetArrayLength(static_cast<jarray>(jobj.get()));
-
-    for (int i = 0; i < size; ++i) {
-      JniLocalRef jstr(jni()->GetObjectArrayElement(
-          static_cast<jobjectArray>(jobj.get()), i));
-
-      parameters.push_back(JniToNativeString(jstr.get()));
-    }
-  }
+  string format = std::move(parameters.front());
+  parameters.erase(parameters.begin());
 
   return { std::move(format), std::move(parameters) };
 }
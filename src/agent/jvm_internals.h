@@ -124,11 +124,8 @@ class JvmInternals : public ClassPathLookup {
     // Class object.
     JavaClass cls;
 
-    // FormatMessage.getFormat method.
-    jmethodID get_format_method { nullptr };
-
-    // FormatMessage.getParameters method.
-    jmethodID get_parameters_method { nullptr };
+    // FormatMessage.pack method.
+    jmethodID pack_method { nullptr };
   } format_message_;
 };
 
@@ -49,12 +49,22 @@ std::unique_ptr<LocalVariableReader> JvmLocalVariableReader::Clone() const {
       new JvmLocalVariableReader(*this));
 }
 
+
 bool JvmLocalVariableReader::ReadValue(
     const EvaluationContext& evaluation_context,
     JVariant* result) const {
+  return ReadSlot(evaluation_context, slot_, signature_.type, result);
+}
+
+
+bool JvmLocalVariableReader::ReadSlot(
+    const EvaluationContext& evaluation_context,
+    jint slot,
+    JType type,
+    JVariant* result) {
   jvmtiError err = JVMTI_ERROR_NONE;
 
-  switch (signature_.type) {
+  switch (type) {
     case JType::Void:
       LOG(ERROR) << "'void' type is unexpected";
       return false;
@@ -68,14 +78,14 @@ bool JvmLocalVariableReader::ReadValue(
       err = jvmti()->GetLocalInt(
           evaluation_context.thread,
           evaluation_context.frame_depth,
-          slot_,
+          slot,
           &value);
       if (err != JVMTI_ERROR_NONE) {
         LOG(ERROR) << "GetLocalInt failed, error: " << err;
         return false;
       }
 
-      switch (signature_.type) {
+      switch (type) {
         case JType::Boolean:
           *result = JVariant::Boolean(static_cast<jboolean>(value));
           return true;
@@ -106,7 +116,7 @@ bool JvmLocalVariableReader::ReadValue(
       err = jvmti()->GetLocalLong(
           evaluation_context.thread,
           evaluation_context.frame_depth,
-          slot_,
+          slot,
           &value);
       if (err != JVMTI_ERROR_NONE) {
         LOG(ERROR) << "GetLocalLong failed, error: " << err;
@@ -122,7 +132,7 @@ bool JvmLocalVariableReader::ReadValue(
       err = jvmti()->GetLocalFloat(
           evaluation_context.thread,
           evaluation_context.frame_depth,
-          slot_,
+          slot,
           &value);
       if (err != JVMTI_ERROR_NONE) {
         LOG(ERROR) << "GetLocalFloat failed, error: " << err;
@@ -138,7 +148,7 @@ bool JvmLocalVariableReader::ReadValue(
       err = jvmti()->GetLocalDouble(
           evaluation_context.thread,
           evaluation_context.frame_depth,
-          slot_,
+          slot,
           &value);
       if (err != JVMTI_ERROR_NONE) {
         LOG(ERROR) << "GetLocalDouble failed, error: " << err;
@@ -154,7 +164,7 @@ bool JvmLocalVariableReader::ReadValue(
       err = jvmti()->GetLocalObject(
           evaluation_context.thread,
           evaluation_context.frame_depth,
-          slot_,
+          slot,
           &local_ref);
       if (err != JVMTI_ERROR_NONE) {
         LOG(ERROR) << "GetLocalObject failed, error: " << err;
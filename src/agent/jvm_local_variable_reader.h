@@ -53,6 +53,16 @@ class JvmLocalVariableReader : public LocalVariableReader {
 
   bool IsDefinedAtLocation(jlocation location) const override;
 
+  // Reads the value of the local variable of type "type" in "slot" of the
+  // frame selected by "evaluation_context". Used directly by the read plan
+  // of "MethodLocals::Entry", so that capturing a frame doesn't go through
+  // the reader instances.
+  static bool ReadSlot(
+      const EvaluationContext& evaluation_context,
+      jint slot,
+      JType type,
+      JVariant* result);
+
  private:
   // Distinguishes between local variable and a method argument.
   const bool is_argument_;
@@ -59,7 +59,6 @@ class JvmObjectArrayReader : public ArrayReader {
       return MethodCallResult::PendingJniException().format_exception();
     }
 
-    result.change_ref_type(JVariant::ReferenceKind::Global);
     return std::move(result);
   }
 };
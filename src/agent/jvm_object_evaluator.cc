@@ -18,12 +18,14 @@
 
 #include "array_type_evaluator.h"
 #include "config.h"
+#include "field_path_type_evaluator.h"
 #include "generic_type_evaluator.h"
 #include "iterable_type_evaluator.h"
 #include "map_type_evaluator.h"
 #include "map_entry_type_evaluator.h"
 #include "messages.h"
 #include "model.h"
+#include "protobuf_type_evaluator.h"
 #include "safe_method_caller.h"
 #include "value_formatter.h"
 
@@ -98,6 +100,10 @@ void JvmObjectEvaluator::Initialize() {
   if (!map_->Initialize()) {
     map_ = nullptr;  // This pretty printer will not be available.
   }
+
+  protobuf_.reset(new ProtobufTypeEvaluator);
+
+  field_path_ = FieldPathTypeEvaluator::CreateFromFlags(class_metadata_reader_);
 }
 
 
@@ -123,8 +129,7 @@ void JvmObjectEvaluator::Evaluate(
   const ClassMetadataReader::Entry& metadata =
       class_metadata_reader_->GetClassMetadata(static_cast<jclass>(cls.get()));
 
-  const WellKnownJClass obj_well_known_jclass =
-      WellKnownJClassFromSignature(metadata.signature);
+  const WellKnownJClass obj_well_known_jclass = metadata.well_known_jclass;
 
   // Special treatment for Java strings. Usually Java strings will be formatted
   // as a value type based on the compile time signature of a variable. If,
@@ -133,21 +138,30 @@ void JvmObjectEvaluator::Evaluate(
   //     Object objString = "hippopotamus";
   // This scenario is very likely with generics where the compile time type of
   // class fields will be Object if no type constraints are specified.
-  if (ValueFormatter::IsImmutableValueObject(
-        WellKnownJClassFromSignature(metadata.signature))) {
+  if (ValueFormatter::IsImmutableValueObject(obj_well_known_jclass)) {
     *members = std::vector<NamedJVariant>(1);
     NamedJVariant& entry = (*members)[0];
 
     entry.name.clear();  // Keep name empty to indicate it's not really a field.
-    entry.value.assign_new_ref(JVariant::ReferenceKind::Global, obj);
+    entry.value.assign_new_ref(JVariant::ReferenceKind::Local, obj);
     entry.well_known_jclass = obj_well_known_jclass;
 
     return;
   }
 
-  TypeEvaluator* evaluator = SelectEvaluator(
-      static_cast<jclass>(cls.get()),
-      metadata);
+  // Reuse the evaluator selected for the previous objects of this class.
+  TypeEvaluator* evaluator = nullptr;
+  if (metadata.type_evaluator != nullptr) {
+    evaluator = metadata.type_evaluator->load(std::memory_order_acquire);
+  }
+
+  if (evaluator == nullptr) {
+    evaluator = SelectEvaluator(static_cast<jclass>(cls.get()), metadata);
+    if ((evaluator != nullptr) && (metadata.type_evaluator != nullptr)) {
+      metadata.type_evaluator->store(evaluator, std::memory_order_release);
+    }
+  }
+
   if (evaluator == nullptr) {
     // Should never happen. Failure of "SelectEvaluator" indicates some bug in
     // this class.
@@ -170,8 +184,7 @@ void JvmObjectEvaluator::Evaluate(
 TypeEvaluator* JvmObjectEvaluator::SelectEvaluator(
     jclass cls,
     const ClassMetadataReader::Entry& metadata) const {
-  const WellKnownJClass obj_well_known_jclass =
-      WellKnownJClassFromSignature(metadata.signature);
+  const WellKnownJClass obj_well_known_jclass = metadata.well_known_jclass;
 
   // Java array object.
   if (obj_well_known_jclass == WellKnownJClass::Array) {
@@ -188,6 +201,17 @@ TypeEvaluator* JvmObjectEvaluator::SelectEvaluator(
     return array_[i].get();
   }
 
+  // User configured pretty printers take precedence over the built-in ones.
+  auto it_field_path = field_path_.find(metadata.signature.object_signature);
+  if (it_field_path != field_path_.end()) {
+    return it_field_path->second.get();
+  }
+
+  // Pretty printer for generated protocol buffer messages.
+  if (protobuf_->IsProtobufMessage(cls)) {
+    return protobuf_.get();
+  }
+
   // Pretty printer for maps.
   if ((map_ != nullptr) && map_->IsMap(cls)) {
     return map_.get();
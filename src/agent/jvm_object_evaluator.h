@@ -17,6 +17,7 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_JVM_OBJECT_EVALUATOR_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_JVM_OBJECT_EVALUATOR_H_
 
+#include <map>
 #include "class_indexer.h"
 #include "class_metadata_reader.h"
 #include "common.h"
@@ -28,9 +29,11 @@ namespace devtools {
 namespace cdbg {
 
 class ClassMetadataReader;
+class FieldPathTypeEvaluator;
 class IterableTypeEvaluator;
 class MapEntryTypeEvaluator;
 class MapTypeEvaluator;
+class ProtobufTypeEvaluator;
 class TypeEvaluator;
 
 class JvmObjectEvaluator : public ObjectEvaluator {
@@ -41,6 +44,9 @@ class JvmObjectEvaluator : public ObjectEvaluator {
 
   ~JvmObjectEvaluator() override;
 
+  // Creates the type evaluators. Must be called once, before any objects
+  // are evaluated: the selected evaluators are cached in the entries of
+  // "class_metadata_reader".
   void Initialize();
 
   void Evaluate(
@@ -66,6 +72,10 @@ class JvmObjectEvaluator : public ObjectEvaluator {
   std::unique_ptr<IterableTypeEvaluator> iterable_;
   std::unique_ptr<MapEntryTypeEvaluator> map_entry_;
   std::unique_ptr<MapTypeEvaluator> map_;
+  std::unique_ptr<ProtobufTypeEvaluator> protobuf_;
+
+  // User configured pretty printers keyed by class signature.
+  std::map<string, std::unique_ptr<FieldPathTypeEvaluator>> field_path_;
 
   DISALLOW_COPY_AND_ASSIGN(JvmObjectEvaluator);
 };
@@ -68,6 +68,37 @@ string JvmReadersFactory::GetEvaluationPointClassName() {
 }
 
 
+jobject JvmReadersFactory::GetEvaluationPointClassLoader() {
+  if (is_class_loader_loaded_) {
+    return class_loader_.get();
+  }
+
+  is_class_loader_loaded_ = true;
+
+  jvmtiError err = JVMTI_ERROR_NONE;
+
+  jclass cls = nullptr;
+  err = jvmti()->GetMethodDeclaringClass(method_, &cls);
+  if (err != JVMTI_ERROR_NONE) {
+    LOG(ERROR) << "GetMethodDeclaringClass failed, error: " << err;
+    return nullptr;
+  }
+
+  JniLocalRef auto_cls(cls);
+
+  jobject class_loader = nullptr;
+  err = jvmti()->GetClassLoader(cls, &class_loader);
+  if (err != JVMTI_ERROR_NONE) {
+    LOG(ERROR) << "GetClassLoader failed, error: " << err;
+    return nullptr;
+  }
+
+  class_loader_.reset(class_loader);
+
+  return class_loader_.get();
+}
+
+
 JniLocalRef JvmReadersFactory::FindClassByName(
     const string& class_name,
     FormatMessageModel* error_message) {
@@ -78,7 +109,9 @@ JniLocalRef JvmReadersFactory::FindClassByName(
 
   // Case 1: class name is fully qualified (i.e. includes the package name)
   // and has been already loaded by the JVM.
-  cls = class_indexer->FindClassByName(class_name);
+  cls = class_indexer->FindClassByName(
+      class_name,
+      GetEvaluationPointClassLoader());
   if (cls != nullptr) {
     return cls;
   }
@@ -95,7 +128,8 @@ JniLocalRef JvmReadersFactory::FindClassByName(
   size_t name_pos = current_class_name.find_last_of('.');
   if ((name_pos > 0) && (name_pos != string::npos)) {
     cls = class_indexer->FindClassByName(
-        current_class_name.substr(0, name_pos + 1) + class_name);
+        current_class_name.substr(0, name_pos + 1) + class_name,
+        GetEvaluationPointClassLoader());
     if (cls != nullptr) {
       return cls;
     }
@@ -114,7 +148,9 @@ JniLocalRef JvmReadersFactory::FindClassByName(
       return nullptr;
 
     case 1:
-      cls = class_indexer->FindClassBySignature(candidates[0]);
+      cls = class_indexer->FindClassBySignature(
+          candidates[0],
+          GetEvaluationPointClassLoader());
       if (cls != nullptr) {
         return cls;
       }
@@ -176,13 +212,17 @@ bool JvmReadersFactory::IsAssignable(
   }
 
   // Get the class object corresponding to "from_signature".
-  JniLocalRef from_cls = class_indexer->FindClassBySignature(from_signature);
+  JniLocalRef from_cls = class_indexer->FindClassBySignature(
+      from_signature,
+      GetEvaluationPointClassLoader());
   if (from_cls == nullptr) {
     return false;
   }
 
   // Get the class object corresponding to "to_signature".
-  JniLocalRef to_cls = class_indexer->FindClassBySignature(to_signature);
+  JniLocalRef to_cls = class_indexer->FindClassBySignature(
+      to_signature,
+      GetEvaluationPointClassLoader());
   if (to_cls == nullptr) {
     return false;
   }
@@ -200,9 +240,9 @@ JvmReadersFactory::CreateLocalVariableReader(
   std::shared_ptr<const MethodLocals::Entry> method =
       evaluators_->method_locals->GetLocalVariables(method_);
 
-  for (const std::unique_ptr<LocalVariableReader>& local : method->locals) {
-    if (local->IsDefinedAtLocation(location_) &&
-        (variable_name == local->GetName())) {
+  for (int index : method->FindLocals(location_)) {
+    const std::unique_ptr<LocalVariableReader>& local = method->locals[index];
+    if (variable_name == local->GetName()) {
       return local->Clone();
     }
   }
@@ -229,8 +269,9 @@ JvmReadersFactory::CreateInstanceFieldReader(
     const string& class_signature,
     const string& field_name,
     FormatMessageModel* error_message) {
-  JniLocalRef cls =
-      evaluators_->class_indexer->FindClassBySignature(class_signature);
+  JniLocalRef cls = evaluators_->class_indexer->FindClassBySignature(
+      class_signature,
+      GetEvaluationPointClassLoader());
   if (cls == nullptr) {
     // JVM does not defer loading field types, so it should never happen.
     LOG(WARNING) << "Class not found: " << class_signature;
@@ -343,8 +384,9 @@ std::vector<ClassMetadataReader::Method>
 JvmReadersFactory::FindInstanceMethods(
     const string& class_signature,
     const string& method_name) {
-  JniLocalRef cls =
-      evaluators_->class_indexer->FindClassBySignature(class_signature);
+  JniLocalRef cls = evaluators_->class_indexer->FindClassBySignature(
+      class_signature,
+      GetEvaluationPointClassLoader());
   if (cls == nullptr) {
     LOG(ERROR) << "Local instance class not found: " << class_signature;
     return {};
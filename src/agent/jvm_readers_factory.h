@@ -90,6 +90,12 @@ class JvmReadersFactory : public ReadersFactory {
       const JSignature& array_signature) override;
 
  private:
+  // Gets the class loader of the class declaring "method_" (nullptr for the
+  // bootstrap class loader). Classes loaded by this class loader are
+  // preferred when resolving names, since application servers load the
+  // same classes in many class loaders.
+  jobject GetEvaluationPointClassLoader();
+
   // Common code for the two public versions of "CreateStaticFieldReader".
   std::unique_ptr<StaticFieldReader> CreateStaticFieldReader(
       jclass cls,
@@ -112,6 +118,10 @@ class JvmReadersFactory : public ReadersFactory {
   // variables.
   const jlocation location_;
 
+  // Cached result of "GetEvaluationPointClassLoader".
+  bool is_class_loader_loaded_ { false };
+  JniLocalRef class_loader_;
+
   DISALLOW_COPY_AND_ASSIGN(JvmReadersFactory);
 };
 
@@ -25,11 +25,13 @@ JvmStaticFieldReader::JvmStaticFieldReader(
     jclass cls,
     const string& name,
     jfieldID field_id,
-    const JSignature& signature)
+    const JSignature& signature,
+    bool is_final)
     : cls_(static_cast<jclass>(jni()->NewGlobalRef(cls))),
       name_(name),
       signature_(signature),
-      field_id_(field_id) {
+      field_id_(field_id),
+      is_final_(is_final) {
 }
 
 
@@ -39,7 +41,8 @@ JvmStaticFieldReader::JvmStaticFieldReader(
           jni()->NewGlobalRef(jvm_static_field_reader.cls_))),
       name_(jvm_static_field_reader.name_),
       signature_(jvm_static_field_reader.signature_),
-      field_id_(jvm_static_field_reader.field_id_) {
+      field_id_(jvm_static_field_reader.field_id_),
+      is_final_(jvm_static_field_reader.is_final_) {
 }
 
 
@@ -124,6 +127,32 @@ bool JvmStaticFieldReader::ReadValue(JVariant* result) const {
   return false;
 }
 
+
+
+bool JvmStaticFieldReader::ReadConstantValue(JVariant* result) const {
+  if (!is_final_ ||
+      (cls_ == nullptr) ||
+      (signature_.type == JType::Void) ||
+      (signature_.type == JType::Object)) {
+    return false;
+  }
+
+  // Until the static initializer completes, the field may still hold the
+  // default value.
+  jint class_status = 0;
+  jvmtiError err = jvmti()->GetClassStatus(cls_, &class_status);
+  if (err != JVMTI_ERROR_NONE) {
+    LOG(ERROR) << "GetClassStatus failed, error: " << err;
+    return false;
+  }
+
+  if ((class_status & JVMTI_CLASS_STATUS_INITIALIZED) == 0) {
+    return false;
+  }
+
+  return ReadValue(result);
+}
+
 }  // namespace cdbg
 }  // namespace devtools
 
@@ -30,7 +30,8 @@ class JvmStaticFieldReader : public StaticFieldReader {
       jclass cls,
       const string& name,
       jfieldID field_id,
-      const JSignature& signature);
+      const JSignature& signature,
+      bool is_final);
 
   JvmStaticFieldReader(
       const JvmStaticFieldReader& jvm_static_field_reader);
@@ -47,6 +48,8 @@ class JvmStaticFieldReader : public StaticFieldReader {
 
   bool ReadValue(JVariant* result) const override;
 
+  bool ReadConstantValue(JVariant* result) const override;
+
  private:
   // Global reference to Java class object to which the static field belongs.
   jclass cls_;
@@ -60,6 +63,9 @@ class JvmStaticFieldReader : public StaticFieldReader {
   // JVMTI specific field ID. The value of "jfieldID" remains valid as long as
   // the class containing this field is loaded.
   const jfieldID field_id_;
+
+  // True if the field is declared as "final".
+  const bool is_final_;
 };
 
 }  // namespace cdbg
@@ -16,21 +16,36 @@
 
 #include "jvmti_agent.h"
 
+#include <sys/stat.h>
+
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <limits>
 #include <sstream>
 
 #include "callbacks_monitor.h"
 #include "auto_reset_event.h"
 #include "bridge.h"
+#include "compiled_method_filter.h"
 #include "config_builder.h"
+#include "fast_clock.h"
+#include "jni_agent_events.h"
 #include "jni_breakpoint_labels_provider.h"
-#include "jni_semaphore.h"
 #include "jvm_class_metadata_reader.h"
 #include "jvm_eval_call_stack.h"
 #include "jvmti_agent_thread.h"
 #include "jvmti_buffer.h"
+#include "memory_budget.h"
 #include "method_locals.h"
+#include "method_unload_filter.h"
+#include "native_semaphore.h"
+#include "object_tags.h"
+#include "rate_limit.h"
+#include "retained_class_files.h"
 #include "stopwatch.h"
+#include "trace_recorder.h"
+#include "jni_proxy_agentevents.h"
 #include "jni_proxy_breakpointlabelsprovider.h"
 #include "jni_proxy_classpathlookup.h"
 #include "jni_proxy_dynamicloghelper.h"
@@ -42,6 +57,44 @@ DEFINE_string(
     "",
     "additional directories and files containing resolvable binaries");
 
+DEFINE_bool(
+    defer_jvmti_debugger_capabilities,
+    false,
+    "if true, JVMTI capabilities that degrade JIT compiled code (breakpoint "
+    "events and access to local variables) are only requested when the "
+    "first breakpoint arrives rather than at startup; breakpoints will fail "
+    "if the JVM doesn't support adding these capabilities in the live phase");
+
+DEFINE_bool(
+    cdbg_keep_debugger_warm,
+    false,
+    "if true, disabling the debugger only removes the breakpoints; the class "
+    "index and the caches are kept up to date (at the cost of indexing "
+    "newly loaded classes) so that enabling the debugger again is fast");
+
+DEFINE_bool(
+    cdbg_cache_breakpoint_labels,
+    true,
+    "if true, breakpoint labels are computed once and refreshed when the "
+    "agent is idle rather than computed through JNI on every capture");
+
+DEFINE_bool(
+    cdbg_jfr_events,
+    false,
+    "if true, the agent work (breakpoint hits, condition evaluation, "
+    "capture, class prepare handling, etc.) is emitted as Java Flight "
+    "Recorder events when JFR is available in the JVM");
+
+DEFINE_string(
+    cdbg_config_file,
+    "",
+    "if set, the agent reapplies the flags in this file (one \"name=value\" "
+    "per line) whenever it changes and rebuilds the safe caller "
+    "configuration (method rules and quotas) without restarting; method "
+    "calls already in progress complete with the previous configuration");
+
+DECLARE_string(locals_capture_frames);
+
 
 using google::SetCommandLineOption;
 
@@ -102,6 +155,7 @@ JvmtiAgent::JvmtiAgent(
       eval_call_stack_(std::move(eval_call_stack)),
       fn_loaders_(std::move(fn_loaders)),
       breakpoint_labels_provider_factory_(breakpoint_labels_provider_factory),
+      breakpoint_labels_cache_(breakpoint_labels_provider_factory),
       enable_capabilities_(enable_capabilities),
       enable_jvmti_events_(enable_jvmti_events),
       scheduler_(Scheduler<>::DefaultClock),
@@ -109,18 +163,30 @@ JvmtiAgent::JvmtiAgent(
           this,
           [this] () {
             return std::unique_ptr<AutoResetEvent>(new AutoResetEvent(
-                std::unique_ptr<Semaphore>(new JniSemaphore)));
+                std::unique_ptr<Semaphore>(new NativeSemaphore)));
           },
           [this] () {
             return std::unique_ptr<AgentThread>(new JvmtiAgentThread);
           },
           internals_,
           std::move(bridge),
-          &format_queue_) {
+          &format_queue_,
+          &dynamic_log_queue_) {
+  // The activation thread sleeps until the next scheduled callback.
+  scheduler_.SetWakeUp([this] () { worker_.RequestScheduledCallbacks(); });
+
+  agent_status_cookie_ = AgentStatus::GetInstance()->Register(
+      "format queue",
+      [this] (std::ostream* os) {
+        *os << "size: " << format_queue_.GetSize() << '\n'
+            << "dropped: " << format_queue_.GetDroppedItemsCount() << '\n';
+      });
 }
 
 
 JvmtiAgent::~JvmtiAgent() {
+  AgentStatus::GetInstance()->Unregister(agent_status_cookie_);
+
   // Assert no unhealthy callbacks occurred throughout the debuglet lifetime.
   LOG_IF(WARNING, !CallbacksMonitor::GetInstance()->IsHealthy(0))
       << "Unhealthy callbacks occurred during debuglet lifetime";
@@ -157,25 +223,46 @@ bool JvmtiAgent::OnLoad() {
   InitializeFlagsFromSystemProperties();
 
   // Generate debugger configuration.
-  config_ = DefaultConfig();
+  ReloadConfigFile();
+  if (config_.Get() == nullptr) {
+    config_.Set(DefaultConfig());
+  }
 
   if (enable_capabilities_) {
     // Request capabilities. Without the right capabilities APIs like
     // SetBreakpoint will fail with error code 99.
     jvmtiCapabilities jvmti_capabilities;
     memset(&jvmti_capabilities, 0, sizeof(jvmti_capabilities));
-    jvmti_capabilities.can_generate_breakpoint_events = true;
     jvmti_capabilities.can_maintain_original_method_order = true;
     jvmti_capabilities.can_get_line_numbers = true;
-    jvmti_capabilities.can_access_local_variables = true;
     jvmti_capabilities.can_get_source_file_name = true;
     jvmti_capabilities.can_generate_compiled_method_load_events = true;
+    RequestObjectTaggingCapability(&jvmti_capabilities);
+    if (!FLAGS_defer_jvmti_debugger_capabilities) {
+      SetDebuggerCapabilities(&jvmti_capabilities);
+    }
+
+    // GC events are only used to discard condition cost samples that include
+    // a GC pause. Don't fail "AddCapabilities" if the JVM can't provide them.
+    jvmtiCapabilities potential_capabilities;
+    memset(&potential_capabilities, 0, sizeof(potential_capabilities));
+    if ((jvmti()->GetPotentialCapabilities(&potential_capabilities) ==
+         JVMTI_ERROR_NONE) &&
+        potential_capabilities.can_generate_garbage_collection_events) {
+      jvmti_capabilities.can_generate_garbage_collection_events = true;
+    }
+
     err = jvmti()->AddCapabilities(&jvmti_capabilities);
     if (err != JVMTI_ERROR_NONE) {
       LOG(ERROR) << "AddCapabilities failed, error: " << err;
       // The best we can do here is to continue. We don't want to fail Java
       // process loading just because there was some problem with debugger.
+    } else {
+      EnableObjectTagging();
+      has_debugger_capabilities_ = !FLAGS_defer_jvmti_debugger_capabilities;
     }
+
+    LogCapabilities();
   }
 
   // Enable unconditional event callbacks (we need these whether debugger is
@@ -184,6 +271,14 @@ bool JvmtiAgent::OnLoad() {
       JVMTI_ENABLE,
       { JVMTI_EVENT_VM_INIT, JVMTI_EVENT_VM_DEATH });
 
+  // Class files have to be retained from the very beginning, before the
+  // debugger is enabled.
+  if (InitializeRetainedClassFiles()) {
+    EnableJvmtiNotifications(
+        JVMTI_ENABLE,
+        { JVMTI_EVENT_CLASS_FILE_LOAD_HOOK });
+  }
+
   LOG(INFO) << "Java debuglet initialization completed";
 
   return true;
@@ -218,12 +313,21 @@ void JvmtiAgent::JvmtiOnVMDeath() {
   // Stop the worker threads.
   worker_.Shutdown();
 
+  // No more spans are flushed after the worker threads stopped.
+  if (agent_events_ != nullptr) {
+    SetTraceSpanSink(nullptr);
+    agent_events_ = nullptr;
+  }
+
   // Disable the debugger. This cleans up all breakpoints.
   EnableDebugger(false);
+  ReleaseWarmDebugger();
+  ReleaseRetiredDebuggers();
 
   // Release all pending breakpoint updates. They are never going to be sent
   // anyway...
   format_queue_.RemoveAll();
+  dynamic_log_queue_.RemoveAll();
 
   CleanupSystemClasses();
 
@@ -240,10 +344,38 @@ void JvmtiAgent::JvmtiOnClassLoad(jthread thread, jclass cls) {
 }
 
 
+void JvmtiAgent::JvmtiOnClassFileLoadHook(
+    jclass class_being_redefined,
+    jobject loader,
+    const char* name,
+    jint class_data_len,
+    const unsigned char* class_data) {
+  ScopedMonitoredCall monitored_call("JVMTI:ClassFileLoadHook");
+
+  // Redefined classes are ignored: the retained class file has to match
+  // the original class file that "ClassPathLookup" would return.
+  if (class_being_redefined != nullptr) {
+    return;
+  }
+
+  RetainedClassFiles* retained_class_files = GetRetainedClassFiles();
+  if (retained_class_files != nullptr) {
+    retained_class_files->JvmtiOnClassFileLoadHook(
+        loader,
+        name,
+        class_data,
+        class_data_len);
+  }
+}
+
+
 void JvmtiAgent::JvmtiOnClassPrepare(jthread thread, jclass cls) {
   ScopedMonitoredCall monitored_call("JVMTI:ClassPrepare");
 
   std::shared_ptr<Debugger> debugger = debugger_;
+  if (debugger == nullptr) {
+    debugger = warm_debugger_;
+  }
 
   if (debugger != nullptr) {
     debugger->JvmtiOnClassPrepare(thread, cls);
@@ -258,16 +390,29 @@ void JvmtiAgent::JvmtiOnCompiledMethodLoad(
     jint map_length,
     const jvmtiAddrLocationMap* map,
     const void* compile_info) {
-  // ScopedMonitoredCall monitored_call("JVMTI:CompiledMethodLoad");
+  // The event is only enabled with --locals_capture_frames=interpreted.
+  CompiledMethodFilter::Add(method);
 }
 
 
 void JvmtiAgent::JvmtiOnCompiledMethodUnload(
     jmethodID method,
     const void* code_addr) {
+  if (FLAGS_locals_capture_frames == "interpreted") {
+    CompiledMethodFilter::Remove(method);
+  }
+
+  // Most of the unloaded methods were never seen by the debugger.
+  if (!MethodUnloadFilter::MayContain(method)) {
+    return;
+  }
+
   ScopedMonitoredCall monitored_call("JVMTI:CompiledMethodUnload");
 
   std::shared_ptr<Debugger> debugger = debugger_;
+  if (debugger == nullptr) {
+    debugger = warm_debugger_;
+  }
 
   if (debugger != nullptr) {
     debugger->JvmtiOnCompiledMethodUnload(method, code_addr);
@@ -279,16 +424,17 @@ void JvmtiAgent::JvmtiOnBreakpoint(
     jthread thread,
     jmethodID method,
     jlocation location) {
-  ScopedMonitoredCall monitored_call("JVMTI:Breakpoint");
-
   // Ignore breakpoint events from debugger worker threads. Debugging
   // the debugger may cause deadlock.
   if (JvmtiAgentThread::IsInAgentThread()) {
     return;
   }
 
-  std::shared_ptr<Debugger> debugger = debugger_;
+  // In the steady state this is a couple of plain stores into the slot
+  // owned by this thread and a single load of the debugger pointer.
+  ScopedHotMonitoredCall monitored_call("JVMTI:Breakpoint");
 
+  Debugger* debugger = hot_debugger_.load(std::memory_order_acquire);
   if (debugger != nullptr) {
     debugger->JvmtiOnBreakpoint(thread, method, location);
   }
@@ -321,21 +467,150 @@ void JvmtiAgent::EnableJvmtiDebuggerNotifications(jvmtiEventMode mode) {
       {
         JVMTI_EVENT_CLASS_PREPARE,
         JVMTI_EVENT_COMPILED_METHOD_UNLOAD,
-        JVMTI_EVENT_BREAKPOINT
+        JVMTI_EVENT_GARBAGE_COLLECTION_START,
+        JVMTI_EVENT_GARBAGE_COLLECTION_FINISH
       });
+
+  // Track the methods that have compiled code so that the capture can skip
+  // local variables of compiled frames (reading them deoptimizes the frame).
+  // The JVM replays the load events of the methods compiled so far.
+  if (FLAGS_locals_capture_frames == "interpreted") {
+    if (mode == JVMTI_ENABLE) {
+      CompiledMethodFilter::Clear();
+    }
+
+    EnableJvmtiNotifications(mode, { JVMTI_EVENT_COMPILED_METHOD_LOAD });
+
+    if ((mode == JVMTI_ENABLE) && enable_jvmti_events_) {
+      jvmtiError err =
+          jvmti()->GenerateEvents(JVMTI_EVENT_COMPILED_METHOD_LOAD);
+      if (err != JVMTI_ERROR_NONE) {
+        LOG(ERROR) << "GenerateEvents(COMPILED_METHOD_LOAD) failed, error: "
+                   << err;
+      }
+    }
+  }
+
+  // Breakpoint events can't be enabled before the capability is acquired
+  // (see "AcquireDebuggerCapabilities").
+  if (has_debugger_capabilities_ || !enable_capabilities_) {
+    EnableJvmtiNotifications(mode, { JVMTI_EVENT_BREAKPOINT });
+  }
 }
 
 
-bool JvmtiAgent::OnWorkerReady() {
-  // Connect to Java internals implementation.
-{
-    if (!internals_->LoadInternals()) {
-      LOG(ERROR) << "Internals could not be initialized";
-      return false;
+void JvmtiAgent::SetDebuggerCapabilities(jvmtiCapabilities* capabilities) {
+  capabilities->can_generate_breakpoint_events = true;
+  capabilities->can_access_local_variables = true;
+}
+
+
+void JvmtiAgent::AcquireDebuggerCapabilities() {
+  if (!enable_capabilities_ ||
+      has_debugger_capabilities_ ||
+      debugger_capabilities_unavailable_) {
+    return;
+  }
+
+  LOG(INFO) << "Acquiring deferred JVMTI debugger capabilities";
+
+  jvmtiCapabilities potential_capabilities;
+  memset(&potential_capabilities, 0, sizeof(potential_capabilities));
+  jvmtiError err = jvmti()->GetPotentialCapabilities(&potential_capabilities);
+  if (err != JVMTI_ERROR_NONE) {
+    LOG(ERROR) << "GetPotentialCapabilities failed, error: " << err;
+    debugger_capabilities_unavailable_ = true;
+    return;
+  }
+
+  if (!potential_capabilities.can_generate_breakpoint_events ||
+      !potential_capabilities.can_access_local_variables) {
+    LOG(ERROR) << "JVM can't add debugger capabilities in the live phase, "
+                  "restart without --defer_jvmti_debugger_capabilities";
+    debugger_capabilities_unavailable_ = true;
+    return;
+  }
+
+  jvmtiCapabilities jvmti_capabilities;
+  memset(&jvmti_capabilities, 0, sizeof(jvmti_capabilities));
+  SetDebuggerCapabilities(&jvmti_capabilities);
+
+  err = jvmti()->AddCapabilities(&jvmti_capabilities);
+  if (err != JVMTI_ERROR_NONE) {
+    LOG(ERROR) << "AddCapabilities failed, error: " << err;
+    debugger_capabilities_unavailable_ = true;
+    return;
+  }
+
+  has_debugger_capabilities_ = true;
+
+  // The debugger is already attached, but breakpoint events couldn't be
+  // enabled without the capability.
+  if (debugger_ != nullptr) {
+    EnableJvmtiNotifications(JVMTI_ENABLE, { JVMTI_EVENT_BREAKPOINT });
+  }
+
+  LogCapabilities();
+}
+
+
+void JvmtiAgent::LogCapabilities() {
+  jvmtiCapabilities capabilities;
+  memset(&capabilities, 0, sizeof(capabilities));
+  jvmtiError err = jvmti()->GetCapabilities(&capabilities);
+  if (err != JVMTI_ERROR_NONE) {
+    LOG(ERROR) << "GetCapabilities failed, error: " << err;
+    return;
+  }
+
+  const struct {
+    const char* name;
+    unsigned int is_held;
+  } capabilities_list[] = {
+    { "can_generate_breakpoint_events",
+      capabilities.can_generate_breakpoint_events },
+    { "can_access_local_variables",
+      capabilities.can_access_local_variables },
+    { "can_maintain_original_method_order",
+      capabilities.can_maintain_original_method_order },
+    { "can_get_line_numbers", capabilities.can_get_line_numbers },
+    { "can_get_source_file_name", capabilities.can_get_source_file_name },
+    { "can_generate_compiled_method_load_events",
+      capabilities.can_generate_compiled_method_load_events },
+    { "can_tag_objects", capabilities.can_tag_objects },
+    { "can_generate_garbage_collection_events",
+      capabilities.can_generate_garbage_collection_events }
+  };
+
+  std::ostringstream names;
+  for (const auto& capability : capabilities_list) {
+    if (capability.is_held) {
+      if (names.tellp() > 0) {
+        names << ", ";
+      }
+
+      names << capability.name;
     }
   }
 
+  LOG(INFO) << "JVMTI capabilities held: " << names.str();
+}
+
+
+bool JvmtiAgent::OnWorkerReady() {
+  Stopwatch stopwatch;
+
+  // Connect to Java internals implementation. Only the classes needed for
+  // registration are loaded here. Heavier parts of the internals (class name
+  // indexes, method safety configuration and bytecode analysis) are loaded
+  // by the JVM when first used.
+  if (!internals_->LoadInternals()) {
+    LOG(ERROR) << "Internals could not be initialized";
+    return false;
+  }
+
   std::vector<bool (*)(jobject)> jni_bind_methods = {
+    jniproxy::BindAgentEventsWithClassLoader,
     jniproxy::BindBreakpointLabelsProviderWithClassLoader,
     jniproxy::BindClassPathLookupWithClassLoader,
     jniproxy::BindDynamicLogHelperWithClassLoader,
@@ -354,6 +629,9 @@ bool JvmtiAgent::OnWorkerReady() {
     }
   }
 
+  LOG(INFO) << "Internals initialization time: "
+            << stopwatch.GetElapsedMicros() << " microseconds";
+
   // Split the extra class path into individual components.
   std::vector<string> extra_class_path;
   std::stringstream extra_class_path_stream(FLAGS_cdbg_extra_class_path);
@@ -362,6 +640,19 @@ bool JvmtiAgent::OnWorkerReady() {
       extra_class_path.push_back(item);
   }
 
+  if (FLAGS_cdbg_cache_breakpoint_labels) {
+    breakpoint_labels_cache_.Refresh();
+  }
+
+  if (FLAGS_cdbg_jfr_events) {
+    agent_events_.reset(new JniAgentEvents);
+    if (agent_events_->Initialize()) {
+      SetTraceSpanSink(agent_events_.get());
+    } else {
+      agent_events_ = nullptr;
+    }
+  }
+
   // Currently we need "ClassPathLookup" very early to compute uniquifier.
   if (!internals_->CreateClassPathLookupInstance(
         true,
@@ -376,19 +667,46 @@ bool JvmtiAgent::OnWorkerReady() {
 void JvmtiAgent::OnIdle() {
   ScopedMonitoredCall monitored_call("Agent:Idle");
 
-  // Invoke scheduled callbacks.
-  // The precision of "scheduler_" has the granularity of "OnIdle" calls. This
-  // is typically in the order of minutes. This precision is good enough
-  // because the scheduler is only used to expire breakpoints and the
-  // expiration time defaults to 24 hours. If scheduler is used for more fine
-  // grained tasks, "Worker" will need to take the next scheduled time into
-  // account when going into wait.
+  // Scheduled callbacks are normally invoked by the activation thread when
+  // they are due (see "ProcessScheduledCallbacks"). This is a fallback in
+  // case the activation thread is not running.
   scheduler_.Process();
+
+  FastClock::Recalibrate();
+
+  ReleaseRetiredDebuggers();
+
+  FlushTraceSpans();
+
+  MemoryBudget::GetInstance()->Update();
+
+  ReloadConfigFile();
+
+  if (FLAGS_cdbg_cache_breakpoint_labels) {
+    breakpoint_labels_cache_.Refresh();
+  }
+
+  std::shared_ptr<Debugger> debugger = debugger_;
+  if (debugger != nullptr) {
+    debugger->PrewarmClassFiles();
+    debugger->ExportBreakpointCounters();
+    debugger->RemoveUnloadedClasses();
+    debugger->FlushRepeatedDynamicLogs();
+  }
+
+  // The CPU quota of a container can change while the process is running.
+  if (UpdateEffectiveCpuCount() && (debugger != nullptr)) {
+    debugger->ResizeCostLimiters();
+  }
 }
 
 
 void JvmtiAgent::OnBreakpointsUpdated(
     std::vector<std::unique_ptr<BreakpointModel>> breakpoints) {
+  if (!breakpoints.empty()) {
+    AcquireDebuggerCapabilities();
+  }
+
   std::shared_ptr<Debugger> debugger = debugger_;
   if (debugger != nullptr) {
     debugger->SetActiveBreakpointsList(std::move(breakpoints));
@@ -396,11 +714,80 @@ void JvmtiAgent::OnBreakpointsUpdated(
 }
 
 
+void JvmtiAgent::OnBreakpointsChanged(
+    std::vector<std::unique_ptr<BreakpointModel>> added_breakpoints,
+    const std::vector<string>& removed_breakpoint_ids) {
+  if (!added_breakpoints.empty()) {
+    AcquireDebuggerCapabilities();
+  }
+
+  std::shared_ptr<Debugger> debugger = debugger_;
+  if (debugger != nullptr) {
+    debugger->UpdateActiveBreakpointsList(
+        std::move(added_breakpoints),
+        removed_breakpoint_ids);
+  }
+}
+
+
+void JvmtiAgent::ActivateScheduledBreakpoints() {
+  ScopedMonitoredCall monitored_call("Agent:ActivateBreakpoints");
+
+  std::shared_ptr<Debugger> debugger = debugger_;
+  if (debugger != nullptr) {
+    debugger->ActivateScheduledBreakpoints();
+  }
+}
+
+
+int JvmtiAgent::ProcessScheduledCallbacks() {
+  ScopedMonitoredCall monitored_call("Agent:ProcessScheduledCallbacks");
+
+  scheduler_.Process();
+
+  const time_t next_time = scheduler_.NextTime();
+  if (next_time == Scheduler<>::kNever) {
+    return -1;
+  }
+
+  // The scheduler has the resolution of one second. Wake up right when the
+  // second of the next callback starts.
+  const int64 current_time_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch()).count();
+  const int64 delay_ms =
+      static_cast<int64>(next_time) * 1000 - current_time_ms;
+
+  return static_cast<int>(std::max<int64>(
+      0,
+      std::min<int64>(delay_ms, std::numeric_limits<int>::max())));
+}
+
+
 void JvmtiAgent::EnableDebugger(bool is_enabled) {
   ScopedMonitoredCall monitored_call(
       is_enabled ? "Agent:EnableDebugger" : "Agent:DisableDebugger");
 
   if (is_enabled) {
+    // Reattach the debugger kept warm since it was disabled. Its class
+    // index is up to date, so there is nothing to initialize. Copy before
+    // clearing "warm_debugger_" not to miss any CLASS_PREPARE event.
+    if ((debugger_ == nullptr) && (warm_debugger_ != nullptr)) {
+      Stopwatch stopwatch;
+
+      debugger_ = warm_debugger_;
+      warm_debugger_ = nullptr;
+
+      if (has_debugger_capabilities_ || !enable_capabilities_) {
+        EnableJvmtiNotifications(JVMTI_ENABLE, { JVMTI_EVENT_BREAKPOINT });
+      }
+
+      hot_debugger_.store(debugger_.get(), std::memory_order_release);
+
+      LOG(INFO) << "Warm Java debuglet reattached in "
+                << stopwatch.GetElapsedMicros() << " microseconds";
+    }
+
     // Attach debugger if needed
     if (debugger_ == nullptr) {
       LOG(INFO) << "Attaching Java debuglet";
@@ -417,7 +804,7 @@ void JvmtiAgent::EnableDebugger(bool is_enabled) {
       // notifications needs to be enabled before calling "Initialize".
       debugger_ = std::make_shared<Debugger>(
           &scheduler_,
-          config_.get(),
+          &config_,
           eval_call_stack_.get(),
           std::unique_ptr<MethodLocals>(new MethodLocals(nullptr)),
           std::unique_ptr<ClassMetadataReader>(
@@ -425,17 +812,43 @@ void JvmtiAgent::EnableDebugger(bool is_enabled) {
           internals_,
           std::bind(&JvmtiAgent::BuildBreakpointLabelsProvider, this),
           &format_queue_,
-          worker_.canary_control());
+          &dynamic_log_queue_,
+          worker_.canary_control(),
+          [this] () { return worker_.RequestBreakpointsActivation(); });
+      hot_debugger_.store(debugger_.get(), std::memory_order_release);
       debugger_->Initialize();
     }
   } else {
+    // Keep the debugger warm (see "ReleaseWarmDebugger"). Breakpoint
+    // callbacks may still be running on other threads, but the breakpoints
+    // they are hitting are all completed. Copy before clearing "debugger_"
+    // not to miss any CLASS_PREPARE event.
+    if ((debugger_ != nullptr) && FLAGS_cdbg_keep_debugger_warm) {
+      LOG(INFO) << "Detaching Java debuglet, keeping it warm";
+
+      EnableJvmtiNotifications(JVMTI_DISABLE, { JVMTI_EVENT_BREAKPOINT });
+      hot_debugger_.store(nullptr, std::memory_order_seq_cst);
+
+      debugger_->RemoveAllBreakpoints();
+      warm_debugger_ = debugger_;
+      debugger_ = nullptr;
+
+      format_queue_.RemoveAll();
+    }
+
     // Detach debugger if needed
     if (debugger_ != nullptr) {
       // Disable debugger specific event callbacks.
       EnableJvmtiDebuggerNotifications(JVMTI_DISABLE);
 
       // The "Debugger" instance might not get released here if there is
-      // ongoing JVMTI callback being processed.
+      // ongoing JVMTI callback being processed. Breakpoint callbacks don't
+      // hold a reference, so keep the instance around until they are done.
+      hot_debugger_.store(nullptr, std::memory_order_seq_cst);
+      retired_debuggers_.push_back({
+          std::move(debugger_),
+          CallbacksMonitor::GetInstance()->GetCurrentTimeMillis()
+      });
       debugger_ = nullptr;
 
       // Remove all pending breakpoint updates. It is still possible that a
@@ -447,8 +860,94 @@ void JvmtiAgent::EnableDebugger(bool is_enabled) {
 }
 
 
+void JvmtiAgent::ReleaseWarmDebugger() {
+  if (warm_debugger_ == nullptr) {
+    return;
+  }
+
+  EnableJvmtiDebuggerNotifications(JVMTI_DISABLE);
+
+  retired_debuggers_.push_back({
+      std::move(warm_debugger_),
+      CallbacksMonitor::GetInstance()->GetCurrentTimeMillis()
+  });
+  warm_debugger_ = nullptr;
+}
+
+
+void JvmtiAgent::ReleaseRetiredDebuggers() {
+  CallbacksMonitor* callbacks_monitor = CallbacksMonitor::GetInstance();
+
+  auto it = retired_debuggers_.begin();
+  while (it != retired_debuggers_.end()) {
+    if (callbacks_monitor->HasCallsStartedBy(it->retire_time_ms)) {
+      ++it;
+    } else {
+      it = retired_debuggers_.erase(it);
+    }
+  }
+}
+
+
+void JvmtiAgent::ReloadConfigFile() {
+  if (FLAGS_cdbg_config_file.empty()) {
+    return;
+  }
+
+  struct stat st;
+  if ((stat(FLAGS_cdbg_config_file.c_str(), &st) != 0) ||
+      (st.st_mtime == config_file_mtime_)) {
+    return;
+  }
+
+  FILE* file = fopen(FLAGS_cdbg_config_file.c_str(), "r");
+  if (file == nullptr) {
+    LOG_EVERY_N(WARNING, 100) << "Failed to open configuration file "
+                              << FLAGS_cdbg_config_file;
+    return;
+  }
+
+  config_file_mtime_ = st.st_mtime;
+
+  // Same syntax as flags set through system properties, minus the prefix.
+  // Leading dashes are allowed, so that a flag file can be used as is.
+  char line[1024];
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    string item(line);
+    item.erase(item.find_last_not_of(" \t\r\n") + 1);
+    item.erase(0, std::min(item.find_first_not_of(" \t-"), item.size()));
+    if (item.empty() || (item[0] == '#')) {
+      continue;
+    }
+
+    const size_t separator = item.find('=');
+    if (separator == string::npos) {
+      LOG(WARNING) << "Ignoring invalid configuration line: " << item;
+      continue;
+    }
+
+    const string flag_name = item.substr(0, separator);
+    const string value = item.substr(separator + 1);
+    if (SetCommandLineOption(flag_name.c_str(), value.c_str()).empty()) {
+      LOG(WARNING) << "Failed to set flag " << flag_name << " = " << value;
+    }
+  }
+
+  fclose(file);
+
+  config_.Set(DefaultConfig());
+
+  LOG(INFO) << "Configuration version " << config_.Get()->version()
+            << " loaded from " << FLAGS_cdbg_config_file;
+}
+
+
 std::unique_ptr<BreakpointLabelsProvider>
 JvmtiAgent::BuildBreakpointLabelsProvider() {
+  if (FLAGS_cdbg_cache_breakpoint_labels) {
+    return breakpoint_labels_cache_.NewProvider();
+  }
+
   return std::unique_ptr<BreakpointLabelsProvider>(
       new JniBreakpointLabelsProvider(breakpoint_labels_provider_factory_));
 }
@@ -17,12 +17,18 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_JVMTI_AGENT_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_JVMTI_AGENT_H_
 
+#include <atomic>
 #include <memory>
 #include <vector>
+#include "agent_status.h"
 #include "common.h"
 #include "config.h"
+#include "config_store.h"
 #include "debugger.h"
+#include "dynamic_log_queue.h"
 #include "eval_call_stack.h"
+#include "jni_agent_events.h"
+#include "jni_breakpoint_labels_provider.h"
 #include "jvm_class_metadata_reader.h"
 #include "jvm_internals.h"
 #include "scheduler.h"
@@ -79,6 +85,16 @@ class JvmtiAgent
   // doesn't have methods initialized so it not very useful for debugger.
   void JvmtiOnClassLoad(jthread thread, jclass cls);
 
+  // Sent when JVM obtains class file data, but before it constructs the in
+  // memory representation of the class. Only enabled if class files are
+  // retained (see "RetainedClassFiles"). The class file is never modified.
+  void JvmtiOnClassFileLoadHook(
+      jclass class_being_redefined,
+      jobject loader,
+      const char* name,
+      jint class_data_len,
+      const unsigned char* class_data);
+
   // A class prepare event is generated when Java class is ready to be used
   // by Java code, but before any method (including constructor and static
   // initializer) is actually called.
@@ -121,8 +137,16 @@ class JvmtiAgent
   void OnBreakpointsUpdated(
       std::vector<std::unique_ptr<BreakpointModel>> breakpoints) override;
 
+  void OnBreakpointsChanged(
+      std::vector<std::unique_ptr<BreakpointModel>> added_breakpoints,
+      const std::vector<string>& removed_breakpoint_ids) override;
+
   void EnableDebugger(bool is_enabled) override;
 
+  void ActivateScheduledBreakpoints() override;
+
+  int ProcessScheduledCallbacks() override;
+
   bool IsFieldDebuggerVisible(
       jclass cls,
       const string& class_signature,
@@ -146,9 +170,32 @@ class JvmtiAgent
   // Enables or disables debugger specific JVMTI callbacks.
   void EnableJvmtiDebuggerNotifications(jvmtiEventMode mode);
 
+  // Requests the capabilities that are only needed to set breakpoints and
+  // capture data. On HotSpot these degrade JIT compiled code even if no
+  // breakpoint is ever set.
+  static void SetDebuggerCapabilities(jvmtiCapabilities* capabilities);
+
+  // Adds the debugger capabilities in the live phase if they were deferred
+  // with --defer_jvmti_debugger_capabilities. Called when the first
+  // breakpoint arrives.
+  void AcquireDebuggerCapabilities();
+
+  // Logs the JVMTI capabilities currently held by the agent.
+  void LogCapabilities();
+
   // Creates the instance of "BreakpointLabelsProvider" to use for the debugger.
   std::unique_ptr<BreakpointLabelsProvider> BuildBreakpointLabelsProvider();
 
+  // Fully detaches the debugger kept warm by "EnableDebugger(false)" (if any).
+  void ReleaseWarmDebugger();
+
+  // Destroys the detached debuggers that are no longer used by any callback.
+  void ReleaseRetiredDebuggers();
+
+  // Applies the flags in "FLAGS_cdbg_config_file" and replaces the
+  // configuration if the file has changed since the last call.
+  void ReloadConfigFile();
+
  private:
   // Proxy class to access Java internals implementation.
   // Not owned by this class.
@@ -158,8 +205,13 @@ class JvmtiAgent
   // of eval_call_stack_
   std::unique_ptr<EvalCallStack> eval_call_stack_;
 
-  // Agent configuration.
-  std::unique_ptr<Config> config_;
+  // Agent configuration. Replaced by "ReloadConfigFile" without restarting
+  // the debugger.
+  ConfigStore config_;
+
+  // Modification time of "FLAGS_cdbg_config_file" when it was last applied
+  // or 0 if never.
+  time_t config_file_mtime_ { 0 };
 
   // Vector of function pointers that load Java based classes.
   std::vector<bool (*)(jobject)> fn_loaders_;
@@ -168,18 +220,40 @@ class JvmtiAgent
   // com.google.devtools.cdbg.debuglets.java.BreakpointLabelsProvider interface.
   const std::function<JniLocalRef()> breakpoint_labels_provider_factory_;
 
+  // Breakpoint labels computed in advance (see
+  // "FLAGS_cdbg_cache_breakpoint_labels").
+  JniBreakpointLabelsCache breakpoint_labels_cache_;
+
+  // Emits the traced agent phases as JFR events or nullptr if not enabled
+  // (see "FLAGS_cdbg_jfr_events").
+  std::unique_ptr<JniAgentEvents> agent_events_;
+
   // When false, don't enable JVMTI capabilities.
   const bool enable_capabilities_;
 
   // When false, don't enable JVMTI events as debugger gets enabled/disabled.
   const bool enable_jvmti_events_;
 
+  // True once the capabilities set by "SetDebuggerCapabilities" were added.
+  // Only accessed from "OnLoad" and the worker thread.
+  bool has_debugger_capabilities_ { false };
+
+  // Set if adding deferred debugger capabilities failed, so that it's not
+  // retried on every breakpoint update.
+  bool debugger_capabilities_unavailable_ { false };
+
   // Schedules callbacks at a specified time in the future.
   Scheduler<> scheduler_;
 
   // Breakpoint hit results that wait to be reported to the hub.
   FormatQueue format_queue_;
 
+  // Registration of the format queue status in "AgentStatus".
+  AgentStatus::Cookie agent_status_cookie_;
+
+  // Dynamic log entries that wait to be written to the application log.
+  DynamicLogQueue dynamic_log_queue_;
+
   // Worker threads responsible to talk to the backend.
   Worker worker_;
 
@@ -188,6 +262,30 @@ class JvmtiAgent
   // of the callback processing.
   std::shared_ptr<Debugger> debugger_;
 
+  // Debugger that was disabled with --cdbg_keep_debugger_warm. It has no
+  // breakpoints, but it keeps receiving CLASS_PREPARE and
+  // COMPILED_METHOD_UNLOAD events so that it can be enabled again quickly.
+  std::shared_ptr<Debugger> warm_debugger_;
+
+  // Raw pointer to "debugger_" for the breakpoint callback, which is too hot
+  // to copy "shared_ptr" on every hit. The callback reads it within
+  // "ScopedHotMonitoredCall", so a detached debugger is kept in
+  // "retired_debuggers_" until no such callback can still be using it.
+  std::atomic<Debugger*> hot_debugger_ { nullptr };
+
+  // Detached debugger that might still be used by ongoing callbacks.
+  struct RetiredDebugger {
+    // Detached debugger instance.
+    std::shared_ptr<Debugger> debugger;
+
+    // Time (in "CallbacksMonitor" clock) when "hot_debugger_" was cleared.
+    int64 retire_time_ms;
+  };
+
+  // Detached debuggers waiting for the ongoing callbacks to complete.
+  // Only accessed from the worker thread (or after the worker is stopped).
+  std::vector<RetiredDebugger> retired_debuggers_;
+
   DISALLOW_COPY_AND_ASSIGN(JvmtiAgent);
 };
 
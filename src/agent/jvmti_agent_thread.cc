@@ -16,8 +16,34 @@
 
 #include "jvmti_agent_thread.h"
 
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include "jni_proxy_thread.h"
 
+// The scheduling flags below are lists of "thread=value" entries separated
+// by ';'. "thread" is the name the agent thread was started with (e.g.
+// "CloudDebugger_transmission_thread") or "*" for all the other threads.
+DEFINE_string(
+    cdbg_agent_thread_sched_policy,
+    "",
+    "scheduling policy of agent threads (\"other\", \"batch\" or "
+    "\"idle\"), e.g. \"*=batch;CloudDebugger_format_thread=idle\"");
+
+DEFINE_string(
+    cdbg_agent_thread_nice,
+    "",
+    "nice level of agent threads, e.g. \"*=10\"");
+
+DEFINE_string(
+    cdbg_agent_thread_cpus,
+    "",
+    "CPUs agent threads may run on, e.g. \"*=0-1,6\"");
+
 namespace devtools {
 namespace cdbg {
 
@@ -26,6 +52,154 @@ namespace cdbg {
 static __thread bool g_is_agent_thread = false;
 
 
+// Finds the value of a scheduling flag for the specified thread. Returns
+// empty string if the flag doesn't configure the thread.
+static string GetThreadSetting(const string& flag, const string& thread_name) {
+  string default_value;
+
+  size_t begin = 0;
+  while (begin < flag.size()) {
+    size_t end = flag.find(';', begin);
+    if (end == string::npos) {
+      end = flag.size();
+    }
+
+    const string entry = flag.substr(begin, end - begin);
+    begin = end + 1;
+
+    const size_t separator = entry.find('=');
+    if (separator == string::npos) {
+      continue;
+    }
+
+    const string name = entry.substr(0, separator);
+    if (name == thread_name) {
+      return entry.substr(separator + 1);
+    }
+
+    if (name == "*") {
+      default_value = entry.substr(separator + 1);
+    }
+  }
+
+  return default_value;
+}
+
+
+// Parses a list of CPUs (like "0-3,6"). Returns false if the list is
+// invalid.
+static bool ParseCpuList(const string& cpus, cpu_set_t* cpu_set) {
+  CPU_ZERO(cpu_set);
+
+  const char* p = cpus.c_str();
+  while (*p != '\0') {
+    char* end = nullptr;
+    const long first = strtol(p, &end, 10);  // NOLINT
+    if (end == p) {
+      return false;
+    }
+
+    long last = first;  // NOLINT
+    p = end;
+    if (*p == '-') {
+      ++p;
+      last = strtol(p, &end, 10);
+      if (end == p) {
+        return false;
+      }
+
+      p = end;
+    }
+
+    if ((first < 0) || (last < first) || (last >= CPU_SETSIZE)) {
+      return false;
+    }
+
+    for (long cpu = first; cpu <= last; ++cpu) {  // NOLINT
+      CPU_SET(cpu, cpu_set);
+    }
+
+    if (*p == ',') {
+      ++p;
+    } else if (*p != '\0') {
+      return false;
+    }
+  }
+
+  return CPU_COUNT(cpu_set) > 0;
+}
+
+
+// Applies the scheduling policy, nice level and CPU affinity configured for
+// the calling agent thread, so that the agent work (like formatting and
+// transmission of snapshots) can be kept off the CPUs and the time slices
+// that the application needs. Linux applies these per thread.
+static void ApplyThreadScheduling(const string& thread_name) {
+  const string policy =
+      GetThreadSetting(FLAGS_cdbg_agent_thread_sched_policy, thread_name);
+  if (!policy.empty()) {
+    int sched_policy = -1;
+    if (policy == "other") {
+      sched_policy = SCHED_OTHER;
+    } else if (policy == "batch") {
+      sched_policy = SCHED_BATCH;
+    } else if (policy == "idle") {
+      sched_policy = SCHED_IDLE;
+    }
+
+    sched_param param;
+    memset(&param, 0, sizeof(param));
+    if (sched_policy == -1) {
+      LOG(WARNING) << "Invalid scheduling policy " << policy
+                   << " of agent thread " << thread_name;
+    } else if (sched_setscheduler(0, sched_policy, &param) != 0) {
+      LOG(WARNING) << "Failed to set scheduling policy " << policy
+                   << " of agent thread " << thread_name
+                   << ", error: " << errno;
+    } else {
+      LOG(INFO) << "Scheduling policy of agent thread " << thread_name
+                << " set to " << policy;
+    }
+  }
+
+  const string nice =
+      GetThreadSetting(FLAGS_cdbg_agent_thread_nice, thread_name);
+  if (!nice.empty()) {
+    char* end = nullptr;
+    const long nice_level = strtol(nice.c_str(), &end, 10);  // NOLINT
+    const pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    if ((*end != '\0') || (nice_level < -20) || (nice_level > 19)) {
+      LOG(WARNING) << "Invalid nice level " << nice
+                   << " of agent thread " << thread_name;
+    } else if (setpriority(PRIO_PROCESS, tid, nice_level) != 0) {
+      LOG(WARNING) << "Failed to set nice level " << nice
+                   << " of agent thread " << thread_name
+                   << ", error: " << errno;
+    } else {
+      LOG(INFO) << "Nice level of agent thread " << thread_name
+                << " set to " << nice;
+    }
+  }
+
+  const string cpus =
+      GetThreadSetting(FLAGS_cdbg_agent_thread_cpus, thread_name);
+  if (!cpus.empty()) {
+    cpu_set_t cpu_set;
+    if (!ParseCpuList(cpus, &cpu_set)) {
+      LOG(WARNING) << "Invalid CPU list " << cpus
+                   << " of agent thread " << thread_name;
+    } else if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+      LOG(WARNING) << "Failed to set CPU affinity " << cpus
+                   << " of agent thread " << thread_name
+                   << ", error: " << errno;
+    } else {
+      LOG(INFO) << "Agent thread " << thread_name << " bound to CPUs "
+                << cpus;
+    }
+  }
+}
+
+
 JvmtiAgentThread::JvmtiAgentThread() {
 }
 
@@ -98,6 +272,8 @@ bool JvmtiAgentThread::StartAgentThread(
 
         LOG(INFO) << "Agent thread started: " << agent_arg->first;
 
+        ApplyThreadScheduling(agent_arg->first);
+
         agent_arg->second();
 
         LOG(INFO) << "Agent thread exited: " << agent_arg->first;
@@ -24,7 +24,9 @@
 namespace devtools {
 namespace cdbg {
 
-// Implements JVMTI agent thread.
+// Implements JVMTI agent thread. The scheduling policy, nice level and CPU
+// affinity of the thread can be configured by its name (see
+// "--cdbg_agent_thread_sched_policy") and are applied when it starts.
 class JvmtiAgentThread : public AgentThread {
  public:
   JvmtiAgentThread();
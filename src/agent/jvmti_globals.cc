@@ -18,11 +18,17 @@
 #include <dirent.h>
 #include <memory>
 #include <sstream>
+#include "agent_status.h"
 #include "callbacks_monitor.h"
 #include "common.h"
+#include "fast_clock.h"
+#include "gc_epoch.h"
 #include "jvm_eval_call_stack.h"
 #include "jvm_internals.h"
 #include "jvmti_buffer.h"
+#include "memory_budget.h"
+#include "overhead_governor.h"
+#include "stack_trace_cache.h"
 #include "statistician.h"
 #include "version.h"
 
@@ -129,6 +135,30 @@ static void JNICALL JvmtiOnClassLoad(
 }
 
 
+// Sent when JVM obtains class file data, but before it constructs the in
+// memory representation of the class.
+static void JNICALL JvmtiOnClassFileLoadHook(
+    jvmtiEnv* jvmti,
+    JNIEnv* jni,
+    jclass class_being_redefined,
+    jobject loader,
+    const char* name,
+    jobject protection_domain,
+    jint class_data_len,
+    const unsigned char* class_data,
+    jint* new_class_data_len,
+    unsigned char** new_class_data) {
+  devtools::cdbg::set_thread_jni(jni);
+
+  g_instance->JvmtiOnClassFileLoadHook(
+      class_being_redefined,
+      loader,
+      name,
+      class_data_len,
+      class_data);
+}
+
+
 // A class prepare event is generated when class preparation is complete.
 static void JNICALL JvmtiOnClassPrepare(
     jvmtiEnv* jvmti,
@@ -190,6 +220,19 @@ static void JNICALL JvmtiOnCompiledMethodUnload(
   devtools::cdbg::set_thread_jni(previous_jni);
 }
 
+// Sent when a garbage collection pause begins. Only a very limited subset of
+// JVMTI is allowed in this callback and JNI is not available, so the
+// callback doesn't go through the agent.
+static void JNICALL JvmtiOnGarbageCollectionStart(jvmtiEnv* jvmti) {
+  devtools::cdbg::GcEpoch::OnGarbageCollectionStart();
+}
+
+// Sent when a garbage collection pause ends. Same restrictions as for
+// GarbageCollectionStart apply.
+static void JNICALL JvmtiOnGarbageCollectionFinish(jvmtiEnv* jvmti) {
+  devtools::cdbg::GcEpoch::OnGarbageCollectionFinish();
+}
+
 // Breakpoint JVMTI event callback.
 static void JNICALL JvmtiOnBreakpoint(
     jvmtiEnv* jvmti,
@@ -214,9 +257,12 @@ static bool InitializeJvmtiCallbacks() {
   jvmti_callbacks.VMDeath = &JvmtiOnVMDeath;
   jvmti_callbacks.ClassLoad = &JvmtiOnClassLoad;
   jvmti_callbacks.ClassPrepare = &JvmtiOnClassPrepare;
+  jvmti_callbacks.ClassFileLoadHook = &JvmtiOnClassFileLoadHook;
   jvmti_callbacks.CompiledMethodLoad = &JvmtiOnCompiledMethodLoad;
   jvmti_callbacks.CompiledMethodUnload = &JvmtiOnCompiledMethodUnload;
   jvmti_callbacks.Breakpoint = &JvmtiOnBreakpoint;
+  jvmti_callbacks.GarbageCollectionStart = &JvmtiOnGarbageCollectionStart;
+  jvmti_callbacks.GarbageCollectionFinish = &JvmtiOnGarbageCollectionFinish;
 
   // Enable JvmtiOnVMInit callback.
   err = devtools::cdbg::jvmti()->SetEventCallbacks(
@@ -295,8 +341,13 @@ static void InitEnvironment(const char* options) {
 #endif  // STANDALONE_BUILD
 
   devtools::cdbg::InitializeStatisticians();
+  devtools::cdbg::FastClock::Initialize();
   devtools::cdbg::CallbacksMonitor::InitializeSingleton(
       devtools::cdbg::kDefaultMaxCallbackTimeMs);
+  devtools::cdbg::OverheadGovernor::InitializeSingleton();
+  devtools::cdbg::MemoryBudget::InitializeSingleton();
+  devtools::cdbg::StackTraceCache::InitializeSingleton();
+  devtools::cdbg::AgentStatus::InitializeSingleton();
 }
 
 
@@ -386,6 +437,10 @@ JNIEXPORT void JNICALL Agent_OnUnload(JavaVM* vm) {
   CleanupAgent();
 
   devtools::cdbg::CallbacksMonitor::CleanupSingleton();
+  devtools::cdbg::OverheadGovernor::CleanupSingleton();
+  devtools::cdbg::StackTraceCache::CleanupSingleton();
+  devtools::cdbg::MemoryBudget::CleanupSingleton();
+  devtools::cdbg::AgentStatus::CleanupSingleton();
   devtools::cdbg::CleanupStatisticians();
 }
 
@@ -94,11 +94,12 @@ int64 LeakyBucket::RefillBucket(
   // fill_rate_ is in tokens per second, hence the scaling factor.
   // We can get a negative amount of tokens by calling TakeTokens. Make sure we
   // don't add more than the capacity of leaky bucket.
+  const int64 capacity = capacity_.load(std::memory_order_relaxed);
   fractional_tokens_ +=
-      std::min(elapsed_ns * (fill_rate_ / 1e9), static_cast<double>(capacity_));
+      std::min(elapsed_ns * (fill_rate_ / 1e9), static_cast<double>(capacity));
   const int64 ideal_tokens_to_add = fractional_tokens_;
 
-  const int64 max_tokens_to_add = capacity_ - available_tokens;
+  const int64 max_tokens_to_add = capacity - available_tokens;
   int64 real_tokens_to_add;
   if (max_tokens_to_add < ideal_tokens_to_add) {
     fractional_tokens_ = 0.0;
@@ -127,5 +128,18 @@ void LeakyBucket::TakeTokens(int64 tokens) {
   }
 }
 
+
+void LeakyBucket::SetLimits(int64 capacity, int64 fill_rate) {
+  std::lock_guard<std::mutex> lock(mu_);
+
+  capacity_.store(capacity, std::memory_order_relaxed);
+  fill_rate_ = fill_rate;
+
+  const int64 excess_tokens = AtomicLoadTokens() - capacity;
+  if (excess_tokens > 0) {
+    AtomicIncrementTokens(-excess_tokens);
+  }
+}
+
 }  // namespace cdbg
 }  // namespace devtools
@@ -52,6 +52,14 @@ class LeakyBucket {
   // bucket negative.
   void TakeTokens(int64 tokens);
 
+  // Changes the capacity and the fill rate of the bucket. Tokens above the
+  // new capacity are discarded.
+  void SetLimits(int64 capacity, int64 fill_rate);
+
+  // Gets the number of tokens currently in the bucket (without refilling it).
+  // Only used for diagnostics.
+  int64 available_tokens() const { return AtomicLoadTokens(); }
+
  private:
   // The slow path of RequestTokens. Grabs a lock and may refill tokens_
   // using the fill rate and time passed since last fill.
@@ -87,15 +95,16 @@ class LeakyBucket {
   // during a normal RequestTokens that was not satisfied.
   std::atomic<int64> tokens_;
 
-  // Capacity of the bucket.
-  const int64 capacity_;
+  // Capacity of the bucket. Only changes in "SetLimits" (under "mu_"), but is
+  // read without a lock on the fast path.
+  std::atomic<int64> capacity_;
 
   // Although the main token count is an integer we also track fractional tokens
   // for increased precision.
   double fractional_tokens_;
 
-  // Fill rate in tokens per second.
-  const int64 fill_rate_;
+  // Fill rate in tokens per second. Guarded by "mu_".
+  int64 fill_rate_;
 
   // Time in nanoseconds of the last refill.
   int64 fill_time_ns_;
@@ -105,7 +114,7 @@ class LeakyBucket {
 
 // Inline fast-path.
 inline bool LeakyBucket::RequestTokens(int64 requested_tokens) {
-  if (requested_tokens > capacity_) {
+  if (requested_tokens > capacity_.load(std::memory_order_relaxed)) {
     return false;
   }
 
@@ -19,6 +19,7 @@
 
 #include "common.h"
 #include "expression_evaluator.h"
+#include "expression_program.h"
 
 namespace devtools {
 namespace cdbg {
@@ -41,6 +42,12 @@ class LiteralEvaluator : public ExpressionEvaluator {
 
   Nullable<jvalue> GetStaticValue() const override { return n_.get_jvalue(); }
 
+  bool HasMethodCalls() const override { return false; }
+
+  int Lower(ExpressionProgramBuilder* builder) const override {
+    return builder->AddConstant(n_.type(), n_.get_jvalue());
+  }
+
   ErrorOr<JVariant> Evaluate(
       const EvaluationContext& evaluation_context) const override {
     return JVariant(n_);
@@ -0,0 +1,54 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_LOCATION_INDEX_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_LOCATION_INDEX_H_
+
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Finds the interval containing "location" in a sorted array of interval
+// start locations. Returns the index of the last element that is not greater
+// than "location" or -1 if all the elements are greater.
+//
+// The search is a binary search without data dependent branches (the loop
+// only depends on "size"), which keeps the pipeline busy on the short
+// arrays typical for line number and local variable tables.
+inline int FindLocationInterval(
+    const jlocation* starts,
+    int size,
+    jlocation location) {
+  if (size <= 0) {
+    return -1;
+  }
+
+  const jlocation* base = starts;
+  int remaining = size;
+  while (remaining > 1) {
+    const int half = remaining / 2;
+    base = (base[half] <= location) ? base + half : base;
+    remaining -= half;
+  }
+
+  return (*base <= location) ? static_cast<int>(base - starts) : -1;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_LOCATION_INDEX_H_
@@ -16,125 +16,117 @@
 
 #include "log_data_collector.h"
 
+#include <algorithm>
 #include "expression_evaluator.h"
 #include "messages.h"
 #include "readers_factory.h"
 #include "value_formatter.h"
-#include "jni_proxy_object.h"
+
+DEFINE_int32(
+    max_dynamic_log_message_bytes,
+    16 * 1024,
+    "maximum size of a single dynamic log message; longer messages are "
+    "truncated while they are being rendered");
 
 namespace devtools {
 namespace cdbg {
 
-// Substitutes parameter placeholders $0, $1, etc. with the parameter value
-// as evaluated by "parameters".
-static string SubstitutePlaceholders(
-    const string& format,
-    std::function<string(int)> parameters) {
-  string result;
-  result.reserve(format.size());
-
-  for (string::const_iterator it = format.begin(); it != format.end(); ) {
-    if ((*it != '$') || (it + 1 == format.end())) {
-      result.push_back(*it++);
-      continue;
-    }
-
-    string::const_iterator p = it + 1;
-
-    // "$$" is an escaped form of "$"
-    if (*p == '$') {
-      result.push_back('$');
-      it += 2;
-      continue;
-    }
-
-    int parameter_index = 0;
-    while (isdigit(*p) && (p != format.end())) {
-      parameter_index = parameter_index * 10 + (*p - '0');
-      ++p;
-    }
-
-    if (p == it + 1) {
-      result.push_back(*it++);
-      continue;
-    }
+// Appended to a message or an object that was cut short due to the message
+// size limit.
+static constexpr char kTruncatedSuffix[] = " ...";
 
-    result.append(parameters(parameter_index));
-    it = p;
-  }
-
-  return result;
-}
-
-
-// Formats structured message into a string.
-// Note that we are losing the ability to localize the message that goes into
-// the log.
+// Prints out the value of JVariant or status message if present. Strings
+// (including results of "toString()") are truncated to fit into "max_size".
+// Note that we are losing the ability to localize the status message that
+// goes into the log.
 // TODO(vlif): retain the message as is once we have structured log messages.
-static string FormatMessage(const FormatMessageModel& message) {
-  return SubstitutePlaceholders(
-      message.format,
-      [&message] (int parameter_index) -> string {
-        if ((parameter_index < 0) ||
-            (parameter_index >= message.parameters.size())) {
-          DCHECK(false) << "Bad parameter index " << parameter_index
-                        << ", format: " << message.format;
-          return string();
-        }
-
-        return message.parameters[parameter_index];
-      });
-}
-
-
-// Prints out the value of JVariant or status message if present.
-static string FormatValue(const NamedJVariant& result, bool quote_string) {
+static void AppendValue(
+    const NamedJVariant& result,
+    bool quote_string,
+    size_t max_size,
+    string* formatted_value) {
   if (result.value.type() == JType::Void) {
-    return FormatMessage(result.status.description);
+    MessageTemplate::AppendFormatted(
+        result.status.description.format,
+        result.status.description.parameters,
+        formatted_value);
+    return;
   }
 
   ValueFormatter::Options format_options;
   format_options.quote_string = quote_string;
 
-  string formatted_value;
-  ValueFormatter::Format(result, format_options, &formatted_value, nullptr);
+  // Counts characters rather than bytes, so the value may still exceed the
+  // limit. "LogDataCollector::Format" cuts the message to size at the end.
+  const size_t remaining =
+      (formatted_value->size() < max_size)
+          ? (max_size - formatted_value->size())
+          : 0;
+  if (remaining < static_cast<size_t>(format_options.max_string_length)) {
+    format_options.max_string_length = static_cast<int>(remaining);
+  }
 
-  return formatted_value;
+  ValueFormatter::Append(result, format_options, formatted_value);
 }
 
 
 // Prints out all the members of an object in a yaml like format. The output
-// is supposed to be human readable rather than a protocol format.
-static string FormatMembers(const std::vector<NamedJVariant>& members) {
+// is supposed to be human readable rather than a protocol format. Stops
+// adding members once the output reaches "max_size".
+static void AppendMembers(
+    const std::vector<NamedJVariant>& members,
+    size_t max_size,
+    string* result) {
   if ((members.size() == 1) &&
       members[0].name.empty() &&
       members[0].status.description.format.empty()) {
     // Special case for Java strings: format single unnamed member as
     // variable value rather than as a member.
-    return FormatValue(members[0], false);
+    AppendValue(members[0], false, max_size, result);
+    return;
   }
 
-  string result;
-  result += "{ ";
+  *result += "{ ";
 
+  bool is_first = true;
   for (const NamedJVariant& member : members) {
-    if (result.size() > 2) {
-      result += ", ";
+    if (result->size() >= max_size) {
+      *result += kTruncatedSuffix;
+      break;
     }
 
-    result += member.name;
-    result += ": ";
-    result += FormatValue(member, true);
+    if (!is_first) {
+      *result += ", ";
+    }
+
+    is_first = false;
+
+    *result += member.name;
+    *result += ": ";
+    AppendValue(member, true, max_size, result);
   }
 
-  result += " }";
+  *result += " }";
+}
 
-  return result;
+
+// Cuts "result" to "max_size" bytes without splitting a UTF-8 sequence and
+// marks it as truncated.
+static void TruncateMessage(size_t max_size, string* result) {
+  size_t size = max_size;
+  while ((size > 0) && (((*result)[size] & 0xC0) == 0x80)) {
+    --size;
+  }
+
+  result->resize(size);
+  *result += kTruncatedSuffix;
 }
 
 
 // Checks if the object class has a non-default version of "toString()".
-static bool HasCustomToString(const JVariant& item) {
+static bool HasCustomToString(
+    ClassMetadataReader* class_metadata_reader,
+    const JVariant& item) {
   jobject obj = nullptr;
   if (!item.get<jobject>(&obj) || (obj == nullptr)) {
     return false;
@@ -145,24 +137,17 @@ static bool HasCustomToString(const JVariant& item) {
     return false;
   }
 
-  jmethodID method_id = jni()->GetMethodID(
-      static_cast<jclass>(cls.get()),
-      "toString",
-      "()Ljava/lang/String;");
-  if (!JniCheckNoException("GetMethodID(toString)")) {
-    return false;
-  }
-
-  return !jni()->IsSameObject(
-      GetMethodDeclaringClass(method_id).get(),
-      jniproxy::Object()->GetClass());
+  return class_metadata_reader->GetClassMetadata(
+      static_cast<jclass>(cls.get())).has_custom_to_string;
 }
 
 
 void LogDataCollector::Collect(
     MethodCaller* method_caller,
+    ClassMetadataReader* class_metadata_reader,
     ObjectEvaluator* object_evaluator,
     const std::vector<CompiledExpression>& watches,
+    SharedSubexpressionValues* shared_values,
     jthread thread) {
   const ClassMetadataReader::Method to_string_method =
       InstanceMethod("Ljava/lang/Object;", "toString", "()Ljava/lang/String;");
@@ -170,29 +155,39 @@ void LogDataCollector::Collect(
   DCHECK(watch_results_.empty())
       << "LogDataCollector::Collect is only expected to be called once";
 
+  watch_results_.reserve(watches.size());
+
   for (const CompiledExpression& watch : watches) {
-    NamedJVariant result =
-        EvaluateWatchedExpression(method_caller, watch, thread);
+    watch_results_.push_back(WatchResult());
+    WatchResult& watch_result = watch_results_.back();
+
+    watch_result.value = EvaluateWatchedExpression(
+        method_caller,
+        watch,
+        shared_values,
+        thread);
+    NamedJVariant& result = watch_result.value;
 
     if (ValueFormatter::IsValue(result)) {
-      watch_results_.push_back(FormatValue(result, false));
       continue;
     }
 
     // If the expression evaluates to an object, there is no point in leaving
     // the object as is. It will print out as "<object>", which is not very
-    // useful. Instead we get a string representation of an object.
+    // useful. Instead we get a string representation of an object. This has
+    // to happen here, while the application thread is still stopped at the
+    // breakpoint.
 
     // Try to call "toString()" unless it's a default "Object.toString", which
     // is not too helpful.
-    if (HasCustomToString(result.value)) {
+    if (HasCustomToString(class_metadata_reader, result.value)) {
       ErrorOr<JVariant> to_string =
           method_caller->Invoke(to_string_method, result.value, {});
       if (!to_string.is_error() &&
           to_string.value().has_non_null_object()) {
         result.value = ErrorOr<JVariant>::detach_value(std::move(to_string));
+        result.value.change_ref_type(JVariant::ReferenceKind::Global);
         result.well_known_jclass = WellKnownJClass::String;
-        watch_results_.push_back(FormatValue(result, false));
         continue;
       }
     }
@@ -201,17 +196,34 @@ void LogDataCollector::Collect(
     jobject obj = nullptr;
     result.value.get<jobject>(&obj);
 
-    std::vector<NamedJVariant> members;
-    object_evaluator->Evaluate(method_caller, obj, &members);
+    object_evaluator->Evaluate(method_caller, obj, &watch_result.members);
+    for (NamedJVariant& member : watch_result.members) {
+      member.value.change_ref_type(JVariant::ReferenceKind::Global);
+    }
 
-    watch_results_.push_back(FormatMembers(members));
+    watch_result.has_members = true;
+    result.value = JVariant();
   }
 }
 
 
+void LogDataCollector::AppendWatchResult(
+    const WatchResult& watch_result,
+    size_t max_size,
+    string* result) {
+  if (watch_result.has_members) {
+    AppendMembers(watch_result.members, max_size, result);
+    return;
+  }
+
+  AppendValue(watch_result.value, false, max_size, result);
+}
+
+
 NamedJVariant LogDataCollector::EvaluateWatchedExpression(
     MethodCaller* method_caller,
     const CompiledExpression& watch,
+    SharedSubexpressionValues* shared_values,
     jthread thread) const {
   if (watch.evaluator == nullptr) {
     LOG_IF(WARNING, watch.error_message.format.empty())
@@ -230,6 +242,7 @@ NamedJVariant LogDataCollector::EvaluateWatchedExpression(
   evaluation_context.thread = thread;
   evaluation_context.frame_depth = 0;
   evaluation_context.method_caller = method_caller;
+  evaluation_context.shared_values = shared_values;
 
   ErrorOr<JVariant> evaluation_result =
       watch.evaluator->Evaluate(evaluation_context);
@@ -253,19 +266,41 @@ NamedJVariant LogDataCollector::EvaluateWatchedExpression(
 }
 
 
-string LogDataCollector::Format(const BreakpointModel& breakpoint) const {
-  return SubstitutePlaceholders(
-      breakpoint.log_message_format,
-      [this] (int watch_index) -> string {
+string LogDataCollector::Format(
+    const MessageTemplate& log_message_template) const {
+  const size_t max_size = std::max(FLAGS_max_dynamic_log_message_bytes, 1);
+
+  string result;
+  result.reserve(std::min<size_t>(
+      max_size + arraysize(kTruncatedSuffix),
+      log_message_template.literals_size() +
+      log_message_template.parameters_count() * kEstimatedWatchResultSize));
+
+  log_message_template.Render(
+      [this, max_size] (int watch_index, string* result) {
+        // The message is already over the limit. Don't bother rendering
+        // values that will be cut off anyway.
+        if (result->size() >= max_size) {
+          return;
+        }
+
         if ((watch_index < 0) || (watch_index >= watch_results_.size())) {
-          return FormatMessage({
-            InvalidParameterIndex,
-            { std::to_string(watch_index) }
-          });
+          MessageTemplate::AppendFormatted(
+              InvalidParameterIndex,
+              { std::to_string(watch_index) },
+              result);
+          return;
         }
 
-        return watch_results_[watch_index];
-      });
+        AppendWatchResult(watch_results_[watch_index], max_size, result);
+      },
+      &result);
+
+  if (result.size() > max_size) {
+    TruncateMessage(max_size, &result);
+  }
+
+  return result;
 }
 
 
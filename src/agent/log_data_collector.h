@@ -21,6 +21,7 @@
 #include "common.h"
 #include "class_indexer.h"
 #include "expression_util.h"
+#include "message_template.h"
 #include "method_caller.h"
 #include "model.h"
 #include "object_evaluator.h"
@@ -29,8 +30,18 @@
 namespace devtools {
 namespace cdbg {
 
+class SharedSubexpressionValues;
+
+// Typical size of a formatted watched expression used to reserve the log
+// message buffer upfront.
+constexpr int kEstimatedWatchResultSize = 32;
+
 // Evaluates watched expressions and formats the log message string for
-// dynamic logs.
+// dynamic logs. "Collect" runs on the application thread while it is stopped
+// at the breakpoint. It evaluates the expressions (including calls to
+// "toString()") and keeps the raw values with global references to Java
+// objects. Building the message string from these values is deferred to
+// "Format", which may be called later from any thread attached to JVM.
 class LogDataCollector {
  public:
   LogDataCollector() {}
@@ -38,12 +49,17 @@ class LogDataCollector {
   // Evaluates the expressions to be included in the log message.
   void Collect(
       MethodCaller* method_caller,
+      ClassMetadataReader* class_metadata_reader,
       ObjectEvaluator* object_evaluator,
       const std::vector<CompiledExpression>& watches,
+      SharedSubexpressionValues* shared_values,
       jthread thread);
 
-  // Formats the log message string.
-  string Format(const BreakpointModel& breakpoint) const;
+  // Formats the log message string. "log_message_template" refers to the
+  // watched expressions as $0, $1, etc. The message is limited to
+  // "FLAGS_max_dynamic_log_message_bytes": strings are truncated and object
+  // members are skipped once the limit is reached.
+  string Format(const MessageTemplate& log_message_template) const;
 
  private:
   // Evaluates a watched expression. Returns compilation error message if
@@ -51,17 +67,40 @@ class LogDataCollector {
   NamedJVariant EvaluateWatchedExpression(
       MethodCaller* method_caller,
       const CompiledExpression& watch,
+      SharedSubexpressionValues* shared_values,
       jthread thread) const;
 
  private:
-  // Evaluated watched expressions. The string will contain one of:
-  // 1. Actual result of expression (if primitive type or a string).
-  // 2. Formatted error status either due to a failure to compile an expression
-  //    or due to a runtime failure.
-  // 3. Formatted object if an expression evaluates to an object. The
-  //    formatting may either call "toString()" or print out all the object
-  //    fields.
-  std::vector<string> watch_results_;
+  // Raw result of a single watched expression.
+  struct WatchResult {
+    // One of:
+    // 1. Actual result of expression (if primitive type or a string).
+    // 2. Error status either due to a failure to compile an expression
+    //    or due to a runtime failure.
+    // 3. String returned by "toString()" if an expression evaluates to an
+    //    object with a custom implementation of it.
+    // Not used if "has_members" is true.
+    NamedJVariant value;
+
+    // Set if the expression evaluates to an object that will be printed out
+    // through all its fields.
+    bool has_members { false };
+
+    // Fields of the object if "has_members" is true.
+    std::vector<NamedJVariant> members;
+  };
+
+  // Formats a single watched expression result and appends it to "result".
+  // Stops early once "result" reaches "max_size".
+  static void AppendWatchResult(
+      const WatchResult& watch_result,
+      size_t max_size,
+      string* result);
+
+ private:
+  // Evaluated watched expressions. All the references to Java objects are
+  // global references.
+  std::vector<WatchResult> watch_results_;
 
   DISALLOW_COPY_AND_ASSIGN(LogDataCollector);
 };
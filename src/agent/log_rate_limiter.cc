@@ -0,0 +1,75 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "log_rate_limiter.h"
+
+#include <algorithm>
+#include "fast_clock.h"
+
+DEFINE_double(
+    cdbg_hot_path_log_rate,
+    1,
+    "maximum number of messages per second written by a single diagnostic "
+    "on the breakpoint hit path after an initial burst; messages over the "
+    "limit are counted and reported with the next message; 0 disables the "
+    "limit");
+
+namespace devtools {
+namespace cdbg {
+
+// Number of messages a call site can log back to back before the rate limit
+// kicks in.
+static constexpr int kLogRateLimiterBurst = 10;
+
+
+std::ostream& operator<< (std::ostream& os, LogSuppressedCount suppressed) {
+  if (suppressed.count > 0) {
+    os << "(" << suppressed.count << " similar messages suppressed) ";
+  }
+
+  return os;
+}
+
+
+bool LogRateLimiter::Acquire() {
+  const double rate = FLAGS_cdbg_hot_path_log_rate;
+  if (rate <= 0) {
+    return true;
+  }
+
+  const int64 interval_ns = static_cast<int64>(1000000000 / rate);
+  const int64 max_backlog_ns = (kLogRateLimiterBurst - 1) * interval_ns;
+  const int64 now_ns = FastClock::NowNanos();
+
+  int64 refill_time_ns = refill_time_ns_.load(std::memory_order_relaxed);
+  while (true) {
+    const int64 start_ns = std::max(refill_time_ns, now_ns);
+    if (start_ns - now_ns > max_backlog_ns) {
+      suppressed_count_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    if (refill_time_ns_.compare_exchange_weak(
+            refill_time_ns,
+            start_ns + interval_ns,
+            std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,90 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_LOG_RATE_LIMITER_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_LOG_RATE_LIMITER_H_
+
+#include <atomic>
+#include <ostream>
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Number of suppressed messages reported in front of the next logged message.
+struct LogSuppressedCount {
+  int64 count;
+};
+
+// Prints nothing if no messages were suppressed.
+std::ostream& operator<< (std::ostream& os, LogSuppressedCount suppressed);
+
+// Rate limits a single logging call site on the breakpoint hit path. Some
+// diagnostics there are benign races (e.g. a hit racing with completion of
+// the breakpoint), but at high QPS they can repeat on every hit. Formatting
+// and writing a log line every time would turn such race into a storm of log
+// I/O on application threads.
+//
+// Each call site has its own token bucket allowing a short burst of messages
+// and then at most "FLAGS_cdbg_hot_path_log_rate" messages per second.
+// Messages over the limit are only counted. The count is reported with the
+// next message that gets logged.
+//
+// This class is lock free and thread safe. Instances are function local
+// statics created by "LOG_RATE_LIMITED". The constructor is constexpr, so
+// they don't need a guard variable.
+class LogRateLimiter {
+ public:
+  constexpr LogRateLimiter() { }
+
+  // Returns true if the message should be logged. Otherwise counts the
+  // message as suppressed.
+  bool Acquire();
+
+  // Gets and resets the number of messages suppressed so far.
+  LogSuppressedCount TakeSuppressedCount() {
+    return { suppressed_count_.exchange(0, std::memory_order_relaxed) };
+  }
+
+ private:
+  // Time (in "FastClock" nanoseconds) at which the bucket would be full
+  // again. This is the "theoretical arrival time" formulation of the token
+  // bucket, which only needs a single atomic.
+  std::atomic<int64> refill_time_ns_ { 0 };
+
+  // Number of messages suppressed since the last logged one.
+  std::atomic<int64> suppressed_count_ { 0 };
+
+  DISALLOW_COPY_AND_ASSIGN(LogRateLimiter);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#define CDBG_LOG_RATE_LIMITER_CONCAT(prefix, line) prefix ## line
+#define CDBG_LOG_RATE_LIMITER_NAME(line) \
+    CDBG_LOG_RATE_LIMITER_CONCAT(cdbg_log_rate_limiter_, line)
+
+// Rate limited version of "LOG(severity)" for diagnostics on the breakpoint
+// hit path (see "LogRateLimiter"). Expands to two statements (like
+// "LOG_EVERY_N"), so it can't be the unbraced body of "if" or a loop.
+#define LOG_RATE_LIMITED(severity) \
+    static ::devtools::cdbg::LogRateLimiter \
+        CDBG_LOG_RATE_LIMITER_NAME(__LINE__); \
+    LOG_IF(severity, CDBG_LOG_RATE_LIMITER_NAME(__LINE__).Acquire()) \
+        << CDBG_LOG_RATE_LIMITER_NAME(__LINE__).TakeSuppressedCount()
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_LOG_RATE_LIMITER_H_
@@ -0,0 +1,252 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lz4_block.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace devtools {
+namespace cdbg {
+
+// Shortest match the format can encode.
+constexpr int kMinMatch = 4;
+
+// The format requires the last 5 bytes of the block to be literals and the
+// last match to start at least 12 bytes before the end of the block.
+constexpr int kLastLiterals = 5;
+constexpr int kMatchFindLimit = 12;
+
+// Largest distance of a match.
+constexpr int kMaxOffset = 65535;
+
+// Lengths of literals and matches that don't fit the 4 bits of the token
+// continue in the following bytes.
+constexpr int kTokenLengthMask = 15;
+
+// Size of the hash table of recent positions (in bits).
+constexpr int kHashLog = 12;
+
+
+// Reads 4 bytes at "p" (unaligned).
+static uint32 Read32(const char* p) {
+  uint32 value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+
+// Hashes the 4 bytes starting a potential match.
+static int HashSequence(uint32 sequence) {
+  return (sequence * 2654435761u) >> (32 - kHashLog);
+}
+
+
+// Appends the part of a length that didn't fit the token.
+static void AppendLength(int length, string* block) {
+  length -= kTokenLengthMask;
+  while (length >= 255) {
+    block->push_back(static_cast<char>(255));
+    length -= 255;
+  }
+
+  block->push_back(static_cast<char>(length));
+}
+
+
+// Appends a sequence of literals followed by a match. "match_length" is 0
+// for the last sequence, which only has literals.
+static void AppendSequence(
+    const char* literals,
+    int literals_length,
+    int offset,
+    int match_length,
+    string* block) {
+  const int encoded_match_length =
+      (match_length == 0) ? 0 : match_length - kMinMatch;
+
+  block->push_back(static_cast<char>(
+      (std::min(literals_length, kTokenLengthMask) << 4) |
+      std::min(encoded_match_length, kTokenLengthMask)));
+
+  if (literals_length >= kTokenLengthMask) {
+    AppendLength(literals_length, block);
+  }
+
+  block->append(literals, literals_length);
+
+  if (match_length == 0) {
+    return;
+  }
+
+  block->push_back(static_cast<char>(offset & 0xFF));
+  block->push_back(static_cast<char>(offset >> 8));
+
+  if (encoded_match_length >= kTokenLengthMask) {
+    AppendLength(encoded_match_length, block);
+  }
+}
+
+
+// Reads the part of a length that didn't fit the token. Returns false if
+// the block ends prematurely or the length exceeds "max_length".
+static bool ReadLength(
+    const uint8** in,
+    const uint8* in_end,
+    int max_length,
+    int* length) {
+  uint8 b = 0;
+  do {
+    if (*in >= in_end) {
+      return false;
+    }
+
+    b = *(*in)++;
+    *length += b;
+    if (*length > max_length) {
+      return false;
+    }
+  } while (b == 255);
+
+  return true;
+}
+
+
+string CompressLz4Block(const char* data, int size) {
+  string block;
+  block.reserve(size + size / 255 + 16);
+
+  int anchor = 0;  // Start of the pending literals.
+
+  if (size > kMatchFindLimit) {
+    int table[1 << kHashLog];
+    std::fill(table, table + (1 << kHashLog), -1);
+
+    int pos = 0;
+    while (pos + kMatchFindLimit < size) {
+      const uint32 sequence = Read32(data + pos);
+      int& entry = table[HashSequence(sequence)];
+      const int candidate = entry;
+      entry = pos;
+
+      if ((candidate < 0) ||
+          (pos - candidate > kMaxOffset) ||
+          (Read32(data + candidate) != sequence)) {
+        ++pos;
+        continue;
+      }
+
+      int match_end = pos + kMinMatch;
+      int reference = candidate + kMinMatch;
+      while ((match_end < size - kLastLiterals) &&
+             (data[match_end] == data[reference])) {
+        ++match_end;
+        ++reference;
+      }
+
+      AppendSequence(
+          data + anchor,
+          pos - anchor,
+          pos - candidate,
+          match_end - pos,
+          &block);
+
+      pos = match_end;
+      anchor = pos;
+    }
+  }
+
+  AppendSequence(data + anchor, size - anchor, 0, 0, &block);
+
+  return block;
+}
+
+
+bool DecompressLz4Block(const string& block, int size, string* data) {
+  data->resize(size);
+  char* out = size > 0 ? &(*data)[0] : nullptr;
+  int out_pos = 0;
+
+  const uint8* in = reinterpret_cast<const uint8*>(block.data());
+  const uint8* in_end = in + block.size();
+
+  for (;;) {
+    if (in >= in_end) {
+      return false;
+    }
+
+    const uint8 token = *in++;
+
+    int literals_length = token >> 4;
+    if ((literals_length == kTokenLengthMask) &&
+        !ReadLength(&in, in_end, size, &literals_length)) {
+      return false;
+    }
+
+    if ((in_end - in < literals_length) ||
+        (size - out_pos < literals_length)) {
+      return false;
+    }
+
+    memcpy(out + out_pos, in, literals_length);
+    in += literals_length;
+    out_pos += literals_length;
+
+    // The last sequence has no match.
+    if (in == in_end) {
+      break;
+    }
+
+    if (in_end - in < 2) {
+      return false;
+    }
+
+    const int offset = in[0] | (in[1] << 8);
+    in += 2;
+    if ((offset == 0) || (offset > out_pos)) {
+      return false;
+    }
+
+    int match_length = token & kTokenLengthMask;
+    if ((match_length == kTokenLengthMask) &&
+        !ReadLength(&in, in_end, size, &match_length)) {
+      return false;
+    }
+
+    match_length += kMinMatch;
+    if (size - out_pos < match_length) {
+      return false;
+    }
+
+    // Overlapping matches repeat the last "offset" bytes, so they are copied
+    // byte by byte.
+    const char* match = out + out_pos - offset;
+    if (offset >= match_length) {
+      memcpy(out + out_pos, match, match_length);
+    } else {
+      for (int i = 0; i < match_length; ++i) {
+        out[out_pos + i] = match[i];
+      }
+    }
+
+    out_pos += match_length;
+  }
+
+  return out_pos == size;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
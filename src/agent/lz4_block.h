@@ -0,0 +1,43 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_LZ4_BLOCK_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_LZ4_BLOCK_H_
+
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Compression of memory blocks in the LZ4 block format. The agent doesn't
+// link the LZ4 library, so this is a small standalone implementation: a
+// greedy single pass compressor with a hash table of recent positions and a
+// bounds checked decompressor.
+//
+// The block doesn't store the size of the uncompressed data. The caller
+// keeps it along with the block.
+
+// Compresses "size" bytes at "data".
+string CompressLz4Block(const char* data, int size);
+
+// Decompresses a block produced by "CompressLz4Block" from data of "size"
+// bytes. Returns false if the block is corrupted.
+bool DecompressLz4Block(const string& block, int size, string* data);
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_LZ4_BLOCK_H_
@@ -122,8 +122,6 @@ void MapEntryTypeEvaluator::Evaluate(
     } else {
       member_evaluators[i].member->value =
           ErrorOr<JVariant>::detach_value(std::move(result));
-      member_evaluators[i].member->value.change_ref_type(
-          JVariant::ReferenceKind::Global);
     }
   }
 }
@@ -46,6 +46,8 @@ bool MapTypeEvaluator::Initialize() {
     return false;
   }
 
+  jdk_collections_reader_.Initialize();
+
   return true;
 }
 
@@ -64,6 +66,16 @@ void MapTypeEvaluator::Evaluate(
     const ClassMetadataReader::Entry& class_metadata,
     jobject obj,
     std::vector<NamedJVariant>* members) {
+  std::vector<JdkCollectionsReader::MapEntry> map_entries;
+  if (jdk_collections_reader_.ReadMap(
+          class_metadata.signature,
+          obj,
+          kMaxCaptureObjectElements,
+          &map_entries)) {
+    FormatMapEntries(&map_entries, members);
+    return;
+  }
+
   std::unique_ptr<FormatMessageModel> error_message;
 
   // Set<Map.Entry<K,V>> entries = obj.entrySet();
@@ -160,6 +172,65 @@ void MapTypeEvaluator::TryInlineMap(
   }
 }
 
+
+void MapTypeEvaluator::FormatMapEntries(
+    std::vector<JdkCollectionsReader::MapEntry>* entries,
+    std::vector<NamedJVariant>* members) {
+  members->clear();
+  members->reserve(entries->size() + 1);
+
+  // Inline the map only if all the keys are immutable values of the same
+  // type (see "TryInlineMap").
+  WellKnownJClass map_keys_well_known_jclass = WellKnownJClass::Unknown;
+  bool inline_map = true;
+  for (const JdkCollectionsReader::MapEntry& entry : *entries) {
+    WellKnownJClass well_known_jclass = WellKnownJClass::Unknown;
+    string signature = GetObjectClassSignature(entry.key.get());
+    if (!signature.empty()) {
+      well_known_jclass =
+          WellKnownJClassFromSignature(JSignatureFromSignature(signature));
+    }
+
+    if (!ValueFormatter::IsImmutableValueObject(well_known_jclass) ||
+        ((map_keys_well_known_jclass != WellKnownJClass::Unknown) &&
+         (map_keys_well_known_jclass != well_known_jclass))) {
+      inline_map = false;
+      break;
+    }
+
+    map_keys_well_known_jclass = well_known_jclass;
+  }
+
+  for (JdkCollectionsReader::MapEntry& entry : *entries) {
+    NamedJVariant member;
+    if (inline_map) {
+      NamedJVariant entry_key;
+      entry_key.value = JVariant::LocalRef(std::move(entry.key));
+      entry_key.well_known_jclass = map_keys_well_known_jclass;
+
+      string key;
+      ValueFormatter::Format(
+          entry_key,
+          ValueFormatter::Options(),
+          &key,
+          nullptr);
+
+      member.name.reserve(key.size() + 2);
+      member.name += '[';
+      member.name += key;
+      member.name += ']';
+      member.value = JVariant::LocalRef(std::move(entry.value));
+    } else {
+      member.name = FormatArrayIndexName(members->size());
+      member.value = JVariant::LocalRef(std::move(entry.entry));
+    }
+
+    members->push_back(std::move(member));
+  }
+
+  IterableTypeEvaluator::AppendCollectionStatus(members);
+}
+
 }  // namespace cdbg
 }  // namespace devtools
 
@@ -20,6 +20,7 @@
 #include <memory>
 #include "common.h"
 #include "iterable_type_evaluator.h"
+#include "jdk_collections_reader.h"
 #include "jni_utils.h"
 #include "map_entry_type_evaluator.h"
 #include "type_evaluator.h"
@@ -35,7 +36,10 @@ struct NamedJVariant;
 // The iteration of a map starts with iteration of the return value of
 // Map.entrySet() call. Then "MapTypeEvaluator" formats the map entries
 // as either "[key] = value" for well known key types or as
-// "[i] = { key = ..., value = ... }" for complex key types.
+// "[i] = { key = ..., value = ... }" for complex key types. Entries of
+// "java.util.HashMap", "java.util.LinkedHashMap" and
+// "java.util.concurrent.ConcurrentHashMap" are read directly from the hash
+// table when possible.
 class MapTypeEvaluator : public TypeEvaluator {
  public:
   MapTypeEvaluator();
@@ -80,6 +84,13 @@ class MapTypeEvaluator : public TypeEvaluator {
       NamedJVariant* key,
       NamedJVariant* value);
 
+  // Formats entries read by "JdkCollectionsReader" the same way as
+  // "TryInlineMap". Keys and values are already known, so no methods need
+  // to be called.
+  static void FormatMapEntries(
+      std::vector<JdkCollectionsReader::MapEntry>* entries,
+      std::vector<NamedJVariant>* members);
+
  private:
   // Used to evaluate Set<Map.Entry<K,V>> returned by Map.entrySet().
   IterableTypeEvaluator iterable_evaluator_;
@@ -90,6 +101,9 @@ class MapTypeEvaluator : public TypeEvaluator {
   // "java.lang.Map" class object.
   JavaClass map_;
 
+  // Fast path for the most common JDK maps.
+  JdkCollectionsReader jdk_collections_reader_;
+
   // Method metadata for the Java methods this pretty printer is using.
   const ClassMetadataReader::Method map_entry_set_;
 
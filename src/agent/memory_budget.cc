@@ -0,0 +1,129 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "memory_budget.h"
+
+#include <sstream>
+#include "statistician.h"
+
+DEFINE_int32(
+    max_agent_memory_mb,
+    64,
+    "maximum total native memory used by the debugger agent caches and "
+    "pending breakpoint updates (in megabytes); caches are released and new "
+    "snapshots are shrunk when the agent exceeds it; 0 disables the limit");
+
+namespace devtools {
+namespace cdbg {
+
+static MemoryBudget* g_instance = nullptr;
+
+
+void MemoryBudget::InitializeSingleton() {
+  DCHECK(g_instance == nullptr);
+
+  g_instance = new MemoryBudget();
+}
+
+
+void MemoryBudget::CleanupSingleton() {
+  delete g_instance;
+  g_instance = nullptr;
+}
+
+
+MemoryBudget* MemoryBudget::GetInstance() {
+  DCHECK(g_instance != nullptr);
+  return g_instance;
+}
+
+
+MemoryBudget::Cookie MemoryBudget::Register(
+    const char* name,
+    SizeCallback fn_size,
+    ReleaseCallback fn_release) {
+  MutexLock lock(&mu_);
+
+  consumers_.push_back({ name, fn_size, fn_release });
+  return &consumers_.back();
+}
+
+
+void MemoryBudget::Unregister(Cookie cookie) {
+  MutexLock lock(&mu_);
+
+  for (auto it = consumers_.begin(); it != consumers_.end(); ++it) {
+    if (&*it == cookie) {
+      consumers_.erase(it);
+      return;
+    }
+  }
+
+  DCHECK(false) << "Memory consumer not found";
+}
+
+
+void MemoryBudget::Update() {
+  const int64 max_bytes =
+      static_cast<int64>(FLAGS_max_agent_memory_mb) * 1024 * 1024;
+
+  MutexLock lock(&mu_);
+
+  int64 total_bytes = ComputeTotalBytes();
+  statAgentMemorySize->add(total_bytes);
+
+  if ((max_bytes > 0) && (total_bytes > max_bytes)) {
+    std::ostringstream breakdown;
+    breakdown << "pending captures: "
+              << charged_bytes_.load(std::memory_order_relaxed);
+    for (const Consumer& consumer : consumers_) {
+      breakdown << ", " << consumer.name << ": " << consumer.fn_size();
+    }
+
+    LOG(WARNING) << "Agent memory (" << total_bytes << " bytes) exceeds "
+                 << "the budget (" << max_bytes << " bytes), releasing "
+                 << "caches, " << breakdown.str();
+
+    for (const Consumer& consumer : consumers_) {
+      if (total_bytes <= max_bytes) {
+        break;
+      }
+
+      if (consumer.fn_release != nullptr) {
+        consumer.fn_release();
+        total_bytes = ComputeTotalBytes();
+      }
+    }
+  }
+
+  total_bytes_.store(total_bytes, std::memory_order_relaxed);
+  is_over_budget_.store(
+      (max_bytes > 0) && (total_bytes > max_bytes),
+      std::memory_order_relaxed);
+}
+
+
+int64 MemoryBudget::ComputeTotalBytes() const {
+  int64 total_bytes = charged_bytes_.load(std::memory_order_relaxed);
+  for (const Consumer& consumer : consumers_) {
+    total_bytes += consumer.fn_size();
+  }
+
+  return total_bytes;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
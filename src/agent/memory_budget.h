@@ -0,0 +1,130 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_MEMORY_BUDGET_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_MEMORY_BUDGET_H_
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include "common.h"
+#include "mutex.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Tracks the native memory used by the agent as a whole and compares it to
+// a single budget (FLAGS_max_agent_memory_mb). Each cache limits its own
+// size, but nothing else bounds the sum of them.
+//
+// There are two kinds of memory consumers:
+// 1. Caches register a callback reporting their current size and a callback
+//    releasing as much memory as possible. They are polled by "Update".
+// 2. Short lived objects (e.g. breakpoint captures waiting to be formatted)
+//    "Charge" their size when allocated and refund it when released.
+//
+// "Update" is called periodically from the worker thread. If the agent is
+// over budget, it asks the registered consumers to release memory (in the
+// order of registration) until the agent fits again. While the agent is
+// still over budget, new captures are taken with the minimal limits.
+//
+// This class is thread safe.
+class MemoryBudget {
+ public:
+  // Returns the current memory used by the consumer in bytes.
+  typedef std::function<int64()> SizeCallback;
+
+  // Releases memory held by the consumer.
+  typedef std::function<void()> ReleaseCallback;
+
+  // Identifies registered consumer.
+  typedef void* Cookie;
+
+  MemoryBudget() { }
+
+  // One time initialization of the global instance.
+  static void InitializeSingleton();
+
+  // One time cleanup of the global instance.
+  static void CleanupSingleton();
+
+  // Gets the global instance of this class.
+  static MemoryBudget* GetInstance();
+
+  // Registers memory consumer. "name" must be a string literal. The
+  // callbacks are invoked with an internal lock held and must not call
+  // back into this class. "fn_release" may be null if the consumer can't
+  // release anything.
+  Cookie Register(
+      const char* name,
+      SizeCallback fn_size,
+      ReleaseCallback fn_release);
+
+  // Unregisters memory consumer. No callbacks are invoked after this
+  // function returns.
+  void Unregister(Cookie cookie);
+
+  // Adds (or refunds if negative) memory of short lived objects.
+  void Charge(int64 bytes) {
+    charged_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  // Recomputes the total memory used by the agent and releases memory if
+  // the agent is over budget.
+  void Update();
+
+  // Returns true if the agent was over budget after the last "Update".
+  bool IsOverBudget() const {
+    return is_over_budget_.load(std::memory_order_relaxed);
+  }
+
+  // Gets the total memory used by the agent computed by the last "Update".
+  int64 total_bytes() const {
+    return total_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Consumer {
+    const char* name;
+    SizeCallback fn_size;
+    ReleaseCallback fn_release;
+  };
+
+  // Computes the total memory used by the agent. Must be called with "mu_"
+  // locked.
+  int64 ComputeTotalBytes() const;
+
+ private:
+  // Locks "consumers_".
+  Mutex mu_;
+
+  // Registered memory consumers. Kept in a list to keep the cookies valid.
+  std::list<Consumer> consumers_;
+
+  // Memory of short lived objects.
+  std::atomic<int64> charged_bytes_ { 0 };
+
+  // Result of the last "Update".
+  std::atomic<int64> total_bytes_ { 0 };
+  std::atomic<bool> is_over_budget_ { false };
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryBudget);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_MEMORY_BUDGET_H_
@@ -0,0 +1,105 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "message_template.h"
+
+namespace devtools {
+namespace cdbg {
+
+MessageTemplate::MessageTemplate(const string& format) {
+  literals_.reserve(format.size());
+
+  size_t position = 0;
+  while (position < format.size()) {
+    size_t next = 0;
+    const int parameter_index = ParsePlaceholder(format, position, &next);
+    if (parameter_index >= 0) {
+      segments_.push_back({ parameter_index, 0, 0 });
+      ++parameters_count_;
+      position = next;
+      continue;
+    }
+
+    // Extend the previous literal span if there is one.
+    if (segments_.empty() || (segments_.back().parameter_index >= 0)) {
+      segments_.push_back({ -1, static_cast<int>(literals_.size()), 0 });
+    }
+
+    // For "$$" this appends the single unescaped "$".
+    literals_.push_back(format[position]);
+    ++segments_.back().length;
+    position = next;
+  }
+}
+
+
+int MessageTemplate::ParsePlaceholder(
+    const string& format,
+    size_t position,
+    size_t* next) {
+  *next = position + 1;
+
+  if ((format[position] != '$') || (position + 1 == format.size())) {
+    return -1;
+  }
+
+  // "$$" is an escaped form of "$"
+  if (format[position + 1] == '$') {
+    *next = position + 2;
+    return -1;
+  }
+
+  size_t p = position + 1;
+  int parameter_index = 0;
+  while ((p < format.size()) && isdigit(format[p])) {
+    parameter_index = parameter_index * 10 + (format[p] - '0');
+    ++p;
+  }
+
+  if (p == position + 1) {
+    return -1;
+  }
+
+  *next = p;
+  return parameter_index;
+}
+
+
+void MessageTemplate::AppendFormatted(
+    const string& format,
+    const std::vector<string>& parameters,
+    string* result) {
+  result->reserve(result->size() + format.size());
+
+  size_t position = 0;
+  while (position < format.size()) {
+    size_t next = 0;
+    const int parameter_index = ParsePlaceholder(format, position, &next);
+    if (parameter_index < 0) {
+      result->push_back(format[position]);
+    } else if (parameter_index < parameters.size()) {
+      result->append(parameters[parameter_index]);
+    } else {
+      DCHECK(false) << "Bad parameter index " << parameter_index
+                    << ", format: " << format;
+    }
+
+    position = next;
+  }
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,109 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_MESSAGE_TEMPLATE_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_MESSAGE_TEMPLATE_H_
+
+#include <vector>
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Message format with parameter placeholders $0, $1, etc. compiled into a
+// list of segments. Each segment is either a literal span or a reference to
+// a parameter. "$$" is an escaped form of "$". A "$" not followed by a digit
+// is kept as is.
+//
+// Compiling the format once (e.g. per breakpoint) saves parsing it on every
+// rendering. Rendering appends everything directly to a single output buffer.
+//
+// This class is immutable and therefore thread safe.
+class MessageTemplate {
+ public:
+  explicit MessageTemplate(const string& format);
+
+  // Appends the message to "result". "append_parameter" is called as
+  // "append_parameter(int parameter_index, string* result)" for each
+  // placeholder and is expected to append the value of the parameter to
+  // "result".
+  template <typename AppendParameter>
+  void Render(AppendParameter append_parameter, string* result) const {
+    for (const Segment& segment : segments_) {
+      if (segment.parameter_index < 0) {
+        result->append(literals_, segment.offset, segment.length);
+      } else {
+        append_parameter(segment.parameter_index, result);
+      }
+    }
+  }
+
+  // Gets the total size of all the literal spans. This is the minimum size
+  // of the rendered message.
+  int literals_size() const { return literals_.size(); }
+
+  // Gets the number of placeholders in the template.
+  int parameters_count() const { return parameters_count_; }
+
+  // Appends "format" with placeholders substituted by "parameters" to
+  // "result" in a single pass without compiling the format first. Used for
+  // formats that are only rendered once. Placeholders referring to missing
+  // parameters are substituted with an empty string.
+  static void AppendFormatted(
+      const string& format,
+      const std::vector<string>& parameters,
+      string* result);
+
+ private:
+  // Either a literal span or a placeholder.
+  struct Segment {
+    // Index of the parameter or -1 if this is a literal span.
+    int parameter_index;
+
+    // Offset of the literal span in "literals_".
+    int offset;
+
+    // Length of the literal span.
+    int length;
+  };
+
+  // Parses the placeholder starting at "format[position]". Returns the
+  // index of the parameter and sets "next" to the position following the
+  // placeholder. Returns -1 if "format[position]" doesn't start a
+  // placeholder. In this case "next" is set to the position following the
+  // literal characters ("$$" is one such character).
+  static int ParsePlaceholder(
+      const string& format,
+      size_t position,
+      size_t* next);
+
+ private:
+  // All the literal spans (unescaped) concatenated together.
+  string literals_;
+
+  // Compiled format.
+  std::vector<Segment> segments_;
+
+  // Number of segments that are placeholders.
+  int parameters_count_ { 0 };
+
+  DISALLOW_COPY_AND_ASSIGN(MessageTemplate);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_MESSAGE_TEMPLATE_H_
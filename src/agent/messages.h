@@ -153,9 +153,21 @@ constexpr char InstanceFieldsOmitted[] =
 constexpr char EmptyCollection[] =
     "Empty collection";
 
+constexpr char ProtobufMessageEmpty[] =
+    "No fields set";
+
 constexpr char OutOfBufferSpace[] =
     "Buffer full";
 
+constexpr char CaptureTimeLimitExceeded[] =
+    "Capture time limit ($0 microseconds) reached";
+
+constexpr char LocalVariableNotCaptured[] =
+    "Value not captured (type: $0)";
+
+constexpr char LocalVariableNotCapturedCompiled[] =
+    "Value not captured (compiled frame, type: $0)";
+
 constexpr char NullPointerDereference[] =
     "Null pointer dereference";
 
@@ -177,6 +189,10 @@ constexpr char ConditionEvaluationCostExceededGlobalLimit[] =
     "Snapshot cancelled. The condition evaluation cost for all active "
     "snapshots might affect the application performance.";
 
+constexpr char SnapshotCancelledBacklog[] =
+    "Snapshot cancelled. The debugger can't report snapshots to the backend "
+    "fast enough. Please try again at a later time.";
+
 constexpr char CollectionNotAllItemsCaptured[] =
     "Only first $0 items were captured";
 
@@ -189,6 +205,16 @@ constexpr char ArrayTypeExpected[] =
 constexpr char ArrayIndexNotInteger[] =
     "The array index $0 is not an integer";
 
+constexpr char ArrayAggregateInvalidArguments[] =
+    "Invalid arguments of the built-in function $0";
+
+constexpr char ArrayAggregateTooLarge[] =
+    "The built-in function $0 is limited to arrays of $2 elements (the array "
+    "has $1 elements)";
+
+constexpr char ArrayAggregateEmptyArray[] =
+    "The built-in function $0 is undefined for an empty array";
+
 constexpr char InvalidParameterIndex[] =
     "Invalid parameter $$$0";
 
@@ -196,6 +222,46 @@ constexpr char DynamicLogOutOfQuota[] =
     "Dynamic log line is paused due to high log rate "
     "until log quota is restored";
 
+constexpr char MetricExpressionRequired[] =
+    "A metric breakpoint requires exactly one numeric expression";
+
+constexpr char InvalidLogSamplingRate[] =
+    "Invalid log sampling rate $0, expected a positive integer";
+
+constexpr char LogSamplingKeyNotSupported[] =
+    "Log sampling key must be of a primitive type and must not call methods";
+
+constexpr char DurationProbeLabelRequired[] =
+    "A duration breakpoint requires exactly one of the labels $0 and $1";
+
+constexpr char DurationKeyNotSupported[] =
+    "Duration key must be of a primitive type and must not call methods";
+
+constexpr char InvalidBreakpointLabel[] =
+    "Invalid value $1 of breakpoint label $0, expected an integer not less "
+    "than $2";
+
+constexpr char InvalidCaptureHits[] =
+    "Invalid number of hits to capture $0, expected an integer between 1 "
+    "and $1";
+
+constexpr char CaptureHitUnchanged[] =
+    "No changes since the first hit";
+
+constexpr char CaptureHitObjectChanged[] =
+    "Different object than in the first hit, members were not captured";
+
+constexpr char DynamicLogRepeated[] =
+    "$0 (repeated $1 more times in $2 ms)";
+
+constexpr char SnapshotFirstTierCaptured[] =
+    "Only the call stack, local variables of the top frame and watched "
+    "expressions were captured. Set the snapshot again with the DEFAULT or "
+    "DEEP capture profile to capture more.";
+
+constexpr char BreakpointGroupCaptured[] =
+    "The snapshot was captured by breakpoint $1 of the breakpoint group $0";
+
 constexpr char CanaryBreakpointUnhealthy[] =
     "The snapshot canary has failed and the snapshot cancelled. Please try "
     "again at a later time."
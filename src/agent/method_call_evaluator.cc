@@ -33,6 +33,17 @@ namespace cdbg {
 // Maximum number of supported arguments for a method call.
 constexpr int MaxMethodCallArguments = 10;
 
+// Gets the parsed signature of "method". Methods that come from the class
+// metadata cache carry it already. Returns nullptr if the signature is bad.
+static std::shared_ptr<const JMethodSignature> GetParsedSignature(
+    const ClassMetadataReader::Method& method) {
+  if (method.parsed_signature != nullptr) {
+    return method.parsed_signature;
+  }
+
+  return InternJMethodSignature(method.signature);
+}
+
 MethodCallEvaluator::MethodCallEvaluator(
     string method_name,
     std::unique_ptr<ExpressionEvaluator> instance_source,
@@ -209,33 +220,40 @@ void MethodCallEvaluator::MatchMethods(
     return;
   }
 
-  JMethodSignature signature;
-  if (!ParseJMethodSignature(matched_method.signature, &signature)) {
+  std::shared_ptr<const JMethodSignature> signature =
+      GetParsedSignature(matched_method);
+  if (signature == nullptr) {
     *error_message = INTERNAL_ERROR_MESSAGE;
     return;
   }
 
   method_ = matched_method;
-  return_type_ = signature.return_type;
+  return_type_ = signature->return_type;
+
+  // "MatchMethod" only accepts arguments whose static type is identical or
+  // assignable to the parameter type (or a "null" literal), so the values
+  // computed at runtime always satisfy the signature.
+  call_target_cache_.set_arguments_verified();
 }
 
 
 bool MethodCallEvaluator::MatchMethod(
     ReadersFactory* readers_factory,
     const ClassMetadataReader::Method& candidate_method) {
-  JMethodSignature method_signature;
-  if (!ParseJMethodSignature(candidate_method.signature, &method_signature)) {
+  std::shared_ptr<const JMethodSignature> method_signature =
+      GetParsedSignature(candidate_method);
+  if (method_signature == nullptr) {
     return false;
   }
 
-  if (method_signature.arguments.size() != arguments_.size()) {
+  if (method_signature->arguments.size() != arguments_.size()) {
     return false;
   }
 
   for (int i = 0; i < arguments_.size(); ++i) {
     if (!MatchArgument(
             readers_factory,
-            method_signature.arguments[i],
+            method_signature->arguments[i],
             *arguments_[i])) {
       return false;
     }
@@ -384,7 +402,15 @@ ErrorOr<JVariant> MethodCallEvaluator::Evaluate(
     arguments.push_back(ErrorOr<JVariant>::detach_value(std::move(arg_value)));
   }
 
-  return evaluation_context.method_caller->Invoke(
+  // Method calls are only allowed if the caller provided "MethodCaller". This
+  // should never happen if "HasMethodCalls" was consulted.
+  if (evaluation_context.method_caller == nullptr) {
+    DCHECK(false) << "Method call evaluated without MethodCaller";
+    return INTERNAL_ERROR_MESSAGE;
+  }
+
+  return evaluation_context.method_caller->InvokeCached(
+      &call_target_cache_,
       method_,
       source.value(),
       std::move(arguments));
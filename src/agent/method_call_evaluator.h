@@ -18,8 +18,10 @@
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_METHOD_CALL_EVALUATOR_H_
 
 #include "common.h"
+#include "call_target_cache.h"
 #include "class_metadata_reader.h"
 #include "expression_evaluator.h"
+#include "expression_program.h"
 
 namespace devtools {
 namespace cdbg {
@@ -46,6 +48,12 @@ class MethodCallEvaluator : public ExpressionEvaluator {
 
   Nullable<jvalue> GetStaticValue() const override { return nullptr; }
 
+  bool HasMethodCalls() const override { return true; }
+
+  int Lower(ExpressionProgramBuilder* builder) const override {
+    return builder->AddLeaf(*this);
+  }
+
   ErrorOr<JVariant> Evaluate(
       const EvaluationContext& evaluation_context) const override;
 
@@ -125,6 +133,10 @@ class MethodCallEvaluator : public ExpressionEvaluator {
   // Return value of the method.
   JSignature return_type_;
 
+  // Call target resolved on the previous evaluation. Logically not part of
+  // the state of the compiled expression.
+  mutable CallTargetCache call_target_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(MethodCallEvaluator);
 };
 
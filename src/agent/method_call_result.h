@@ -140,12 +140,11 @@ inline MethodCallResult MethodCallResult::PendingJniException() {
 
 
 inline MethodCallResult MethodCallResult::Success(JVariant return_value) {
-  // If the return value is an object, we need to make sure we don't keep
-  // local reference. Local references will be discarded once
-  // "JNIEnv::PopLocalFrame" is called and we want to persist the return
-  // value for longer than that.
-  return_value.change_ref_type(JVariant::ReferenceKind::Global);
-
+  // Object return values are kept as local references. They are only needed
+  // for the rest of the expression evaluation. Code that keeps the value
+  // longer (e.g. the captured watched expressions) promotes it to a global
+  // reference. "NanoJavaInterpreter" carries the value out of its local
+  // frame itself.
   MethodCallResult result;
   result.result_type_ = Type::Success;
   result.data_ = std::move(return_value);
@@ -17,6 +17,8 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_METHOD_CALLER_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_METHOD_CALLER_H_
 
+#include <functional>
+#include <memory>
 #include "common.h"
 #include "class_metadata_reader.h"
 #include "model_util.h"
@@ -24,6 +26,7 @@
 namespace devtools {
 namespace cdbg {
 
+class CallTargetCache;
 class JVariant;
 
 // Invokes Java method (either static or instance).
@@ -40,8 +43,25 @@ class MethodCaller {
       const ClassMetadataReader::Method& metadata,
       const JVariant& source,
       std::vector<JVariant> arguments) = 0;
+
+  // Same as "Invoke", but allows the implementation to reuse the call target
+  // resolved by previous calls from the same call site. "call_target_cache"
+  // is owned by the call site and is shared across threads. The default
+  // implementation ignores the cache.
+  virtual ErrorOr<JVariant> InvokeCached(
+      CallTargetCache* call_target_cache,
+      const ClassMetadataReader::Method& metadata,
+      const JVariant& source,
+      std::vector<JVariant> arguments) {
+    return Invoke(metadata, source, std::move(arguments));
+  }
 };
 
+// Owning pointer to "MethodCaller". The deleter may return the instance to
+// a pool rather than destroying it.
+typedef std::unique_ptr<MethodCaller, std::function<void(MethodCaller*)>>
+    MethodCallerPtr;
+
 }  // namespace cdbg
 }  // namespace devtools
 
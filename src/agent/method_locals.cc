@@ -16,9 +16,12 @@
 
 #include "method_locals.h"
 
+#include <algorithm>
 #include "jni_utils.h"
 #include "jvm_local_variable_reader.h"
 #include "jvmti_buffer.h"
+#include "location_index.h"
+#include "method_unload_filter.h"
 
 namespace devtools {
 namespace cdbg {
@@ -29,9 +32,20 @@ MethodLocals::MethodLocals(
 }
 
 
+MethodLocals::~MethodLocals() {
+  for (const auto& method_vars : method_vars_) {
+    MethodUnloadFilter::Remove(method_vars.first);
+  }
+}
+
+
 // Note: JNIEnv* is not available through jni() call.
 void MethodLocals::JvmtiOnCompiledMethodUnload(jmethodID method) {
-  method_vars_.erase(method);
+  MutexLock writer_lock(&mu_);
+
+  if (method_vars_.erase(method) > 0) {
+    MethodUnloadFilter::Remove(method);
+  }
 }
 
 
@@ -58,6 +72,9 @@ std::shared_ptr<const MethodLocals::Entry> MethodLocals::GetLocalVariables(
 
     auto in = method_vars_.insert(
         std::make_pair(method, std::move(locals)));
+    if (in.second) {
+      MethodUnloadFilter::Add(method);
+    }
 
     return in.first->second;
   }
@@ -125,17 +142,88 @@ std::shared_ptr<MethodLocals::Entry> MethodLocals::LoadEntry(
 
   for (int i = 0; i < num_entries; ++i) {
     const jvmtiLocalVariableEntry& local_variable_entry = table.get()[i];
-    entry->locals.push_back(
-        std::unique_ptr<LocalVariableReader>(
-            new JvmLocalVariableReader(
-                local_variable_entry,
-                local_variable_entry.slot < arguments_size)));
+    const bool is_argument = local_variable_entry.slot < arguments_size;
+    std::unique_ptr<LocalVariableReader> reader(
+        new JvmLocalVariableReader(local_variable_entry, is_argument));
+
+    entry->slots.push_back(local_variable_entry.slot);
+    entry->types.push_back(reader->GetStaticType().type);
+    entry->is_argument.push_back(is_argument);
+    entry->well_known_jclasses.push_back(
+        WellKnownJClassFromSignature(reader->GetStaticType()));
+    entry->names.push_back(&reader->GetName());
+
+    entry->locals.push_back(std::move(reader));
   }
 
+  IndexLocals(table.get(), num_entries, entry.get());
+
   return entry;
 }
 
 
+void MethodLocals::IndexLocals(
+    const jvmtiLocalVariableEntry* table,
+    int num_entries,
+    Entry* entry) {
+  for (int i = 0; i < num_entries; ++i) {
+    entry->ranges.push_back(table[i].start_location);
+    entry->ranges.push_back(table[i].start_location + table[i].length);
+  }
+
+  std::sort(entry->ranges.begin(), entry->ranges.end());
+  entry->ranges.erase(
+      std::unique(entry->ranges.begin(), entry->ranges.end()),
+      entry->ranges.end());
+
+  entry->range_offsets.reserve(entry->ranges.size() + 1);
+  entry->range_offsets.push_back(0);
+  for (int range = 0; range < entry->ranges.size(); ++range) {
+    const jlocation location = entry->ranges[range];
+    for (int i = 0; i < num_entries; ++i) {
+      // Same condition as in "JvmLocalVariableReader::IsDefinedAtLocation".
+      if ((location >= table[i].start_location) &&
+          (location < table[i].start_location + table[i].length)) {
+        entry->range_locals.push_back(i);
+      }
+    }
+
+    entry->range_offsets.push_back(entry->range_locals.size());
+  }
+
+  entry->range_arguments.reserve(entry->ranges.size());
+  for (int range = 0; range < entry->ranges.size(); ++range) {
+    int arguments_count = 0;
+    for (int i = entry->range_offsets[range];
+         i < entry->range_offsets[range + 1];
+         ++i) {
+      if (entry->is_argument[entry->range_locals[i]]) {
+        ++arguments_count;
+      }
+    }
+
+    entry->range_arguments.push_back(arguments_count);
+  }
+}
+
+
+int MethodLocals::Entry::FindRange(jlocation location) const {
+  return FindLocationInterval(ranges.data(), ranges.size(), location);
+}
+
+
+MethodLocals::Entry::LocalsRange MethodLocals::Entry::FindLocals(
+    jlocation location) const {
+  const int range = FindRange(location);
+  if (range == -1) {
+    return { nullptr, nullptr };
+  }
+
+  const int* data = range_locals.data();
+  return { data + range_offsets[range], data + range_offsets[range + 1] };
+}
+
+
 std::unique_ptr<LocalVariableReader> MethodLocals::LoadLocalInstance(
     jclass cls,
     jmethodID method) {
@@ -22,6 +22,7 @@
 #include <vector>
 #include "common.h"
 #include "mutex.h"
+#include "type_util.h"
 
 namespace devtools {
 namespace cdbg {
@@ -50,11 +51,54 @@ class MethodLocals {
   // "JNIEnv*" is not going to be available. Therefore this structure must not
   // contain anything that requires "JNIEnv*" in destructor (e.g. "JVariant").
   struct Entry {
+    // Range of indexes in "locals".
+    struct LocalsRange {
+      const int* first;
+      const int* last;
+
+      const int* begin() const { return first; }
+      const int* end() const { return last; }
+    };
+
     // List of local variables.
     std::vector<std::unique_ptr<LocalVariableReader>> locals;
 
     // Reader of "this" or null if the method is static.
     std::unique_ptr<LocalVariableReader> local_instance;
+
+    // Sorted boundaries of code ranges in which the set of defined local
+    // variables doesn't change. The range "i" is [ranges[i], ranges[i + 1]).
+    std::vector<jlocation> ranges;
+
+    // Indexes of local variables defined in the range "i" are
+    // "range_locals[range_offsets[i]..range_offsets[i + 1])". There is one
+    // more element in "range_offsets" than in "ranges".
+    std::vector<int> range_offsets;
+    std::vector<int> range_locals;
+
+    // Number of method arguments among the local variables defined in the
+    // range "i".
+    std::vector<int> range_arguments;
+
+    // Read plan of the local variables: arrays parallel to "locals", so that
+    // a breakpoint hit reads the variables defined at its location in a
+    // tight loop (see "JvmLocalVariableReader::ReadSlot") rather than
+    // through virtual calls to "LocalVariableReader".
+    std::vector<jint> slots;
+    std::vector<JType> types;
+    std::vector<bool> is_argument;
+    std::vector<WellKnownJClass> well_known_jclasses;
+
+    // Names of the local variables. Point to the names owned by "locals".
+    std::vector<const string*> names;
+
+    // Gets the index of the range containing "location" or -1 if no local
+    // variable is defined there.
+    int FindRange(jlocation location) const;
+
+    // Gets indexes in "locals" of local variables defined at "location" (in
+    // the order of "locals").
+    LocalsRange FindLocals(jlocation location) const;
   };
 
   // "local_variables_visibility_policy" is not owned by this class and must
@@ -62,7 +106,7 @@ class MethodLocals {
   explicit MethodLocals(
       LocalVariablesVisibilityPolicy* local_variables_visibility_policy);
 
-  virtual ~MethodLocals() {}
+  virtual ~MethodLocals();
 
   // Gets readers for all local variable available at a particular code
   // location. The function returns "shared_ptr" to ensure that the caller
@@ -79,6 +123,13 @@ class MethodLocals {
   // Loads "Entry" information for the specified Java method.
   std::shared_ptr<Entry> LoadEntry(jmethodID method);
 
+  // Builds "ranges" index of local variables in "entry". "table" is the
+  // local variables table in the same order as "entry->locals".
+  static void IndexLocals(
+      const jvmtiLocalVariableEntry* table,
+      int num_entries,
+      Entry* entry);
+
   // Load information about local instance (i.e. "this" pointer). Returns
   // nullptr for static methods.
   static std::unique_ptr<LocalVariableReader> LoadLocalInstance(
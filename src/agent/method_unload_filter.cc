@@ -0,0 +1,71 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "method_unload_filter.h"
+
+namespace devtools {
+namespace cdbg {
+
+constexpr int MethodUnloadFilter::kCountersCount;
+constexpr uint16 MethodUnloadFilter::kStuckCounter;
+
+std::atomic<uint16>
+    MethodUnloadFilter::counters_[MethodUnloadFilter::kCountersCount];
+
+
+void MethodUnloadFilter::Add(jmethodID method) {
+  uint32 first;
+  uint32 second;
+  GetCounters(method, &first, &second);
+
+  UpdateCounter(first, 1);
+  UpdateCounter(second, 1);
+}
+
+
+void MethodUnloadFilter::Remove(jmethodID method) {
+  uint32 first;
+  uint32 second;
+  GetCounters(method, &first, &second);
+
+  UpdateCounter(first, -1);
+  UpdateCounter(second, -1);
+}
+
+
+void MethodUnloadFilter::UpdateCounter(uint32 index, int delta) {
+  std::atomic<uint16>& counter = counters_[index];
+
+  uint16 value = counter.load(std::memory_order_relaxed);
+  do {
+    // Once a counter overflows, we no longer know how many methods map into
+    // it, so it can never be decremented safely.
+    if (value == kStuckCounter) {
+      return;
+    }
+
+    DCHECK((delta > 0) || (value > 0));
+    if ((delta < 0) && (value == 0)) {
+      return;
+    }
+  } while (!counter.compare_exchange_weak(
+      value,
+      static_cast<uint16>(value + delta),
+      std::memory_order_relaxed));
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,85 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_METHOD_UNLOAD_FILTER_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_METHOD_UNLOAD_FILTER_H_
+
+#include <atomic>
+#include <cstdint>
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Counting Bloom filter of the methods (jmethodID) that any of the agent
+// caches holds. JIT heavy applications unload compiled methods all the time
+// and almost none of them are of any interest to the debugger. The
+// COMPILED_METHOD_UNLOAD callback checks the filter first and skips routing
+// the event to the caches (and locking each of them) if the method is
+// definitely not cached.
+//
+// Caches call "Add" before they start holding a method and "Remove" after
+// they no longer do. Each "Add" must be matched by exactly one "Remove" from
+// the same cache. A counter that overflows sticks at the maximum value, so
+// the filter may report false positives, but never false negatives.
+//
+// All the functions are lock free and safe to call in JVMTI callbacks.
+class MethodUnloadFilter {
+ public:
+  // Records that one more cache holds "method".
+  static void Add(jmethodID method);
+
+  // Reverts a single "Add" of "method".
+  static void Remove(jmethodID method);
+
+  // Returns false if no cache holds "method". Two relaxed loads.
+  static bool MayContain(jmethodID method) {
+    uint32 first;
+    uint32 second;
+    GetCounters(method, &first, &second);
+
+    return (counters_[first].load(std::memory_order_relaxed) != 0) &&
+           (counters_[second].load(std::memory_order_relaxed) != 0);
+  }
+
+ private:
+  MethodUnloadFilter() = delete;
+
+  // Number of counters in the filter (must be a power of 2).
+  static constexpr int kCountersCount = 1 << 14;
+
+  // Value that a counter sticks at once it overflows.
+  static constexpr uint16 kStuckCounter = 0xFFFF;
+
+  // Computes the indexes of the two counters of "method".
+  static void GetCounters(jmethodID method, uint32* first, uint32* second) {
+    const uint64 hash =
+        static_cast<uint64>(reinterpret_cast<uintptr_t>(method)) *
+        0x9E3779B97F4A7C15ULL;
+    *first = static_cast<uint32>(hash >> 32) & (kCountersCount - 1);
+    *second = static_cast<uint32>(hash >> 48) & (kCountersCount - 1);
+  }
+
+  // Increments or decrements the counter unless it's stuck.
+  static void UpdateCounter(uint32 index, int delta);
+
+  static std::atomic<uint16> counters_[kCountersCount];
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_METHOD_UNLOAD_FILTER_H_
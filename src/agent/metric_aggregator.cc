@@ -0,0 +1,185 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metric_aggregator.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include "atomic_util.h"
+
+namespace devtools {
+namespace cdbg {
+
+constexpr int MetricAggregator::kBucketCount;
+
+// Formats a sample value for the breakpoint update.
+static string FormatSample(double value) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.15g", value);
+  return buffer;
+}
+
+
+// Appends a member with the specified name and value to "variable".
+static void AddMember(
+    const string& name,
+    string value,
+    VariableBuilder* variable) {
+  VariableBuilder member;
+  member.set_name(name);
+  member.set_value(std::move(value));
+  variable->add_member(member);
+}
+
+
+MetricAggregator::MetricAggregator() {
+  min_.store(HUGE_VAL, std::memory_order_relaxed);
+  max_.store(-HUGE_VAL, std::memory_order_relaxed);
+  for (std::atomic<int64>& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+
+bool MetricAggregator::GetSample(const JVariant& value, double* sample) {
+  switch (value.type()) {
+    case JType::Byte: {
+      jbyte b = 0;
+      value.get<jbyte>(&b);
+      *sample = b;
+      return true;
+    }
+
+    case JType::Char: {
+      jchar c = 0;
+      value.get<jchar>(&c);
+      *sample = c;
+      return true;
+    }
+
+    case JType::Short: {
+      jshort s = 0;
+      value.get<jshort>(&s);
+      *sample = s;
+      return true;
+    }
+
+    case JType::Int: {
+      jint i = 0;
+      value.get<jint>(&i);
+      *sample = i;
+      return true;
+    }
+
+    case JType::Long: {
+      jlong j = 0;
+      value.get<jlong>(&j);
+      *sample = static_cast<double>(j);
+      return true;
+    }
+
+    case JType::Float: {
+      jfloat f = 0;
+      value.get<jfloat>(&f);
+      *sample = f;
+      return !isnan(*sample);
+    }
+
+    case JType::Double: {
+      jdouble d = 0;
+      value.get<jdouble>(&d);
+      *sample = d;
+      return !isnan(*sample);
+    }
+
+    case JType::Void:
+    case JType::Boolean:
+    case JType::Object:
+      return false;
+  }
+
+  return false;
+}
+
+
+int MetricAggregator::GetBucket(double sample) {
+  if (!(sample >= 1)) {
+    return 0;
+  }
+
+  // "sample" is in [2^(exponent-1), 2^exponent).
+  int exponent = 0;
+  frexp(sample, &exponent);
+
+  return std::min(exponent, kBucketCount - 1);
+}
+
+
+void MetricAggregator::Add(double sample) {
+  count_.fetch_add(1, std::memory_order_relaxed);
+  AtomicAdd(&sum_, sample);
+  AtomicMin(&min_, sample);
+  AtomicMax(&max_, sample);
+  buckets_[GetBucket(sample)].fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void MetricAggregator::Format(VariableBuilder* variable) const {
+  const int64 count = count_.load(std::memory_order_relaxed);
+  const double sum = sum_.load(std::memory_order_relaxed);
+
+  AddMember("count", std::to_string(count), variable);
+  AddMember("errors", std::to_string(errors_), variable);
+
+  if (count == 0) {
+    return;
+  }
+
+  AddMember("sum", FormatSample(sum), variable);
+  AddMember("mean", FormatSample(sum / count), variable);
+  AddMember("min", FormatSample(min_.load(std::memory_order_relaxed)),
+            variable);
+  AddMember("max", FormatSample(max_.load(std::memory_order_relaxed)),
+            variable);
+
+  // Only list the buckets that have samples.
+  VariableBuilder histogram;
+  histogram.set_name("histogram");
+  for (int i = 0; i < kBucketCount; ++i) {
+    const int64 bucket_count = buckets_[i].load(std::memory_order_relaxed);
+    if (bucket_count == 0) {
+      continue;
+    }
+
+    string name;
+    if (i == 0) {
+      name = "< 1";
+    } else if (i == kBucketCount - 1) {
+      name = ">= " + FormatSample(ldexp(1, i - 1));
+    } else {
+      name = "[" + FormatSample(ldexp(1, i - 1)) + ", " +
+             FormatSample(ldexp(1, i)) + ")";
+    }
+
+    AddMember(name, std::to_string(bucket_count), &histogram);
+  }
+
+  variable->add_member(histogram);
+}
+
+}  // namespace cdbg
+}  // namespace devtools
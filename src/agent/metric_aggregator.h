@@ -0,0 +1,83 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_METRIC_AGGREGATOR_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_METRIC_AGGREGATOR_H_
+
+#include <atomic>
+#include "common.h"
+#include "jvariant.h"
+#include "model_util.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Aggregates the values of the numeric expression of a metric breakpoint
+// (see "BreakpointModel::Action::METRIC") in native memory: count, sum,
+// minimum, maximum and a histogram with a bucket per power of two. Only the
+// aggregate is reported to the backend, so a metric breakpoint can stay on
+// a hot code path for a fraction of the cost of logging every hit.
+//
+// The aggregate is cumulative since the breakpoint was set. "Add" is called
+// on the breakpoint hit path, so it never takes a lock. Values read while
+// samples are being added may be slightly inconsistent with each other.
+//
+// This class is thread safe.
+class MetricAggregator {
+ public:
+  MetricAggregator();
+
+  // Converts the value of a primitive numeric Java type to a metric sample.
+  // Returns false if "value" is not numeric (e.g. boolean or an object).
+  static bool GetSample(const JVariant& value, double* sample);
+
+  // Adds a new sample to the aggregate.
+  void Add(double sample);
+
+  // Counts a hit at which the value could not be computed.
+  void AddError() { errors_.fetch_add(1, std::memory_order_relaxed); }
+
+  // Gets the number of samples added.
+  int64 count() const { return count_.load(std::memory_order_relaxed); }
+
+  // Fills "variable" with the aggregate. The values are added as members
+  // of "variable".
+  void Format(VariableBuilder* variable) const;
+
+ private:
+  // Number of histogram buckets. Bucket 0 counts samples smaller than 1
+  // (including negative ones). Bucket "i" counts samples in
+  // [2^(i-1), 2^i). The last bucket also counts all the larger samples.
+  static constexpr int kBucketCount = 64;
+
+  // Gets the histogram bucket of a sample.
+  static int GetBucket(double sample);
+
+ private:
+  std::atomic<int64> count_ { 0 };
+  std::atomic<double> sum_ { 0 };
+  std::atomic<double> min_;
+  std::atomic<double> max_;
+  std::atomic<int64> errors_ { 0 };
+  std::atomic<int64> buckets_[kBucketCount];
+
+  DISALLOW_COPY_AND_ASSIGN(MetricAggregator);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_METRIC_AGGREGATOR_H_
@@ -71,6 +71,55 @@ struct VariableModel {
   std::unique_ptr<StatusMessageModel> status;
 };
 
+// Variable table in a flat form. Variables are records linked by index and
+// all their strings share a single buffer, so a snapshot with thousands of
+// variable table entries takes a few vectors rather than a heap object and
+// several strings per variable. Produced by "CaptureDataCollector" and
+// written by the serializer without conversion to "VariableModel".
+struct FlatVariableTableModel {
+  // Substring of "strings".
+  struct StringRef {
+    uint32 offset = 0;
+    uint32 length = 0;
+  };
+
+  // Same fields as "VariableModel".
+  struct Variable {
+    StringRef name;
+    bool has_value = false;
+    StringRef value;
+    StringRef type;
+    int64 var_table_index = -1;  // -1 if not set.
+    int32 status = -1;  // Index in "statuses" or -1 if not set.
+    int32 first_member = 0;  // Index in "variables" of the first member.
+    int32 members_count = 0;  // Members are stored next to each other.
+  };
+
+  // Index in "variables" of each entry of the variable table.
+  std::vector<int32> entries;
+
+  std::vector<Variable> variables;
+
+  // Characters of all strings referenced by "variables".
+  string strings;
+
+  std::vector<StatusMessageModel> statuses;
+
+  // Appends the string to "strings".
+  StringRef AddString(const string& str) {
+    StringRef ref;
+    ref.offset = strings.size();
+    ref.length = str.size();
+    strings.append(str);
+    return ref;
+  }
+
+  // Gets the copy of the string referenced by "ref".
+  string GetString(StringRef ref) const {
+    return strings.substr(ref.offset, ref.length);
+  }
+};
+
 struct StackFrameModel {
   string function;
   std::unique_ptr<SourceLocationModel> location;
@@ -81,7 +130,10 @@ struct StackFrameModel {
 struct BreakpointModel {
   enum class Action {
     CAPTURE = 0,
-    LOG = 1
+    LOG = 1,
+    METRIC = 2,
+    PROFILE = 3,
+    DURATION = 4
   };
 
   enum class LogLevel {
@@ -90,6 +142,17 @@ struct BreakpointModel {
     ERROR = 2
   };
 
+  // Amount of data captured by a snapshot breakpoint. Smaller captures pause
+  // the application thread for shorter time.
+  enum class CaptureProfile {
+    DEFAULT = 0,  // The serialization code assumes default is DEFAULT.
+    MINIMAL = 1,  // Top frame only, referenced objects are not explored.
+    DEEP = 2,     // More frames with local variables and larger data quota.
+    TIERED = 3    // Call stack, top frame locals and watched expressions.
+                  // More is captured by setting the breakpoint again with
+                  // a richer profile (which reuses the compiled breakpoint).
+  };
+
   string id;
   bool is_canary = false;
   Action action = Action::CAPTURE;
@@ -98,12 +161,15 @@ struct BreakpointModel {
   std::vector<string> expressions;
   string log_message_format;
   LogLevel log_level = LogLevel::INFO;
+  CaptureProfile capture_profile = CaptureProfile::DEFAULT;
   bool is_final_state = false;
   TimestampModel create_time;
   std::unique_ptr<StatusMessageModel> status;
   std::vector<std::unique_ptr<StackFrameModel>> stack;
   std::vector<std::unique_ptr<VariableModel>> evaluated_expressions;
   std::vector<std::unique_ptr<VariableModel>> variable_table;
+  // Captured variable table. If set, "variable_table" is empty.
+  std::shared_ptr<const FlatVariableTableModel> flat_variable_table;
   std::map<string, string> labels;
 };
 
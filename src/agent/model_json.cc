@@ -16,6 +16,9 @@
 
 #include "model_json.h"
 
+#include <cstring>
+#include <limits>
+#include "format_util.h"
 #include "jni_proxy_api_client_datetime.h"
 #include "jsoncpp_util.h"
 #include "model_util.h"
@@ -50,7 +53,10 @@ static const struct BreakpointActionCode {
   const char* enum_string;
 } breakpoint_action_codes_map[] = {
   ENUM_CODE_MAP(BreakpointModel::Action, CAPTURE),
-  ENUM_CODE_MAP(BreakpointModel::Action, LOG)
+  ENUM_CODE_MAP(BreakpointModel::Action, LOG),
+  ENUM_CODE_MAP(BreakpointModel::Action, METRIC),
+  ENUM_CODE_MAP(BreakpointModel::Action, PROFILE),
+  ENUM_CODE_MAP(BreakpointModel::Action, DURATION)
 };
 
 
@@ -65,6 +71,18 @@ static const struct BreakpointLogLevelCode {
 };
 
 
+// Maps capture profile to enum strings.
+static const struct BreakpointCaptureProfileCode {
+  BreakpointModel::CaptureProfile enum_code;
+  const char* enum_string;
+} breakpoint_capture_profile_codes_map[] = {
+  ENUM_CODE_MAP(BreakpointModel::CaptureProfile, DEFAULT),
+  ENUM_CODE_MAP(BreakpointModel::CaptureProfile, MINIMAL),
+  ENUM_CODE_MAP(BreakpointModel::CaptureProfile, DEEP),
+  ENUM_CODE_MAP(BreakpointModel::CaptureProfile, TIERED)
+};
+
+
 // All DeserializeModel(root) methods are implemented through template
 // specialization.
 template <typename TModel>
@@ -245,6 +263,26 @@ static void SerializeLogLevel(
 }
 
 
+static void SerializeCaptureProfile(
+    BreakpointModel::CaptureProfile capture_profile,
+    Json::Value* root) {
+  // No need to set the default values.
+  if (capture_profile == BreakpointModel::CaptureProfile::DEFAULT) {
+    return;
+  }
+
+  for (const auto& entry : breakpoint_capture_profile_codes_map) {
+    if (capture_profile == entry.enum_code) {
+      (*root)["captureProfile"] = Json::Value(entry.enum_string);
+      return;
+    }
+  }
+
+  LOG(ERROR) << "Invalid 'capture_profile' value: "
+             << static_cast<int>(capture_profile);
+}
+
+
 // Returns seconds and milliseconds formatted as an RFC3339 timestamp string.
 // Returns empty string in case of error.
 static string FormatTime(int64 seconds, int32 millis) {
@@ -266,9 +304,9 @@ static string FormatTime(int64 seconds, int32 millis) {
 }
 
 
-static void SerializeTimestamp(
-    const TimestampModel& model,
-    Json::Value* root) {
+// Formats the timestamp as RFC3339 string. Logs and returns empty string in
+// case of error.
+static string FormatTimestamp(const TimestampModel& model) {
   string value = FormatTime(model.seconds, model.nanos / (1000 * 1000));
   if (value.empty()) {
     LOG(ERROR) << "Failed to format timestamp value: "
@@ -276,7 +314,14 @@ static void SerializeTimestamp(
                << ", nanos=" << model.nanos;
   }
 
-  (*root) = Json::Value(value);
+  return value;
+}
+
+
+static void SerializeTimestamp(
+    const TimestampModel& model,
+    Json::Value* root) {
+  (*root) = Json::Value(FormatTimestamp(model));
 }
 
 
@@ -315,8 +360,7 @@ StatusMessageModel::Context DeserializeRefersTo(const Json::Value& root) {
 }
 
 
-BreakpointModel::Action DeserializeBreakpointAction(const Json::Value& root) {
-  const string& action = JsonCppGetString(root, "action");
+static BreakpointModel::Action ParseBreakpointAction(const string& action) {
   if (action.empty()) {
     return BreakpointModel::Action::CAPTURE;  // default
   }
@@ -332,8 +376,12 @@ BreakpointModel::Action DeserializeBreakpointAction(const Json::Value& root) {
 }
 
 
-BreakpointModel::LogLevel DeserializeLogLevel(const Json::Value& root) {
-  const string& log_level = JsonCppGetString(root, "logLevel");
+BreakpointModel::Action DeserializeBreakpointAction(const Json::Value& root) {
+  return ParseBreakpointAction(JsonCppGetString(root, "action"));
+}
+
+
+static BreakpointModel::LogLevel ParseLogLevel(const string& log_level) {
   if (log_level.empty()) {
     return BreakpointModel::LogLevel::INFO;  // default
   }
@@ -349,6 +397,34 @@ BreakpointModel::LogLevel DeserializeLogLevel(const Json::Value& root) {
 }
 
 
+BreakpointModel::LogLevel DeserializeLogLevel(const Json::Value& root) {
+  return ParseLogLevel(JsonCppGetString(root, "logLevel"));
+}
+
+
+static BreakpointModel::CaptureProfile ParseCaptureProfile(
+    const string& capture_profile) {
+  if (capture_profile.empty()) {
+    return BreakpointModel::CaptureProfile::DEFAULT;  // default
+  }
+
+  for (const auto& entry : breakpoint_capture_profile_codes_map) {
+    if (capture_profile == entry.enum_string) {
+      return entry.enum_code;
+    }
+  }
+
+  LOG(ERROR) << "Invalid 'capture_profile' value: " << capture_profile;
+  return BreakpointModel::CaptureProfile::DEFAULT;
+}
+
+
+BreakpointModel::CaptureProfile DeserializeCaptureProfile(
+    const Json::Value& root) {
+  return ParseCaptureProfile(JsonCppGetString(root, "captureProfile"));
+}
+
+
 // Parses RFC3339 timestamp string and convert it into the number of
 // milliseconds passed since Unix epoch. Returns 0 in case of error.
 static int64 ParseTime(const string& input) {
@@ -365,13 +441,9 @@ static int64 ParseTime(const string& input) {
 }
 
 
-TimestampModel DeserializeTimestamp(const Json::Value& root) {
-  if (!root.isString()) {
-    return kUnspecifiedTimestamp;
-  }
-
-  string value = root.asString();
-
+// Parses RFC3339 timestamp string. Returns "kUnspecifiedTimestamp" in case
+// of error.
+static TimestampModel ParseTimestamp(const string& value) {
   int64 total_millis = ParseTime(value);
   if (total_millis == 0) {
     return kUnspecifiedTimestamp;
@@ -385,6 +457,15 @@ TimestampModel DeserializeTimestamp(const Json::Value& root) {
 }
 
 
+TimestampModel DeserializeTimestamp(const Json::Value& root) {
+  if (!root.isString()) {
+    return kUnspecifiedTimestamp;
+  }
+
+  return ParseTimestamp(root.asString());
+}
+
+
 template <>
 std::unique_ptr<StatusMessageModel> DeserializeModel<StatusMessageModel>(
     const Json::Value& root) {
@@ -535,6 +616,39 @@ std::unique_ptr<StackFrameModel> DeserializeModel<StackFrameModel>(
 }
 
 
+// Converts a variable of the flat variable table to "VariableModel". Only
+// used for logging, so the extra allocations don't matter.
+static std::unique_ptr<VariableModel> ExpandVariable(
+    const FlatVariableTableModel& model,
+    int32 index) {
+  const FlatVariableTableModel::Variable& variable = model.variables[index];
+
+  std::unique_ptr<VariableModel> target(new VariableModel);
+  target->name = model.GetString(variable.name);
+  if (variable.has_value) {
+    target->value = model.GetString(variable.value);
+  }
+
+  target->type = model.GetString(variable.type);
+
+  if (variable.var_table_index != -1) {
+    target->var_table_index = variable.var_table_index;
+  }
+
+  for (int32 i = 0; i < variable.members_count; ++i) {
+    target->members.push_back(
+        ExpandVariable(model, variable.first_member + i));
+  }
+
+  if (variable.status != -1) {
+    target->status.reset(
+        new StatusMessageModel(model.statuses[variable.status]));
+  }
+
+  return target;
+}
+
+
 static void SerializeModel(
     const BreakpointModel& model,
     Json::Value* root) {
@@ -558,6 +672,8 @@ static void SerializeModel(
 
   SerializeLogLevel(model.log_level, root);
 
+  SerializeCaptureProfile(model.capture_profile, root);
+
   // "isFinalState" defaults to false, so we only need to include the
   // element when the value is true.
   if (model.is_final_state) {
@@ -576,7 +692,17 @@ static void SerializeModel(
 
   SerializeModel(model.evaluated_expressions, "evaluatedExpressions", root);
 
-  SerializeModel(model.variable_table, "variableTable", root);
+  if (model.flat_variable_table != nullptr) {
+    std::vector<std::unique_ptr<VariableModel>> variable_table;
+    for (int32 index : model.flat_variable_table->entries) {
+      variable_table.push_back(
+          ExpandVariable(*model.flat_variable_table, index));
+    }
+
+    SerializeModel(variable_table, "variableTable", root);
+  } else {
+    SerializeModel(model.variable_table, "variableTable", root);
+  }
 
   if (!model.labels.empty()) {
     SerializeModel(model.labels, &(*root)["labels"]);
@@ -618,6 +744,9 @@ std::unique_ptr<BreakpointModel> DeserializeModel<BreakpointModel>(
   // Log level.
   model->log_level = DeserializeLogLevel(root);
 
+  // Capture profile.
+  model->capture_profile = DeserializeCaptureProfile(root);
+
   // Final state flag.
   model->is_final_state = JsonCppGetBool(root, "isFinalState", false);
 
@@ -656,12 +785,478 @@ std::unique_ptr<BreakpointModel> DeserializeModel<BreakpointModel>(
 }
 
 
+// Streaming JSON writer. Produces exactly the same output as
+// "Json::FastWriter" would for the equivalent "Json::Value" tree without
+// building the tree. The caller is responsible to write object members in
+// the order "Json::Value" would have them (sorted by name).
+class JsonStreamWriter {
+ public:
+  explicit JsonStreamWriter(string* output) : output_(output) { }
+
+  void BeginObject() {
+    Separate();
+    output_->push_back('{');
+    need_separator_ = false;
+  }
+
+  void EndObject() {
+    output_->push_back('}');
+    need_separator_ = true;
+  }
+
+  void BeginArray() {
+    Separate();
+    output_->push_back('[');
+    need_separator_ = false;
+  }
+
+  void EndArray() {
+    output_->push_back(']');
+    need_separator_ = true;
+  }
+
+  // Starts new member of the current object. Must be followed by a value.
+  void Key(const char* name) {
+    Separate();
+    AppendQuotedString(name, strlen(name));
+    output_->push_back(':');
+    need_separator_ = false;
+  }
+
+  void Key(const string& name) {
+    Separate();
+    AppendQuotedString(name.data(), name.size());
+    output_->push_back(':');
+    need_separator_ = false;
+  }
+
+  void String(const string& value) {
+    Separate();
+    AppendQuotedString(value.data(), value.size());
+    need_separator_ = true;
+  }
+
+  void String(const char* value, size_t length) {
+    Separate();
+    AppendQuotedString(value, length);
+    need_separator_ = true;
+  }
+
+  void Int(int64 value) {
+    Separate();
+    AppendInteger(value, output_);
+    need_separator_ = true;
+  }
+
+  void Bool(bool value) {
+    Separate();
+    output_->append(value ? "true" : "false");
+    need_separator_ = true;
+  }
+
+  void Null() {
+    Separate();
+    output_->append("null");
+    need_separator_ = true;
+  }
+
+ private:
+  void Separate() {
+    if (need_separator_) {
+      output_->push_back(',');
+    }
+  }
+
+  // Escapes the string the same way "Json::valueToQuotedString" does.
+  void AppendQuotedString(const char* value, size_t length) {
+    AppendJsonQuotedString(value, length, output_);
+  }
+
+ private:
+  // Buffer receiving the JSON text. Not owned by this class.
+  string* const output_;
+
+  // True if the next value or key needs to be preceded by a comma.
+  bool need_separator_ { false };
+
+  DISALLOW_COPY_AND_ASSIGN(JsonStreamWriter);
+};
+
+
+template <typename TElement>
+static void WriteModel(
+    const std::vector<std::unique_ptr<TElement>>& model,
+    const char* array_name,
+    JsonStreamWriter* writer) {
+  if (model.empty()) {
+    return;
+  }
+
+  writer->Key(array_name);
+  writer->BeginArray();
+  for (const std::unique_ptr<TElement>& element : model) {
+    WriteModel(*element, writer);
+  }
+  writer->EndArray();
+}
+
+
+static void WriteModel(
+    const std::vector<string>& model,
+    const char* array_name,
+    JsonStreamWriter* writer) {
+  if (model.empty()) {
+    return;
+  }
+
+  writer->Key(array_name);
+  writer->BeginArray();
+  for (const string& element : model) {
+    writer->String(element);
+  }
+  writer->EndArray();
+}
+
+
+static void WriteModel(
+    const std::map<string, string>& model,
+    JsonStreamWriter* writer) {
+  writer->BeginObject();
+  // "std::map" is already sorted by key.
+  for (const auto& element : model) {
+    writer->Key(element.first);
+    writer->String(element.second);
+  }
+  writer->EndObject();
+}
+
+
+// Looks up the string representation of an enum value in one of the maps
+// above. Returns nullptr if not found.
+template <typename TEnum, typename TCode, int N>
+static const char* FindEnumString(TEnum value, const TCode (&codes)[N]) {
+  for (const auto& entry : codes) {
+    if (value == entry.enum_code) {
+      return entry.enum_string;
+    }
+  }
+
+  return nullptr;
+}
+
+
+static void WriteModel(
+    const FormatMessageModel& model,
+    JsonStreamWriter* writer) {
+  writer->BeginObject();
+  writer->Key("format");
+  writer->String(model.format);
+  WriteModel(model.parameters, "parameters", writer);
+  writer->EndObject();
+}
+
+
+static void WriteModel(
+    const StatusMessageModel& model,
+    JsonStreamWriter* writer) {
+  writer->BeginObject();
+
+  writer->Key("description");
+  WriteModel(model.description, writer);
+
+  writer->Key("isError");
+  writer->Bool(model.is_error);
+
+  // No need to set the default values.
+  if (model.refers_to != StatusMessageModel::Context::UNSPECIFIED) {
+    const char* refers_to =
+        FindEnumString(model.refers_to, status_context_codes_map);
+    if (refers_to != nullptr) {
+      writer->Key("refersTo");
+      writer->String(refers_to);
+    } else {
+      LOG(ERROR) << "Invalid 'refers_to' value: "
+                 << static_cast<int>(model.refers_to);
+    }
+  }
+
+  writer->EndObject();
+}
+
+
+static void WriteModel(
+    const SourceLocationModel& model,
+    JsonStreamWriter* writer) {
+  writer->BeginObject();
+  writer->Key("line");
+  writer->Int(model.line);
+  writer->Key("path");
+  writer->String(model.path);
+  writer->EndObject();
+}
+
+
+static void WriteModel(
+    const VariableModel& model,
+    JsonStreamWriter* writer) {
+  // "Json::Value" of a variable without any members is null rather than an
+  // empty object (e.g. first entry in the variable table).
+  if (model.members.empty() &&
+      model.name.empty() &&
+      (model.status == nullptr) &&
+      model.type.empty() &&
+      !model.value.has_value() &&
+      !model.var_table_index.has_value()) {
+    writer->Null();
+    return;
+  }
+
+  writer->BeginObject();
+
+  WriteModel(model.members, "members", writer);
+
+  if (!model.name.empty()) {
+    writer->Key("name");
+    writer->String(model.name);
+  }
+
+  if (model.status != nullptr) {
+    writer->Key("status");
+    WriteModel(*model.status, writer);
+  }
+
+  if (!model.type.empty()) {
+    writer->Key("type");
+    writer->String(model.type);
+  }
+
+  if (model.value.has_value()) {
+    writer->Key("value");
+    writer->String(model.value.value());
+  }
+
+  if (model.var_table_index.has_value()) {
+    writer->Key("varTableIndex");
+    writer->Int(static_cast<int>(model.var_table_index.value()));
+  }
+
+  writer->EndObject();
+}
+
+
+// Writes a variable of the flat variable table. The fields are written in
+// the same order as for "VariableModel".
+static void WriteModel(
+    const FlatVariableTableModel& model,
+    int32 index,
+    JsonStreamWriter* writer) {
+  const FlatVariableTableModel::Variable& variable = model.variables[index];
+
+  auto write_string = [&model, writer] (
+      const FlatVariableTableModel::StringRef& ref) {
+    writer->String(model.strings.data() + ref.offset, ref.length);
+  };
+
+  if ((variable.members_count == 0) &&
+      (variable.name.length == 0) &&
+      (variable.status == -1) &&
+      (variable.type.length == 0) &&
+      !variable.has_value &&
+      (variable.var_table_index == -1)) {
+    writer->Null();
+    return;
+  }
+
+  writer->BeginObject();
+
+  if (variable.members_count > 0) {
+    writer->Key("members");
+    writer->BeginArray();
+    for (int32 i = 0; i < variable.members_count; ++i) {
+      WriteModel(model, variable.first_member + i, writer);
+    }
+    writer->EndArray();
+  }
+
+  if (variable.name.length > 0) {
+    writer->Key("name");
+    write_string(variable.name);
+  }
+
+  if (variable.status != -1) {
+    writer->Key("status");
+    WriteModel(model.statuses[variable.status], writer);
+  }
+
+  if (variable.type.length > 0) {
+    writer->Key("type");
+    write_string(variable.type);
+  }
+
+  if (variable.has_value) {
+    writer->Key("value");
+    write_string(variable.value);
+  }
+
+  if (variable.var_table_index != -1) {
+    writer->Key("varTableIndex");
+    writer->Int(static_cast<int>(variable.var_table_index));
+  }
+
+  writer->EndObject();
+}
+
+
+static void WriteModel(
+    const FlatVariableTableModel& model,
+    const char* array_name,
+    JsonStreamWriter* writer) {
+  if (model.entries.empty()) {
+    return;
+  }
+
+  writer->Key(array_name);
+  writer->BeginArray();
+  for (int32 index : model.entries) {
+    WriteModel(model, index, writer);
+  }
+  writer->EndArray();
+}
+
+
+static void WriteModel(
+    const StackFrameModel& model,
+    JsonStreamWriter* writer) {
+  writer->BeginObject();
+
+  WriteModel(model.arguments, "arguments", writer);
+
+  writer->Key("function");
+  writer->String(model.function);
+
+  WriteModel(model.locals, "locals", writer);
+
+  if (model.location != nullptr) {
+    writer->Key("location");
+    WriteModel(*model.location, writer);
+  }
+
+  writer->EndObject();
+}
+
+
+static void WriteModel(
+    const BreakpointModel& model,
+    JsonStreamWriter* writer) {
+  writer->BeginObject();
+
+  // No need to set the default values.
+  if (model.action != BreakpointModel::Action::CAPTURE) {
+    const char* action =
+        FindEnumString(model.action, breakpoint_action_codes_map);
+    if (action != nullptr) {
+      writer->Key("action");
+      writer->String(action);
+    } else {
+      LOG(ERROR) << "Invalid 'action' value: "
+                 << static_cast<int>(model.action);
+    }
+  }
+
+  if (model.capture_profile != BreakpointModel::CaptureProfile::DEFAULT) {
+    const char* capture_profile = FindEnumString(
+        model.capture_profile,
+        breakpoint_capture_profile_codes_map);
+    if (capture_profile != nullptr) {
+      writer->Key("captureProfile");
+      writer->String(capture_profile);
+    } else {
+      LOG(ERROR) << "Invalid 'capture_profile' value: "
+                 << static_cast<int>(model.capture_profile);
+    }
+  }
+
+  if (!model.condition.empty()) {
+    writer->Key("condition");
+    writer->String(model.condition);
+  }
+
+  if (model.create_time != kUnspecifiedTimestamp) {
+    writer->Key("createTime");
+    writer->String(FormatTimestamp(model.create_time));
+  }
+
+  WriteModel(model.evaluated_expressions, "evaluatedExpressions", writer);
+
+  WriteModel(model.expressions, "expressions", writer);
+
+  writer->Key("id");
+  writer->String(model.id);
+
+  // "isFinalState" defaults to false, so we only need to include the
+  // element when the value is true.
+  if (model.is_final_state) {
+    writer->Key("isFinalState");
+    writer->Bool(model.is_final_state);
+  }
+
+  if (!model.labels.empty()) {
+    writer->Key("labels");
+    WriteModel(model.labels, writer);
+  }
+
+  if (model.location != nullptr) {
+    writer->Key("location");
+    WriteModel(*model.location, writer);
+  }
+
+  if (model.log_level != BreakpointModel::LogLevel::INFO) {
+    const char* log_level =
+        FindEnumString(model.log_level, breakpoint_log_level_codes_map);
+    if (log_level != nullptr) {
+      writer->Key("logLevel");
+      writer->String(log_level);
+    } else {
+      LOG(ERROR) << "Invalid 'log_level' value: "
+                 << static_cast<int>(model.log_level);
+    }
+  }
+
+  if (!model.log_message_format.empty()) {
+    writer->Key("logMessageFormat");
+    writer->String(model.log_message_format);
+  }
+
+  WriteModel(model.stack, "stackFrames", writer);
+
+  if (model.status != nullptr) {
+    writer->Key("status");
+    WriteModel(*model.status, writer);
+  }
+
+  if (model.flat_variable_table != nullptr) {
+    WriteModel(*model.flat_variable_table, "variableTable", writer);
+  } else {
+    WriteModel(model.variable_table, "variableTable", writer);
+  }
+
+  writer->EndObject();
+}
+
+
 SerializedBreakpoint BreakpointToJson(const BreakpointModel& model) {
-  Json::Value root;
-  SerializeModel(model, &root);
+  SerializedBreakpoint serialized_breakpoint { "json", model.id, string() };
 
-  Json::FastWriter writer;
-  return { "json", model.id, writer.write(root) };
+  // Write the JSON text straight into the output buffer. This is the hot
+  // path for breakpoint updates. Building "Json::Value" tree first would
+  // double the memory and allocations for large snapshots.
+  JsonStreamWriter writer(&serialized_breakpoint.data);
+  WriteModel(model, &writer);
+
+  // "Json::FastWriter" terminates the output with a new line.
+  serialized_breakpoint.data.push_back('\n');
+
+  return serialized_breakpoint;
 }
 
 
@@ -674,6 +1269,464 @@ SerializedBreakpoint BreakpointToPrettyJson(const BreakpointModel& model) {
 }
 
 
+// Streaming JSON reader of breakpoint definitions. Fills "BreakpointModel"
+// straight from the JSON text without building "Json::Value" tree. Only
+// supports what "ListActiveBreakpoints" responses contain. Anything else
+// (captured data, status, unexpected value types or syntax) makes the
+// reader give up, in which case the caller falls back to "Json::Reader".
+class JsonStreamReader {
+ public:
+  explicit JsonStreamReader(const string& input)
+      : next_(input.data()),
+        end_(input.data() + input.size()) {
+  }
+
+  // Reads the breakpoint definition. Returns nullptr if the input is not
+  // supported by this reader.
+  std::unique_ptr<BreakpointModel> ReadBreakpoint() {
+    std::unique_ptr<BreakpointModel> model(new BreakpointModel);
+    model->location.reset(new SourceLocationModel);
+    model->location->line = 0;
+
+    bool ok = ReadObject([this, &model] (const string& key) {
+      if (key == "id") {
+        return ReadString(&model->id);
+      }
+
+      if (key == "action") {
+        string action;
+        if (!ReadString(&action)) {
+          return false;
+        }
+
+        model->action = ParseBreakpointAction(action);
+        return true;
+      }
+
+      if (key == "location") {
+        model->location.reset(new SourceLocationModel);
+        return ReadLocation(model->location.get());
+      }
+
+      if (key == "condition") {
+        return ReadString(&model->condition);
+      }
+
+      if (key == "expressions") {
+        return ReadStringArray(&model->expressions);
+      }
+
+      if (key == "logMessageFormat") {
+        return ReadString(&model->log_message_format);
+      }
+
+      if (key == "logLevel") {
+        string log_level;
+        if (!ReadString(&log_level)) {
+          return false;
+        }
+
+        model->log_level = ParseLogLevel(log_level);
+        return true;
+      }
+
+      if (key == "captureProfile") {
+        string capture_profile;
+        if (!ReadString(&capture_profile)) {
+          return false;
+        }
+
+        model->capture_profile = ParseCaptureProfile(capture_profile);
+        return true;
+      }
+
+      if (key == "isFinalState") {
+        return ReadBool(&model->is_final_state);
+      }
+
+      if (key == "createTime") {
+        string create_time;
+        if (!ReadString(&create_time)) {
+          return false;
+        }
+
+        model->create_time = ParseTimestamp(create_time);
+        return true;
+      }
+
+      if (key == "labels") {
+        return ReadStringMap(&model->labels);
+      }
+
+      if ((key == "status") ||
+          (key == "stackFrames") ||
+          (key == "evaluatedExpressions") ||
+          (key == "variableTable")) {
+        return false;  // Captured data is not supported.
+      }
+
+      return SkipValue(0);
+    });
+
+    SkipWhitespace();
+    if (!ok || (next_ != end_) || model->id.empty()) {
+      return nullptr;
+    }
+
+    return model;
+  }
+
+ private:
+  // Maximum nesting of skipped values.
+  static constexpr int kMaxSkipDepth = 32;
+
+  void SkipWhitespace() {
+    while ((next_ < end_) &&
+           ((*next_ == ' ') || (*next_ == '\t') ||
+            (*next_ == '\n') || (*next_ == '\r'))) {
+      ++next_;
+    }
+  }
+
+  // Skips whitespace and consumes "ch" if it comes next.
+  bool Consume(char ch) {
+    SkipWhitespace();
+    if ((next_ < end_) && (*next_ == ch)) {
+      ++next_;
+      return true;
+    }
+
+    return false;
+  }
+
+  // Skips whitespace and consumes "literal" if it comes next.
+  bool ConsumeLiteral(const char* literal) {
+    SkipWhitespace();
+    const size_t length = strlen(literal);
+    if ((end_ - next_ < static_cast<ptrdiff_t>(length)) ||
+        (memcmp(next_, literal, length) != 0)) {
+      return false;
+    }
+
+    next_ += length;
+    return true;
+  }
+
+  // Reads JSON object invoking "fn_member" for each key. "fn_member" must
+  // consume the value.
+  template <typename TFunction>
+  bool ReadObject(TFunction fn_member) {
+    if (!Consume('{')) {
+      return false;
+    }
+
+    if (Consume('}')) {
+      return true;
+    }
+
+    string key;
+    do {
+      if (!ReadString(&key) || !Consume(':') || !fn_member(key)) {
+        return false;
+      }
+    } while (Consume(','));
+
+    return Consume('}');
+  }
+
+  // Reads JSON string decoding the escape sequences.
+  bool ReadString(string* value) {
+    if (!Consume('"')) {
+      return false;
+    }
+
+    value->clear();
+    while (next_ < end_) {
+      const char ch = *next_++;
+      if (ch == '"') {
+        return true;
+      }
+
+      if (static_cast<unsigned char>(ch) < ' ') {
+        return false;
+      }
+
+      if (ch != '\\') {
+        value->push_back(ch);
+        continue;
+      }
+
+      if (next_ == end_) {
+        return false;
+      }
+
+      switch (*next_++) {
+        case '"': value->push_back('"'); break;
+        case '\\': value->push_back('\\'); break;
+        case '/': value->push_back('/'); break;
+        case 'b': value->push_back('\b'); break;
+        case 'f': value->push_back('\f'); break;
+        case 'n': value->push_back('\n'); break;
+        case 'r': value->push_back('\r'); break;
+        case 't': value->push_back('\t'); break;
+        case 'u':
+          if (!ReadUnicodeEscape(value)) {
+            return false;
+          }
+          break;
+
+        default:
+          return false;
+      }
+    }
+
+    return false;  // Unterminated string.
+  }
+
+  // Reads the 4 hex digits after "\u".
+  bool ReadHex4(uint32* code_unit) {
+    if (end_ - next_ < 4) {
+      return false;
+    }
+
+    *code_unit = 0;
+    for (int i = 0; i < 4; ++i) {
+      const char ch = *next_++;
+      uint32 digit;
+      if ((ch >= '0') && (ch <= '9')) {
+        digit = ch - '0';
+      } else if ((ch >= 'a') && (ch <= 'f')) {
+        digit = ch - 'a' + 10;
+      } else if ((ch >= 'A') && (ch <= 'F')) {
+        digit = ch - 'A' + 10;
+      } else {
+        return false;
+      }
+
+      *code_unit = (*code_unit << 4) | digit;
+    }
+
+    return true;
+  }
+
+  // Decodes "\u" escape sequence (and the low surrogate following a high
+  // surrogate) and appends the code point to "value" in UTF-8.
+  bool ReadUnicodeEscape(string* value) {
+    uint32 code_point = 0;
+    if (!ReadHex4(&code_point)) {
+      return false;
+    }
+
+    if ((code_point >= 0xD800) && (code_point <= 0xDBFF)) {
+      uint32 low_surrogate = 0;
+      if ((end_ - next_ < 2) || (next_[0] != '\\') || (next_[1] != 'u')) {
+        return false;
+      }
+
+      next_ += 2;
+      if (!ReadHex4(&low_surrogate) ||
+          (low_surrogate < 0xDC00) ||
+          (low_surrogate > 0xDFFF)) {
+        return false;
+      }
+
+      code_point =
+          0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+    }
+
+    if (code_point < 0x80) {
+      value->push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+      value->push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+      value->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else if (code_point < 0x10000) {
+      value->push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+      value->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+      value->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+      value->push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+      value->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+      value->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+      value->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+
+    return true;
+  }
+
+  // Reads a 32 bit integer. Numbers with a fraction or an exponent are not
+  // supported.
+  bool ReadInt(int32* value) {
+    SkipWhitespace();
+
+    const bool is_negative = (next_ < end_) && (*next_ == '-');
+    if (is_negative) {
+      ++next_;
+    }
+
+    int64 n = 0;
+    int digits = 0;
+    while ((next_ < end_) && (*next_ >= '0') && (*next_ <= '9')) {
+      n = n * 10 + (*next_++ - '0');
+      if (++digits > 10) {
+        return false;
+      }
+    }
+
+    if ((digits == 0) ||
+        ((next_ < end_) &&
+         ((*next_ == '.') || (*next_ == 'e') || (*next_ == 'E')))) {
+      return false;
+    }
+
+    if (is_negative) {
+      n = -n;
+    }
+
+    if ((n < std::numeric_limits<int32>::min()) ||
+        (n > std::numeric_limits<int32>::max())) {
+      return false;
+    }
+
+    *value = static_cast<int32>(n);
+    return true;
+  }
+
+  bool ReadBool(bool* value) {
+    if (ConsumeLiteral("true")) {
+      *value = true;
+      return true;
+    }
+
+    if (ConsumeLiteral("false")) {
+      *value = false;
+      return true;
+    }
+
+    return false;
+  }
+
+  // Reads an array of strings.
+  bool ReadStringArray(std::vector<string>* values) {
+    values->clear();
+
+    if (!Consume('[')) {
+      return false;
+    }
+
+    if (Consume(']')) {
+      return true;
+    }
+
+    do {
+      values->push_back(string());
+      if (!ReadString(&values->back())) {
+        return false;
+      }
+    } while (Consume(','));
+
+    return Consume(']');
+  }
+
+  // Reads an object with non-empty string values.
+  bool ReadStringMap(std::map<string, string>* values) {
+    values->clear();
+
+    return ReadObject([this, values] (const string& key) {
+      string value;
+      if (!ReadString(&value) || value.empty()) {
+        return false;
+      }
+
+      (*values)[key] = std::move(value);
+      return true;
+    });
+  }
+
+  // Reads the source location. Missing line number defaults to 0.
+  bool ReadLocation(SourceLocationModel* model) {
+    model->line = 0;
+
+    return ReadObject([this, model] (const string& key) {
+      if (key == "path") {
+        return ReadString(&model->path);
+      }
+
+      if (key == "line") {
+        return ReadInt(&model->line);
+      }
+
+      return SkipValue(0);
+    });
+  }
+
+  // Skips a value of any type.
+  bool SkipValue(int depth) {
+    if (depth > kMaxSkipDepth) {
+      return false;
+    }
+
+    SkipWhitespace();
+    if (next_ == end_) {
+      return false;
+    }
+
+    switch (*next_) {
+      case '{':
+        return ReadObject([this, depth] (const string& key) {
+          return SkipValue(depth + 1);
+        });
+
+      case '[':
+        ++next_;
+        if (Consume(']')) {
+          return true;
+        }
+
+        do {
+          if (!SkipValue(depth + 1)) {
+            return false;
+          }
+        } while (Consume(','));
+
+        return Consume(']');
+
+      case '"': {
+        string value;
+        return ReadString(&value);
+      }
+
+      case 't':
+        return ConsumeLiteral("true");
+
+      case 'f':
+        return ConsumeLiteral("false");
+
+      case 'n':
+        return ConsumeLiteral("null");
+
+      default: {
+        const char* start = next_;
+        while ((next_ < end_) &&
+               (strchr("+-.0123456789eE", *next_) != nullptr)) {
+          ++next_;
+        }
+
+        return next_ != start;
+      }
+    }
+  }
+
+ private:
+  // Next character to read.
+  const char* next_;
+
+  // End of the input.
+  const char* const end_;
+
+  DISALLOW_COPY_AND_ASSIGN(JsonStreamReader);
+};
+
+
 std::unique_ptr<BreakpointModel> BreakpointFromJson(
     const SerializedBreakpoint& serialized_breakpoint) {
   if (serialized_breakpoint.format != "json") {
@@ -687,6 +1740,14 @@ std::unique_ptr<BreakpointModel> BreakpointFromJson(
 
 std::unique_ptr<BreakpointModel> BreakpointFromJsonString(
     const string& json_string) {
+  std::unique_ptr<BreakpointModel> breakpoint =
+      JsonStreamReader(json_string).ReadBreakpoint();
+  if (breakpoint != nullptr) {
+    return breakpoint;
+  }
+
+  // Slow path for breakpoints that the streaming reader doesn't support.
+  // It also reports errors in the JSON text.
   Json::Value root;
   Json::Reader reader;
   if (!reader.parse(json_string, root)) {
@@ -362,6 +362,7 @@ class BreakpointBuilder {
 
     set_log_message_format(source.log_message_format);
     set_log_level(source.log_level);
+    set_capture_profile(source.capture_profile);
 
     set_is_final_state(source.is_final_state);
 
@@ -386,6 +387,9 @@ class BreakpointBuilder {
       add_variable_table_item(VariableBuilder(*variable_table_item).build());
     }
 
+    // The flat variable table is immutable and can be shared.
+    data_->flat_variable_table = source.flat_variable_table;
+
     set_labels(source.labels);
   }
 
@@ -439,6 +443,12 @@ class BreakpointBuilder {
     return *this;
   }
 
+  BreakpointBuilder& set_capture_profile(
+      BreakpointModel::CaptureProfile capture_profile) {
+    data_->capture_profile = capture_profile;
+    return *this;
+  }
+
   BreakpointBuilder& set_is_final_state(bool is_final_state) {
     data_->is_final_state = is_final_state;
     return *this;
@@ -495,6 +505,7 @@ class BreakpointBuilder {
 
   BreakpointBuilder& clear_variable_table() {
     data_->variable_table.clear();
+    data_->flat_variable_table = nullptr;
     return *this;
   }
 
@@ -539,55 +550,79 @@ class BreakpointBuilder {
 };
 
 
-// Stores either data or an error message in case of an error.
+// Stores either data or an error message in case of an error. The error
+// message is only allocated on failure, so that the success path (taken by
+// every node of every expression evaluation) doesn't construct, move or
+// destroy any strings.
 template <typename T>
 class ErrorOr {
  public:
   // Default constructor to initialize to default value with no error.
-  ErrorOr() : is_error_(false) {
-  }
+  ErrorOr() { }
 
   // Deliberately implicit constructor.
   ErrorOr(T value)  // NOLINT
-      : is_error_(false),
-        value_(std::move(value)) {
+      : value_(std::move(value)) {
   }
 
   // Deliberately implicit constructor.
   ErrorOr(FormatMessageModel error_message)  // NOLINT
-      : is_error_(true),
-        error_message_(std::move(error_message)) {
+      : error_message_(new FormatMessageModel(std::move(error_message))) {
   }
 
+  ErrorOr(const ErrorOr& other)
+      : value_(other.value_),
+        error_message_(
+            (other.error_message_ == nullptr)
+                ? nullptr
+                : new FormatMessageModel(*other.error_message_)) {
+  }
+
+  ErrorOr(ErrorOr&& other) = default;
+
+  ErrorOr& operator= (const ErrorOr& other) {
+    if (this != &other) {
+      *this = ErrorOr(other);
+    }
+
+    return *this;
+  }
+
+  ErrorOr& operator= (ErrorOr&& other) = default;
+
   static T detach_value(ErrorOr data) {
     return std::move(data.value_);
   }
 
-  bool is_error() const { return is_error_; }
+  bool is_error() const { return error_message_ != nullptr; }
 
   const T& value() const {
-    DCHECK(!is_error_);
+    DCHECK(!is_error());
     return value_;
   }
 
   T& value() {
-    DCHECK(!is_error_);
+    DCHECK(!is_error());
     return value_;
   }
 
+  // Returns an empty message if there is no error.
   const FormatMessageModel& error_message() const {
-    return error_message_;
+    if (error_message_ == nullptr) {
+      static const FormatMessageModel* const empty_message =
+          new FormatMessageModel();
+      return *empty_message;
+    }
+
+    return *error_message_;
   }
 
  private:
-  // Selects between "value_" and "error_message_".
-  bool is_error_;
-
   // Stored data in case there is no error.
   T value_;
 
-  // Error message if "is_error_ == true".
-  FormatMessageModel error_message_;
+  // Error message or null if there is no error.
+  std::unique_ptr<FormatMessageModel> error_message_;
 };
 
 
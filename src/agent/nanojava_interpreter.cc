@@ -34,6 +34,7 @@ static constexpr int kExtraLocalVariables = 32;
 
 NanoJavaInterpreter::NanoJavaInterpreter(
     Supervisor* supervisor,
+    NanoJavaSlotPool* slot_pool,
     ClassFile::Method* method,
     const NanoJavaInterpreter* parent_frame,
     jobject instance,
@@ -43,11 +44,16 @@ NanoJavaInterpreter::NanoJavaInterpreter(
       diag_state_(this, parent_frame),
       instance_(instance),
       arguments_(arguments),
+      slots_(slot_pool, method->GetMaxStack() + method->GetMaxLocals()),
       stack_(
           this,
-          std::bind(&NanoJavaInterpreter::RaiseNullPointerException, this),
-          method->GetMaxStack()),
-      locals_(this, method->GetMaxLocals()) {
+          [this]() { RaiseNullPointerException(); },
+          method->GetMaxStack(),
+          slots_.slots()),
+      locals_(
+          this,
+          method->GetMaxLocals(),
+          slots_.slots() + method->GetMaxStack()) {
   DCHECK(method_->IsStatic() == (instance_ == nullptr));
 }
 
@@ -79,6 +85,18 @@ MethodCallResult NanoJavaInterpreter::Execute() {
 
   DCHECK(result_ != nullptr);
 
+  // The returned object has to survive the local frame. Let
+  // "PopLocalFrame" carry it over as a local reference of the caller's frame
+  // rather than promoting it to a global reference.
+  if ((result_->result_type() == MethodCallResult::Type::Success) &&
+      result_->return_value().has_non_null_object()) {
+    jobject return_ref = jni()->NewLocalRef(result_->return_ref());
+    result_ = nullptr;
+
+    return MethodCallResult::Success(
+        JVariant::LocalRef(jni()->PopLocalFrame(return_ref)));
+  }
+
   jni()->PopLocalFrame(nullptr);  // We don't need result.
 
   return std::move(*result_);
@@ -197,16 +215,16 @@ void NanoJavaInterpreter::ExecuteInternal() {
 
 
 int NanoJavaInterpreter::ExecuteSingleInstruction() {
-  Nullable<ClassFile::Instruction> nullable_instruction =
-      method_->GetInstruction(ip_);
-  if (!nullable_instruction.has_value()) {
+  const ClassFile::Instruction* cached_instruction =
+      method_->GetCachedInstruction(ip_);
+  if (cached_instruction == nullptr) {
     SET_INTERNAL_ERROR(
         "failed to read instruction at offset $0",
         std::to_string(ip_));
     return -1;
   }
 
-  const ClassFile::Instruction& instruction = nullable_instruction.value();
+  const ClassFile::Instruction& instruction = *cached_instruction;
   int next_ip = instruction.next_instruction_offset;
 
   const uint8 opcode = instruction.opcode;
@@ -1138,7 +1156,10 @@ int NanoJavaInterpreter::ExecuteSingleInstruction() {
     case JVM_OPC_invokespecial:
     case JVM_OPC_invokestatic:
     case JVM_OPC_invokeinterface:
-      InvokeOperation(instruction.opcode, *instruction.method_operand);
+      InvokeOperation(
+          instruction.opcode,
+          *instruction.method_operand,
+          instruction.call_target_cache);
       break;
 
     case JVM_OPC_new: {
@@ -1428,7 +1449,7 @@ int NanoJavaInterpreter::ExecuteSingleInstruction() {
       break;
 
     case JVM_OPC_invokedynamic:
-      SetOpcodeNotSupportedError("INVOKEDYNAMIC");
+      InvokeDynamicOperation(instruction.invoke_dynamic_operand);
       break;
 
     case JVM_OPC_jsr:
@@ -1443,15 +1464,10 @@ int NanoJavaInterpreter::ExecuteSingleInstruction() {
       const int32 index = stack_.PopStack(Slot::Type::Int) -
                           instruction.table_switch_operand.low;
 
-      if ((index >= 0) &&
-          (index < instruction.table_switch_operand.table.size())) {
-        ClassFile::TableSwitchTable table =
-            instruction.table_switch_operand.table;
+      const ClassFile::TableSwitchTable& table =
+          instruction.table_switch_operand.table;
+      if ((index >= 0) && (index < table.size())) {
         next_ip = instruction.offset + table.offset(index);
-        if (table.is_error()) {
-          SET_INTERNAL_ERROR("Bad tableswitch table");
-          break;
-        }
       } else {
         next_ip = instruction.offset +
                   instruction.table_switch_operand.default_handler_offset;
@@ -1463,20 +1479,14 @@ int NanoJavaInterpreter::ExecuteSingleInstruction() {
     case JVM_OPC_lookupswitch: {
       const int32 key = stack_.PopStack(Slot::Type::Int);
 
-      next_ip = instruction.offset +
-                instruction.lookup_switch_operand.default_handler_offset;
-      ClassFile::LookupSwitchTable table =
+      const ClassFile::LookupSwitchTable& table =
           instruction.lookup_switch_operand.table;
-      for (int i = 0; i < table.size(); ++i) {
-        if (table.value(i) == key) {
-          next_ip = instruction.offset + table.offset(i);
-          break;
-        }
-      }
-
-      if (table.is_error()) {
-        SET_INTERNAL_ERROR("Bad lookupswitch table");
-        break;
+      const int row = table.Find(key);
+      if (row != -1) {
+        next_ip = instruction.offset + table.offset(row);
+      } else {
+        next_ip = instruction.offset +
+                  instruction.lookup_switch_operand.default_handler_offset;
       }
 
       break;
@@ -1532,33 +1542,33 @@ bool NanoJavaInterpreter::DispatchExceptionHandler() {
     return false;
   }
 
-  // Loop through the exception table. The first row to match is the exception
-  // handler to branch to. Each row in exception table has a code range and
-  // optional type. The row matches if the current instruction pointer is
-  // within the code range and the thrown exception is an instance of the
-  // type in the exception table.
-  for (int i = 0; i < method_->GetExceptionTableSize(); ++i) {
-    Nullable<ClassFile::TryCatchBlock> nullable_block =
-        method_->GetTryCatchBlock(i);
-    if (!nullable_block.has_value()) {
-      SET_INTERNAL_ERROR("Failed to read trycatch block $0", std::to_string(i));
-      return false;
-    }
-
-    const ClassFile::TryCatchBlock& block = nullable_block.value();
-
-    if ((ip_ < block.begin_offset) || (ip_ >= block.end_offset)) {
-      continue;
-    }
+  const ClassFile::ExceptionDispatchTable* dispatch_table =
+      method_->GetExceptionDispatchTable();
+  if (dispatch_table == nullptr) {
+    SET_INTERNAL_ERROR("Failed to read exception table");
+    return false;
+  }
 
-    // The exception was thrown from the location matching current try...catch
-    // block range. If this is a "finally" block, we are done. Otherwise we
-    // need to check if the thrown exception is is an instance of "block.type"
-    // class.
+  // Loop through the exception table rows covering the current instruction
+  // pointer (in the exception table order). The first row to match is the
+  // exception handler to branch to. The row matches if it has no type or if
+  // the thrown exception is an instance of the type in the exception table.
+  const int* rows_begin = nullptr;
+  const int* rows_end = nullptr;
+  dispatch_table->Find(ip_, &rows_begin, &rows_end);
+  for (const int* it = rows_begin; it != rows_end; ++it) {
+    const ClassFile::TryCatchBlock& block = dispatch_table->row(*it);
+
+    // If this is a "finally" block, we are done. Otherwise we need to check
+    // if the thrown exception is is an instance of "block.type" class.
     if (block.type != nullptr) {
-      jclass cls = LoadClass(block.type->type.get());
+      jclass cls = dispatch_table->GetCatchClass(*it);
       if (cls == nullptr) {
-        return false;
+        // Reports the error if the class is still not loaded.
+        cls = LoadClass(block.type->type.get());
+        if (cls == nullptr) {
+          return false;
+        }
       }
 
       if (!jni()->IsInstanceOf(exception, cls)) {
@@ -1797,7 +1807,8 @@ void NanoJavaInterpreter::LdcOperation(int constant_pool_index) {
 
 void NanoJavaInterpreter::InvokeOperation(
     uint8 opcode,
-    const ConstantPool::MethodRef& operand) {
+    const ConstantPool::MethodRef& operand,
+    CallTargetCache* call_target_cache) {
   if (!operand.is_found) {
     SetResult(MethodCallResult::Error({
         ClassNotLoaded,
@@ -1828,7 +1839,8 @@ void NanoJavaInterpreter::InvokeOperation(
       opcode == JVM_OPC_invokespecial,
       operand,
       instance.get(),
-      arguments);
+      arguments,
+      call_target_cache);
 
   if (rc.result_type() != MethodCallResult::Type::Success) {
     SetResult(rc);
@@ -1838,6 +1850,164 @@ void NanoJavaInterpreter::InvokeOperation(
 }
 
 
+void NanoJavaInterpreter::InvokeDynamicOperation(
+    const ConstantPool::InvokeDynamicRef* operand) {
+  if ((operand == nullptr) || !operand->is_string_concat) {
+    SetOpcodeNotSupportedError("INVOKEDYNAMIC");
+    return;
+  }
+
+  const std::vector<JSignature>& signature = operand->signature.arguments;
+
+  std::vector<JVariant> arguments(signature.size());
+  auto it_arguments = arguments.rbegin();
+  for (auto it = signature.rbegin(); it != signature.rend();
+       ++it, ++it_arguments) {
+    *it_arguments = stack_.PopStackAny(it->type);
+  }
+
+  if (IsError()) {
+    return;
+  }
+
+  // Concatenate straight into a native buffer and only create the Java
+  // string at the end. Unlike "StringBuilder" this doesn't allocate any
+  // intermediate Java objects.
+  string result;
+  for (const auto& element : operand->string_concat_recipe) {
+    if (element.argument_index == -1) {
+      result += element.constant;
+    } else if (!AppendStringConcatArgument(
+        signature[element.argument_index],
+        arguments[element.argument_index],
+        &result)) {
+      return;
+    }
+  }
+
+  if (!CheckNewArrayAllowed(result.size())) {
+    return;
+  }
+
+  JniLocalRef str(jni()->NewStringUTF(result.c_str()));
+  if (!CheckJavaException()) {
+    return;
+  }
+
+  supervisor_->NewObjectAllocated(str.get());
+
+  stack_.PushStackObject(str.get());
+}
+
+
+bool NanoJavaInterpreter::AppendStringConcatArgument(
+    const JSignature& signature,
+    const JVariant& value,
+    string* result) {
+  const char* value_of_signature = nullptr;
+
+  switch (signature.type) {
+    case JType::Void:
+      SET_INTERNAL_ERROR("void string concatenation argument");
+      return false;
+
+    case JType::Boolean: {
+      jboolean n = false;
+      value.get<jboolean>(&n);
+      *result += n ? "true" : "false";
+      return true;
+    }
+
+    case JType::Char: {
+      // Modified UTF-8 encoding of a single UTF-16 code unit.
+      jchar n = 0;
+      value.get<jchar>(&n);
+      if ((n >= 0x01) && (n <= 0x7F)) {
+        *result += static_cast<char>(n);
+      } else if (n <= 0x7FF) {
+        *result += static_cast<char>(0xC0 | (n >> 6));
+        *result += static_cast<char>(0x80 | (n & 0x3F));
+      } else {
+        *result += static_cast<char>(0xE0 | (n >> 12));
+        *result += static_cast<char>(0x80 | ((n >> 6) & 0x3F));
+        *result += static_cast<char>(0x80 | (n & 0x3F));
+      }
+      return true;
+    }
+
+    case JType::Byte: {
+      jbyte n = 0;
+      value.get<jbyte>(&n);
+      *result += std::to_string(n);
+      return true;
+    }
+
+    case JType::Short: {
+      jshort n = 0;
+      value.get<jshort>(&n);
+      *result += std::to_string(n);
+      return true;
+    }
+
+    case JType::Int: {
+      jint n = 0;
+      value.get<jint>(&n);
+      *result += std::to_string(n);
+      return true;
+    }
+
+    case JType::Long: {
+      jlong n = 0;
+      value.get<jlong>(&n);
+      *result += std::to_string(n);
+      return true;
+    }
+
+    // Java formats floating point numbers differently than C++.
+    case JType::Float:
+      value_of_signature = "(F)Ljava/lang/String;";
+      break;
+
+    case JType::Double:
+      value_of_signature = "(D)Ljava/lang/String;";
+      break;
+
+    case JType::Object: {
+      jobject obj = nullptr;
+      value.get<jobject>(&obj);
+      if (obj == nullptr) {
+        *result += "null";
+        return true;
+      }
+
+      if (signature.object_signature == "Ljava/lang/String;") {
+        *result += JniToNativeString(obj);
+        return true;
+      }
+
+      // Call "toString" the same way Java does it.
+      value_of_signature = "(Ljava/lang/Object;)Ljava/lang/String;";
+      break;
+    }
+  }
+
+  MethodCallResult rc = supervisor_->InvokeImplicit(
+      StaticMethod("Ljava/lang/String;", "valueOf", value_of_signature),
+      nullptr,
+      { value });
+  if (rc.result_type() != MethodCallResult::Type::Success) {
+    SetResult(std::move(rc));
+    return false;
+  }
+
+  jobject str = nullptr;
+  rc.return_value().get<jobject>(&str);
+  *result += (str == nullptr) ? "null" : JniToNativeString(str);
+
+  return true;
+}
+
+
 void NanoJavaInterpreter::CheckFieldFound(const ConstantPool::FieldRef& field) {
   if (!field.is_found) {
     SetResult(MethodCallResult::Error({
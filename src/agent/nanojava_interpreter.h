@@ -25,6 +25,7 @@
 #include "nanojava_internal_error_builder.h"
 #include "nanojava_locals.h"
 #include "nanojava_slot.h"
+#include "nanojava_slot_pool.h"
 #include "nanojava_stack.h"
 
 namespace devtools {
@@ -57,11 +58,21 @@ class NanoJavaInterpreter : public NanoJavaInternalErrorProvider {
     // instance method calls "nonvirtual" chooses between virtual and
     // non-virtual calls. If "nonvirtual" is false, the derived method will be
     // used. If "nonvirtual" is true, the selected method will be called even if
-    // overloaded by a derived class.
+    // overloaded by a derived class. "call_target_cache" is the inline cache
+    // of the call site or nullptr if the call site has none.
     virtual MethodCallResult InvokeNested(
         bool nonvirtual,
         const ConstantPool::MethodRef& method,
         jobject source,
+        std::vector<JVariant> arguments,
+        CallTargetCache* call_target_cache) = 0;
+
+    // Calls a method that the interpreted code does not reference directly
+    // (e.g. "String.valueOf" when concatenating strings). The call is subject
+    // to the same rules as "InvokeNested".
+    virtual MethodCallResult InvokeImplicit(
+        const ClassMetadataReader::Method& metadata,
+        jobject source,
         std::vector<JVariant> arguments) = 0;
 
     // Indicates that one more instruction is about to be executed. Returns
@@ -124,12 +135,14 @@ class NanoJavaInterpreter : public NanoJavaInternalErrorProvider {
     DISALLOW_COPY_AND_ASSIGN(DiagState);
   };
 
-  // Class constructor. "supervisor", "method", "parent_frame", "instance" and
-  // "arguments" are not owned by this class. Their lifetime must exceed
-  // lifetime of this class. "parent_frame" might be nullptr if this is a top
-  // level caller.
+  // Class constructor. "supervisor", "slot_pool", "method", "parent_frame",
+  // "instance" and "arguments" are not owned by this class. Their lifetime
+  // must exceed lifetime of this class. "parent_frame" might be nullptr if
+  // this is a top level caller. The operand stack and local variables are
+  // allocated from "slot_pool". Nested interpreters must use the same pool.
   NanoJavaInterpreter(
       Supervisor* supervisor,
+      NanoJavaSlotPool* slot_pool,
       ClassFile::Method* method,
       const NanoJavaInterpreter* parent_frame,
       jobject instance,
@@ -280,7 +293,20 @@ class NanoJavaInterpreter : public NanoJavaInternalErrorProvider {
   // Implements INVOKExxx instructions.
   void InvokeOperation(
       uint8 opcode,
-      const ConstantPool::MethodRef& operand);
+      const ConstantPool::MethodRef& operand,
+      CallTargetCache* call_target_cache);
+
+  // Implements INVOKEDYNAMIC instruction. Only string concatenation is
+  // supported.
+  void InvokeDynamicOperation(const ConstantPool::InvokeDynamicRef* operand);
+
+  // Appends string representation of a string concatenation argument to
+  // "result" (as modified UTF-8). Returns false and sets the method result
+  // on error.
+  bool AppendStringConcatArgument(
+      const JSignature& signature,
+      const JVariant& value,
+      string* result);
 
   // Implements NEWARRAY instruction.
   void NewArrayOperation(int array_type);
@@ -377,6 +403,9 @@ class NanoJavaInterpreter : public NanoJavaInternalErrorProvider {
   // Method call arguments (not including "this").
   const std::vector<JVariant>& arguments_;
 
+  // Storage for "stack_" and "locals_". Must be declared before them.
+  NanoJavaSlotPool::Frame slots_;
+
   // Execution stack of the interpreted method.
   NanoJavaStack stack_;
 
@@ -22,15 +22,15 @@ namespace nanojava {
 
 NanoJavaLocals::NanoJavaLocals(
     NanoJavaInternalErrorProvider* internal_error_provider,
-    int max_locals)
+    int max_locals,
+    Slot* storage)
     : internal_error_provider_(internal_error_provider),
       max_locals_(max_locals),
-      locals_(new Slot[max_locals]) {
+      locals_(storage) {
 }
 
 
 NanoJavaLocals::~NanoJavaLocals() {
-  delete[] locals_;
 }
 
 
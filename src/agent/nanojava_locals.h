@@ -32,11 +32,13 @@ namespace nanojava {
 // caller must verify error wasn't set before assuming the operation succeeded.
 class NanoJavaLocals {
  public:
-  // Allocates space for the local variables. Long and double types take two
-  // slots.
+  // Uses "max_locals" slots at "storage" for the local variables. Long and
+  // double types take two slots. "storage" is not owned by this class and
+  // must outlive it.
   NanoJavaLocals(
       NanoJavaInternalErrorProvider* internal_error_provider,
-      int max_locals);
+      int max_locals,
+      Slot* storage);
 
   ~NanoJavaLocals();
 
@@ -79,7 +81,7 @@ class NanoJavaLocals {
   // in. Long and double types take two slots of a local variable.
   const int max_locals_;
 
-  // Local variables of the method.
+  // Local variables of the method. Not owned by this class.
   Slot* const locals_;
 
   DISALLOW_COPY_AND_ASSIGN(NanoJavaLocals);
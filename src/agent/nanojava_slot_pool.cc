@@ -0,0 +1,87 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nanojava_slot_pool.h"
+
+#include <algorithm>
+
+namespace devtools {
+namespace cdbg {
+namespace nanojava {
+
+constexpr int NanoJavaSlotPool::kBlockSize;
+
+
+NanoJavaSlotPool::Frame::Frame(NanoJavaSlotPool* pool, int count)
+    : pool_(pool),
+      block_(pool->current_block_),
+      offset_(pool->current_offset_),
+      slots_(pool->Allocate(count)) {
+}
+
+
+NanoJavaSlotPool::Frame::~Frame() {
+  pool_->Release(block_, offset_);
+}
+
+
+Slot* NanoJavaSlotPool::Allocate(int count) {
+  DCHECK_GE(count, 0);
+
+  if ((current_block_ < blocks_.size()) &&
+      (current_offset_ + count > blocks_[current_block_].size)) {
+    // Doesn't fit into the current block. The rest of the current block
+    // stays unused until the frames that use it are released.
+    ++current_block_;
+    current_offset_ = 0;
+  }
+
+  if (current_block_ == blocks_.size()) {
+    blocks_.push_back(Block());
+  }
+
+  Block& block = blocks_[current_block_];
+  if (block.size < current_offset_ + count) {
+    // Either a new block or an unused block that is too small. Either way
+    // "current_offset_" is 0 here.
+    DCHECK_EQ(0, current_offset_);
+    block.size = std::max(kBlockSize, count);
+    block.slots.reset(new Slot[block.size]);
+  }
+
+  Slot* slots = block.slots.get() + current_offset_;
+  current_offset_ += count;
+
+  // Slots may have been used by a previous frame.
+  std::fill(slots, slots + count, Slot());
+
+  return slots;
+}
+
+
+void NanoJavaSlotPool::Release(int block, int offset) {
+  DCHECK((block < current_block_) ||
+         ((block == current_block_) && (offset <= current_offset_)))
+      << "Frames released out of order";
+
+  current_block_ = block;
+  current_offset_ = offset;
+}
+
+}  // namespace nanojava
+}  // namespace cdbg
+}  // namespace devtools
+
@@ -0,0 +1,100 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_NANOJAVA_SLOT_POOL_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_NANOJAVA_SLOT_POOL_H_
+
+#include <memory>
+#include <vector>
+#include "common.h"
+#include "nanojava_slot.h"
+
+namespace devtools {
+namespace cdbg {
+namespace nanojava {
+
+// Provides storage for operand stacks and local variables of nested
+// interpreted method calls. Interpreter frames are strictly nested, so the
+// slots are handed out and released in LIFO order from large blocks. The
+// blocks are reused by subsequent calls and only released when the pool is
+// destroyed, so after a warm up, calling an interpreted method doesn't
+// allocate any memory for the frame.
+//
+// This class is not thread safe.
+class NanoJavaSlotPool {
+ public:
+  // Slots of a single interpreter frame. The slots are returned to the pool
+  // when this object goes out of scope. Frames must be destroyed in the
+  // reverse order of their construction.
+  class Frame {
+   public:
+    // Allocates "count" empty slots from "pool", which must outlive this
+    // object.
+    Frame(NanoJavaSlotPool* pool, int count);
+
+    ~Frame();
+
+    // Gets the allocated slots.
+    Slot* slots() const { return slots_; }
+
+   private:
+    // Pool that owns the slots. Not owned by this class.
+    NanoJavaSlotPool* const pool_;
+
+    // Top of the pool before the slots were allocated.
+    const int block_;
+    const int offset_;
+
+    // Allocated slots.
+    Slot* const slots_;
+
+    DISALLOW_COPY_AND_ASSIGN(Frame);
+  };
+
+  NanoJavaSlotPool() { }
+
+ private:
+  // Allocates "count" consecutive empty slots at the top of the pool.
+  Slot* Allocate(int count);
+
+  // Releases all slots allocated since the top of the pool was at
+  // "block" and "offset".
+  void Release(int block, int offset);
+
+ private:
+  // Minimum size of a block in slots.
+  static constexpr int kBlockSize = 1024;
+
+  struct Block {
+    std::unique_ptr<Slot[]> slots;
+    int size;
+  };
+
+  // Blocks allocated so far. Blocks beyond "current_block_" are not in use.
+  std::vector<Block> blocks_;
+
+  // Top of the pool: index of the block in use and of its first free slot.
+  int current_block_ { 0 };
+  int current_offset_ { 0 };
+
+  DISALLOW_COPY_AND_ASSIGN(NanoJavaSlotPool);
+};
+
+}  // namespace nanojava
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_NANOJAVA_SLOT_POOL_H_
@@ -23,16 +23,16 @@ namespace nanojava {
 NanoJavaStack::NanoJavaStack(
     NanoJavaInternalErrorProvider* internal_error_provider,
     std::function<void()> fn_raise_null_pointer_exception,
-    int max_stack)
+    int max_stack,
+    Slot* storage)
     : internal_error_provider_(internal_error_provider),
       fn_raise_null_pointer_exception_(fn_raise_null_pointer_exception),
       max_stack_(max_stack),
-      stack_(new Slot[max_stack]) {
+      stack_(storage) {
 }
 
 
 NanoJavaStack::~NanoJavaStack() {
-  delete[] stack_;
 }
 
 
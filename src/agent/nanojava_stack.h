@@ -35,12 +35,13 @@ namespace nanojava {
 // 3. Maximum stack size as specified in Java class file.
 class NanoJavaStack {
  public:
-  // Allocates space for the local variables. Long and double types take two
-  // slots.
+  // Uses "max_stack" slots at "storage" for the stack. Long and double types
+  // take two slots. "storage" is not owned by this class and must outlive it.
   NanoJavaStack(
       NanoJavaInternalErrorProvider* internal_error_provider,
       std::function<void()> fn_raise_null_pointer_exception,
-      int max_stack);
+      int max_stack,
+      Slot* storage);
 
   ~NanoJavaStack();
 
@@ -125,7 +126,7 @@ class NanoJavaStack {
 
   // Operand stack of the current method. Unlike x86, each method has
   // its own stack. This is because a method can return prematurely without
-  // popping its stack.
+  // popping its stack. Not owned by this class.
   Slot* const stack_;
 
   // Index of the next free stack slot. When the stack is empty, this index
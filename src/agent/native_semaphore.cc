@@ -0,0 +1,137 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "native_semaphore.h"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace devtools {
+namespace cdbg {
+
+// Blocks while the value of "word" is "expected" (or until woken up) for at
+// most "timeout". Returns errno of the wait (0 if woken up).
+static int FutexWait(
+    std::atomic<int32>* word,
+    int32 expected,
+    const struct timespec* timeout) {
+  static_assert(
+      sizeof(std::atomic<int32>) == sizeof(int32),
+      "std::atomic<int32> can't be used as a futex word");
+
+  if (syscall(
+          SYS_futex,
+          reinterpret_cast<int32*>(word),
+          FUTEX_WAIT_PRIVATE,
+          expected,
+          timeout,
+          nullptr,
+          0) == 0) {
+    return 0;
+  }
+
+  return errno;
+}
+
+
+// Wakes up a single thread waiting on "word".
+static void FutexWakeOne(std::atomic<int32>* word) {
+  syscall(
+      SYS_futex,
+      reinterpret_cast<int32*>(word),
+      FUTEX_WAKE_PRIVATE,
+      1,
+      nullptr,
+      nullptr,
+      0);
+}
+
+
+static int64 MonotonicClockMs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+
+bool NativeSemaphore::TryAcquire() {
+  int32 permits = permits_.load();
+  while (permits > 0) {
+    if (permits_.compare_exchange_weak(permits, permits - 1)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+bool NativeSemaphore::Acquire(int timeout_ms) {
+  if (TryAcquire()) {
+    return true;
+  }
+
+  if (timeout_ms <= 0) {
+    return false;
+  }
+
+  const int64 deadline_ms = MonotonicClockMs() + timeout_ms;
+
+  // "Release" checks "waiters_" after incrementing "permits_", while we
+  // check "permits_" after incrementing "waiters_". Either "Release" sees
+  // the waiter and wakes it up or the waiter sees the new permit.
+  waiters_.fetch_add(1);
+
+  bool acquired = false;
+  while (true) {
+    if (TryAcquire()) {
+      acquired = true;
+      break;
+    }
+
+    const int64 remaining_ms = deadline_ms - MonotonicClockMs();
+    if (remaining_ms <= 0) {
+      break;
+    }
+
+    struct timespec timeout;
+    timeout.tv_sec = remaining_ms / 1000;
+    timeout.tv_nsec = (remaining_ms % 1000) * 1000000;
+
+    // EAGAIN (permits changed), EINTR and spurious wake ups just retry.
+    FutexWait(&permits_, 0, &timeout);
+  }
+
+  waiters_.fetch_sub(1);
+
+  return acquired;
+}
+
+
+void NativeSemaphore::Release() {
+  permits_.fetch_add(1);
+
+  if (waiters_.load() > 0) {
+    FutexWakeOne(&permits_);
+  }
+}
+
+}  // namespace cdbg
+}  // namespace devtools
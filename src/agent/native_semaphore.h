@@ -0,0 +1,67 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_NATIVE_SEMAPHORE_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_NATIVE_SEMAPHORE_H_
+
+#include <atomic>
+#include "common.h"
+#include "semaphore.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Semaphore implemented directly on top of Linux futex. Unlike
+// "JniSemaphore", signalling a thread doesn't call into Java, so it is
+// cheap enough for the worker wake up paths (e.g. every enqueued breakpoint
+// update). The wait can't be interrupted by "Thread.interrupt", which the
+// agent threads don't rely on: they are stopped by a signal.
+//
+// This class is thread safe.
+class NativeSemaphore : public Semaphore {
+ public:
+  NativeSemaphore() { }
+
+  bool Initialize() override { return true; }
+
+  bool Acquire(int timeout_ms) override;
+
+  int DrainPermits() override {
+    return permits_.exchange(0);
+  }
+
+  void Release() override;
+
+ private:
+  // Takes a single permit if there is one available.
+  bool TryAcquire();
+
+ private:
+  // Number of available permits. This is the futex word.
+  std::atomic<int32> permits_ { 0 };
+
+  // Number of threads that are about to wait or are waiting on "permits_".
+  // "Release" doesn't need to make a system call if there are none.
+  std::atomic<int32> waiters_ { 0 };
+
+  DISALLOW_COPY_AND_ASSIGN(NativeSemaphore);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_NATIVE_SEMAPHORE_H_
@@ -19,6 +19,7 @@
 
 #include "common.h"
 #include "expression_evaluator.h"
+#include "expression_program.h"
 #include "messages.h"
 #include "model.h"
 
@@ -55,6 +56,15 @@ class NumericCastEvaluator : public ExpressionEvaluator {
       return false;
     }
 
+    // Cast constants right away.
+    JVariant source_value;
+    if (GetStaticPrimitiveValue(*source_, &source_value)) {
+      ErrorOr<JVariant> result = Convert(source_value);
+      if (!result.is_error()) {
+        static_value_ = JVariant(result.value());
+      }
+    }
+
     return true;
   }
 
@@ -69,44 +79,74 @@ class NumericCastEvaluator : public ExpressionEvaluator {
   }
 
   Nullable<jvalue> GetStaticValue() const override {
+    if (static_value_.type() != JType::Void) {
+      return static_value_.get_jvalue();
+    }
+
     return nullptr;
   }
 
+  bool HasMethodCalls() const override {
+    return (static_value_.type() == JType::Void) && source_->HasMethodCalls();
+  }
+
+  int Lower(ExpressionProgramBuilder* builder) const override {
+    if (static_value_.type() != JType::Void) {
+      return builder->AddConstant(
+          static_value_.type(),
+          static_value_.get_jvalue());
+    }
+
+    return builder->AddConversion(
+        source_->GetStaticType().type,
+        TargetType(),
+        source_->Lower(builder));
+  }
+
   ErrorOr<JVariant> Evaluate(
       const EvaluationContext& evaluation_context) const override {
+    if (static_value_.type() != JType::Void) {
+      return JVariant(static_value_);
+    }
+
     ErrorOr<JVariant> source_result = source_->Evaluate(evaluation_context);
     if (source_result.is_error()) {
       return source_result;
     }
 
-    switch (source_result.value().type()) {
+    return Convert(source_result.value());
+  }
+
+ private:
+  // Casts the primitive value in "source" to "TTargetType".
+  static ErrorOr<JVariant> Convert(const JVariant& source) {
+    switch (source.type()) {
       case JType::Byte:
-        return Cast<jbyte>(source_result.value());
+        return Cast<jbyte>(source);
 
       case JType::Char:
-        return Cast<jchar>(source_result.value());
+        return Cast<jchar>(source);
 
       case JType::Short:
-        return Cast<jshort>(source_result.value());
+        return Cast<jshort>(source);
 
       case JType::Int:
-        return Cast<jint>(source_result.value());
+        return Cast<jint>(source);
 
       case JType::Long:
-        return Cast<jlong>(source_result.value());
+        return Cast<jlong>(source);
 
       case JType::Float:
-        return Cast<jfloat>(source_result.value());
+        return Cast<jfloat>(source);
 
       case JType::Double:
-        return Cast<jdouble>(source_result.value());
+        return Cast<jdouble>(source);
 
       default:
         return INTERNAL_ERROR_MESSAGE;
     }
   }
 
- private:
   // Utility function to read value of type "TSourceType" from "source",
   // cast it to "TTargetType" and returns it.
   template <typename TSourceType>
@@ -126,6 +166,10 @@ class NumericCastEvaluator : public ExpressionEvaluator {
   // Statically computed resulting type of the expression.
   const JSignature result_type_;
 
+  // Value of the expression computed at compile time if "source_" is
+  // constant or void otherwise.
+  JVariant static_value_;
+
   DISALLOW_COPY_AND_ASSIGN(NumericCastEvaluator);
 };
 
@@ -37,7 +37,8 @@ class ObjectEvaluator {
   // "status" may be set to information or error message. Example of such a
   // message is: "only first 10 elements out of 1578 were captured". The
   // "method_caller" argument is only used during "Evaluate" and not stored
-  // afterwards.
+  // afterwards. Objects in "members" are local references. The caller has
+  // to promote the ones it keeps to global references.
   virtual void Evaluate(
       MethodCaller* method_caller,
       jobject obj,
@@ -0,0 +1,98 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "object_tags.h"
+
+#include "mutex.h"
+
+DEFINE_bool(
+    cdbg_tag_objects,
+    true,
+    "Use JVMTI object tags to identify Java objects (instead of comparing "
+    "objects with the same identity hash code)");
+
+namespace devtools {
+namespace cdbg {
+
+// Set once while the agent is loaded.
+static bool g_object_tagging_enabled = false;
+
+// Serializes assignment of new tags, so that two threads don't assign
+// different tags to the same object.
+static Mutex g_object_tags_mu;
+
+// Next tag to assign. Tag value of 0 means no tag in JVMTI.
+static jlong g_next_object_tag = 1;
+
+
+void RequestObjectTaggingCapability(jvmtiCapabilities* capabilities) {
+  if (FLAGS_cdbg_tag_objects) {
+    capabilities->can_tag_objects = true;
+  }
+}
+
+
+void EnableObjectTagging() {
+  g_object_tagging_enabled = FLAGS_cdbg_tag_objects;
+}
+
+
+bool IsObjectTaggingEnabled() {
+  return g_object_tagging_enabled;
+}
+
+
+bool GetObjectTag(jobject obj, jlong* tag) {
+  *tag = 0;
+
+  if (!g_object_tagging_enabled) {
+    return false;
+  }
+
+  jvmtiError err = jvmti()->GetTag(obj, tag);
+  if (err != JVMTI_ERROR_NONE) {
+    return false;
+  }
+
+  if (*tag != 0) {
+    return true;  // Common code path.
+  }
+
+  MutexLock lock(&g_object_tags_mu);
+
+  // Another thread might have tagged the object before we took the lock.
+  err = jvmti()->GetTag(obj, tag);
+  if (err != JVMTI_ERROR_NONE) {
+    return false;
+  }
+
+  if (*tag != 0) {
+    return true;
+  }
+
+  err = jvmti()->SetTag(obj, g_next_object_tag);
+  if (err != JVMTI_ERROR_NONE) {
+    return false;
+  }
+
+  *tag = g_next_object_tag++;
+
+  return true;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
@@ -0,0 +1,52 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_OBJECT_TAGS_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_OBJECT_TAGS_H_
+
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// JVMTI object tags used as identities of Java objects. Each object gets a
+// unique 64 bit tag the first time it is queried. The tag stays with the
+// object (even if GC moves it) until the object is collected. Tags of
+// different objects never collide, so identity lookups keyed on tags need
+// no "IsSameObject" calls.
+//
+// Since JVMTI only supports a single tag per object per environment, this
+// is the only place in the agent that sets object tags.
+
+// Requests the "can_tag_objects" capability if enabled through flags.
+void RequestObjectTaggingCapability(jvmtiCapabilities* capabilities);
+
+// Enables object tags after JVMTI accepted the capabilities requested with
+// "RequestObjectTaggingCapability". Must be called while the agent is
+// loaded before any object tag is queried.
+void EnableObjectTagging();
+
+// Returns true if object tags are available.
+bool IsObjectTaggingEnabled();
+
+// Gets the tag of "obj", tagging the object if it doesn't have a tag yet.
+// Returns false if object tags are not available or on error.
+bool GetObjectTag(jobject obj, jlong* tag);
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_OBJECT_TAGS_H_
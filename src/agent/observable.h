@@ -17,9 +17,10 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_OBSERVABLE_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_OBSERVABLE_H_
 
+#include <atomic>
 #include <functional>
-#include <list>
 #include <memory>
+#include <vector>
 #include "common.h"
 #include "mutex.h"
 
@@ -27,31 +28,51 @@ namespace devtools {
 namespace cdbg {
 
 // Implements multicast event with variable number of arguments.
+//
+// Events are fired on hot paths (every class prepare and every enqueued
+// breakpoint update), while subscriptions change rarely. The subscribers are
+// therefore kept in an immutable array published through an atomic pointer.
+// "Fire" reads the current array without taking a lock or allocating memory.
+// "Subscribe" and "Unsubscribe" build a new array. The replaced arrays are
+// kept until the object is destroyed, because a concurrent "Fire" may still
+// be iterating over them.
+//
 // This class is thread safe.
 template <class... Args>
 class Observable {
  public:
   typedef std::function<void(Args...)> Callback;
-  typedef typename std::list<Callback> Handlers;
 
   // Use unique_ptr here to ensure the cookie is not kept around after call
-  // to "Unsubscribe".
-  typedef std::unique_ptr<typename Handlers::iterator> Cookie;
+  // to "Unsubscribe". The cookie holds the unique ID of the subscription.
+  typedef std::unique_ptr<int64> Cookie;
 
   Observable() { }
 
   ~Observable() {
-    DCHECK(handlers_.empty());
+    DCHECK(handlers_.load(std::memory_order_relaxed) == nullptr ||
+           handlers_.load(std::memory_order_relaxed)->empty());
   }
 
-  // Subscribes to the event. Returns cookie used in "RemoveHandler" to
-  // unsubscribe. The callback handler must not call to Subscribe or Unsubscribe
-  // because it will cause deadlock.
+  // Subscribes to the event. Returns cookie used in "Unsubscribe" to
+  // unsubscribe. The callback handler may fire the event recursively, but
+  // must not call to Subscribe or Unsubscribe because it will cause deadlock.
   Cookie Subscribe(std::function<void(Args...)> fn) {
     MutexLock lock(&mu_);
 
-    auto it = handlers_.insert(handlers_.end(), std::move(fn));
-    return Cookie(new typename Handlers::iterator(it));
+    const int64 id = ++last_id_;
+
+    std::unique_ptr<Handlers> handlers(new Handlers);
+    const Handlers* current = handlers_.load(std::memory_order_relaxed);
+    if (current != nullptr) {
+      handlers->reserve(current->size() + 1);
+      *handlers = *current;
+    }
+
+    handlers->push_back({ id, std::move(fn) });
+    Publish(std::move(handlers));
+
+    return Cookie(new int64(id));
   }
 
   // Removes subscription to the event. It is the responsibility of the caller
@@ -64,33 +85,60 @@ class Observable {
 
     MutexLock lock(&mu_);
 
-    handlers_.erase(*cookie);
+    std::unique_ptr<Handlers> handlers(new Handlers);
+    const Handlers* current = handlers_.load(std::memory_order_relaxed);
+    if (current != nullptr) {
+      for (const Handler& handler : *current) {
+        if (handler.id != *cookie) {
+          handlers->push_back(handler);
+        }
+      }
+    }
+
+    Publish(std::move(handlers));
   }
 
   // Invokes all the subscribed handlers.
   void Fire(Args... args) const {
-    // Clone the list of callbacks to prevent deadlock if the callback causes
-    // the event to be fired recursively (from either this thread or another
-    // thread). A more efficient solution would be to iterate over read/write
-    // lock, but since this class is only used for low frequency events, the
-    // performance impact of this solution is negligible.
-    std::list<Callback> handlers_copy;
-    {
-      MutexLock lock(&mu_);
-      handlers_copy = handlers_;
+    const Handlers* handlers = handlers_.load(std::memory_order_acquire);
+    if (handlers == nullptr) {
+      return;
     }
 
-    for (auto& fn : handlers_copy) {
-      fn(args...);
+    for (const Handler& handler : *handlers) {
+      handler.fn(args...);
     }
   }
 
  private:
-  // Locks access to "handlers_" list in this class.
-  mutable Mutex mu_;
+  // Single subscription.
+  struct Handler {
+    int64 id;
+    Callback fn;
+  };
+
+  typedef std::vector<Handler> Handlers;
+
+  // Makes "handlers" the current subscribers array. Must be called with
+  // "mu_" locked.
+  void Publish(std::unique_ptr<Handlers> handlers) {
+    handlers_.store(handlers.get(), std::memory_order_release);
+    snapshots_.push_back(std::move(handlers));
+  }
+
+ private:
+  // Serializes changes to the subscribers.
+  Mutex mu_;
+
+  // Current immutable array of subscribers (or nullptr if there never were
+  // any subscribers). Owned by "snapshots_".
+  std::atomic<const Handlers*> handlers_ { nullptr };
+
+  // All the subscriber arrays ever published (including the current one).
+  std::vector<std::unique_ptr<const Handlers>> snapshots_;
 
-  // List of subscribers to the event.
-  Handlers handlers_;
+  // ID of the last subscription.
+  int64 last_id_ = 0;
 
   DISALLOW_COPY_AND_ASSIGN(Observable);
 };
@@ -0,0 +1,176 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "overhead_governor.h"
+
+#include <time.h>
+#include <algorithm>
+
+DEFINE_double(
+    max_agent_cpu,
+    0.01,  // 1% of process CPU time
+    "maximum total CPU time used by the debugger agent as a fraction of the "
+    "CPU time of the process; agent features are throttled when the agent "
+    "exceeds it; 0 disables the limit");
+
+namespace devtools {
+namespace cdbg {
+
+// Length of the accounting period over which the agent CPU time is compared
+// to the budget.
+constexpr int64 kOverheadGovernorPeriodNs = 1000000000;  // 1 second.
+
+// The throttling level is lowered once the agent uses less than this
+// fraction of the budget. The gap keeps the level from flapping.
+constexpr double kOverheadGovernorRecoveryFactor = 0.5;
+
+// Number of values in "OverheadPriority".
+constexpr int kOverheadPriorityCount =
+    static_cast<int>(OverheadPriority::Capture) + 1;
+
+constexpr int OverheadGovernor::kShardCount;
+
+static OverheadGovernor* g_instance = nullptr;
+
+// Shard of "OverheadGovernor" assigned to the current thread (or -1 if not
+// assigned yet).
+static __thread int g_overhead_governor_shard = -1;
+
+// Source of shards for new threads.
+static std::atomic<int> g_next_overhead_governor_shard { 0 };
+
+
+OverheadGovernor::OverheadGovernor(
+    std::function<int64()> fn_monotonic_ns,
+    std::function<int64()> fn_process_cpu_ns)
+    : fn_monotonic_ns_(fn_monotonic_ns),
+      fn_process_cpu_ns_(fn_process_cpu_ns),
+      period_start_ns_(fn_monotonic_ns()),
+      period_start_process_cpu_ns_(fn_process_cpu_ns()) {
+  for (Shard& shard : shards_) {
+    shard.charged_ns.store(0, std::memory_order_relaxed);
+  }
+}
+
+
+void OverheadGovernor::InitializeSingleton() {
+  DCHECK(g_instance == nullptr);
+
+  g_instance = new OverheadGovernor();
+}
+
+
+void OverheadGovernor::CleanupSingleton() {
+  delete g_instance;
+  g_instance = nullptr;
+}
+
+
+OverheadGovernor* OverheadGovernor::GetInstance() {
+  DCHECK(g_instance != nullptr);
+  return g_instance;
+}
+
+
+int64 OverheadGovernor::MonotonicClockNanos() {
+  struct timespec tp;
+  clock_gettime(CLOCK_MONOTONIC, &tp);
+  return tp.tv_sec * 1000000000L + tp.tv_nsec;
+}
+
+
+int64 OverheadGovernor::ProcessCpuClockNanos() {
+  struct timespec tp;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &tp);
+  return tp.tv_sec * 1000000000L + tp.tv_nsec;
+}
+
+
+void OverheadGovernor::Charge(int64 cost_ns) {
+  if (FLAGS_max_agent_cpu <= 0) {
+    return;
+  }
+
+  if (g_overhead_governor_shard == -1) {
+    g_overhead_governor_shard = g_next_overhead_governor_shard.fetch_add(1);
+  }
+
+  shards_[g_overhead_governor_shard & (kShardCount - 1)].charged_ns.fetch_add(
+      cost_ns,
+      std::memory_order_relaxed);
+
+  MaybeEndPeriod();
+}
+
+
+bool OverheadGovernor::IsAdmitted(OverheadPriority priority) {
+  if (FLAGS_max_agent_cpu <= 0) {
+    return true;
+  }
+
+  // Throttled features don't charge anything, so something else has to end
+  // the accounting period for the throttling to be lifted.
+  if (throttle_level() > 0) {
+    MaybeEndPeriod();
+  }
+
+  return static_cast<int>(priority) >= throttle_level();
+}
+
+
+void OverheadGovernor::MaybeEndPeriod() {
+  const int64 now = fn_monotonic_ns_();
+  int64 period_start = period_start_ns_.load(std::memory_order_relaxed);
+  if ((now - period_start < kOverheadGovernorPeriodNs) ||
+      !period_start_ns_.compare_exchange_strong(period_start, now)) {
+    return;
+  }
+
+  const int64 process_cpu_ns = fn_process_cpu_ns_();
+  const int64 period_process_cpu_ns =
+      process_cpu_ns - period_start_process_cpu_ns_.exchange(process_cpu_ns);
+
+  int64 charged_ns = 0;
+  for (Shard& shard : shards_) {
+    charged_ns += shard.charged_ns.exchange(0, std::memory_order_relaxed);
+  }
+
+  // A mostly idle process still gets the budget of one busy CPU. Otherwise
+  // even a single capture would throttle the agent in an idle process.
+  const double budget_ns = FLAGS_max_agent_cpu *
+      std::max(period_process_cpu_ns, now - period_start);
+
+  const int throttle_level = this->throttle_level();
+  int new_throttle_level = throttle_level;
+  if (charged_ns > budget_ns) {
+    new_throttle_level = std::min(throttle_level + 1, kOverheadPriorityCount);
+  } else if (charged_ns < budget_ns * kOverheadGovernorRecoveryFactor) {
+    new_throttle_level = std::max(throttle_level - 1, 0);
+  }
+
+  if (new_throttle_level != throttle_level) {
+    throttle_level_.store(new_throttle_level, std::memory_order_relaxed);
+
+    LOG(INFO) << "Agent CPU time " << charged_ns / 1000 << " us, budget "
+              << static_cast<int64>(budget_ns / 1000) << " us, throttling "
+              << new_throttle_level << " of " << kOverheadPriorityCount
+              << " agent features";
+  }
+}
+
+}  // namespace cdbg
+}  // namespace devtools
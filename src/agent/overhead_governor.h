@@ -0,0 +1,149 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_OVERHEAD_GOVERNOR_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_OVERHEAD_GOVERNOR_H_
+
+#include <atomic>
+#include <functional>
+#include "common.h"
+#include "stopwatch.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Agent features competing for the overhead budget, from the first to be
+// throttled to the last one.
+enum class OverheadPriority {
+  // Formatting of captured data on agent threads. Throttling it only delays
+  // the results.
+  Formatting,
+
+  // Dynamic log statements. Log entries are dropped while throttled.
+  DynamicLog,
+
+  // Condition evaluation. Hits on conditional breakpoints are ignored while
+  // throttled.
+  Condition,
+
+  // Data capture on breakpoint hit. The breakpoint stays active and captures
+  // on a later hit.
+  Capture
+};
+
+// Tracks the total CPU time taken from the application by the agent: the time
+// application threads spend in agent callbacks and the time of agent threads.
+// It compares it to a single budget (FLAGS_max_agent_cpu) expressed as a
+// fraction of the process CPU time, so it doesn't matter which feature uses
+// the CPU. When the agent goes over the budget, features are throttled one
+// at a time in the order of "OverheadPriority" until the agent fits again.
+//
+// This is an addition to the feature specific limits (like the condition cost
+// limits in "rate_limit.h"), which mostly protect against a single expensive
+// breakpoint.
+//
+// "Charge" and "IsAdmitted" are called on hot paths and don't lock. The
+// throttling level is reevaluated once per accounting period by whatever
+// thread notices that the period ended.
+//
+// This class is thread safe.
+class OverheadGovernor {
+ public:
+  OverheadGovernor(
+      std::function<int64()> fn_monotonic_ns = MonotonicClockNanos,
+      std::function<int64()> fn_process_cpu_ns = ProcessCpuClockNanos);
+
+  // One time initialization of the global instance.
+  static void InitializeSingleton();
+
+  // One time cleanup of the global instance.
+  static void CleanupSingleton();
+
+  // Gets the global instance of this class.
+  static OverheadGovernor* GetInstance();
+
+  // Adds CPU time used by the agent (either in an application thread or in
+  // an agent thread).
+  void Charge(int64 cost_ns);
+
+  // Checks whether the feature of the specified priority may run now.
+  bool IsAdmitted(OverheadPriority priority);
+
+  // Gets the number of currently throttled priorities (0 if nothing is
+  // throttled).
+  int throttle_level() const {
+    return throttle_level_.load(std::memory_order_relaxed);
+  }
+
+  static int64 MonotonicClockNanos();
+
+  static int64 ProcessCpuClockNanos();
+
+ private:
+  // Number of shards of "charged_ns_". Must be a power of 2.
+  static constexpr int kShardCount = 8;
+
+  // Agent CPU time charged in the current accounting period by a subset of
+  // threads. Padded to keep shards on different cache lines.
+  struct Shard {
+    std::atomic<int64> charged_ns;
+    char padding[64 - sizeof(std::atomic<int64>)];
+  };
+
+  // Ends the accounting period if it's over and adjusts "throttle_level_".
+  void MaybeEndPeriod();
+
+ private:
+  // Functions to read the clocks. Defined explicitly for unit tests.
+  const std::function<int64()> fn_monotonic_ns_;
+  const std::function<int64()> fn_process_cpu_ns_;
+
+  // CPU time charged in the current accounting period.
+  Shard shards_[kShardCount];
+
+  // Start of the current accounting period. The thread that advances it
+  // owns "period_start_process_cpu_ns_" until the next period.
+  std::atomic<int64> period_start_ns_;
+  std::atomic<int64> period_start_process_cpu_ns_;
+
+  // Number of throttled priorities, starting with the first one.
+  std::atomic<int> throttle_level_ { 0 };
+
+  DISALLOW_COPY_AND_ASSIGN(OverheadGovernor);
+};
+
+
+// Charges the CPU time of the current thread spent in the scope to the
+// global "OverheadGovernor".
+class ScopedOverheadCharge {
+ public:
+  ScopedOverheadCharge() : stopwatch_(Stopwatch::ThreadClock) { }
+
+  ~ScopedOverheadCharge() {
+    OverheadGovernor::GetInstance()->Charge(stopwatch_.GetElapsedNanos());
+  }
+
+ private:
+  const Stopwatch stopwatch_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedOverheadCharge);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_OVERHEAD_GOVERNOR_H_
@@ -0,0 +1,152 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "protobuf_type_evaluator.h"
+
+#include "instance_field_reader.h"
+#include "jni_utils.h"
+#include "messages.h"
+#include "model.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Base classes of generated messages in the different versions of the
+// protobuf runtime.
+static constexpr const char* kGeneratedMessageSignatures[] = {
+  "Lcom/google/protobuf/GeneratedMessage;",
+  "Lcom/google/protobuf/GeneratedMessageV3;",
+  "Lcom/google/protobuf/GeneratedMessageLite;"
+};
+
+// Checks whether "name" is a field generated for a message field. The code
+// generator appends '_' to the field name. Presence bits ("bitField0_") are
+// internal.
+static bool IsMessageField(const string& name) {
+  if ((name.size() < 2) || (name.back() != '_')) {
+    return false;
+  }
+
+  return name.compare(0, 8, "bitField") != 0;
+}
+
+
+template <typename T>
+static bool IsZero(const JVariant& value) {
+  T data = T();
+  value.get<T>(&data);
+  return data == T();
+}
+
+
+// Checks whether the field holds the default value, which typically means
+// that it was never set.
+static bool IsDefaultValue(const JVariant& value) {
+  switch (value.type()) {
+    case JType::Void:
+      return false;
+
+    case JType::Boolean:
+      return IsZero<jboolean>(value);
+
+    case JType::Byte:
+      return IsZero<jbyte>(value);
+
+    case JType::Char:
+      return IsZero<jchar>(value);
+
+    case JType::Short:
+      return IsZero<jshort>(value);
+
+    case JType::Int:
+      return IsZero<jint>(value);
+
+    case JType::Long:
+      return IsZero<jlong>(value);
+
+    case JType::Float:
+      return IsZero<jfloat>(value);
+
+    case JType::Double:
+      return IsZero<jdouble>(value);
+
+    case JType::Object:
+      return !value.has_non_null_object();
+  }
+
+  return false;
+}
+
+
+bool ProtobufTypeEvaluator::IsProtobufMessage(jclass cls) const {
+  if (cls == nullptr) {
+    return false;
+  }
+
+  JniLocalRef superclass(jni()->GetSuperclass(cls));
+  while (superclass != nullptr) {
+    const string signature = GetClassSignature(superclass.get());
+    for (const char* generated_message_signature :
+         kGeneratedMessageSignatures) {
+      if (signature == generated_message_signature) {
+        return true;
+      }
+    }
+
+    superclass = JniLocalRef(
+        jni()->GetSuperclass(static_cast<jclass>(superclass.get())));
+  }
+
+  return false;
+}
+
+
+void ProtobufTypeEvaluator::Evaluate(
+    MethodCaller* method_caller,
+    const ClassMetadataReader::Entry& class_metadata,
+    jobject obj,
+    std::vector<NamedJVariant>* members) {
+  members->clear();
+
+  for (const auto& field_reader : class_metadata.instance_fields) {
+    const string& name = field_reader->GetName();
+    if (!IsMessageField(name)) {
+      continue;
+    }
+
+    NamedJVariant member;
+    if (!field_reader->ReadValue(obj, &member.value)) {
+      member.status.is_error = false;
+      member.status.refers_to = StatusMessageModel::Context::VARIABLE_VALUE;
+      member.status.description = INTERNAL_ERROR_MESSAGE;
+    } else if (IsDefaultValue(member.value)) {
+      continue;
+    } else {
+      member.well_known_jclass =
+          WellKnownJClassFromSignature(field_reader->GetStaticType());
+    }
+
+    member.name = name.substr(0, name.size() - 1);
+    members->push_back(std::move(member));
+  }
+
+  if (members->empty()) {
+    members->push_back(NamedJVariant::InfoStatus({ ProtobufMessageEmpty }));
+  }
+}
+
+}  // namespace cdbg
+}  // namespace devtools
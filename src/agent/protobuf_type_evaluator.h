@@ -0,0 +1,63 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_PROTOBUF_TYPE_EVALUATOR_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_PROTOBUF_TYPE_EVALUATOR_H_
+
+#include "common.h"
+#include "type_evaluator.h"
+
+namespace devtools {
+namespace cdbg {
+
+class ClassMetadataReader;
+struct NamedJVariant;
+
+// Captures the fields of a generated protocol buffer message. The generic
+// field dump of a message is dominated by the internal fields of the
+// protobuf runtime ("bitField0_", "memoizedHashCode", "unknownFields", ...)
+// and by fields that were never set. Following the naming convention of the
+// Java code generator, this evaluator only captures fields named "foo_"
+// (reported as "foo") and skips the ones that hold the default value (null,
+// zero or false). No methods are called.
+class ProtobufTypeEvaluator : public TypeEvaluator {
+ public:
+  ProtobufTypeEvaluator() { }
+
+  // Checks whether the specified class is a generated message, i.e. one of
+  // its superclasses is "GeneratedMessage", "GeneratedMessageV3" or
+  // "GeneratedMessageLite" of "com.google.protobuf". The protobuf runtime is
+  // an application library, so the superclasses are compared by signature.
+  bool IsProtobufMessage(jclass cls) const;
+
+  string GetEvaluatorName() override {
+    return "ProtobufTypeEvaluator";
+  }
+
+  void Evaluate(
+      MethodCaller* method_caller,
+      const ClassMetadataReader::Entry& class_metadata,
+      jobject obj,
+      std::vector<NamedJVariant>* members) override;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ProtobufTypeEvaluator);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_PROTOBUF_TYPE_EVALUATOR_H_
@@ -16,8 +16,11 @@
 
 #include "rate_limit.h"
 
+#include <stdio.h>
+#include <algorithm>
 #include <thread>  // NOLINT
 #include "leaky_bucket.h"
+#include "sharded_leaky_bucket.h"
 
 //
 // See comment in rate_limit.h explaining the meaning of these flags and how
@@ -37,6 +40,12 @@ DEFINE_double(
     "maximum rate of dynamic log entries in this process; short bursts are "
     "allowed to exceed this limit");
 
+DEFINE_double(
+    max_dynamic_log_bytes_rate,
+    50 * 1024,  // 50 KB per second on average
+    "maximum rate of bytes in dynamic log messages in this process; short "
+    "bursts are allowed to exceed this limit");
+
 namespace devtools {
 namespace cdbg {
 
@@ -64,45 +73,81 @@ constexpr double kConditionCostCapacityFactor = 0.1;
 constexpr double kDynamicLogCapacityFactor = 5;  // allow short bursts.
 
 
-void MovingAverage::Add(int64 value) {
-  MutexLock lock(&mu_);
+constexpr int MovingAverage::kMaxSize;
 
-  if (window_.size() >= max_size_) {   // make room
-    sum_ -= window_.front();
-    window_.pop();
+
+MovingAverage::MovingAverage() {
+  for (std::atomic<int64>& slot : window_) {
+    slot.store(0, std::memory_order_relaxed);
   }
+}
 
-  window_.push(value);
-  sum_ += value;
+
+void MovingAverage::Add(int64 value) {
+  const int64 index = count_.fetch_add(1, std::memory_order_relaxed);
+
+  // Each value is removed from the total exactly once by whoever replaces it
+  // in the ring, even if two threads race for the same slot.
+  const int64 evicted = window_[index % kMaxSize].exchange(
+      value,
+      std::memory_order_relaxed);
+  sum_.fetch_add(value - evicted, std::memory_order_relaxed);
 }
 
 
 int64 MovingAverage::Average() const {
-  MutexLock lock(&mu_);
+  const int64 count = std::min<int64>(
+      count_.load(std::memory_order_relaxed),
+      kMaxSize);
+  if (count == 0) {
+    return 0;
+  }
 
-  if (window_.empty()) {
+  return sum_.load(std::memory_order_relaxed) / count;
+}
+
+
+int64 MovingAverage::Median() const {
+  const int count = std::min<int64>(
+      count_.load(std::memory_order_relaxed),
+      kMaxSize);
+  if (count == 0) {
     return 0;
   }
 
-  return sum_ / window_.size();
+  int64 values[kMaxSize];
+  for (int i = 0; i < count; ++i) {
+    values[i] = window_[i].load(std::memory_order_relaxed);
+  }
+
+  std::nth_element(values, values + count / 2, values + count);
+
+  return values[count / 2];
 }
 
 
 int MovingAverage::IsFilled() const {
-  MutexLock lock(&mu_);
-  return window_.size() == max_size_;
+  return count_.load(std::memory_order_relaxed) >= kMaxSize;
 }
 
 
 void MovingAverage::Reset() {
-  MutexLock lock(&mu_);
+  for (std::atomic<int64>& slot : window_) {
+    slot.store(0, std::memory_order_relaxed);
+  }
 
-  window_ = std::queue<int64>();
-  sum_ = 0.;
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
 }
 
 
-// Gets the number of CPUs that this process can use.
+// Defines the number of tokens each CPU borrows from the shared bucket of
+// a "ShardedLeakyBucket" at a time:
+//    chunk_size = capacity / (cpu_count * chunk_factor).
+static constexpr int kShardedCostLimiterChunkFactor = 16;
+
+
+// Gets the number of CPUs that this process can run on.
 static int GetCpuCount() {
   static int cpu_count_cache = -1;
 
@@ -129,6 +174,104 @@ static int GetCpuCount() {
 }
 
 
+// Reads the first one or two integer values from a file. Returns the number
+// of values read (0 if the file doesn't exist).
+static int ReadInt64Values(const char* path, int64* value1, int64* value2) {
+  FILE* file = fopen(path, "r");
+  if (file == nullptr) {
+    return 0;
+  }
+
+  const int count = (value2 == nullptr)
+      ? fscanf(file, "%lld", value1)
+      : fscanf(file, "%lld %lld", value1, value2);
+  fclose(file);
+
+  return std::max(0, count);
+}
+
+
+// Reads the CPU quota of the cgroup of this process in CPUs. Returns 0 if
+// there is no quota or it can't be read. Both cgroup v2 ("cpu.max") and v1
+// ("cpu.cfs_quota_us" and "cpu.cfs_period_us") are supported. Only the
+// cgroup mounted at "/sys/fs/cgroup" is considered, which is the cgroup of
+// the container when running in one.
+static double ReadCgroupCpuQuota() {
+  int64 quota = -1;
+  int64 period = 0;
+
+  // In cgroup v2 the quota is "max" if not limited, so only the period is
+  // not read.
+  if (ReadInt64Values("/sys/fs/cgroup/cpu.max", &quota, &period) != 2) {
+    if (ReadInt64Values(
+            "/sys/fs/cgroup/cpu/cpu.cfs_quota_us", &quota, nullptr) == 1) {
+      ReadInt64Values("/sys/fs/cgroup/cpu/cpu.cfs_period_us", &period, nullptr);
+    } else if (ReadInt64Values(
+            "/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_quota_us",
+            &quota,
+            nullptr) == 1) {
+      ReadInt64Values(
+          "/sys/fs/cgroup/cpu,cpuacct/cpu.cfs_period_us",
+          &period,
+          nullptr);
+    }
+  }
+
+  // Quota is -1 in cgroup v1 if not limited.
+  if ((quota <= 0) || (period <= 0)) {
+    return 0;
+  }
+
+  return static_cast<double>(quota) / period;
+}
+
+
+// Last computed effective CPU count (0 if not computed yet). Stored as
+// 1/1000 of a CPU so that it fits into a lock free atomic.
+static std::atomic<int64> g_effective_cpu_millis { 0 };
+
+
+// Computes the effective CPU count in 1/1000 of a CPU.
+static int64 ComputeEffectiveCpuMillis() {
+  double cpu_count = GetCpuCount();
+
+  const double quota = ReadCgroupCpuQuota();
+  if (quota > 0) {
+    cpu_count = std::min(cpu_count, quota);
+  }
+
+  // Don't go below a small fraction of a CPU, so that the limiters still
+  // let something through.
+  return std::max<int64>(100, cpu_count * 1000);
+}
+
+
+double GetEffectiveCpuCount() {
+  int64 cpu_millis = g_effective_cpu_millis.load(std::memory_order_relaxed);
+  if (cpu_millis == 0) {
+    UpdateEffectiveCpuCount();
+    cpu_millis = g_effective_cpu_millis.load(std::memory_order_relaxed);
+  }
+
+  return cpu_millis / 1000.0;
+}
+
+
+bool UpdateEffectiveCpuCount() {
+  const int64 cpu_millis = ComputeEffectiveCpuMillis();
+  const int64 previous_cpu_millis =
+      g_effective_cpu_millis.exchange(cpu_millis, std::memory_order_relaxed);
+  if (cpu_millis == previous_cpu_millis) {
+    return false;
+  }
+
+  LOG(INFO) << "Effective CPU count: " << cpu_millis / 1000.0;
+
+  // The first computation is not a change.
+  return previous_cpu_millis != 0;
+}
+
+
 static int64 GetBaseFillRate(CostLimitType type) {
   switch (type) {
     case CostLimitType::BreakpointCondition:
@@ -136,6 +279,9 @@ static int64 GetBaseFillRate(CostLimitType type) {
 
     case CostLimitType::DynamicLog:
       return FLAGS_max_dynamic_log_rate;
+
+    case CostLimitType::DynamicLogBytes:
+      return FLAGS_max_dynamic_log_bytes_rate;
   }
 
   return 0;
@@ -148,6 +294,7 @@ static int64 GetBaseCapacity(CostLimitType type) {
       return GetBaseFillRate(type) * kConditionCostCapacityFactor;
 
     case CostLimitType::DynamicLog:
+    case CostLimitType::DynamicLogBytes:
       return GetBaseFillRate(type) * kDynamicLogCapacityFactor;
   }
 
@@ -155,16 +302,76 @@ static int64 GetBaseCapacity(CostLimitType type) {
 }
 
 
-std::unique_ptr<LeakyBucket> CreateGlobalCostLimiter(CostLimitType type) {
+// Computes the parameters of a global limiter for the effective CPU count.
+static void GetGlobalCostLimits(
+    CostLimitType type,
+    int64* capacity,
+    int64* fill_rate) {
   // Logs are I/O bound, not CPU bound.
-  int cpu_factor = ((type == CostLimitType::DynamicLog) ? 1 : GetCpuCount());
+  const double cpu_factor =
+      ((type == CostLimitType::DynamicLog) ||
+       (type == CostLimitType::DynamicLogBytes))
+          ? 1
+          : GetEffectiveCpuCount();
+
+  *capacity = GetBaseCapacity(type) * cpu_factor;
+  *fill_rate = GetBaseFillRate(type) * cpu_factor;
+}
+
+
+// Computes the chunk size of a sharded global limiter. Tokens cached by all
+// the shards together are at most 1/16 of the capacity. There is no point in
+// sharding on a single CPU.
+static int64 GetShardedCostLimiterChunkSize(int64 capacity) {
+  const int cpu_count = GetCpuCount();
+  if (cpu_count <= 1) {
+    return 0;
+  }
+
+  return capacity / (cpu_count * kShardedCostLimiterChunkFactor);
+}
+
+
+std::unique_ptr<LeakyBucket> CreateGlobalCostLimiter(CostLimitType type) {
+  int64 capacity;
+  int64 fill_rate;
+  GetGlobalCostLimits(type, &capacity, &fill_rate);
 
-  int64 capacity = GetBaseCapacity(type) * cpu_factor;
-  int64 fill_rate = GetBaseFillRate(type) * cpu_factor;
   return std::unique_ptr<LeakyBucket>(new LeakyBucket(capacity, fill_rate));
 }
 
 
+std::unique_ptr<ShardedLeakyBucket> CreateShardedGlobalCostLimiter(
+    CostLimitType type) {
+  int64 capacity;
+  int64 fill_rate;
+  GetGlobalCostLimits(type, &capacity, &fill_rate);
+
+  // Shards are selected by CPU number, so there is one for every CPU the
+  // process may run on, even if the quota doesn't let it use all of them
+  // at once.
+  return std::unique_ptr<ShardedLeakyBucket>(new ShardedLeakyBucket(
+      capacity,
+      fill_rate,
+      GetCpuCount(),
+      GetShardedCostLimiterChunkSize(capacity)));
+}
+
+
+void ResizeShardedGlobalCostLimiter(
+    CostLimitType type,
+    ShardedLeakyBucket* limiter) {
+  int64 capacity;
+  int64 fill_rate;
+  GetGlobalCostLimits(type, &capacity, &fill_rate);
+
+  limiter->SetLimits(
+      capacity,
+      fill_rate,
+      GetShardedCostLimiterChunkSize(capacity));
+}
+
+
 std::unique_ptr<LeakyBucket> CreatePerBreakpointCostLimiter(
     CostLimitType type) {
   int64 capacity = GetBaseCapacity(type);
@@ -17,8 +17,8 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_RATE_LIMIT_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_RATE_LIMIT_H_
 
+#include <atomic>
 #include <memory>
-#include <queue>
 #include "common.h"
 #include "mutex.h"
 
@@ -26,6 +26,7 @@ namespace devtools {
 namespace cdbg {
 
 class LeakyBucket;
+class ShardedLeakyBucket;
 
 //
 // Each rate limit is defined as the maximum amount of time in nanoseconds to
@@ -37,7 +38,9 @@ class LeakyBucket;
 //    exceed the limit gets disabled.
 //
 // The global limit is for all CPUs combined (we assume that multiple
-// breakpoints will hit different CPUs). We don't make this assumption
+// breakpoints will hit different CPUs). The CPU count takes the cgroup CPU
+// quota into account, so a container limited to 2 CPUs on a large host gets
+// the budget of 2 CPUs. We don't make this assumption
 // for per-breakpoint limit.
 //
 // The first rule ensures that in vast majority of scenarios expensive
@@ -50,46 +53,81 @@ class LeakyBucket;
 // yield false positives if JVM triggers garbage collection while the debuglet
 // is evaluating the condition or writing a log statement. To alleviate the
 // effect of garbage collector, we apply moving average filter to time
-// measurements. It would be better to use median, but there are no efficient
-// algorithms to compute a running median.
+// measurements. Alternatively the median of the same window can be used,
+// which is not affected by occasional garbage collection pauses at all.
 //
 
 // Types of cost limits we have in the debuglet.
 enum class CostLimitType {
   BreakpointCondition,
-  DynamicLog
+  DynamicLog,
+  DynamicLogBytes
 };
 
 // Creates instance of "LeakyBucket" to enforce global cost.
 std::unique_ptr<LeakyBucket> CreateGlobalCostLimiter(CostLimitType type);
 
+// Creates instance of "ShardedLeakyBucket" to enforce global cost. Unlike
+// "CreateGlobalCostLimiter" the limiter scales with many application threads
+// requesting tokens simultaneously on different CPUs.
+std::unique_ptr<ShardedLeakyBucket> CreateShardedGlobalCostLimiter(
+    CostLimitType type);
+
 // Creates instance of "LeakyBucket" to enforce per breakpoint cost.
 std::unique_ptr<LeakyBucket> CreatePerBreakpointCostLimiter(CostLimitType type);
 
-// Thread safe moving average computation.
+// Gets the number of CPUs available to the process: the CPUs it is allowed
+// to run on, further limited by the cgroup CPU quota (e.g. in a container).
+// The quota can be a fraction of a CPU. Global cost limits scale with it.
+double GetEffectiveCpuCount();
+
+// Reads the cgroup CPU quota again. Returns true if the effective CPU count
+// changed, in which case the existing global limiters should be resized with
+// "ResizeShardedGlobalCostLimiter".
+bool UpdateEffectiveCpuCount();
+
+// Adjusts a limiter created by "CreateShardedGlobalCostLimiter" to the
+// current effective CPU count.
+void ResizeShardedGlobalCostLimiter(
+    CostLimitType type,
+    ShardedLeakyBucket* limiter);
+
+// Thread safe moving average computation. The class is lock free and never
+// allocates memory: the last values are kept in a fixed ring of atomics and
+// the total is updated incrementally. When multiple threads add values
+// simultaneously, "Average" may momentarily reflect a partially applied
+// update, which is good enough for rate limiting.
 class MovingAverage {
  public:
+  MovingAverage();
+
   void Add(int64 value);
 
   int64 Average() const;
 
+  // Gets the median of the last values. Unlike the average, the median is
+  // not skewed by a few outliers (e.g. a condition evaluation interrupted by
+  // garbage collection).
+  int64 Median() const;
+
   int IsFilled() const;
 
+  // Not thread safe with respect to "Add".
   void Reset();
 
  private:
   // We compute the k-term moving average. The choice of 32 is arbitrary.
   // TODO(vlif): adjust it to optimal value.
-  const int max_size_ { 32 };
+  static constexpr int kMaxSize = 32;
 
-  // Lock access to "window_" and "sum_".
-  mutable Mutex mu_;
+  // Last k values. Slot "i % kMaxSize" holds the i-th added value.
+  std::atomic<int64> window_[kMaxSize];
 
-  // Last k values.
-  std::queue<int64> window_;
+  // Total number of values added so far.
+  std::atomic<int64> count_ { 0 };
 
   // Total of last k values.
-  int64 sum_ { 0 };
+  std::atomic<int64> sum_ { 0 };
 };
 
 }  // namespace cdbg
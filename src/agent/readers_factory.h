@@ -31,6 +31,7 @@ class ClassIndexer;
 class LocalVariableReader;
 class InstanceFieldReader;
 class StaticFieldReader;
+class SharedSubexpressionValues;
 class FormatMessageModel;
 
 // Exposes JVM to expression evaluation through set of mockable interfaces.
@@ -148,8 +149,16 @@ struct EvaluationContext {
   jint frame_depth = 0;
 
   // Invokes methods referenced in an expression. Keeps quota to limit the
-  // complexity of the interpreted methods.
+  // complexity of the interpreted methods. May be null if the evaluated
+  // expression doesn't call any methods (see
+  // "ExpressionEvaluator::HasMethodCalls").
   MethodCaller* method_caller = nullptr;
+
+  // Values of subexpressions shared by the condition and the watched
+  // expressions of the breakpoint being evaluated (see
+  // "SharedSubexpressionEvaluator"). May be null, in which case every
+  // subexpression is evaluated on its own.
+  SharedSubexpressionValues* shared_values = nullptr;
 };
 
 }  // namespace cdbg
@@ -0,0 +1,193 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "retained_class_files.h"
+
+#include <cstring>
+#include <sstream>
+#include "jni_utils.h"
+
+DEFINE_string(
+    cdbg_retained_class_files_packages,
+    "",
+    "Colon separated list of internal names prefixes (e.g. "
+    "\"com/mycompany/\") of classes whose class files are kept in memory "
+    "when loaded by JVM, so that safe caller doesn't need to read them "
+    "from disk");
+
+DEFINE_int32(
+    cdbg_retained_class_files_max_size,
+    16 * 1024 * 1024,  // 16 MB.
+    "Maximum total size of class files kept in memory");
+
+namespace devtools {
+namespace cdbg {
+
+// Global instance of "RetainedClassFiles" (or nullptr if disabled). Never
+// released, since "ClassFile" instances reference the retained buffers.
+static RetainedClassFiles* g_retained_class_files = nullptr;
+
+
+RetainedClassFiles::RetainedClassFiles(
+    std::vector<string> package_prefixes,
+    int64 max_size)
+    : package_prefixes_(std::move(package_prefixes)),
+      max_size_(max_size) {
+}
+
+
+RetainedClassFiles::~RetainedClassFiles() {
+  for (auto& entry : entries_) {
+    if (entry.second.loader != nullptr) {
+      jni()->DeleteWeakGlobalRef(entry.second.loader);
+    }
+  }
+}
+
+
+void RetainedClassFiles::JvmtiOnClassFileLoadHook(
+    jobject loader,
+    const char* name,
+    const uint8* class_data,
+    int class_data_len) {
+  if ((name == nullptr) || !IsRetainedClass(name)) {
+    return;
+  }
+
+  jobject loader_ref = nullptr;
+  if (loader != nullptr) {
+    loader_ref = jni()->NewWeakGlobalRef(loader);
+    if (loader_ref == nullptr) {
+      return;
+    }
+  }
+
+  {
+    MutexLock lock(&mu_);
+
+    if (total_size_ + class_data_len <= max_size_) {
+      void* buffer = arena_.Allocate(class_data_len, 1);
+      memcpy(buffer, class_data, class_data_len);
+
+      entries_.insert(std::make_pair(
+          string(name),
+          Entry { loader_ref, ByteSource(buffer, class_data_len) }));
+      total_size_ += class_data_len;
+
+      return;
+    }
+  }
+
+  LOG_FIRST_N(INFO, 1) << "Retained class files budget exhausted, class "
+                       << name << " will not be retained";
+
+  if (loader_ref != nullptr) {
+    jni()->DeleteWeakGlobalRef(loader_ref);
+  }
+}
+
+
+bool RetainedClassFiles::Find(jclass cls, ByteSource* class_file) {
+  const string signature = GetClassSignature(cls);
+  if ((signature.size() < 2) ||
+      (signature.front() != 'L') ||
+      (signature.back() != ';')) {
+    return false;
+  }
+
+  const string name = signature.substr(1, signature.size() - 2);
+  if (!IsRetainedClass(name.c_str())) {
+    return false;
+  }
+
+  jobject loader = nullptr;
+  if (jvmti()->GetClassLoader(cls, &loader) != JVMTI_ERROR_NONE) {
+    return false;
+  }
+
+  JniLocalRef loader_ref(loader);
+
+  MutexLock lock(&mu_);
+
+  auto range = entries_.equal_range(name);
+  for (auto it = range.first; it != range.second; ++it) {
+    const Entry& entry = it->second;
+
+    // A dead weak reference is the same as nullptr, so it can't be confused
+    // with a live class loader. The bootstrap class loader is nullptr too,
+    // but its entries never have a weak reference to begin with.
+    const bool same_loader = (entry.loader == nullptr)
+        ? (loader == nullptr)
+        : ((loader != nullptr) && jni()->IsSameObject(entry.loader, loader));
+    if (same_loader) {
+      *class_file = entry.class_file;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+int64 RetainedClassFiles::total_size() const {
+  MutexLock lock(&mu_);
+  return total_size_;
+}
+
+
+bool RetainedClassFiles::IsRetainedClass(const char* name) const {
+  for (const string& prefix : package_prefixes_) {
+    if (strncmp(name, prefix.c_str(), prefix.size()) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+bool InitializeRetainedClassFiles() {
+  DCHECK(g_retained_class_files == nullptr);
+
+  std::vector<string> package_prefixes;
+  std::stringstream ss(FLAGS_cdbg_retained_class_files_packages);
+  string item;
+  while (std::getline(ss, item, ':')) {
+    if (!item.empty()) {
+      package_prefixes.push_back(std::move(item));
+    }
+  }
+
+  if (package_prefixes.empty() ||
+      (FLAGS_cdbg_retained_class_files_max_size <= 0)) {
+    return false;
+  }
+
+  g_retained_class_files = new RetainedClassFiles(
+      std::move(package_prefixes),
+      FLAGS_cdbg_retained_class_files_max_size);
+
+  return true;
+}
+
+
+RetainedClassFiles* GetRetainedClassFiles() {
+  return g_retained_class_files;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
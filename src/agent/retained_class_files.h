@@ -0,0 +1,114 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_RETAINED_CLASS_FILES_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_RETAINED_CLASS_FILES_H_
+
+#include <unordered_map>
+#include <vector>
+#include "arena.h"
+#include "byte_source.h"
+#include "common.h"
+#include "mutex.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Keeps copies of class files that JVM passes to the class file load hook.
+// Loading a class file through "ClassPathLookup" reads it from disk or from
+// a .jar file. Classes retained here are parsed in place instead, with no
+// I/O and no copy.
+//
+// Only classes of the configured packages are retained. The total size of
+// retained class files is bounded; once the budget is exhausted, new classes
+// are no longer retained. Retained class files are never released, so that
+// "ClassFile" instances can reference them directly.
+//
+// This class is thread safe.
+class RetainedClassFiles {
+ public:
+  // "package_prefixes" are internal names (e.g. "com/google/") of classes
+  // to retain. "max_size" is the maximum total size in bytes of all the
+  // retained class files.
+  RetainedClassFiles(std::vector<string> package_prefixes, int64 max_size);
+
+  ~RetainedClassFiles();
+
+  // Class file load hook. "loader" is nullptr for the bootstrap class loader.
+  // "name" is the internal name of the class (might be nullptr).
+  void JvmtiOnClassFileLoadHook(
+      jobject loader,
+      const char* name,
+      const uint8* class_data,
+      int class_data_len);
+
+  // Finds the retained class file of "cls". The returned buffer never
+  // changes and stays valid for the lifetime of this class. Returns false
+  // if the class was not retained.
+  bool Find(jclass cls, ByteSource* class_file);
+
+  // Total size in bytes of the retained class files.
+  int64 total_size() const;
+
+ private:
+  struct Entry {
+    // Weak global reference to the class loader (nullptr for the bootstrap
+    // class loader).
+    jobject loader;
+
+    // Copy of the class file in "arena_".
+    ByteSource class_file;
+  };
+
+  // Checks whether the class belongs to one of the retained packages.
+  bool IsRetainedClass(const char* name) const;
+
+ private:
+  // Internal names prefixes of the retained classes.
+  const std::vector<string> package_prefixes_;
+
+  // Maximum total size of the retained class files.
+  const int64 max_size_;
+
+  // Locks access to all the data members below.
+  mutable Mutex mu_;
+
+  // Storage of the retained class files.
+  Arena arena_;
+
+  // Retained class files. The key is the internal name of the class. The
+  // same class might be loaded by multiple class loaders.
+  std::unordered_multimap<string, Entry> entries_;
+
+  // Total size of the retained class files.
+  int64 total_size_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(RetainedClassFiles);
+};
+
+
+// Creates the global instance of "RetainedClassFiles" if enabled through
+// flags. Must be called once while the agent is loaded. Returns true if the
+// class file load hook should be enabled.
+bool InitializeRetainedClassFiles();
+
+// Gets the global instance of "RetainedClassFiles" or nullptr if disabled.
+RetainedClassFiles* GetRetainedClassFiles();
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_RETAINED_CLASS_FILES_H_
@@ -0,0 +1,278 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "safe_caller_intrinsics.h"
+
+#include <algorithm>
+#include <cmath>
+#include "jni_utils.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Reads the argument at the specified index. The argument type has already
+// been verified against the method signature.
+template <typename T>
+static T GetArgument(const std::vector<JVariant>& arguments, int index) {
+  T value = T();
+  const bool rc = arguments[index].get<T>(&value);
+  DCHECK(rc);
+  return value;
+}
+
+
+//
+// java.lang.Math and java.lang.StrictMath.
+//
+
+// Java "abs" wraps around for the minimum value of integral types (e.g.
+// "Math.abs(Integer.MIN_VALUE)" returns "Integer.MIN_VALUE").
+template <typename T, typename TUnsigned>
+static MethodCallResult MathAbsIntegral(
+    SafeMethodCaller* caller,
+    jobject unused_instance,
+    const std::vector<JVariant>& arguments) {
+  const T value = GetArgument<T>(arguments, 0);
+  const T result = (value < 0)
+      ? static_cast<T>(static_cast<TUnsigned>(0) -
+                       static_cast<TUnsigned>(value))
+      : value;
+  return MethodCallResult::Success(JVariant::Primitive<T>(result));
+}
+
+
+template <typename T>
+static MethodCallResult MathAbsFloating(
+    SafeMethodCaller* caller,
+    jobject unused_instance,
+    const std::vector<JVariant>& arguments) {
+  return MethodCallResult::Success(
+      JVariant::Primitive<T>(std::fabs(GetArgument<T>(arguments, 0))));
+}
+
+
+template <typename T>
+static MethodCallResult MathMaxIntegral(
+    SafeMethodCaller* caller,
+    jobject unused_instance,
+    const std::vector<JVariant>& arguments) {
+  const T a = GetArgument<T>(arguments, 0);
+  const T b = GetArgument<T>(arguments, 1);
+  return MethodCallResult::Success(JVariant::Primitive<T>((a >= b) ? a : b));
+}
+
+
+template <typename T>
+static MethodCallResult MathMinIntegral(
+    SafeMethodCaller* caller,
+    jobject unused_instance,
+    const std::vector<JVariant>& arguments) {
+  const T a = GetArgument<T>(arguments, 0);
+  const T b = GetArgument<T>(arguments, 1);
+  return MethodCallResult::Success(JVariant::Primitive<T>((a <= b) ? a : b));
+}
+
+
+// Java "max" returns NaN if either argument is NaN and considers -0.0 to be
+// smaller than 0.0.
+template <typename T>
+static MethodCallResult MathMaxFloating(
+    SafeMethodCaller* caller,
+    jobject unused_instance,
+    const std::vector<JVariant>& arguments) {
+  const T a = GetArgument<T>(arguments, 0);
+  const T b = GetArgument<T>(arguments, 1);
+
+  T result;
+  if (std::isnan(a)) {
+    result = a;
+  } else if (std::isnan(b)) {
+    result = b;
+  } else if ((a == 0) && (b == 0)) {
+    result = std::signbit(a) ? b : a;
+  } else {
+    result = (a >= b) ? a : b;
+  }
+
+  return MethodCallResult::Success(JVariant::Primitive<T>(result));
+}
+
+
+// Java "min" returns NaN if either argument is NaN and considers -0.0 to be
+// smaller than 0.0.
+template <typename T>
+static MethodCallResult MathMinFloating(
+    SafeMethodCaller* caller,
+    jobject unused_instance,
+    const std::vector<JVariant>& arguments) {
+  const T a = GetArgument<T>(arguments, 0);
+  const T b = GetArgument<T>(arguments, 1);
+
+  T result;
+  if (std::isnan(a)) {
+    result = a;
+  } else if (std::isnan(b)) {
+    result = b;
+  } else if ((a == 0) && (b == 0)) {
+    result = std::signbit(a) ? a : b;
+  } else {
+    result = (a <= b) ? a : b;
+  }
+
+  return MethodCallResult::Success(JVariant::Primitive<T>(result));
+}
+
+
+//
+// java.lang.String.
+//
+
+// Method signature:
+//     public int length();
+static MethodCallResult StringLength(
+    SafeMethodCaller* caller,
+    jobject instance,
+    const std::vector<JVariant>& arguments) {
+  return MethodCallResult::Success(
+      JVariant::Int(jni()->GetStringLength(static_cast<jstring>(instance))));
+}
+
+
+// Method signature:
+//     public boolean isEmpty();
+static MethodCallResult StringIsEmpty(
+    SafeMethodCaller* caller,
+    jobject instance,
+    const std::vector<JVariant>& arguments) {
+  const jsize length = jni()->GetStringLength(static_cast<jstring>(instance));
+  return MethodCallResult::Success(JVariant::Boolean(length == 0));
+}
+
+
+// Method signature:
+//     public char charAt(int index);
+static MethodCallResult StringCharAt(
+    SafeMethodCaller* caller,
+    jobject instance,
+    const std::vector<JVariant>& arguments) {
+  const jint index = GetArgument<jint>(arguments, 0);
+
+  // "GetStringRegion" throws "StringIndexOutOfBoundsException" if "index" is
+  // out of range (same as "String.charAt").
+  jchar c = 0;
+  jni()->GetStringRegion(static_cast<jstring>(instance), index, 1, &c);
+  if (jni()->ExceptionCheck()) {
+    return MethodCallResult::PendingJniException();
+  }
+
+  return MethodCallResult::Success(JVariant::Char(c));
+}
+
+
+// Method signature:
+//     public boolean equals(Object anObject);
+static MethodCallResult StringEquals(
+    SafeMethodCaller* caller,
+    jobject instance,
+    const std::vector<JVariant>& arguments) {
+  const jobject other = GetArgument<jobject>(arguments, 0);
+
+  if (jni()->IsSameObject(instance, other)) {
+    return MethodCallResult::Success(JVariant::Boolean(true));
+  }
+
+  if (other == nullptr) {
+    return MethodCallResult::Success(JVariant::Boolean(false));
+  }
+
+  // "java.lang.String" is final, so the class of "instance" is String.
+  JniLocalRef string_cls = GetObjectClass(instance);
+  if ((string_cls == nullptr) ||
+      !jni()->IsInstanceOf(other, static_cast<jclass>(string_cls.get()))) {
+    return MethodCallResult::Success(JVariant::Boolean(false));
+  }
+
+  jstring s1 = static_cast<jstring>(instance);
+  jstring s2 = static_cast<jstring>(other);
+
+  const jsize length = jni()->GetStringLength(s1);
+  if (length != jni()->GetStringLength(s2)) {
+    return MethodCallResult::Success(JVariant::Boolean(false));
+  }
+
+  //
+  // Note: no JNI calls are allowed between GetStringCritical and
+  // ReleaseStringCritical.
+  //
+
+  bool is_equal = false;
+  const jchar* chars1 = jni()->GetStringCritical(s1, nullptr);
+  if (chars1 != nullptr) {
+    const jchar* chars2 = jni()->GetStringCritical(s2, nullptr);
+    if (chars2 != nullptr) {
+      is_equal = std::equal(chars1, chars1 + length, chars2);
+      jni()->ReleaseStringCritical(s2, chars2);
+    }
+
+    jni()->ReleaseStringCritical(s1, chars1);
+
+    if (chars2 == nullptr) {
+      return MethodCallResult::Error(INTERNAL_ERROR_MESSAGE);
+    }
+  } else {
+    return MethodCallResult::Error(INTERNAL_ERROR_MESSAGE);
+  }
+
+  return MethodCallResult::Success(JVariant::Boolean(is_equal));
+}
+
+
+// Intrinsics of methods available in both "java.lang.Math" and
+// "java.lang.StrictMath". The two classes are identical for these methods.
+#define MATH_INTRINSICS(class_name) \
+  { class_name, "abs", "(I)I", MathAbsIntegral<jint, uint32> }, \
+  { class_name, "abs", "(J)J", MathAbsIntegral<jlong, uint64> }, \
+  { class_name, "abs", "(F)F", MathAbsFloating<jfloat> }, \
+  { class_name, "abs", "(D)D", MathAbsFloating<jdouble> }, \
+  { class_name, "max", "(II)I", MathMaxIntegral<jint> }, \
+  { class_name, "max", "(JJ)J", MathMaxIntegral<jlong> }, \
+  { class_name, "max", "(FF)F", MathMaxFloating<jfloat> }, \
+  { class_name, "max", "(DD)D", MathMaxFloating<jdouble> }, \
+  { class_name, "min", "(II)I", MathMinIntegral<jint> }, \
+  { class_name, "min", "(JJ)J", MathMinIntegral<jlong> }, \
+  { class_name, "min", "(FF)F", MathMinFloating<jfloat> }, \
+  { class_name, "min", "(DD)D", MathMinFloating<jdouble> }
+
+static const SafeCallerIntrinsic safe_caller_intrinsics[] = {
+  MATH_INTRINSICS("java/lang/Math"),
+  MATH_INTRINSICS("java/lang/StrictMath"),
+  { "java/lang/String", "length", "()I", StringLength },
+  { "java/lang/String", "isEmpty", "()Z", StringIsEmpty },
+  { "java/lang/String", "charAt", "(I)C", StringCharAt },
+  { "java/lang/String", "equals", "(Ljava/lang/Object;)Z", StringEquals }
+};
+
+#undef MATH_INTRINSICS
+
+
+const SafeCallerIntrinsic* GetSafeCallerIntrinsics(int* size) {
+  *size = arraysize(safe_caller_intrinsics);
+  return safe_caller_intrinsics;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
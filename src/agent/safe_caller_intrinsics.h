@@ -0,0 +1,64 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_SAFE_CALLER_INTRINSICS_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_SAFE_CALLER_INTRINSICS_H_
+
+#include <vector>
+#include "common.h"
+#include "jvariant.h"
+#include "method_call_result.h"
+
+namespace devtools {
+namespace cdbg {
+
+class SafeMethodCaller;
+
+// Native implementation of a Java method. Intrinsics replace the JNI call of
+// allowed methods that are called very frequently from expressions and
+// pretty printers. An intrinsic must have exactly the same semantics as the
+// Java method it replaces (including exceptions).
+//
+// "arguments" are guaranteed to match the method signature.
+typedef MethodCallResult (*SafeCallerIntrinsicFn)(
+    SafeMethodCaller* caller,
+    jobject instance,
+    const std::vector<JVariant>& arguments);
+
+// Binds an intrinsic to a Java method.
+struct SafeCallerIntrinsic {
+  // Internal name of the class that defines the method (e.g.
+  // "java/lang/String").
+  const char* class_name;
+
+  // Method name.
+  const char* method_name;
+
+  // Method signature.
+  const char* method_signature;
+
+  // Native implementation of the method.
+  SafeCallerIntrinsicFn fn;
+};
+
+// Gets the table of all the available intrinsics. "size" is set to the
+// number of entries in the table.
+const SafeCallerIntrinsic* GetSafeCallerIntrinsics(int* size);
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_SAFE_CALLER_INTRINSICS_H_
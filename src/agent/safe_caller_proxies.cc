@@ -164,7 +164,8 @@ MethodCallResult StringFormatPre(
             false,
             to_string,
             ref.get(),
-            {});
+            {},
+            nullptr);
         if (rc.result_type() != MethodCallResult::Type::Success) {
           return rc;
         }
@@ -16,7 +16,12 @@
 
 #include "safe_method_caller.h"
 
+#include <algorithm>
+#include <atomic>
+#include <map>
 #include "jni_method_caller.h"
+#include "mutex.h"
+#include "stopwatch.h"
 #include "type_util.h"
 #include "jni_proxy_nullpointerexception.h"
 
@@ -24,20 +29,192 @@ DECLARE_bool(enable_safe_caller);
 DECLARE_int32(safe_caller_max_array_elements);
 DECLARE_int32(safe_caller_max_interpreter_stack_depth);
 
+DEFINE_int32(
+    safe_caller_interpreted_calls_log_interval,
+    0,
+    "If positive, safe caller counts methods executed by the NanoJava "
+    "interpreter and logs the most frequent ones every specified number of "
+    "interpreted calls (used to find candidates for new intrinsics)");
+
+DEFINE_int32(
+    safe_caller_doomed_call_retry_interval,
+    16,
+    "Loops in methods that previously ran out of instructions quota are "
+    "rejected without interpretation when the remaining quota is not larger. "
+    "Every specified number of rejected calls is interpreted anyway in case "
+    "the data changed. Zero disables the rejection");
+
+DEFINE_int32(
+    safe_caller_interpreter_stats_log_interval,
+    0,
+    "If positive, safe caller measures the NanoJava interpreter throughput "
+    "(instructions per second, allocations and quota rejections) and logs it "
+    "every specified number of top level interpreted calls");
+
+DEFINE_bool(
+    safe_caller_trust_compiled_call_sites,
+    true,
+    "Skip the runtime argument checks for allowed methods called from "
+    "compiled expressions that verified the argument types at compile time");
+
 namespace devtools {
 namespace cdbg {
 
 using devtools::cdbg::nanojava::NanoJavaInterpreter;
 
+// Number of methods to print in the interpreted calls statistics.
+constexpr int kInterpretedCallsTopCount = 20;
+
+// Locks access to the interpreted calls statistics.
+static Mutex g_interpreted_calls_mu;
+
+// Number of calls per interpreted method (across all instances of
+// "SafeMethodCaller"). Allocated on first use and never freed.
+static std::map<string, int64>* g_interpreted_calls = nullptr;
+
+// Total number of interpreted method calls.
+static int64 g_interpreted_calls_total = 0;
+
+
+// Throughput of the NanoJava interpreter aggregated across all instances of
+// "SafeMethodCaller". Only top level interpreted calls are measured (nested
+// calls are included in the time of the outer call).
+struct InterpreterStats {
+  // Number of top level interpreted calls.
+  std::atomic<int64> calls { 0 };
+
+  // Number of executed instructions (including the nested calls).
+  std::atomic<int64> instructions { 0 };
+
+  // Wall time spent in the interpreter.
+  std::atomic<int64> elapsed_nanos { 0 };
+
+  // Number of objects allocated by the interpreted code.
+  std::atomic<int64> allocated_objects { 0 };
+
+  // Number of arrays allocated by the interpreted code.
+  std::atomic<int64> allocated_arrays { 0 };
+
+  // Number of calls that ran out of instructions quota.
+  std::atomic<int64> quota_exceeded { 0 };
+
+  // Number of calls rejected upfront because they previously ran out of
+  // instructions quota.
+  std::atomic<int64> quota_rejected { 0 };
+};
+
+static InterpreterStats g_interpreter_stats;
+
+
+// Updates the interpreter throughput statistics with a completed top level
+// interpreted call and periodically logs them.
+static void CountInterpreterRun(
+    int64 instructions,
+    int64 elapsed_nanos,
+    int64 allocated_objects,
+    int64 allocated_arrays,
+    bool quota_exceeded) {
+  const int interval = FLAGS_safe_caller_interpreter_stats_log_interval;
+
+  g_interpreter_stats.instructions += instructions;
+  g_interpreter_stats.elapsed_nanos += elapsed_nanos;
+  g_interpreter_stats.allocated_objects += allocated_objects;
+  g_interpreter_stats.allocated_arrays += allocated_arrays;
+  if (quota_exceeded) {
+    ++g_interpreter_stats.quota_exceeded;
+  }
+
+  const int64 calls = ++g_interpreter_stats.calls;
+  if (calls % interval != 0) {
+    return;
+  }
+
+  const int64 total_instructions = g_interpreter_stats.instructions.load();
+  const int64 total_nanos = g_interpreter_stats.elapsed_nanos.load();
+
+  LOG(INFO) << "NanoJava interpreter statistics: "
+            << calls << " calls, "
+            << total_instructions << " instructions, "
+            << (total_nanos / 1000) << " microseconds, "
+            << ((total_nanos > 0)
+                ? (total_instructions * 1000000000 / total_nanos)
+                : 0) << " instructions per second, "
+            << g_interpreter_stats.allocated_objects.load()
+            << " objects allocated, "
+            << g_interpreter_stats.allocated_arrays.load()
+            << " arrays allocated, "
+            << g_interpreter_stats.quota_exceeded.load()
+            << " calls out of quota, "
+            << g_interpreter_stats.quota_rejected.load()
+            << " calls rejected upfront";
+}
+
+
+// Updates statistics of methods executed by the NanoJava interpreter and
+// periodically prints the most frequently interpreted ones.
+static void CountInterpretedCall(const ClassMetadataReader::Method& metadata) {
+  const int interval = FLAGS_safe_caller_interpreted_calls_log_interval;
+  if (interval <= 0) {
+    return;
+  }
+
+  string key = metadata.class_signature.object_signature;
+  key += '.';
+  key += metadata.name;
+  key += metadata.signature;
+
+  MutexLock lock(&g_interpreted_calls_mu);
+
+  if (g_interpreted_calls == nullptr) {
+    g_interpreted_calls = new std::map<string, int64>;
+  }
+
+  ++(*g_interpreted_calls)[key];
+  ++g_interpreted_calls_total;
+
+  if (g_interpreted_calls_total % interval != 0) {
+    return;
+  }
+
+  std::vector<std::pair<int64, const string*>> top;
+  top.reserve(g_interpreted_calls->size());
+  for (const auto& entry : *g_interpreted_calls) {
+    top.push_back(std::make_pair(entry.second, &entry.first));
+  }
+
+  const int count = std::min<int>(top.size(), kInterpretedCallsTopCount);
+  std::partial_sort(
+      top.begin(),
+      top.begin() + count,
+      top.end(),
+      [] (const std::pair<int64, const string*>& p1,
+          const std::pair<int64, const string*>& p2) {
+        return p1.first > p2.first;
+      });
+
+  string message;
+  for (int i = 0; i < count; ++i) {
+    message += "\n    ";
+    message += std::to_string(top[i].first);
+    message += ' ';
+    message += *top[i].second;
+  }
+
+  LOG(INFO) << "Most frequently interpreted methods (out of "
+            << g_interpreted_calls_total << " calls):" << message;
+}
+
 SafeMethodCaller::SafeMethodCaller(
-    const Config* config,
+    std::shared_ptr<const Config> config,
     Config::MethodCallQuota quota,
     ClassIndexer* class_indexer,
-    ClassFilesCache* class_files_cache)
-    : config_(config),
+    ClassFilesCache* class_files_cache,
+    SharedCallTargetCache* shared_call_target_cache /* = nullptr */)
+    : config_(std::move(config)),
       quota_(quota),
       class_indexer_(class_indexer),
-      class_files_cache_(class_files_cache) {
+      class_files_cache_(class_files_cache),
+      shared_call_target_cache_(shared_call_target_cache) {
 }
 
 
@@ -46,10 +223,33 @@ SafeMethodCaller::~SafeMethodCaller() {
 }
 
 
+void SafeMethodCaller::Reset() {
+  DCHECK(current_interpreter_ == nullptr);
+
+  total_instructions_counter_ = 0;
+  total_method_load_counter_ = 0;
+  allocated_objects_counter_ = 0;
+  allocated_arrays_counter_ = 0;
+
+  if (!temporary_objects_.IsEmpty()) {
+    temporary_objects_.RemoveAll();
+  }
+}
+
+
 ErrorOr<JVariant> SafeMethodCaller::Invoke(
     const ClassMetadataReader::Method& metadata,
     const JVariant& source,
     std::vector<JVariant> arguments) {
+  return InvokeCached(nullptr, metadata, source, std::move(arguments));
+}
+
+
+ErrorOr<JVariant> SafeMethodCaller::InvokeCached(
+    CallTargetCache* call_target_cache,
+    const ClassMetadataReader::Method& metadata,
+    const JVariant& source,
+    std::vector<JVariant> arguments) {
   DCHECK(current_interpreter_ == nullptr)
       << "InvokeInternal should be used for recursive calls";
 
@@ -58,8 +258,12 @@ ErrorOr<JVariant> SafeMethodCaller::Invoke(
     return INTERNAL_ERROR_MESSAGE;
   }
 
-  MethodCallResult rc =
-      InvokeInternal(false, metadata, source_obj, std::move(arguments));
+  MethodCallResult rc = InvokeInternal(
+      false,
+      metadata,
+      source_obj,
+      std::move(arguments),
+      call_target_cache);
 
   switch (rc.result_type()) {
     case MethodCallResult::Type::Error:
@@ -80,8 +284,27 @@ MethodCallResult SafeMethodCaller::InvokeNested(
     bool nonvirtual,
     const ConstantPool::MethodRef& method,
     jobject source,
+    std::vector<JVariant> arguments,
+    CallTargetCache* call_target_cache) {
+  return InvokeInternal(
+      nonvirtual,
+      method.metadata.value(),
+      source,
+      arguments,
+      call_target_cache);
+}
+
+
+MethodCallResult SafeMethodCaller::InvokeImplicit(
+    const ClassMetadataReader::Method& metadata,
+    jobject source,
     std::vector<JVariant> arguments) {
-  return InvokeInternal(nonvirtual, method.metadata.value(), source, arguments);
+  return InvokeInternal(
+      false,
+      metadata,
+      source,
+      std::move(arguments),
+      nullptr);
 }
 
 
@@ -89,7 +312,8 @@ MethodCallResult SafeMethodCaller::InvokeInternal(
     bool nonvirtual,
     const ClassMetadataReader::Method& metadata,
     jobject source,
-    std::vector<JVariant> arguments) {
+    std::vector<JVariant> arguments,
+    CallTargetCache* call_target_cache) {
   if (!metadata.is_static() && (source == nullptr)) {
     return MethodCallResult::JavaException(
         jniproxy::NullPointerException()->NewObject()
@@ -103,7 +327,7 @@ MethodCallResult SafeMethodCaller::InvokeInternal(
   // 3. The class in which the method was defined (e.g. "java.util.HashMap"
   //    overloads "toString()", but some custom class might not).
   ErrorOr<SafeMethodCaller::CallTarget> call_target =
-      GetCallTarget(nonvirtual, metadata, source);
+      GetCallTarget(nonvirtual, metadata, source, call_target_cache);
   if (call_target.is_error()) {
     return MethodCallResult::Error(call_target.error_message());
   }
@@ -118,7 +342,9 @@ MethodCallResult SafeMethodCaller::InvokeInternal(
           metadata,
           source,
           std::move(arguments),
-          call_target.value());
+          call_target.value(),
+          (call_target_cache != nullptr) &&
+              call_target_cache->arguments_verified());
 
     case Config::Method::CallAction::Interpret:
       return InvokeInterpreter(
@@ -136,10 +362,12 @@ MethodCallResult SafeMethodCaller::InvokeInternal(
 ErrorOr<SafeMethodCaller::CallTarget> SafeMethodCaller::GetCallTarget(
     bool nonvirtual,
     const ClassMetadataReader::Method& metadata,
-    jobject source) {
+    jobject source,
+    CallTargetCache* call_target_cache) {
+  const bool is_virtual = !metadata.is_static() && !nonvirtual;
+
   JniLocalRef object_cls;
-  JniLocalRef method_cls;
-  if (metadata.is_static() || nonvirtual) {
+  if (!is_virtual) {
     std::shared_ptr<ClassIndexer::Type> type = class_indexer_->GetReference(
         metadata.class_signature.object_signature);
 
@@ -152,25 +380,68 @@ ErrorOr<SafeMethodCaller::CallTarget> SafeMethodCaller::GetCallTarget(
           { TypeNameFromSignature(metadata.class_signature) }
       };
     }
-
-    method_cls = JniNewLocalRef(object_cls.get());
   } else {
     object_cls = GetObjectClass(source);
     if (object_cls == nullptr) {
       return INTERNAL_ERROR_MESSAGE;
     }
+  }
+
+  // Everything below only depends on "object_cls".
+  if (call_target_cache != nullptr) {
+    CallTarget cached_call_target;
+    if (call_target_cache->Find(
+            object_cls.get(),
+            config_->version(),
+            &cached_call_target)) {
+      return std::move(cached_call_target);
+    }
+  }
 
-    jmethodID method_id = jni()->GetMethodID(
-        static_cast<jclass>(object_cls.get()),
-        metadata.name.c_str(),
-        metadata.signature.c_str());
+  if (shared_call_target_cache_ != nullptr) {
+    CallTarget cached_call_target;
+    if (shared_call_target_cache_->Find(
+            object_cls.get(),
+            metadata.is_static(),
+            metadata.name,
+            metadata.signature,
+            config_->version(),
+            &cached_call_target)) {
+      if (call_target_cache != nullptr) {
+        call_target_cache->Update(cached_call_target);
+      }
+
+      return std::move(cached_call_target);
+    }
+  }
+
+  // The method ID is needed to find the declaring class of virtual methods
+  // and to drop the shared cache entry when the method is unloaded.
+  jmethodID method_id = nullptr;
+  if (is_virtual || (shared_call_target_cache_ != nullptr)) {
+    if (metadata.is_static()) {
+      method_id = jni()->GetStaticMethodID(
+          static_cast<jclass>(object_cls.get()),
+          metadata.name.c_str(),
+          metadata.signature.c_str());
+    } else {
+      method_id = jni()->GetMethodID(
+          static_cast<jclass>(object_cls.get()),
+          metadata.name.c_str(),
+          metadata.signature.c_str());
+    }
     if (jni()->ExceptionCheck()) {
       return MethodCallResult::PendingJniException().format_exception();
     }
     if (method_id == nullptr) {
       return INTERNAL_ERROR_MESSAGE;
     }
+  }
 
+  JniLocalRef method_cls;
+  if (!is_virtual) {
+    method_cls = JniNewLocalRef(object_cls.get());
+  } else {
     method_cls = GetMethodDeclaringClass(method_id);
   }
 
@@ -183,13 +454,29 @@ ErrorOr<SafeMethodCaller::CallTarget> SafeMethodCaller::GetCallTarget(
       metadata.name,
       metadata.signature);
 
-  return CallTarget {
+  CallTarget call_target {
       std::move(method_cls),
       std::move(method_cls_signature),
       std::move(object_cls),
       std::move(object_cls_signature),
-      &method_config
+      &method_config,
+      config_->version()
   };
+
+  if (call_target_cache != nullptr) {
+    call_target_cache->Update(call_target);
+  }
+
+  if (shared_call_target_cache_ != nullptr) {
+    shared_call_target_cache_->Insert(
+        method_id,
+        metadata.is_static(),
+        metadata.name,
+        metadata.signature,
+        call_target);
+  }
+
+  return std::move(call_target);
 }
 
 
@@ -211,12 +498,44 @@ MethodCallResult SafeMethodCaller::MethodBlocked(
 }
 
 
+bool SafeMethodCaller::IsSideEffectFree(const Config::Method& method_config) {
+  return (method_config.action == Config::Method::CallAction::Allow) &&
+         (method_config.thunk == nullptr) &&
+         !method_config.require_temporary_object &&
+         !method_config.returns_temporary_object;
+}
+
+
 MethodCallResult SafeMethodCaller::InvokeJni(
     bool nonvirtual,
     const ClassMetadataReader::Method& metadata,
     jobject source,
     std::vector<JVariant> arguments,
-    const CallTarget& call_target) {
+    const CallTarget& call_target,
+    bool arguments_verified) {
+  // Fast path: neither the rule nor the arguments need checking, so the
+  // only thing left to do is the call itself.
+  if (arguments_verified &&
+      FLAGS_safe_caller_trust_compiled_call_sites &&
+      IsSideEffectFree(*call_target.method_config) &&
+      (metadata.is_static() || !nonvirtual)) {
+    if (call_target.method_config->intrinsic != nullptr) {
+      return call_target.method_config->intrinsic(this, source, arguments);
+    }
+
+    JniMethodCaller method_caller;
+    if (!method_caller.Bind(
+            static_cast<jclass>(call_target.object_cls.get()),
+            metadata)) {
+      return MethodCallResult::Error({
+          ClassNotLoaded,
+          { TypeNameFromJObjectSignature(call_target.object_cls_signature) }
+      });
+    }
+
+    return method_caller.Call(nonvirtual, source, arguments);
+  }
+
   if (call_target.method_config->require_temporary_object &&
       !IsTemporaryObject(source)) {
     return MethodBlocked(metadata, call_target);
@@ -231,8 +550,12 @@ MethodCallResult SafeMethodCaller::InvokeJni(
     }
   }
 
-  JMethodSignature method_signature;
-  if (!ParseJMethodSignature(metadata.signature, &method_signature)) {
+  std::shared_ptr<const JMethodSignature> method_signature =
+      metadata.parsed_signature;
+  if (method_signature == nullptr) {
+    method_signature = InternJMethodSignature(metadata.signature);
+  }
+  if (method_signature == nullptr) {
     LOG(ERROR) << "Failed to parse method signature, "
                   "class: " << metadata.class_signature.object_signature
                << ", name: " << metadata.name
@@ -249,11 +572,15 @@ MethodCallResult SafeMethodCaller::InvokeJni(
     return MethodCallResult::Error(INTERNAL_ERROR_MESSAGE);
   }
 
-  rc = CheckArguments(method_signature, arguments);
+  rc = CheckArguments(*method_signature, arguments);
   if (rc.result_type() != MethodCallResult::Type::Success) {
     return rc;
   }
 
+  if (call_target.method_config->intrinsic != nullptr) {
+    return call_target.method_config->intrinsic(this, source, arguments);
+  }
+
   // TODO(vlif): cache method callers.
   JniMethodCaller method_caller;
   if (!method_caller.Bind(
@@ -325,8 +652,36 @@ MethodCallResult SafeMethodCaller::InvokeInterpreter(
     });
   }
 
+  CountInterpretedCall(metadata);
+
+  // Methods with loops that ran out of quota before are likely to run out
+  // of quota again if they get less instructions this time. Rejecting the
+  // call upfront saves burning the whole remaining quota.
+  const int32 remaining_quota =
+      quota_.max_interpreter_instructions - total_instructions_counter_;
+  ClassFile::Method::InterpreterProfile* profile =
+      method->interpreter_profile();
+  const bool is_cyclic =
+      (profile != nullptr) &&
+      (FLAGS_safe_caller_doomed_call_retry_interval > 0) &&
+      (method->GetControlFlow() == ClassFile::ControlFlow::Cyclic);
+  if (is_cyclic) {
+    const int32 exhausted_quota = profile->exhausted_quota.load();
+    if ((exhausted_quota > 0) &&
+        (remaining_quota <= exhausted_quota) &&
+        ((profile->rejected_calls.fetch_add(1) + 1) %
+         FLAGS_safe_caller_doomed_call_retry_interval) != 0) {
+      if (FLAGS_safe_caller_interpreter_stats_log_interval > 0) {
+        ++g_interpreter_stats.quota_rejected;
+      }
+
+      return MethodCallResult::Error({ InterpreterQuotaExceeded });
+    }
+  }
+
   NanoJavaInterpreter interpreter(
       this,
+      &slot_pool_,
       method,
       current_interpreter_,
       source,
@@ -336,6 +691,14 @@ MethodCallResult SafeMethodCaller::InvokeInterpreter(
   const NanoJavaInterpreter* previous_interpreter = current_interpreter_;
   current_interpreter_ = &interpreter;
 
+  const bool measure =
+      (previous_interpreter == nullptr) &&
+      (FLAGS_safe_caller_interpreter_stats_log_interval > 0);
+  const int64 instructions_before = total_instructions_counter_;
+  const int64 allocated_objects_before = allocated_objects_counter_;
+  const int64 allocated_arrays_before = allocated_arrays_counter_;
+  Stopwatch stopwatch;
+
   // Execute the method. Method calls within the executed method will
   // recursively call this function.
   MethodCallResult rc = interpreter.Execute();
@@ -343,6 +706,30 @@ MethodCallResult SafeMethodCaller::InvokeInterpreter(
   // Restore the stack trace.
   current_interpreter_ = previous_interpreter;
 
+  if (measure) {
+    CountInterpreterRun(
+        total_instructions_counter_ - instructions_before,
+        stopwatch.GetElapsedNanos(),
+        allocated_objects_counter_ - allocated_objects_before,
+        allocated_arrays_counter_ - allocated_arrays_before,
+        (rc.result_type() == MethodCallResult::Type::Error) &&
+            (rc.error().format == InterpreterQuotaExceeded));
+  }
+
+  if (is_cyclic) {
+    if ((rc.result_type() == MethodCallResult::Type::Error) &&
+        (rc.error().format == InterpreterQuotaExceeded)) {
+      int32 exhausted_quota = profile->exhausted_quota.load();
+      while ((exhausted_quota < remaining_quota) &&
+             !profile->exhausted_quota.compare_exchange_weak(
+                 exhausted_quota,
+                 remaining_quota)) {
+      }
+    } else if (rc.result_type() != MethodCallResult::Type::Error) {
+      profile->exhausted_quota.store(0);
+    }
+  }
+
   return rc;
 }
 
@@ -350,6 +737,7 @@ MethodCallResult SafeMethodCaller::InvokeInterpreter(
 void SafeMethodCaller::NewObjectAllocated(jobject obj) {
   DCHECK(obj != nullptr);
   temporary_objects_.Insert(obj, {});
+  ++allocated_objects_counter_;
 }
 
 
@@ -368,6 +756,8 @@ SafeMethodCaller::IsNextInstructionAllowed() {
 
 std::unique_ptr<FormatMessageModel> SafeMethodCaller::IsNewArrayAllowed(
     int32 count) {
+  ++allocated_arrays_counter_;
+
   if (count > FLAGS_safe_caller_max_array_elements) {
     return std::unique_ptr<FormatMessageModel>(new FormatMessageModel {
         MethodNotSafeNewArrayTooLarge,
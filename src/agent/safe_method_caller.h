@@ -17,6 +17,7 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_SAFE_METHOD_CALLER_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_SAFE_METHOD_CALLER_H_
 
+#include "call_target_cache.h"
 #include "class_file.h"
 #include "class_files_cache.h"
 #include "class_indexer.h"
@@ -31,28 +32,43 @@
 #include "method_call_result.h"
 #include "model.h"
 #include "nanojava_interpreter.h"
+#include "shared_call_target_cache.h"
 
 namespace devtools {
 namespace cdbg {
 
 // Invokes methods either through JNI or with built-in NanoJava interpreter.
-// This class is not thread safe. It should be instantiated for a single
-// method call or for series of calls within the same expression.
+// This class is not thread safe. It should be used for a single method call
+// or for series of calls within the same expression and then either
+// destroyed or "Reset" (see "SafeMethodCallerPool").
 class SafeMethodCaller
     : public MethodCaller,
       public nanojava::NanoJavaInterpreter::Supervisor {
  public:
-  // "config" and "class_indexer" are not owned by this class and must outlive
+  // "config" is the configuration snapshot used for the lifetime of this
+  // instance, even if the debuglet configuration is replaced in the
+  // meantime. "class_indexer" is not owned by this class and must outlive
   // it. The configuration has a separate quota for expressions and pretty
   // printers, hence passing it explicitly, rather than getting from "config".
+  // "shared_call_target_cache" is optional and must outlive this class if
+  // specified.
   SafeMethodCaller(
-      const Config* config,
+      std::shared_ptr<const Config> config,
       Config::MethodCallQuota quota,
       ClassIndexer* class_indexer,
-      ClassFilesCache* class_files_cache);
+      ClassFilesCache* class_files_cache,
+      SharedCallTargetCache* shared_call_target_cache = nullptr);
 
   ~SafeMethodCaller() override;
 
+  // Gets the configuration snapshot used by this instance.
+  const Config* config() const { return config_.get(); }
+
+  // Prepares the instance for reuse by another expression: restarts the
+  // quota counters and releases the temporary objects. Must not be called
+  // while a method is being executed.
+  void Reset();
+
   // Gets the total number of instructions processed by the interpreter.
   int total_instructions_counter() const {
     return total_instructions_counter_;
@@ -74,13 +90,20 @@ class SafeMethodCaller
       const JVariant& source,
       std::vector<JVariant> arguments) override;
 
+  ErrorOr<JVariant> InvokeCached(
+      CallTargetCache* call_target_cache,
+      const ClassMetadataReader::Method& metadata,
+      const JVariant& source,
+      std::vector<JVariant> arguments) override;
+
   // Common code for the outer and nested method invocation. Also used by
-  // safe caller proxies.
+  // safe caller proxies. "call_target_cache" is optional and may be null.
   MethodCallResult InvokeInternal(
       bool nonvirtual,
       const ClassMetadataReader::Method& metadata,
       jobject source,
-      std::vector<JVariant> arguments);
+      std::vector<JVariant> arguments,
+      CallTargetCache* call_target_cache);
 
   //
   // Implementation of "NanoJavaInterpreter::Supervisor" interface.
@@ -92,6 +115,12 @@ class SafeMethodCaller
       bool nonvirtual,
       const ConstantPool::MethodRef& method,
       jobject source,
+      std::vector<JVariant> arguments,
+      CallTargetCache* call_target_cache) override;
+
+  MethodCallResult InvokeImplicit(
+      const ClassMetadataReader::Method& metadata,
+      jobject source,
       std::vector<JVariant> arguments) override;
 
   std::unique_ptr<FormatMessageModel> IsNextInstructionAllowed() override;
@@ -109,22 +138,7 @@ class SafeMethodCaller
 
  private:
   // Classes that play a role when calling a method.
-  struct CallTarget {
-    // Class that implemented the method to be executed.
-    JniLocalRef method_cls;
-
-    // Signature of "method_cls".
-    string method_cls_signature;
-
-    // The class returned by Java statement "obj.getClass()".
-    JniLocalRef object_cls;
-
-    // Signature of "object_cls".
-    string object_cls_signature;
-
-    // Policy of the method.
-    const Config::Method* method_config;
-  };
+  typedef MethodCallTarget CallTarget;
 
   // Checks if the interpreter is effectively disabled.
   bool IsNanoJavaInterpreterDisabled() const {
@@ -136,7 +150,8 @@ class SafeMethodCaller
   ErrorOr<CallTarget> GetCallTarget(
       bool nonvirtual,
       const ClassMetadataReader::Method& metadata,
-      jobject source);
+      jobject source,
+      CallTargetCache* call_target_cache);
 
   // Format call stack of the interpreted methods.
   string CurrentCallStack() const;
@@ -165,13 +180,21 @@ class SafeMethodCaller
       const ClassMetadataReader::Method& metadata,
       const CallTarget& call_target) const;
 
-  // Calls the target method with JNI.
+  // Checks whether calling the method through JNI needs nothing beyond the
+  // call itself: the rule allows the call and has no thunk and no temporary
+  // object constraints.
+  static bool IsSideEffectFree(const Config::Method& method_config);
+
+  // Calls the target method with JNI. "arguments_verified" indicates that
+  // the call site proved at compile time that "arguments" match the method
+  // signature.
   MethodCallResult InvokeJni(
       bool nonvirtual,
       const ClassMetadataReader::Method& metadata,
       jobject source,
       std::vector<JVariant> arguments,
-      const CallTarget& call_target);
+      const CallTarget& call_target,
+      bool arguments_verified);
 
   // Calls the target method with NanoJava interpreter.
   MethodCallResult InvokeInterpreter(
@@ -185,7 +208,7 @@ class SafeMethodCaller
   struct Empty { };
 
   // Policy for method calls.
-  const Config* const config_;
+  const std::shared_ptr<const Config> config_;
 
   // Quota settings for method calls invoked by this instance
   // of "SafeMethodCaller".
@@ -197,11 +220,18 @@ class SafeMethodCaller
   // Global cache of loaded class files for safe caller.
   ClassFilesCache* const class_files_cache_;
 
+  // Global cache of resolved call targets (or nullptr if not used).
+  SharedCallTargetCache* const shared_call_target_cache_;
+
   // Currently interpreted method. The interpreter keeps a reference to its
   // parent. This way we can reconstruct the interpreter call stack for
   // debugging purposes.
   const nanojava::NanoJavaInterpreter* current_interpreter_ = nullptr;
 
+  // Storage for operand stacks and local variables of the interpreted
+  // methods. Reused across all the nested calls made through this instance.
+  nanojava::NanoJavaSlotPool slot_pool_;
+
   // Total number of instructions processed by the interpreter.
   // Does not count JNI calls.
   int total_instructions_counter_ = 0;
@@ -210,6 +240,11 @@ class SafeMethodCaller
   // Methods fetched from cache are not counted.
   int total_method_load_counter_ = 0;
 
+  // Number of objects and arrays allocated by the interpreted code. Only
+  // used for the interpreter throughput statistics.
+  int allocated_objects_counter_ = 0;
+  int allocated_arrays_counter_ = 0;
+
   // Set of temporary objects created during expression evaluation. We do not
   // consider these objects as part of application state. Therefore we allow
   // methods invoked from expressions to change instance fields of such objects.
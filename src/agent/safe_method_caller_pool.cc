@@ -0,0 +1,113 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "safe_method_caller_pool.h"
+
+#include "safe_method_caller.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Maximum number of idle callers kept per quota type. This roughly matches
+// the number of threads hitting breakpoints at the same time.
+constexpr int kMaxIdleSafeMethodCallers = 64;
+
+
+SafeMethodCallerPool::SafeMethodCallerPool(
+    const ConfigStore* config,
+    ClassIndexer* class_indexer,
+    ClassFilesCache* class_files_cache,
+    SharedCallTargetCache* shared_call_target_cache)
+    : config_(config),
+      class_indexer_(class_indexer),
+      class_files_cache_(class_files_cache),
+      shared_call_target_cache_(shared_call_target_cache) {
+}
+
+
+SafeMethodCallerPool::~SafeMethodCallerPool() {
+}
+
+
+MethodCallerPtr SafeMethodCallerPool::Acquire(
+    Config::MethodCallQuotaType type) {
+  DCHECK((type >= 0) && (type < Config::MAX_TYPES));
+
+  std::shared_ptr<const Config> config = config_->Get();
+
+  std::unique_ptr<SafeMethodCaller> caller;
+  std::vector<std::unique_ptr<SafeMethodCaller>> stale;
+
+  {
+    MutexLock lock(&mu_);
+
+    std::vector<std::unique_ptr<SafeMethodCaller>>& idle = idle_[type];
+    if (!idle.empty() && (idle.back()->config() != config.get())) {
+      // The configuration has been replaced. All the idle callers of this
+      // type were created before that.
+      stale.swap(idle);
+    }
+
+    if (!idle.empty()) {
+      caller = std::move(idle.back());
+      idle.pop_back();
+    }
+  }
+
+  // "stale" callers (and possibly the last reference to the old
+  // configuration) are released here, outside of the lock.
+  stale.clear();
+
+  if (caller == nullptr) {
+    caller.reset(new SafeMethodCaller(
+        config,
+        config->GetQuota(type),
+        class_indexer_,
+        class_files_cache_,
+        shared_call_target_cache_));
+  }
+
+  return MethodCallerPtr(
+      caller.release(),
+      [this, type](MethodCaller* method_caller) {
+        Release(type, static_cast<SafeMethodCaller*>(method_caller));
+      });
+}
+
+
+void SafeMethodCallerPool::Release(
+    Config::MethodCallQuotaType type,
+    SafeMethodCaller* caller) {
+  std::unique_ptr<SafeMethodCaller> auto_caller(caller);
+
+  // Callers of a replaced configuration are not reused.
+  if (auto_caller->config() != config_->Get().get()) {
+    return;
+  }
+
+  // Release the temporary objects before taking the lock.
+  auto_caller->Reset();
+
+  MutexLock lock(&mu_);
+
+  std::vector<std::unique_ptr<SafeMethodCaller>>& idle = idle_[type];
+  if (idle.size() < kMaxIdleSafeMethodCallers) {
+    idle.push_back(std::move(auto_caller));
+  }
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,84 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_SAFE_METHOD_CALLER_POOL_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_SAFE_METHOD_CALLER_POOL_H_
+
+#include <memory>
+#include <vector>
+#include "common.h"
+#include "config.h"
+#include "config_store.h"
+#include "method_caller.h"
+#include "mutex.h"
+
+namespace devtools {
+namespace cdbg {
+
+class ClassFilesCache;
+class ClassIndexer;
+class SafeMethodCaller;
+class SharedCallTargetCache;
+
+// Keeps idle instances of "SafeMethodCaller" (one list per quota type), so
+// that breakpoint hits don't construct and destroy a new caller with its
+// interpreter storage each time. Released callers are "Reset" and put back.
+// Each caller keeps the configuration snapshot it was created with, so idle
+// callers created with a configuration that has been replaced since are
+// discarded rather than reused.
+//
+// This class is thread safe. The callers it hands out are not.
+class SafeMethodCallerPool {
+ public:
+  // All pointer arguments are not owned by this class and must outlive it.
+  // "shared_call_target_cache" is optional.
+  SafeMethodCallerPool(
+      const ConfigStore* config,
+      ClassIndexer* class_indexer,
+      ClassFilesCache* class_files_cache,
+      SharedCallTargetCache* shared_call_target_cache);
+
+  ~SafeMethodCallerPool();
+
+  // Gets an idle caller with the quota of "type" or creates a new one. The
+  // caller returns to the pool when the pointer is released. The pointer
+  // must be released before this object is destroyed.
+  MethodCallerPtr Acquire(Config::MethodCallQuotaType type);
+
+ private:
+  // Puts "caller" back to the idle list of "type" or deletes it if the
+  // list is full.
+  void Release(Config::MethodCallQuotaType type, SafeMethodCaller* caller);
+
+ private:
+  const ConfigStore* const config_;
+  ClassIndexer* const class_indexer_;
+  ClassFilesCache* const class_files_cache_;
+  SharedCallTargetCache* const shared_call_target_cache_;
+
+  // Locks "idle_".
+  Mutex mu_;
+
+  // Callers ready for reuse per quota type.
+  std::vector<std::unique_ptr<SafeMethodCaller>> idle_[Config::MAX_TYPES];
+
+  DISALLOW_COPY_AND_ASSIGN(SafeMethodCallerPool);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_SAFE_METHOD_CALLER_POOL_H_
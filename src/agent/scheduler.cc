@@ -19,7 +19,7 @@
 namespace devtools {
 namespace cdbg {
 
-static Scheduler<>::Id NullId __attribute__((unused)) =  { 0, -1 };
+static Scheduler<>::Id NullId __attribute__((unused)) =  { -1, 0 };
 
 }  // namespace cdbg
 }  // namespace devtools
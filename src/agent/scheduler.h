@@ -17,9 +17,11 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_SCHEDULER_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_SCHEDULER_H_
 
+#include <string.h>
 #include <functional>
-#include <map>
+#include <limits>
 #include <memory>
+#include <vector>
 #include "common.h"
 #include "mutex.h"
 
@@ -27,37 +29,47 @@ namespace devtools {
 namespace cdbg {
 
 // Schedules callbacks to be invoked some time in the future. The precision
-// of timing depends on the frequency that "Process" method is called.
+// of timing depends on when "Process" method is called. The worker sleeps
+// until "NextTime" and the scheduler wakes it up through the function set
+// with "SetWakeUp" if an earlier callback is scheduled in the meantime.
+//
+// Scheduled callbacks are kept in a hierarchical timing wheel with the
+// resolution of one second: "kWheelSlots" slots of one second, then slots of
+// "kWheelSlots" seconds and so on. "Schedule" and "Cancel" take constant
+// time. "Process" moves the callbacks to the finer levels as their time
+// approaches. The callbacks are stored in a pool of nodes reused across
+// schedules, so neither "Schedule" nor "Cancel" allocates memory once the
+// pool has grown to the number of pending callbacks.
+//
 // This class is thread safe.
 template <class... Args>
 class Scheduler {
  public:
-  // Type for callback to be invoked.
-  typedef std::function<void(Args...)> Callback;
-
-  // Primary data structure used by this class. Maps absolute time when the
-  // callback is scheduled to be invoked to the callback functor. Usage of
-  // "multimap" ensures we can schedule multiple callbacks for the same time
-  // (either same callback or different callback).
-  typedef typename std::multimap<
-      time_t,
-      std::pair<int, Callback>> Events;
-
-  // Cancellation token type. The key is timestamp (for efficient lookup in
-  // "events_" and unique schedule ID.
-  typedef std::pair<time_t, int> Id;
+  // Cancellation token type. Consists of the index of the node holding the
+  // scheduled callback and the generation of that node (incremented every
+  // time the node is reused).
+  typedef std::pair<int, uint32> Id;
 
   // Invalid value of scheduled item "Id". Useful for initialization value of
   // an "Id" variable.
   static const Id NullId;
 
+  // Returned by "NextTime" if no callbacks are scheduled.
+  static constexpr time_t kNever = std::numeric_limits<time_t>::max();
+
   // Default clock function to be used everywhere except of unit tests.
   static time_t DefaultClock() {
     return time(nullptr);
   }
 
   explicit Scheduler(std::function<time_t()> clock)
-      : clock_(clock) {
+      : clock_(clock),
+        current_time_(clock()) {
+    for (int level = 0; level < kWheelLevels; ++level) {
+      for (int slot = 0; slot < kWheelSlots; ++slot) {
+        wheel_[level][slot] = kNullNode;
+      }
+    }
   }
 
   ~Scheduler() {
@@ -67,6 +79,34 @@ class Scheduler {
   // constructor.
   time_t CurrentTime() const { return clock_(); }
 
+  // Sets the function called (without any locks held) when a callback is
+  // scheduled earlier than the time last returned by "NextTime". The
+  // function is expected to wake up the thread calling "Process". Must be
+  // called before any callbacks are scheduled.
+  void SetWakeUp(std::function<void()> wake_up) {
+    wake_up_ = std::move(wake_up);
+  }
+
+  // Gets the time of the earliest scheduled callback or "kNever" if there
+  // are none. The time may be in the past if "Process" is overdue.
+  time_t NextTime() {
+    MutexLock lock(&mu_);
+
+    // The nodes in the free list are not linked to any list. Scanning the
+    // pool is simpler than walking the wheel and it's only done once per
+    // sleep of the worker.
+    time_t next_time = kNever;
+    for (const Node& node : nodes_) {
+      if ((node.list != nullptr) && (node.time < next_time)) {
+        next_time = node.time;
+      }
+    }
+
+    wake_up_time_ = next_time;
+
+    return next_time;
+  }
+
   // Schedules the callback to be executed at the specified time. The scheduler
   // will hold a weak reference to the target object. The callback is not
   // invoked if the last reference to the object is released by the time
@@ -76,27 +116,38 @@ class Scheduler {
       time_t time,
       std::weak_ptr<T> target,
       void (T::*fn)(Args...)) {
-    Callback callback = [target, fn](Args... args) {
-      auto locked_target = target.lock();
-      if (locked_target == nullptr) {
-        // The target object has already expired.
-        return;
-      }
+    static_assert(
+        sizeof(fn) <= kMaxMethodSize,
+        "Member function pointer doesn't fit the scheduler node");
 
-      T& t = *locked_target;
-      (t.*fn)(args...);
-    };
+    Id id;
+    bool is_wake_up_needed = false;
 
-    MutexLock lock(&mu_);
+    {
+      MutexLock lock(&mu_);
+
+      const int index = AllocateNode();
+      Node& node = nodes_[index];
+      node.time = time;
+      node.target = std::move(target);
+      node.invoke = &InvokeMethod<T>;
+      memcpy(node.method, &fn, sizeof(fn));
+
+      InsertNode(index);
 
-    int cancellation_id = ++last_id_;
+      id = { index, node.generation };
 
-    events_.insert(
-        std::make_pair(
-            time,
-            std::make_pair(cancellation_id, std::move(callback))));
+      if (time < wake_up_time_) {
+        wake_up_time_ = time;
+        is_wake_up_needed = true;
+      }
+    }
 
-    return { time, cancellation_id };
+    if (is_wake_up_needed && wake_up_) {
+      wake_up_();
+    }
+
+    return id;
   }
 
   // Cancels the scheduled callback or does nothing if the specified item
@@ -105,60 +156,310 @@ class Scheduler {
   bool Cancel(Id id) {
     MutexLock lock(&mu_);
 
-    auto it = events_.lower_bound(id.first);
-    while ((it != events_.end()) && (it->first == id.first)) {
-      if (it->second.first == id.second) {
-        events_.erase(it);
-        return true;
-      }
-
-      ++it;
+    if ((id.first < 0) ||
+        (id.first >= static_cast<int>(nodes_.size())) ||
+        (nodes_[id.first].generation != id.second) ||
+        (nodes_[id.first].list == nullptr)) {
+      return false;
     }
 
-    return false;
+    UnlinkNode(id.first);
+    FreeNode(id.first);
+
+    return true;
   }
 
   // Invokes all the callbacks scheduled from up to the current time. Completed
   // callbacks are removed from the list.
   void Process(Args... args) {
     // Gather all the callbacks we need to invoke first.
-    std::vector<Callback> current_callbacks;
+    std::vector<DueCallback> current_callbacks;
     const time_t time = CurrentTime();
 
     {
       MutexLock lock(&mu_);
-      for (auto it = events_.begin(); it != events_.end(); ) {
-        // "events_" is sorted by the scheduled time. Once we saw the first item
-        // scheduled in the future, we can stop looking any further.
-        if (it->first > time) {
-          break;
-        }
 
-        current_callbacks.push_back(std::move(it->second.second));
-        it = events_.erase(it);
+      int due = kNullNode;
+      AdvanceWheel(time, &due);
+
+      while (due != kNullNode) {
+        Node& node = nodes_[due];
+        DueCallback callback;
+        callback.target = std::move(node.target);
+        callback.invoke = node.invoke;
+        memcpy(callback.method, node.method, kMaxMethodSize);
+        current_callbacks.push_back(std::move(callback));
+
+        const int next = node.next;
+        UnlinkNode(due);
+        FreeNode(due);
+        due = next;
       }
     }
 
     // Now invoke these callbacks without lock. This allows the callback to
     // call Cancel. Each callback holds a weak reference. Therefore if an
     // object has just been deleted, the callback will do nothing.
-    for (auto& callback : current_callbacks) {
-      callback(args...);
+    for (const DueCallback& callback : current_callbacks) {
+      std::shared_ptr<void> locked_target = callback.target.lock();
+      if (locked_target == nullptr) {
+        // The target object has already expired.
+        continue;
+      }
+
+      callback.invoke(locked_target.get(), callback.method, args...);
     }
   }
 
  private:
-  // Global counter to assign unique cancellation IDs.
-  int last_id_ { 0 };
+  // Number of slots in each level of the timing wheel. Must be a power of 2.
+  static constexpr int kWheelSlots = 256;
+
+  // Number of bits of the time indexing a slot in a single level.
+  static constexpr int kWheelSlotBits = 8;
+
+  // Number of levels in the timing wheel. With 256 slots per level, the
+  // third level spans 194 days. Callbacks further in the future are put into
+  // the last slot of the third level and moved back when they get there.
+  static constexpr int kWheelLevels = 3;
+
+  // Maximum size of a member function pointer.
+  static constexpr int kMaxMethodSize = 2 * sizeof(void*);
+
+  // Invalid node index.
+  static constexpr int kNullNode = -1;
+
+  // Calls the member function stored in "method" on "target".
+  typedef void (*InvokeFn)(void* target, const char* method, Args... args);
+
+  // Scheduled callback. Nodes are linked into a doubly linked list of the
+  // wheel slot (or the free list) by indexes into "nodes_".
+  struct Node {
+    // Time when the callback is scheduled to be invoked.
+    time_t time { 0 };
+
+    // Incremented every time the node is freed to invalidate stale "Id".
+    uint32 generation { 1 };
+
+    // Neighbours in the list.
+    int prev { kNullNode };
+    int next { kNullNode };
+
+    // Head of the list containing this node or nullptr if the node is free.
+    int* list { nullptr };
+
+    // Target object of the callback.
+    std::weak_ptr<void> target;
+
+    // Invokes "method" on the target.
+    InvokeFn invoke { nullptr };
+
+    // Member function pointer (copied byte by byte).
+    char method[kMaxMethodSize];
+  };
+
+  // Callback taken out of "nodes_" to be invoked without a lock.
+  struct DueCallback {
+    std::weak_ptr<void> target;
+    InvokeFn invoke;
+    char method[kMaxMethodSize];
+  };
+
+  template <typename T>
+  static void InvokeMethod(void* target, const char* method, Args... args) {
+    void (T::*fn)(Args...);
+    memcpy(&fn, method, sizeof(fn));
+    (static_cast<T*>(target)->*fn)(args...);
+  }
+
+  // Gets a free node (growing the pool if necessary). Must be called with
+  // "mu_" locked.
+  int AllocateNode() {
+    if (free_list_ == kNullNode) {
+      nodes_.emplace_back();
+      return nodes_.size() - 1;
+    }
+
+    const int index = free_list_;
+    free_list_ = nodes_[index].next;
+    return index;
+  }
+
+  // Returns unlinked node to the free list. Must be called with "mu_" locked.
+  void FreeNode(int index) {
+    Node& node = nodes_[index];
+    node.target.reset();
+    node.invoke = nullptr;
+    ++node.generation;
+    if (node.generation == 0) {
+      node.generation = 1;  // Zero is reserved for "NullId".
+    }
+
+    node.prev = kNullNode;
+    node.next = free_list_;
+    free_list_ = index;
+  }
+
+  // Adds node to the beginning of a list. Must be called with "mu_" locked.
+  void LinkNode(int index, int* list) {
+    Node& node = nodes_[index];
+    node.list = list;
+    node.prev = kNullNode;
+    node.next = *list;
+    if (*list != kNullNode) {
+      nodes_[*list].prev = index;
+    }
+
+    *list = index;
+  }
+
+  // Removes node from its list. Must be called with "mu_" locked.
+  void UnlinkNode(int index) {
+    Node& node = nodes_[index];
+    if (node.prev != kNullNode) {
+      nodes_[node.prev].next = node.next;
+    } else {
+      *node.list = node.next;
+    }
+
+    if (node.next != kNullNode) {
+      nodes_[node.next].prev = node.prev;
+    }
+
+    node.list = nullptr;
+    node.prev = kNullNode;
+    node.next = kNullNode;
+  }
+
+  // Puts the node into the wheel slot of its time. Must be called with "mu_"
+  // locked.
+  void InsertNode(int index) {
+    const time_t time = nodes_[index].time;
+    if (time < current_time_) {
+      LinkNode(index, &overdue_);
+      return;
+    }
+
+    // The slots of each level are indexed by the time shifted right. The
+    // slot of the current time has already been cascaded to the finer level,
+    // so a level is only used if its slot is less than a full turn ahead.
+    for (int level = 0; level < kWheelLevels; ++level) {
+      const int shift = level * kWheelSlotBits;
+      if ((time >> shift) - (current_time_ >> shift) < kWheelSlots) {
+        LinkNode(
+            index,
+            &wheel_[level][(time >> shift) & (kWheelSlots - 1)]);
+        return;
+      }
+    }
+
+    // Too far in the future. Park it in the last slot of the last level.
+    const int shift = (kWheelLevels - 1) * kWheelSlotBits;
+    const time_t parked_time =
+        current_time_ + (static_cast<time_t>(kWheelSlots - 1) << shift);
+    LinkNode(
+        index,
+        &wheel_[kWheelLevels - 1][(parked_time >> shift) & (kWheelSlots - 1)]);
+  }
+
+  // Reinserts all the nodes of a slot. Returns the slot index in its level.
+  // Must be called with "mu_" locked.
+  int Cascade(int level) {
+    const int slot =
+        (current_time_ >> (level * kWheelSlotBits)) & (kWheelSlots - 1);
+
+    int index = wheel_[level][slot];
+    wheel_[level][slot] = kNullNode;
+    while (index != kNullNode) {
+      const int next = nodes_[index].next;
+      nodes_[index].list = nullptr;
+      nodes_[index].prev = kNullNode;
+      nodes_[index].next = kNullNode;
+      InsertNode(index);
+      index = next;
+    }
 
+    return slot;
+  }
+
+  // Moves all the nodes scheduled up to "time" (inclusive) to the "due"
+  // list. Must be called with "mu_" locked.
+  void AdvanceWheel(time_t time, int* due) {
+    // If the clock jumped far ahead (or "Process" wasn't called for a long
+    // time), rebuild the wheel rather than stepping through every second.
+    const time_t max_steps = static_cast<time_t>(kWheelSlots) * kWheelSlots;
+    if (time - current_time_ > max_steps) {
+      std::vector<int> pending;
+      for (int level = 0; level < kWheelLevels; ++level) {
+        for (int slot = 0; slot < kWheelSlots; ++slot) {
+          while (wheel_[level][slot] != kNullNode) {
+            const int index = wheel_[level][slot];
+            UnlinkNode(index);
+            pending.push_back(index);
+          }
+        }
+      }
+
+      current_time_ = time + 1;
+      for (int index : pending) {
+        InsertNode(index);
+      }
+    }
+
+    while (current_time_ <= time) {
+      // Move the callbacks of the next coarser level down when the finer
+      // level wraps around.
+      if ((current_time_ & (kWheelSlots - 1)) == 0) {
+        for (int level = 1; level < kWheelLevels; ++level) {
+          if (Cascade(level) != 0) {
+            break;
+          }
+        }
+      }
+
+      int* slot = &wheel_[0][current_time_ & (kWheelSlots - 1)];
+      while (*slot != kNullNode) {
+        const int index = *slot;
+        UnlinkNode(index);
+        LinkNode(index, &overdue_);
+      }
+
+      ++current_time_;
+    }
+
+    *due = overdue_;
+  }
+
+ private:
   // Clock function. Used to override in unit tests.
   const std::function<time_t()> clock_;
 
-  // Locks access to "handlers_" and "last_id_" list in this class.
+  // Wakes up the thread calling "Process" (may be null).
+  std::function<void()> wake_up_;
+
+  // Time until which the thread calling "Process" sleeps (as last returned
+  // by "NextTime").
+  time_t wake_up_time_ { kNever };
+
+  // Locks access to the timing wheel and the nodes.
   mutable Mutex mu_;
 
-  // List of scheduled items.
-  Events events_;
+  // Next second of the timing wheel to process. All the callbacks scheduled
+  // before this time are in "overdue_".
+  time_t current_time_;
+
+  // Heads of the lists of nodes in each slot of each level of the wheel.
+  int wheel_[kWheelLevels][kWheelSlots];
+
+  // Head of the list of nodes due to be invoked.
+  int overdue_ { kNullNode };
+
+  // Pool of nodes. "Node::list" pointers refer to members of this object, so
+  // the pool can be reallocated freely.
+  std::vector<Node> nodes_;
+
+  // Head of the list of free nodes in "nodes_".
+  int free_list_ { kNullNode };
 
   DISALLOW_COPY_AND_ASSIGN(Scheduler);
 };
@@ -167,6 +468,9 @@ class Scheduler {
 template <class... Args>
 const typename Scheduler<Args...>::Id Scheduler<Args...>::NullId;
 
+template <class... Args>
+constexpr time_t Scheduler<Args...>::kNever;
+
 }  // namespace cdbg
 }  // namespace devtools
 
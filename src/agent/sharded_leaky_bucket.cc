@@ -0,0 +1,76 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sharded_leaky_bucket.h"
+
+#include <sched.h>
+#include <algorithm>
+
+namespace devtools {
+namespace cdbg {
+
+ShardedLeakyBucket::ShardedLeakyBucket(
+    int64 capacity,
+    int64 fill_rate,
+    int shard_count,
+    int64 chunk_size)
+    : global_(capacity, fill_rate),
+      shard_count_(std::max(1, shard_count)),
+      chunk_size_(std::max<int64>(0, chunk_size)),
+      shards_(new Shard[shard_count_]) {
+}
+
+
+ShardedLeakyBucket::Shard* ShardedLeakyBucket::GetShard() {
+  int cpu = sched_getcpu();
+  if (cpu < 0) {
+    cpu = 0;  // Not supported, all threads share the same shard.
+  }
+
+  return &shards_[cpu % shard_count_];
+}
+
+
+bool ShardedLeakyBucket::RequestTokensSlow(
+    Shard* shard,
+    int64 requested_tokens) {
+  // Return the tokens that were taken on the fast path. Other threads on
+  // this CPU might have failed in the meantime because of the temporarily
+  // negative count, which is fine.
+  shard->tokens += requested_tokens;
+
+  // Take the requested tokens together with the next chunk for the shard.
+  const int64 chunk_size = chunk_size_.load(std::memory_order_relaxed);
+  if (global_.RequestTokens(requested_tokens + chunk_size)) {
+    shard->tokens += chunk_size;
+    return true;
+  }
+
+  // Fall back to taking just the requested tokens.
+  return global_.RequestTokens(requested_tokens);
+}
+
+
+void ShardedLeakyBucket::SetLimits(
+    int64 capacity,
+    int64 fill_rate,
+    int64 chunk_size) {
+  global_.SetLimits(capacity, fill_rate);
+  chunk_size_.store(std::max<int64>(0, chunk_size), std::memory_order_relaxed);
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,114 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_SHARDED_LEAKY_BUCKET_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_SHARDED_LEAKY_BUCKET_H_
+
+#include <atomic>
+#include <memory>
+#include "common.h"
+#include "leaky_bucket.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Leaky bucket for limits shared by all the application threads. A single
+// "LeakyBucket" keeps its token count in one atomic variable, so the cache
+// line bounces between all the CPUs requesting tokens. "ShardedLeakyBucket"
+// keeps a small cache of tokens per CPU and only goes to the global
+// "LeakyBucket" when the local cache runs out. Tokens are borrowed from the
+// global bucket in chunks, so the global limit still holds: a shard only
+// hands out the tokens it already took from the global bucket. The tokens
+// cached in shards (less than "chunk_size" per shard) are not available to
+// other CPUs, which makes the limit slightly stricter than that of the
+// global bucket alone.
+//
+// This class is thread safe.
+class ShardedLeakyBucket {
+ public:
+  // "capacity" and "fill_rate" are the parameters of the global bucket (see
+  // "LeakyBucket"). "shard_count" is the number of token caches (typically
+  // the number of CPUs). Each cache borrows "chunk_size" tokens from the
+  // global bucket at a time. If "chunk_size" is 0, all requests go straight
+  // to the global bucket.
+  ShardedLeakyBucket(
+      int64 capacity,
+      int64 fill_rate,
+      int shard_count,
+      int64 chunk_size);
+
+  // Requests tokens from the bucket. Returns false if not enough tokens are
+  // available. No tokens are issued in this case.
+  inline bool RequestTokens(int64 requested_tokens);
+
+  // Changes the parameters of the global bucket and the chunk size. Tokens
+  // already cached in shards stay there until used.
+  void SetLimits(int64 capacity, int64 fill_rate, int64 chunk_size);
+
+  // Gets the number of tokens in the global bucket. Tokens cached in shards
+  // are not included. Only used for diagnostics.
+  int64 available_tokens() const { return global_.available_tokens(); }
+
+ private:
+  // Tokens cached for a single CPU. Shards are padded to avoid false sharing
+  // of a cache line between two CPUs.
+  struct Shard {
+    std::atomic<int64> tokens { 0 };
+    char padding[64 - sizeof(std::atomic<int64>)];
+  };
+
+  // Gets the shard of the current CPU.
+  Shard* GetShard();
+
+  // Called when the shard doesn't have enough tokens. Returns the tokens
+  // taken on the fast path and borrows from the global bucket.
+  bool RequestTokensSlow(Shard* shard, int64 requested_tokens);
+
+ private:
+  // Global bucket enforcing the limit.
+  LeakyBucket global_;
+
+  // Number of entries in "shards_".
+  const int shard_count_;
+
+  // Number of tokens borrowed by a shard from the global bucket at a time.
+  std::atomic<int64> chunk_size_;
+
+  // Per CPU token caches.
+  std::unique_ptr<Shard[]> shards_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShardedLeakyBucket);
+};
+
+// Inline fast-path.
+inline bool ShardedLeakyBucket::RequestTokens(int64 requested_tokens) {
+  if (chunk_size_.load(std::memory_order_relaxed) == 0) {
+    return global_.RequestTokens(requested_tokens);
+  }
+
+  Shard* shard = GetShard();
+  if (shard->tokens.fetch_sub(requested_tokens) >= requested_tokens) {
+    // The shard had at least as much as we needed.
+    return true;
+  }
+
+  return RequestTokensSlow(shard, requested_tokens);
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_SHARDED_LEAKY_BUCKET_H_
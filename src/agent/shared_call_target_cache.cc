@@ -0,0 +1,198 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shared_call_target_cache.h"
+
+#include <functional>
+#include "method_unload_filter.h"
+
+namespace devtools {
+namespace cdbg {
+
+SharedCallTargetCache::SharedCallTargetCache(int max_size)
+    : max_size_(max_size) {
+}
+
+
+SharedCallTargetCache::~SharedCallTargetCache() {
+  for (const auto& method_keys : method_keys_) {
+    MethodUnloadFilter::Remove(method_keys.first);
+  }
+}
+
+
+bool SharedCallTargetCache::Find(
+    jobject object_cls,
+    bool is_static,
+    const string& name,
+    const string& signature,
+    int64 config_version,
+    MethodCallTarget* target) {
+  const size_t key = GetNameKey(is_static, name, signature);
+
+  std::vector<JniGlobalRef> retired_refs;
+  bool found = false;
+
+  {
+    MutexLock lock(&mu_);
+
+    retired_refs = TakeRetiredRefs();
+
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      for (const Entry& entry : it->second) {
+        if ((entry.is_static == is_static) &&
+            (entry.name == name) &&
+            (entry.signature == signature) &&
+            (entry.config_version == config_version) &&
+            jni()->IsSameObject(entry.object_cls.get(), object_cls)) {
+          target->method_cls = JniNewLocalRef(entry.method_cls.get());
+          target->method_cls_signature = entry.method_cls_signature;
+          target->object_cls = JniNewLocalRef(entry.object_cls.get());
+          target->object_cls_signature = entry.object_cls_signature;
+          target->method_config = entry.method_config;
+          target->config_version = entry.config_version;
+          found = true;
+          break;
+        }
+      }
+    }
+  }
+
+  // "retired_refs" released here (outside of the lock).
+  return found;
+}
+
+
+void SharedCallTargetCache::Insert(
+    jmethodID method,
+    bool is_static,
+    const string& name,
+    const string& signature,
+    const MethodCallTarget& target) {
+  if (max_size_ <= 0) {
+    return;
+  }
+
+  const size_t key = GetNameKey(is_static, name, signature);
+
+  Entry entry {
+    method,
+    is_static,
+    name,
+    signature,
+    JniNewGlobalRef(target.method_cls.get()),
+    target.method_cls_signature,
+    JniNewGlobalRef(target.object_cls.get()),
+    target.object_cls_signature,
+    target.method_config,
+    target.config_version
+  };
+
+  std::vector<JniGlobalRef> retired_refs;
+
+  {
+    MutexLock lock(&mu_);
+
+    if (size_ >= max_size_) {
+      for (const auto& method_keys : method_keys_) {
+        MethodUnloadFilter::Remove(method_keys.first);
+      }
+
+      for (auto& key_entries : entries_) {
+        for (Entry& existing_entry : key_entries.second) {
+          RetireEntry(&existing_entry);
+        }
+      }
+
+      entries_.clear();
+      method_keys_.clear();
+      size_ = 0;
+    }
+
+    retired_refs = TakeRetiredRefs();
+
+    std::vector<size_t>& keys = method_keys_[method];
+    if (keys.empty()) {
+      MethodUnloadFilter::Add(method);
+    }
+
+    keys.push_back(key);
+    entries_[key].push_back(std::move(entry));
+    ++size_;
+  }
+}
+
+
+void SharedCallTargetCache::JvmtiOnCompiledMethodUnload(jmethodID method) {
+  MutexLock lock(&mu_);
+
+  auto method_it = method_keys_.find(method);
+  if (method_it == method_keys_.end()) {
+    return;
+  }
+
+  for (size_t key : method_it->second) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      continue;  // Already removed through a duplicate key.
+    }
+
+    std::vector<Entry>& key_entries = it->second;
+    for (auto entry = key_entries.begin(); entry != key_entries.end(); ) {
+      if (entry->method == method) {
+        RetireEntry(&*entry);
+        entry = key_entries.erase(entry);
+        --size_;
+      } else {
+        ++entry;
+      }
+    }
+
+    if (key_entries.empty()) {
+      entries_.erase(it);
+    }
+  }
+
+  method_keys_.erase(method_it);
+  MethodUnloadFilter::Remove(method);
+}
+
+
+size_t SharedCallTargetCache::GetNameKey(
+    bool is_static,
+    const string& name,
+    const string& signature) {
+  std::hash<string> hasher;
+  return (hasher(name) * 31 + hasher(signature)) * 2 + (is_static ? 1 : 0);
+}
+
+
+void SharedCallTargetCache::RetireEntry(Entry* entry) {
+  retired_refs_.push_back(std::move(entry->method_cls));
+  retired_refs_.push_back(std::move(entry->object_cls));
+}
+
+
+std::vector<JniGlobalRef> SharedCallTargetCache::TakeRetiredRefs() {
+  std::vector<JniGlobalRef> retired_refs;
+  retired_refs.swap(retired_refs_);
+  return retired_refs;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
@@ -0,0 +1,138 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_SHARED_CALL_TARGET_CACHE_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_SHARED_CALL_TARGET_CACHE_H_
+
+#include <unordered_map>
+#include <vector>
+#include "call_target_cache.h"
+#include "common.h"
+#include "jni_utils.h"
+#include "mutex.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Process wide cache of resolved method call targets keyed by the name and
+// signature of the called method and the class of the receiver object.
+// Unlike "CallTargetCache", which serves a single call site, this cache is
+// shared by all the instances of "SafeMethodCaller". Calls to the same method
+// from different breakpoints, from pretty printers and from methods executed
+// by the NanoJava interpreter skip the method lookup ("GetMethodID"), class
+// signature queries and method rule lookup after the first call. The cached
+// method rule is the safety verdict of the method for that receiver class.
+//
+// Entries are also indexed by the resolved method ("jmethodID"), so that they
+// are dropped when the method is unloaded (which includes the class being
+// unloaded or redefined).
+//
+// Each entry keeps global references to the receiver class and to the class
+// that declares the method. This guarantees that the cached "jmethodID" stays
+// valid. The number of entries is bounded, so that the cache doesn't prevent
+// unloading of an unbounded number of classes. When the cache is full, it
+// starts over.
+//
+// This class is thread safe.
+class SharedCallTargetCache {
+ public:
+  // "max_size" is the maximum number of cached call targets.
+  explicit SharedCallTargetCache(int max_size);
+
+  ~SharedCallTargetCache();
+
+  // Fills "target" with the cached call target of the method "name" with
+  // "signature" called on an object of class "object_cls". Only call targets
+  // resolved with the configuration of "config_version" are considered.
+  // Returns false if not found. Entries of replaced configurations are not
+  // removed right away, but they are gone once the cache starts over.
+  bool Find(
+      jobject object_cls,
+      bool is_static,
+      const string& name,
+      const string& signature,
+      int64 config_version,
+      MethodCallTarget* target);
+
+  // Adds new call target of the method "name" with "signature" resolved to
+  // "method".
+  void Insert(
+      jmethodID method,
+      bool is_static,
+      const string& name,
+      const string& signature,
+      const MethodCallTarget& target);
+
+  // Drops all the cached call targets of "method". JNIEnv* is not available
+  // in this callback, so the global references are released later.
+  void JvmtiOnCompiledMethodUnload(jmethodID method);
+
+ private:
+  // Cached call target with global references instead of local ones.
+  struct Entry {
+    jmethodID method;
+    bool is_static;
+    string name;
+    string signature;
+    JniGlobalRef method_cls;
+    string method_cls_signature;
+    JniGlobalRef object_cls;
+    string object_cls_signature;
+    const Config::Method* method_config;
+    int64 config_version;
+  };
+
+  // Computes the key of "entries_".
+  static size_t GetNameKey(
+      bool is_static,
+      const string& name,
+      const string& signature);
+
+  // Moves the global references of the entry to "retired_refs_". Must be
+  // called with "mu_" held.
+  void RetireEntry(Entry* entry);
+
+  // Takes out references of removed entries to be released by the caller
+  // after the lock is released. Must be called with "mu_" held.
+  std::vector<JniGlobalRef> TakeRetiredRefs();
+
+  // Maximum number of entries in the cache.
+  const int max_size_;
+
+  // Locks access to all the data members below.
+  Mutex mu_;
+
+  // Cached call targets keyed by "GetNameKey". The number of receiver
+  // classes per method is usually one, so each key has a short list that is
+  // scanned linearly.
+  std::unordered_map<size_t, std::vector<Entry>> entries_;
+
+  // Keys of "entries_" holding call targets resolved to each method.
+  std::unordered_map<jmethodID, std::vector<size_t>> method_keys_;
+
+  // Total number of entries in "entries_".
+  int size_ = 0;
+
+  // Global references of removed entries that have not been released yet.
+  std::vector<JniGlobalRef> retired_refs_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedCallTargetCache);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_SHARED_CALL_TARGET_CACHE_H_
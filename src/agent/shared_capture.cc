@@ -0,0 +1,87 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shared_capture.h"
+
+#include "overhead_governor.h"
+
+namespace devtools {
+namespace cdbg {
+
+void SharedCapture::Enlist(
+    const string& breakpoint_id,
+    BreakpointModel::CaptureProfile capture_profile,
+    const std::vector<CompiledExpression>* watches,
+    SharedSubexpressionValues* shared_values,
+    CaptureCallback on_captured) {
+  participants_.push_back({ capture_profile,
+                            { breakpoint_id, watches, shared_values },
+                            std::move(on_captured) });
+}
+
+
+void SharedCapture::Collect(jthread thread) {
+  if (participants_.empty()) {
+    return;
+  }
+
+  // The breakpoints charged the governor for their conditions only.
+  ScopedOverheadCharge overhead_charge;
+
+  for (BreakpointModel::CaptureProfile capture_profile : {
+           BreakpointModel::CaptureProfile::DEFAULT,
+           BreakpointModel::CaptureProfile::MINIMAL,
+           BreakpointModel::CaptureProfile::DEEP,
+           BreakpointModel::CaptureProfile::TIERED }) {
+    Collect(thread, capture_profile);
+  }
+
+  participants_.clear();
+}
+
+
+void SharedCapture::Collect(
+    jthread thread,
+    BreakpointModel::CaptureProfile capture_profile) {
+  std::vector<CaptureDataCollector::BreakpointWatches> breakpoints;
+  for (const Participant& participant : participants_) {
+    if (participant.capture_profile == capture_profile) {
+      breakpoints.push_back(participant.watches);
+    }
+  }
+
+  if (breakpoints.empty()) {
+    return;
+  }
+
+  std::shared_ptr<CaptureDataCollector> collector(
+      new CaptureDataCollector(evaluators_, capture_profile));
+  collector->CollectShared(breakpoints, thread);
+
+  if (breakpoints.size() > 1) {
+    LOG(INFO) << "Shared capture of " << breakpoints.size()
+              << " breakpoints";
+  }
+
+  for (Participant& participant : participants_) {
+    if (participant.capture_profile == capture_profile) {
+      participant.on_captured(collector);
+    }
+  }
+}
+
+}  // namespace cdbg
+}  // namespace devtools
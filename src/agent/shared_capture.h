@@ -0,0 +1,93 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_SHARED_CAPTURE_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_SHARED_CAPTURE_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "capture_data_collector.h"
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+class CompiledExpression;
+class JvmEvaluators;
+class SharedSubexpressionValues;
+
+// Collects a single capture for all the snapshot breakpoints that a thread
+// hit at the same code location. Reading the call stack, local variables and
+// referenced objects dominates the cost of a snapshot, and it is the same for
+// all of these breakpoints. Each breakpoint still evaluates its own condition
+// and watched expressions and is completed and formatted separately.
+//
+// The breakpoints enlist while the hit is routed to them and the capture
+// happens once all the breakpoints at the location had a chance to enlist.
+// Only breakpoints with the same capture profile share a capture.
+// This class is not thread safe; it only lives on the stack of the thread
+// that hit the breakpoints.
+class SharedCapture {
+ public:
+  // Callback receiving the capture of an enlisted breakpoint.
+  using CaptureCallback =
+      std::function<void(std::shared_ptr<CaptureDataCollector>)>;
+
+  explicit SharedCapture(JvmEvaluators* evaluators)
+      : evaluators_(evaluators) {
+  }
+
+  // Enlists a snapshot breakpoint that passed its condition and quotas.
+  // "watches" and "shared_values" (may be null) must remain valid until
+  // "Collect" returns (typically "on_captured" keeps the owner alive).
+  void Enlist(
+      const string& breakpoint_id,
+      BreakpointModel::CaptureProfile capture_profile,
+      const std::vector<CompiledExpression>* watches,
+      SharedSubexpressionValues* shared_values,
+      CaptureCallback on_captured);
+
+  // Captures the state of the program and hands it over to all the enlisted
+  // breakpoints. No-op if no breakpoints enlisted.
+  void Collect(jthread thread);
+
+ private:
+  // Single enlisted breakpoint.
+  struct Participant {
+    BreakpointModel::CaptureProfile capture_profile;
+    CaptureDataCollector::BreakpointWatches watches;
+    CaptureCallback on_captured;
+  };
+
+  // Bundles all the evaluation classes together. Not owned by this class.
+  JvmEvaluators* const evaluators_;
+
+  // Enlisted breakpoints in the order of the hit.
+  std::vector<Participant> participants_;
+
+  // Captures the data for the enlisted breakpoints with "capture_profile".
+  void Collect(
+      jthread thread,
+      BreakpointModel::CaptureProfile capture_profile);
+
+  DISALLOW_COPY_AND_ASSIGN(SharedCapture);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_SHARED_CAPTURE_H_
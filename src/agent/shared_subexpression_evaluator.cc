@@ -0,0 +1,45 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shared_subexpression_evaluator.h"
+
+#include "readers_factory.h"
+
+namespace devtools {
+namespace cdbg {
+
+ErrorOr<JVariant> SharedSubexpressionEvaluator::Evaluate(
+    const EvaluationContext& evaluation_context) const {
+  SharedSubexpressionValues* shared_values = evaluation_context.shared_values;
+  if (shared_values == nullptr) {
+    return source_->Evaluate(evaluation_context);
+  }
+
+  const JVariant* cached_value = shared_values->Find(slot_);
+  if (cached_value != nullptr) {
+    return JVariant(*cached_value);
+  }
+
+  ErrorOr<JVariant> value = source_->Evaluate(evaluation_context);
+  if (!value.is_error()) {
+    shared_values->Set(slot_, value.value());
+  }
+
+  return value;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
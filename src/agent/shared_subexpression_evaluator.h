@@ -0,0 +1,113 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_SHARED_SUBEXPRESSION_EVALUATOR_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_SHARED_SUBEXPRESSION_EVALUATOR_H_
+
+#include <memory>
+#include <vector>
+#include "common.h"
+#include "expression_evaluator.h"
+#include "expression_program.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Values of the shared subexpressions computed during a single breakpoint
+// hit. Each slot is filled by the first successful evaluation of the
+// subexpression and reused by all the subsequent ones (in the condition or in
+// the watched expressions of the same breakpoint). Errors are not kept: the
+// condition and the watched expressions may call methods under different
+// policies, so a call rejected in one of them might still succeed in another.
+//
+// Values may hold local references, so the instance must not outlive the
+// breakpoint hit callback and it must only be used by the thread that hit
+// the breakpoint.
+class SharedSubexpressionValues {
+ public:
+  explicit SharedSubexpressionValues(int size) : values_(size) { }
+
+  // Gets the value of the subexpression in "slot" or nullptr if it hasn't
+  // been evaluated yet.
+  const JVariant* Find(int slot) const {
+    return values_[slot].get();
+  }
+
+  // Stores the value of the subexpression in "slot".
+  void Set(int slot, const JVariant& value) {
+    values_[slot].reset(new JVariant(value));
+  }
+
+ private:
+  std::vector<std::unique_ptr<JVariant>> values_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedSubexpressionValues);
+};
+
+
+// Wraps a subexpression that appears more than once in the expressions of a
+// breakpoint. The subexpression is evaluated once per breakpoint hit and the
+// result is reused through "EvaluationContext::shared_values". Evaluates the
+// subexpression every time if the context has no shared values.
+class SharedSubexpressionEvaluator : public ExpressionEvaluator {
+ public:
+  // Class constructor. The instance will own "source".
+  SharedSubexpressionEvaluator(
+      int slot,
+      std::unique_ptr<ExpressionEvaluator> source)
+      : slot_(slot),
+        source_(std::move(source)) {
+  }
+
+  bool Compile(
+      ReadersFactory* readers_factory,
+      FormatMessageModel* error_message) override {
+    return source_->Compile(readers_factory, error_message);
+  }
+
+  const JSignature& GetStaticType() const override {
+    return source_->GetStaticType();
+  }
+
+  Nullable<jvalue> GetStaticValue() const override {
+    return source_->GetStaticValue();
+  }
+
+  bool HasMethodCalls() const override {
+    return source_->HasMethodCalls();
+  }
+
+  int Lower(ExpressionProgramBuilder* builder) const override {
+    return builder->AddLeaf(*this);
+  }
+
+  ErrorOr<JVariant> Evaluate(
+      const EvaluationContext& evaluation_context) const override;
+
+ private:
+  // Index of the subexpression value in "SharedSubexpressionValues".
+  const int slot_;
+
+  // Shared subexpression.
+  std::unique_ptr<ExpressionEvaluator> source_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedSubexpressionEvaluator);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_SHARED_SUBEXPRESSION_EVALUATOR_H_
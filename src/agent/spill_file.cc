@@ -0,0 +1,151 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "spill_file.h"
+
+#include <cstdint>
+#include <cstdio>
+
+namespace devtools {
+namespace cdbg {
+
+// Marks the beginning of each record in the spill file.
+static constexpr uint32_t kRecordMagic = 0x53424443;  // "CDBS".
+
+// Upper bound on the size of a single string in a record. Anything larger
+// indicates a corrupted file.
+static constexpr uint32_t kMaxFieldSize = 64 * 1024 * 1024;
+
+
+static void AppendUInt32(uint32_t value, string* buffer) {
+  buffer->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+
+static void AppendField(const string& value, string* buffer) {
+  AppendUInt32(value.size(), buffer);
+  buffer->append(value);
+}
+
+
+static bool ReadUInt32(FILE* file, uint32_t* value) {
+  return fread(value, sizeof(*value), 1, file) == 1;
+}
+
+
+static bool ReadField(FILE* file, string* value) {
+  uint32_t size = 0;
+  if (!ReadUInt32(file, &size) || (size > kMaxFieldSize)) {
+    return false;
+  }
+
+  value->resize(size);
+  return (size == 0) || (fread(&(*value)[0], size, 1, file) == 1);
+}
+
+
+bool SpillFile::Append(int priority, const SerializedBreakpoint& message) {
+  if (!IsEnabled()) {
+    return false;
+  }
+
+  // Build the entire record first, so that it is written with a single
+  // sequential write.
+  string record;
+  record.reserve(
+      5 * sizeof(uint32_t) +
+      message.format.size() +
+      message.id.size() +
+      message.data.size());
+  AppendUInt32(kRecordMagic, &record);
+  AppendUInt32(priority, &record);
+  AppendField(message.format, &record);
+  AppendField(message.id, &record);
+  AppendField(message.data, &record);
+
+  FILE* file = fopen(path_.c_str(), "ab");
+  if (file == nullptr) {
+    LOG(ERROR) << "Failed to open spill file " << path_;
+    return false;
+  }
+
+  bool success = false;
+  if (fseek(file, 0, SEEK_END) == 0) {
+    const long size = ftell(file);  // NOLINT
+    if ((size >= 0) && (size + record.size() <= max_size_)) {
+      success = (fwrite(record.data(), record.size(), 1, file) == 1);
+      if (!success) {
+        LOG(ERROR) << "Failed to write to spill file " << path_;
+      }
+    } else {
+      LOG(WARNING) << "Spill file " << path_ << " is full, discarding "
+                      "breakpoint update " << message.id;
+    }
+  }
+
+  if (fclose(file) != 0) {
+    success = false;
+  }
+
+  return success;
+}
+
+
+std::vector<SpillFile::Record> SpillFile::ReadAndRemove() {
+  std::vector<Record> records;
+
+  if (!IsEnabled()) {
+    return records;
+  }
+
+  FILE* file = fopen(path_.c_str(), "rb");
+  if (file == nullptr) {
+    return records;  // Nothing was spilled.
+  }
+
+  while (true) {
+    uint32_t magic = 0;
+    uint32_t priority = 0;
+    Record record;
+    if (!ReadUInt32(file, &magic) ||
+        (magic != kRecordMagic) ||
+        !ReadUInt32(file, &priority) ||
+        !ReadField(file, &record.message.format) ||
+        !ReadField(file, &record.message.id) ||
+        !ReadField(file, &record.message.data)) {
+      break;
+    }
+
+    record.priority = priority;
+    records.push_back(std::move(record));
+  }
+
+  if (!feof(file)) {
+    LOG(WARNING) << "Spill file " << path_ << " is corrupted, "
+                 << records.size() << " records recovered";
+  }
+
+  fclose(file);
+
+  if (remove(path_.c_str()) != 0) {
+    LOG(ERROR) << "Failed to delete spill file " << path_;
+  }
+
+  return records;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,80 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_SPILL_FILE_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_SPILL_FILE_H_
+
+#include <vector>
+#include "common.h"
+#include "model.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Append-only file of serialized breakpoint updates that could not be
+// transmitted to the backend, either because the agent is going down or
+// because the transmission queue overflowed. The next instance of the agent
+// reads the file back and retransmits the updates. This keeps the snapshots
+// taken right before a crash or redeployment from being lost.
+//
+// Records are appended sequentially and the file never grows beyond the
+// configured size. No function of this class is ever called from the
+// breakpoint capture path.
+//
+// This class is not thread safe.
+class SpillFile {
+ public:
+  // Single breakpoint update read back from the file.
+  struct Record {
+    // Transmission priority of the update (opaque to this class).
+    int priority;
+
+    // Serialized breakpoint update.
+    SerializedBreakpoint message;
+  };
+
+  // Empty "path" disables the spill file.
+  SpillFile(const string& path, int64 max_size)
+      : path_(path),
+        max_size_(max_size) {
+  }
+
+  // Checks whether the spill file was configured.
+  bool IsEnabled() const { return !path_.empty(); }
+
+  // Appends a single breakpoint update to the end of the file. Returns false
+  // if the file is disabled, full or can't be written.
+  bool Append(int priority, const SerializedBreakpoint& message);
+
+  // Reads all the records from the file and deletes the file. A truncated
+  // record at the end of the file (e.g. if the process crashed while writing
+  // it) is ignored.
+  std::vector<Record> ReadAndRemove();
+
+ private:
+  // Location of the spill file.
+  const string path_;
+
+  // Maximum size of the spill file in bytes.
+  const int64 max_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(SpillFile);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_SPILL_FILE_H_
@@ -0,0 +1,237 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stack_sampler.h"
+
+#include <algorithm>
+#include <functional>
+#include "eval_call_stack.h"
+#include "messages.h"
+#include "overhead_governor.h"
+#include "stopwatch.h"
+
+DEFINE_int32(
+    cdbg_profile_max_threads,
+    256,
+    "maximum number of threads whose call stacks are read by a single "
+    "sample of a profile breakpoint");
+
+DEFINE_int32(
+    cdbg_profile_max_distinct_stacks,
+    10000,
+    "maximum number of distinct call stacks a profile breakpoint counts; "
+    "samples of new call stacks beyond that are only reported as dropped");
+
+DEFINE_int32(
+    cdbg_profile_max_reported_stacks,
+    500,
+    "maximum number of folded call stacks (the ones with the most samples) "
+    "reported by a profile breakpoint");
+
+namespace devtools {
+namespace cdbg {
+
+// Appends a member with the specified name and value to "variable".
+static void AddMember(
+    const string& name,
+    string value,
+    VariableBuilder* variable) {
+  VariableBuilder member;
+  member.set_name(name);
+  member.set_value(std::move(value));
+  variable->add_member(member);
+}
+
+
+StackSampler::StackSampler(EvalCallStack* eval_call_stack)
+    : eval_call_stack_(eval_call_stack) {
+}
+
+
+StackSampler::~StackSampler() {
+  Stop();
+}
+
+
+bool StackSampler::Start(int interval_ms, int duration_ms) {
+  interval_ms_ = interval_ms;
+  duration_ms_ = duration_ms;
+  stop_.store(false, std::memory_order_relaxed);
+
+  return sampling_thread_.Start(
+      "StackSampler",
+      std::bind(&StackSampler::SamplingThreadProc, this));
+}
+
+
+void StackSampler::Stop() {
+  stop_.store(true, std::memory_order_relaxed);
+  sampling_thread_.Join();
+}
+
+
+void StackSampler::SamplingThreadProc() {
+  OverheadGovernor* overhead_governor = OverheadGovernor::GetInstance();
+  Stopwatch stopwatch;
+
+  while (!stop_.load(std::memory_order_relaxed)) {
+    if (overhead_governor->IsAdmitted(OverheadPriority::Formatting)) {
+      Stopwatch sample_stopwatch;
+      TakeSample();
+      overhead_governor->Charge(sample_stopwatch.GetElapsedNanos());
+    } else {
+      ++throttled_samples_;
+    }
+
+    const int64 remaining_ms = duration_ms_ - stopwatch.GetElapsedMillis();
+    if (remaining_ms <= 0) {
+      break;
+    }
+
+    sampling_thread_.Sleep(
+        static_cast<int>(std::min<int64>(interval_ms_, remaining_ms)));
+  }
+
+  elapsed_ms_ = stopwatch.GetElapsedMillis();
+}
+
+
+void StackSampler::TakeSample() {
+  std::vector<EvalCallStack::ThreadStack> threads;
+  eval_call_stack_->ReadAllThreads(
+      std::max(0, FLAGS_cdbg_profile_max_threads),
+      string(),
+      &threads);
+
+  ++samples_;
+
+  for (const EvalCallStack::ThreadStack& thread : threads) {
+    // Blocked and waiting threads don't use CPU. The sampling thread itself
+    // has no Java frames.
+    if (((thread.state & JVMTI_THREAD_STATE_RUNNABLE) == 0) ||
+        thread.frames.empty()) {
+      continue;
+    }
+
+    std::shared_ptr<const StackTraceCache::Stack> stack =
+        StackTraceCache::GetInstance()->Get(thread.frames);
+
+    auto it = stacks_.find(stack.get());
+    if (it == stacks_.end()) {
+      if (stacks_.size() >=
+          std::max(0, FLAGS_cdbg_profile_max_distinct_stacks)) {
+        ++dropped_thread_samples_;
+        continue;
+      }
+
+      const StackTraceCache::Stack* key = stack.get();
+      it = stacks_.insert({ key, { std::move(stack), 0 } }).first;
+    }
+
+    ++it->second.second;
+    ++thread_samples_;
+  }
+}
+
+
+void StackSampler::BuildCallTree(CallTreeNode* root) const {
+  for (const auto& entry : stacks_) {
+    const StackTraceCache::Stack& stack = *entry.second.first;
+    const int64 count = entry.second.second;
+
+    // The call tree starts from the outermost call frame.
+    CallTreeNode* node = root;
+    for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+      std::unique_ptr<CallTreeNode>& child = node->children[it->function];
+      if (child == nullptr) {
+        child.reset(new CallTreeNode);
+      }
+
+      node = child.get();
+    }
+
+    node->self += count;
+  }
+}
+
+
+void StackSampler::FoldCallTree(
+    const CallTreeNode& node,
+    const string& path,
+    std::vector<FoldedStack>* stacks) {
+  if (node.self > 0) {
+    stacks->push_back({ path, node.self });
+  }
+
+  for (const auto& child : node.children) {
+    FoldCallTree(*child.second, path + ';' + child.first, stacks);
+  }
+}
+
+
+void StackSampler::Format(VariableBuilder* variable) const {
+  AddMember("samples", std::to_string(samples_), variable);
+  AddMember("thread_samples", std::to_string(thread_samples_), variable);
+  AddMember("dropped_thread_samples",
+            std::to_string(dropped_thread_samples_),
+            variable);
+  AddMember("throttled_samples", std::to_string(throttled_samples_),
+            variable);
+  AddMember("interval_ms", std::to_string(interval_ms_), variable);
+  AddMember("duration_ms", std::to_string(elapsed_ms_), variable);
+
+  CallTreeNode root;
+  BuildCallTree(&root);
+
+  std::vector<FoldedStack> stacks;
+  for (const auto& child : root.children) {
+    FoldCallTree(*child.second, child.first, &stacks);
+  }
+
+  // The hottest call stacks first.
+  std::stable_sort(
+      stacks.begin(),
+      stacks.end(),
+      [] (const FoldedStack& s1, const FoldedStack& s2) {
+        return s1.second > s2.second;
+      });
+
+  const size_t max_stacks =
+      std::max(0, FLAGS_cdbg_profile_max_reported_stacks);
+
+  VariableBuilder folded_stacks;
+  folded_stacks.set_name("stacks");
+  for (size_t i = 0; (i < stacks.size()) && (i < max_stacks); ++i) {
+    AddMember(stacks[i].first, std::to_string(stacks[i].second),
+              &folded_stacks);
+  }
+
+  if (stacks.size() > max_stacks) {
+    VariableBuilder truncated;
+    truncated.set_status(StatusMessageBuilder()
+        .set_info()
+        .set_refers_to(StatusMessageModel::Context::VARIABLE_VALUE)
+        .set_format(CollectionNotAllItemsCaptured)
+        .set_parameters({ std::to_string(max_stacks) })
+        .build());
+    folded_stacks.add_member(truncated);
+  }
+
+  variable->add_member(folded_stacks);
+}
+
+}  // namespace cdbg
+}  // namespace devtools
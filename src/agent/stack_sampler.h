@@ -0,0 +1,147 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_STACK_SAMPLER_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_STACK_SAMPLER_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "common.h"
+#include "jvmti_agent_thread.h"
+#include "model_util.h"
+#include "stack_trace_cache.h"
+
+namespace devtools {
+namespace cdbg {
+
+class EvalCallStack;
+
+// Samples the call stacks of the running threads at a fixed interval for a
+// bounded time (see "BreakpointModel::Action::PROFILE"). Only the aggregate
+// is reported to the backend, so a profile costs a single breakpoint update
+// regardless of how many samples it took.
+//
+// The stacks of all the threads are read at a single safepoint per sample
+// on a dedicated agent thread. Each call stack is interned through
+// "StackTraceCache", so sampling a stack seen before only costs a hash
+// lookup and an increment. The counts are merged into a call tree (with a
+// node per function, so that different lines of a method are folded
+// together) when the profile is formatted. The profile is reported as
+// folded call stacks ("outer;...;inner" with the sample count), which is
+// the input format of the common flame graph tools.
+//
+// Sampling yields to the application when the agent is over its CPU budget
+// (see "OverheadGovernor"); the skipped samples are reported.
+//
+// "Start", "Stop" and "Format" must not be called concurrently.
+class StackSampler {
+ public:
+  explicit StackSampler(EvalCallStack* eval_call_stack);
+
+  // Stops the sampling thread if it is still running.
+  ~StackSampler();
+
+  // Starts sampling every "interval_ms" milliseconds for "duration_ms"
+  // milliseconds. Returns false if the sampling thread could not be
+  // started.
+  bool Start(int interval_ms, int duration_ms);
+
+  // Stops sampling (if it hasn't stopped already) and waits for the
+  // sampling thread to exit.
+  void Stop();
+
+  // Fills "variable" with the profile. The values are added as members
+  // of "variable". Must be called after "Stop".
+  void Format(VariableBuilder* variable) const;
+
+ private:
+  // Node of the call tree built from the sampled call stacks.
+  struct CallTreeNode {
+    // Number of samples with this function at the top of the call stack.
+    int64 self = 0;
+
+    // Functions called from this one keyed by the function name.
+    std::map<string, std::unique_ptr<CallTreeNode>> children;
+  };
+
+  // Folded call stack and the number of samples in it.
+  typedef std::pair<string, int64> FoldedStack;
+
+  // Sampling thread procedure.
+  void SamplingThreadProc();
+
+  // Reads the call stacks of all the running threads and counts them.
+  void TakeSample();
+
+  // Merges the sampled call stacks into a call tree.
+  void BuildCallTree(CallTreeNode* root) const;
+
+  // Appends the folded call stacks of the subtree of "node" to "stacks".
+  // "path" is the folded call stack of "node".
+  static void FoldCallTree(
+      const CallTreeNode& node,
+      const string& path,
+      std::vector<FoldedStack>* stacks);
+
+ private:
+  // Reads the call stacks of the threads.
+  EvalCallStack* const eval_call_stack_;
+
+  // Thread taking the samples.
+  JvmtiAgentThread sampling_thread_;
+
+  // Set to stop the sampling thread.
+  std::atomic<bool> stop_ { false };
+
+  // Sampling parameters set by "Start".
+  int interval_ms_ = 0;
+  int duration_ms_ = 0;
+
+  // The fields below are only accessed from the sampling thread while it is
+  // running.
+
+  // Number of samples taken per interned call stack. The value keeps the
+  // interned stack alive, so that the key is not reused.
+  std::unordered_map<
+      const StackTraceCache::Stack*,
+      std::pair<std::shared_ptr<const StackTraceCache::Stack>, int64>> stacks_;
+
+  // Number of call stacks sampled across all the threads.
+  int64 thread_samples_ = 0;
+
+  // Number of times the call stacks were read.
+  int64 samples_ = 0;
+
+  // Number of call stacks not counted because "stacks_" was full.
+  int64 dropped_thread_samples_ = 0;
+
+  // Number of samples skipped because the agent was over its CPU budget.
+  int64 throttled_samples_ = 0;
+
+  // Actual time the sampling took.
+  int64 elapsed_ms_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(StackSampler);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_STACK_SAMPLER_H_
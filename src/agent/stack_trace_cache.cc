@@ -0,0 +1,161 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stack_trace_cache.h"
+
+#include "statistician.h"
+#include "type_util.h"
+
+DEFINE_int32(
+    cdbg_stack_trace_cache_max_size,
+    1024 * 1024,  // 1 MB.
+    "Maximum estimated memory used by formatted call stacks reused across "
+    "captures");
+
+namespace devtools {
+namespace cdbg {
+
+// Estimated memory used by a cache entry in addition to the strings.
+static constexpr int kStackOverhead = 64;
+
+// Estimated memory used by a single call frame in addition to the strings.
+static constexpr int kFrameOverhead =
+    sizeof(StackTraceCache::Frame) +
+    sizeof(std::shared_ptr<const EvalCallStack::FrameInfo>);
+
+static StackTraceCache* g_instance = nullptr;
+
+
+StackTraceCache::StackTraceCache() {
+  memory_budget_cookie_ = MemoryBudget::GetInstance()->Register(
+      "stack trace cache",
+      [this] () { return total_size(); },
+      [this] () { Release(); });
+}
+
+
+StackTraceCache::~StackTraceCache() {
+  MemoryBudget::GetInstance()->Unregister(memory_budget_cookie_);
+}
+
+
+void StackTraceCache::InitializeSingleton() {
+  DCHECK(g_instance == nullptr);
+
+  g_instance = new StackTraceCache();
+}
+
+
+void StackTraceCache::CleanupSingleton() {
+  delete g_instance;
+  g_instance = nullptr;
+}
+
+
+StackTraceCache* StackTraceCache::GetInstance() {
+  DCHECK(g_instance != nullptr);
+  return g_instance;
+}
+
+
+std::shared_ptr<const StackTraceCache::Stack> StackTraceCache::Get(
+    const FrameInfos& frames) {
+  {
+    MutexLock lock(&mu_);
+    auto it = stacks_.find(frames);
+    if (it != stacks_.end()) {
+      statStackTraceCacheHitRate->add(100);
+      return it->second;
+    }
+  }
+
+  statStackTraceCacheHitRate->add(0);
+
+  // Format the call stack without holding the lock. If two threads format
+  // the same call stack concurrently, the first one to finish wins.
+  std::shared_ptr<Stack> stack(new Stack);
+  stack->reserve(frames.size());
+
+  int64 size = kStackOverhead;
+  for (const auto& frame_info : frames) {
+    stack->push_back(FormatFrame(*frame_info));
+    size += kFrameOverhead +
+            stack->back().function.size() +
+            stack->back().path.size();
+  }
+
+  MutexLock lock(&mu_);
+
+  // Start over if the cache is full.
+  if (total_size_ + size > FLAGS_cdbg_stack_trace_cache_max_size) {
+    stacks_.clear();
+    total_size_ = 0;
+  }
+
+  auto result = stacks_.insert(std::make_pair(frames, stack));
+  if (result.second) {
+    total_size_ += size;
+  }
+
+  return result.first->second;
+}
+
+
+int64 StackTraceCache::total_size() const {
+  MutexLock lock(&mu_);
+  return total_size_;
+}
+
+
+void StackTraceCache::Release() {
+  MutexLock lock(&mu_);
+  stacks_.clear();
+  total_size_ = 0;
+}
+
+
+size_t StackTraceCache::FrameInfosHash::operator() (
+    const FrameInfos& frames) const {
+  size_t hash = frames.size();
+  for (const auto& frame_info : frames) {
+    hash = hash * 31 + std::hash<const void*>()(frame_info.get());
+  }
+
+  return hash;
+}
+
+
+StackTraceCache::Frame StackTraceCache::FormatFrame(
+    const EvalCallStack::FrameInfo& frame_info) {
+  const EvalCallStack::MethodInfo& method_info = *frame_info.method;
+
+  Frame frame;
+
+  frame.function = InternClassSignature(method_info.class_signature)->type_name;
+  frame.function += '.';
+  frame.function += method_info.method_name;
+
+  frame.path = ConstructFilePath(
+      method_info.class_signature.c_str(),
+      method_info.source_file_name.c_str());
+
+  frame.line = frame_info.line_number;
+
+  return frame;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
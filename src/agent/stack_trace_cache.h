@@ -0,0 +1,124 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_STACK_TRACE_CACHE_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_STACK_TRACE_CACHE_H_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "common.h"
+#include "eval_call_stack.h"
+#include "memory_budget.h"
+#include "mutex.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Interns formatted call stacks. Hot code paths tend to be captured over and
+// over again with exactly the same call stack (e.g. a multi-hit snapshot or a
+// breakpoint group). Formatting a call frame requires decoding the class
+// signature and constructing the source file path, which is repeated for
+// every frame of every capture without this cache.
+//
+// The call stacks are keyed by the sequence of "FrameInfo" pointers.
+// "JvmEvalCallStack" already interns "FrameInfo" by location, so the same
+// call stack yields the same sequence. The cache keeps references to the
+// "FrameInfo" objects it uses as keys, so that a pointer can't be reused for
+// a different location while the entry is alive. A call stack decoded again
+// after the call frames cache was released just gets a new entry.
+//
+// The cache is bounded by FLAGS_cdbg_stack_trace_cache_max_size and starts
+// over when full. It also registers with "MemoryBudget".
+//
+// This class is thread safe.
+class StackTraceCache {
+ public:
+  // Single formatted call frame.
+  struct Frame {
+    // User friendly function name (like "MyOrg.MyClass.MyMethod").
+    string function;
+
+    // Path of the source file.
+    string path;
+
+    // Line number or -1 if not available.
+    int line;
+  };
+
+  // Formatted call stack (top frame first).
+  typedef std::vector<Frame> Stack;
+
+  // Call frames as captured by "EvalCallStack".
+  typedef std::vector<std::shared_ptr<const EvalCallStack::FrameInfo>>
+      FrameInfos;
+
+  StackTraceCache();
+
+  ~StackTraceCache();
+
+  // One time initialization of the global instance. Must be called after
+  // "MemoryBudget::InitializeSingleton".
+  static void InitializeSingleton();
+
+  // One time cleanup of the global instance.
+  static void CleanupSingleton();
+
+  // Gets the global instance of this class.
+  static StackTraceCache* GetInstance();
+
+  // Gets the formatted call stack, formatting it if it isn't in the cache
+  // yet. The returned stack is immutable and remains valid after the cache
+  // starts over.
+  std::shared_ptr<const Stack> Get(const FrameInfos& frames);
+
+  // Gets the approximate memory used by the cache.
+  int64 total_size() const;
+
+  // Removes all the entries.
+  void Release();
+
+ private:
+  struct FrameInfosHash {
+    size_t operator() (const FrameInfos& frames) const;
+  };
+
+  // Formats a single call frame.
+  static Frame FormatFrame(const EvalCallStack::FrameInfo& frame_info);
+
+ private:
+  // Locks the cache.
+  mutable Mutex mu_;
+
+  // Formatted call stacks keyed by call frames.
+  std::unordered_map<
+      FrameInfos,
+      std::shared_ptr<const Stack>,
+      FrameInfosHash> stacks_;
+
+  // Approximate memory used by "stacks_".
+  int64 total_size_ = 0;
+
+  // Registration with "MemoryBudget".
+  MemoryBudget::Cookie memory_budget_cookie_;
+
+  DISALLOW_COPY_AND_ASSIGN(StackTraceCache);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_STACK_TRACE_CACHE_H_
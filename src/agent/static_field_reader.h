@@ -46,6 +46,11 @@ class StaticFieldReader {
   // object type, "result" will contain a local reference (which the caller
   // is responsible to release).
   virtual bool ReadValue(JVariant* result) const = 0;
+
+  // Reads the value of a "static final" field of a primitive type once its
+  // class has been initialized. Such value can't change anymore, so the
+  // caller can use it as a constant. Returns false for any other field.
+  virtual bool ReadConstantValue(JVariant* result) const = 0;
 };
 
 }  // namespace cdbg
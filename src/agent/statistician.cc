@@ -17,6 +17,8 @@
 #include "statistician.h"
 
 #include <math.h>
+#include <algorithm>
+#include "atomic_util.h"
 
 namespace devtools {
 namespace cdbg {
@@ -26,18 +28,40 @@ namespace cdbg {
 constexpr int kReportLogTimeMicros = 15 * 60 * 1000 * 1000;  // 15 minutes.
 
 Statistician* statCaptureTime = nullptr;
+Statistician* statCaptureDeoptimizedFrames = nullptr;
 Statistician* statDynamicLogTime = nullptr;
+Statistician* statDynamicLogWriteTime = nullptr;
 Statistician* statConditionEvaluationTime = nullptr;
 Statistician* statFormattingTime = nullptr;
 Statistician* statClassPrepareTime = nullptr;
 Statistician* statBreakpointsUpdateTime = nullptr;
 Statistician* statSafeClassSize = nullptr;
 Statistician* statSafeClassTransformTime = nullptr;
+Statistician* statClassFilesCacheHitRate = nullptr;
+Statistician* statFrameInfoCacheHitRate = nullptr;
+Statistician* statStackTraceCacheHitRate = nullptr;
+Statistician* statTransmitCompressionRatio = nullptr;
+Statistician* statTransmitCompressionTime = nullptr;
+Statistician* statAgentMemorySize = nullptr;
+Statistician* statHubConnectionReuseRate = nullptr;
+Statistician* statUnloadedClassesRemoved = nullptr;
+Statistician* statBreakpointHitAllocations = nullptr;
+Statistician* statBreakpointHitJniCalls = nullptr;
+Statistician* statBreakpointHitJvmtiCalls = nullptr;
+Statistician* statBreakpointHitGlobalRefs = nullptr;
+Statistician* statConditionAllocations = nullptr;
+Statistician* statConditionJniCalls = nullptr;
+Statistician* statConditionJvmtiCalls = nullptr;
+Statistician* statConditionGlobalRefs = nullptr;
 
 
 void InitializeStatisticians() {
   statCaptureTime = new Statistician("capture_time_micros");
+  statCaptureDeoptimizedFrames =
+      new Statistician("capture_deoptimized_frames");
   statDynamicLogTime = new Statistician("dynamic_log_time_micros");
+  statDynamicLogWriteTime =
+      new Statistician("dynamic_log_write_time_micros");
   statConditionEvaluationTime =
       new Statistician("condition_evaluation_time_micros");
   statFormattingTime = new Statistician("formatting_time_micros");
@@ -47,6 +71,32 @@ void InitializeStatisticians() {
   statSafeClassSize = new Statistician("safe_class_size_bytes");
   statSafeClassTransformTime =
       new Statistician("safe_class_transform_time_micros");
+  statClassFilesCacheHitRate =
+      new Statistician("class_files_cache_hit_rate_percent");
+  statFrameInfoCacheHitRate =
+      new Statistician("frame_info_cache_hit_rate_percent");
+  statStackTraceCacheHitRate =
+      new Statistician("stack_trace_cache_hit_rate_percent");
+  statTransmitCompressionRatio =
+      new Statistician("transmit_compression_ratio_percent");
+  statTransmitCompressionTime =
+      new Statistician("transmit_compression_time_micros");
+  statAgentMemorySize = new Statistician("agent_memory_bytes");
+  statHubConnectionReuseRate =
+      new Statistician("hub_connection_reuse_rate_percent");
+  statUnloadedClassesRemoved =
+      new Statistician("unloaded_classes_removed_count");
+
+#ifdef CDBG_HOT_PATH_COUNTERS
+  statBreakpointHitAllocations = new Statistician("breakpoint_hit_allocations");
+  statBreakpointHitJniCalls = new Statistician("breakpoint_hit_jni_calls");
+  statBreakpointHitJvmtiCalls = new Statistician("breakpoint_hit_jvmti_calls");
+  statBreakpointHitGlobalRefs = new Statistician("breakpoint_hit_global_refs");
+  statConditionAllocations = new Statistician("condition_allocations");
+  statConditionJniCalls = new Statistician("condition_jni_calls");
+  statConditionJvmtiCalls = new Statistician("condition_jvmti_calls");
+  statConditionGlobalRefs = new Statistician("condition_global_refs");
+#endif  // CDBG_HOT_PATH_COUNTERS
 }
 
 
@@ -54,9 +104,15 @@ void CleanupStatisticians() {
   delete statCaptureTime;
   statCaptureTime = nullptr;
 
+  delete statCaptureDeoptimizedFrames;
+  statCaptureDeoptimizedFrames = nullptr;
+
   delete statDynamicLogTime;
   statDynamicLogTime = nullptr;
 
+  delete statDynamicLogWriteTime;
+  statDynamicLogWriteTime = nullptr;
+
   delete statConditionEvaluationTime;
   statConditionEvaluationTime = nullptr;
 
@@ -74,65 +130,309 @@ void CleanupStatisticians() {
 
   delete statSafeClassTransformTime;
   statSafeClassTransformTime = nullptr;
+
+  delete statClassFilesCacheHitRate;
+  statClassFilesCacheHitRate = nullptr;
+
+  delete statFrameInfoCacheHitRate;
+  statFrameInfoCacheHitRate = nullptr;
+
+  delete statStackTraceCacheHitRate;
+  statStackTraceCacheHitRate = nullptr;
+
+  delete statTransmitCompressionRatio;
+  statTransmitCompressionRatio = nullptr;
+
+  delete statTransmitCompressionTime;
+  statTransmitCompressionTime = nullptr;
+
+  delete statAgentMemorySize;
+  statAgentMemorySize = nullptr;
+
+  delete statHubConnectionReuseRate;
+  statHubConnectionReuseRate = nullptr;
+
+  delete statUnloadedClassesRemoved;
+  statUnloadedClassesRemoved = nullptr;
+
+  delete statBreakpointHitAllocations;
+  statBreakpointHitAllocations = nullptr;
+
+  delete statBreakpointHitJniCalls;
+  statBreakpointHitJniCalls = nullptr;
+
+  delete statBreakpointHitJvmtiCalls;
+  statBreakpointHitJvmtiCalls = nullptr;
+
+  delete statBreakpointHitGlobalRefs;
+  statBreakpointHitGlobalRefs = nullptr;
+
+  delete statConditionAllocations;
+  statConditionAllocations = nullptr;
+
+  delete statConditionJniCalls;
+  statConditionJniCalls = nullptr;
+
+  delete statConditionJvmtiCalls;
+  statConditionJvmtiCalls = nullptr;
+
+  delete statConditionGlobalRefs;
+  statConditionGlobalRefs = nullptr;
 }
 
 
-void Statistician::add(double sample) {
-  bool log_statistics = false;
+Statistician* FindStatistician(const string& name) {
+  for (Statistician* statistician : GetAllStatisticians()) {
+    if (name == statistician->name()) {
+      return statistician;
+    }
+  }
 
-  {
-    MutexLock lock(&mu_);
+  return nullptr;
+}
 
-    sum_ += sample;
-    sum2_ += sample * sample;
 
-    if (count_ > 0) {
-      min_ = std::min(min_, sample);
-      max_ = std::max(max_, sample);
-    } else {
-      min_ = sample;
-      max_ = sample;
+std::vector<Statistician*> GetAllStatisticians() {
+  Statistician* const statisticians[] = {
+    statCaptureTime,
+    statCaptureDeoptimizedFrames,
+    statDynamicLogTime,
+    statDynamicLogWriteTime,
+    statConditionEvaluationTime,
+    statFormattingTime,
+    statClassPrepareTime,
+    statBreakpointsUpdateTime,
+    statSafeClassSize,
+    statSafeClassTransformTime,
+    statClassFilesCacheHitRate,
+    statFrameInfoCacheHitRate,
+    statStackTraceCacheHitRate,
+    statTransmitCompressionRatio,
+    statTransmitCompressionTime,
+    statAgentMemorySize,
+    statHubConnectionReuseRate,
+    statUnloadedClassesRemoved,
+    statBreakpointHitAllocations,
+    statBreakpointHitJniCalls,
+    statBreakpointHitJvmtiCalls,
+    statBreakpointHitGlobalRefs,
+    statConditionAllocations,
+    statConditionJniCalls,
+    statConditionJvmtiCalls,
+    statConditionGlobalRefs
+  };
+
+  std::vector<Statistician*> result;
+  for (Statistician* statistician : statisticians) {
+    if (statistician != nullptr) {
+      result.push_back(statistician);
     }
+  }
+
+  return result;
+}
+
+
+// Shard of "Statistician" assigned to the current thread (or -1 if not
+// assigned yet).
+static __thread int g_statistician_shard = -1;
+
+// Source of statistician shards for new threads.
+static std::atomic<int> g_next_statistician_shard { 0 };
 
-    ++count_;
+constexpr int Statistician::kShardCount;
+constexpr int Statistician::kSubBucketCount;
+constexpr int Statistician::kExponentCount;
+constexpr int Statistician::kBucketCount;
 
-    if (report_timer_.GetElapsedMicros() > kReportLogTimeMicros) {
-      log_statistics = true;
-      report_timer_.Reset();
+
+Statistician::Statistician(const char* name) : name_(name) {
+  for (Shard& shard : shards_) {
+    shard.count.store(0, std::memory_order_relaxed);
+    shard.sum.store(0, std::memory_order_relaxed);
+    shard.sum2.store(0, std::memory_order_relaxed);
+    shard.min.store(HUGE_VAL, std::memory_order_relaxed);
+    shard.max.store(-HUGE_VAL, std::memory_order_relaxed);
+    for (std::atomic<int32>& bucket : shard.buckets) {
+      bucket.store(0, std::memory_order_relaxed);
     }
   }
+}
+
+
+void Statistician::add(double sample) {
+  Shard* shard = GetShard();
+
+  shard->buckets[GetBucket(sample)].fetch_add(1, std::memory_order_relaxed);
+  AtomicAdd(&shard->sum, sample);
+  AtomicAdd(&shard->sum2, sample * sample);
+  AtomicMin(&shard->min, sample);
+  AtomicMax(&shard->max, sample);
+  shard->count.fetch_add(1, std::memory_order_relaxed);
+
+  MaybeReport();
+}
+
+
+int Statistician::count() const {
+  int64 count = 0;
+  for (const Shard& shard : shards_) {
+    count += shard.count.load(std::memory_order_relaxed);
+  }
+
+  return count;
+}
+
+
+double Statistician::min() const {
+  double min_value = HUGE_VAL;
+  for (const Shard& shard : shards_) {
+    min_value = std::min(min_value, shard.min.load(std::memory_order_relaxed));
+  }
 
-  if (log_statistics) {
-    LOG(INFO)
-        << "Statistics of " << name_ << ": "
-           "mean = " << mean()
-        << ", stdev = " << stdev()
-        << ", min = " << min()
-        << ", max = " << max()
-        << ", samples = " << count();
+  return (min_value == HUGE_VAL) ? -1 : min_value;
+}
+
+
+double Statistician::max() const {
+  double max_value = -HUGE_VAL;
+  for (const Shard& shard : shards_) {
+    max_value = std::max(max_value, shard.max.load(std::memory_order_relaxed));
   }
+
+  return (max_value == -HUGE_VAL) ? -1 : max_value;
 }
 
 
 double Statistician::mean() const {
-  MutexLock lock(&mu_);
+  int64 count;
+  double sum;
+  double sum2;
+  GetSums(&count, &sum, &sum2);
 
-  if (count_ == 0) {
+  if (count == 0) {
     return -1;
   }
 
-  return sum_ / count_;
+  return sum / count;
 }
 
+
 double Statistician::stdev() const {
-  MutexLock lock(&mu_);
+  int64 count;
+  double sum;
+  double sum2;
+  GetSums(&count, &sum, &sum2);
+
+  if (count == 0) {
+    return -1;
+  }
+
+  const double mean_value = sum / count;
+  return sqrt(std::max(0.0, (sum2 / count) - (mean_value * mean_value)));
+}
+
 
-  if (count_ == 0) {
+double Statistician::percentile(double fraction) const {
+  int64 histogram[kBucketCount] = { 0 };
+  int64 total = 0;
+  for (const Shard& shard : shards_) {
+    for (int i = 0; i < kBucketCount; ++i) {
+      const int32 n = shard.buckets[i].load(std::memory_order_relaxed);
+      histogram[i] += n;
+      total += n;
+    }
+  }
+
+  if (total == 0) {
     return -1;
   }
 
-  const double mean_value = sum_ / count_;
-  return sqrt((sum2_ / count_) - (mean_value * mean_value));
+  // Rank of the sample (1 based) that the percentile is about.
+  const int64 rank = std::max<int64>(
+      1,
+      std::min<int64>(total, static_cast<int64>(ceil(fraction * total))));
+
+  int bucket = 0;
+  for (int64 cumulative = histogram[0]; cumulative < rank; ) {
+    cumulative += histogram[++bucket];
+  }
+
+  // The middle of the bucket might be outside of the range of the samples
+  // actually seen (e.g. if all the samples are the same).
+  return std::max(min(), std::min(max(), GetBucketValue(bucket)));
+}
+
+
+Statistician::Shard* Statistician::GetShard() {
+  if (g_statistician_shard == -1) {
+    g_statistician_shard = g_next_statistician_shard.fetch_add(1);
+  }
+
+  return &shards_[g_statistician_shard & (kShardCount - 1)];
+}
+
+
+int Statistician::GetBucket(double sample) {
+  if (!(sample >= 1)) {  // Also true for NaN.
+    return 0;
+  }
+
+  // sample = mantissa * 2^exponent, where mantissa is in [0.5, 1).
+  int exponent = 0;
+  const double mantissa = frexp(sample, &exponent);
+  if (exponent > kExponentCount) {
+    return kBucketCount - 1;
+  }
+
+  const int sub_bucket = static_cast<int>((mantissa * 2 - 1) * kSubBucketCount);
+  return 1 + (exponent - 1) * kSubBucketCount + sub_bucket;
+}
+
+
+double Statistician::GetBucketValue(int bucket) {
+  if (bucket == 0) {
+    return 0.5;
+  }
+
+  const int exponent = (bucket - 1) / kSubBucketCount;
+  const int sub_bucket = (bucket - 1) % kSubBucketCount;
+  return ldexp(1 + (sub_bucket + 0.5) / kSubBucketCount, exponent);
+}
+
+
+void Statistician::GetSums(int64* count, double* sum, double* sum2) const {
+  *count = 0;
+  *sum = 0;
+  *sum2 = 0;
+
+  for (const Shard& shard : shards_) {
+    *count += shard.count.load(std::memory_order_relaxed);
+    *sum += shard.sum.load(std::memory_order_relaxed);
+    *sum2 += shard.sum2.load(std::memory_order_relaxed);
+  }
+}
+
+
+void Statistician::MaybeReport() {
+  const int64 now = report_timer_.GetElapsedMicros();
+  int64 last_report = last_report_micros_.load(std::memory_order_relaxed);
+  if ((now - last_report <= kReportLogTimeMicros) ||
+      !last_report_micros_.compare_exchange_strong(last_report, now)) {
+    return;
+  }
+
+  LOG(INFO)
+      << "Statistics of " << name_ << ": "
+         "mean = " << mean()
+      << ", stdev = " << stdev()
+      << ", min = " << min()
+      << ", max = " << max()
+      << ", p50 = " << percentile(0.5)
+      << ", p90 = " << percentile(0.9)
+      << ", p99 = " << percentile(0.99)
+      << ", p999 = " << percentile(0.999)
+      << ", samples = " << count();
 }
 
 
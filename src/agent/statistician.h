@@ -17,19 +17,33 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_STATISTICIAN_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_STATISTICIAN_H_
 
+#include <atomic>
+#include <vector>
 #include "common.h"
-#include "mutex.h"
 #include "stopwatch.h"
 
 namespace devtools {
 namespace cdbg {
 
-// Computes statistics (like minimum, maximum and average) over a stream of
-// samples.
+// Computes statistics (like minimum, maximum, average and percentiles) over
+// a stream of samples.
+//
+// "add" is called on hot paths (e.g. breakpoint hit), so it never takes a
+// lock. The statistics are kept in several shards and each thread always
+// updates the same shard, which keeps application threads from bouncing the
+// same cache lines. Each shard has a log-bucketed histogram (8 buckets per
+// power of two, so a percentile is within about 6% of the real value) on top
+// of count, sum, sum of squares, minimum and maximum.
+//
+// Readers merge all the shards. Since the shards are updated without a lock,
+// the values read while samples are being added may be slightly inconsistent
+// with each other (e.g. "count" may already include a sample that "mean" does
+// not).
+//
 // This class is thread safe.
 class Statistician {
  public:
-  explicit Statistician(const char* name) : name_(name) { }
+  explicit Statistician(const char* name);
 
   // Adds a new sample to the statistics.
   void add(double sample);
@@ -38,13 +52,13 @@ class Statistician {
   const char* name() const { return name_; }
 
   // Gets the number of samples added.
-  int count() const { return count_; }
+  int count() const;
 
   // Gets the minimal sample value encountered.
-  double min() const { return min_; }
+  double min() const;
 
   // Gets the maximal sample value encountered.
-  double max() const { return max_; }
+  double max() const;
 
   // Gets the mean value of all the samples encountered.
   double mean() const;
@@ -52,30 +66,67 @@ class Statistician {
   // Gets the standard deviation of the samples.
   double stdev() const;
 
+  // Gets the approximate sample value below which the "fraction" (in [0, 1])
+  // of the samples fall. For example "percentile(0.99)" is the 99th
+  // percentile. Returns -1 if there are no samples.
+  double percentile(double fraction) const;
+
  private:
-  // Synchronize updates.
-  mutable Mutex mu_;
+  // Number of statistics shards. Must be a power of 2.
+  static constexpr int kShardCount = 8;
 
-  // Name of the collector for logging purposes.
-  const char* name_;
+  // Number of histogram buckets per power of two.
+  static constexpr int kSubBucketCount = 8;
+
+  // Number of powers of two covered by the histogram. Samples of 2^32 and
+  // more all fall into the last bucket.
+  static constexpr int kExponentCount = 32;
 
-  // Number of samples.
-  int count_ { 0 };
+  // Total number of histogram buckets. The first bucket is for all the
+  // samples smaller than 1.
+  static constexpr int kBucketCount = 1 + kExponentCount * kSubBucketCount;
 
-  // Sum of all the sample values.
-  double sum_ { 0 };
+  // Statistics updated by a subset of threads.
+  struct Shard {
+    std::atomic<int64> count;
+    std::atomic<double> sum;
+    std::atomic<double> sum2;
+    std::atomic<double> min;
+    std::atomic<double> max;
+    std::atomic<int32> buckets[kBucketCount];
 
-  // Sum of squares of values.
-  double sum2_ { 0 };
+    // Keeps the next shard off the cache line with the last buckets.
+    char padding[64];
+  };
 
-  // Minimal sample value.
-  double min_ { -1 };
+  // Gets the shard updated by the current thread.
+  Shard* GetShard();
 
-  // Maximal sample value.
-  double max_ { -1 };
+  // Gets the histogram bucket of a sample.
+  static int GetBucket(double sample);
 
-  // Counts time since the collected statistics were last written to the log.
-  Stopwatch report_timer_;
+  // Gets the representative value (middle) of a histogram bucket.
+  static double GetBucketValue(int bucket);
+
+  // Sums up the sample values and their squares across all the shards.
+  void GetSums(int64* count, double* sum, double* sum2) const;
+
+  // Writes the collected statistics to the log if "kReportLogTimeMicros"
+  // passed since the last time. Only one thread wins the report.
+  void MaybeReport();
+
+ private:
+  // Name of the collector for logging purposes.
+  const char* name_;
+
+  // Statistics shards.
+  Shard shards_[kShardCount];
+
+  // Counts time since the statistician was created.
+  const Stopwatch report_timer_;
+
+  // Value of "report_timer_" when the statistics were last written to log.
+  std::atomic<int64> last_report_micros_ { 0 };
 
   DISALLOW_COPY_AND_ASSIGN(Statistician);
 };
@@ -83,13 +134,34 @@ class Statistician {
 
 // Global instances of all the metrics collected in the debuglet.
 extern Statistician* statCaptureTime;
+extern Statistician* statCaptureDeoptimizedFrames;
 extern Statistician* statDynamicLogTime;
+extern Statistician* statDynamicLogWriteTime;
 extern Statistician* statConditionEvaluationTime;
 extern Statistician* statFormattingTime;
 extern Statistician* statClassPrepareTime;
 extern Statistician* statBreakpointsUpdateTime;
 extern Statistician* statSafeClassSize;
 extern Statistician* statSafeClassTransformTime;
+extern Statistician* statClassFilesCacheHitRate;
+extern Statistician* statFrameInfoCacheHitRate;
+extern Statistician* statStackTraceCacheHitRate;
+extern Statistician* statTransmitCompressionRatio;
+extern Statistician* statTransmitCompressionTime;
+extern Statistician* statAgentMemorySize;
+extern Statistician* statHubConnectionReuseRate;
+extern Statistician* statUnloadedClassesRemoved;
+
+// Only initialized in builds with hot path counters (see
+// "hot_path_counters.h").
+extern Statistician* statBreakpointHitAllocations;
+extern Statistician* statBreakpointHitJniCalls;
+extern Statistician* statBreakpointHitJvmtiCalls;
+extern Statistician* statBreakpointHitGlobalRefs;
+extern Statistician* statConditionAllocations;
+extern Statistician* statConditionJniCalls;
+extern Statistician* statConditionJvmtiCalls;
+extern Statistician* statConditionGlobalRefs;
 
 // Initialize global statistician instances. This function is only expected to
 // be called exactly once during initialization.
@@ -98,6 +170,13 @@ void InitializeStatisticians();
 // Global statistician instances cleanup.
 void CleanupStatisticians();
 
+// Finds global statistician instance by name. Returns nullptr if not found.
+Statistician* FindStatistician(const string& name);
+
+// Gets all the global statistician instances (empty before
+// "InitializeStatisticians").
+std::vector<Statistician*> GetAllStatisticians();
+
 }  // namespace cdbg
 }  // namespace devtools
 
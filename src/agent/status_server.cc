@@ -0,0 +1,134 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "status_server.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace devtools {
+namespace cdbg {
+
+// Maximum time to wait for a client to read the status.
+constexpr int kStatusSendTimeoutMs = 1000;
+
+
+StatusServer::StatusServer(
+    const string& path,
+    std::function<string()> fn_status)
+    : path_(path),
+      fn_status_(fn_status) {
+}
+
+
+StatusServer::~StatusServer() {
+  if (socket_ != -1) {
+    close(socket_);
+    unlink(path_.c_str());
+  }
+}
+
+
+bool StatusServer::Listen() {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path_.size() >= sizeof(address.sun_path)) {
+    LOG(ERROR) << "Status socket path is too long: " << path_;
+    return false;
+  }
+
+  path_.copy(address.sun_path, path_.size());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd == -1) {
+    LOG(ERROR) << "Failed to create status socket, error: " << errno;
+    return false;
+  }
+
+  // Remove the socket file left behind by a previous process.
+  unlink(path_.c_str());
+
+  // Only the user running the process can connect to the socket.
+  const mode_t old_umask = umask(S_IRWXG | S_IRWXO);
+  const int rc = bind(
+      fd,
+      reinterpret_cast<struct sockaddr*>(&address),
+      sizeof(address));
+  umask(old_umask);
+
+  if ((rc == -1) || (listen(fd, 4) == -1)) {
+    LOG(ERROR) << "Failed to listen on status socket " << path_
+               << ", error: " << errno;
+    close(fd);
+    return false;
+  }
+
+  LOG(INFO) << "Agent status is served on " << path_;
+
+  socket_ = fd;
+  return true;
+}
+
+
+void StatusServer::ServeOnce(int timeout_ms) {
+  if (socket_ == -1) {
+    return;
+  }
+
+  struct pollfd poll_fd = { socket_, POLLIN, 0 };
+  if (poll(&poll_fd, 1, timeout_ms) <= 0) {
+    return;
+  }
+
+  int client = accept4(socket_, nullptr, nullptr, SOCK_CLOEXEC);
+  if (client == -1) {
+    return;
+  }
+
+  // Don't let a client that doesn't read the status stall the thread.
+  struct timeval timeout = {
+    kStatusSendTimeoutMs / 1000,
+    (kStatusSendTimeoutMs % 1000) * 1000
+  };
+  setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  const string status = fn_status_();
+  size_t offset = 0;
+  while (offset < status.size()) {
+    ssize_t sent = send(
+        client,
+        status.data() + offset,
+        status.size() - offset,
+        MSG_NOSIGNAL);
+    if (sent <= 0) {
+      break;
+    }
+
+    offset += sent;
+  }
+
+  close(client);
+}
+
+}  // namespace cdbg
+}  // namespace devtools
@@ -0,0 +1,66 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_STATUS_SERVER_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_STATUS_SERVER_H_
+
+#include <functional>
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Serves the agent status over a local Unix domain socket. Every client
+// connecting to the socket receives the current status (as returned by
+// "fn_status") and the connection is closed. For example:
+//
+//   socat - UNIX-CONNECT:/tmp/cdbg.sock
+//
+// The socket is only accessible to the user running the process.
+//
+// This class is not thread safe. All the calls are expected to come from the
+// same thread.
+class StatusServer {
+ public:
+  StatusServer(const string& path, std::function<string()> fn_status);
+
+  // Closes the socket and removes the socket file.
+  ~StatusServer();
+
+  // Creates the socket and starts listening. Returns false on failure.
+  bool Listen();
+
+  // Waits up to "timeout_ms" for a client to connect and sends the status
+  // to it.
+  void ServeOnce(int timeout_ms);
+
+ private:
+  // Path of the Unix domain socket.
+  const string path_;
+
+  // Builds the status sent to clients.
+  std::function<string()> fn_status_;
+
+  // Listening socket or -1 if not listening.
+  int socket_ = -1;
+
+  DISALLOW_COPY_AND_ASSIGN(StatusServer);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_STATUS_SERVER_H_
@@ -19,6 +19,7 @@
 
 #include "common.h"
 #include "expression_evaluator.h"
+#include "expression_program.h"
 
 namespace devtools {
 namespace cdbg {
@@ -39,6 +40,12 @@ class StringEvaluator : public ExpressionEvaluator {
 
   Nullable<jvalue> GetStaticValue() const override { return nullptr; }
 
+  bool HasMethodCalls() const override { return false; }
+
+  int Lower(ExpressionProgramBuilder* builder) const override {
+    return builder->AddLeaf(*this);
+  }
+
   ErrorOr<JVariant> Evaluate(
       const EvaluationContext& evaluation_context) const override;
 
@@ -0,0 +1,226 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "string_intrinsic_evaluator.h"
+
+#include <cstring>
+#include "jni_utils.h"
+#include "messages.h"
+#include "method_call_result.h"
+#include "model.h"
+#include "type_util.h"
+
+namespace devtools {
+namespace cdbg {
+
+static const struct {
+  const char* name;
+  StringIntrinsic intrinsic;
+} kStringIntrinsics[] = {
+  { "equals", StringIntrinsic::Equals },
+  { "startsWith", StringIntrinsic::StartsWith },
+  { "endsWith", StringIntrinsic::EndsWith },
+  { "contains", StringIntrinsic::Contains }
+};
+
+
+// Compares "size" characters. "memcmp" is vectorized by the C library.
+static bool CharsEqual(const jchar* s1, const jchar* s2, size_t size) {
+  return memcmp(s1, s2, size * sizeof(jchar)) == 0;
+}
+
+
+// Looks for "pattern" in "data". Candidates are located by the first
+// character and verified with "memcmp".
+static bool ContainsChars(
+    const jchar* data,
+    size_t size,
+    const jchar* pattern,
+    size_t pattern_size) {
+  if (pattern_size == 0) {
+    return true;
+  }
+
+  if (pattern_size > size) {
+    return false;
+  }
+
+  const jchar first = pattern[0];
+  const size_t last_position = size - pattern_size;
+  for (size_t i = 0; i <= last_position; ++i) {
+    if ((data[i] == first) &&
+        CharsEqual(data + i + 1, pattern + 1, pattern_size - 1)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+bool StringIntrinsicFromName(const string& name, StringIntrinsic* intrinsic) {
+  for (const auto& entry : kStringIntrinsics) {
+    if (name == entry.name) {
+      *intrinsic = entry.intrinsic;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+StringIntrinsicEvaluator::StringIntrinsicEvaluator(
+    StringIntrinsic intrinsic,
+    std::vector<jchar> literal,
+    std::unique_ptr<ExpressionEvaluator> source,
+    std::unique_ptr<ExpressionEvaluator> method_call)
+    : intrinsic_(intrinsic),
+      literal_(std::move(literal)),
+      source_(std::move(source)),
+      method_call_(std::move(method_call)) {
+}
+
+
+StringIntrinsicEvaluator::~StringIntrinsicEvaluator() {
+}
+
+
+bool StringIntrinsicEvaluator::Compile(
+    ReadersFactory* readers_factory,
+    FormatMessageModel* error_message) {
+  FormatMessageModel source_error;
+  if (source_->Compile(readers_factory, &source_error)) {
+    const JSignature& source_signature = source_->GetStaticType();
+    if ((source_signature.type == JType::Object) &&
+        (source_signature.object_signature == kJavaStringClassSignature)) {
+      method_call_ = nullptr;
+      return true;
+    }
+  }
+
+  source_ = nullptr;
+
+  return method_call_->Compile(readers_factory, error_message);
+}
+
+
+const JSignature& StringIntrinsicEvaluator::GetStaticType() const {
+  static const JSignature boolean_signature = { JType::Boolean };
+
+  if (method_call_ != nullptr) {
+    return method_call_->GetStaticType();
+  }
+
+  return boolean_signature;
+}
+
+
+bool StringIntrinsicEvaluator::HasMethodCalls() const {
+  if (method_call_ != nullptr) {
+    return method_call_->HasMethodCalls();
+  }
+
+  return source_->HasMethodCalls();
+}
+
+
+int StringIntrinsicEvaluator::Lower(ExpressionProgramBuilder* builder) const {
+  if (method_call_ != nullptr) {
+    return method_call_->Lower(builder);
+  }
+
+  return builder->AddLeaf(*this);
+}
+
+
+ErrorOr<JVariant> StringIntrinsicEvaluator::Evaluate(
+    const EvaluationContext& evaluation_context) const {
+  if (method_call_ != nullptr) {
+    return method_call_->Evaluate(evaluation_context);
+  }
+
+  ErrorOr<JVariant> source = source_->Evaluate(evaluation_context);
+  if (source.is_error()) {
+    return source;
+  }
+
+  jobject obj = nullptr;
+  if (!source.value().get<jobject>(&obj)) {
+    return INTERNAL_ERROR_MESSAGE;
+  }
+
+  if (obj == nullptr) {
+    return FormatMessageModel { NullPointerDereference };
+  }
+
+  jstring str = static_cast<jstring>(obj);
+  const jsize size = jni()->GetStringLength(str);
+
+  // Strings of different length are never equal, no need to look at the
+  // characters.
+  if ((intrinsic_ == StringIntrinsic::Equals) &&
+      (static_cast<size_t>(size) != literal_.size())) {
+    return JVariant::Boolean(false);
+  }
+
+  const jchar* data = jni()->GetStringCritical(str, nullptr);
+  if (data == nullptr) {
+    if (jni()->ExceptionCheck()) {
+      return MethodCallResult::PendingJniException().format_exception();
+    }
+
+    return FormatMessageModel { OutOfMemory };
+  }
+
+  const bool result = Match(data, size);
+
+  jni()->ReleaseStringCritical(str, data);
+
+  return JVariant::Boolean(result);
+}
+
+
+bool StringIntrinsicEvaluator::Match(const jchar* data, jsize size) const {
+  const size_t string_size = size;
+  const size_t literal_size = literal_.size();
+  const jchar* literal = literal_.data();
+
+  switch (intrinsic_) {
+    case StringIntrinsic::Equals:
+      return (string_size == literal_size) &&
+             CharsEqual(data, literal, literal_size);
+
+    case StringIntrinsic::StartsWith:
+      return (string_size >= literal_size) &&
+             CharsEqual(data, literal, literal_size);
+
+    case StringIntrinsic::EndsWith:
+      return (string_size >= literal_size) &&
+             CharsEqual(
+                 data + string_size - literal_size,
+                 literal,
+                 literal_size);
+
+    case StringIntrinsic::Contains:
+      return ContainsChars(data, string_size, literal, literal_size);
+  }
+
+  return false;
+}
+
+}  // namespace cdbg
+}  // namespace devtools
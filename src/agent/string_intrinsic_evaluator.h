@@ -0,0 +1,102 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_STRING_INTRINSIC_EVALUATOR_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_STRING_INTRINSIC_EVALUATOR_H_
+
+#include <vector>
+#include "common.h"
+#include "expression_evaluator.h"
+#include "expression_program.h"
+
+namespace devtools {
+namespace cdbg {
+
+// "java.lang.String" methods evaluated natively when the argument is a
+// string literal.
+enum class StringIntrinsic {
+  Equals,      // s.equals("literal")
+  StartsWith,  // s.startsWith("literal")
+  EndsWith,    // s.endsWith("literal")
+  Contains     // s.contains("literal")
+};
+
+// Gets the intrinsic by the method name. Returns false if the method is not
+// one of the intrinsics.
+bool StringIntrinsicFromName(const string& name, StringIntrinsic* intrinsic);
+
+// Evaluates comparisons of a string against a string literal (e.g.
+// "user.getName().equals(\"x\")") without invoking the Java method. The
+// characters of the string are compared in place between
+// "GetStringCritical" and "ReleaseStringCritical" against the literal kept
+// in UTF-16 since the expression was parsed.
+//
+// The intrinsic is only used if the static type of the source object is
+// "java.lang.String". Since the class is final, the result is the same as
+// calling the method. Otherwise all calls are forwarded to the regular
+// method call evaluator.
+class StringIntrinsicEvaluator : public ExpressionEvaluator {
+ public:
+  // "method_call" is the same call compiled as a regular method call. It is
+  // used if the source object is not known to be a string.
+  StringIntrinsicEvaluator(
+      StringIntrinsic intrinsic,
+      std::vector<jchar> literal,
+      std::unique_ptr<ExpressionEvaluator> source,
+      std::unique_ptr<ExpressionEvaluator> method_call);
+
+  ~StringIntrinsicEvaluator() override;
+
+  bool Compile(
+      ReadersFactory* readers_factory,
+      FormatMessageModel* error_message) override;
+
+  const JSignature& GetStaticType() const override;
+
+  Nullable<jvalue> GetStaticValue() const override { return nullptr; }
+
+  bool HasMethodCalls() const override;
+
+  int Lower(ExpressionProgramBuilder* builder) const override;
+
+  ErrorOr<JVariant> Evaluate(
+      const EvaluationContext& evaluation_context) const override;
+
+ private:
+  // Compares the characters of the string to "literal_".
+  bool Match(const jchar* data, jsize size) const;
+
+ private:
+  // String method to evaluate.
+  const StringIntrinsic intrinsic_;
+
+  // Argument of the method in UTF-16.
+  const std::vector<jchar> literal_;
+
+  // Object on which the method is invoked.
+  std::unique_ptr<ExpressionEvaluator> source_;
+
+  // Regular method call. Reset after "Compile" if the intrinsic is used,
+  // otherwise all calls are forwarded to it.
+  std::unique_ptr<ExpressionEvaluator> method_call_;
+
+  DISALLOW_COPY_AND_ASSIGN(StringIntrinsicEvaluator);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_STRING_INTRINSIC_EVALUATOR_H_
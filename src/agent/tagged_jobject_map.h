@@ -0,0 +1,284 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_TAGGED_JOBJECT_MAP_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_TAGGED_JOBJECT_MAP_H_
+
+#include <functional>
+#include <unordered_map>
+#include "common.h"
+#include "jobject_map.h"
+#include "object_tags.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Drop-in replacement of "JobjectMap" keyed on JVMTI object tags (see
+// "GetObjectTag"). Each Java object has a unique tag, so a lookup is a
+// single "GetTag" call followed by a hash table lookup with no
+// "IsSameObject" calls.
+//
+// If object tags are not available, the map falls back to "JobjectMap".
+// The mode is chosen when the map is constructed, which happens after the
+// agent has been loaded.
+//
+// Tags stay on the objects after they are removed from the map. This is
+// fine since a tag is just an identity and doesn't keep the object alive.
+template <typename TRef, typename TData>
+class TaggedJobjectMap {
+ public:
+  // Default constructor (no explicit cleanup of element values on removal).
+  TaggedJobjectMap() : tagged_(IsObjectTaggingEnabled()) { }
+
+  ~TaggedJobjectMap() {
+    RemoveAll();
+  }
+
+  // Enables cleanup of element values on removal.
+  explicit TaggedJobjectMap(
+      std::function<void(jobject, TData*)> cleanup_routine)
+      : tagged_(IsObjectTaggingEnabled()),
+        cleanup_routine_(cleanup_routine),
+        fallback_(cleanup_routine) {
+  }
+
+  // Checks whether the specified Java object is already contained in the map.
+  bool Contains(jobject obj) const;
+
+  // Looks up for the data corresponding to the specified Java object. Returns
+  // nullptr if object is not in the dictionary or if error occurs.
+  TData* Find(jobject obj);
+  const TData* Find(jobject obj) const;
+
+  // Same as above, but takes the precomputed hash code of "obj" (see
+  // "GetHashCode").
+  TData* Find(jobject obj, jint hash_code);
+
+  // Inserts a new entry to the map. If the object is already present in the
+  // map, the function returns false and the data structure is not changed.
+  // If an error occurs taking ref, the function also returns false.
+  // "inserted" is set to the actual object and data pair stored in the map.
+  bool Insert(jobject obj, TData data, std::pair<jobject, TData>** inserted);
+
+  bool Insert(jobject obj, TData data);
+
+  bool Insert(
+      jobject obj,
+      jint hash_code,
+      TData data,
+      std::pair<jobject, TData>** inserted);
+
+  // Removes the specified object from the dictionary (releasing the ref).
+  // Returns true if the object was actually removed.
+  bool Remove(jobject obj);
+
+  bool Remove(jobject obj, jint hash_code);
+
+  // Computes the hash code of the object (which is derived from the object
+  // tag if object tags are available). Returns false on error.
+  static bool GetHashCode(jobject obj, jint* hash_code);
+
+  // Removes all entries from the dictionary (releasing the refs).
+  void RemoveAll();
+
+ private:
+  // True if the map is keyed on object tags, false if all the calls are
+  // forwarded to "fallback_".
+  const bool tagged_;
+
+  // Operation to invoke upon removal of an entry from the dictionary.
+  std::function<void(jobject, TData*)> cleanup_routine_;
+
+  // Objects keyed on their tags. "std::unordered_map" doesn't relocate the
+  // stored elements, so "Find" can return pointers to them.
+  std::unordered_map<jlong, std::pair<jobject, TData>> map_;
+
+  // Used if object tags are not available.
+  JobjectMap<TRef, TData> fallback_;
+
+  DISALLOW_COPY_AND_ASSIGN(TaggedJobjectMap);
+};
+
+
+template <typename TRef, typename TData>
+bool TaggedJobjectMap<TRef, TData>::GetHashCode(jobject obj, jint* hash_code) {
+  if (!IsObjectTaggingEnabled()) {
+    return JobjectMap<TRef, TData>::GetHashCode(obj, hash_code);
+  }
+
+  jlong tag = 0;
+  if (!GetObjectTag(obj, &tag)) {
+    *hash_code = 0;
+    return false;
+  }
+
+  // Tags are assigned sequentially, so the low bits are well distributed.
+  *hash_code = static_cast<jint>(tag ^ (tag >> 32));
+  return true;
+}
+
+
+template <typename TRef, typename TData>
+TData* TaggedJobjectMap<TRef, TData>::Find(jobject obj) {
+  if (!tagged_) {
+    return fallback_.Find(obj);
+  }
+
+  jlong tag = 0;
+  if (!GetObjectTag(obj, &tag)) {
+    return nullptr;
+  }
+
+  auto it = map_.find(tag);
+  if (it == map_.end()) {
+    return nullptr;
+  }
+
+  return &it->second.second;
+}
+
+
+template <typename TRef, typename TData>
+TData* TaggedJobjectMap<TRef, TData>::Find(jobject obj, jint hash_code) {
+  if (!tagged_) {
+    return fallback_.Find(obj, hash_code);
+  }
+
+  return Find(obj);
+}
+
+
+template <typename TRef, typename TData>
+const TData* TaggedJobjectMap<TRef, TData>::Find(jobject obj) const {
+  return const_cast<TaggedJobjectMap*>(this)->Find(obj);
+}
+
+
+template <typename TRef, typename TData>
+bool TaggedJobjectMap<TRef, TData>::Contains(jobject obj) const {
+  return Find(obj) != nullptr;
+}
+
+
+template <typename TRef, typename TData>
+bool TaggedJobjectMap<TRef, TData>::Insert(
+    jobject obj,
+    TData data,
+    std::pair<jobject, TData>** inserted) {
+  DCHECK(obj != nullptr);
+
+  if (!tagged_) {
+    return fallback_.Insert(obj, std::move(data), inserted);
+  }
+
+  *inserted = nullptr;
+
+  jlong tag = 0;
+  if (!GetObjectTag(obj, &tag)) {
+    return false;
+  }
+
+  auto it = map_.find(tag);
+  if (it != map_.end()) {
+    *inserted = &it->second;
+    return false;
+  }
+
+  jobject ref = TRef::Create(obj);
+  if (ref == nullptr) {
+    return false;
+  }
+
+  auto in = map_.insert(
+      std::make_pair(tag, std::make_pair(ref, std::move(data))));
+  *inserted = &in.first->second;
+
+  return true;
+}
+
+
+template <typename TRef, typename TData>
+bool TaggedJobjectMap<TRef, TData>::Insert(
+    jobject obj,
+    jint hash_code,
+    TData data,
+    std::pair<jobject, TData>** inserted) {
+  if (!tagged_) {
+    return fallback_.Insert(obj, hash_code, std::move(data), inserted);
+  }
+
+  return Insert(obj, std::move(data), inserted);
+}
+
+
+template <typename TRef, typename TData>
+bool TaggedJobjectMap<TRef, TData>::Insert(jobject obj, TData data) {
+  std::pair<jobject, TData>* inserted;
+  return Insert(obj, std::move(data), &inserted);
+}
+
+
+template <typename TRef, typename TData>
+bool TaggedJobjectMap<TRef, TData>::Remove(jobject obj) {
+  if (!tagged_) {
+    return fallback_.Remove(obj);
+  }
+
+  jlong tag = 0;
+  if (!GetObjectTag(obj, &tag)) {
+    return false;
+  }
+
+  auto it = map_.find(tag);
+  if (it == map_.end()) {
+    return false;
+  }
+
+  TRef::Delete(it->second.first);
+  map_.erase(it);
+
+  return true;
+}
+
+
+template <typename TRef, typename TData>
+bool TaggedJobjectMap<TRef, TData>::Remove(jobject obj, jint hash_code) {
+  if (!tagged_) {
+    return fallback_.Remove(obj, hash_code);
+  }
+
+  return Remove(obj);
+}
+
+
+template <typename TRef, typename TData>
+void TaggedJobjectMap<TRef, TData>::RemoveAll() {
+  for (auto& entry : map_) {
+    if (cleanup_routine_ != nullptr) {
+      cleanup_routine_(entry.second.first, &entry.second.second);
+    }
+    TRef::Delete(entry.second.first);
+  }
+
+  map_.clear();
+
+  fallback_.RemoveAll();
+}
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_TAGGED_JOBJECT_MAP_H_
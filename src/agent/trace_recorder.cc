@@ -0,0 +1,258 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "trace_recorder.h"
+
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include "mutex.h"
+
+DEFINE_string(
+    cdbg_trace_file,
+    "",
+    "if not empty, the breakpoint lifecycle phases (condition, capture, "
+    "format queue wait, formatting, serialization and transmission) are "
+    "traced and written to this file in Chrome trace event format");
+
+namespace devtools {
+namespace cdbg {
+
+// Maximum number of spans buffered per thread between two flushes. Spans
+// recorded while the buffer is full are dropped. Must be a power of 2.
+constexpr int kTraceBufferCapacity = 4096;
+
+// Maximum number of threads that can record spans. Threads beyond this
+// limit don't record anything. The buffers are never freed.
+constexpr int kMaxTraceBuffers = 256;
+
+// Maximum length of breakpoint ID kept in a span (longer IDs are truncated).
+constexpr int kMaxTraceBreakpointIdLength = 63;
+
+// Single recorded span.
+struct TraceSpan {
+  // Name of the phase (string literal).
+  const char* name;
+
+  // Null terminated breakpoint ID.
+  char breakpoint_id[kMaxTraceBreakpointIdLength + 1];
+
+  // Start and end of the span in the trace clock.
+  int64 start_nanos;
+  int64 end_nanos;
+};
+
+// Spans recorded by a single thread. This is a single producer (the thread)
+// single consumer ("FlushTraceSpans") ring buffer.
+struct TraceBuffer {
+  // Thread ID of the thread owning the buffer.
+  int64 tid;
+
+  // Total number of spans written and read. The difference is the number
+  // of spans in the buffer.
+  std::atomic<uint64> write_count { 0 };
+  std::atomic<uint64> read_count { 0 };
+
+  TraceSpan spans[kTraceBufferCapacity];
+};
+
+// Locks allocation of new trace buffers.
+static Mutex g_trace_buffers_mu;
+
+// Trace buffers allocated so far. Only the first "g_trace_buffers_count"
+// entries are set.
+static TraceBuffer* g_trace_buffers[kMaxTraceBuffers];
+static std::atomic<int> g_trace_buffers_count { 0 };
+
+// Trace buffer of the current thread (or nullptr if not allocated yet).
+static __thread TraceBuffer* g_thread_trace_buffer = nullptr;
+
+// Set if the current thread could not get a trace buffer.
+static __thread bool g_thread_trace_buffer_unavailable = false;
+
+// Locks access to the trace file.
+static Mutex g_trace_file_mu;
+
+// Trace file opened on the first flush.
+static FILE* g_trace_file = nullptr;
+
+// Sink receiving the flushed spans or nullptr if not set. Changed with
+// "g_trace_file_mu" locked.
+static std::atomic<TraceSpanSink*> g_trace_span_sink { nullptr };
+
+
+// Gets the trace buffer of the current thread allocating it as necessary.
+// Returns nullptr if the limit on number of buffers has been reached.
+static TraceBuffer* GetThreadTraceBuffer() {
+  if ((g_thread_trace_buffer != nullptr) ||
+      g_thread_trace_buffer_unavailable) {
+    return g_thread_trace_buffer;
+  }
+
+  MutexLock lock(&g_trace_buffers_mu);
+
+  const int count = g_trace_buffers_count.load(std::memory_order_relaxed);
+  if (count >= kMaxTraceBuffers) {
+    g_thread_trace_buffer_unavailable = true;
+    return nullptr;
+  }
+
+  TraceBuffer* buffer = new TraceBuffer;
+  buffer->tid = syscall(SYS_gettid);
+
+  g_trace_buffers[count] = buffer;
+  g_trace_buffers_count.store(count + 1, std::memory_order_release);
+
+  g_thread_trace_buffer = buffer;
+  return buffer;
+}
+
+
+// Writes the breakpoint ID as a JSON string body. Characters that would need
+// escaping never appear in breakpoint IDs, so they are just replaced.
+static void WriteTraceBreakpointId(FILE* file, const char* breakpoint_id) {
+  for (const char* p = breakpoint_id; *p != '\0'; ++p) {
+    const char ch = *p;
+    fputc(((ch < ' ') || (ch == '"') || (ch == '\\')) ? '_' : ch, file);
+  }
+}
+
+
+bool IsTracingEnabled() {
+  return !FLAGS_cdbg_trace_file.empty() ||
+         (g_trace_span_sink.load(std::memory_order_relaxed) != nullptr);
+}
+
+
+void SetTraceSpanSink(TraceSpanSink* sink) {
+  MutexLock lock(&g_trace_file_mu);
+  g_trace_span_sink.store(sink, std::memory_order_relaxed);
+}
+
+
+int64 TraceClockNanos() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+
+void RecordTraceSpan(
+    const char* name,
+    const char* breakpoint_id,
+    int64 start_nanos,
+    int64 end_nanos) {
+  if (!IsTracingEnabled()) {
+    return;
+  }
+
+  TraceBuffer* buffer = GetThreadTraceBuffer();
+  if (buffer == nullptr) {
+    return;
+  }
+
+  const uint64 write_count =
+      buffer->write_count.load(std::memory_order_relaxed);
+  const uint64 read_count = buffer->read_count.load(std::memory_order_acquire);
+  if (write_count - read_count >= kTraceBufferCapacity) {
+    return;  // The buffer is full.
+  }
+
+  TraceSpan& span = buffer->spans[write_count % kTraceBufferCapacity];
+  span.name = name;
+  strncpy(span.breakpoint_id, breakpoint_id, kMaxTraceBreakpointIdLength);
+  span.breakpoint_id[kMaxTraceBreakpointIdLength] = '\0';
+  span.start_nanos = start_nanos;
+  span.end_nanos = end_nanos;
+
+  buffer->write_count.store(write_count + 1, std::memory_order_release);
+}
+
+
+void FlushTraceSpans() {
+  if (!IsTracingEnabled()) {
+    return;
+  }
+
+  MutexLock lock(&g_trace_file_mu);
+
+  if ((g_trace_file == nullptr) && !FLAGS_cdbg_trace_file.empty()) {
+    g_trace_file = fopen(FLAGS_cdbg_trace_file.c_str(), "w");
+    if (g_trace_file == nullptr) {
+      LOG_FIRST_N(ERROR, 1) << "Failed to open trace file "
+                            << FLAGS_cdbg_trace_file;
+    } else {
+      // The closing bracket is optional in the JSON array format, so the
+      // file stays valid as the events are appended.
+      fputs("[\n", g_trace_file);
+    }
+  }
+
+  TraceSpanSink* sink = g_trace_span_sink.load(std::memory_order_relaxed);
+
+  const int64 pid = getpid();
+  const int count = g_trace_buffers_count.load(std::memory_order_acquire);
+  for (int i = 0; i < count; ++i) {
+    TraceBuffer* buffer = g_trace_buffers[i];
+
+    const uint64 read_count =
+        buffer->read_count.load(std::memory_order_relaxed);
+    const uint64 write_count =
+        buffer->write_count.load(std::memory_order_acquire);
+    for (uint64 n = read_count; n < write_count; ++n) {
+      const TraceSpan& span = buffer->spans[n % kTraceBufferCapacity];
+
+      if (g_trace_file != nullptr) {
+        fprintf(
+            g_trace_file,
+            "{\"name\":\"%s\",\"cat\":\"breakpoint\",\"ph\":\"X\","
+            "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lld,\"tid\":%lld,"
+            "\"args\":{\"breakpoint_id\":\"",
+            span.name,
+            span.start_nanos / 1000.0,
+            (span.end_nanos - span.start_nanos) / 1000.0,
+            static_cast<long long>(pid),
+            static_cast<long long>(buffer->tid));
+        WriteTraceBreakpointId(g_trace_file, span.breakpoint_id);
+        fputs("\"}},\n", g_trace_file);
+      }
+
+      if (sink != nullptr) {
+        sink->Add(
+            span.name,
+            span.breakpoint_id,
+            span.start_nanos,
+            span.end_nanos);
+      }
+    }
+
+    buffer->read_count.store(write_count, std::memory_order_release);
+  }
+
+  if (g_trace_file != nullptr) {
+    fflush(g_trace_file);
+  }
+
+  if (sink != nullptr) {
+    sink->Flush();
+  }
+}
+
+}  // namespace cdbg
+}  // namespace devtools
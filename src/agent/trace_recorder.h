@@ -0,0 +1,127 @@
+/**
+ * Copyright 2015 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_TRACE_RECORDER_H_
+#define DEVTOOLS_CDBG_DEBUGLETS_JAVA_TRACE_RECORDER_H_
+
+#include "common.h"
+
+namespace devtools {
+namespace cdbg {
+
+// Optional tracing of the breakpoint lifecycle (hit, condition evaluation,
+// capture, format queue wait, formatting, serialization and transmission)
+// and of class prepare handling.
+// Unlike "Statistician" that only keeps aggregates, each span is recorded
+// with its timestamps and the breakpoint ID, so that a slow breakpoint
+// update can be attributed to a specific phase.
+//
+// Tracing is enabled with --cdbg_trace_file or by setting a span sink (see
+// "SetTraceSpanSink"). Spans are recorded into a per-thread buffer without
+// taking any locks. "FlushTraceSpans" appends the recorded spans to the
+// trace file in Chrome trace event format (loadable in chrome://tracing and
+// Perfetto UI) and forwards them to the sink.
+//
+// All functions are thread safe.
+
+// Receives the spans collected by "FlushTraceSpans". Calls are serialized
+// and come from the thread calling "FlushTraceSpans".
+class TraceSpanSink {
+ public:
+  virtual ~TraceSpanSink() { }
+
+  // Receives a single span. "breakpoint_id" is empty for spans not related
+  // to a specific breakpoint.
+  virtual void Add(
+      const char* name,
+      const char* breakpoint_id,
+      int64 start_nanos,
+      int64 end_nanos) = 0;
+
+  // Called after all the spans of a single "FlushTraceSpans" call were added.
+  virtual void Flush() = 0;
+};
+
+// Returns true if the tracing is enabled.
+bool IsTracingEnabled();
+
+// Sets the sink receiving the traced spans (in addition to the trace file)
+// or removes it if "sink" is nullptr. The caller retains ownership of
+// "sink". Once this function returns, the previous sink is no longer used.
+void SetTraceSpanSink(TraceSpanSink* sink);
+
+// Gets the current time (in nanoseconds) in the trace clock (monotonic).
+int64 TraceClockNanos();
+
+// Records a span of phase "name" of breakpoint "breakpoint_id". "name" must
+// be a string literal. The span is dropped if the tracing is disabled or if
+// the buffer of the current thread is full.
+void RecordTraceSpan(
+    const char* name,
+    const char* breakpoint_id,
+    int64 start_nanos,
+    int64 end_nanos);
+
+inline void RecordTraceSpan(
+    const char* name,
+    const string& breakpoint_id,
+    int64 start_nanos,
+    int64 end_nanos) {
+  RecordTraceSpan(name, breakpoint_id.c_str(), start_nanos, end_nanos);
+}
+
+// Writes the spans recorded so far to the trace file. Should be called
+// periodically from a single thread.
+void FlushTraceSpans();
+
+
+// Records a span from construction to destruction of this object.
+class ScopedTraceSpan {
+ public:
+  ScopedTraceSpan(const char* name, const string& breakpoint_id)
+      : ScopedTraceSpan(name, breakpoint_id.c_str()) {
+  }
+
+  // Span not related to a specific breakpoint.
+  explicit ScopedTraceSpan(const char* name)
+      : ScopedTraceSpan(name, "") {
+  }
+
+  ~ScopedTraceSpan() {
+    if (start_nanos_ >= 0) {
+      RecordTraceSpan(name_, breakpoint_id_, start_nanos_, TraceClockNanos());
+    }
+  }
+
+ private:
+  ScopedTraceSpan(const char* name, const char* breakpoint_id)
+      : name_(name),
+        breakpoint_id_(breakpoint_id),
+        start_nanos_(IsTracingEnabled() ? TraceClockNanos() : -1) {
+  }
+
+ private:
+  const char* const name_;
+  const char* const breakpoint_id_;
+  const int64 start_nanos_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedTraceSpan);
+};
+
+}  // namespace cdbg
+}  // namespace devtools
+
+#endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_TRACE_RECORDER_H_
@@ -17,9 +17,13 @@
 #ifndef DEVTOOLS_CDBG_DEBUGLETS_JAVA_TRANSMIT_QUEUE_H_
 #define DEVTOOLS_CDBG_DEBUGLETS_JAVA_TRANSMIT_QUEUE_H_
 
-#include <queue>
+#include <algorithm>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <vector>
 #include "common.h"
+#include "stopwatch.h"
 
 namespace devtools {
 namespace cdbg {
@@ -33,12 +37,37 @@ constexpr int kMaxTransmitQueueSize = 100;
 // assumed to be poisonous and discarded
 constexpr int kMaxRetryAttempts = 10;
 
+// Delay before the first retry of a message. Each subsequent retry doubles
+// the delay up to "kMaxRetryBackoffMs".
+constexpr int kInitialRetryBackoffMs = 1000;
+
+// Maximum delay between two retries of the same message.
+constexpr int kMaxRetryBackoffMs = 5 * 60 * 1000;
+
+// Importance of a pending message. Messages are transmitted in the order of
+// priority and in FIFO order within the same priority.
+enum class TransmitPriority {
+  // Final breakpoint result with the captured snapshot.
+  FINAL_RESULT,
+
+  // Final breakpoint update without a snapshot (e.g. error or expiration).
+  FINAL_STATUS,
+
+  // Non final update. Superseded by any newer message with the same key.
+  INTERIM
+};
+
 // Simple list of pending UpdateActiveBreakpoint messages.
 //
+// Messages are ordered by "TransmitPriority". The oldest pending interim
+// message of a breakpoint is dropped when a newer message of the same
+// breakpoint (identified by the key) is queued.
 //
 // Since communication channel is not reliable, "TransmitQueue" supports
 // retrying. Each message maintains retry count and if exceeded, the message is
-// considered poisonous and discarded.
+// considered poisonous and discarded. A message that failed to be sent is not
+// ready for transmission again until its exponential backoff delay expires,
+// so that a single failing message doesn't block other messages.
 //
 // The class is not thread safe since formatting and transmission always run
 // in the same thread (main debugger thread).
@@ -50,63 +79,237 @@ class TransmitQueue {
     // Formatted message ready to be transmitted.
     std::unique_ptr<TMessage> message;
 
+    // Importance of the message.
+    TransmitPriority priority { TransmitPriority::INTERIM };
+
+    // Identifies messages that supersede each other (e.g. breakpoint ID).
+    string key;
+
     // Number of times the message was attempted to be sent.
     int attempts { 0 };
+
+    // Time (as measured by "clock_") before which the message should not be
+    // retried.
+    int64 not_before_ms { 0 };
   };
 
+  // Callback invoked with a message discarded because the queue is full.
+  typedef std::function<void(const Item&)> OverflowCallback;
+
   TransmitQueue() { }
 
+  // Sets the callback to receive messages that don't fit the queue.
+  void set_overflow_callback(OverflowCallback fn) {
+    overflow_callback_ = fn;
+  }
+
   // Appends the formatted message to the end of the queue. "Enqueue" honors
   // the "kMaxPendingResults" limit and discards the breakpoint if threshold
-  // is reached.
-  bool enqueue(std::unique_ptr<TMessage> message) {
+  // is reached. Pending interim message with the same "key" is dropped.
+  bool enqueue(
+      std::unique_ptr<TMessage> message,
+      TransmitPriority priority,
+      const string& key) {
     std::unique_ptr<Item> new_item(new Item);
     new_item->message = std::move(message);
+    new_item->priority = priority;
+    new_item->key = key;
+
+    RemoveSupersededItems(key);
 
     return enqueue(std::move(new_item));
   }
 
   // Returns message that failed to be sent back to the end of the queue. The
   // function increments retry count and discards the message if the retry
-  // count exceeds kMaxRetryAttempts.
+  // count exceeds kMaxRetryAttempts. The message will not be ready before
+  // its backoff delay expires.
   bool enqueue(std::unique_ptr<Item> item) {
     if (item->attempts >= kMaxRetryAttempts) {
       LOG(ERROR) << "Item retry count exceeded maximum, discarding...";
       return false;
     }
 
-    if (queue_.size() >= kMaxTransmitQueueSize) {
+    if (IsSuperseded(*item)) {
+      return false;
+    }
+
+    if (size() >= kMaxTransmitQueueSize) {
       LOG(ERROR) << "Transmission queue is full, discarding new item...";
+      if (overflow_callback_ != nullptr) {
+        overflow_callback_(*item);
+      }
       return false;
     }
 
+    if (item->attempts > 0) {
+      const int64 backoff_ms = std::min<int64>(
+          static_cast<int64>(kInitialRetryBackoffMs) << (item->attempts - 1),
+          kMaxRetryBackoffMs);
+      item->not_before_ms = clock_.GetElapsedMillis() + backoff_ms;
+    }
+
     item->attempts++;
-    queue_.push(std::move(item));
+    GetQueue(item->priority).push_back(std::move(item));
 
     return true;
   }
 
-  // Checks whether the transmission queue is empty.
+  // Checks whether the transmission queue is empty. Messages waiting for
+  // their retry backoff delay count as pending.
   bool empty() const {
-    return queue_.empty();
+    for (const auto& queue : queues_) {
+      if (!queue.empty()) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Total number of pending messages, including the ones waiting for their
+  // retry backoff delay.
+  int size() const {
+    int size = 0;
+    for (const auto& queue : queues_) {
+      size += queue.size();
+    }
+
+    return size;
+  }
+
+  // Total size of pending messages as computed by "message_size" for each
+  // message.
+  template <typename TMessageSize>
+  int64 total_size(TMessageSize message_size) const {
+    int64 total_size = 0;
+    for (const auto& queue : queues_) {
+      for (const auto& item : queue) {
+        total_size += message_size(*item->message);
+      }
+    }
+
+    return total_size;
   }
 
-  // Pops the next message ready for transmission. Returns nullptr if the queue
-  // is empty.
+  // Gets the next message ready for transmission without removing it from
+  // the queue. Returns nullptr if no message is ready.
+  const TMessage* peek() const {
+    int queue_index;
+    size_t position;
+    if (!FindReady(&queue_index, &position)) {
+      return nullptr;
+    }
+
+    return queues_[queue_index][position]->message.get();
+  }
+
+  // Pops the next message ready for transmission. Returns nullptr if no
+  // message is ready.
   std::unique_ptr<Item> pop() {
-    if (queue_.empty()) {
+    int queue_index;
+    size_t position;
+    if (!FindReady(&queue_index, &position)) {
       return nullptr;
     }
 
-    std::unique_ptr<Item> front = std::move(queue_.front());
-    queue_.pop();
+    std::deque<std::unique_ptr<Item>>& queue = queues_[queue_index];
+    std::unique_ptr<Item> item = std::move(queue[position]);
+    queue.erase(queue.begin() + position);
+
+    return item;
+  }
+
+  // Removes all the pending messages from the queue (including the ones
+  // waiting for their retry backoff delay) in the order of priority.
+  std::vector<std::unique_ptr<Item>> drain() {
+    std::vector<std::unique_ptr<Item>> items;
+    for (auto& queue : queues_) {
+      for (std::unique_ptr<Item>& item : queue) {
+        items.push_back(std::move(item));
+      }
+      queue.clear();
+    }
+
+    return items;
+  }
+
+  // Returns message that was popped, but not attempted to be sent, back to
+  // the front of the queue. Unlike "enqueue", the retry count is unchanged.
+  void unpop(std::unique_ptr<Item> item) {
+    if (IsSuperseded(*item)) {
+      return;
+    }
 
-    return front;
+    GetQueue(item->priority).push_front(std::move(item));
   }
 
  private:
-  // Items pending transmission.
-  std::queue<std::unique_ptr<Item>> queue_;
+  std::deque<std::unique_ptr<Item>>& GetQueue(TransmitPriority priority) {
+    return queues_[static_cast<int>(priority)];
+  }
+
+  // Finds the first message of the highest priority that is past its retry
+  // backoff delay. Returns false if no message is ready.
+  bool FindReady(int* queue_index, size_t* position) const {
+    const int64 now_ms = clock_.GetElapsedMillis();
+    for (int i = 0; i < arraysize(queues_); ++i) {
+      for (size_t j = 0; j < queues_[i].size(); ++j) {
+        if (queues_[i][j]->not_before_ms <= now_ms) {
+          *queue_index = i;
+          *position = j;
+          return true;
+        }
+      }
+    }
+
+    return false;
+  }
+
+  // Checks whether "item" is an interim message and a newer message with the
+  // same key is already pending.
+  bool IsSuperseded(const Item& item) const {
+    if ((item.priority != TransmitPriority::INTERIM) || item.key.empty()) {
+      return false;
+    }
+
+    for (const auto& queue : queues_) {
+      for (const std::unique_ptr<Item>& pending : queue) {
+        if (pending->key == item.key) {
+          return true;
+        }
+      }
+    }
+
+    return false;
+  }
+
+  // Drops pending interim messages with the specified key.
+  void RemoveSupersededItems(const string& key) {
+    if (key.empty()) {
+      return;
+    }
+
+    auto& queue = GetQueue(TransmitPriority::INTERIM);
+    queue.erase(
+        std::remove_if(
+            queue.begin(),
+            queue.end(),
+            [&key] (const std::unique_ptr<Item>& item) {
+              return item->key == key;
+            }),
+        queue.end());
+  }
+
+ private:
+  // Items pending transmission, one queue per "TransmitPriority".
+  std::deque<std::unique_ptr<Item>> queues_[3];
+
+  // Measures time for retry backoff.
+  Stopwatch clock_;
+
+  // Optional callback for messages that don't fit the queue.
+  OverflowCallback overflow_callback_;
 
   DISALLOW_COPY_AND_ASSIGN(TransmitQueue);
 };
@@ -115,4 +318,3 @@ class TransmitQueue {
 }  // namespace devtools
 
 #endif  // DEVTOOLS_CDBG_DEBUGLETS_JAVA_TRANSMIT_QUEUE_H_
-
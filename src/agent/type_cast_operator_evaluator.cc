@@ -162,6 +162,14 @@ bool TypeCastOperatorEvaluator::Compile(
       return false;
     }
 
+    // Upcasts (e.g. "(Object) str") always succeed, so there is nothing to
+    // check at runtime.
+    if (readers_factory->IsAssignable(
+            source_->GetStaticType().object_signature,
+            result_type_.object_signature)) {
+      computer_ = &TypeCastOperatorEvaluator::DoNothingComputer;
+    }
+
     return true;
   }
 
@@ -175,6 +183,10 @@ bool TypeCastOperatorEvaluator::Compile(
 
 ErrorOr<JVariant> TypeCastOperatorEvaluator::Evaluate(
     const EvaluationContext& evaluation_context) const {
+  if (IsNoOp()) {
+    return source_->Evaluate(evaluation_context);
+  }
+
   ErrorOr<JVariant> source_result = source_->Evaluate(evaluation_context);
   if (source_result.is_error()) {
     return source_result;
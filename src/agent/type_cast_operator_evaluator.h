@@ -20,6 +20,7 @@
 #include "common.h"
 #include "jni_utils.h"
 #include "expression_evaluator.h"
+#include "expression_program.h"
 #include "java_expression.h"
 
 namespace devtools {
@@ -45,13 +46,35 @@ class TypeCastOperatorEvaluator : public ExpressionEvaluator {
   }
 
   Nullable<jvalue> GetStaticValue() const override {
+    if (IsNoOp()) {
+      return source_->GetStaticValue();
+    }
+
     return nullptr;
   }
 
+  bool HasMethodCalls() const override {
+    return source_->HasMethodCalls();
+  }
+
+  int Lower(ExpressionProgramBuilder* builder) const override {
+    if (IsNoOp()) {
+      return source_->Lower(builder);
+    }
+
+    return builder->AddLeaf(*this);
+  }
+
   ErrorOr<JVariant> Evaluate(
       const EvaluationContext& evaluation_context) const override;
 
  private:
+  // Returns true if the cast doesn't change the value of "source_" (numeric
+  // casts are applied to "source_" in "Compile").
+  bool IsNoOp() const {
+    return computer_ == &TypeCastOperatorEvaluator::DoNothingComputer;
+  }
+
   // No-op Computer.
   ErrorOr<JVariant> DoNothingComputer(const JVariant& source) const;
 
@@ -50,7 +50,7 @@ class TypeEvaluator {
   // were captured". "method_caller" holds the method evaluation policy and
   // keeps track of method evaluation quota. Some type evaluators don't need
   // the "method_caller". The "method_caller" is not stored beyond immediate
-  // call to "Evaluate".
+  // call to "Evaluate". Objects in "members" are local references.
   virtual void Evaluate(
       MethodCaller* method_caller,
       const ClassMetadataReader::Entry& class_metadata,
@@ -16,11 +16,53 @@
 
 #include "type_util.h"
 
+#include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "mutex.h"
 
 namespace devtools {
 namespace cdbg {
 
+// Number of array index names ("[0]", "[1]", ...) that are built in advance.
+// Covers all the elements captured by "ArrayTypeEvaluator" (which is
+// limited by "kMaxCapturePrimitiveElements").
+static constexpr int kInternedArrayIndexNames = 100;
+
+// Number of independently locked shards of the interned class signatures
+// table. Class signatures are interned from application threads (e.g. by
+// dynamic logs), so a single lock would serialize them.
+static constexpr int kInternedClassSignatureShards = 16;
+
+// Maximum number of interned class signatures in a single shard.
+static constexpr int kMaxInternedClassSignaturesPerShard = 4096;
+
+
+static string BuildArrayIndexName(int i) {
+  char str[20];
+  snprintf(str, arraysize(str), "[%d]", i);
+  str[arraysize(str) - 1] = '\0';
+
+  return str;
+}
+
+
+// Builds the immutable table of array index names. The table is never
+// released.
+static const std::vector<string>* BuildArrayIndexNamesTable() {
+  std::vector<string>* names = new std::vector<string>;
+  names->reserve(kInternedArrayIndexNames);
+  for (int i = 0; i < kInternedArrayIndexNames; ++i) {
+    names->push_back(BuildArrayIndexName(i));
+  }
+
+  return names;
+}
+
 static Nullable<string> InsertExtraArgumentIntoDescriptor(
     const string& descriptor,
     size_t pos,
@@ -239,6 +281,154 @@ bool ParseJMethodSignature(const string& signature, JMethodSignature* result) {
 }
 
 
+// Locks access to the interned method signatures.
+static Mutex g_interned_method_signatures_mu;
+
+// Parsed method signatures keyed by the signature string. Method signatures
+// repeat a lot across classes (e.g. "()V" or "()Ljava/lang/String;"), so the
+// table stays small. Allocated on first use and never freed.
+static std::map<string, std::shared_ptr<const JMethodSignature>>*
+    g_interned_method_signatures = nullptr;
+
+std::shared_ptr<const JMethodSignature> InternJMethodSignature(
+    const string& signature) {
+  MutexLock lock(&g_interned_method_signatures_mu);
+
+  if (g_interned_method_signatures == nullptr) {
+    g_interned_method_signatures =
+        new std::map<string, std::shared_ptr<const JMethodSignature>>;
+  }
+
+  auto it = g_interned_method_signatures->find(signature);
+  if (it != g_interned_method_signatures->end()) {
+    return it->second;
+  }
+
+  std::shared_ptr<JMethodSignature> parsed(new JMethodSignature);
+  if (!ParseJMethodSignature(signature, parsed.get())) {
+    return nullptr;
+  }
+
+  g_interned_method_signatures->insert(std::make_pair(signature, parsed));
+
+  return parsed;
+}
+
+
+// Class signature that isn't necessarily null terminated (e.g. signature
+// in a JVMTI buffer). Used as a key in the interned class signatures table,
+// so that lookups don't need to copy the signature into a string.
+struct ClassSignatureView {
+  const char* data;
+  size_t size;
+};
+
+struct ClassSignatureViewHash {
+  size_t operator() (const ClassSignatureView& view) const {
+    // FNV-1a hash.
+    uint64 hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < view.size; ++i) {
+      hash ^= static_cast<uint8>(view.data[i]);
+      hash *= 1099511628211ULL;
+    }
+
+    return static_cast<size_t>(hash);
+  }
+};
+
+struct ClassSignatureViewEqual {
+  bool operator() (
+      const ClassSignatureView& view1,
+      const ClassSignatureView& view2) const {
+    return (view1.size == view2.size) &&
+           (memcmp(view1.data, view2.data, view1.size) == 0);
+  }
+};
+
+// Single shard of the interned class signatures table. The keys point to
+// the "signature" of the interned instance they map to.
+struct InternedClassSignatureShard {
+  Mutex mu;
+  std::unordered_map<
+      ClassSignatureView,
+      std::shared_ptr<const InternedClassSignature>,
+      ClassSignatureViewHash,
+      ClassSignatureViewEqual> signatures;
+};
+
+// Interned class signatures. Allocated on first use and never freed.
+static InternedClassSignatureShard* GetInternedClassSignatureShards() {
+  static InternedClassSignatureShard* shards =
+      new InternedClassSignatureShard[kInternedClassSignatureShards];
+  return shards;
+}
+
+// Last unique number assigned to an interned class signature.
+static std::atomic<int32> g_last_interned_class_signature_id { 0 };
+
+static std::shared_ptr<const InternedClassSignature> InternClassSignature(
+    const ClassSignatureView& view) {
+  const size_t hash = ClassSignatureViewHash()(view);
+  InternedClassSignatureShard& shard = GetInternedClassSignatureShards()[
+      (hash >> 32) % kInternedClassSignatureShards];
+
+  {
+    MutexLock lock(&shard.mu);
+
+    auto it = shard.signatures.find(view);
+    if (it != shard.signatures.end()) {
+      return it->second;
+    }
+  }
+
+  // Build the names outside of the lock. This is the only place where the
+  // signature is copied. If another thread interns the same signature in
+  // the meantime, its instance wins.
+  std::shared_ptr<InternedClassSignature> interned(new InternedClassSignature);
+  interned->signature.assign(view.data, view.size);
+
+  const string& signature = interned->signature;
+  interned->jsignature = { JType::Object, signature };
+  interned->type_name = IsArrayObjectSignature(signature)
+      ? TypeNameFromSignature(interned->jsignature)
+      : TypeNameFromJObjectSignature(signature);
+  interned->binary_name = BinaryNameFromJObjectSignature(signature);
+  interned->id = 0;
+
+  MutexLock lock(&shard.mu);
+
+  auto it = shard.signatures.find(view);
+  if (it != shard.signatures.end()) {
+    return it->second;
+  }
+
+  if (shard.signatures.size() >= kMaxInternedClassSignaturesPerShard) {
+    return interned;
+  }
+
+  interned->id = ++g_last_interned_class_signature_id;
+  shard.signatures.insert(std::make_pair(
+      ClassSignatureView { signature.data(), signature.size() },
+      interned));
+
+  return interned;
+}
+
+
+std::shared_ptr<const InternedClassSignature> InternClassSignature(
+    const string& signature) {
+  return InternClassSignature(
+      ClassSignatureView { signature.data(), signature.size() });
+}
+
+
+std::shared_ptr<const InternedClassSignature> InternClassSignature(
+    const char* signature) {
+  return InternClassSignature(
+      ClassSignatureView { signature, strlen(signature) });
+}
+
+
 string TrimReturnType(const string& signature) {
   if (signature.empty() || (signature[0] != '(')) {
     return signature;  // Error, return original signature.
@@ -525,5 +715,17 @@ string ConstructFilePath(
 }
 
 
+string FormatArrayIndexName(int i) {
+  // Initialization of function-local statics is thread safe.
+  static const std::vector<string>* names = BuildArrayIndexNamesTable();
+
+  if ((i >= 0) && (i < kInternedArrayIndexNames)) {
+    return (*names)[i];
+  }
+
+  return BuildArrayIndexName(i);
+}
+
 }  // namespace cdbg
 }  // namespace devtools
+
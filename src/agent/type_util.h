@@ -70,7 +70,7 @@ struct NamedJVariant {
     NamedJVariant instance;
     instance.status.is_error = true;
     instance.status.refers_to = StatusMessageModel::Context::VARIABLE_VALUE;
-    instance.status.description = description;
+    instance.status.description = std::move(description);
 
     return instance;
   }
@@ -79,7 +79,7 @@ struct NamedJVariant {
     NamedJVariant instance;
     instance.status.is_error = false;
     instance.status.refers_to = StatusMessageModel::Context::VARIABLE_VALUE;
-    instance.status.description = description;
+    instance.status.description = std::move(description);
 
     return instance;
   }
@@ -97,6 +97,17 @@ struct NamedJVariant {
   // Formatted error message explaining why the value could not be
   // captured.
   StatusMessageModel status;
+
+  // Length of the Java string in "value" (if it is one) or -1 if unknown.
+  // Filled in once by the capture size accounting, so that formatting the
+  // string doesn't need to query the length again.
+  int string_length { -1 };
+
+  // UTF-8 content of a short Java string copied while the thread was still
+  // paused (see "ValueFormatter::CaptureInlineString"). When set, "value" no
+  // longer holds the string reference.
+  bool has_inline_string { false };
+  string inline_string;
 };
 
 
@@ -117,6 +128,45 @@ string SignatureFromJSignature(JSignature signature);
 // unexpected.
 bool ParseJMethodSignature(const string& signature, JMethodSignature* result);
 
+// Parses Java method signature and returns the shared parsed instance. All
+// calls with the same signature string return the same instance. Returns
+// nullptr if the signature format is unexpected. The interned signatures are
+// never freed. Thread safe.
+std::shared_ptr<const JMethodSignature> InternJMethodSignature(
+    const string& signature);
+
+// Precomputed names of a Java class signature.
+struct InternedClassSignature {
+  // JVMTI class signature (e.g. "Lcom/prod/MyClass$MyInnerClass;").
+  string signature;
+
+  // Signature as "JSignature" (always JType::Object).
+  JSignature jsignature;
+
+  // Type name (e.g. "com.prod.MyClass.MyInnerClass" or "int[]").
+  string type_name;
+
+  // Binary name as returned by "BinaryNameFromJObjectSignature" (e.g.
+  // "com.prod.MyClass$MyInnerClass").
+  string binary_name;
+
+  // Unique number of the interned signature (starting from 1) or 0 if the
+  // table was full and the signature was not interned.
+  int32 id;
+};
+
+// Gets the precomputed names of a class signature (object or array). All
+// calls with the same signature string return the same instance, until the
+// table reaches its size limit. Beyond that a new (not interned) instance is
+// built on each call. The interned signatures are never freed. Thread safe.
+std::shared_ptr<const InternedClassSignature> InternClassSignature(
+    const string& signature);
+
+// Same as above, but takes null terminated signature (e.g. as returned by
+// JVMTI). The signature is only copied if it wasn't interned yet.
+std::shared_ptr<const InternedClassSignature> InternClassSignature(
+    const char* signature);
+
 // Removes return type from method signature. For example: "(IIJ)I" will become
 // "(IIJ)". If the method signature is corrupted, returns original string.
 string TrimReturnType(const string& signature);
@@ -260,14 +310,10 @@ inline bool IsNumericJType(JType type) {
 }
 
 
-// Format array index ("[N]")
-inline string FormatArrayIndexName(int i) {
-  char str[20];
-  snprintf(str, arraysize(str), "[%d]", i);
-  str[arraysize(str) - 1] = '\0';
-
-  return str;
-}
+// Format array index ("[N]"). Names of the first array elements come from a
+// table built once per process, so that capturing an array doesn't format
+// (and allocate) the same names over and over again.
+string FormatArrayIndexName(int i);
 
 }  // namespace cdbg
 }  // namespace devtools
@@ -16,6 +16,7 @@
 
 #include "unary_expression_evaluator.h"
 
+#include "expression_program.h"
 #include "model.h"
 #include "messages.h"
 #include "numeric_cast_evaluator.h"
@@ -40,6 +41,24 @@ bool UnaryExpressionEvaluator::Compile(
     return false;
   }
 
+  if (!CompileOperator(error_message)) {
+    return false;
+  }
+
+  JVariant arg_value;
+  if (GetStaticPrimitiveValue(*arg_, &arg_value)) {
+    ErrorOr<JVariant> result = computer_(arg_value);
+    if (!result.is_error()) {
+      static_value_ = JVariant(result.value());
+    }
+  }
+
+  return true;
+}
+
+
+bool UnaryExpressionEvaluator::CompileOperator(
+    FormatMessageModel* error_message) {
   switch (type_) {
     case UnaryJavaExpression::Type::plus:
     case UnaryJavaExpression::Type::minus:
@@ -154,6 +173,10 @@ bool UnaryExpressionEvaluator::CompileLogicalComplement(
 
 ErrorOr<JVariant> UnaryExpressionEvaluator::Evaluate(
     const EvaluationContext& evaluation_context) const {
+  if (static_value_.type() != JType::Void) {
+    return JVariant(static_value_);
+  }
+
   ErrorOr<JVariant> arg_value = arg_->Evaluate(evaluation_context);
   if (arg_value.is_error()) {
     return arg_value;
@@ -163,6 +186,50 @@ ErrorOr<JVariant> UnaryExpressionEvaluator::Evaluate(
 }
 
 
+int UnaryExpressionEvaluator::Lower(ExpressionProgramBuilder* builder) const {
+  if (static_value_.type() != JType::Void) {
+    return builder->AddConstant(
+        static_value_.type(),
+        static_value_.get_jvalue());
+  }
+
+  const JType arg_type = arg_->GetStaticType().type;
+  ExpressionProgram::Opcode opcode;
+
+  switch (type_) {
+    case UnaryJavaExpression::Type::plus:
+      return arg_->Lower(builder);
+
+    case UnaryJavaExpression::Type::minus:
+      if (!ExpressionProgram::SelectTypedOpcode(
+              ExpressionProgram::Opcode::NEG_INT,
+              arg_type,
+              &opcode)) {
+        return ExpressionProgramBuilder::kNoRegister;
+      }
+      break;
+
+    case UnaryJavaExpression::Type::bitwise_complement:
+      if (!ExpressionProgram::SelectTypedOpcode(
+              ExpressionProgram::Opcode::COMPLEMENT_INT,
+              arg_type,
+              &opcode)) {
+        return ExpressionProgramBuilder::kNoRegister;
+      }
+      break;
+
+    case UnaryJavaExpression::Type::logical_complement:
+      opcode = ExpressionProgram::Opcode::BOOLEAN_NOT;
+      break;
+
+    default:
+      return ExpressionProgramBuilder::kNoRegister;
+  }
+
+  return builder->AddUnary(opcode, arg_->Lower(builder));
+}
+
+
 ErrorOr<JVariant> UnaryExpressionEvaluator::LogicalComplementComputer(
     const JVariant& arg) {
   jboolean boolean_value = false;
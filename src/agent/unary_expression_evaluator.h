@@ -42,13 +42,27 @@ class UnaryExpressionEvaluator : public ExpressionEvaluator {
   }
 
   Nullable<jvalue> GetStaticValue() const override {
+    if (static_value_.type() != JType::Void) {
+      return static_value_.get_jvalue();
+    }
+
     return nullptr;
   }
 
+  bool HasMethodCalls() const override {
+    return (static_value_.type() == JType::Void) && arg_->HasMethodCalls();
+  }
+
+  int Lower(ExpressionProgramBuilder* builder) const override;
+
   ErrorOr<JVariant> Evaluate(
       const EvaluationContext& evaluation_context) const override;
 
  private:
+  // Selects the computer and the result type based on the operator and on
+  // the type of the compiled argument.
+  bool CompileOperator(FormatMessageModel* error_message);
+
   // Tries to compile the expression for unary plus and minus operators.
   // Returns false if the argument is not suitable.
   bool CompilePlusMinusOperators(FormatMessageModel* error_message);
@@ -89,6 +103,10 @@ class UnaryExpressionEvaluator : public ExpressionEvaluator {
   // computer_ is supposed product.
   JSignature result_type_;
 
+  // Value of the expression computed at compile time if the argument is
+  // constant or void otherwise.
+  JVariant static_value_;
+
   DISALLOW_COPY_AND_ASSIGN(UnaryExpressionEvaluator);
 };
 
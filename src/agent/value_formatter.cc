@@ -17,6 +17,9 @@
 #include "value_formatter.h"
 
 #include <numeric>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "jni_utils.h"
 
 namespace devtools {
@@ -32,34 +35,191 @@ static constexpr char kNormalStringSuffixNoQuotes[] = "";
 static constexpr char kTruncatedStringSuffix[] = " ...\"";
 static constexpr char kTruncatedStringSuffixNoQuotes[] = " ...";
 
+// Number of UTF-16 characters copied from a Java string at a time.
+static constexpr int kStringChunkLength = 256;
+
+// Maximum number of UTF-8 bytes produced from a single UTF-16 character.
+// Characters outside of BMP take 4 bytes, but they are encoded as a
+// surrogate pair of two UTF-16 characters.
+static constexpr int kMaxUtf8BytesPerChar = 3;
+
 static bool IsJavaString(const NamedJVariant& data) {
-  return (data.value.type() == JType::Object) &&
-         ValueFormatter::IsImmutableValueObject(data.well_known_jclass);
+  return data.has_inline_string ||
+         ((data.value.type() == JType::Object) &&
+          ValueFormatter::IsImmutableValueObject(data.well_known_jclass));
+}
+
+
+static bool IsHighSurrogate(jchar c) {
+  return (c >= 0xD800) && (c <= 0xDBFF);
+}
+
+
+static bool IsLowSurrogate(jchar c) {
+  return (c >= 0xDC00) && (c <= 0xDFFF);
 }
 
 
-static void FormatJavaString(
+// Encodes "count" UTF-16 characters as UTF-8 into "out" and returns the
+// pointer past the last written byte. "out" must have room for
+// "kMaxUtf8BytesPerChar * count" bytes. Follows the modified UTF-8 of JNI
+// for characters 0 (encoded as two non-zero bytes) and unpaired surrogates.
+static char* EncodeUtf8(const jchar* chars, int count, char* out) {
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i non_ascii_bits = _mm_set1_epi16(static_cast<int16>(0xFF80));
+#endif
+
+  int i = 0;
+  while (i < count) {
+#if defined(__SSE2__)
+    // Narrow 8 ASCII characters at a time.
+    while (i + 8 <= count) {
+      const __m128i block =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + i));
+      const __m128i is_ascii = _mm_andnot_si128(
+          _mm_cmpeq_epi16(block, zero),
+          _mm_cmpeq_epi16(_mm_and_si128(block, non_ascii_bits), zero));
+      if (_mm_movemask_epi8(is_ascii) != 0xFFFF) {
+        break;
+      }
+
+      _mm_storel_epi64(
+          reinterpret_cast<__m128i*>(out),
+          _mm_packus_epi16(block, block));
+      i += 8;
+      out += 8;
+    }
+#endif
+
+    // Fast path for runs of ASCII characters (excluding 0), which is what
+    // most of the strings consist of.
+    while ((i < count) && (static_cast<jchar>(chars[i] - 1) < 0x7F)) {
+      *out++ = static_cast<char>(chars[i++]);
+    }
+
+    if (i == count) {
+      break;
+    }
+
+    const jchar c = chars[i++];
+    if (c < 0x800) {
+      *out++ = static_cast<char>(0xC0 | (c >> 6));
+      *out++ = static_cast<char>(0x80 | (c & 0x3F));
+    } else if (IsHighSurrogate(c) && (i < count) &&
+               IsLowSurrogate(chars[i])) {
+      const uint32 code_point =
+          0x10000 + ((c - 0xD800) << 10) + (chars[i++] - 0xDC00);
+      *out++ = static_cast<char>(0xF0 | (code_point >> 18));
+      *out++ = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+      *out++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+      *out++ = static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+      *out++ = static_cast<char>(0xE0 | (c >> 12));
+      *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+      *out++ = static_cast<char>(0x80 | (c & 0x3F));
+    }
+  }
+
+  return out;
+}
+
+
+// Gets the suffix closing the formatted string. Returns the length of the
+// suffix (not including '\0') in "suffix_length".
+static const char* GetStringSuffix(
+    const ValueFormatter::Options& options,
+    bool truncated,
+    int* suffix_length) {
+  if (options.quote_string) {
+    if (truncated) {
+      *suffix_length = arraysize(kTruncatedStringSuffix) - 1;
+      return kTruncatedStringSuffix;
+    }
+
+    *suffix_length = arraysize(kNormalStringSuffix) - 1;
+    return kNormalStringSuffix;
+  }
+
+  if (truncated) {
+    *suffix_length = arraysize(kTruncatedStringSuffixNoQuotes) - 1;
+    return kTruncatedStringSuffixNoQuotes;
+  }
+
+  *suffix_length = arraysize(kNormalStringSuffixNoQuotes) - 1;
+  return kNormalStringSuffixNoQuotes;
+}
+
+
+// Formats the string copied by "CaptureInlineString". Truncation counts
+// UTF-16 characters (a 4 byte UTF-8 sequence is a surrogate pair), so that
+// the result is the same as formatting the Java string itself.
+static void AppendInlineString(
+    const NamedJVariant& source,
+    const ValueFormatter::Options& options,
+    string* formatted_value) {
+  const string& value = source.inline_string;
+
+  size_t end = value.size();
+  const bool truncated = (source.string_length > options.max_string_length);
+  if (truncated) {
+    int remaining = std::max(0, options.max_string_length);
+    end = 0;
+    while (end < value.size()) {
+      const uint8 lead = static_cast<uint8>(value[end]);
+      const int sequence_length =
+          (lead < 0x80) ? 1 : (lead < 0xE0) ? 2 : (lead < 0xF0) ? 3 : 4;
+      const int chars = (sequence_length == 4) ? 2 : 1;
+      if (chars > remaining) {
+        break;
+      }
+
+      remaining -= chars;
+      end += sequence_length;
+    }
+  }
+
+  int suffix_length = 0;
+  const char* suffix = GetStringSuffix(options, truncated, &suffix_length);
+
+  if (options.quote_string) {
+    formatted_value->push_back('"');
+  }
+
+  formatted_value->append(value, 0, end);
+  formatted_value->append(suffix, suffix_length);
+}
+
+
+static void AppendJavaString(
     const NamedJVariant& source,
     const ValueFormatter::Options& options,
     string* formatted_value) {
+  if (source.has_inline_string) {
+    AppendInlineString(source, options, formatted_value);
+    return;
+  }
+
   jobject ref = nullptr;
   if (!source.value.get<jobject>(&ref)) {
     DCHECK(false);
-    *formatted_value = "<unavailable>";
+    formatted_value->append("<unavailable>");
     return;
   }
 
   jstring jstr = static_cast<jstring>(ref);
 
   if (jstr == nullptr) {
-    *formatted_value = kNull;
+    formatted_value->append(kNull);
     return;
   }
 
-  jint len = jni()->GetStringLength(jstr);
+  jint len = (source.string_length >= 0)
+      ? source.string_length
+      : jni()->GetStringLength(jstr);
   if (len < 0) {
     LOG(ERROR) << "Bad string length: " << len;
-    *formatted_value = "<malformed string>";
+    formatted_value->append("<malformed string>");
     return;
   }
 
@@ -67,52 +227,62 @@ static void FormatJavaString(
   if (len > options.max_string_length) {
     len = options.max_string_length;
     truncated = true;
-  }
 
-  const char* suffix = nullptr;
-  int suffix_length = 0;  // Does not include '\0'.
-  if (options.quote_string) {
-    if (truncated) {
-      suffix = kTruncatedStringSuffix;
-      suffix_length = arraysize(kTruncatedStringSuffix) - 1;
-    } else {
-      suffix = kNormalStringSuffix;
-      suffix_length = arraysize(kNormalStringSuffix) - 1;
-    }
-  } else {
-    if (truncated) {
-      suffix = kTruncatedStringSuffixNoQuotes;
-      suffix_length = arraysize(kTruncatedStringSuffixNoQuotes) - 1;
-    } else {
-      suffix = kNormalStringSuffixNoQuotes;
-      suffix_length = arraysize(kNormalStringSuffixNoQuotes) - 1;
+    // Don't cut a surrogate pair in half.
+    if (len > 0) {
+      jchar last = 0;
+      jni()->GetStringRegion(jstr, len - 1, 1, &last);
+      if (JniCheckNoException("GetStringRegion") && IsHighSurrogate(last)) {
+        --len;
+      }
     }
   }
 
-  // Allocate the string using 4x of the unicode string length.
-  formatted_value->resize(4 * len + 1 + suffix_length);
+  int suffix_length = 0;
+  const char* suffix = GetStringSuffix(options, truncated, &suffix_length);
+
+  // Allocate the string for the worst case encoding past the existing
+  // content.
+  const size_t base = formatted_value->size();
+  const size_t value_begin = base + (options.quote_string ? 1 : 0);
+  formatted_value->resize(
+      value_begin + kMaxUtf8BytesPerChar * len + suffix_length);
 
   if (options.quote_string) {
     // Wrap the string with double quotes to give a clue that it's a string.
-    (*formatted_value)[0] = '"';
+    (*formatted_value)[base] = '"';
   }
 
-  // Throws StringIndexOutOfBoundsException on index overflow.
-  jni()->GetStringUTFRegion(
-      jstr,
-      0,
-      len,
-      &((*formatted_value)[options.quote_string ? 1 : 0]));
-  JniCheckNoException("GetStringUTFRegion");
+  // Only the captured prefix of the string is copied from the JVM. This
+  // keeps the cost bounded for huge strings (e.g. JSON payloads).
+  char* const value = &((*formatted_value)[value_begin]);
+  char* out = value;
+  jchar chunk[kStringChunkLength];
+  int offset = 0;
+  while (offset < len) {
+    int count = std::min(kStringChunkLength, len - offset);
+
+    // Throws StringIndexOutOfBoundsException on index overflow.
+    jni()->GetStringRegion(jstr, offset, count, chunk);
+    if (!JniCheckNoException("GetStringRegion")) {
+      break;
+    }
+
+    // Leave the high surrogate at the end of the chunk to the next chunk,
+    // so that the surrogate pair is encoded together.
+    if ((offset + count < len) && IsHighSurrogate(chunk[count - 1])) {
+      --count;
+    }
+
+    out = EncodeUtf8(chunk, count, out);
+    offset += count;
+  }
 
-  // Find the end of the string. Java strings can include 0, but modified UTF-8
-  // encoding keeps it as two non-zero bytes:
-  // http://docs.oracle.com/javase/1.5.0/docs/guide/jni/spec/types.html
-  len = strlen(&((*formatted_value)[0]));
+  const size_t end = value_begin + (out - value);
 
   // Copy the suffix onto the allocated space and resize back to the full size.
-  std::copy(suffix, suffix + suffix_length, formatted_value->begin() + len);
-  formatted_value->resize(len + suffix_length);
+  std::copy(suffix, suffix + suffix_length, formatted_value->begin() + end);
+  formatted_value->resize(end + suffix_length);
 }
 
 
@@ -145,17 +315,17 @@ bool ValueFormatter::IsValue(const NamedJVariant& data) {
 }
 
 
-int ValueFormatter::GetTotalDataSize(const NamedJVariant& data) {
-  const int name_size = data.name.size();
+int ValueFormatter::GetTotalDataSize(NamedJVariant* data) {
+  const int name_size = data->name.size();
 
   // Include size of error message if evaluation failed.
-  if (!data.status.description.format.empty()) {
+  if (!data->status.description.format.empty()) {
     return
       name_size +
-      data.status.description.format.size() +
+      data->status.description.format.size() +
       std::accumulate(
-          data.status.description.parameters.begin(),
-          data.status.description.parameters.end(),
+          data->status.description.parameters.begin(),
+          data->status.description.parameters.end(),
           0,
           [] (int accumulated_total, const string& parameter) {
             return accumulated_total + parameter.size();
@@ -163,12 +333,22 @@ int ValueFormatter::GetTotalDataSize(const NamedJVariant& data) {
   }
 
   // Compute length of a string.
-  if (!IsJavaString(data)) {
+  if (!IsJavaString(*data)) {
     return name_size + 8;  // 8 characters is good enough approximation.
   }
 
+  if (data->has_inline_string) {
+    return name_size +
+           2 +
+           std::min<int>(kDefaultMaxStringLength, data->string_length);
+  }
+
   jobject ref = nullptr;
-  if (data.value.get<jobject>(&ref) && (ref != nullptr)) {
+  if (data->value.get<jobject>(&ref) && (ref != nullptr)) {
+    if (data->string_length < 0) {
+      data->string_length = jni()->GetStringLength(static_cast<jstring>(ref));
+    }
+
     // 2 characters for the wrapping double quotes + number of characters to
     // take from the Java string.
     //
@@ -178,25 +358,75 @@ int ValueFormatter::GetTotalDataSize(const NamedJVariant& data) {
     // length has a very small impact on the total size of the captured buffer.
     return name_size +
            2 +
-           std::min<int>(
-               kDefaultMaxStringLength,
-               jni()->GetStringLength(static_cast<jstring>(ref)));
+           std::min<int>(kDefaultMaxStringLength, data->string_length);
   }
 
   return name_size + 4;
 }
 
 
+void ValueFormatter::CaptureInlineString(NamedJVariant* data) {
+  if (data->has_inline_string ||
+      !data->status.description.format.empty() ||
+      !IsJavaString(*data)) {
+    return;
+  }
+
+  jobject ref = nullptr;
+  if (!data->value.get<jobject>(&ref) || (ref == nullptr)) {
+    return;
+  }
+
+  jstring jstr = static_cast<jstring>(ref);
+
+  if (data->string_length < 0) {
+    data->string_length = jni()->GetStringLength(jstr);
+  }
+
+  const int len = data->string_length;
+  if ((len < 0) || (len > kMaxInlineStringLength)) {
+    return;
+  }
+
+  jchar chars[kMaxInlineStringLength];
+  jni()->GetStringRegion(jstr, 0, len, chars);
+  if (!JniCheckNoException("GetStringRegion")) {
+    return;
+  }
+
+  data->inline_string.resize(kMaxUtf8BytesPerChar * len);
+  char* const begin = &data->inline_string[0];
+  data->inline_string.resize(EncodeUtf8(chars, len, begin) - begin);
+  data->has_inline_string = true;
+
+  data->value = JVariant();
+}
+
+
+void ValueFormatter::Append(
+    const NamedJVariant& source,
+    const Options& options,
+    string* formatted_value) {
+  if (IsJavaString(source)) {
+    AppendJavaString(source, options, formatted_value);
+  } else {
+    source.value.AppendToString(formatted_value);
+  }
+}
+
+
 void ValueFormatter::Format(
     const NamedJVariant& source,
     const Options& options,
     string* formatted_value,
     string* type) {
+  formatted_value->clear();
+
   // Format Java string.
   if (IsJavaString(source)) {
-    FormatJavaString(source, options, formatted_value);
+    AppendJavaString(source, options, formatted_value);
     if (type != nullptr) {
-      if (source.value.has_non_null_object()) {
+      if (source.has_inline_string || source.value.has_non_null_object()) {
         *type = "String";
       } else {
         type->clear();
@@ -206,7 +436,7 @@ void ValueFormatter::Format(
   }
 
   // Format primitive value (or null).
-  *formatted_value = source.value.ToString(true);
+  source.value.AppendToString(formatted_value);
   if (type != nullptr) {
     if (source.value.type() != JType::Object) {
       *type = TypeNameFromSignature({ source.value.type() });
@@ -31,6 +31,10 @@ constexpr int kDefaultMaxStringLength = 256;
 // Maximum string length to capture in watched expressions.
 constexpr int kExtendedMaxStringLength = 2048;
 
+// Java strings up to this length (in UTF-16 characters) are copied into
+// the capture rather than kept as references until formatting.
+constexpr int kMaxInlineStringLength = 64;
+
 // Set of methods to format JVariant to a string.
 class ValueFormatter {
  public:
@@ -52,8 +56,16 @@ class ValueFormatter {
 
   // Computes approximated amount of data that the value will take when
   // formatted. Includes both name and value, but doesn't count any formatting
-  // overhead.
-  static int GetTotalDataSize(const NamedJVariant& data);
+  // overhead. Only strings need a JNI call, and their length is cached in
+  // "data", so that "Format" and "Append" don't repeat it.
+  static int GetTotalDataSize(NamedJVariant* data);
+
+  // Copies the content of a short Java string into "data" and releases the
+  // string reference. Does nothing if "data" is not a Java string or if the
+  // string is longer than "kMaxInlineStringLength". Called while the thread
+  // is paused, so that the capture doesn't need a global reference for
+  // every short string it holds.
+  static void CaptureInlineString(NamedJVariant* data);
 
   // Formats variable value to a string format. "FormatValue" can be called
   // even if this is a reference. In this case the function will return
@@ -64,6 +76,14 @@ class ValueFormatter {
       const Options& options,
       string* formatted_value,
       string* type);
+
+  // Same as "Format", but appends the value to "formatted_value" rather than
+  // replacing its content and doesn't compute the type. Used to build a
+  // message out of many values without a temporary string per value.
+  static void Append(
+      const NamedJVariant& source,
+      const Options& options,
+      string* formatted_value);
 };
 
 
@@ -16,9 +16,14 @@
 
 #include "worker.h"
 
+#include <algorithm>
+#include <iterator>
+#include "agent_status.h"
 #include "callbacks_monitor.h"
 #include "agent_thread.h"
 #include "bridge.h"
+#include "overhead_governor.h"
+#include "status_server.h"
 
 DEFINE_int32(
     hub_retry_delay_ms,
@@ -32,33 +37,89 @@ DEFINE_int32(
     "amount of time in milliseconds to sleep before checking whether "
     "the debugger was enabled back");
 
+DEFINE_int32(
+    cdbg_format_threads,
+    2,
+    "number of threads formatting and serializing captured breakpoint "
+    "results; if 0, the results are formatted on the transmission thread");
+
+DEFINE_int32(
+    cdbg_worker_max_sleep_ms,
+    60000,  // 1 minute
+    "maximum time in milliseconds the activation thread sleeps when no "
+    "scheduled callbacks are due; the thread is woken up earlier when a "
+    "callback is scheduled");
+
+DEFINE_string(
+    cdbg_status_socket,
+    "",
+    "if not empty, path of a Unix domain socket serving the live status of "
+    "the agent (statistics, cache hit rates, queue depths, rate limiters, "
+    "breakpoint counters and callbacks watchdog state) to local clients");
+
 namespace devtools {
 namespace cdbg {
 
+// Maximum time the status thread waits for a client before checking whether
+// the agent is unloading.
+constexpr int kStatusThreadPollIntervalMs = 500;
+
 int g_register_debuggee_attempts = 0;
 
+// Number of consecutive failed hanging gets after which the debuggee is
+// registered again.
+static constexpr int kMaxListActiveBreakpointsFailures = 3;
+
+// Time to wait before retrying to format breakpoint updates while the agent
+// is over its CPU budget.
+static constexpr int kFormattingThrottleDelayMs = 100;
+
 Worker::Worker(
     Provider* provider,
     std::function<std::unique_ptr<AutoResetEvent>()> event_factory,
     std::function<std::unique_ptr<AgentThread>()> agent_thread_factory,
     ClassPathLookup* class_path_lookup,
     std::unique_ptr<Bridge> bridge,
-    FormatQueue* format_queue)
+    FormatQueue* format_queue,
+    DynamicLogQueue* dynamic_log_queue)
     : provider_(provider),
       main_thread_event_(event_factory()),
       transmission_thread_event_(event_factory()),
       main_thread_(agent_thread_factory()),
       transmission_thread_(agent_thread_factory()),
+      dynamic_log_thread_event_(event_factory()),
+      dynamic_log_thread_(agent_thread_factory()),
+      activation_thread_event_(event_factory()),
+      activation_thread_(agent_thread_factory()),
+      status_thread_(agent_thread_factory()),
       class_path_lookup_(class_path_lookup),
       bridge_(std::move(bridge)),
-      canary_control_(CallbacksMonitor::GetInstance(), bridge_.get()),
-      format_queue_(format_queue) {
+      canary_control_(
+          CallbacksMonitor::GetInstance(),
+          bridge_.get(),
+          [this]() { transmission_thread_event_->Signal(); }),
+      format_queue_(format_queue),
+      dynamic_log_queue_(dynamic_log_queue) {
+  for (int i = 0; i < FLAGS_cdbg_format_threads; ++i) {
+    format_threads_.push_back(
+        FormatThread { event_factory(), agent_thread_factory() });
+  }
+
   // Subscribe to receive synchronous notifications every time a breakpoint
   // update is enqueued. In return we get a cookie that must be returned
   // back to unsubscribe (on shutdown).
   on_breakpoint_update_enqueued_cookie_ =
       format_queue_->SubscribeOnItemEnqueuedEvents([this]() {
-        transmission_thread_event_->Signal();
+        if (active_format_threads_ > 0) {
+          format_threads_[0].event->Signal();
+        } else {
+          transmission_thread_event_->Signal();
+        }
+      });
+
+  on_dynamic_log_enqueued_cookie_ =
+      dynamic_log_queue_->SubscribeOnItemEnqueuedEvents([this]() {
+        dynamic_log_thread_event_->Signal();
       });
 }
 
@@ -91,6 +152,8 @@ void Worker::Start() {
 void Worker::Shutdown() {
   format_queue_->UnsubscribeOnItemEnqueuedEvents(
       std::move(on_breakpoint_update_enqueued_cookie_));
+  dynamic_log_queue_->UnsubscribeOnItemEnqueuedEvents(
+      std::move(on_dynamic_log_enqueued_cookie_));
 
   is_unloading_ = true;
 
@@ -140,7 +203,13 @@ void Worker::MainThreadProc() {
     return;  // Signal to stop the main debugger thread.
   }
 
+  StartDynamicLogThread();
+  StartActivationThread();
+  StartStatusThread();
+
   while (!is_unloading_) {
+    ScopedOverheadCharge overhead_charge;
+
     // Register debuggee if not registered or if previous call to list active
     // breakpoints failed.
     if (!is_registered_) {
@@ -150,8 +219,6 @@ void Worker::MainThreadProc() {
       ListActiveBreakpoints();
     }
 
-    canary_control_.ApproveHealtyBreakpoints();
-
     provider_->OnIdle();
   }
 
@@ -160,22 +227,78 @@ void Worker::MainThreadProc() {
     transmission_thread_event_->Signal();
     transmission_thread_->Join();
   }
+
+  // Same for the formatting threads.
+  for (int i = 0; i < active_format_threads_; ++i) {
+    format_threads_[i].event->Signal();
+    format_threads_[i].thread->Join();
+  }
+
+  // And for the dynamic log thread. Log points hit from now on write the
+  // entries synchronously.
+  if (dynamic_log_thread_->IsStarted()) {
+    dynamic_log_queue_->SetConsumerActive(false);
+    dynamic_log_thread_event_->Signal();
+    dynamic_log_thread_->Join();
+  }
+
+  // And for the activation thread. Classes prepared from now on activate
+  // their breakpoints synchronously.
+  if (activation_thread_->IsStarted()) {
+    is_activation_thread_active_ = false;
+    activation_thread_event_->Signal();
+    activation_thread_->Join();
+  }
+
+  // And for the status thread.
+  if (status_thread_->IsStarted()) {
+    status_thread_->Join();
+  }
 }
 
 
 void Worker::TransmissionThreadProc() {
+  bool is_formatting_throttled = false;
   while (!is_unloading_) {
     // Wait until one of the following:
     // 1. New breakpoint update has been enqueued.
-    // 2. Shutdown.
-    // 3. Previously failed transmissions and we are past the retry interval.
-    transmission_thread_event_->Wait(
-        bridge_->HasPendingMessages()
+    // 2. New canary breakpoint waits for registration.
+    // 3. Shutdown.
+    // 4. Previously failed transmissions and we are past the retry interval.
+    // 5. Formatting was throttled and it's time to try again.
+    // 6. A canary breakpoint is due for approval.
+    int64 delay_ms =
+        is_formatting_throttled
+        ? kFormattingThrottleDelayMs
+        : bridge_->HasPendingMessages()
         ? FLAGS_hub_retry_delay_ms
-        : 100000000);  // arbitrary long delay.
+        : 100000000;  // arbitrary long delay.
+
+    const int64 canary_delay_ms = canary_control_.GetApprovalDelayMs();
+    if (canary_delay_ms >= 0) {
+      delay_ms = std::min(delay_ms, canary_delay_ms);
+    }
+
+    transmission_thread_event_->Wait(static_cast<int>(delay_ms));
+
+    ScopedOverheadCharge overhead_charge;
+
+    // Register the new canary breakpoints, so that they can be activated.
+    canary_control_.RegisterPendingBreakpoints();
+
+    // Approve the canary breakpoints that have been healthy long enough.
+    canary_control_.ApproveHealtyBreakpoints();
+
+    // Enqueue new breakpoint updates for transmission unless they are
+    // formatted by the formatting threads.
+    is_formatting_throttled = false;
+    while (!is_unloading_ && (active_format_threads_ == 0)) {
+      if (!OverheadGovernor::GetInstance()->IsAdmitted(
+              OverheadPriority::Formatting)) {
+        is_formatting_throttled = true;
+        break;
+      }
 
-    // Enqueue new breakpoint updates for transmission.
-    while (!is_unloading_) {
       std::unique_ptr<BreakpointModel> breakpoint =
           format_queue_->FormatAndPop();
 
@@ -189,6 +312,203 @@ void Worker::TransmissionThreadProc() {
     // Post breakpoint hit results (both the new ones and retry previously
     // failed messages).
     bridge_->TransmitBreakpointUpdates();
+
+    // Stop admitting new captures while the backlog is high. This is
+    // reevaluated at least every "hub_retry_delay_ms" while messages are
+    // pending.
+    format_queue_->SetDownstreamSaturated(bridge_->IsTransmitBacklogged());
+  }
+}
+
+
+void Worker::FormatThreadProc(int index) {
+  while (!is_unloading_) {
+    format_threads_[index].event->Wait(100000000);  // arbitrary long delay.
+
+    while (!is_unloading_) {
+      // Formatting is the first to be throttled when the agent is over its
+      // CPU budget. It only delays the results.
+      if (!OverheadGovernor::GetInstance()->IsAdmitted(
+              OverheadPriority::Formatting)) {
+        format_threads_[index].event->Wait(kFormattingThrottleDelayMs);
+        continue;
+      }
+
+      ScopedOverheadCharge overhead_charge;
+      std::unique_ptr<BreakpointModel> breakpoint =
+          format_queue_->FormatAndPop();
+
+      if (breakpoint == nullptr) {
+        break;
+      }
+
+      // Wake up the next formatting thread so that the next item in the
+      // queue is formatted in parallel with this one.
+      const int count = active_format_threads_;
+      if (count > 1) {
+        format_threads_[(index + 1) % count].event->Signal();
+      }
+
+      // Serialization happens here as well, so it is also parallelized.
+      // Updates of the same breakpoint formatted by different threads may
+      // be enqueued out of order. This is benign since "TransmitQueue" drops
+      // an interim update if a newer update of the same breakpoint is
+      // pending and an interim update is never formatted after the final
+      // one.
+      bridge_->EnqueueBreakpointUpdate(std::move(breakpoint));
+      transmission_thread_event_->Signal();
+    }
+  }
+}
+
+
+void Worker::StartFormatThreads() {
+  if (active_format_threads_ > 0) {
+    return;
+  }
+
+  // Threads that failed to start are left out. If none of the threads
+  // started, the transmission thread formats the updates itself.
+  int count = 0;
+  for (FormatThread& format_thread : format_threads_) {
+    if (!format_thread.event->Initialize() ||
+        !format_thread.thread->Start(
+            "CloudDebugger_format_thread",
+            std::bind(&Worker::FormatThreadProc, this, count))) {
+      LOG(ERROR) << "Format thread could not be started.";
+      break;
+    }
+
+    ++count;
+  }
+
+  active_format_threads_ = count;
+
+  // Pick up the updates enqueued before the formatting threads started.
+  if (count > 0) {
+    format_threads_[0].event->Signal();
+  }
+}
+
+
+void Worker::DynamicLogThreadProc() {
+  while (!is_unloading_) {
+    dynamic_log_thread_event_->Wait(100000000);  // arbitrary long delay.
+
+    ScopedOverheadCharge overhead_charge;
+    while (!is_unloading_ && dynamic_log_queue_->WriteBatch()) {
+    }
+  }
+}
+
+
+void Worker::StartDynamicLogThread() {
+  if (!dynamic_log_thread_event_->Initialize() ||
+      !dynamic_log_thread_->Start(
+          "CloudDebugger_dynamic_log_thread",
+          std::bind(&Worker::DynamicLogThreadProc, this))) {
+    LOG(ERROR) << "Dynamic log thread could not be started.";
+    return;
+  }
+
+  dynamic_log_queue_->SetConsumerActive(true);
+}
+
+
+bool Worker::RequestBreakpointsActivation() {
+  if (!is_activation_thread_active_) {
+    return false;
+  }
+
+  is_activation_requested_ = true;
+  activation_thread_event_->Signal();
+  return true;
+}
+
+
+void Worker::RequestScheduledCallbacks() {
+  if (is_activation_thread_active_) {
+    activation_thread_event_->Signal();
+  }
+}
+
+
+void Worker::ActivationThreadProc() {
+  int sleep_ms = 0;
+  while (!is_unloading_) {
+    // Sleep until the next scheduled callback is due. The scheduler wakes
+    // the thread up if an earlier callback is scheduled in the meantime, so
+    // an idle agent doesn't need to poll.
+    activation_thread_event_->Wait(sleep_ms);
+
+    if (is_unloading_) {
+      break;
+    }
+
+    ScopedOverheadCharge overhead_charge;
+    if (is_activation_requested_.exchange(false)) {
+      provider_->ActivateScheduledBreakpoints();
+    }
+
+    const int delay_ms = provider_->ProcessScheduledCallbacks();
+    sleep_ms = ((delay_ms < 0) || (delay_ms > FLAGS_cdbg_worker_max_sleep_ms))
+        ? FLAGS_cdbg_worker_max_sleep_ms
+        : delay_ms;
+  }
+}
+
+
+void Worker::StartActivationThread() {
+  if (!activation_thread_event_->Initialize() ||
+      !activation_thread_->Start(
+          "CloudDebugger_activation_thread",
+          std::bind(&Worker::ActivationThreadProc, this))) {
+    LOG(ERROR) << "Breakpoints activation thread could not be started.";
+    return;
+  }
+
+  is_activation_thread_active_ = true;
+}
+
+
+void Worker::StatusThreadProc() {
+  StatusServer server(
+      FLAGS_cdbg_status_socket,
+      [] () { return AgentStatus::GetInstance()->Format(); });
+  if (!server.Listen()) {
+    return;
+  }
+
+  while (!is_unloading_) {
+    server.ServeOnce(kStatusThreadPollIntervalMs);
+  }
+}
+
+
+void Worker::StartStatusThread() {
+  if (FLAGS_cdbg_status_socket.empty()) {
+    return;
+  }
+
+  if (!status_thread_->Start(
+          "CloudDebugger_status_thread",
+          std::bind(&Worker::StatusThreadProc, this))) {
+    LOG(ERROR) << "Status thread could not be started.";
+  }
+}
+
+
+void Worker::StartTransmissionThread() {
+  if (transmission_thread_->IsStarted()) {
+    return;
+  }
+
+  StartFormatThreads();
+
+  if (!transmission_thread_->Start(
+        "CloudDebugger_transmission_thread",
+        std::bind(&Worker::TransmissionThreadProc, this))) {
+    LOG(ERROR) << "Transmission thread could not be started.";
   }
 }
 
@@ -198,7 +518,17 @@ void Worker::RegisterDebuggee() {
   is_registered_ = bridge_->RegisterDebuggee(&new_is_enabled);
   ++g_register_debuggee_attempts;
 
+  has_listed_breakpoints_ = false;
+  listed_breakpoint_ids_.clear();
+  list_active_breakpoints_failures_ = 0;
+
   if (is_registered_) {
+    // Retransmit breakpoint updates left over by the previous instance of
+    // the debugger right away.
+    if (bridge_->HasPendingMessages()) {
+      StartTransmissionThread();
+    }
+
     provider_->EnableDebugger(new_is_enabled);
 
     if (!new_is_enabled) {
@@ -219,25 +549,74 @@ void Worker::ListActiveBreakpoints() {
   auto rc = bridge_->ListActiveBreakpoints(&breakpoints);
   switch (rc) {
     case Bridge::HangingGetResult::SUCCESS:
+      list_active_breakpoints_failures_ = 0;
+
       // Start the transmission thread first time a breakpoint is set. We then
       // never stop the transmission thread until shutdown (for simplicity).
-      if (!breakpoints.empty() && !transmission_thread_->IsStarted()) {
-        if (!transmission_thread_->Start(
-              "CloudDebugger_transmission_thread",
-              std::bind(&Worker::TransmissionThreadProc, this))) {
-          LOG(ERROR) << "Transmission thread could not be started.";
-        }
+      if (!breakpoints.empty()) {
+        StartTransmissionThread();
       }
 
       // Update the list of active breakpoints.
-      provider_->OnBreakpointsUpdated(std::move(breakpoints));
+      if (!has_listed_breakpoints_) {
+        for (const auto& breakpoint : breakpoints) {
+          listed_breakpoint_ids_.insert(breakpoint->id);
+        }
+
+        has_listed_breakpoints_ = true;
+        provider_->OnBreakpointsUpdated(std::move(breakpoints));
+      } else {
+        std::set<string> breakpoint_ids;
+        std::vector<std::unique_ptr<BreakpointModel>> added_breakpoints;
+        for (auto& breakpoint : breakpoints) {
+          if (!breakpoint_ids.insert(breakpoint->id).second) {
+            continue;  // Duplicate ID.
+          }
+
+          if (listed_breakpoint_ids_.find(breakpoint->id) ==
+              listed_breakpoint_ids_.end()) {
+            added_breakpoints.push_back(std::move(breakpoint));
+          }
+        }
+
+        std::vector<string> removed_breakpoint_ids;
+        std::set_difference(
+            listed_breakpoint_ids_.begin(),
+            listed_breakpoint_ids_.end(),
+            breakpoint_ids.begin(),
+            breakpoint_ids.end(),
+            std::back_inserter(removed_breakpoint_ids));
+
+        listed_breakpoint_ids_.swap(breakpoint_ids);
+
+        // Called even if nothing changed, so that the provider can retry
+        // breakpoints that it failed to set before.
+        provider_->OnBreakpointsChanged(
+            std::move(added_breakpoints),
+            removed_breakpoint_ids);
+      }
       return;
 
     case Bridge::HangingGetResult::FAIL:
-      is_registered_ = false;
+      // The registration is most likely still valid, so just retry the
+      // hanging get with the same wait token after a delay. Registering
+      // again would make the backend recompute everything for this
+      // debuggee. Register again anyway if the failures persist, in case the
+      // backend fails without saying that the debuggee is not registered.
+      if (++list_active_breakpoints_failures_ >=
+          kMaxListActiveBreakpointsFailures) {
+        is_registered_ = false;
+      } else {
+        main_thread_event_->Wait(FLAGS_hub_retry_delay_ms);
+      }
       return;
 
     case Bridge::HangingGetResult::TIMEOUT:
+      list_active_breakpoints_failures_ = 0;
+      return;
+
+    case Bridge::HangingGetResult::NOT_REGISTERED:
+      is_registered_ = false;
       return;
   }
 }
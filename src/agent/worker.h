@@ -20,9 +20,12 @@
 #include <atomic>
 #include <memory>
 #include <map>
+#include <set>
+#include <vector>
 #include "auto_reset_event.h"
 #include "canary_control.h"
 #include "common.h"
+#include "dynamic_log_queue.h"
 #include "format_queue.h"
 #include "model.h"
 #include "stopwatch.h"
@@ -37,7 +40,10 @@ class ClassPathLookup;
 // Implements background worker threads of the debuglet. The main worker thread
 // communicate with the backend and call the agent back when list of active
 // breakpoints changes. A second worker thread is used to send breakpoint
-// updates to the backend.
+// updates to the backend. A third worker thread writes dynamic log entries
+// to the application log. A fourth worker thread activates pending
+// breakpoints when their classes are prepared. An optional fifth worker
+// thread serves the agent status to local clients.
 class Worker {
  public:
   // Callback interface to used by the worker owner
@@ -57,25 +63,43 @@ class Worker {
     // All "OnIdle" calls are invoked from the same thread.
     virtual void OnIdle() = 0;
 
-    // Called upon a change in a set of active breakpoints.
-    // TODO(vlif): add support for added/removed actions for a single
-    // breakpoint.
+    // Called upon a change in a set of active breakpoints with the full list
+    // of active breakpoints.
     virtual void OnBreakpointsUpdated(
         std::vector<std::unique_ptr<BreakpointModel>> breakpoints) = 0;
 
+    // Called upon a change in a set of active breakpoints with just the
+    // breakpoints that were added and removed since the previous call to
+    // either "OnBreakpointsUpdated" or "OnBreakpointsChanged".
+    virtual void OnBreakpointsChanged(
+        std::vector<std::unique_ptr<BreakpointModel>> added_breakpoints,
+        const std::vector<string>& removed_breakpoint_ids) = 0;
+
     // Attaches or detaches the debugger as necessary.
     virtual void EnableDebugger(bool is_enabled) = 0;
+
+    // Activates pending breakpoints scheduled for activation since the last
+    // call. Invoked from the activation thread after
+    // "RequestBreakpointsActivation".
+    virtual void ActivateScheduledBreakpoints() = 0;
+
+    // Invokes the callbacks scheduled up to the current time. Called from the
+    // activation thread when the next callback is due (or when woken up by
+    // "RequestScheduledCallbacks"). Returns the time in milliseconds until
+    // the next scheduled callback or -1 if there are none.
+    virtual int ProcessScheduledCallbacks() = 0;
   };
 
-  // The "provider", "class_path_lookup" and "format_queue" not owned by this
-  // class and must outlive this object.
+  // The "provider", "class_path_lookup", "format_queue" and
+  // "dynamic_log_queue" not owned by this class and must outlive this object.
   Worker(
       Provider* provider,
       std::function<std::unique_ptr<AutoResetEvent>()> event_factory,
       std::function<std::unique_ptr<AgentThread>()> agent_thread_factory,
       ClassPathLookup* class_path_lookup,
       std::unique_ptr<Bridge> bridge,
-      FormatQueue* format_queue);
+      FormatQueue* format_queue,
+      DynamicLogQueue* dynamic_log_queue);
 
   ~Worker();
 
@@ -86,6 +110,18 @@ class Worker {
   // agent gets unloaded.
   void Shutdown();
 
+  // Wakes up the activation thread to call
+  // "Provider::ActivateScheduledBreakpoints". Returns false if the thread is
+  // not running, in which case breakpoints should be activated
+  // synchronously. This function is thread safe.
+  bool RequestBreakpointsActivation();
+
+  // Wakes up the activation thread to call
+  // "Provider::ProcessScheduledCallbacks" (e.g. when a callback has been
+  // scheduled earlier than the thread is going to wake up). This function is
+  // thread safe.
+  void RequestScheduledCallbacks();
+
   // Gets the canary breakpoints manager.
   CanaryControl* canary_control() { return &canary_control_; }
 
@@ -96,9 +132,41 @@ class Worker {
   // Transmission worker thread (sends breakpoint updates to the backend).
   void TransmissionThreadProc();
 
+  // Formatting worker thread (formats and serializes captured breakpoint
+  // results). "index" identifies the thread in "format_threads_".
+  void FormatThreadProc(int index);
+
+  // Starts the formatting threads unless they are already running.
+  void StartFormatThreads();
+
+  // Dynamic log worker thread (writes dynamic logs to the application log).
+  void DynamicLogThreadProc();
+
+  // Starts the dynamic log thread. If the thread can't be started, dynamic
+  // logs are written synchronously by the application threads.
+  void StartDynamicLogThread();
+
+  // Breakpoints activation worker thread (compiles breakpoint expressions
+  // and sets JVMTI breakpoints when classes are prepared).
+  void ActivationThreadProc();
+
+  // Starts the activation thread. If the thread can't be started, pending
+  // breakpoints are activated synchronously by the threads preparing the
+  // classes.
+  void StartActivationThread();
+
+  // Status worker thread (serves the agent status on a Unix domain socket).
+  void StatusThreadProc();
+
+  // Starts the status thread if enabled with --cdbg_status_socket.
+  void StartStatusThread();
+
   // Attaches/detaches debugger.
   void EnableDebugger(bool new_is_enabled);
 
+  // Starts the transmission thread unless it's already running.
+  void StartTransmissionThread();
+
   // Sends "RegisterDebuggee" message to the backend and updates the local
   // state.
   void RegisterDebuggee();
@@ -108,6 +176,13 @@ class Worker {
   void ListActiveBreakpoints();
 
  private:
+  // Formatting thread and its own notification event ("AutoResetEvent" only
+  // supports a single waiting thread).
+  struct FormatThread {
+    std::unique_ptr<AutoResetEvent> event;
+    std::unique_ptr<AgentThread> thread;
+  };
+
   // Callback interface. The provider feeds the worker thread with the
   // breakpoint updates to be sent to the backend and listens for notifications
   // about new breakpoints and debuggee getting disabled.
@@ -126,6 +201,36 @@ class Worker {
   // Worker thread to send breakpoint updates to the backend.
   std::unique_ptr<AgentThread> transmission_thread_;
 
+  // Notification event to wake up the dynamic log thread.
+  std::unique_ptr<AutoResetEvent> dynamic_log_thread_event_;
+
+  // Worker thread to write dynamic log entries to the application log.
+  std::unique_ptr<AgentThread> dynamic_log_thread_;
+
+  // Notification event to wake up the activation thread.
+  std::unique_ptr<AutoResetEvent> activation_thread_event_;
+
+  // Worker thread to activate pending breakpoints.
+  std::unique_ptr<AgentThread> activation_thread_;
+
+  // Worker thread serving the agent status to local clients.
+  std::unique_ptr<AgentThread> status_thread_;
+
+  // Set while the activation thread is running.
+  std::atomic<bool> is_activation_thread_active_ { false };
+
+  // Set by "RequestBreakpointsActivation" to tell the activation thread why
+  // it was woken up.
+  std::atomic<bool> is_activation_requested_ { false };
+
+  // Pool of threads to format captured breakpoint results in parallel. The
+  // vector is not changed after construction.
+  std::vector<FormatThread> format_threads_;
+
+  // Number of leading threads in "format_threads_" that are running. Zero
+  // if the results are formatted by the transmission thread.
+  std::atomic<int> active_format_threads_ { 0 };
+
   // Java implementation of "ClassPathLookup" class. Not owned by this class.
   ClassPathLookup* const class_path_lookup_;
 
@@ -141,12 +246,28 @@ class Worker {
   // Registration of a callback when a new breakpoint is enqueued.
   FormatQueue::OnItemEnqueued::Cookie on_breakpoint_update_enqueued_cookie_;
 
+  // Dynamic log entries that wait to be written to the application log.
+  DynamicLogQueue* const dynamic_log_queue_;
+
+  // Registration of a callback when a new dynamic log entry is enqueued.
+  DynamicLogQueue::OnItemEnqueued::Cookie on_dynamic_log_enqueued_cookie_;
+
   // Flag indicating that the JVMTI agent is being unloaded.
   std::atomic<bool> is_unloading_ { false };
 
   // Result of last call to "RegisterDebuggee".
   bool is_registered_ { false };
 
+  // Number of consecutive failed calls to list active breakpoints.
+  int list_active_breakpoints_failures_ { 0 };
+
+  // IDs of breakpoints passed to the provider so far. Used to only notify
+  // the provider about changes in the list of active breakpoints. Only valid
+  // if "has_listed_breakpoints_" is true. The full list is sent again after
+  // each registration, since the debugger might have been reattached.
+  std::set<string> listed_breakpoint_ids_;
+  bool has_listed_breakpoints_ { false };
+
   DISALLOW_COPY_AND_ASSIGN(Worker);
 };
 
@@ -1,13 +0,0 @@
-#include "antlr/CharStreamException.hpp"
-#include "antlr/String.hpp"
-
-#ifdef ANTLR_CXX_SUPPORTS_NAMESPACE
-namespace antlr {
-#endif
-
-ANTLR_IMPLEMENT_DYNAMIC( CharStreamException, ANTLRException, ANTLRException );
-
-
-#ifdef ANTLR_CXX_SUPPORTS_NAMESPACE
-}
-#endif
@@ -1,13 +0,0 @@
-#include "antlr/CharStreamIOException.hpp"
-#include "antlr/String.hpp"
-
-#ifdef ANTLR_CXX_SUPPORTS_NAMESPACE
-namespace antlr {
-#endif
-
-ANTLR_IMPLEMENT_DYNAMIC( CharStreamIOException, CharStreamException, ANTLRException );
-
-
-#ifdef ANTLR_CXX_SUPPORTS_NAMESPACE
-}
-#endif
@@ -1,30 +0,0 @@
-#ifndef INC_TokenStreamRetryException_hpp__
-#define INC_TokenStreamRetryException_hpp__
-
-/* ANTLR Translator Generator
- * Project led by Terence Parr at http://www.jGuru.com
- * Software rights: http://www.antlr.org/RIGHTS.html
- *
- * $Id: //depot/code/org.antlr/release/antlr-2.7.2/lib/cpp/antlr/TokenStreamRetryException.hpp#1 $
- */
-
-#include <antlr/config.hpp>
-#include <antlr/TokenStreamException.hpp>
-
-#ifdef ANTLR_CXX_SUPPORTS_NAMESPACE
-namespace antlr {
-#endif
-
-class TokenStreamRetryException : public TokenStreamException {
-public:
-  ANTLR_DECLARE_DYNAMIC( TokenStreamRetryException, TokenStreamException, ANTLRException );
-
-	TokenStreamRetryException() {}
-	~TokenStreamRetryException() throw() {}
-};
-
-#ifdef ANTLR_CXX_SUPPORTS_NAMESPACE
-}
-#endif
-
-#endif //INC_TokenStreamRetryException_hpp__